@@ -46,6 +46,7 @@ Includes   <System Includes> , "Project Includes"
 #include "r_image_config.h"
 #include "r_vdc_portsetting.h"
 #include "r_display_init.h"
+#include "r_compositor.h"
 #include "r_sdk_camera_graphics.h"
 
 /******************************************************************************
@@ -62,7 +63,14 @@ Macro definitions
 
 #define     DISP_BUFFER_STRIDE         (((DISP_AREA_HW * 2u) + 31u) & ~31u)
 #define     DISP_BUFFER_HEIGHT         (DISP_AREA_VW)
-#define     DISP_BUFFER_NUM            (2u)
+#define     DISP_BUFFER_NUM            (2u)     /* 3 for triple buffering if VRAM allows */
+#define     DISP_FLIP_INTERVAL         (1u)
+#define     DISP_FLIP_TIMEOUT          (100u)
+
+/* Moving box drawn over the background */
+#define     DISP_BACKGROUND            (0x0000u)
+#define     DISP_BOX_SIZE              (64u)
+#define     DISP_BOX_STEP              (16u)
 
 void sdk_camera_graphics_sample_task(void const *pArg);
 
@@ -83,6 +91,9 @@ Private global variables and functions
 ******************************************************************************/
 uint8_t graphic_buffer[DISP_BUFFER_NUM][DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT] __attribute__ ((section(".VRAM_SECTION0")));
 
+static st_rvapi_flip_t gs_graphic_flip;
+static st_comp_surface_t gs_graphic_surface;
+
 /***********************************************************************************************************************
  * Function Name: graphics_sample_task
  * Description  : Creates touch screen task
@@ -95,6 +106,11 @@ void sdk_camera_graphics_sample_task(void const *pArg)
     vdc_error_t error;
     vdc_channel_t vdc_ch = VDC_CHANNEL_0;
     uint8_t data = 0x00;
+    uint32_t i;
+    void *p_buff;
+    void *buffers[DISP_BUFFER_NUM];
+    st_comp_rect_t screen;
+    st_comp_rect_t box;
 
     /***********************************************************************/
     /* display init (VDC5 output setting) */
@@ -106,8 +122,11 @@ void sdk_camera_graphics_sample_task(void const *pArg)
     /***********************************************************************/
     /* display buffer clear */
     /***********************************************************************/
-    memset( &graphic_buffer[0], 0x00,  DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT );
-    memset( &graphic_buffer[1], 0x00,  DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT );
+    for (i = 0; i < DISP_BUFFER_NUM; i++)
+    {
+        memset( &graphic_buffer[i], 0x00,  DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT );
+        buffers[i] = (void *)graphic_buffer[i];
+    }
 
     /***********************************************************************/
     /* Graphic Layer 0 VDC_GR_FORMAT_YCBCR422 */
@@ -150,16 +169,48 @@ void sdk_camera_graphics_sample_task(void const *pArg)
         R_RVAPI_DispPortSettingVDC(vdc_ch, &VDC_LcdPortSetting);
     }
 
-    while (1)
+    /* Flip graphic_buffer on Vsync */
+    if (VDC_OK == error)
     {
-    	data++;
-        memset( &graphic_buffer[1], data,  DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT );
-        R_RVAPI_GraphChangeSurfaceVDC(vdc_ch,VDC_LAYER_ID_0_RD, &graphic_buffer[1]);
-    	R_OS_TaskSleep (1000);
+        st_rvapi_flip_config_t flip_cnf;
 
-    	data++;
-        memset( &graphic_buffer[0], data,  DISP_BUFFER_STRIDE * DISP_BUFFER_HEIGHT );
-        R_RVAPI_GraphChangeSurfaceVDC(vdc_ch,VDC_LAYER_ID_0_RD, &graphic_buffer[0] );
+        flip_cnf.layer_id = VDC_LAYER_ID_0_RD;
+        flip_cnf.pp_buff  = buffers;
+        flip_cnf.num      = DISP_BUFFER_NUM;
+        flip_cnf.interval = DISP_FLIP_INTERVAL;
+        flip_cnf.mailbox  = false;
+
+        error = R_RVAPI_FlipCreateVDC(&gs_graphic_flip, vdc_ch, &flip_cnf);
+    }
+
+    /* Only the areas invalidated since a buffer was last shown are redrawn or copied */
+    r_compositor_init(&gs_graphic_surface, DISP_AREA_HW, DISP_AREA_VW, DISP_BUFFER_STRIDE, 2u);
+    screen.x = 0;
+    screen.y = 0;
+    screen.w = DISP_AREA_HW;
+    screen.h = DISP_AREA_VW;
+    box.x = 0;
+    box.y = (DISP_AREA_VW - DISP_BOX_SIZE) / 2u;
+    box.w = DISP_BOX_SIZE;
+    box.h = DISP_BOX_SIZE;
+
+    while (1)
+    {
+        if ((VDC_OK == error) && (VDC_OK == R_RVAPI_FlipAcquireVDC(&gs_graphic_flip, DISP_FLIP_TIMEOUT, &p_buff)))
+        {
+            /* Move the box, invalidating where it was and where it is going */
+            r_compositor_invalidate(&gs_graphic_surface, &box);
+            box.x = (uint16_t)((box.x + DISP_BOX_STEP) % (DISP_AREA_HW - DISP_BOX_SIZE));
+            r_compositor_invalidate(&gs_graphic_surface, &box);
+
+            data++;
+            r_compositor_begin(&gs_graphic_surface, p_buff);
+            r_compositor_fill(&gs_graphic_surface, &screen, DISP_BACKGROUND);
+            r_compositor_fill(&gs_graphic_surface, &box, (uint32_t)data * 0x0101u);
+            r_compositor_end(&gs_graphic_surface, NULL);
+
+            R_RVAPI_FlipQueueVDC(&gs_graphic_flip, p_buff);
+        }
     	R_OS_TaskSleep (1000);
     }
 }
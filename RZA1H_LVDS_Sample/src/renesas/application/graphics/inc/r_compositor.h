@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_compositor.h
+ * @brief          Dirty rectangle tracking for double and triple buffered surfaces
+ * @version        1.00
+ * @date           24.04.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 24.04.2019 1.00 First Release
+ *****************************************************************************/
+
+/* Multiple inclusion prevention macro */
+#ifndef R_COMPOSITOR_H
+#define R_COMPOSITOR_H
+
+/******************************************************************************
+Includes   <System Includes> , "Project Includes"
+******************************************************************************/
+#include    "r_typedefs.h"
+
+/******************************************************************************
+Macro definitions
+******************************************************************************/
+#define COMPOSITOR_MAX_RECTS    (16u)   /* Dirty rectangles kept per frame, further rectangles are merged */
+#define COMPOSITOR_MAX_BUFFERS  (3u)    /* Frame buffers per surface */
+
+/******************************************************************************
+Typedef definitions
+******************************************************************************/
+
+/** Rectangle in pixels */
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} st_comp_rect_t;
+
+/** Set of non overlapping rectangles */
+typedef struct
+{
+    uint32_t       num;
+    st_comp_rect_t rect[COMPOSITOR_MAX_RECTS];
+} st_comp_region_t;
+
+/** Memory traffic of the last frame */
+typedef struct
+{
+    uint32_t copy_bytes;                /* Bytes copied from the previous frame by r_compositor_begin */
+    uint32_t draw_bytes;                /* Bytes of the dirty region redrawn by the widgets */
+} st_comp_stats_t;
+
+/** Surface state, allocated by the caller */
+typedef struct
+{
+    uint16_t         width;
+    uint16_t         height;
+    uint32_t         stride;            /* Bytes per line */
+    uint32_t         bpp;               /* Bytes per pixel */
+    uint32_t         frame;             /* Frames completed with r_compositor_end */
+    st_comp_region_t dirty;             /* Invalid area of the frame being drawn */
+    st_comp_region_t history[COMPOSITOR_MAX_BUFFERS - 1u]; /* Invalid areas of the last frames */
+    uint8_t          *p_buff[COMPOSITOR_MAX_BUFFERS];
+    uint32_t         drawn[COMPOSITOR_MAX_BUFFERS];        /* Frame last drawn into p_buff + 1, 0: never */
+    uint8_t          *p_front;          /* Buffer of the last completed frame */
+    uint8_t          *p_back;           /* Buffer being drawn */
+    st_comp_stats_t  stats;
+} st_comp_surface_t;
+
+/******************************************************************************
+ Functions Prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Initialises a surface. The whole surface is invalid until drawn.
+ * @param p_surface surface
+ * @param width     width in pixels
+ * @param height    height in pixels
+ * @param stride    bytes per line
+ * @param bpp       bytes per pixel
+ */
+void r_compositor_init(st_comp_surface_t * const p_surface, const uint16_t width, const uint16_t height,
+        const uint32_t stride, const uint32_t bpp);
+
+/**
+ * @brief Marks an area as needing to be redrawn in the next frame.
+ *        Called by widgets when their content changes.
+ * @param p_surface surface
+ * @param p_rect    area, clipped to the surface
+ */
+void r_compositor_invalidate(st_comp_surface_t * const p_surface, const st_comp_rect_t * const p_rect);
+
+/**
+ * @brief Starts a frame in p_buff. Areas changed in earlier frames that
+ *        p_buff has not seen are copied from the last completed frame,
+ *        except where they are invalid in this frame.
+ * @param p_surface surface
+ * @param p_buff    frame buffer to draw into
+ * @return Invalid area of this frame. Every rectangle must be redrawn
+ *         completely before r_compositor_end.
+ */
+const st_comp_region_t * r_compositor_begin(st_comp_surface_t * const p_surface, void * const p_buff);
+
+/**
+ * @brief Ends the frame started by r_compositor_begin.
+ * @param p_surface surface
+ * @param p_stats   memory traffic of the frame, may be NULL
+ */
+void r_compositor_end(st_comp_surface_t * const p_surface, st_comp_stats_t * const p_stats);
+
+/**
+ * @brief Fills a rectangle of the frame being drawn, clipped to the invalid area.
+ * @param p_surface surface
+ * @param p_rect    area
+ * @param colour    pixel value, the low bpp bytes are used
+ */
+void r_compositor_fill(st_comp_surface_t * const p_surface, const st_comp_rect_t * const p_rect,
+        const uint32_t colour);
+
+#endif  /* R_COMPOSITOR_H */
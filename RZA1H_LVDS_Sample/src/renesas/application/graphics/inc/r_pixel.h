@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_pixel.h
+ * @brief          2D pixel operations on frame buffers
+ * @version        1.00
+ * @date           24.04.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 24.04.2019 1.00 First Release
+ *****************************************************************************/
+
+/* Multiple inclusion prevention macro */
+#ifndef R_PIXEL_H
+#define R_PIXEL_H
+
+/******************************************************************************
+Includes   <System Includes> , "Project Includes"
+******************************************************************************/
+#include    "r_typedefs.h"
+
+/******************************************************************************
+Macro definitions
+******************************************************************************/
+
+/******************************************************************************
+Typedef definitions
+******************************************************************************/
+
+/** Rotation applied by r_pixel_rotate16 and r_pixel_rotate32 */
+typedef enum
+{
+    PIXEL_ROTATE_90 = 0,                /* Clockwise, the destination is height x width */
+    PIXEL_ROTATE_180,
+    PIXEL_ROTATE_270                    /* Anticlockwise, the destination is height x width */
+} e_pixel_rotate_t;
+
+/******************************************************************************
+ Functions Prototypes
+ ******************************************************************************/
+/*
+ * Pixel formats, as held in memory on this little endian target:
+ *   RGB565      16 bits, R in bits 15-11, G in bits 10-5, B in bits 4-0
+ *   ARGB4444    16 bits, A in bits 15-12, then R, G and B
+ *   ARGB8888    32 bits, A in bits 31-24, then R, G and B
+ *   RGB888      32 bits laid out as ARGB8888, written with A = 0xFF
+ *   YCbCr422    bytes Y0 Cb Y1 Cr for each pair of pixels, full range BT.601
+ *
+ * Strides are in bytes. Widths and heights are in pixels.
+ */
+
+/**
+ * @brief Fills a rectangle of 16-bit pixels
+ * @param p_dst      first pixel
+ * @param dst_stride bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ * @param colour     pixel value
+ */
+void r_pixel_fill16(void * const p_dst, const uint32_t dst_stride, const uint32_t width, const uint32_t height,
+        const uint16_t colour);
+
+/**
+ * @brief Fills a rectangle of 32-bit pixels
+ * @param p_dst      first pixel
+ * @param dst_stride bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ * @param colour     pixel value
+ */
+void r_pixel_fill32(void * const p_dst, const uint32_t dst_stride, const uint32_t width, const uint32_t height,
+        const uint32_t colour);
+
+/**
+ * @brief Copies a rectangle between buffers of any pixel size
+ * @param p_dst      first destination pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first source pixel
+ * @param src_stride source bytes per line
+ * @param bytes      bytes per line to copy
+ * @param height     lines
+ */
+void r_pixel_copy(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t bytes, const uint32_t height);
+
+/**
+ * @brief Blends ARGB8888 source pixels over RGB565 destination pixels
+ *        (Porter-Duff source over destination)
+ * @param p_dst      first RGB565 pixel, read and written
+ * @param dst_stride destination bytes per line
+ * @param p_src      first ARGB8888 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ */
+void r_pixel_blend_argb8888_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Blends ARGB4444 source pixels over RGB565 destination pixels
+ *        (Porter-Duff source over destination)
+ * @param p_dst      first RGB565 pixel, read and written
+ * @param dst_stride destination bytes per line
+ * @param p_src      first ARGB4444 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ */
+void r_pixel_blend_argb4444_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts RGB565 to RGB888, replicating the top bits into the low bits
+ * @param p_dst      first RGB888 pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first RGB565 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ */
+void r_pixel_rgb565_to_rgb888(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts RGB888 (or ARGB8888, ignoring A) to RGB565 by truncation
+ * @param p_dst      first RGB565 pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first RGB888 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line
+ * @param height     lines
+ */
+void r_pixel_rgb888_to_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts RGB888 to YCbCr422. The chroma of each pair of pixels is
+ *        taken from their average colour.
+ * @param p_dst      first YCbCr422 pixel pair
+ * @param dst_stride destination bytes per line
+ * @param p_src      first RGB888 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line, even
+ * @param height     lines
+ */
+void r_pixel_rgb888_to_ycbcr422(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts YCbCr422 to RGB888
+ * @param p_dst      first RGB888 pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first YCbCr422 pixel pair
+ * @param src_stride source bytes per line
+ * @param width      pixels per line, even
+ * @param height     lines
+ */
+void r_pixel_ycbcr422_to_rgb888(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts RGB565 to YCbCr422, as r_pixel_rgb565_to_rgb888
+ *        followed by r_pixel_rgb888_to_ycbcr422
+ * @param p_dst      first YCbCr422 pixel pair
+ * @param dst_stride destination bytes per line
+ * @param p_src      first RGB565 pixel
+ * @param src_stride source bytes per line
+ * @param width      pixels per line, even
+ * @param height     lines
+ */
+void r_pixel_rgb565_to_ycbcr422(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Converts YCbCr422 to RGB565, as r_pixel_ycbcr422_to_rgb888
+ *        followed by r_pixel_rgb888_to_rgb565
+ * @param p_dst      first RGB565 pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first YCbCr422 pixel pair
+ * @param src_stride source bytes per line
+ * @param width      pixels per line, even
+ * @param height     lines
+ */
+void r_pixel_ycbcr422_to_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height);
+
+/**
+ * @brief Rotates a rectangle of 16-bit pixels into another buffer
+ * @param p_dst      first destination pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first source pixel
+ * @param src_stride source bytes per line
+ * @param width      source pixels per line
+ * @param height     source lines
+ * @param rotate     rotation
+ */
+void r_pixel_rotate16(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const e_pixel_rotate_t rotate);
+
+/**
+ * @brief Rotates a rectangle of 32-bit pixels into another buffer
+ * @param p_dst      first destination pixel
+ * @param dst_stride destination bytes per line
+ * @param p_src      first source pixel
+ * @param src_stride source bytes per line
+ * @param width      source pixels per line
+ * @param height     source lines
+ * @param rotate     rotation
+ */
+void r_pixel_rotate32(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const e_pixel_rotate_t rotate);
+
+#endif  /* R_PIXEL_H */
@@ -0,0 +1,475 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :    r_compositor.c
+ * @file          r_compositor.c
+ * $Rev:          1.0
+ * $Date:         24.04.2019
+ * @brief         Dirty rectangle tracking for double and triple buffered surfaces
+ ******************************************************************************/
+
+/*******************************************************************************
+ Includes <System Includes>, "Project Includes"
+ *******************************************************************************/
+#include <string.h>
+
+#include "r_typedefs.h"
+
+#include "r_compositor.h"
+#include "r_pixel.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define COMPOSITOR_HISTORY     (COMPOSITOR_MAX_BUFFERS - 1u)
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+
+/*!****************************************************************************
+ * Function Name: rect_area
+ * @brief         Area of a rectangle
+ * @param[in]     p_rect    : rectangle
+ * @retval        pixels
+ ******************************************************************************/
+static uint32_t rect_area(const st_comp_rect_t * const p_rect)
+{
+    return ((uint32_t) p_rect->w * (uint32_t) p_rect->h);
+} /* End of function rect_area() */
+
+/*!****************************************************************************
+ * Function Name: rect_union
+ * @brief         Bounding box of two rectangles
+ * @param[in]     p_a       : rectangle
+ * @param[in]     p_b       : rectangle
+ * @param[out]    p_out     : bounding box
+ * @retval        none
+ ******************************************************************************/
+static void rect_union(const st_comp_rect_t * const p_a, const st_comp_rect_t * const p_b,
+        st_comp_rect_t * const p_out)
+{
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+
+    x0 = (p_a->x < p_b->x) ? p_a->x : p_b->x;
+    y0 = (p_a->y < p_b->y) ? p_a->y : p_b->y;
+    x1 = (((uint32_t) p_a->x + p_a->w) > ((uint32_t) p_b->x + p_b->w)) ?
+            ((uint32_t) p_a->x + p_a->w) : ((uint32_t) p_b->x + p_b->w);
+    y1 = (((uint32_t) p_a->y + p_a->h) > ((uint32_t) p_b->y + p_b->h)) ?
+            ((uint32_t) p_a->y + p_a->h) : ((uint32_t) p_b->y + p_b->h);
+
+    p_out->x = (uint16_t) x0;
+    p_out->y = (uint16_t) y0;
+    p_out->w = (uint16_t) (x1 - x0);
+    p_out->h = (uint16_t) (y1 - y0);
+} /* End of function rect_union() */
+
+/*!****************************************************************************
+ * Function Name: rect_intersect
+ * @brief         Intersection of two rectangles
+ * @param[in]     p_a       : rectangle
+ * @param[in]     p_b       : rectangle
+ * @param[out]    p_out     : intersection, may be NULL
+ * @retval        true if the rectangles overlap
+ ******************************************************************************/
+static bool_t rect_intersect(const st_comp_rect_t * const p_a, const st_comp_rect_t * const p_b,
+        st_comp_rect_t * const p_out)
+{
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+    bool_t overlap;
+
+    x0 = (p_a->x > p_b->x) ? p_a->x : p_b->x;
+    y0 = (p_a->y > p_b->y) ? p_a->y : p_b->y;
+    x1 = (((uint32_t) p_a->x + p_a->w) < ((uint32_t) p_b->x + p_b->w)) ?
+            ((uint32_t) p_a->x + p_a->w) : ((uint32_t) p_b->x + p_b->w);
+    y1 = (((uint32_t) p_a->y + p_a->h) < ((uint32_t) p_b->y + p_b->h)) ?
+            ((uint32_t) p_a->y + p_a->h) : ((uint32_t) p_b->y + p_b->h);
+
+    overlap = ((x0 < x1) && (y0 < y1));
+    if ((true == overlap) && (NULL != p_out))
+    {
+        p_out->x = (uint16_t) x0;
+        p_out->y = (uint16_t) y0;
+        p_out->w = (uint16_t) (x1 - x0);
+        p_out->h = (uint16_t) (y1 - y0);
+    }
+
+    return overlap;
+} /* End of function rect_intersect() */
+
+/*!****************************************************************************
+ * Function Name: rect_contains
+ * @brief         Tests whether a rectangle lies inside another
+ * @param[in]     p_outer   : rectangle
+ * @param[in]     p_inner   : rectangle
+ * @retval        true if p_inner is inside p_outer
+ ******************************************************************************/
+static bool_t rect_contains(const st_comp_rect_t * const p_outer, const st_comp_rect_t * const p_inner)
+{
+    return ((p_inner->x >= p_outer->x) && (p_inner->y >= p_outer->y)
+            && (((uint32_t) p_inner->x + p_inner->w) <= ((uint32_t) p_outer->x + p_outer->w))
+            && (((uint32_t) p_inner->y + p_inner->h) <= ((uint32_t) p_outer->y + p_outer->h)));
+} /* End of function rect_contains() */
+
+/*!****************************************************************************
+ * Function Name: region_add
+ * @brief         Adds a rectangle to a region. Rectangles that overlap it, or
+ *                whose bounding box with it is no larger than the two areas
+ *                together, are merged into it first. When the region is full
+ *                the rectangle is merged with the one that grows least.
+ * @param[in,out] p_region  : region
+ * @param[in]     p_rect    : rectangle
+ * @retval        none
+ ******************************************************************************/
+static void region_add(st_comp_region_t * const p_region, const st_comp_rect_t * const p_rect)
+{
+    st_comp_rect_t rect;
+    st_comp_rect_t bbox;
+    uint32_t i;
+    uint32_t best = 0;
+    uint32_t cost;
+    uint32_t best_cost = 0;
+    bool_t merged;
+
+    rect = *p_rect;
+
+    do
+    {
+        merged = false;
+        for (i = 0; (i < p_region->num) && (false == merged); i++)
+        {
+            rect_union(&rect, &p_region->rect[i], &bbox);
+            if ((true == rect_intersect(&rect, &p_region->rect[i], NULL))
+                    || (rect_area(&bbox) <= (rect_area(&rect) + rect_area(&p_region->rect[i]))))
+            {
+                merged = true;
+            }
+            else if (COMPOSITOR_MAX_RECTS == p_region->num)
+            {
+                /* Full, remember the cheapest merge */
+                cost = rect_area(&bbox) - rect_area(&p_region->rect[i]);
+                if ((0u == i) || (cost < best_cost))
+                {
+                    best = i;
+                    best_cost = cost;
+                }
+            }
+            else
+            {
+                /* Do Nothing */
+            }
+
+            if (true == merged)
+            {
+                best = i;
+            }
+        }
+
+        if ((true == merged) || (COMPOSITOR_MAX_RECTS == p_region->num))
+        {
+            rect_union(&rect, &p_region->rect[best], &rect);
+            p_region->num--;
+            p_region->rect[best] = p_region->rect[p_region->num];
+            merged = true;
+        }
+    } while (true == merged);
+
+    p_region->rect[p_region->num] = rect;
+    p_region->num++;
+} /* End of function region_add() */
+
+/*!****************************************************************************
+ * Function Name: copy_rect
+ * @brief         Copies a rectangle between frame buffers
+ * @param[in]     p_surface : surface
+ * @param[out]    p_dst     : destination frame buffer
+ * @param[in]     p_src     : source frame buffer
+ * @param[in]     p_rect    : area
+ * @retval        bytes copied
+ ******************************************************************************/
+static uint32_t copy_rect(const st_comp_surface_t * const p_surface, uint8_t * const p_dst,
+        const uint8_t * const p_src, const st_comp_rect_t * const p_rect)
+{
+    uint32_t offset;
+    uint32_t len;
+
+    offset = (p_rect->y * p_surface->stride) + (p_rect->x * p_surface->bpp);
+    len = p_rect->w * p_surface->bpp;
+
+    r_pixel_copy(&p_dst[offset], p_surface->stride, &p_src[offset], p_surface->stride, len, p_rect->h);
+
+    return (len * p_rect->h);
+} /* End of function copy_rect() */
+
+/*!****************************************************************************
+ * Function Name: fill_rect
+ * @brief         Fills a rectangle of a frame buffer
+ * @param[in]     p_surface : surface
+ * @param[out]    p_buff    : frame buffer
+ * @param[in]     p_rect    : area
+ * @param[in]     colour    : pixel value
+ * @retval        none
+ ******************************************************************************/
+static void fill_rect(const st_comp_surface_t * const p_surface, uint8_t * const p_buff,
+        const st_comp_rect_t * const p_rect, const uint32_t colour)
+{
+    uint8_t *p_line;
+    uint32_t line;
+    uint32_t i;
+    uint32_t b;
+
+    p_line = &p_buff[(p_rect->y * p_surface->stride) + (p_rect->x * p_surface->bpp)];
+
+    if (2u == p_surface->bpp)
+    {
+        r_pixel_fill16(p_line, p_surface->stride, p_rect->w, p_rect->h, (uint16_t) colour);
+    }
+    else if (4u == p_surface->bpp)
+    {
+        r_pixel_fill32(p_line, p_surface->stride, p_rect->w, p_rect->h, colour);
+    }
+    else
+    {
+        for (line = 0; line < p_rect->h; line++)
+        {
+            for (i = 0; i < p_rect->w; i++)
+            {
+                for (b = 0; b < p_surface->bpp; b++)
+                {
+                    p_line[(i * p_surface->bpp) + b] = (uint8_t) (colour >> (b * 8u));
+                }
+            }
+            p_line += p_surface->stride;
+        }
+    }
+} /* End of function fill_rect() */
+
+/*!****************************************************************************
+ * Function Name: r_compositor_init
+ * @brief         Initialises a surface
+ * @param[out]    p_surface : surface
+ * @param[in]     width     : width in pixels
+ * @param[in]     height    : height in pixels
+ * @param[in]     stride    : bytes per line
+ * @param[in]     bpp       : bytes per pixel
+ * @retval        none
+ ******************************************************************************/
+void r_compositor_init(st_comp_surface_t * const p_surface, const uint16_t width, const uint16_t height,
+        const uint32_t stride, const uint32_t bpp)
+{
+    st_comp_rect_t full;
+
+    memset(p_surface, 0, sizeof(st_comp_surface_t));
+    p_surface->width = width;
+    p_surface->height = height;
+    p_surface->stride = stride;
+    p_surface->bpp = bpp;
+
+    full.x = 0;
+    full.y = 0;
+    full.w = width;
+    full.h = height;
+    region_add(&p_surface->dirty, &full);
+} /* End of function r_compositor_init() */
+
+/*!****************************************************************************
+ * Function Name: r_compositor_invalidate
+ * @brief         Marks an area as needing to be redrawn
+ * @param[in]     p_surface : surface
+ * @param[in]     p_rect    : area
+ * @retval        none
+ ******************************************************************************/
+void r_compositor_invalidate(st_comp_surface_t * const p_surface, const st_comp_rect_t * const p_rect)
+{
+    st_comp_rect_t full;
+    st_comp_rect_t clipped;
+
+    full.x = 0;
+    full.y = 0;
+    full.w = p_surface->width;
+    full.h = p_surface->height;
+
+    if (true == rect_intersect(&full, p_rect, &clipped))
+    {
+        region_add(&p_surface->dirty, &clipped);
+    }
+} /* End of function r_compositor_invalidate() */
+
+/*!****************************************************************************
+ * Function Name: r_compositor_begin
+ * @brief         Starts a frame, bringing p_buff up to date with the last
+ *                completed frame outside the invalid area
+ * @param[in]     p_surface : surface
+ * @param[in]     p_buff    : frame buffer to draw into
+ * @retval        invalid area of the frame
+ ******************************************************************************/
+const st_comp_region_t * r_compositor_begin(st_comp_surface_t * const p_surface, void * const p_buff)
+{
+    st_comp_region_t stale;
+    st_comp_rect_t full;
+    uint32_t index;
+    uint32_t i;
+    uint32_t j;
+    uint32_t f;
+    bool_t covered;
+
+    /* Find the buffer, replacing the least recently drawn one if it is new */
+    index = 0;
+    for (i = 0; i < COMPOSITOR_MAX_BUFFERS; i++)
+    {
+        if (p_surface->p_buff[i] == p_buff)
+        {
+            index = i;
+            break;
+        }
+        if (p_surface->drawn[i] < p_surface->drawn[index])
+        {
+            index = i;
+        }
+    }
+    if (p_surface->p_buff[index] != p_buff)
+    {
+        p_surface->p_buff[index] = p_buff;
+        p_surface->drawn[index] = 0;
+    }
+
+    p_surface->p_back = p_buff;
+    p_surface->stats.copy_bytes = 0;
+
+    if ((NULL != p_surface->p_front) && (p_surface->p_front != p_buff))
+    {
+        stale.num = 0;
+
+        if ((0u == p_surface->drawn[index]) || ((p_surface->frame - p_surface->drawn[index]) > COMPOSITOR_HISTORY))
+        {
+            full.x = 0;
+            full.y = 0;
+            full.w = p_surface->width;
+            full.h = p_surface->height;
+            region_add(&stale, &full);
+        }
+        else
+        {
+            /* Frames completed since p_buff was last drawn */
+            for (f = p_surface->drawn[index]; f < p_surface->frame; f++)
+            {
+                for (i = 0; i < p_surface->history[f % COMPOSITOR_HISTORY].num; i++)
+                {
+                    region_add(&stale, &p_surface->history[f % COMPOSITOR_HISTORY].rect[i]);
+                }
+            }
+        }
+
+        for (i = 0; i < stale.num; i++)
+        {
+            covered = false;
+            for (j = 0; j < p_surface->dirty.num; j++)
+            {
+                if (true == rect_contains(&p_surface->dirty.rect[j], &stale.rect[i]))
+                {
+                    covered = true;
+                }
+            }
+            if (false == covered)
+            {
+                p_surface->stats.copy_bytes += copy_rect(p_surface, p_buff, p_surface->p_front, &stale.rect[i]);
+            }
+        }
+    }
+
+    return (&p_surface->dirty);
+} /* End of function r_compositor_begin() */
+
+/*!****************************************************************************
+ * Function Name: r_compositor_end
+ * @brief         Ends the frame started by r_compositor_begin
+ * @param[in]     p_surface : surface
+ * @param[out]    p_stats   : memory traffic of the frame, may be NULL
+ * @retval        none
+ ******************************************************************************/
+void r_compositor_end(st_comp_surface_t * const p_surface, st_comp_stats_t * const p_stats)
+{
+    uint32_t i;
+
+    p_surface->stats.draw_bytes = 0;
+    for (i = 0; i < p_surface->dirty.num; i++)
+    {
+        p_surface->stats.draw_bytes += rect_area(&p_surface->dirty.rect[i]) * p_surface->bpp;
+    }
+
+    p_surface->history[p_surface->frame % COMPOSITOR_HISTORY] = p_surface->dirty;
+    p_surface->dirty.num = 0;
+    p_surface->frame++;
+
+    for (i = 0; i < COMPOSITOR_MAX_BUFFERS; i++)
+    {
+        if (p_surface->p_buff[i] == p_surface->p_back)
+        {
+            p_surface->drawn[i] = p_surface->frame;
+        }
+    }
+    p_surface->p_front = p_surface->p_back;
+    p_surface->p_back = NULL;
+
+    if (NULL != p_stats)
+    {
+        *p_stats = p_surface->stats;
+    }
+} /* End of function r_compositor_end() */
+
+/*!****************************************************************************
+ * Function Name: r_compositor_fill
+ * @brief         Fills a rectangle of the frame being drawn, clipped to the
+ *                invalid area
+ * @param[in]     p_surface : surface
+ * @param[in]     p_rect    : area
+ * @param[in]     colour    : pixel value
+ * @retval        none
+ ******************************************************************************/
+void r_compositor_fill(st_comp_surface_t * const p_surface, const st_comp_rect_t * const p_rect,
+        const uint32_t colour)
+{
+    st_comp_rect_t clipped;
+    uint32_t i;
+
+    if (NULL != p_surface->p_back)
+    {
+        for (i = 0; i < p_surface->dirty.num; i++)
+        {
+            if (true == rect_intersect(&p_surface->dirty.rect[i], p_rect, &clipped))
+            {
+                fill_rect(p_surface, p_surface->p_back, &clipped, colour);
+            }
+        }
+    }
+} /* End of function r_compositor_fill() */
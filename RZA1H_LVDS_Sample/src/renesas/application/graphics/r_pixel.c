@@ -0,0 +1,867 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :    r_pixel.c
+ * @file          r_pixel.c
+ * $Rev:          1.0
+ * $Date:         24.04.2019
+ * @brief         2D pixel operations on frame buffers
+ ******************************************************************************/
+
+/*******************************************************************************
+ Includes <System Includes>, "Project Includes"
+ *******************************************************************************/
+#include <string.h>
+
+#include "r_typedefs.h"
+
+#include "r_pixel.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+
+/* Full range BT.601 in 8 fractional bits */
+#define PIXEL_Y_R           (77)
+#define PIXEL_Y_G           (150)
+#define PIXEL_Y_B           (29)
+#define PIXEL_CB_R          (43)
+#define PIXEL_CB_G          (85)
+#define PIXEL_CB_B          (128)
+#define PIXEL_CR_R          (128)
+#define PIXEL_CR_G          (107)
+#define PIXEL_CR_B          (21)
+
+/* Inverse in 6 fractional bits, so that all terms fit in 16 bits */
+#define PIXEL_R_CR          (90)
+#define PIXEL_G_CB          (22)
+#define PIXEL_G_CR          (46)
+#define PIXEL_B_CB          (113)
+
+#define PIXEL_TILE          (8u)
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+
+/*!****************************************************************************
+ * Function Name: div255
+ * @brief         Divides by 255 with rounding, exact for x <= 255 * 255
+ * @param[in]     x         : dividend
+ * @retval        quotient
+ ******************************************************************************/
+static uint32_t div255(const uint32_t x)
+{
+    return ((x + 128u + ((x + 128u) >> 8)) >> 8);
+} /* End of function div255() */
+
+/*!****************************************************************************
+ * Function Name: pack565
+ * @brief         Packs 8-bit components into RGB565 by truncation
+ * @param[in]     r         : red
+ * @param[in]     g         : green
+ * @param[in]     b         : blue
+ * @retval        RGB565 pixel
+ ******************************************************************************/
+static uint16_t pack565(const uint32_t r, const uint32_t g, const uint32_t b)
+{
+    return (uint16_t) (((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
+} /* End of function pack565() */
+
+/*!****************************************************************************
+ * Function Name: unpack565
+ * @brief         Expands RGB565 into 8-bit components
+ * @param[in]     pix       : RGB565 pixel
+ * @param[out]    p_rgb     : red, green and blue
+ * @retval        none
+ ******************************************************************************/
+static void unpack565(const uint32_t pix, uint32_t * const p_rgb)
+{
+    uint32_t r5;
+    uint32_t g6;
+    uint32_t b5;
+
+    r5 = (pix >> 11) & 0x1Fu;
+    g6 = (pix >> 5) & 0x3Fu;
+    b5 = pix & 0x1Fu;
+    p_rgb[0] = (r5 << 3) | (r5 >> 2);
+    p_rgb[1] = (g6 << 2) | (g6 >> 4);
+    p_rgb[2] = (b5 << 3) | (b5 >> 2);
+} /* End of function unpack565() */
+
+/*!****************************************************************************
+ * Function Name: blend565
+ * @brief         Blends 8-bit components over an RGB565 pixel
+ * @param[in]     dst       : RGB565 pixel
+ * @param[in]     a         : source alpha
+ * @param[in]     r         : source red
+ * @param[in]     g         : source green
+ * @param[in]     b         : source blue
+ * @retval        RGB565 pixel
+ ******************************************************************************/
+static uint16_t blend565(const uint32_t dst, const uint32_t a, const uint32_t r, const uint32_t g,
+        const uint32_t b)
+{
+    uint32_t d[3];
+
+    unpack565(dst, d);
+    return pack565(div255((r * a) + (d[0] * (255u - a))), div255((g * a) + (d[1] * (255u - a))),
+            div255((b * a) + (d[2] * (255u - a))));
+} /* End of function blend565() */
+
+/*!****************************************************************************
+ * Function Name: chroma
+ * @brief         Scales a chroma sum to an offset 8-bit value
+ * @param[in]     t         : sum in 8 fractional bits, -32640 to 32640
+ * @retval        Cb or Cr
+ ******************************************************************************/
+static uint8_t chroma(const int32_t t)
+{
+    int32_t v;
+
+    /* Kept positive so that the shift rounds down */
+    v = (int32_t) ((uint32_t) (t + 32896) >> 8) - 128;
+    if (v > 127)
+    {
+        v = 127;
+    }
+    return (uint8_t) (v + 128);
+} /* End of function chroma() */
+
+/*!****************************************************************************
+ * Function Name: luma
+ * @brief         Luma of 8-bit components
+ * @param[in]     r         : red
+ * @param[in]     g         : green
+ * @param[in]     b         : blue
+ * @retval        Y
+ ******************************************************************************/
+static uint8_t luma(const uint32_t r, const uint32_t g, const uint32_t b)
+{
+    return (uint8_t) (((PIXEL_Y_R * r) + (PIXEL_Y_G * g) + (PIXEL_Y_B * b) + 128u) >> 8);
+} /* End of function luma() */
+
+/*!****************************************************************************
+ * Function Name: rgb_to_ycc_pair
+ * @brief         Converts two pixels of 8-bit components to Y0 Cb Y1 Cr
+ * @param[in]     p_rgb0    : red, green and blue of the first pixel
+ * @param[in]     p_rgb1    : red, green and blue of the second pixel
+ * @param[out]    p_ycc     : 4 bytes
+ * @retval        none
+ ******************************************************************************/
+static void rgb_to_ycc_pair(const uint32_t * const p_rgb0, const uint32_t * const p_rgb1, uint8_t * const p_ycc)
+{
+    int32_t r;
+    int32_t g;
+    int32_t b;
+
+    r = (int32_t) ((p_rgb0[0] + p_rgb1[0] + 1u) >> 1);
+    g = (int32_t) ((p_rgb0[1] + p_rgb1[1] + 1u) >> 1);
+    b = (int32_t) ((p_rgb0[2] + p_rgb1[2] + 1u) >> 1);
+
+    p_ycc[0] = luma(p_rgb0[0], p_rgb0[1], p_rgb0[2]);
+    p_ycc[1] = chroma((PIXEL_CB_B * b) - (PIXEL_CB_R * r) - (PIXEL_CB_G * g));
+    p_ycc[2] = luma(p_rgb1[0], p_rgb1[1], p_rgb1[2]);
+    p_ycc[3] = chroma((PIXEL_CR_R * r) - (PIXEL_CR_G * g) - (PIXEL_CR_B * b));
+} /* End of function rgb_to_ycc_pair() */
+
+/*!****************************************************************************
+ * Function Name: clamp_q6
+ * @brief         Rounds a component in 6 fractional bits to 0 - 255
+ * @param[in]     t         : component, at least -16416
+ * @retval        component
+ ******************************************************************************/
+static uint32_t clamp_q6(const int32_t t)
+{
+    int32_t v;
+
+    /* Kept positive so that the shift rounds down */
+    v = (int32_t) ((uint32_t) (t + 32 + 16384) >> 6) - 256;
+    if (v < 0)
+    {
+        v = 0;
+    }
+    if (v > 255)
+    {
+        v = 255;
+    }
+    return (uint32_t) v;
+} /* End of function clamp_q6() */
+
+/*!****************************************************************************
+ * Function Name: ycc_to_rgb_pair
+ * @brief         Converts Y0 Cb Y1 Cr to two pixels of 8-bit components
+ * @param[in]     p_ycc     : 4 bytes
+ * @param[out]    p_rgb0    : red, green and blue of the first pixel
+ * @param[out]    p_rgb1    : red, green and blue of the second pixel
+ * @retval        none
+ ******************************************************************************/
+static void ycc_to_rgb_pair(const uint8_t * const p_ycc, uint32_t * const p_rgb0, uint32_t * const p_rgb1)
+{
+    int32_t y0;
+    int32_t y1;
+    int32_t cb;
+    int32_t cr;
+
+    y0 = (int32_t) p_ycc[0] * 64;
+    y1 = (int32_t) p_ycc[2] * 64;
+    cb = (int32_t) p_ycc[1] - 128;
+    cr = (int32_t) p_ycc[3] - 128;
+
+    p_rgb0[0] = clamp_q6(y0 + (PIXEL_R_CR * cr));
+    p_rgb0[1] = clamp_q6((y0 - (PIXEL_G_CB * cb)) - (PIXEL_G_CR * cr));
+    p_rgb0[2] = clamp_q6(y0 + (PIXEL_B_CB * cb));
+    p_rgb1[0] = clamp_q6(y1 + (PIXEL_R_CR * cr));
+    p_rgb1[1] = clamp_q6((y1 - (PIXEL_G_CB * cb)) - (PIXEL_G_CR * cr));
+    p_rgb1[2] = clamp_q6(y1 + (PIXEL_B_CB * cb));
+} /* End of function ycc_to_rgb_pair() */
+
+/*!****************************************************************************
+ * Function Name: pack888
+ * @brief         Packs 8-bit components into RGB888
+ * @param[in]     p_rgb     : red, green and blue
+ * @retval        RGB888 pixel
+ ******************************************************************************/
+static uint32_t pack888(const uint32_t * const p_rgb)
+{
+    return (0xFF000000u | (p_rgb[0] << 16) | (p_rgb[1] << 8) | p_rgb[2]);
+} /* End of function pack888() */
+
+/*!****************************************************************************
+ * Function Name: unpack888
+ * @brief         Splits RGB888 into 8-bit components
+ * @param[in]     pix       : RGB888 pixel
+ * @param[out]    p_rgb     : red, green and blue
+ * @retval        none
+ ******************************************************************************/
+static void unpack888(const uint32_t pix, uint32_t * const p_rgb)
+{
+    p_rgb[0] = (pix >> 16) & 0xFFu;
+    p_rgb[1] = (pix >> 8) & 0xFFu;
+    p_rgb[2] = pix & 0xFFu;
+} /* End of function unpack888() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_fill16
+ * @brief         Fills a rectangle of 16-bit pixels
+ * @param[out]    p_dst      : first pixel
+ * @param[in]     dst_stride : bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @param[in]     colour     : pixel value
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_fill16(void * const p_dst, const uint32_t dst_stride, const uint32_t width, const uint32_t height,
+        const uint16_t colour)
+{
+    uint8_t *p_line;
+    uint16_t *p_pix;
+    uint32_t line;
+    uint32_t x;
+
+    p_line = (uint8_t *) p_dst;
+    for (line = 0; line < height; line++)
+    {
+        p_pix = (uint16_t *) p_line;
+        for (x = 0; x < width; x++)
+        {
+            p_pix[x] = colour;
+        }
+        p_line += dst_stride;
+    }
+} /* End of function r_pixel_fill16() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_fill32
+ * @brief         Fills a rectangle of 32-bit pixels
+ * @param[out]    p_dst      : first pixel
+ * @param[in]     dst_stride : bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @param[in]     colour     : pixel value
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_fill32(void * const p_dst, const uint32_t dst_stride, const uint32_t width, const uint32_t height,
+        const uint32_t colour)
+{
+    uint8_t *p_line;
+    uint32_t *p_pix;
+    uint32_t line;
+    uint32_t x;
+
+    p_line = (uint8_t *) p_dst;
+    for (line = 0; line < height; line++)
+    {
+        p_pix = (uint32_t *) p_line;
+        for (x = 0; x < width; x++)
+        {
+            p_pix[x] = colour;
+        }
+        p_line += dst_stride;
+    }
+} /* End of function r_pixel_fill32() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_copy
+ * @brief         Copies a rectangle between buffers
+ * @param[out]    p_dst      : first destination pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     bytes      : bytes per line to copy
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_copy(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t bytes, const uint32_t height)
+{
+    uint8_t *p_d;
+    const uint8_t *p_s;
+    uint32_t line;
+
+    p_d = (uint8_t *) p_dst;
+    p_s = (const uint8_t *) p_src;
+    for (line = 0; line < height; line++)
+    {
+        memcpy(p_d, p_s, bytes);
+        p_d += dst_stride;
+        p_s += src_stride;
+    }
+} /* End of function r_pixel_copy() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_blend_argb8888_rgb565
+ * @brief         Blends ARGB8888 over RGB565
+ * @param[in,out] p_dst      : first RGB565 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first ARGB8888 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_blend_argb8888_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint16_t *p_d;
+    const uint32_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t s;
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint16_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint32_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; x < width; x++)
+        {
+            s = p_s[x];
+            p_d[x] = blend565(p_d[x], s >> 24, (s >> 16) & 0xFFu, (s >> 8) & 0xFFu, s & 0xFFu);
+        }
+    }
+} /* End of function r_pixel_blend_argb8888_rgb565() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_blend_argb4444_rgb565
+ * @brief         Blends ARGB4444 over RGB565
+ * @param[in,out] p_dst      : first RGB565 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first ARGB4444 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_blend_argb4444_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint16_t *p_d;
+    const uint16_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t s;
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint16_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint16_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; x < width; x++)
+        {
+            s = p_s[x];
+            p_d[x] = blend565(p_d[x], ((s >> 12) & 0xFu) * 17u, ((s >> 8) & 0xFu) * 17u, ((s >> 4) & 0xFu) * 17u,
+                    (s & 0xFu) * 17u);
+        }
+    }
+} /* End of function r_pixel_blend_argb4444_rgb565() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rgb565_to_rgb888
+ * @brief         Converts RGB565 to RGB888
+ * @param[out]    p_dst      : first RGB888 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first RGB565 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rgb565_to_rgb888(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint32_t *p_d;
+    const uint16_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint32_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint16_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; x < width; x++)
+        {
+            unpack565(p_s[x], rgb);
+            p_d[x] = pack888(rgb);
+        }
+    }
+} /* End of function r_pixel_rgb565_to_rgb888() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rgb888_to_rgb565
+ * @brief         Converts RGB888 to RGB565
+ * @param[out]    p_dst      : first RGB565 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first RGB888 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rgb888_to_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint16_t *p_d;
+    const uint32_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint16_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint32_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; x < width; x++)
+        {
+            unpack888(p_s[x], rgb);
+            p_d[x] = pack565(rgb[0], rgb[1], rgb[2]);
+        }
+    }
+} /* End of function r_pixel_rgb888_to_rgb565() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rgb888_to_ycbcr422
+ * @brief         Converts RGB888 to YCbCr422
+ * @param[out]    p_dst      : first YCbCr422 pixel pair
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first RGB888 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rgb888_to_ycbcr422(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint8_t *p_d;
+    const uint32_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb0[3];
+    uint32_t rgb1[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint8_t *) p_dst + (line * dst_stride);
+        p_s = (const uint32_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; (x + 2u) <= width; x += 2u)
+        {
+            unpack888(p_s[x], rgb0);
+            unpack888(p_s[x + 1u], rgb1);
+            rgb_to_ycc_pair(rgb0, rgb1, &p_d[x * 2u]);
+        }
+    }
+} /* End of function r_pixel_rgb888_to_ycbcr422() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_ycbcr422_to_rgb888
+ * @brief         Converts YCbCr422 to RGB888
+ * @param[out]    p_dst      : first RGB888 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first YCbCr422 pixel pair
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_ycbcr422_to_rgb888(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint32_t *p_d;
+    const uint8_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb0[3];
+    uint32_t rgb1[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint32_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint8_t *) p_src + (line * src_stride);
+        for (x = 0; (x + 2u) <= width; x += 2u)
+        {
+            ycc_to_rgb_pair(&p_s[x * 2u], rgb0, rgb1);
+            p_d[x] = pack888(rgb0);
+            p_d[x + 1u] = pack888(rgb1);
+        }
+    }
+} /* End of function r_pixel_ycbcr422_to_rgb888() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rgb565_to_ycbcr422
+ * @brief         Converts RGB565 to YCbCr422
+ * @param[out]    p_dst      : first YCbCr422 pixel pair
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first RGB565 pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rgb565_to_ycbcr422(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint8_t *p_d;
+    const uint16_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb0[3];
+    uint32_t rgb1[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint8_t *) p_dst + (line * dst_stride);
+        p_s = (const uint16_t *) ((const uint8_t *) p_src + (line * src_stride));
+        for (x = 0; (x + 2u) <= width; x += 2u)
+        {
+            unpack565(p_s[x], rgb0);
+            unpack565(p_s[x + 1u], rgb1);
+            rgb_to_ycc_pair(rgb0, rgb1, &p_d[x * 2u]);
+        }
+    }
+} /* End of function r_pixel_rgb565_to_ycbcr422() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_ycbcr422_to_rgb565
+ * @brief         Converts YCbCr422 to RGB565
+ * @param[out]    p_dst      : first RGB565 pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first YCbCr422 pixel pair
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : pixels per line
+ * @param[in]     height     : lines
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_ycbcr422_to_rgb565(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height)
+{
+    uint16_t *p_d;
+    const uint8_t *p_s;
+    uint32_t line;
+    uint32_t x;
+    uint32_t rgb0[3];
+    uint32_t rgb1[3];
+
+    for (line = 0; line < height; line++)
+    {
+        p_d = (uint16_t *) ((uint8_t *) p_dst + (line * dst_stride));
+        p_s = (const uint8_t *) p_src + (line * src_stride);
+        for (x = 0; (x + 2u) <= width; x += 2u)
+        {
+            ycc_to_rgb_pair(&p_s[x * 2u], rgb0, rgb1);
+            p_d[x] = pack565(rgb0[0], rgb0[1], rgb0[2]);
+            p_d[x + 1u] = pack565(rgb1[0], rgb1[1], rgb1[2]);
+        }
+    }
+} /* End of function r_pixel_ycbcr422_to_rgb565() */
+
+/*!****************************************************************************
+ * Function Name: rotate_block16
+ * @brief         Rotates part of a rectangle of 16-bit pixels
+ * @param[out]    p_dst      : first destination pixel of the whole rectangle
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel of the whole rectangle
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line of the whole rectangle
+ * @param[in]     height     : source lines of the whole rectangle
+ * @param[in]     p_part     : part of the source to rotate
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+static void rotate_block16(uint8_t * const p_dst, const uint32_t dst_stride, const uint8_t * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const uint32_t * const p_part,
+        const e_pixel_rotate_t rotate)
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t dx;
+    uint32_t dy;
+    uint16_t pix;
+
+    for (y = p_part[1]; y < p_part[3]; y++)
+    {
+        for (x = p_part[0]; x < p_part[2]; x++)
+        {
+            pix = ((const uint16_t *) (p_src + (y * src_stride)))[x];
+            if (PIXEL_ROTATE_90 == rotate)
+            {
+                dx = (height - 1u) - y;
+                dy = x;
+            }
+            else if (PIXEL_ROTATE_180 == rotate)
+            {
+                dx = (width - 1u) - x;
+                dy = (height - 1u) - y;
+            }
+            else
+            {
+                dx = y;
+                dy = (width - 1u) - x;
+            }
+            ((uint16_t *) (p_dst + (dy * dst_stride)))[dx] = pix;
+        }
+    }
+} /* End of function rotate_block16() */
+
+/*!****************************************************************************
+ * Function Name: rotate_block32
+ * @brief         Rotates part of a rectangle of 32-bit pixels
+ * @param[out]    p_dst      : first destination pixel of the whole rectangle
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel of the whole rectangle
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line of the whole rectangle
+ * @param[in]     height     : source lines of the whole rectangle
+ * @param[in]     p_part     : part of the source to rotate
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+static void rotate_block32(uint8_t * const p_dst, const uint32_t dst_stride, const uint8_t * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const uint32_t * const p_part,
+        const e_pixel_rotate_t rotate)
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t dx;
+    uint32_t dy;
+    uint32_t pix;
+
+    for (y = p_part[1]; y < p_part[3]; y++)
+    {
+        for (x = p_part[0]; x < p_part[2]; x++)
+        {
+            pix = ((const uint32_t *) (p_src + (y * src_stride)))[x];
+            if (PIXEL_ROTATE_90 == rotate)
+            {
+                dx = (height - 1u) - y;
+                dy = x;
+            }
+            else if (PIXEL_ROTATE_180 == rotate)
+            {
+                dx = (width - 1u) - x;
+                dy = (height - 1u) - y;
+            }
+            else
+            {
+                dx = y;
+                dy = (width - 1u) - x;
+            }
+            ((uint32_t *) (p_dst + (dy * dst_stride)))[dx] = pix;
+        }
+    }
+} /* End of function rotate_block32() */
+
+/*!****************************************************************************
+ * Function Name: rotate_tile16
+ * @brief         Rotates a PIXEL_TILE x PIXEL_TILE tile of 16-bit pixels
+ * @param[out]    p_dst      : first destination pixel of the whole rectangle
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel of the whole rectangle
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line of the whole rectangle
+ * @param[in]     height     : source lines of the whole rectangle
+ * @param[in]     x0         : left of the tile
+ * @param[in]     y0         : top of the tile
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+static void rotate_tile16(uint8_t * const p_dst, const uint32_t dst_stride, const uint8_t * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const uint32_t x0,
+        const uint32_t y0, const e_pixel_rotate_t rotate)
+{
+    uint32_t part[4];
+
+    part[0] = x0;
+    part[1] = y0;
+    part[2] = x0 + PIXEL_TILE;
+    part[3] = y0 + PIXEL_TILE;
+    rotate_block16(p_dst, dst_stride, p_src, src_stride, width, height, part, rotate);
+} /* End of function rotate_tile16() */
+
+/*!****************************************************************************
+ * Function Name: rotate_tile32
+ * @brief         Rotates a PIXEL_TILE x PIXEL_TILE tile of 32-bit pixels
+ * @param[out]    p_dst      : first destination pixel of the whole rectangle
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel of the whole rectangle
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line of the whole rectangle
+ * @param[in]     height     : source lines of the whole rectangle
+ * @param[in]     x0         : left of the tile
+ * @param[in]     y0         : top of the tile
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+static void rotate_tile32(uint8_t * const p_dst, const uint32_t dst_stride, const uint8_t * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const uint32_t x0,
+        const uint32_t y0, const e_pixel_rotate_t rotate)
+{
+    uint32_t part[4];
+
+    part[0] = x0;
+    part[1] = y0;
+    part[2] = x0 + PIXEL_TILE;
+    part[3] = y0 + PIXEL_TILE;
+    rotate_block32(p_dst, dst_stride, p_src, src_stride, width, height, part, rotate);
+} /* End of function rotate_tile32() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rotate16
+ * @brief         Rotates a rectangle of 16-bit pixels. Whole tiles are
+ *                rotated first, keeping the reads and writes of each tile
+ *                within a few cache lines, then the right and bottom edges.
+ * @param[out]    p_dst      : first destination pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line
+ * @param[in]     height     : source lines
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rotate16(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const e_pixel_rotate_t rotate)
+{
+    uint32_t tiled_w;
+    uint32_t tiled_h;
+    uint32_t x;
+    uint32_t y;
+    uint32_t part[4];
+
+    tiled_w = width - (width % PIXEL_TILE);
+    tiled_h = height - (height % PIXEL_TILE);
+
+    for (y = 0; y < tiled_h; y += PIXEL_TILE)
+    {
+        for (x = 0; x < tiled_w; x += PIXEL_TILE)
+        {
+            rotate_tile16((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, x, y,
+                    rotate);
+        }
+    }
+
+    /* Right edge */
+    part[0] = tiled_w;
+    part[1] = 0;
+    part[2] = width;
+    part[3] = tiled_h;
+    rotate_block16((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, part, rotate);
+
+    /* Bottom edge */
+    part[0] = 0;
+    part[1] = tiled_h;
+    part[2] = width;
+    part[3] = height;
+    rotate_block16((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, part, rotate);
+} /* End of function r_pixel_rotate16() */
+
+/*!****************************************************************************
+ * Function Name: r_pixel_rotate32
+ * @brief         Rotates a rectangle of 32-bit pixels, as r_pixel_rotate16
+ * @param[out]    p_dst      : first destination pixel
+ * @param[in]     dst_stride : destination bytes per line
+ * @param[in]     p_src      : first source pixel
+ * @param[in]     src_stride : source bytes per line
+ * @param[in]     width      : source pixels per line
+ * @param[in]     height     : source lines
+ * @param[in]     rotate     : rotation
+ * @retval        none
+ ******************************************************************************/
+void r_pixel_rotate32(void * const p_dst, const uint32_t dst_stride, const void * const p_src,
+        const uint32_t src_stride, const uint32_t width, const uint32_t height, const e_pixel_rotate_t rotate)
+{
+    uint32_t tiled_w;
+    uint32_t tiled_h;
+    uint32_t x;
+    uint32_t y;
+    uint32_t part[4];
+
+    tiled_w = width - (width % PIXEL_TILE);
+    tiled_h = height - (height % PIXEL_TILE);
+
+    for (y = 0; y < tiled_h; y += PIXEL_TILE)
+    {
+        for (x = 0; x < tiled_w; x += PIXEL_TILE)
+        {
+            rotate_tile32((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, x, y,
+                    rotate);
+        }
+    }
+
+    /* Right edge */
+    part[0] = tiled_w;
+    part[1] = 0;
+    part[2] = width;
+    part[3] = tiled_h;
+    rotate_block32((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, part, rotate);
+
+    /* Bottom edge */
+    part[0] = 0;
+    part[1] = tiled_h;
+    part[2] = width;
+    part[3] = height;
+    rotate_block32((uint8_t *) p_dst, dst_stride, (const uint8_t *) p_src, src_stride, width, height, part, rotate);
+} /* End of function r_pixel_rotate32() */
@@ -253,6 +253,17 @@ typedef enum _CTLCODE
     CTL_USBF_SEND_HID_REPORTIN,
     CTL_USBF_START,
     CTL_USBF_STOP,
+    CTL_FILE_CREATE_LINK_MAP,
+    CTL_FILE_DISCARD_LINK_MAP,
+    CTL_ETHER_READ_ZERO_COPY,
+    CTL_ETHER_RELEASE_RX_BUFFER,
+    CTL_ETHER_WRITE_GATHER,
+    CTL_ETHER_READ_BURST,
+    CTL_ETHER_SET_RX_COALESCE,
+    CTL_ETHER_GET_STATISTICS,
+    /* The next read is started and returns without waiting for it, the
+       result is collected with CTL_GET_OVERLAPPED_READ_RESULT */
+    CTL_START_OVERLAPPED_READ,
     /* TODO: add device specific control functions here */
     /* must be last control code, dynamic driver will reuse
        control code from this point forward */
@@ -577,6 +588,81 @@ typedef struct _IDLECB
 /** The control structure for CTL_STREAM_SET_INPUT_PREPARSER */
 typedef void (*PFNPKT)(uint8_t *pbyFrame, uint16_t usLength);
 
+/** Control structure for CTL_ETHER_READ_ZERO_COPY */
+typedef struct _ETZCRX
+{
+    /* Pointer to the frame lent by the driver */
+    uint8_t     *pbyFrame;
+    /* The length of the frame */
+    size_t      stLength;
+    /* The space in front of the frame which can be used by the borrower */
+    size_t      stHeadroom;
+} ETZCRX,
+*PETZCRX;
+
+/** A segment of a frame for CTL_ETHER_WRITE_GATHER */
+typedef struct _ETSEG
+{
+    /* Pointer to the data */
+    uint8_t     *pbyData;
+    /* The length of the data */
+    size_t      stLength;
+} ETSEG,
+*PETSEG;
+
+/** Control structure for CTL_ETHER_WRITE_GATHER */
+typedef struct _ETGTX
+{
+    /* Pointer to the list of segments of the frame */
+    PETSEG      pSegments;
+    /* The number of segments */
+    uint32_t    uiSegments;
+    /* Function called when the segments are no longer needed */
+    void        (*pfnRelease)(void *pvParameter);
+    /* The parameter for the release function */
+    void        *pvParameter;
+} ETGTX,
+*PETGTX;
+
+/** Control structure for CTL_ETHER_READ_BURST */
+typedef struct _ETRXB
+{
+    /* Pointer to the list of frames lent by the driver */
+    PETZCRX     pFrames;
+    /* The size of the list */
+    uint32_t    uiMaxFrames;
+    /* The number of frames lent */
+    uint32_t    uiFrames;
+} ETRXB,
+*PETRXB;
+
+/** Control structure for CTL_ETHER_SET_RX_COALESCE. CTL_ETHER_READ_BURST
+   waits for uiFrames frames or uiTimeOut mS after the first frame */
+typedef struct _ETCOAL
+{
+    uint32_t    uiFrames;
+    uint32_t    uiTimeOut;
+} ETCOAL,
+*PETCOAL;
+
+/** Control structure for CTL_ETHER_GET_STATISTICS */
+typedef struct _ETSTATS
+{
+    uint32_t    uiRxFrames;
+    uint32_t    uiRxErrors;
+    /* Frames discarded by the reader */
+    uint32_t    uiRxDropped;
+    uint32_t    uiRxFifoOverflows;
+    /* Frames lost because every receive descriptor was full */
+    uint32_t    uiRxRingOverruns;
+    uint32_t    uiTxFrames;
+    /* The number of times a frame had to wait for a transmit descriptor */
+    uint32_t    uiTxRingFull;
+    /* Frames dropped after waiting for a transmit descriptor */
+    uint32_t    uiTxDropped;
+} ETSTATS,
+*PETSTATS;
+
 /* TODO: Add device specific control structures here */
 
 /** Version Information for drivers (high or low level little endian) */
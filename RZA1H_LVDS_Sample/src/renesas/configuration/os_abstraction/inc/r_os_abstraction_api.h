@@ -228,6 +228,12 @@ void R_OS_TaskUsesFloatingPoint(void);
 */
 uint32_t   R_OS_GetNumberOfTasks(void);
 
+/** OS Abstraction Get Tick Count Function
+ *  @brief Function to obtain the number of system ticks since the scheduler was started. May be called from an ISR.
+ *  @retval    The system tick count, see OS_SYSTICKS_TO_MS.
+*/
+systime_t  R_OS_GetTickCount(void);
+
 /* Locking management */
 /** OS Abstraction System Lock Function
  *  @brief Function to lock a critical section.
@@ -869,6 +869,31 @@ uint32_t R_OS_GetNumberOfTasks (void)
  End of function R_OS_GetNumberOfTasks
  **********************************************************************************************************************/
 
+/***********************************************************************************************************************
+ * Function Name: R_OS_GetTickCount
+ * Description  : Obtain the number of system ticks since the scheduler was started, callable from an ISR
+ * Arguments    : none
+ * Return Value : system tick count
+ **********************************************************************************************************************/
+systime_t R_OS_GetTickCount (void)
+{
+    systime_t ticks;
+
+    /* Check if we are in an ISR */
+    if (ulPortInterruptNesting)
+    {
+        ticks = (systime_t) xTaskGetTickCountFromISR();
+    }
+    else
+    {
+        ticks = (systime_t) xTaskGetTickCount();
+    }
+    return (ticks);
+}
+/***********************************************************************************************************************
+ End of function R_OS_GetTickCount
+ **********************************************************************************************************************/
+
 /***********************************************************************************************************************
  * Function Name: R_OS_SysLock
  * Description  : Function to lock a critical section.
@@ -164,13 +164,22 @@ static st_mount_table_t gs_mount_table[] =
    {"dma_ssif_wr", (st_r_driver_t *)&g_dmac_driver, R_SC0},
    {"dma_ssif_rd", (st_r_driver_t *)&g_dmac_driver, R_SC1},
 
-   /** USB DMA driver added by USER */
-   {"dma_usb_in", (st_r_driver_t *) &g_dmac_driver, R_SC2},
-   {"dma_usb_out", (st_r_driver_t *) &g_dmac_driver, R_SC3},
+   /** USB DMA channel pool added by USER */
+   {"dma_usb0", (st_r_driver_t *) &g_dmac_driver, R_SC2},
+   {"dma_usb1", (st_r_driver_t *) &g_dmac_driver, R_SC3},
+   {"dma_usb2", (st_r_driver_t *) &g_dmac_driver, R_SC4},
+   {"dma_usb3", (st_r_driver_t *) &g_dmac_driver, R_SC5},
+
+   /** USB function DMA channel added by USER */
+   {"dma_usbf0", (st_r_driver_t *) &g_dmac_driver, R_SC8},
 
 #if R_SELF_INSERT_APP_PMOD
    /** PMOD driver added by USER */
    {"pmod okaya", (st_r_driver_t *)&g_pmod_okaya_lcd_driver, R_SC0},
+
+   /** PMOD SPI DMA added by USER */
+   {"dma_pmod_wr", (st_r_driver_t *)&g_dmac_driver, R_SC6},
+   {"dma_pmod_rd", (st_r_driver_t *)&g_dmac_driver, R_SC7},
 #endif
 
 #if R_SELF_LOAD_MIDDLEWARE_USB_HOST_CONTROLLER
@@ -137,6 +137,9 @@
 
 #define TASK_GRAPHICS_TASK_PRI      (R_OS_TASK_MAIN_TASK_PRI + 1)
 #define TASK_CONSOLE_TASK_PRI       (R_OS_TASK_MAIN_TASK_PRI + 1)
+#define TASK_JPEG_PIPE_PRI          (R_OS_TASK_MAIN_TASK_PRI + 1)
+#define TASK_MJPEG_REC_PRI          (R_OS_TASK_MAIN_TASK_PRI + 1)
+#define TASK_MJPEG_CEU_PRI          (R_OS_TASK_MAIN_TASK_PRI + 2)
 #define TASK_DISK_MANAGER_PRI       (TC_SOFT_ISR_PRIORITY - 9)
 #define TASK_USB_ENMERATOR_PRI      (R_OS_TASK_MAIN_TASK_PRI - 1)
 #define TASK_TCP_IP_CONSOLE_PRI     (R_OS_TASK_MAIN_TASK_PRI - 1)
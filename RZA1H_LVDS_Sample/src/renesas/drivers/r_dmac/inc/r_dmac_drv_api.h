@@ -58,6 +58,9 @@
 /** Unique ID. Assigned by requirements */
 #define R_DRV_DMAC_HLD_UID                (59)
 
+/** Alignment of link mode descriptors, one cache line */
+#define DMAC_LINK_DESCRIPTOR_ALIGN        (32u)
+
 /***********************************************************************************************************************
  Typedef definitions
  **********************************************************************************************************************/
@@ -70,7 +73,9 @@ typedef enum
     CTL_DMAC_ENABLE,                                           /*!< Enable a DMA transfer */
     CTL_DMAC_DISABLE,                                          /*!< Disable a DMA transfer */
     CTL_DMAC_NEXT_TRANSFER,                                    /*!< Set data for following transfer */
-	CTL_DMAC_GET_TRANSFER_BYTE_COUNT                           /*!< Get current value of CRTB register */
+	CTL_DMAC_GET_TRANSFER_BYTE_COUNT,                          /*!< Get current value of CRTB register */
+    CTL_DMAC_LINK_START,                                       /*!< Build and start a link mode descriptor chain */
+    CTL_DMAC_LINK_GET_COMPLETED                                /*!< Get the number of chain descriptors completed */
 } e_ctrl_code_dmac_t;
 
 typedef enum
@@ -149,6 +154,39 @@ typedef struct
     uint32_t count;                                             /*!< DMA Transfer Size */
 } st_r_drv_dmac_next_transfer_t;
 
+/** Link mode descriptor, read from memory by the DMAC.
+ *  Each one must start on a DMAC_LINK_DESCRIPTOR_ALIGN boundary so that the
+ *  driver can clean and invalidate it as a single cache line */
+typedef struct
+{
+    volatile uint32_t header;                                   /*!< LV, LE, WBD and DIM bits */
+    volatile uint32_t source_address;                           /*!< Source Address */
+    volatile uint32_t destination_address;                      /*!< Destination Address */
+    volatile uint32_t count;                                    /*!< DMA Transfer Size */
+    volatile uint32_t chcfg;                                    /*!< CHCFG_n value for this descriptor */
+    volatile uint32_t chitvl;                                   /*!< CHITVL_n value for this descriptor */
+    volatile uint32_t chext;                                    /*!< CHEXT_n value for this descriptor */
+    volatile uint32_t next_link_address;                        /*!< Address of the following descriptor */
+} st_r_drv_dmac_link_descriptor_t;
+
+typedef struct
+{
+    void *source_address;                                       /*!< Source Address */
+    void *destination_address;                                  /*!< Destination Address */
+    uint32_t count;                                             /*!< DMA Transfer Size */
+    bool_t notify;                                              /*!< Interrupt and call p_descriptor_complete when done */
+} st_r_drv_dmac_link_entry_t;
+
+typedef struct
+{
+    st_r_drv_dmac_link_descriptor_t *p_descriptors;             /*!< One per entry, filled in by the driver */
+    const st_r_drv_dmac_link_entry_t *p_entries;                /*!< Transfers, in order */
+    uint32_t num_entries;                                       /*!< Number of entries */
+    bool_t cache_maintenance;                                   /*!< Clean sources and invalidate destinations (memory to memory) */
+    void (*p_descriptor_complete)(uint32_t index);              /*!< Called from the DMA end interrupt, may be NULL */
+    e_r_drv_dmac_err_t err;                                     /*!< error code (see e_r_drv_dmac_err_t) */
+} st_r_drv_dmac_link_chain_t;
+
 /******************************************************************************
  Constant Data
  ******************************************************************************/
@@ -130,6 +130,81 @@ static const st_r_drv_dmac_sc_config_t DMAC_SC_TABLE[] =
             0,
         }
     },
+    { 2,  /* USB DMA pool */
+        {
+            DMA_RS_USB0_DMA1_RX,
+            DMA_DATA_SIZE_4,
+            DMA_DATA_SIZE_4,
+            DMA_ADDRESS_INCREMENT,
+            DMA_ADDRESS_FIX,
+            DMA_REQUEST_SOURCE,
+            NULL,
+            NULL,
+            0x00000000,
+            0x00000000,
+            0,
+        }
+    },
+    { 3,  /* USB DMA pool */
+        {
+            DMA_RS_USB0_DMA1_TX,
+            DMA_DATA_SIZE_4,
+            DMA_DATA_SIZE_4,
+            DMA_ADDRESS_INCREMENT,
+            DMA_ADDRESS_FIX,
+            DMA_REQUEST_SOURCE,
+            NULL,
+            NULL,
+            0x00000000,
+            0x00000000,
+            0,
+        }
+    },
+    { 6,  /* PMOD LCD SPI write */
+        {
+            DMA_RS_SPTI1,
+            DMA_DATA_SIZE_2,
+            DMA_DATA_SIZE_2,
+            DMA_ADDRESS_INCREMENT,
+            DMA_ADDRESS_FIX,
+            DMA_REQUEST_DESTINATION,
+            NULL,
+            NULL,
+            0x00000000,
+            0x00000000,
+            0,
+        }
+    },
+    { 7,  /* PMOD LCD SPI read, discarded */
+        {
+            DMA_RS_SPRI1,
+            DMA_DATA_SIZE_2,
+            DMA_DATA_SIZE_2,
+            DMA_ADDRESS_FIX,
+            DMA_ADDRESS_FIX,
+            DMA_REQUEST_SOURCE,
+            NULL,
+            NULL,
+            0x00000000,
+            0x00000000,
+            0,
+        }
+    },
+    { 8,  /* USB function D1FIFO */
+        {
+            DMA_RS_USB0_DMA0_TX_D1FIFO,
+            DMA_DATA_SIZE_4,
+            DMA_DATA_SIZE_4,
+            DMA_ADDRESS_INCREMENT,
+            DMA_ADDRESS_FIX,
+            DMA_REQUEST_SOURCE,
+            NULL,
+            NULL,
+            0x00000000,
+            0x00000000,
+            0,
+        }
+    },
 };
 
 #endif /* R_DMAC_INC_R_DMAC_DRV_SC_CFG_H_ */
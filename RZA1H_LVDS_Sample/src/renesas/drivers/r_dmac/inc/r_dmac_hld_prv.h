@@ -60,5 +60,6 @@ void r_dmac_hld_prv_dma_uninit (void);
 e_r_drv_dmac_err_t r_dmac_hld_prv_dma_enable (uint_t sc_config_index);
 e_r_drv_dmac_err_t r_dmac_hld_prv_dma_disable (uint_t sc_config_index, uint32_t *remaining_data_length);
 int_t r_dmac_hld_prv_open (uint_t sc_config_index);
+e_r_drv_dmac_err_t r_dmac_hld_prv_link_start (uint_t sc_config_index, st_r_drv_dmac_link_chain_t *p_chain);
 
 #endif /* DRIVERS_R_DMAC_INC_R_DMAC_HLD_PRV_H_ */
@@ -72,6 +72,10 @@ typedef enum
 	DMA_RS_USB0_DMA0_RX,
 	DMA_RS_USB0_DMA1_TX,
 	DMA_RS_USB0_DMA1_RX,
+	DMA_RS_USB0_DMA0_RX_D0FIFO,             /*!< USB D0FIFO used for an IN transfer */
+	DMA_RS_USB0_DMA0_TX_D1FIFO,             /*!< USB D1FIFO used for an OUT transfer */
+	DMA_RS_USB0_DMA1_RX_D0FIFO,
+	DMA_RS_USB0_DMA1_TX_D1FIFO,
 	DMA_RS_ADI,
 	DMA_RS_IEBBTD,
 	DMA_RS_IEBBTV,
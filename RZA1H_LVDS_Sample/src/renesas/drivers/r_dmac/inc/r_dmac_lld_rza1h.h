@@ -88,6 +88,8 @@ void R_DMAC_ErrInterruptHandler (uint32_t int_sense);
 int_t R_DMAC_GetChannel (uint_t sc_config_index);
 e_r_drv_dmac_err_t R_DMAC_SetNextTransfer (uint_t sc_config_index, void *source_address, void *destination_address, uint32_t count);
 e_r_drv_dmac_err_t R_DMAC_GetCrtbRegisterValue(uint_t sc_config_index, uint32_t * p_crtb_value);
+e_r_drv_dmac_err_t R_DMAC_LinkStart (uint_t sc_config_index, st_r_drv_dmac_link_chain_t *p_chain);
+e_r_drv_dmac_err_t R_DMAC_LinkGetCompleted (uint_t sc_config_index, uint32_t *p_completed);
 
 void R_DMAC_InitialiseInterrupts (void);
 void R_DMAC_UnInitialiseInterrupts (void);
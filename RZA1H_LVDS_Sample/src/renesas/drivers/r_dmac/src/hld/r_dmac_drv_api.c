@@ -454,6 +454,44 @@ static int_t dmac_hld_control (st_stream_ptr_t p_stream, uint32_t ctl_code, void
             break;
         }
 
+        case CTL_DMAC_LINK_START:
+        {
+            if (NULL != p_ctl_struct)
+            {
+                /* assign new pointer for readability */
+                st_r_drv_dmac_link_chain_t *p_chain = (st_r_drv_dmac_link_chain_t *) p_ctl_struct;
+
+                dmac_err = r_dmac_hld_prv_link_start(sc_config_index, p_chain);
+                p_chain->err = dmac_err;
+
+                if (DMAC_SUCCESS == dmac_err)
+                {
+                    ret_value = DRV_SUCCESS;
+                }
+                else
+                {
+                    ret_value = DRV_ERROR;
+                }
+            }
+            break;
+        }
+
+        case CTL_DMAC_LINK_GET_COMPLETED:
+        {
+            if (NULL != p_ctl_struct)
+            {
+                if (R_DMAC_LinkGetCompleted(sc_config_index, (uint32_t *) p_ctl_struct) == DMAC_SUCCESS)
+                {
+                    ret_value = DRV_SUCCESS;
+                }
+                else
+                {
+                    ret_value = DRV_ERROR;
+                }
+            }
+            break;
+        }
+
         default:
         {
             TRACE(("DMAC Driver: Unknown control code\r\n"));
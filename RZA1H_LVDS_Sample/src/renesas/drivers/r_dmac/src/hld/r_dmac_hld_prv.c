@@ -116,6 +116,24 @@ e_r_drv_dmac_err_t r_dmac_hld_prv_dma_disable (uint_t sc_config_index, uint32_t
  End of function r_dmac_hld_prv_dma_disable
  **********************************************************************************************************************/
 
+/**
+ *                 r_dmac_hld_prv_link_start
+ * @brief          Start a link mode descriptor chain
+ * @param[in]      sc_config_index: the SC config index
+ * @param[in]      p_chain: the chain to build and start
+ * @retval         DRV_SUCCESS: Success
+ *                 DRV_ERROR:   Failure
+ */
+e_r_drv_dmac_err_t r_dmac_hld_prv_link_start (uint_t sc_config_index, st_r_drv_dmac_link_chain_t *p_chain)
+{
+    R_DMAC_EnableChannelInterrupt(sc_config_index);
+
+    return R_DMAC_LinkStart(sc_config_index, p_chain);
+}
+/***********************************************************************************************************************
+ End of function r_dmac_hld_prv_link_start
+ **********************************************************************************************************************/
+
 /**
  *                 r_dmac_hld_prv_open
  * @brief          Configures a DMA channel according to the Smart Configurator
@@ -48,6 +48,7 @@
 #include "r_dmac_hld_prv.h"
 
 #include "r_intc.h"                 /* INTC low layer driver used in HLD */
+#include "r_cache_l1_rz_api.h"      /* descriptor and memory to memory buffer maintenance */
 
 #include "control.h"
 
@@ -107,6 +108,7 @@
 #define DMAC_PRV_CHCTRL_SET_SETEN            (0x00000001U)
 
 /* CHCFG */
+#define DMAC_PRV_CHCFG_SET_DMS               (0x80000000U)
 #define DMAC_PRV_CHCFG_SET_REN               (0x40000000U)
 #define DMAC_PRV_CHCFG_MASK_REN              (0x40000000U)
 #define DMAC_PRV_CHCFG_SET_RSW               (0x20000000U)
@@ -142,6 +144,12 @@
 #define DMAC_PRV_CHEXT_SET_SCA_STRONG        (0x00000000U)
 #define DMAC_PRV_CHEXT_SET_SPR_NON_SECURE    (0x00000002U)
 
+/* Link mode descriptor header */
+#define DMAC_PRV_LINK_HEADER_LV              (0x00000001U)       /* link valid, cleared by the DMAC on write back */
+#define DMAC_PRV_LINK_HEADER_LE              (0x00000002U)       /* link end */
+#define DMAC_PRV_LINK_HEADER_WBD             (0x00000004U)       /* write back disable */
+#define DMAC_PRV_LINK_HEADER_DIM             (0x00000008U)       /* descriptor interrupt mask */
+
 /* REQD value in CHCFG is undecided on configuration table */
 /* used case of a resource is the same and two or more direction value exists */
 #define DMAC_PRV_CHCFG_REQD_UNDEFINED        (2)
@@ -404,6 +412,10 @@ static const st_dma_configuration_t gs_dma_configuration_table[] =
 	{  DMA_RS_USB0_DMA0_RX,    0x087, DMAC_PRV_CHCFG_SET_AM_LEVEL    , DMAC_PRV_CHCFG_SET_LVL_LEVEL, DMAC_PRV_CHCFG_SET_REQD_SRC},
 	{  DMA_RS_USB0_DMA1_TX,    0x08b, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_DST},
 	{  DMA_RS_USB0_DMA1_RX,    0x08f, DMAC_PRV_CHCFG_SET_AM_LEVEL    , DMAC_PRV_CHCFG_SET_LVL_LEVEL, DMAC_PRV_CHCFG_SET_REQD_SRC},
+	{  DMA_RS_USB0_DMA0_RX_D0FIFO, 0x083, DMAC_PRV_CHCFG_SET_AM_LEVEL    , DMAC_PRV_CHCFG_SET_LVL_LEVEL, DMAC_PRV_CHCFG_SET_REQD_SRC},
+	{  DMA_RS_USB0_DMA0_TX_D1FIFO, 0x087, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_DST},
+	{  DMA_RS_USB0_DMA1_RX_D0FIFO, 0x08b, DMAC_PRV_CHCFG_SET_AM_LEVEL    , DMAC_PRV_CHCFG_SET_LVL_LEVEL, DMAC_PRV_CHCFG_SET_REQD_SRC},
+	{  DMA_RS_USB0_DMA1_TX_D1FIFO, 0x08f, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_DST},
 	{           DMA_RS_ADI,    0x093, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_SRC},
 	{        DMA_RS_IEBBTD,    0x0a3, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_SRC},
 	{        DMA_RS_IEBBTV,    0x0a7, DMAC_PRV_CHCFG_SET_AM_BUS_CYCLE, DMAC_PRV_CHCFG_SET_LVL_EDGE , DMAC_PRV_CHCFG_SET_REQD_SRC},
@@ -489,6 +501,8 @@ typedef struct
 {
     void (*p_dmaComplete)();
     void (*p_dmaError)();
+    st_r_drv_dmac_link_chain_t *p_link_chain;       /* link mode chain in progress, NULL in register mode */
+    uint32_t link_completed;                        /* descriptors of the chain completed */
 } st_channel_settings_t;
 
 /*******************************************************************************
@@ -516,6 +530,7 @@ static bool_t validate_settings (const st_r_drv_dmac_channel_config_t *dmac_conf
 static uint32_t determine_chcfg_n_value (uint_t channel, const st_r_drv_dmac_channel_config_t *dmac_config,
         st_dma_configuration_t *dma_configuration, uint32_t request_direction, uint8_t register_set);
 static uint32_t determine_chext_n_value (uint32_t source_address, uint32_t destination_address);
+static void link_end_process (const uint_t channel);
 
 /*******************************************************************************
  Global variables
@@ -628,6 +643,17 @@ void R_DMAC_ErrInterruptHandler(uint32_t int_sense)
  */
 static void R_DMAC_EndHandlerProcess(const uint_t channel)
 {
+    if (NULL != s_channel_settings[channel].p_link_chain)
+    {
+        /* report the descriptors completed, the complete callback follows the last one */
+        link_end_process(channel);
+
+        if (NULL != s_channel_settings[channel].p_link_chain)
+        {
+            return;
+        }
+    }
+
     if (NULL != s_channel_settings[channel].p_dmaComplete)
     {
         (*s_channel_settings[channel].p_dmaComplete)();
@@ -1001,6 +1027,9 @@ e_r_drv_dmac_err_t R_DMAC_Disable(uint_t sc_config_index, uint32_t *remaining_da
     /* clear continuous DMA setting */
     gsp_dma_ch_register_addr_table[channel]->chcfg_n &= (~(uint32_t) (DMAC_PRV_CHCFG_SET_RSW | DMAC_PRV_CHCFG_SET_RSEL));
 
+    /* abandon any link mode chain, the descriptors belong to the caller again */
+    s_channel_settings[channel].p_link_chain = NULL;
+
     /* clear TC, END bit */
     gsp_dma_ch_register_addr_table[channel]->chctrl_n = (DMAC_PRV_CHCTRL_SET_CLRTC | DMAC_PRV_CHCTRL_SET_CLREND);
 
@@ -1518,6 +1547,8 @@ e_r_drv_dmac_err_t R_DMAC_InitialiseData(void)
         /* initialise channel configuration data */
         s_channel_settings[channel].p_dmaComplete = NULL;
         s_channel_settings[channel].p_dmaError = NULL;
+        s_channel_settings[channel].p_link_chain = NULL;
+        s_channel_settings[channel].link_completed = 0;
     }
 
     return DMAC_SUCCESS;
@@ -1844,4 +1875,196 @@ e_r_drv_dmac_err_t R_DMAC_GetCrtbRegisterValue(uint_t sc_config_index, uint32_t
  End of function R_DMAC_SetNextTransfer
  ******************************************************************************/
 
+/**
+ * R_DMAC_LinkStart
+ * @brief      Build a link mode descriptor chain and start it
+ *             The channel keeps the transfer settings (resource, widths, address
+ *             types) from its last configuration; each entry supplies the
+ *             addresses and count. Only the entries asking for notification
+ *             and the last one raise the DMA end interrupt. A memory to memory
+ *             chain is software triggered here.
+ * @param[in]  sc_config_index: the index into the Smart Configuration table
+ * @param[in]  p_chain: the chain, its descriptors and entries must remain valid
+ *             until the last descriptor has completed or the channel is disabled
+ * @retval     DMAC_SUCCESS Successful operation
+ * @retval     DMAC_ERR_INVALID_CFG The chain is invalid
+ * @retval     DMAC_ERR_FAILED A chain is already running on the channel
+ */
+e_r_drv_dmac_err_t R_DMAC_LinkStart(uint_t sc_config_index, st_r_drv_dmac_link_chain_t *p_chain)
+{
+    st_r_drv_dmac_link_descriptor_t *p_descriptor;
+    const st_r_drv_dmac_link_entry_t *p_entry;
+    uint32_t chcfg_value;
+    uint32_t chitvl_value;
+    uint32_t header;
+    uint32_t dmars_value;
+    uint32_t i;
+    uint_t channel;
+
+    channel = DMAC_SC_TABLE[sc_config_index].channel;
+
+    if ((NULL == p_chain) || (NULL == p_chain->p_descriptors) || (NULL == p_chain->p_entries)
+            || (0 == p_chain->num_entries)
+            || (0 != (((uint32_t) p_chain->p_descriptors) & (DMAC_LINK_DESCRIPTOR_ALIGN - 1u))))
+    {
+        return DMAC_ERR_INVALID_CFG;
+    }
+
+    if (NULL != s_channel_settings[channel].p_link_chain)
+    {
+        return DMAC_ERR_FAILED;
+    }
+
+    /* every descriptor repeats the configured transfer settings in link mode */
+    chcfg_value = gsp_dma_ch_register_addr_table[channel]->chcfg_n;
+    chcfg_value &= (~(uint32_t) (DMAC_PRV_CHCFG_SET_REN | DMAC_PRV_CHCFG_SET_RSW | DMAC_PRV_CHCFG_SET_RSEL | DMAC_PRV_CHCFG_SET_DEM));
+    chcfg_value |= DMAC_PRV_CHCFG_SET_DMS;
+    chitvl_value = gsp_dma_ch_register_addr_table[channel]->chitvl_n;
+
+    for (i = 0; i < p_chain->num_entries; i++)
+    {
+        p_entry = &p_chain->p_entries[i];
+        p_descriptor = &p_chain->p_descriptors[i];
+
+        if (0 == p_entry->count)
+        {
+            return DMAC_ERR_INVALID_CFG;
+        }
+
+        header = DMAC_PRV_LINK_HEADER_LV;
+
+        if ((i + 1) == p_chain->num_entries)
+        {
+            header |= DMAC_PRV_LINK_HEADER_LE;
+            p_descriptor->next_link_address = 0;
+        }
+        else
+        {
+            p_descriptor->next_link_address = (uint32_t) &p_chain->p_descriptors[i + 1];
+
+            if (!p_entry->notify)
+            {
+                header |= DMAC_PRV_LINK_HEADER_DIM;
+            }
+        }
+
+        p_descriptor->header = header;
+        p_descriptor->source_address = (uint32_t) p_entry->source_address;
+        p_descriptor->destination_address = (uint32_t) p_entry->destination_address;
+        p_descriptor->count = p_entry->count;
+        p_descriptor->chcfg = chcfg_value;
+        p_descriptor->chitvl = chitvl_value;
+        p_descriptor->chext = determine_chext_n_value((uint32_t) p_entry->source_address,
+                (uint32_t) p_entry->destination_address);
+
+        if (p_chain->cache_maintenance)
+        {
+            /* the DMAC reads the source from memory and must not have its result overwritten by an eviction */
+            R_CACHE_L1_CleanLine((uint32_t) p_entry->source_address, p_entry->count);
+            R_CACHE_L1_CleanInvalidLine((uint32_t) p_entry->destination_address, p_entry->count);
+        }
+    }
+
+    /* the DMAC fetches the descriptors from memory */
+    R_CACHE_L1_CleanLine((uint32_t) p_chain->p_descriptors,
+            p_chain->num_entries * sizeof(st_r_drv_dmac_link_descriptor_t));
+
+    s_channel_settings[channel].link_completed = 0;
+    s_channel_settings[channel].p_link_chain = p_chain;
+
+    /* reset DMA */
+    gsp_dma_ch_register_addr_table[channel]->chctrl_n = DMAC_PRV_CHCTRL_SET_SWRST;
+
+    /* select link mode and point the channel at the first descriptor */
+    gsp_dma_ch_register_addr_table[channel]->chcfg_n = chcfg_value;
+    gsp_dma_ch_register_addr_table[channel]->nxla_n = (uint32_t) p_chain->p_descriptors;
+
+    /* enable DMA transfer */
+    gsp_dma_ch_register_addr_table[channel]->chctrl_n = DMAC_PRV_CHCTRL_SET_SETEN;
+
+    /* a channel without a request source (DMARS) is a memory to memory transfer */
+    dmars_value = *gsp_dmars_register_addr_table[channel];
+    if ((channel & 1u) > 0)
+    {
+        dmars_value >>= 16;
+    }
+
+    if (0 == (dmars_value & 0xffffu))
+    {
+        gsp_dma_ch_register_addr_table[channel]->chctrl_n = DMAC_PRV_CHCTRL_SET_STG;
+    }
+
+    return DMAC_SUCCESS;
+}
+/*******************************************************************************
+ End of function R_DMAC_LinkStart
+ ******************************************************************************/
+
+/**
+ * R_DMAC_LinkGetCompleted
+ * @brief      Get the number of descriptors of the last chain completed
+ * @param[in]  sc_config_index: the index into the Smart Configuration table
+ * @param[out] p_completed: number of descriptors completed
+ * @retval     DMAC_SUCCESS Always returned
+ */
+e_r_drv_dmac_err_t R_DMAC_LinkGetCompleted(uint_t sc_config_index, uint32_t *p_completed)
+{
+    uint_t channel;
+
+    channel = DMAC_SC_TABLE[sc_config_index].channel;
+
+    *p_completed = s_channel_settings[channel].link_completed;
+
+    return (DMAC_SUCCESS);
+}
+/*******************************************************************************
+ End of function R_DMAC_LinkGetCompleted
+ ******************************************************************************/
+
+/**
+ *              link_end_process
+ * @brief       Report the link mode descriptors completed since the last interrupt
+ *              The DMAC writes each descriptor header back with LV cleared once
+ *              its transfer has finished. Descriptors with their interrupt
+ *              masked are reported with the next one that raises it.
+ * @param[in]   channel: channel number
+ * @retval      None
+ */
+static void link_end_process(const uint_t channel)
+{
+    st_r_drv_dmac_link_chain_t *p_chain = s_channel_settings[channel].p_link_chain;
+    st_r_drv_dmac_link_descriptor_t *p_descriptor;
+    uint32_t index;
+
+    while (s_channel_settings[channel].link_completed < p_chain->num_entries)
+    {
+        index = s_channel_settings[channel].link_completed;
+        p_descriptor = &p_chain->p_descriptors[index];
+
+        /* discard any stale copy of the header before reading the write back */
+        R_CACHE_L1_InvalidLine((uint32_t) p_descriptor, sizeof(st_r_drv_dmac_link_descriptor_t));
+
+        if (0 != (p_descriptor->header & DMAC_PRV_LINK_HEADER_LV))
+        {
+            break;
+        }
+
+        s_channel_settings[channel].link_completed = index + 1;
+
+        if ((NULL != p_chain->p_descriptor_complete)
+                && (p_chain->p_entries[index].notify || ((index + 1) == p_chain->num_entries)))
+        {
+            (*p_chain->p_descriptor_complete)(index);
+        }
+    }
+
+    if (s_channel_settings[channel].link_completed == p_chain->num_entries)
+    {
+        s_channel_settings[channel].p_link_chain = NULL;
+    }
+}
+/******************************************************************************
+ End of function link_end_process
+ ******************************************************************************/
+
 /* End of File */
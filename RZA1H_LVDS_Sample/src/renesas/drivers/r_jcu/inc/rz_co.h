@@ -655,7 +655,7 @@ Functions Prototypes
 *    None.
 *
 * Description:
-*    If "e" argument is 0, this function do nothing.
+*    If "e" argument is 0, nothing is printed.
 *
 *    If you set break point at this function, you can see call tree
 *    at the place of raising an error.
@@ -663,6 +663,23 @@ Functions Prototypes
 void  R_CO_SetErrNum( errnum_t e );
 
 
+/***********************************************************************
+* Function: R_CO_GetErrNum
+*    Returns the error code set last.
+*
+* Arguments:
+*    None
+*
+* Return Value:
+*    The "e" argument of the last call of <R_CO_SetErrNum>, 0 for success.
+*
+* Description:
+*    Called from the "in_OnFinished" callback of an asynchronous driver
+*    function, this is the result of that function.
+************************************************************************/
+errnum_t  R_CO_GetErrNum(void);
+
+
 /******************************************************************************
 Functions Prototypes
 ******************************************************************************/
@@ -54,12 +54,16 @@ Exported global variables and functions (to be accessed by other files)
 /******************************************************************************
 Private global variables and functions
 ******************************************************************************/
+static volatile errnum_t  gs_errnum;
+
 
 /***********************************************************************
 * Implement: R_CO_SetErrNum
 ************************************************************************/
 void  R_CO_SetErrNum( errnum_t e )
 {
+    gs_errnum = e;
+
     if ( e )
     {
         printf( "<Error num=\"0x%08X\"/>\n",  e );
@@ -67,6 +71,15 @@ void  R_CO_SetErrNum( errnum_t e )
 }
 
 
+/***********************************************************************
+* Implement: R_CO_GetErrNum
+************************************************************************/
+errnum_t  R_CO_GetErrNum(void)
+{
+    return  gs_errnum;
+}
+
+
 /***********************************************************************
 * Implement: R_CO_SetTrue
 ************************************************************************/
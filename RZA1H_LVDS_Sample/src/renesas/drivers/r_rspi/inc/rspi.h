@@ -299,6 +299,8 @@ void r_rspi1_callback_error(uint8_t err_type);
 /* Start user code for function. Do not edit comment generated here */
 void R_RSPI1_Start(void);
 void R_RSPI1_Stop(void);
+void R_RSPI1_DmaRequestEnable(void);
+void R_RSPI1_DmaRequestDisable(void);
 
 void R_SPI_Init(void);
 
@@ -83,6 +83,10 @@ uint8_t * gp_spi_tx_address;
 /* SCI5 transmit data number */
 uint16_t  g_spi_tx_count;
 
+/* RSPI1 interrupt enables saved by R_RSPI1_DmaRequestEnable */
+static bool_t s_rspi1_spti_enabled = false;
+static bool_t s_rspi1_spri_enabled = false;
+
 static void port_settings(void)
 {
 
@@ -491,3 +495,82 @@ void R_RSPI1_LoopBackDisable(void)
                        RSPIn_SPPCR_SPLP_SHIFT,
                        RSPIn_SPPCR_SPLP);
 }
+
+/*******************************************************************************
+* Function Name: rspi_intc_is_enabled
+* Description  : This function reads the enable bit of an interrupt from the
+*                ICDISERn registers.
+* Arguments    : int_id - Interrupt ID
+* Return Value : true if the interrupt is enabled
+*******************************************************************************/
+static bool_t rspi_intc_is_enabled(uint16_t int_id)
+{
+    volatile uint32_t * paddr = (volatile uint32_t *) &INTC.ICDISER0;
+
+    /* ICDISERn has 32 sources in the 32 bits */
+    return (0u != ((*(paddr + (int_id / 32))) & (1uL << (int_id % 32))));
+}
+
+/*******************************************************************************
+* Function Name: R_RSPI1_DmaRequestEnable
+* Description  : This function routes the RSPI1 transmit and receive requests
+*                to the DMAC instead of the CPU. The DMA channels must already
+*                be enabled, as the transmit request is raised straight away.
+* Arguments    : None
+* Return Value : None
+*******************************************************************************/
+void R_RSPI1_DmaRequestEnable(void)
+{
+    /* Remember the interrupt enables for R_RSPI1_DmaRequestDisable */
+    s_rspi1_spti_enabled = rspi_intc_is_enabled(INTC_ID_SPTI1);
+    s_rspi1_spri_enabled = rspi_intc_is_enabled(INTC_ID_SPRI1);
+
+    /* The requests are taken by the DMAC */
+    R_INTC_Disable(INTC_ID_SPTI1);
+    R_INTC_Disable(INTC_ID_SPRI1);
+
+    /* Enable receive request first so that no frame is missed */
+    rza_io_reg_write_8( &(RSPI1.SPCR),
+                       1,
+                       RSPIn_SPCR_SPRIE_SHIFT,
+                       RSPIn_SPCR_SPRIE);
+
+    /* Enable transmit request */
+    rza_io_reg_write_8( &(RSPI1.SPCR),
+                       1,
+                       RSPIn_SPCR_SPTIE_SHIFT,
+                       RSPIn_SPCR_SPTIE);
+}
+
+/*******************************************************************************
+* Function Name: R_RSPI1_DmaRequestDisable
+* Description  : This function returns RSPI1 to CPU driven transfers after
+*                R_RSPI1_DmaRequestEnable.
+* Arguments    : None
+* Return Value : None
+*******************************************************************************/
+void R_RSPI1_DmaRequestDisable(void)
+{
+    /* Disable transmit request */
+    rza_io_reg_write_8( &(RSPI1.SPCR),
+                       0,
+                       RSPIn_SPCR_SPTIE_SHIFT,
+                       RSPIn_SPCR_SPTIE);
+
+    /* Disable receive request */
+    rza_io_reg_write_8( &(RSPI1.SPCR),
+                       0,
+                       RSPIn_SPCR_SPRIE_SHIFT,
+                       RSPIn_SPCR_SPRIE);
+
+    /* As found by R_RSPI1_DmaRequestEnable */
+    if (s_rspi1_spti_enabled)
+    {
+        R_INTC_Enable(INTC_ID_SPTI1);
+    }
+
+    if (s_rspi1_spri_enabled)
+    {
+        R_INTC_Enable(INTC_ID_SPRI1);
+    }
+}
@@ -97,6 +97,7 @@
  * \arg \b R_SSIF_CONTROL_STATUS Report SSIF status, uses parameter @ref st_r_ssif_drv_control_t <BR>
  * \arg \b R_SSIF_AIO_READ_CONTROL Configure SSIF to read, uses parameter @ref aiocb <BR>
  * \arg \b R_SSIF_AIO_WRITE_CONTROL Configure SSIF to write, uses parameter @ref aiocb <BR>
+ * \arg \b R_SSIF_CONTROL_QUEUE_STATS Report queue statistics, uses parameter @ref st_r_ssif_drv_control_t <BR>
  *
  * \c ssif_get_version - Get driver version<BR>
  */
@@ -133,7 +134,8 @@ typedef enum
     R_SSIF_READ_CONTROL,
     R_SSIF_WRITE_CONTROL,
     R_SSIF_AIO_READ_CONTROL,        /*!< Configure SSIF to read, uses parameter @ref aiocb */
-    R_SSIF_AIO_WRITE_CONTROL        /*!< Configure SSIF to write, uses parameter @ref aiocb */
+    R_SSIF_AIO_WRITE_CONTROL,       /*!< Configure SSIF to write, uses parameter @ref aiocb */
+    R_SSIF_CONTROL_QUEUE_STATS      /*!< Report queue statistics, uses parameter @ref st_r_ssif_drv_control_t */
 } e_control_codes_ssif_t;
 
 typedef struct st_r_ssif_drv_control_t
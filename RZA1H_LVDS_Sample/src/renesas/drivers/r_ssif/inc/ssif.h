@@ -266,6 +266,7 @@ typedef struct ssif_info_ch
     AIOCB*      p_aio_tx_next;
     AIOCB*      p_aio_rx_curr;
     AIOCB*      p_aio_rx_next;
+    ssif_queue_stats_t              stats;
     ssif_chcfg_cks_t                clk_select;
     ssif_chcfg_multi_ch_t           multi_ch;
     ssif_chcfg_data_word_t          data_word;
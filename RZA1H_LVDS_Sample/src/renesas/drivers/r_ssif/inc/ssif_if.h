@@ -87,6 +87,8 @@ Includes   <System Includes> , "Project Includes"
 #define SSIF_CFG_ENABLE_ROMDEC_DIRECT  (0xDEC0DEC1u) /* Enable  SSIRDR->STRMDIN0 route */
 #endif
 
+#define SSIF_AIO_QUEUE_DEPTH (8u)    /**< Requests that can be queued per direction */
+
 /******************************************************************************
  Function Macros
  *****************************************************************************/
@@ -226,6 +228,34 @@ typedef struct
 } ssif_chcfg_romdec_t;
 
 #endif
+
+/**< Completion record of a queued buffer */
+typedef struct
+{
+    volatile void *p_buf;       /* Buffer that completed                         */
+    uint32_t       position;    /* Bytes transferred on the channel at completion */
+    uint32_t       tick;        /* OS tick count at completion                    */
+} ssif_aio_complete_t;
+
+/**< Queue statistics for one direction */
+typedef struct
+{
+    uint32_t            queued;         /* Requests waiting or in progress                 */
+    uint32_t            completed;      /* Requests completed                              */
+    uint32_t            xruns;          /* Write: underruns, silence had to be sent.
+                                           Read: overruns, received audio was dropped      */
+    uint32_t            fifo_errors;    /* SSIF FIFO under/overflow error interrupts       */
+    uint32_t            position;       /* Bytes transferred including dummy transfers     */
+    ssif_aio_complete_t history[SSIF_AIO_QUEUE_DEPTH]; /* Indexed by completed % depth   */
+} ssif_aio_stats_t;
+
+/**< Queue statistics reported by R_SSIF_CONTROL_QUEUE_STATS */
+typedef struct
+{
+    ssif_aio_stats_t tx;
+    ssif_aio_stats_t rx;
+} ssif_queue_stats_t;
+
 /**< This structure contains the configuration settings */
 typedef struct
 {
@@ -39,6 +39,7 @@
  Includes   <System Includes> , "Project Includes"
  ******************************************************************************/
 #include <fcntl.h>
+#include <string.h>
 
 #include "r_typedefs.h"
 #include "compiler_settings.h"
@@ -67,6 +68,8 @@ static int_t ssif_read (st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t ui
 static void *ssif_init (void * const config_data, int32_t * const p_errno);
 static int_t ssif_un_init (void * const driver_instance, int32_t * const p_errno);
 static int_t configure_ssif_channel (int_t channel);
+static AIOCB *claim_aio (AIOCB * const p_pool, const AIOCB * const p_template);
+static uint32_t count_aio_in_use (const AIOCB * const p_pool);
 
 /*****************************************************************************
  Constant Data
@@ -85,6 +88,11 @@ static AIOCB *gsp_aio_r = NULL;
 /* structure pointer for setting up DMA write */
 static AIOCB *gsp_aio_w = NULL;
 
+/* control blocks for the requests queued on each direction, aio_complete is
+   set when a block is free */
+static AIOCB gs_aio_w_pool[SSIF_AIO_QUEUE_DEPTH];
+static AIOCB gs_aio_r_pool[SSIF_AIO_QUEUE_DEPTH];
+
 /* pointer to info for SSIF channel */
 static ssif_info_ch_t *gsp_info_ch = (ssif_info_ch_t *)NULL;
 
@@ -106,6 +114,7 @@ extern ssif_info_drv_t g_ssif_info_drv;
 static int_t ssif_open (st_stream_ptr_t pStream)
 {
     int_t ercd = DEVDRV_SUCCESS;
+    uint32_t i;
 
     /* Configure SSIF Channel 0. 4 channels available (0-3) */
     configure_ssif_channel(SSIF_CHNUM_0);
@@ -126,6 +135,14 @@ static int_t ssif_open (st_stream_ptr_t pStream)
         /* Initialise the rx buffer element */
         gsp_info_ch->p_aio_rx_curr = NULL;
 
+        /* Mark every queue entry free and restart the statistics */
+        for (i = 0; i < SSIF_AIO_QUEUE_DEPTH; i++)
+        {
+            gs_aio_w_pool[i].aio_complete = 1;
+            gs_aio_r_pool[i].aio_complete = 1;
+        }
+        memset(&gsp_info_ch->stats, 0, sizeof(gsp_info_ch->stats));
+
         ercd = SSIF_EnableChannel(gsp_info_ch);
         if (DEVDRV_SUCCESS == ercd)
         {
@@ -263,6 +280,31 @@ static int_t ssif_control (st_stream_ptr_t pStream, uint32_t ctlCode, void *pCtl
             }
             break;
 
+            case R_SSIF_CONTROL_QUEUE_STATS:
+            {
+                st_r_ssif_drv_control_t *p_control_struct = pCtlStruct;
+
+                /* Comparison with NULL */
+                if ((NULL == p_control_struct->p_buf) || (NULL == gsp_info_ch))
+                {
+                    result = DEVDRV_ERROR;
+                }
+                else
+                {
+                    ssif_queue_stats_t * const p_stats = p_control_struct->p_buf;
+
+                    /* take a consistent copy, the DMA callbacks update these */
+                    int_t lock = R_OS_SysLock(NULL);
+                    *p_stats = gsp_info_ch->stats;
+                    R_OS_SysUnlock(NULL, lock);
+
+                    p_stats->tx.queued = count_aio_in_use(gs_aio_w_pool);
+                    p_stats->rx.queued = count_aio_in_use(gs_aio_r_pool);
+                    result = DEVDRV_SUCCESS;
+                }
+                break;
+            }
+
             case R_SSIF_AIO_READ_CONTROL:
             {
                 /* point to read setup */
@@ -327,26 +369,35 @@ static int_t ssif_write (st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t u
             }
             else
             {
-                /* update file descriptor field with pointer to channel configuration */
-                gsp_aio_w->aio_fildes = (int) gsp_info_ch;
+                /* take a free control block so that requests can queue behind
+                   the buffer currently being transferred */
+                AIOCB * const p_aio = claim_aio(gs_aio_w_pool, gsp_aio_w);
 
-                /* Enable callback on message */
-                gsp_aio_w->aio_sigevent.sigev_notify = SIGEV_THREAD;
+                if (NULL == p_aio)
+                {
+                    /* all SSIF_AIO_QUEUE_DEPTH entries are still queued */
+                    ercd = DEVDRV_ERROR;
+                }
+                else
+                {
+                    /* update file descriptor field with pointer to channel configuration */
+                    p_aio->aio_fildes = (int) gsp_info_ch;
 
-                /* set operation type */
-                gsp_aio_w->aio_return = SSIF_ASYNC_W;
+                    /* Enable callback on message */
+                    p_aio->aio_sigevent.sigev_notify = SIGEV_THREAD;
 
-                /* number of bytes */
-                gsp_aio_w->aio_nbytes = uiCount;
+                    /* set operation type */
+                    p_aio->aio_return = SSIF_ASYNC_W;
 
-                /* pointer to buffer */
-                gsp_aio_w->aio_buf = (void *) pbyBuffer;
+                    /* number of bytes */
+                    p_aio->aio_nbytes = uiCount;
 
-                /* pass message to config structure */
-                gsp_info_ch->p_aio_tx_next = gsp_aio_w;
+                    /* pointer to buffer */
+                    p_aio->aio_buf = (void *) pbyBuffer;
 
-                /* Go! */
-                SSIF_PostAsyncIo(gsp_info_ch, gsp_aio_w);
+                    /* Go! the DMA callback picks it up from the queue */
+                    SSIF_PostAsyncIo(gsp_info_ch, p_aio);
+                }
             }
         }
     }
@@ -384,26 +435,35 @@ static int_t ssif_read (st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t ui
         }
         else
         {
-            /* update file descriptor field with pointer to channel configuration */
-            gsp_aio_r->aio_fildes = (int) gsp_info_ch;
+            /* take a free control block so that requests can queue behind
+               the buffer currently being filled */
+            AIOCB * const p_aio = claim_aio(gs_aio_r_pool, gsp_aio_r);
 
-            /* Enable callback on message */
-            gsp_aio_r->aio_sigevent.sigev_notify = SIGEV_THREAD;
+            if (NULL == p_aio)
+            {
+                /* all SSIF_AIO_QUEUE_DEPTH entries are still queued */
+                ercd = DEVDRV_ERROR;
+            }
+            else
+            {
+                /* update file descriptor field with pointer to channel configuration */
+                p_aio->aio_fildes = (int) gsp_info_ch;
 
-            /* set operation type */
-            gsp_aio_r->aio_return = SSIF_ASYNC_R;
+                /* Enable callback on message */
+                p_aio->aio_sigevent.sigev_notify = SIGEV_THREAD;
 
-            /* number of bytes */
-            gsp_aio_r->aio_nbytes = uiCount;
+                /* set operation type */
+                p_aio->aio_return = SSIF_ASYNC_R;
 
-            /* pointer to buffer */
-            gsp_aio_r->aio_buf = (void *) pbyBuffer;
+                /* number of bytes */
+                p_aio->aio_nbytes = uiCount;
 
-            /* pass message to config structure */
-            gsp_info_ch->p_aio_rx_next = gsp_aio_r;
+                /* pointer to buffer */
+                p_aio->aio_buf = (void *) pbyBuffer;
 
-            /* Go! */
-            SSIF_PostAsyncIo(gsp_info_ch, gsp_aio_r);
+                /* Go! the DMA callback picks it up from the queue */
+                SSIF_PostAsyncIo(gsp_info_ch, p_aio);
+            }
         }
     }
 
@@ -602,3 +662,65 @@ static int_t configure_ssif_channel (int_t channel)
 /*******************************************************************************
  End of function configure_ssif_channel
  ******************************************************************************/
+
+/******************************************************************************
+ Function Name: claim_aio
+ Description:   Take a free control block from a request pool
+ Arguments:     IN  p_pool - SSIF_AIO_QUEUE_DEPTH control blocks
+ IN  p_template - control block set with R_SSIF_AIO_xxx_CONTROL, its
+ sigevent is copied so every request notifies the same way
+ Return value:  pointer to the claimed block, NULL if the pool is exhausted
+ ******************************************************************************/
+static AIOCB *claim_aio (AIOCB * const p_pool, const AIOCB * const p_template)
+{
+    AIOCB *p_aio = NULL;
+    uint32_t i;
+    int_t lock = R_OS_SysLock(NULL);
+
+    for (i = 0; i < SSIF_AIO_QUEUE_DEPTH; i++)
+    {
+        if (0 != p_pool[i].aio_complete)
+        {
+            p_aio = &p_pool[i];
+            p_aio->aio_complete = 0;
+            break;
+        }
+    }
+
+    R_OS_SysUnlock(NULL, lock);
+
+    if (NULL != p_aio)
+    {
+        p_aio->aio_sigevent = p_template->aio_sigevent;
+    }
+
+    return p_aio;
+}
+/******************************************************************************
+ End of function claim_aio
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: count_aio_in_use
+ Description:   Count the requests of a pool that are queued or in transfer
+ Arguments:     IN  p_pool - SSIF_AIO_QUEUE_DEPTH control blocks
+ Return value:  number of blocks in use
+ ******************************************************************************/
+static uint32_t count_aio_in_use (const AIOCB * const p_pool)
+{
+    uint32_t count = 0;
+    uint32_t i;
+
+    for (i = 0; i < SSIF_AIO_QUEUE_DEPTH; i++)
+    {
+        if (0 == p_pool[i].aio_complete)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+/******************************************************************************
+ End of function count_aio_in_use
+ ******************************************************************************/
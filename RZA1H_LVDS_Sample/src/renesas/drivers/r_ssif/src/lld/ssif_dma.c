@@ -37,6 +37,7 @@
 #include "mcu_board_select.h"
 
 #include "r_dmac_drv_api.h"
+#include "r_os_abstraction_api.h"
 
 /******************************************************************************
  Macro definitions
@@ -70,6 +71,7 @@ static int_t enable_ssif_transfer(ssif_info_ch_t * const p_info_ch);
 static int_t open_dma_driver(ssif_info_ch_t * const p_info_ch);
 static void SSIF_DMA_TxCallback(void);
 static void SSIF_DMA_RxCallback(void);
+static void record_completion(ssif_aio_stats_t * const p_stats, const AIOCB * const p_aio, const uint32_t dummy_count);
 
 static const e_r_drv_dmac_xfer_resource_t
         s_ssif_dma_tx_resource[SSIF_NUM_CHANS] =
@@ -625,6 +627,9 @@ static void SSIF_DMA_TxCallback(void)
 
     ssif_ch = p_info_ch->channel;
 
+    /* account for the transfer that has just finished */
+    record_completion(&p_info_ch->stats.tx, p_info_ch->p_aio_tx_curr, s_ssif_txdma_dummy_trparam[ssif_ch].count);
+
     if (NULL != p_info_ch->p_aio_tx_curr)
     {
         /* now complete user request transfer, Signal to application */
@@ -648,6 +653,12 @@ static void SSIF_DMA_TxCallback(void)
     }
     else
     {
+        /* nothing is queued behind the buffer now playing so silence follows it */
+        if (NULL != p_info_ch->p_aio_tx_curr)
+        {
+            p_info_ch->stats.tx.xruns++;
+        }
+
         next_transfer.source_address      = (void *) s_ssif_txdma_dummy_trparam[ssif_ch].source_address;
         next_transfer.destination_address = (void *) s_ssif_txdma_dummy_trparam[ssif_ch].destination_address;
         next_transfer.count               = (uint32_t) s_ssif_txdma_dummy_trparam[ssif_ch].count;
@@ -677,6 +688,9 @@ static void SSIF_DMA_RxCallback(void)
 
     ssif_ch = p_info_ch->channel;
 
+    /* account for the transfer that has just finished */
+    record_completion(&p_info_ch->stats.rx, p_info_ch->p_aio_rx_curr, s_ssif_rxdma_dummy_trparam[ssif_ch].count);
+
     if (NULL != p_info_ch->p_aio_rx_curr)
     {
         /* now complete user request transfer, Signal to application */
@@ -700,6 +714,12 @@ static void SSIF_DMA_RxCallback(void)
     }
     else
     {
+        /* nothing is queued behind the buffer now filling so input will be dropped */
+        if (NULL != p_info_ch->p_aio_rx_curr)
+        {
+            p_info_ch->stats.rx.xruns++;
+        }
+
         next_transfer.source_address      = (void *) s_ssif_rxdma_dummy_trparam[ssif_ch].source_address;
         next_transfer.destination_address = (void *) s_ssif_rxdma_dummy_trparam[ssif_ch].destination_address;
         next_transfer.count               = (uint32_t) s_ssif_rxdma_dummy_trparam[ssif_ch].count;
@@ -710,3 +730,34 @@ static void SSIF_DMA_RxCallback(void)
 /******************************************************************************
  End of function SSIF_DMA_RxCallback
  *****************************************************************************/
+
+/******************************************************************************
+ * Function Name: record_completion
+ * @brief         Update the queue statistics for a finished DMA transfer
+ * @param[in,out] p_stats: statistics for the direction
+ * @param[in]     p_aio: request that finished, NULL for a dummy transfer
+ * @param[in]     dummy_count: size of the dummy transfer
+ * @retval        none
+ *****************************************************************************/
+static void record_completion(ssif_aio_stats_t * const p_stats, const AIOCB * const p_aio, const uint32_t dummy_count)
+{
+    ssif_aio_complete_t *p_record;
+
+    if (NULL == p_aio)
+    {
+        p_stats->position += dummy_count;
+    }
+    else
+    {
+        p_stats->position += (uint32_t) p_aio->aio_nbytes;
+
+        p_record = &p_stats->history[p_stats->completed % SSIF_AIO_QUEUE_DEPTH];
+        p_record->p_buf = p_aio->aio_buf;
+        p_record->position = p_stats->position;
+        p_record->tick = (uint32_t) R_OS_GetTickCount();
+        p_stats->completed++;
+    }
+}
+/******************************************************************************
+ End of function record_completion
+ *****************************************************************************/
@@ -276,9 +276,19 @@ static void SSIF_ERI5_Handler(uint32_t int_sense)
 static void SSIF_ERI_Handler(const uint32_t ssif_ch)
 {
     ssif_info_ch_t* const p_info_ch = &g_ssif_info_drv.info_ch[ssif_ch];
+    const uint32_t ssisr = g_ssireg[ssif_ch]->SSISR;
 
-    if (0u != (g_ssireg[ssif_ch]->SSISR & SSIF_SR_INT_ERR_MASK))
+    if (0u != (ssisr & SSIF_SR_INT_ERR_MASK))
     {
+        if (0u != (ssisr & (SSIF_SR_BIT_TUIRQ | SSIF_SR_BIT_TOIRQ)))
+        {
+            p_info_ch->stats.tx.fifo_errors++;
+        }
+        if (0u != (ssisr & (SSIF_SR_BIT_RUIRQ | SSIF_SR_BIT_ROIRQ)))
+        {
+            p_info_ch->stats.rx.fifo_errors++;
+        }
+
         /* Restart or Callback */
         SSIF_ErrorRecovery(p_info_ch);
     }
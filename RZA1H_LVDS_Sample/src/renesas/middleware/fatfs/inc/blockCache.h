@@ -41,6 +41,30 @@ Typedefs
 
 typedef struct _BCACHE *PBACHE;
 
+/* The statistics of a block cache */
+typedef struct _BCSTATS
+{
+    /* The number of reads satisfied from the cache */
+    unsigned long   ulHits;
+    /* The number of reads that had to fill a cache line */
+    unsigned long   ulMisses;
+    /* The number of valid lines replaced to make room for a new line */
+    unsigned long   ulEvictions;
+    /* The number of read commands issued to the device */
+    unsigned long   ulReadCommands;
+    /* The number of sectors read from the device */
+    unsigned long   ulSectorsRead;
+    /* The number of lines read ahead of the requested line */
+    unsigned long   ulReadAheadLines;
+    /* The number of write commands issued to the device */
+    unsigned long   ulWriteCommands;
+    /* The number of sectors written to the device */
+    unsigned long   ulSectorsWritten;
+    /* The number of times the dirty lines were written back */
+    unsigned long   ulFlushes;
+} BCSTATS,
+*PBCSTATS;
+
 /***********************************************************************************
 Public Functions
 ***********************************************************************************/
@@ -77,6 +101,43 @@ Return value:  none
 
 extern  void bcDestroy(PBACHE pBlkCache);
 
+/**********************************************************************************
+Function Name: bcSetReadAhead
+Description:   Function to configure the read-ahead of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iReadAheadLines - The maximum number of lines read in one
+                                     command, 0 to disable read-ahead
+               IN  iSequentialThreshold - The number of sequential line
+                                          accesses before read-ahead starts
+Return value:  0 for success -1 on error
+**********************************************************************************/
+
+extern  int bcSetReadAhead(PBACHE pBlkCache,
+                           int iReadAheadLines,
+                           int iSequentialThreshold);
+
+/**********************************************************************************
+Function Name: bcSetWriteBack
+Description:   Function to select write-back or write-through operation
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iWriteBurstLines - The maximum number of dirty lines
+                                      written in one command, 0 to write
+                                      through to the device
+Return value:  0 for success -1 on error
+**********************************************************************************/
+
+extern  int bcSetWriteBack(PBACHE pBlkCache, int iWriteBurstLines);
+
+/**********************************************************************************
+Function Name: bcSetLongCommands
+Description:   Function to select the 16 byte SCSI read and write commands
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iLongCommands - TRUE to use the 16 byte commands
+Return value:  none
+**********************************************************************************/
+
+extern  void bcSetLongCommands(PBACHE pBlkCache, int iLongCommands);
+
 /**********************************************************************************
 Function Name: bcRead
 Description:   Function to read with cache
@@ -107,6 +168,64 @@ extern  unsigned long bcWrite(PBACHE         pBlkCache,
                               unsigned long  ulSector,
                               unsigned long  ulNumberOfSectors);
 
+/**********************************************************************************
+Function Name: bcFlush
+Description:   Function to write all the dirty lines to the device
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  0 for success -1 on error
+**********************************************************************************/
+
+extern  int bcFlush(PBACHE pBlkCache);
+
+/**********************************************************************************
+Function Name: bcClaimFlush
+Description:   Function to mark the cache as being written back by another task,
+               called before the task lets go of the lock that keeps the cache
+               from being destroyed
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+
+extern  void bcClaimFlush(PBACHE pBlkCache);
+
+/**********************************************************************************
+Function Name: bcReleaseFlush
+Description:   Function to end a write back claimed by bcClaimFlush
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+
+extern  void bcReleaseFlush(PBACHE pBlkCache);
+
+/**********************************************************************************
+Function Name: bcWaitFlush
+Description:   Function to wait for a write back claimed by bcClaimFlush to end
+               before the cache is destroyed. Only one task may wait
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+
+extern  void bcWaitFlush(PBACHE pBlkCache);
+
+/**********************************************************************************
+Function Name: bcGetStatistics
+Description:   Function to get the statistics of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               OUT pStats - Pointer to the destination statistics
+Return value:  none
+**********************************************************************************/
+
+extern  void bcGetStatistics(PBACHE pBlkCache, PBCSTATS pStats);
+
+/**********************************************************************************
+Function Name: bcResetStatistics
+Description:   Function to reset the statistics of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+
+extern  void bcResetStatistics(PBACHE pBlkCache);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,11 +42,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK    0
+#define FF_USE_FASTSEEK    1
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND    0
+#define FF_USE_EXPAND    1
 /* This option switches f_expand function. (0:Disable or 1:Enable) */
 
 
@@ -244,7 +244,7 @@
 /  These options have no effect at read-only configuration (FF_FS_READONLY = 1). */
 
 
-#define FF_FS_LOCK        0
+#define FF_FS_LOCK        16
 /* The option FF_FS_LOCK switches file lock function to control duplicated file open
 /  and illegal operation to open objects. This option must be 0 when FF_FS_READONLY
 /  is 1.
@@ -256,9 +256,9 @@
 /      lock control is independent of re-entrancy. */
 
 
-#define FF_FS_REENTRANT    0
+#define FF_FS_REENTRANT    1
 #define FF_FS_TIMEOUT    1000
-#define FF_SYNC_t        HANDLE
+#define FF_SYNC_t        void *
 /* The option FF_FS_REENTRANT switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
@@ -78,6 +78,34 @@
     #define FAT_MODE_TRUNCATE           (0x10)     /*!< Truncate        - FAT Mode */
     #define FAT_MODE_DIR                (0x80)     /*!< Directory       - FAT Mode */
 
+    /* Block cache configuration applied by R_FAT_CreateDrive. The read-ahead,
+       sequential count and write burst are the defaults used when the
+       caller does not pass a FATCACHECFG */
+    #ifndef FAT_CACHE_LINE_SIZE
+    #define FAT_CACHE_LINE_SIZE         (8)        /*!< Sectors in each cache line */
+    #endif
+    #ifndef FAT_CACHE_NUM_LINES
+    #define FAT_CACHE_NUM_LINES         (64)       /*!< Cache lines for each drive */
+    #endif
+    #ifndef FAT_CACHE_READ_AHEAD_LINES
+    #define FAT_CACHE_READ_AHEAD_LINES  (8)        /*!< Lines read in one command, 0 disables read-ahead */
+    #endif
+    #ifndef FAT_CACHE_SEQUENTIAL_COUNT
+    #define FAT_CACHE_SEQUENTIAL_COUNT  (2)        /*!< Sequential line reads before read-ahead starts */
+    #endif
+    #ifndef FAT_CACHE_WRITE_BURST_LINES
+    #define FAT_CACHE_WRITE_BURST_LINES (0)        /*!< Dirty lines written in one command, 0 writes through */
+    #endif
+
+    /* Fast seek cluster link map */
+    #ifndef FAT_LINK_MAP_INITIAL_SIZE
+    #define FAT_LINK_MAP_INITIAL_SIZE   (64)       /*!< Initial link map size in DWORDs (31 fragments) */
+    #endif
+
+    #ifndef FAT_LINK_MAP_ON_READ
+    #define FAT_LINK_MAP_ON_READ        (1)        /*!< Build the link map when a file is opened read only */
+    #endif
+
 /******************************************************************************
  Enumerated Types
  ***********************************************************************************/
@@ -171,6 +199,14 @@ typedef struct _DRIVEINFO
 
 } DRIVEINFO, *PDRIVEINFO;
 
+typedef struct _FATCACHECFG
+{
+    int iReadAheadLines;        /*!< Lines read in one command, 0 disables read-ahead */
+    int iSequentialCount;       /*!< Sequential line reads before read-ahead starts */
+    int iWriteBurstLines;       /*!< Dirty lines written in one command, 0 writes through */
+
+} FATCACHECFG, *PFATCACHECFG;
+
 typedef struct _DRIVE *PDRIVE;
 typedef struct FIL *PFILE;
 
@@ -220,10 +256,14 @@ int R_FAT_LoadLibrary (void);
  * @param[in]  iLun:         The logical unit number
  * @param[in]  dwBlockSize:  The block size of the device
  * @param[in]  dwNumBlocks:  The number of blocks
+ * @param[in]  pCacheCfg:    Block cache tuning for this drive, NULL for the
+ *                           FAT_CACHE_ defaults
  * 
  * @retval     ptr_drv:      Pointer to the drive object
+ * @retval     NULL:         No memory for the block cache
  */
-PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsigned long dwNumBlocks);
+PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsigned long dwNumBlocks,
+                          const FATCACHECFG *pCacheCfg);
 
 /**
  * @brief       Function to destroy the drive object
@@ -234,6 +274,16 @@ PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsig
  */
 FRESULT R_FAT_DestroyDrive (PDRIVE pDrive);
 
+/**
+ * @brief       Function to write any data held in the drive's cache to the media
+ * 
+ * @param[in]   pDrive:       Pointer to the drive object
+ * 
+ * @retval      FR_OK:        Success
+ * @retval      FR_DISK_ERR:  The data could not be written
+ */
+FRESULT R_FAT_FlushDrive (PDRIVE pDrive);
+
 /**
  * @brief   Function to mount a FAT partition (0..3)
  *    
@@ -319,6 +369,53 @@ int R_FAT_WriteFile (FIL *p_file, unsigned char *p_buff, unsigned int no_of_byte
  */
 FRESULT R_FAT_SeekFile (FIL *p_file, FS_T_UINT32 lOffset, int iOrigin, long *p_result);
 
+/**
+ * @brief      Function to create the cluster link map for fast seek
+ *
+ *             Once the map is in place seeks are resolved from the map
+ *             rather than by following the FAT chain. The file can not be
+ *             extended while the map is in use.
+ *
+ * @param[in]  p_file:       Pointer to the file object
+ * @param[in,out] p_table_size: Pointer to the size of the table in DWORDs,
+ *                           0 (or NULL) to size it to the file. Set to the
+ *                           number of DWORDs used on success or required
+ *                           when the given table was too small.
+ *
+ * @retval     0: for success
+ */
+FRESULT R_FAT_CreateLinkMap (FIL *p_file, DWORD *p_table_size);
+
+/**
+ * @brief      Function to discard the cluster link map of a file
+ *
+ * @param[in]  p_file: Pointer to the file object
+ */
+void R_FAT_DiscardLinkMap (FIL *p_file);
+
+/**
+ * @brief      Function to allocate contiguous clusters to an empty file
+ *
+ *             The file size is set to the allocated size, so data written
+ *             later goes to clusters which are already in the FAT. Use
+ *             R_FAT_TruncateFile to return the part that was not used.
+ *
+ * @param[in]  p_file: Pointer to the file object, opened for writing
+ * @param[in]  size:   The number of bytes to allocate
+ *
+ * @retval     0: for success
+ */
+FRESULT R_FAT_ExpandFile (FIL *p_file, FSIZE_t size);
+
+/**
+ * @brief      Function to truncate a file at the file pointer
+ *
+ * @param[in]  p_file: Pointer to the file object, opened for writing
+ *
+ * @retval     0: for success
+ */
+FRESULT R_FAT_TruncateFile (FIL *p_file);
+
 /**
  *  @brief         Return the size of  a file
  *  
@@ -368,6 +465,15 @@ FRESULT R_FAT_FindFirst (DIR *p_dir, FATENTRY *p_fat_entry, char *p_path, const
  */
 FRESULT R_FAT_FindNext (DIR *p_dir, FATENTRY *p_fno);
 
+/**
+ * @brief   Function to close a find and release the directory lock
+ *
+ * @param[in]  p_dir - Pointer to the directory object
+ *
+ * @retval     0: Success
+ */
+FRESULT R_FAT_FindClose (DIR *p_dir);
+
 /**
  * @brief      Function to rewind the find to the first entry 
  * 
@@ -49,27 +49,41 @@ User Includes
 #include "compiler_settings.h"
 #include "r_os_abstraction_api.h"
 #include "r_cache_l1_rz_api.h"
+/***********************************************************************************
+Defines
+***********************************************************************************/
+
+/* Alignment of the cache memory, so that cache lines do not share an L1 line
+   with the index when the memory is cleaned and invalidated */
+#define BC_MEMORY_ALIGNMENT         (32UL)
+
+/* Golden ratio multiplier for the line number hash */
+#define BC_HASH_MULTIPLIER          (0x9E3779B1UL)
+
+/* The largest block count of the 10 byte SCSI read and write commands */
+#define BC_MAX_BLOCKS_10            (0xFFFFUL)
+
 /***********************************************************************************
 Typedefs
 ***********************************************************************************/
 
+typedef struct _BCIDX *PBCIDX;
+
 /* The structure if the cache index */
 typedef struct _BCIDX
 {
-    /* The cache status */
-    union {
-            unsigned long   ulStatus;
-        struct {
-            /* Set when the cache entry is valid */
-            unsigned long   Valid:1;
-            /* The used count for the LRU entry replacement */
-            unsigned long   Count:31;
-        } Field;
-    } Status;
-    /* The tag */
+    /* Set when the cache entry is valid */
+    int     iValid;
+    /* Set when the line holds data not yet written to the device */
+    int     iDirty;
+    /* The tag - the first sector of the line */
     unsigned long   ulSector;
-} BCIDX,
-*PBCIDX;
+    /* The next entry in the same hash bucket */
+    PBCIDX  pHashNext;
+    /* The LRU list links, the head is the most recently used entry */
+    PBCIDX  pLruPrev;
+    PBCIDX  pLruNext;
+} BCIDX;
 
 /* The structure of the cache object */
 typedef struct _BCACHE
@@ -87,6 +101,39 @@ typedef struct _BCACHE
     unsigned long ulNumBlocks;
     /* Pointer to the start of the index */
     PBCIDX  pIndex;
+    /* The hash table of valid entries, indexed by line number */
+    PBCIDX  *ppHash;
+    /* The number of hash buckets - 1 (the table size is a power of 2) */
+    unsigned long ulHashMask;
+    /* The most and least recently used entries */
+    PBCIDX  pLruHead;
+    PBCIDX  pLruTail;
+    /* The cache statistics */
+    BCSTATS stats;
+    /* The maximum number of lines to read in one command, 0 to disable */
+    int     iReadAheadLines;
+    /* The number of sequential line accesses before read-ahead starts */
+    int     iSequentialThreshold;
+    /* The line most recently accessed and the sequential access count */
+    unsigned long ulLastLine;
+    int     iSequentialCount;
+    /* The maximum number of dirty lines written in one command, 0 for
+       write-through operation */
+    int     iWriteBurstLines;
+    /* The number of dirty lines */
+    int     iNumDirty;
+    /* Work space to sort the dirty lines when they are written back */
+    PBCIDX  *ppFlushList;
+    /* The buffer used to transfer several lines in one command */
+    unsigned char *pbyStaging;
+    /* The number of lines the staging buffer holds */
+    int     iStagingLines;
+    /* Set to use the 16 byte SCSI commands */
+    int     iLongCommands;
+    /* The mutex that serialises access to the cache */
+    void    *pMutex;
+    /* Set when no write back claimed by bcClaimFlush is in progress */
+    event_t evFlushIdle;
     /* Pointer to the start of cache memory */
     unsigned char *pbyCache;
 
@@ -100,9 +147,43 @@ static unsigned char *bcSearch(PBACHE         pBlkCache,
                                unsigned long  ulSector,
                                PBCIDX        *ppEntry);
 static unsigned char *bcGetEntry(PBACHE pBlkCache, PBCIDX *ppEntry);
-static int bcInvalidate(PBACHE         pBlkCache,
-                       unsigned long  ulSector,
-                       unsigned long  ulNumSectors);
+static void bcCopyRange(PBACHE         pBlkCache,
+                        unsigned char *pbyBuffer,
+                        unsigned long  ulSector,
+                        unsigned long  ulNumSectors,
+                        int            iToCache);
+static unsigned long bcReadSectors(PBACHE         pBlkCache,
+                                   unsigned char *pbyBuffer,
+                                   unsigned long  ulSector,
+                                   unsigned long  ulNumberOfSectors);
+static unsigned long bcWriteSectors(PBACHE               pBlkCache,
+                                    const unsigned char *pbyBuffer,
+                                    unsigned long        ulSector,
+                                    unsigned long        ulNumberOfSectors);
+static int bcFlushLines(PBACHE pBlkCache);
+static int bcCompareSector(const void *pvEntryA, const void *pvEntryB);
+static int bcSetStaging(PBACHE pBlkCache, int iLines);
+static unsigned char *bcLineMemory(PBACHE pBlkCache, PBCIDX pEntry);
+static PBCIDX bcFindEntry(PBACHE pBlkCache, unsigned long ulCacheSector);
+static unsigned long bcHash(PBACHE pBlkCache, unsigned long ulCacheSector);
+static void bcHashInsert(PBACHE pBlkCache, PBCIDX pEntry);
+static void bcHashRemove(PBACHE pBlkCache, PBCIDX pEntry);
+static void bcLruUnlink(PBACHE pBlkCache, PBCIDX pEntry);
+static void bcLruMakeHead(PBACHE pBlkCache, PBCIDX pEntry);
+static void bcLruMakeTail(PBACHE pBlkCache, PBCIDX pEntry);
+static void bcDiscardEntry(PBACHE pBlkCache, PBCIDX pEntry);
+static int bcIsSequential(PBACHE pBlkCache, unsigned long ulCacheSector);
+static unsigned char *bcFill(PBACHE         pBlkCache,
+                             unsigned long  ulCacheSector,
+                             unsigned long  ulNumLines);
+static int bcReadDevice(PBACHE         pBlkCache,
+                        unsigned long  ulSector,
+                        unsigned long  ulNumberOfSectors,
+                        unsigned char *pbyDest);
+static int bcWriteDevice(PBACHE               pBlkCache,
+                         unsigned long        ulSector,
+                         unsigned long        ulNumberOfSectors,
+                         const unsigned char *pbySrc);
 
 extern  int scsiRead10(int      iMsDev,
                        int      iLun,
@@ -118,6 +199,20 @@ extern  int scsiWrite10(int     iMsDev,
                         PBYTE   pbySrc,
                         size_t  stSrcLength,
                         size_t  *pstLengthWritten);
+extern  int scsiRead16(int       iMsDev,
+                       int       iLun,
+                       uint64_t  qwLBA,
+                       DWORD     dwNumBlocks,
+                       PBYTE     pbyDest,
+                       size_t    stDestLength,
+                       size_t    *pstLengthRead);
+extern  int scsiWrite16(int      iMsDev,
+                        int      iLun,
+                        uint64_t qwLBA,
+                        DWORD    dwNumBlocks,
+                        PBYTE    pbySrc,
+                        size_t   stSrcLength,
+                        size_t   *pstLengthWritten);
 
 /***********************************************************************************
 Public Functions
@@ -141,29 +236,82 @@ PBACHE bcCreate(int iMsDev,
                 unsigned long ulNumBlocks)
 {
     PBACHE  pBlkCache;
+    unsigned long ulNumBuckets = 1UL;
+    size_t  stIndexSize;
+    size_t  stHashSize;
     size_t  stSize = sizeof(BCACHE);
 
-    /* Add on the size of the cache memory */
-    stSize += (size_t)(iLineSize * iNumEntries * iBlockSize);
+    if ((iLineSize <= 0) || (iNumEntries <= 0) || (iBlockSize <= 0))
+    {
+        return NULL;
+    }
+
+    /* Use a power of 2 number of hash buckets, at least as many as entries,
+       so that the chains stay short */
+    while (ulNumBuckets < (unsigned long)iNumEntries)
+    {
+        ulNumBuckets <<= 1;
+    }
+    stIndexSize = sizeof(BCIDX) * (size_t)iNumEntries;
+    stHashSize = sizeof(PBCIDX) * (size_t)ulNumBuckets;
+
+    /* Add on the size of the index, the hash table and the flush list */
+    stSize += stIndexSize + stHashSize;
+    stSize += sizeof(PBCIDX) * (size_t)iNumEntries;
 
-    /* Add on the size of the index */
-    stSize += (size_t)(sizeof(BCIDX) * (unsigned int)iNumEntries);
+    /* Add on the size of the cache memory and the space to align it */
+    stSize += (size_t)(iLineSize * iNumEntries * iBlockSize);
+    stSize += (size_t)BC_MEMORY_ALIGNMENT;
 
     /* Allocate the memory */
     pBlkCache = (PBACHE)R_OS_AllocMem(stSize, R_REGION_LARGE_CAPACITY_RAM);
     if (pBlkCache)
     {
+        int iEntry;
+
         /* Initialise the data */
+        memset(pBlkCache, 0, sizeof(BCACHE));
         pBlkCache->iMsDev = iMsDev;
         pBlkCache->iLun = iLun;
         pBlkCache->iLineSize = iLineSize;
         pBlkCache->iNumEntries = iNumEntries;
         pBlkCache->iBlockSize = iBlockSize;
         pBlkCache->ulNumBlocks = ulNumBlocks;
+        pBlkCache->ulHashMask = ulNumBuckets - 1UL;
         pBlkCache->pIndex =  (PBCIDX)(((char*)pBlkCache) + sizeof(BCACHE));
-        pBlkCache->pbyCache = (unsigned char*)((char*)pBlkCache->pIndex + (sizeof(BCIDX) * (unsigned long)iNumEntries));
-        memset((int*)pBlkCache->pIndex, 0, (sizeof(BCIDX) * (unsigned long)iNumEntries));
+        pBlkCache->ppHash = (PBCIDX*)(((char*)pBlkCache->pIndex) + stIndexSize);
+        pBlkCache->ppFlushList = (PBCIDX*)(((char*)pBlkCache->ppHash) + stHashSize);
+        pBlkCache->pbyCache = (unsigned char*)((((unsigned long)pBlkCache->ppFlushList)
+                                              + (sizeof(PBCIDX) * (size_t)iNumEntries)
+                                              + (BC_MEMORY_ALIGNMENT - 1UL))
+                                              & ~(BC_MEMORY_ALIGNMENT - 1UL));
+        memset(pBlkCache->pIndex, 0, stIndexSize);
+        memset(pBlkCache->ppHash, 0, stHashSize);
         memset(pBlkCache->pbyCache, 0, (size_t)(iLineSize * iNumEntries * iBlockSize));
+
+        /* All the entries start on the LRU list as free entries */
+        for (iEntry = 0; iEntry < iNumEntries; iEntry++)
+        {
+            bcLruMakeTail(pBlkCache, &pBlkCache->pIndex[iEntry]);
+        }
+
+        /* The flush timer runs in a different task to the file system */
+        pBlkCache->pMutex = R_OS_CreateMutex();
+        if (!pBlkCache->pMutex)
+        {
+            R_OS_FreeMem(pBlkCache);
+            pBlkCache = NULL;
+        }
+        else if (!R_OS_CreateEvent(&pBlkCache->evFlushIdle))
+        {
+            R_OS_DeleteMutex(pBlkCache->pMutex);
+            R_OS_FreeMem(pBlkCache);
+            pBlkCache = NULL;
+        }
+        else
+        {
+            R_OS_SetEvent(&pBlkCache->evFlushIdle);
+        }
     }
     return pBlkCache;
 }
@@ -179,12 +327,127 @@ Return value:  none
 **********************************************************************************/
 void bcDestroy(PBACHE pBlkCache)
 {
+    /* The drive may have been created without a cache */
+    if (!pBlkCache)
+    {
+        return;
+    }
+
+    /* Write back anything left in the cache, the drive is being dismounted */
+    bcFlush(pBlkCache);
+    R_OS_DeleteMutex(pBlkCache->pMutex);
+    R_OS_DeleteEvent(&pBlkCache->evFlushIdle);
+    if (pBlkCache->pbyStaging)
+    {
+        R_OS_FreeMem(pBlkCache->pbyStaging);
+    }
     R_OS_FreeMem(pBlkCache);
 }
 /**********************************************************************************
 End of function  bcDestroy
 ***********************************************************************************/
 
+/**********************************************************************************
+Function Name: bcSetReadAhead
+Description:   Function to configure the read-ahead of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iReadAheadLines - The maximum number of lines read in one
+                                     command, 0 to disable read-ahead
+               IN  iSequentialThreshold - The number of sequential line
+                                          accesses before read-ahead starts
+Return value:  0 for success -1 on error
+**********************************************************************************/
+int bcSetReadAhead(PBACHE pBlkCache, int iReadAheadLines, int iSequentialThreshold)
+{
+    int     iResult;
+
+    if ((iReadAheadLines < 0) || (iSequentialThreshold < 0))
+    {
+        return -1;
+    }
+
+    /* Keep at least half of the cache for lines that are not read ahead */
+    if (iReadAheadLines > (pBlkCache->iNumEntries / 2))
+    {
+        iReadAheadLines = pBlkCache->iNumEntries / 2;
+    }
+
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    iResult = bcSetStaging(pBlkCache, (iReadAheadLines > pBlkCache->iWriteBurstLines)
+                                      ? iReadAheadLines : pBlkCache->iWriteBurstLines);
+    if (!iResult)
+    {
+        pBlkCache->iReadAheadLines = iReadAheadLines;
+        pBlkCache->iSequentialThreshold = iSequentialThreshold;
+        pBlkCache->iSequentialCount = 0;
+    }
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+    return iResult;
+}
+/**********************************************************************************
+End of function  bcSetReadAhead
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcSetWriteBack
+Description:   Function to select write-back or write-through operation
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iWriteBurstLines - The maximum number of dirty lines
+                                      written in one command, 0 to write
+                                      through to the device
+Return value:  0 for success -1 on error
+**********************************************************************************/
+int bcSetWriteBack(PBACHE pBlkCache, int iWriteBurstLines)
+{
+    int     iResult;
+
+    if (iWriteBurstLines < 0)
+    {
+        return -1;
+    }
+    if (iWriteBurstLines > pBlkCache->iNumEntries)
+    {
+        iWriteBurstLines = pBlkCache->iNumEntries;
+    }
+
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    /* Nothing may be left dirty when going back to write-through */
+    iResult = (iWriteBurstLines) ? 0 : bcFlushLines(pBlkCache);
+    if (!iResult)
+    {
+        iResult = bcSetStaging(pBlkCache, (iWriteBurstLines > pBlkCache->iReadAheadLines)
+                                          ? iWriteBurstLines : pBlkCache->iReadAheadLines);
+    }
+    if (!iResult)
+    {
+        pBlkCache->iWriteBurstLines = iWriteBurstLines;
+    }
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+    return iResult;
+}
+/**********************************************************************************
+End of function  bcSetWriteBack
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcSetLongCommands
+Description:   Function to select the 16 byte SCSI commands. These take a 32
+               bit block count so a large transfer is one command, but not all
+               devices support them
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iLongCommands - TRUE to use the 16 byte commands
+Return value:  none
+**********************************************************************************/
+void bcSetLongCommands(PBACHE pBlkCache, int iLongCommands)
+{
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    pBlkCache->iLongCommands = iLongCommands;
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+}
+/**********************************************************************************
+End of function  bcSetLongCommands
+***********************************************************************************/
+
 /**********************************************************************************
 Function Name: bcRead
 Description:   Function to read with cache
@@ -199,66 +462,11 @@ unsigned long bcRead(PBACHE         pBlkCache,
                      unsigned long  ulSector,
                      unsigned long  ulNumberOfSectors)
 {
-    unsigned long ulCacheSector = (ulSector - (ulSector % (unsigned long)pBlkCache->iLineSize));
-    size_t  stLengthRead;
-
-    /* Cache only for small & frequent requests */
-    if ((ulNumberOfSectors == 1UL)
-    &&  ((ulCacheSector + (unsigned long)pBlkCache->iLineSize) < (unsigned long)pBlkCache->ulNumBlocks))
-    {
-        PBCIDX  pEntry;
-        /* Search the cache for this entry */
-        unsigned char *pbyCache = bcSearch(pBlkCache, ulSector, &pEntry);
-        if (!pbyCache)
-        {
-            /* Get a new cache entry */
-            volatile size_t  stLength = (size_t)(pBlkCache->iLineSize * pBlkCache->iBlockSize);
-            pbyCache = bcGetEntry(pBlkCache, &pEntry);
-
-            R_CACHE_L1_CleanInvalidLine((uint32_t) pbyCache,stLength);
-            
-            /* Read into the cache memory */
-            if (scsiRead10(pBlkCache->iMsDev,
-                           pBlkCache->iLun,
-                           ulCacheSector,
-                           (WORD)pBlkCache->iLineSize,
-                           pbyCache,
-                           stLength,
-                           &stLengthRead))
-            {
-                /* Device driver error */
-                return 0UL;
-            }
-#ifdef DEBUG
-            dump_sector2(ulSector, pbyCache);
-#endif
-
-            /* Set the start sector */
-            pEntry->ulSector = ulCacheSector;
-            /* Set the valid flag */
-            pEntry->Status.Field.Valid = TRUE;
-            /* Set the sector address */
-            pbyCache = pbyCache + ((ulSector - ulCacheSector) * (unsigned long)pBlkCache->iBlockSize);
-        }
-        /* Copy to the destination */
-        memcpy(pbyBuffer, pbyCache, (size_t)pBlkCache->iBlockSize);
-        return 1UL;
-    }
-    /* Read directly into memory */
-    if (scsiRead10(pBlkCache->iMsDev,
-                   pBlkCache->iLun,
-                   ulSector,
-                   (WORD)ulNumberOfSectors,
-                   pbyBuffer,
-                   (size_t)(ulNumberOfSectors * (unsigned long)pBlkCache->iBlockSize),
-                   &stLengthRead))
-    {
-        /* Device driver error */
-        return 0UL;
-    }
-   // dump_sector2(ulSector, pbyBuffer);
-
-    return ulNumberOfSectors;
+    unsigned long ulResult;
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    ulResult = bcReadSectors(pBlkCache, pbyBuffer, ulSector, ulNumberOfSectors);
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+    return ulResult;
 }
 /**********************************************************************************
 End of function  bcRead
@@ -278,25 +486,131 @@ unsigned long bcWrite(PBACHE         pBlkCache,
                       unsigned long  ulSector,
                       unsigned long  ulNumberOfSectors)
 {
-    size_t  stLengthWritten;
-    /* Invalidate any entries in the cache which are in this area */
-    bcInvalidate(pBlkCache, ulSector, ulNumberOfSectors);
-    /* Write directly to the device */
-    if (scsiWrite10(pBlkCache->iMsDev,
-                    pBlkCache->iLun,
-                    ulSector,
-                    (WORD)ulNumberOfSectors,
-                    (PBYTE)pbyBuffer,
-                    (size_t)(ulNumberOfSectors * (unsigned long)pBlkCache->iBlockSize),
-                    &stLengthWritten))
+    unsigned long ulResult;
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    ulResult = bcWriteSectors(pBlkCache, pbyBuffer, ulSector, ulNumberOfSectors);
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+    return ulResult;
+}
+/**********************************************************************************
+End of function  bcWrite
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcFlush
+Description:   Function to write all the dirty lines to the device
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  0 for success -1 on error
+**********************************************************************************/
+int bcFlush(PBACHE pBlkCache)
+{
+    int     iResult;
+    if (!pBlkCache)
     {
-        /* Device driver error */
-        return 0UL;
+        return 0;
     }
-    return ulNumberOfSectors;
+    R_OS_AcquireMutex(pBlkCache->pMutex);
+    iResult = bcFlushLines(pBlkCache);
+    R_OS_ReleaseMutex(pBlkCache->pMutex);
+    return iResult;
 }
 /**********************************************************************************
-End of function  bcWrite
+End of function  bcFlush
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcClaimFlush
+Description:   Function to mark the cache as being written back by another task,
+               called before the task lets go of the lock that keeps the cache
+               from being destroyed
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+void bcClaimFlush(PBACHE pBlkCache)
+{
+    if (pBlkCache)
+    {
+        R_OS_ResetEvent(&pBlkCache->evFlushIdle);
+    }
+}
+/**********************************************************************************
+End of function  bcClaimFlush
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcReleaseFlush
+Description:   Function to end a write back claimed by bcClaimFlush. The cache
+               may be destroyed as soon as this returns
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+void bcReleaseFlush(PBACHE pBlkCache)
+{
+    if (pBlkCache)
+    {
+        R_OS_SetEvent(&pBlkCache->evFlushIdle);
+    }
+}
+/**********************************************************************************
+End of function  bcReleaseFlush
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcWaitFlush
+Description:   Function to wait for a write back claimed by bcClaimFlush to end
+               before the cache is destroyed. Only one task may wait
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+void bcWaitFlush(PBACHE pBlkCache)
+{
+    if (pBlkCache)
+    {
+        R_OS_WaitForEvent(&pBlkCache->evFlushIdle, R_OS_ABSTRACTION_PRV_EV_WAIT_INFINITE);
+    }
+}
+/**********************************************************************************
+End of function  bcWaitFlush
+***********************************************************************************/
+
+
+/**********************************************************************************
+Function Name: bcGetStatistics
+Description:   Function to get the statistics of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               OUT pStats - Pointer to the destination statistics
+Return value:  none
+**********************************************************************************/
+void bcGetStatistics(PBACHE pBlkCache, PBCSTATS pStats)
+{
+    if ((pBlkCache) && (pStats))
+    {
+        R_OS_AcquireMutex(pBlkCache->pMutex);
+        *pStats = pBlkCache->stats;
+        R_OS_ReleaseMutex(pBlkCache->pMutex);
+    }
+}
+/**********************************************************************************
+End of function  bcGetStatistics
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcResetStatistics
+Description:   Function to reset the statistics of a block cache
+Parameters:    IN  pBlkCache - Pointer to the block cache
+Return value:  none
+**********************************************************************************/
+void bcResetStatistics(PBACHE pBlkCache)
+{
+    if (pBlkCache)
+    {
+        R_OS_AcquireMutex(pBlkCache->pMutex);
+        memset(&pBlkCache->stats, 0, sizeof(BCSTATS));
+        R_OS_ReleaseMutex(pBlkCache->pMutex);
+    }
+}
+/**********************************************************************************
+End of function  bcResetStatistics
 ***********************************************************************************/
 
 /***********************************************************************************
@@ -304,130 +618,912 @@ Private Functions
 ***********************************************************************************/
 
 /**********************************************************************************
-Function Name: bcSearch
-Description:   Function to search the cache for a valid entry
+Function Name: bcReadSectors
+Description:   Function to read with cache, the caller holds the mutex
 Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pbyBuffer - Pointer to the destinaton buffer memory
                IN  ulSector - The starting sector (block)
-               OUT ppEntry - Pointer to the entry pointer
-Return value:  Pointer to the cache memory or NULL if not found
+               IN  ulNumberOfSectors - The number of sectors (blocks)
+Return value:  The number of blocks read
 **********************************************************************************/
-static unsigned char *bcSearch(PBACHE         pBlkCache,
-                               unsigned long  ulSector,
-                               PBCIDX        *ppEntry)
+static unsigned long bcReadSectors(PBACHE         pBlkCache,
+                                   unsigned char *pbyBuffer,
+                                   unsigned long  ulSector,
+                                   unsigned long  ulNumberOfSectors)
 {
-    PBCIDX  pEntry = pBlkCache->pIndex;
-    PBCIDX  pEnd = pEntry + pBlkCache->iNumEntries;
-    /* Search each entry in the cache index */
-    while (pEntry < pEnd)
+    unsigned long ulLineSize = (unsigned long)pBlkCache->iLineSize;
+    unsigned long ulEndSector = ulSector + ulNumberOfSectors;
+    unsigned long ulCacheSector = (ulSector - (ulSector % ulLineSize));
+    unsigned long ulLastCacheSector;
+    unsigned long ulNumLines;
+
+    if (!ulNumberOfSectors)
     {
-        /* If the entry is valid */
-        if ((pEntry->Status.Field.Valid)
-        /* And the sector is within the line */
-        &&  (ulSector >= pEntry->ulSector)
-        &&  (ulSector < (unsigned long)((unsigned long)pEntry->ulSector + (unsigned long)pBlkCache->iLineSize)))
+        return 0UL;
+    }
+    ulLastCacheSector = ((ulEndSector - 1UL) - ((ulEndSector - 1UL) % ulLineSize));
+    ulNumLines = ((ulLastCacheSector - ulCacheSector) / ulLineSize) + 1UL;
+
+    /* Cache only for small & frequent requests */
+    if (((ulNumberOfSectors == 1UL) || (ulNumLines <= (unsigned long)pBlkCache->iReadAheadLines))
+    &&  ((ulLastCacheSector + ulLineSize) < (unsigned long)pBlkCache->ulNumBlocks))
+    {
+        while (ulSector < ulEndSector)
         {
-            /* Calculate the position in the cache memory */
-            unsigned char *pbySrc = (pBlkCache->pbyCache
-                                  + ((pEntry - pBlkCache->pIndex)
-                                  * pBlkCache->iLineSize * pBlkCache->iBlockSize)
-                                  + ((ulSector - (unsigned long)pEntry->ulSector) * (unsigned long)pBlkCache->iBlockSize));
-            if (ppEntry)
+            unsigned long ulLineEnd = ulCacheSector + ulLineSize;
+            unsigned long ulCount = ((ulEndSector < ulLineEnd) ? ulEndSector : ulLineEnd) - ulSector;
+            int     iSequential = bcIsSequential(pBlkCache, ulCacheSector);
+            /* Search the cache for this entry */
+            unsigned char *pbyCache = bcSearch(pBlkCache, ulSector, NULL);
+            if (!pbyCache)
             {
-                *ppEntry = pEntry;
+                /* Read the rest of the request, and the lines after it when
+                   the drive is being read sequentially */
+                unsigned long ulFillLines = ((ulLastCacheSector - ulCacheSector) / ulLineSize) + 1UL;
+                if ((iSequential) && (ulFillLines < (unsigned long)pBlkCache->iReadAheadLines))
+                {
+                    ulFillLines = (unsigned long)pBlkCache->iReadAheadLines;
+                }
+                pbyCache = bcFill(pBlkCache, ulCacheSector, ulFillLines);
+                if (!pbyCache)
+                {
+                    /* Device driver error */
+                    return 0UL;
+                }
+#ifdef DEBUG
+                dump_sector2(ulSector, pbyCache);
+#endif
+                /* Set the sector address */
+                pbyCache = pbyCache + ((ulSector - ulCacheSector) * (unsigned long)pBlkCache->iBlockSize);
             }
-            return pbySrc;
+            /* Copy to the destination */
+            memcpy(pbyBuffer, pbyCache, (size_t)(ulCount * (unsigned long)pBlkCache->iBlockSize));
+            pbyBuffer += ulCount * (unsigned long)pBlkCache->iBlockSize;
+            ulSector += ulCount;
+            ulCacheSector = ulLineEnd;
         }
-        /* Count the times each entry is searched */
-        pEntry->Status.Field.Count++;
-        pEntry++;
+        return ulNumberOfSectors;
     }
-    return NULL;
+    /* Read directly into memory */
+    if (bcReadDevice(pBlkCache, ulSector, ulNumberOfSectors, pbyBuffer))
+    {
+        /* Device driver error */
+        return 0UL;
+    }
+   // dump_sector2(ulSector, pbyBuffer);
+
+    /* Lines not yet written back are newer than the media */
+    if (pBlkCache->iNumDirty)
+    {
+        bcCopyRange(pBlkCache, pbyBuffer, ulSector, ulNumberOfSectors, FALSE);
+    }
+
+    return ulNumberOfSectors;
 }
 /**********************************************************************************
-End of function  bcSearch
+End of function  bcReadSectors
 ***********************************************************************************/
 
 /**********************************************************************************
-Function Name: bcGetEntry
-Description:   Function to get a pointer to a free entry
+Function Name: bcWriteSectors
+Description:   Function to write with cache, the caller holds the mutex
 Parameters:    IN  pBlkCache - Pointer to the block cache
-               OUT ppEntry - Pointer to an entry pointer
-Return value:  Pointer to the cache memory associated with the entry
+               IN  pbyBuffer - Pointer to the source buffer memory
+               IN  ulSector - The starting sector (block)
+               IN  ulNumberOfSectors - The number of sectors (blocks)
+Return value:  The number of blocks written
 **********************************************************************************/
-static unsigned char *bcGetEntry(PBACHE pBlkCache, PBCIDX *ppEntry)
+static unsigned long bcWriteSectors(PBACHE               pBlkCache,
+                                    const unsigned char *pbyBuffer,
+                                    unsigned long        ulSector,
+                                    unsigned long        ulNumberOfSectors)
 {
-    PBCIDX  pEntry = pBlkCache->pIndex;
-    PBCIDX  pResult = pEntry;
-    PBCIDX  pEnd = pEntry + pBlkCache->iNumEntries;
-    unsigned char *pbySrc = pBlkCache->pbyCache;
-    int     iUsedCount = 0;
-    /* Search each entry in the cache index */
-    while (pEntry < pEnd)
+    unsigned long ulLineSize = (unsigned long)pBlkCache->iLineSize;
+    unsigned long ulEndSector = ulSector + ulNumberOfSectors;
+    unsigned long ulCacheSector = (ulSector - (ulSector % ulLineSize));
+    unsigned long ulLastCacheSector;
+    unsigned long ulNumLines;
+
+    if (!ulNumberOfSectors)
     {
-        int iCount = (int)pEntry->Status.Field.Count;
-        /* If an entry is not valid it is good to use */
-        if (!pEntry->Status.Field.Valid)
-        {
-            pResult = pEntry;
-            break;
-        }
-        /* Check for the least recently used */
-        if (iCount > iUsedCount)
+        return 0UL;
+    }
+    ulLastCacheSector = ((ulEndSector - 1UL) - ((ulEndSector - 1UL) % ulLineSize));
+    ulNumLines = ((ulLastCacheSector - ulCacheSector) / ulLineSize) + 1UL;
+
+    /* In write-back mode small writes stay in the cache until flushed */
+    if ((pBlkCache->iWriteBurstLines)
+    &&  ((ulNumberOfSectors == 1UL) || (ulNumLines <= (unsigned long)pBlkCache->iWriteBurstLines))
+    &&  ((ulLastCacheSector + ulLineSize) < (unsigned long)pBlkCache->ulNumBlocks))
+    {
+        while (ulSector < ulEndSector)
         {
-            iUsedCount = iCount;
-            pResult = pEntry;
+            unsigned long ulLineEnd = ulCacheSector + ulLineSize;
+            unsigned long ulCount = ((ulEndSector < ulLineEnd) ? ulEndSector : ulLineEnd) - ulSector;
+            unsigned char *pbyCache;
+            PBCIDX  pEntry = bcFindEntry(pBlkCache, ulCacheSector);
+            if (pEntry)
+            {
+                bcLruMakeHead(pBlkCache, pEntry);
+                pBlkCache->stats.ulHits++;
+            }
+            else if (ulCount == ulLineSize)
+            {
+                /* The whole line is written so there is no need to read it */
+                if (!bcGetEntry(pBlkCache, &pEntry))
+                {
+                    return 0UL;
+                }
+                pEntry->ulSector = ulCacheSector;
+                pEntry->iValid = TRUE;
+                bcHashInsert(pBlkCache, pEntry);
+            }
+            else
+            {
+                /* Read the rest of the line before it is modified */
+                pBlkCache->stats.ulMisses++;
+                if (!bcFill(pBlkCache, ulCacheSector, 1UL))
+                {
+                    return 0UL;
+                }
+                pEntry = bcFindEntry(pBlkCache, ulCacheSector);
+            }
+            pbyCache = bcLineMemory(pBlkCache, pEntry)
+                     + ((ulSector - ulCacheSector) * (unsigned long)pBlkCache->iBlockSize);
+            memcpy(pbyCache, pbyBuffer, (size_t)(ulCount * (unsigned long)pBlkCache->iBlockSize));
+            if (!pEntry->iDirty)
+            {
+                pEntry->iDirty = TRUE;
+                pBlkCache->iNumDirty++;
+            }
+            pbyBuffer += ulCount * (unsigned long)pBlkCache->iBlockSize;
+            ulSector += ulCount;
+            ulCacheSector = ulLineEnd;
         }
-        pEntry++;
+        return ulNumberOfSectors;
     }
-    /* Calculate the position in the cache memory */
-    pbySrc += ((pResult - pBlkCache->pIndex)
-           * pBlkCache->iLineSize * pBlkCache->iBlockSize);
-    /* Return the entry */
-    *ppEntry = pResult;
-    /* Reset the status flags */
-    pResult->Status.ulStatus = 0UL;
-    /* Return the position */
-   return pbySrc;
+
+    /* Keep any lines in the cache which are in this area up to date */
+    bcCopyRange(pBlkCache, (unsigned char*)pbyBuffer, ulSector, ulNumberOfSectors, TRUE);
+    /* Write directly to the device */
+    if (bcWriteDevice(pBlkCache, ulSector, ulNumberOfSectors, pbyBuffer))
+    {
+        /* Device driver error */
+        return 0UL;
+    }
+    return ulNumberOfSectors;
 }
 /**********************************************************************************
-End of function  bcGetEntry
+End of function  bcWriteSectors
 ***********************************************************************************/
 
 /**********************************************************************************
-Function Name: bcInvalidate
-Description:   Function to invalidate any cache entry within the range
+Function Name: bcFlushLines
+Description:   Function to write the dirty lines in sector order, merging
+               adjacent lines into one command, the caller holds the mutex
 Parameters:    IN  pBlkCache - Pointer to the block cache
-               IN  ulSector - The starting sector
-               IN  ulNumSectors - The number of sectors
 Return value:  0 for success -1 on error
 **********************************************************************************/
-static int bcInvalidate(PBACHE         pBlkCache,
-                        unsigned long  ulSector,
-                        unsigned long  ulNumSectors)
+static int bcFlushLines(PBACHE pBlkCache)
 {
+    unsigned long ulLineSize = (unsigned long)pBlkCache->iLineSize;
+    size_t  stLineLength = (size_t)(pBlkCache->iLineSize * pBlkCache->iBlockSize);
+    int     iBurstLines = (pBlkCache->iStagingLines > 1) ? pBlkCache->iStagingLines : 1;
+    int     iNumDirty = 0;
+    int     iResult = 0;
+    int     iFirst = 0;
     PBCIDX  pEntry = pBlkCache->pIndex;
     PBCIDX  pEnd = pEntry + pBlkCache->iNumEntries;
-    unsigned long ulEndSector = ulSector + ulNumSectors;
-    /* Search each entry in the cache index */
+
+    if (!pBlkCache->iNumDirty)
+    {
+        return 0;
+    }
+
+    /* Make a list of the dirty lines in sector order */
     while (pEntry < pEnd)
     {
-        if (pEntry->Status.Field.Valid)
+        if ((pEntry->iValid) && (pEntry->iDirty))
+        {
+            pBlkCache->ppFlushList[iNumDirty++] = pEntry;
+        }
+        pEntry++;
+    }
+    qsort(pBlkCache->ppFlushList, (size_t)iNumDirty, sizeof(PBCIDX), bcCompareSector);
+
+    while (iFirst < iNumDirty)
+    {
+        PBCIDX  *ppRun = &pBlkCache->ppFlushList[iFirst];
+        int     iContiguous = TRUE;
+        int     iWriteError = 0;
+        int     iLines = 1;
+        int     iLine;
+
+        /* Find the run of lines that are next to each other on the media */
+        while (((iFirst + iLines) < iNumDirty)
+        &&     (iLines < iBurstLines)
+        &&     (ppRun[iLines]->ulSector == (ppRun[iLines - 1]->ulSector + ulLineSize)))
+        {
+            if (ppRun[iLines] != (ppRun[iLines - 1] + 1))
+            {
+                iContiguous = FALSE;
+            }
+            iLines++;
+        }
+
+        if (iContiguous)
+        {
+            /* The lines are next to each other in the cache memory too */
+            if (bcWriteDevice(pBlkCache, ppRun[0]->ulSector,
+                              (unsigned long)iLines * ulLineSize,
+                              bcLineMemory(pBlkCache, ppRun[0])))
+            {
+                iWriteError = -1;
+            }
+        }
+        else
+        {
+            for (iLine = 0; iLine < iLines; iLine++)
+            {
+                memcpy(pBlkCache->pbyStaging + ((size_t)iLine * stLineLength),
+                       bcLineMemory(pBlkCache, ppRun[iLine]),
+                       stLineLength);
+            }
+            if (bcWriteDevice(pBlkCache, ppRun[0]->ulSector,
+                              (unsigned long)iLines * ulLineSize,
+                              pBlkCache->pbyStaging))
+            {
+                iWriteError = -1;
+            }
+        }
+
+        /* Lines that failed stay dirty for the next attempt */
+        if (iWriteError)
+        {
+            iResult = -1;
+        }
+        else
+        {
+            for (iLine = 0; iLine < iLines; iLine++)
+            {
+                ppRun[iLine]->iDirty = FALSE;
+                pBlkCache->iNumDirty--;
+            }
+        }
+        iFirst += iLines;
+    }
+    pBlkCache->stats.ulFlushes++;
+    return iResult;
+}
+/**********************************************************************************
+End of function  bcFlushLines
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcCompareSector
+Description:   Function to compare the sectors of two entries for qsort
+Parameters:    IN  pvEntryA - Pointer to the first entry pointer
+               IN  pvEntryB - Pointer to the second entry pointer
+Return value:  <0, 0 or >0 as the first sector is below, equal or above
+**********************************************************************************/
+static int bcCompareSector(const void *pvEntryA, const void *pvEntryB)
+{
+    unsigned long ulSectorA = (*(const PBCIDX*)pvEntryA)->ulSector;
+    unsigned long ulSectorB = (*(const PBCIDX*)pvEntryB)->ulSector;
+    if (ulSectorA < ulSectorB)
+    {
+        return -1;
+    }
+    return (ulSectorA > ulSectorB) ? 1 : 0;
+}
+/**********************************************************************************
+End of function  bcCompareSector
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcSetStaging
+Description:   Function to size the buffer for multi-line transfers
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  iLines - The number of lines the buffer must hold
+Return value:  0 for success -1 on error
+**********************************************************************************/
+static int bcSetStaging(PBACHE pBlkCache, int iLines)
+{
+    unsigned char *pbyStaging = NULL;
+
+    if (iLines == pBlkCache->iStagingLines)
+    {
+        return 0;
+    }
+
+    /* A multi-line transfer is copied through a staging buffer, because the
+       lines need not be adjacent in the cache memory */
+    if (iLines > 1)
+    {
+        pbyStaging = (unsigned char*)R_OS_AllocMem((size_t)(iLines
+                                                  * pBlkCache->iLineSize
+                                                  * pBlkCache->iBlockSize),
+                                                  R_REGION_LARGE_CAPACITY_RAM);
+        if (!pbyStaging)
+        {
+            return -1;
+        }
+    }
+    if (pBlkCache->pbyStaging)
+    {
+        R_OS_FreeMem(pBlkCache->pbyStaging);
+    }
+    pBlkCache->pbyStaging = pbyStaging;
+    pBlkCache->iStagingLines = (pbyStaging) ? iLines : 0;
+    return 0;
+}
+/**********************************************************************************
+End of function  bcSetStaging
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcLineMemory
+Description:   Function to get the cache memory of an entry
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  Pointer to the cache memory of the entry
+**********************************************************************************/
+static unsigned char *bcLineMemory(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    return (pBlkCache->pbyCache
+            + ((pEntry - pBlkCache->pIndex)
+            * pBlkCache->iLineSize * pBlkCache->iBlockSize));
+}
+/**********************************************************************************
+End of function  bcLineMemory
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcSearch
+Description:   Function to search the cache for a valid entry
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulSector - The starting sector (block)
+               OUT ppEntry - Pointer to the entry pointer
+Return value:  Pointer to the cache memory or NULL if not found
+**********************************************************************************/
+static unsigned char *bcSearch(PBACHE         pBlkCache,
+                               unsigned long  ulSector,
+                               PBCIDX        *ppEntry)
+{
+    unsigned long ulCacheSector = (ulSector - (ulSector % (unsigned long)pBlkCache->iLineSize));
+    PBCIDX  pEntry = bcFindEntry(pBlkCache, ulCacheSector);
+    if (pEntry)
+    {
+        /* Calculate the position in the cache memory */
+        unsigned char *pbySrc = (pBlkCache->pbyCache
+                              + ((pEntry - pBlkCache->pIndex)
+                              * pBlkCache->iLineSize * pBlkCache->iBlockSize)
+                              + ((ulSector - ulCacheSector) * (unsigned long)pBlkCache->iBlockSize));
+        /* This is now the most recently used entry */
+        bcLruMakeHead(pBlkCache, pEntry);
+        pBlkCache->stats.ulHits++;
+        if (ppEntry)
+        {
+            *ppEntry = pEntry;
+        }
+        return pbySrc;
+    }
+    pBlkCache->stats.ulMisses++;
+    return NULL;
+}
+/**********************************************************************************
+End of function  bcSearch
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcGetEntry
+Description:   Function to get a pointer to a free entry
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               OUT ppEntry - Pointer to an entry pointer
+Return value:  Pointer to the cache memory associated with the entry or NULL if
+               a dirty line could not be written back to make room
+**********************************************************************************/
+static unsigned char *bcGetEntry(PBACHE pBlkCache, PBCIDX *ppEntry)
+{
+    /* Free entries are kept at the tail of the LRU list, so the tail is
+       either free or the least recently used */
+    PBCIDX  pResult = pBlkCache->pLruTail;
+    if (pResult->iValid)
+    {
+        /* A dirty line must reach the device before it is re-used */
+        if (pResult->iDirty)
+        {
+            if (bcWriteDevice(pBlkCache, pResult->ulSector,
+                              (unsigned long)pBlkCache->iLineSize,
+                              bcLineMemory(pBlkCache, pResult)))
+            {
+                return NULL;
+            }
+            pResult->iDirty = FALSE;
+            pBlkCache->iNumDirty--;
+        }
+        bcDiscardEntry(pBlkCache, pResult);
+        pBlkCache->stats.ulEvictions++;
+    }
+    /* The new entry will be the most recently used */
+    bcLruMakeHead(pBlkCache, pResult);
+    /* Return the entry */
+    *ppEntry = pResult;
+    /* Return the position in the cache memory */
+    return bcLineMemory(pBlkCache, pResult);
+}
+/**********************************************************************************
+End of function  bcGetEntry
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcCopyRange
+Description:   Function to copy between a buffer and the lines within the range
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pbyBuffer - Pointer to the buffer holding the range
+               IN  ulSector - The starting sector
+               IN  ulNumSectors - The number of sectors
+               IN  iToCache - TRUE to update every cached line from the buffer,
+                              FALSE to copy the dirty lines into the buffer
+Return value:  none
+**********************************************************************************/
+static void bcCopyRange(PBACHE         pBlkCache,
+                        unsigned char *pbyBuffer,
+                        unsigned long  ulSector,
+                        unsigned long  ulNumSectors,
+                        int            iToCache)
+{
+    unsigned long ulLineSize = (unsigned long)pBlkCache->iLineSize;
+    unsigned long ulBlockSize = (unsigned long)pBlkCache->iBlockSize;
+    unsigned long ulFirstLine = (ulSector - (ulSector % ulLineSize));
+    unsigned long ulEndSector = ulSector + ulNumSectors;
+    unsigned long ulNumLines = ((ulEndSector - ulFirstLine) + (ulLineSize - 1UL)) / ulLineSize;
+    unsigned long ulLine = ulFirstLine;
+    PBCIDX  pEntry = pBlkCache->pIndex;
+    PBCIDX  pEnd = pEntry + pBlkCache->iNumEntries;
+    /* For short ranges look up each line, otherwise check each entry */
+    int     iLookUp = (ulNumLines <= (unsigned long)pBlkCache->iNumEntries);
+
+    while ((iLookUp) ? (ulLine < ulEndSector) : (pEntry < pEnd))
+    {
+        PBCIDX  pFound = (iLookUp) ? bcFindEntry(pBlkCache, ulLine) : pEntry;
+        if ((pFound)
+        &&  (pFound->iValid)
+        &&  ((iToCache) || (pFound->iDirty))
+        &&  (pFound->ulSector < ulEndSector)
+        &&  ((pFound->ulSector + ulLineSize) > ulSector))
         {
-            unsigned long   ulEntryStart = pEntry->ulSector;
-            unsigned long   ulEntryEnd = (ulEntryStart + (unsigned long)pBlkCache->iLineSize);
-            if (((ulSector >= ulEntryStart) && (ulSector < ulEntryEnd))
-            ||  ((ulEndSector >= ulEntryStart) && (ulEndSector < ulEntryEnd)))
+            unsigned long ulStart = (pFound->ulSector > ulSector) ? pFound->ulSector : ulSector;
+            unsigned long ulEnd = ((pFound->ulSector + ulLineSize) < ulEndSector)
+                                ? (pFound->ulSector + ulLineSize) : ulEndSector;
+            unsigned char *pbyLine = bcLineMemory(pBlkCache, pFound)
+                                   + ((ulStart - pFound->ulSector) * ulBlockSize);
+            unsigned char *pbyData = pbyBuffer + ((ulStart - ulSector) * ulBlockSize);
+            if (iToCache)
+            {
+                memcpy(pbyLine, pbyData, (size_t)((ulEnd - ulStart) * ulBlockSize));
+            }
+            else
             {
-                /* Invalidate */
-                pEntry->Status.ulStatus = 0;
+                memcpy(pbyData, pbyLine, (size_t)((ulEnd - ulStart) * ulBlockSize));
             }
         }
+        ulLine += ulLineSize;
         pEntry++;
     }
+}
+/**********************************************************************************
+End of function  bcCopyRange
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcIsSequential
+Description:   Function to track the access pattern of the drive
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulCacheSector - The first sector of the line being accessed
+Return value:  TRUE if the drive is being read sequentially
+**********************************************************************************/
+static int bcIsSequential(PBACHE pBlkCache, unsigned long ulCacheSector)
+{
+    if (ulCacheSector == (pBlkCache->ulLastLine + (unsigned long)pBlkCache->iLineSize))
+    {
+        if (pBlkCache->iSequentialCount < pBlkCache->iSequentialThreshold)
+        {
+            pBlkCache->iSequentialCount++;
+        }
+    }
+    else if (ulCacheSector != pBlkCache->ulLastLine)
+    {
+        pBlkCache->iSequentialCount = 0;
+    }
+    pBlkCache->ulLastLine = ulCacheSector;
+    return ((pBlkCache->iReadAheadLines > 1)
+        &&  (pBlkCache->iSequentialCount >= pBlkCache->iSequentialThreshold));
+}
+/**********************************************************************************
+End of function  bcIsSequential
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcFill
+Description:   Function to read a run of missing lines in one command
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulCacheSector - The first sector of the first line, which
+                                   must not be in the cache
+               IN  ulNumLines - The number of lines wanted
+Return value:  Pointer to the cache memory of the first line or NULL on error
+**********************************************************************************/
+static unsigned char *bcFill(PBACHE         pBlkCache,
+                             unsigned long  ulCacheSector,
+                             unsigned long  ulNumLines)
+{
+    unsigned long ulLineSize = (unsigned long)pBlkCache->iLineSize;
+    size_t  stLineLength = (size_t)(pBlkCache->iLineSize * pBlkCache->iBlockSize);
+    unsigned char *pbyFirst = NULL;
+    unsigned long ulLines = 1UL;
+    unsigned long ulLine;
+    PBCIDX  pEntry;
+
+    /* The staging buffer limits the size of a merged transfer */
+    if (ulNumLines > (unsigned long)pBlkCache->iStagingLines)
+    {
+        ulNumLines = (unsigned long)pBlkCache->iStagingLines;
+    }
+
+    /* Merge the following lines while they are missing and on the media */
+    while (ulLines < ulNumLines)
+    {
+        ulLine = ulCacheSector + (ulLines * ulLineSize);
+        if (((ulLine + ulLineSize) >= pBlkCache->ulNumBlocks)
+        ||  (bcFindEntry(pBlkCache, ulLine)))
+        {
+            break;
+        }
+        ulLines++;
+    }
+
+    if (ulLines == 1UL)
+    {
+        /* A single line is read straight into the cache memory */
+        pbyFirst = bcGetEntry(pBlkCache, &pEntry);
+        if (!pbyFirst)
+        {
+            return NULL;
+        }
+        R_CACHE_L1_CleanInvalidLine((uint32_t)pbyFirst, stLineLength);
+        if (bcReadDevice(pBlkCache, ulCacheSector, ulLineSize, pbyFirst))
+        {
+            /* Leave the entry free for the next request */
+            bcLruMakeTail(pBlkCache, pEntry);
+            return NULL;
+        }
+        pEntry->ulSector = ulCacheSector;
+        pEntry->iValid = TRUE;
+        bcHashInsert(pBlkCache, pEntry);
+        return pbyFirst;
+    }
+
+    R_CACHE_L1_CleanInvalidLine((uint32_t)pBlkCache->pbyStaging, stLineLength * ulLines);
+    if (bcReadDevice(pBlkCache, ulCacheSector, ulLines * ulLineSize, pBlkCache->pbyStaging))
+    {
+        return NULL;
+    }
+    pBlkCache->stats.ulReadAheadLines += ulLines - 1UL;
+
+    /* Put the lines into the cache, the first line last so that it is the
+       most recently used */
+    ulLine = ulLines;
+    while (ulLine--)
+    {
+        unsigned char *pbyCache = bcGetEntry(pBlkCache, &pEntry);
+        if (!pbyCache)
+        {
+            return NULL;
+        }
+        memcpy(pbyCache, pBlkCache->pbyStaging + (ulLine * stLineLength), stLineLength);
+        pEntry->ulSector = ulCacheSector + (ulLine * ulLineSize);
+        pEntry->iValid = TRUE;
+        bcHashInsert(pBlkCache, pEntry);
+        pbyFirst = pbyCache;
+    }
+    return pbyFirst;
+}
+/**********************************************************************************
+End of function  bcFill
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcReadDevice
+Description:   Function to read from the device in as few commands as possible
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulSector - The starting sector (block)
+               IN  ulNumberOfSectors - The number of sectors (blocks)
+               OUT pbyDest - Pointer to the destination memory
+Return value:  0 for success -1 on error
+**********************************************************************************/
+static int bcReadDevice(PBACHE         pBlkCache,
+                        unsigned long  ulSector,
+                        unsigned long  ulNumberOfSectors,
+                        unsigned char *pbyDest)
+{
+    size_t  stLengthRead;
+    unsigned long ulBlocks;
+    pBlkCache->stats.ulSectorsRead += ulNumberOfSectors;
+    if (pBlkCache->iLongCommands)
+    {
+        pBlkCache->stats.ulReadCommands++;
+        return (scsiRead16(pBlkCache->iMsDev,
+                           pBlkCache->iLun,
+                           (uint64_t)ulSector,
+                           (DWORD)ulNumberOfSectors,
+                           pbyDest,
+                           (size_t)(ulNumberOfSectors * (unsigned long)pBlkCache->iBlockSize),
+                           &stLengthRead)) ? -1 : 0;
+    }
+    /* The 10 byte command has a 16 bit block count */
+    while (ulNumberOfSectors)
+    {
+        ulBlocks = (ulNumberOfSectors > BC_MAX_BLOCKS_10) ? BC_MAX_BLOCKS_10 : ulNumberOfSectors;
+        pBlkCache->stats.ulReadCommands++;
+        if (scsiRead10(pBlkCache->iMsDev,
+                       pBlkCache->iLun,
+                       ulSector,
+                       (WORD)ulBlocks,
+                       pbyDest,
+                       (size_t)(ulBlocks * (unsigned long)pBlkCache->iBlockSize),
+                       &stLengthRead))
+        {
+            return -1;
+        }
+        ulSector += ulBlocks;
+        ulNumberOfSectors -= ulBlocks;
+        pbyDest += ulBlocks * (unsigned long)pBlkCache->iBlockSize;
+    }
+    return 0;
+}
+/**********************************************************************************
+End of function  bcReadDevice
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcWriteDevice
+Description:   Function to write to the device
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulSector - The starting sector (block)
+               IN  ulNumberOfSectors - The number of sectors (blocks)
+               IN  pbySrc - Pointer to the source memory
+Return value:  0 for success -1 on error
+**********************************************************************************/
+static int bcWriteDevice(PBACHE               pBlkCache,
+                         unsigned long        ulSector,
+                         unsigned long        ulNumberOfSectors,
+                         const unsigned char *pbySrc)
+{
+    size_t  stLengthWritten;
+    unsigned long ulBlocks;
+    pBlkCache->stats.ulSectorsWritten += ulNumberOfSectors;
+    if (pBlkCache->iLongCommands)
+    {
+        pBlkCache->stats.ulWriteCommands++;
+        return (scsiWrite16(pBlkCache->iMsDev,
+                            pBlkCache->iLun,
+                            (uint64_t)ulSector,
+                            (DWORD)ulNumberOfSectors,
+                            (PBYTE)pbySrc,
+                            (size_t)(ulNumberOfSectors * (unsigned long)pBlkCache->iBlockSize),
+                            &stLengthWritten)) ? -1 : 0;
+    }
+    /* The 10 byte command has a 16 bit block count */
+    while (ulNumberOfSectors)
+    {
+        ulBlocks = (ulNumberOfSectors > BC_MAX_BLOCKS_10) ? BC_MAX_BLOCKS_10 : ulNumberOfSectors;
+        pBlkCache->stats.ulWriteCommands++;
+        if (scsiWrite10(pBlkCache->iMsDev,
+                        pBlkCache->iLun,
+                        ulSector,
+                        (WORD)ulBlocks,
+                        (PBYTE)pbySrc,
+                        (size_t)(ulBlocks * (unsigned long)pBlkCache->iBlockSize),
+                        &stLengthWritten))
+        {
+            return -1;
+        }
+        ulSector += ulBlocks;
+        ulNumberOfSectors -= ulBlocks;
+        pbySrc += ulBlocks * (unsigned long)pBlkCache->iBlockSize;
+    }
     return 0;
 }
 /**********************************************************************************
-End of function  bcInvalidate
+End of function  bcWriteDevice
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcFindEntry
+Description:   Function to look up the entry of a line in the hash table
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulCacheSector - The first sector of the line
+Return value:  Pointer to the entry or NULL if the line is not in the cache
+**********************************************************************************/
+static PBCIDX bcFindEntry(PBACHE pBlkCache, unsigned long ulCacheSector)
+{
+    PBCIDX  pEntry = pBlkCache->ppHash[bcHash(pBlkCache, ulCacheSector)];
+    /* Search only the entries in the bucket for this line */
+    while ((pEntry) && (pEntry->ulSector != ulCacheSector))
+    {
+        pEntry = pEntry->pHashNext;
+    }
+    return pEntry;
+}
+/**********************************************************************************
+End of function  bcFindEntry
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcHash
+Description:   Function to get the hash bucket of a cache line
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  ulCacheSector - The first sector of the line
+Return value:  The index of the hash bucket
+**********************************************************************************/
+static unsigned long bcHash(PBACHE pBlkCache, unsigned long ulCacheSector)
+{
+    uint32_t ulLine = (uint32_t)(ulCacheSector / (unsigned long)pBlkCache->iLineSize);
+    /* Use the top bits of the product, they depend on all of the line bits */
+    return (unsigned long)(((ulLine * (uint32_t)BC_HASH_MULTIPLIER) >> 16) ^ ulLine)
+           & pBlkCache->ulHashMask;
+}
+/**********************************************************************************
+End of function  bcHash
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcHashInsert
+Description:   Function to add a valid entry to the hash table
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcHashInsert(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    PBCIDX  *ppBucket = &pBlkCache->ppHash[bcHash(pBlkCache, pEntry->ulSector)];
+    pEntry->pHashNext = *ppBucket;
+    *ppBucket = pEntry;
+}
+/**********************************************************************************
+End of function  bcHashInsert
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcHashRemove
+Description:   Function to remove an entry from the hash table
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcHashRemove(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    PBCIDX  *ppBucket = &pBlkCache->ppHash[bcHash(pBlkCache, pEntry->ulSector)];
+    while (*ppBucket)
+    {
+        if (*ppBucket == pEntry)
+        {
+            *ppBucket = pEntry->pHashNext;
+            break;
+        }
+        ppBucket = &(*ppBucket)->pHashNext;
+    }
+    pEntry->pHashNext = NULL;
+}
+/**********************************************************************************
+End of function  bcHashRemove
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcLruUnlink
+Description:   Function to take an entry off the LRU list
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcLruUnlink(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    if (pEntry->pLruPrev)
+    {
+        pEntry->pLruPrev->pLruNext = pEntry->pLruNext;
+    }
+    else if (pBlkCache->pLruHead == pEntry)
+    {
+        pBlkCache->pLruHead = pEntry->pLruNext;
+    }
+    if (pEntry->pLruNext)
+    {
+        pEntry->pLruNext->pLruPrev = pEntry->pLruPrev;
+    }
+    else if (pBlkCache->pLruTail == pEntry)
+    {
+        pBlkCache->pLruTail = pEntry->pLruPrev;
+    }
+    pEntry->pLruPrev = NULL;
+    pEntry->pLruNext = NULL;
+}
+/**********************************************************************************
+End of function  bcLruUnlink
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcLruMakeHead
+Description:   Function to make an entry the most recently used
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcLruMakeHead(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    if (pBlkCache->pLruHead != pEntry)
+    {
+        bcLruUnlink(pBlkCache, pEntry);
+        pEntry->pLruNext = pBlkCache->pLruHead;
+        if (pBlkCache->pLruHead)
+        {
+            pBlkCache->pLruHead->pLruPrev = pEntry;
+        }
+        else
+        {
+            pBlkCache->pLruTail = pEntry;
+        }
+        pBlkCache->pLruHead = pEntry;
+    }
+}
+/**********************************************************************************
+End of function  bcLruMakeHead
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcLruMakeTail
+Description:   Function to make an entry the next one to be re-used
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcLruMakeTail(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    if (pBlkCache->pLruTail != pEntry)
+    {
+        bcLruUnlink(pBlkCache, pEntry);
+        pEntry->pLruPrev = pBlkCache->pLruTail;
+        if (pBlkCache->pLruTail)
+        {
+            pBlkCache->pLruTail->pLruNext = pEntry;
+        }
+        else
+        {
+            pBlkCache->pLruHead = pEntry;
+        }
+        pBlkCache->pLruTail = pEntry;
+    }
+}
+/**********************************************************************************
+End of function  bcLruMakeTail
+***********************************************************************************/
+
+/**********************************************************************************
+Function Name: bcDiscardEntry
+Description:   Function to remove an entry from the hash table and mark it free
+Parameters:    IN  pBlkCache - Pointer to the block cache
+               IN  pEntry - Pointer to the entry
+Return value:  none
+**********************************************************************************/
+static void bcDiscardEntry(PBACHE pBlkCache, PBCIDX pEntry)
+{
+    if (pEntry->iValid)
+    {
+        bcHashRemove(pBlkCache, pEntry);
+        pEntry->iValid = FALSE;
+    }
+}
+/**********************************************************************************
+End of function  bcDiscardEntry
 ***********************************************************************************/
 
 /***********************************************************************************
@@ -30,7 +30,9 @@
 #define DEV_USB        2    /* Example: Map USB MSD to physical drive 2 */
 
 #define DSK_CACHE_SIZE              (1024 * 64)
-#define DSK_MAX_BLOCK_TRANSFER      ((WORD)((1024 * 32)))
+/* The most blocks passed to the cache at once. The cache splits this into
+   commands the device supports, one command when it uses the 16 byte ones */
+#define DSK_MAX_BLOCK_TRANSFER      ((DWORD)((1024UL * 128UL)))
 
 
 static FS_T_SINT32 dskWriteBlocks(const FS_T_UINT8    *pbyBuffer,
@@ -61,34 +63,33 @@ static FS_T_SINT32 dskWriteBlocks(const FS_T_UINT8    *pbyBuffer,
                                   FS_T_UINT32   dwNumBlocks,
                                   PDRIVE        pDrive)
 {
-    WORD wNumBlocks;
+    DWORD dwBlocks;
     FS_T_SINT32 lReturn = (FS_T_SINT32) dwNumBlocks;
 
     while (dwNumBlocks)
     {
-        /* Calculate the number of blocks to write - SCSI 10 byte commands only
-           has a 16bit number for the number of sectors */
+        /* Calculate the number of blocks to transfer */
         if (dwNumBlocks > DSK_MAX_BLOCK_TRANSFER)
         {
-            wNumBlocks = DSK_MAX_BLOCK_TRANSFER;
+            dwBlocks = DSK_MAX_BLOCK_TRANSFER;
         }
         else
         {
-            wNumBlocks = (WORD) dwNumBlocks;
+            dwBlocks = dwNumBlocks;
         }
 
         /* Write to the device through the cache */
         if (!bcWrite(pDrive->pBlockCache,
                      pbyBuffer,
                      dwSectorAddress,
-                     (DWORD)wNumBlocks))
+                     dwBlocks))
         {
             return FS_ERR_DRIVER_FATAL_ERROR;
         }
 
-        dwNumBlocks -= (DWORD) wNumBlocks;
-        dwSectorAddress += wNumBlocks;
-        pbyBuffer += (pDrive->dwBlockSize * wNumBlocks);
+        dwNumBlocks -= dwBlocks;
+        dwSectorAddress += dwBlocks;
+        pbyBuffer += (pDrive->dwBlockSize * dwBlocks);
     }
 
     return lReturn;
@@ -111,34 +112,33 @@ static FS_T_SINT32 dskReadBlocks(FS_T_UINT8     *pbyBuffer,
                                  FS_T_UINT32    dwNumBlocks,
                                  PDRIVE         pDrive)
 {
-    WORD wNumBlocks;
+    DWORD dwBlocks;
     FS_T_SINT32 lReturn = (FS_T_SINT32) dwNumBlocks;
 
     while (dwNumBlocks)
     {
-        /* Calculate the number of blocks to write - SCSI 10 byte commands only
-           has a 16bit number for the number of sectors */
+        /* Calculate the number of blocks to transfer */
         if (dwNumBlocks > DSK_MAX_BLOCK_TRANSFER)
         {
-            wNumBlocks = DSK_MAX_BLOCK_TRANSFER;
+            dwBlocks = DSK_MAX_BLOCK_TRANSFER;
         }
         else
         {
-            wNumBlocks = (WORD) dwNumBlocks;
+            dwBlocks = dwNumBlocks;
         }
 
         /* Write to the device through the cache */
         if (!bcRead(pDrive->pBlockCache,
                     pbyBuffer,
                     dwSectorAddress,
-                    (DWORD) wNumBlocks))
+                    dwBlocks))
         {
             return FS_ERR_DRIVER_FATAL_ERROR;
         }
 
-        dwNumBlocks -= (DWORD) wNumBlocks;
-        dwSectorAddress += wNumBlocks;
-        pbyBuffer += (pDrive->dwBlockSize * wNumBlocks);
+        dwNumBlocks -= dwBlocks;
+        dwSectorAddress += dwBlocks;
+        pbyBuffer += (pDrive->dwBlockSize * dwBlocks);
     }
 
     return lReturn;
@@ -184,6 +184,11 @@ DRESULT disk_read (
 
     PDRIVE p_drive =  get_drive(pdrv);
 
+    if (NULL == p_drive)
+    {
+        return RES_NOTRDY;
+    }
+
     result = (UINT)dskReadBlocks(buff, sector, count, p_drive);
 
 #ifdef DEBUG
@@ -218,6 +223,11 @@ DRESULT disk_write (
 
     PDRIVE p_drive =  get_drive(pdrv);
 
+    if (NULL == p_drive)
+    {
+        return RES_NOTRDY;
+    }
+
     blocks_written = (UINT)dskWriteBlocks(buff, sector, count, p_drive);
 
     if (blocks_written == count)
@@ -238,11 +248,48 @@ DRESULT disk_ioctl (
     void *buff        /* Buffer to send/receive control data */
 )
 {
-    (void) cmd;
-    (void) pdrv;
-    (void) buff;
+    PDRIVE p_drive =  get_drive(pdrv);
 
-    return 0;
+    /* The drive may have been removed since the volume was mounted */
+    if (NULL == p_drive)
+    {
+        return RES_NOTRDY;
+    }
+
+    switch (cmd)
+    {
+        case CTRL_SYNC:
+        {
+            /* Write back any data held in the block cache */
+            if (bcFlush(p_drive->pBlockCache))
+            {
+                return RES_ERROR;
+            }
+            break;
+        }
+        case GET_SECTOR_COUNT:
+        {
+            *(DWORD *) buff = p_drive->dwNumBlocks;
+            break;
+        }
+        case GET_SECTOR_SIZE:
+        {
+            *(WORD *) buff = (WORD) p_drive->dwBlockSize;
+            break;
+        }
+        case GET_BLOCK_SIZE:
+        {
+            /* The erase block size is not known */
+            *(DWORD *) buff = 1;
+            break;
+        }
+        default:
+        {
+            return RES_PARERR;
+        }
+    }
+
+    return RES_OK;
 }
 
 DWORD get_fattime (void)
@@ -44,39 +44,20 @@ void ff_memfree (
 /* Create a Synchronization Object                                        */
 /*------------------------------------------------------------------------*/
 /* This function is called in f_mount() function to create a new
-/  synchronization object for the volume, such as semaphore and mutex.
+/  synchronization object for the volume. Each volume has its own mutex so
+/  tasks using different drives do not wait for each other.
 /  When a 0 is returned, the f_mount() function fails with FR_INT_ERR.
 */
 
-//const osMutexDef_t Mutex[FF_VOLUMES];    /* CMSIS-RTOS */
-
-
 int ff_cre_syncobj (    /* 1:Function succeeded, 0:Could not create the sync object */
     BYTE vol,            /* Corresponding volume (logical drive number) */
     FF_SYNC_t *sobj        /* Pointer to return the created sync object */
 )
 {
-    /* Win32 */
-    *sobj = CreateMutex(NULL, FALSE, NULL);
-    return (int)(*sobj != INVALID_HANDLE_VALUE);
-
-    /* uITRON */
-//    T_CSEM csem = {TA_TPRI,1,1};
-//    *sobj = acre_sem(&csem);
-//    return (int)(*sobj > 0);
-
-    /* uC/OS-II */
-//    OS_ERR err;
-//    *sobj = OSMutexCreate(0, &err);
-//    return (int)(err == OS_NO_ERR);
-
-    /* FreeRTOS */
-//    *sobj = xSemaphoreCreateMutex();
-//    return (int)(*sobj != NULL);
-
-    /* CMSIS-RTOS */
-//    *sobj = osMutexCreate(Mutex + vol);
-//    return (int)(*sobj != NULL);
+    UNUSED_PARAM(vol);
+
+    *sobj = R_OS_CreateMutex();
+    return (int)(*sobj != NULL);
 }
 
 
@@ -92,23 +73,8 @@ int ff_del_syncobj (    /* 1:Function succeeded, 0:Could not delete due to an er
     FF_SYNC_t sobj        /* Sync object tied to the logical drive to be deleted */
 )
 {
-    /* Win32 */
-    return (int)CloseHandle(sobj);
-
-    /* uITRON */
-//    return (int)(del_sem(sobj) == E_OK);
-
-    /* uC/OS-II */
-//    OS_ERR err;
-//    OSMutexDel(sobj, OS_DEL_ALWAYS, &err);
-//    return (int)(err == OS_NO_ERR);
-
-    /* FreeRTOS */
-//  vSemaphoreDelete(sobj);
-//    return 1;
-
-    /* CMSIS-RTOS */
-//    return (int)(osMutexDelete(sobj) == osOK);
+    R_OS_DeleteMutex(sobj);
+    return 1;
 }
 
 
@@ -116,29 +82,16 @@ int ff_del_syncobj (    /* 1:Function succeeded, 0:Could not delete due to an er
 /* Request Grant to Access the Volume                                     */
 /*------------------------------------------------------------------------*/
 /* This function is called on entering file functions to lock the volume.
-/  When a 0 is returned, the file function fails with FR_TIMEOUT.
+/  The wait is not bounded by FF_FS_TIMEOUT: a large transfer by another
+/  task holds the volume for longer than that without anything being wrong.
 */
 
 int ff_req_grant (    /* 1:Got a grant to access the volume, 0:Could not get a grant */
     FF_SYNC_t sobj    /* Sync object to wait */
 )
 {
-    /* Win32 */
-    return (int)(WaitForSingleObject(sobj, FF_FS_TIMEOUT) == WAIT_OBJECT_0);
-
-    /* uITRON */
-//    return (int)(wai_sem(sobj) == E_OK);
-
-    /* uC/OS-II */
-//    OS_ERR err;
-//    OSMutexPend(sobj, FF_FS_TIMEOUT, &err));
-//    return (int)(err == OS_NO_ERR);
-
-    /* FreeRTOS */
-//    return (int)(xSemaphoreTake(sobj, FF_FS_TIMEOUT) == pdTRUE);
-
-    /* CMSIS-RTOS */
-//    return (int)(osMutexWait(sobj, FF_FS_TIMEOUT) == osOK);
+    R_OS_AcquireMutex(sobj);
+    return 1;
 }
 
 
@@ -152,21 +105,7 @@ void ff_rel_grant (
     FF_SYNC_t sobj    /* Sync object to be signaled */
 )
 {
-    /* Win32 */
-    ReleaseMutex(sobj);
-
-    /* uITRON */
-//    sig_sem(sobj);
-
-    /* uC/OS-II */
-//    OSMutexPost(sobj);
-
-    /* FreeRTOS */
-//    xSemaphoreGive(sobj);
-
-    /* CMSIS-RTOS */
-//    osMutexRelease(sobj);
+    R_OS_ReleaseMutex(sobj);
 }
 
 #endif
-
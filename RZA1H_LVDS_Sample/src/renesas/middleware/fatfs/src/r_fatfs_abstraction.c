@@ -246,22 +246,42 @@ int R_FAT_LoadLibrary (void)
  IN  iLun - The logical unit number
  IN  dwBlockSize - The block size of the device
  IN  dwNumBlocks - The number of blocks
- Return value:  Pointer to the drive object
+ IN  pCacheCfg - Block cache tuning, NULL for the defaults
+ Return value:  Pointer to the drive object or NULL if there is no memory
+                for the block cache
  **********************************************************************************/
-PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsigned long dwNumBlocks)
+PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsigned long dwNumBlocks,
+                          const FATCACHECFG *pCacheCfg)
 {
+    static const FATCACHECFG default_cache_cfg =
+    {
+        FAT_CACHE_READ_AHEAD_LINES,
+        FAT_CACHE_SEQUENTIAL_COUNT,
+        FAT_CACHE_WRITE_BURST_LINES
+    };
+
+    if ( !pCacheCfg)
+    {
+        pCacheCfg = &default_cache_cfg;
+    }
+
     memset( &drive_0, 0, sizeof(DRIVE));
     PDRIVE p_drive = &drive_0;
 
-    if (p_drive)
+    p_drive->pBlockCache = bcCreate(iMsDev, iLun, FAT_CACHE_LINE_SIZE, FAT_CACHE_NUM_LINES,
+                                    (int) dwBlockSize, dwNumBlocks);
+
+    /* The drive is built in drive_0, which is not freed */
+    if ( !p_drive->pBlockCache)
     {
-        p_drive->pBlockCache = bcCreate(iMsDev, iLun, 8, 64, (int) dwBlockSize, dwNumBlocks);
-        if ( !p_drive->pBlockCache)
-        {
-            R_OS_FreeMem(p_drive);
-        }
+        return NULL;
     }
 
+    /* Read-ahead and write-back are optimisations, the drive works
+       without them */
+    bcSetReadAhead(p_drive->pBlockCache, pCacheCfg->iReadAheadLines, pCacheCfg->iSequentialCount);
+    bcSetWriteBack(p_drive->pBlockCache, pCacheCfg->iWriteBurstLines);
+
     p_drive->dwBlockSize = dwBlockSize;
     p_drive->dwNumBlocks = dwNumBlocks;
     p_drive->iMsDev = iMsDev;
@@ -273,10 +293,42 @@ PDRIVE R_FAT_CreateDrive (int iMsDev, int iLun, unsigned long dwBlockSize, unsig
  End of function  R_FAT_CreateDrive
  ***********************************************************************************/
 
+/**********************************************************************************
+ Function Name: R_FAT_DestroyDrive
+ Description:   Function to destroy the drive object. The volume is unmounted
+                which frees its mutex and any file locks still held on it
+ Parameters:    IN  pDrive - Pointer to the drive object
+ Return value:  0 for success
+ **********************************************************************************/
 FRESULT R_FAT_DestroyDrive (PDRIVE pDrive)
 {
+    char buffer[10];
+
+    if (NULL != pDrive->p_fat_fs)
+    {
+#if FF_FS_REENTRANT
+        /* Let any file operation in progress on the volume finish first */
+        if (NULL != pDrive->p_fat_fs->sobj)
+        {
+            ff_req_grant(pDrive->p_fat_fs->sobj);
+            ff_rel_grant(pDrive->p_fat_fs->sobj);
+        }
+#endif
+        /* Files left open on this volume still refer to the FATFS object,
+           they must not be used once the drive is destroyed */
+        sprintf(buffer, "%d:", pDrive->proposed_drive_index);
+        f_mount(NULL, buffer, 0);
+        R_OS_FreeMem(pDrive->p_fat_fs);
+        pDrive->p_fat_fs = NULL;
+    }
+
     bcDestroy(pDrive->pBlockCache);
-    R_OS_FreeMem(pDrive);
+
+    /* The drive is built in drive_0 and copied to the disk list on success */
+    if (p_drive_0 != pDrive)
+    {
+        R_OS_FreeMem(pDrive);
+    }
 
     return 0;
 }
@@ -284,6 +336,25 @@ FRESULT R_FAT_DestroyDrive (PDRIVE pDrive)
  End of function  R_FAT_DestroyDrive
  ***********************************************************************************/
 
+/**********************************************************************************
+ Function Name: R_FAT_FlushDrive
+ Description:   Function to write any data held in the drive's cache to the media
+ Parameters:    IN  pDrive - Pointer to the drive object
+ Return value:  FR_OK for success
+ **********************************************************************************/
+FRESULT R_FAT_FlushDrive (PDRIVE pDrive)
+{
+    if ((NULL != pDrive) && (bcFlush(pDrive->pBlockCache)))
+    {
+        return FR_DISK_ERR;
+    }
+
+    return FR_OK;
+}
+/**********************************************************************************
+ End of function  R_FAT_FlushDrive
+ ***********************************************************************************/
+
 /**********************************************************************************
  Function Name: R_FAT_MountPartition
  Description:
@@ -406,8 +477,20 @@ FIL *R_FAT_OpenFile (char *p_path, int iMode)
             result = f_open(fp, (char *)p_path_local, (BYTE) iMode);
             if (result)
             {
+                /* FR_LOCKED when the file is already open for writing, or
+                   for reading when opening it for writing */
+                R_OS_FreeMem(fp);
                 fp = NULL;
             }
+#if FAT_LINK_MAP_ON_READ
+            else if ((iMode & (FA_READ | FA_WRITE)) == FA_READ)
+            {
+                /* Files opened for reading are typically media files which are
+                   seeked about, so resolve seeks from the link map. Without a
+                   map the file is still usable, just slower to seek */
+                R_FAT_CreateLinkMap(fp, NULL);
+            }
+#endif
         }
 
         /* allocation for path not now needed */
@@ -430,6 +513,7 @@ FRESULT R_FAT_CloseFile (FIL *p_file)
 {
     FRESULT result = f_close(p_file);
 
+    R_FAT_DiscardLinkMap(p_file);
     R_OS_FreeMem(p_file);
 
     return R_FAT_ConvertErrorCode(result);
@@ -504,7 +588,9 @@ int R_FAT_WriteFile (FIL *p_file, unsigned char *p_buff, unsigned int no_of_byte
 
 /**********************************************************************************
  Function Name: R_FAT_SeekFile
- Description:   Function to seek to a position in a file
+ Description:   Function to seek to a position in a file. When the file has a
+                cluster link map the seek is resolved from the map, otherwise
+                the FAT chain is followed from the start of the file
  Parameters:    IN  _pFile - Pointer to the file object
  IN  lOffset - The file offset
  IN  iOrigin - The origin
@@ -526,6 +612,152 @@ FRESULT R_FAT_SeekFile (FIL *p_file, FS_T_UINT32 lOffset, int iOrigin, long *p_r
  End of function  R_FAT_SeekFile
  ***********************************************************************************/
 
+/**********************************************************************************
+ Function Name: R_FAT_CreateLinkMap
+ Description:   Function to create the cluster link map for fast seek. Any
+                existing map is discarded first
+ Parameters:    IN  p_file - Pointer to the file object
+ IN/OUT p_table_size - Pointer to the table size in DWORDs, 0 or NULL to
+                       size the table to the file
+ Return value:  0 for success
+ **********************************************************************************/
+FRESULT R_FAT_CreateLinkMap (FIL *p_file, DWORD *p_table_size)
+{
+    DWORD table_size = FAT_LINK_MAP_INITIAL_SIZE;
+    DWORD required = 0UL;
+    DWORD *p_table;
+    int resize = 1;
+    FRESULT result;
+
+    if (NULL == p_file)
+    {
+        return R_FAT_ConvertErrorCode(FR_INVALID_OBJECT);
+    }
+
+    R_FAT_DiscardLinkMap(p_file);
+
+    if ((NULL != p_table_size) && (0UL != *p_table_size))
+    {
+        /* The caller has sized the table, so do not grow it */
+        table_size = *p_table_size;
+        resize = 0;
+    }
+
+    do
+    {
+        p_table = (DWORD *) R_OS_AllocMem((size_t) (table_size * sizeof(DWORD)), R_REGION_LARGE_CAPACITY_RAM);
+        if (NULL == p_table)
+        {
+            result = FR_NOT_ENOUGH_CORE;
+            break;
+        }
+
+        /* The first item is the size of the table, FatFs replaces it with
+           the number of items used or required */
+        p_table[0] = table_size;
+        p_file->cltbl = p_table;
+        result = f_lseek(p_file, CREATE_LINKMAP);
+        required = p_table[0];
+
+        if (FR_OK != result)
+        {
+            p_file->cltbl = NULL;
+            R_OS_FreeMem(p_table);
+        }
+
+        /* Try once more with a table large enough for the whole file */
+        if ((FR_NOT_ENOUGH_CORE == result) && (resize) && (required > table_size))
+        {
+            table_size = required;
+            resize = 0;
+            continue;
+        }
+        break;
+    } while (1);
+
+    if (NULL != p_table_size)
+    {
+        *p_table_size = required;
+    }
+
+    return R_FAT_ConvertErrorCode(result);
+}
+/**********************************************************************************
+ End of function  R_FAT_CreateLinkMap
+ ***********************************************************************************/
+
+/**********************************************************************************
+ Function Name: R_FAT_DiscardLinkMap
+ Description:   Function to discard the cluster link map of a file. Seeks
+                follow the FAT chain again afterwards
+ Parameters:    IN  p_file - Pointer to the file object
+ Return value:  none
+ **********************************************************************************/
+void R_FAT_DiscardLinkMap (FIL *p_file)
+{
+    if ((NULL != p_file) && (NULL != p_file->cltbl))
+    {
+        R_OS_FreeMem(p_file->cltbl);
+        p_file->cltbl = NULL;
+    }
+}
+/**********************************************************************************
+ End of function  R_FAT_DiscardLinkMap
+ ***********************************************************************************/
+
+/**********************************************************************************
+ Function Name: R_FAT_ExpandFile
+ Description:   Function to allocate a contiguous block of clusters to an empty
+                file. The file size becomes the allocated size
+ Parameters:    IN  p_file - Pointer to the file object
+ IN  size - The number of bytes to allocate
+ Return value:  0 for success
+ **********************************************************************************/
+FRESULT R_FAT_ExpandFile (FIL *p_file, FSIZE_t size)
+{
+    FRESULT result;
+
+    if (NULL == p_file)
+    {
+        result = FR_INVALID_OBJECT;
+    }
+    else
+    {
+        result = f_expand(p_file, size, 1);
+    }
+
+    return R_FAT_ConvertErrorCode(result);
+}
+/**********************************************************************************
+ End of function  R_FAT_ExpandFile
+ ***********************************************************************************/
+
+/**********************************************************************************
+ Function Name: R_FAT_TruncateFile
+ Description:   Function to truncate a file at the file pointer, releasing the
+                clusters after it
+ Parameters:    IN  p_file - Pointer to the file object
+ Return value:  0 for success
+ **********************************************************************************/
+FRESULT R_FAT_TruncateFile (FIL *p_file)
+{
+    FRESULT result;
+
+    if (NULL == p_file)
+    {
+        result = FR_INVALID_OBJECT;
+    }
+    else
+    {
+        result = f_truncate(p_file);
+    }
+
+    return R_FAT_ConvertErrorCode(result);
+}
+/**********************************************************************************
+ End of function  R_FAT_TruncateFile
+ ***********************************************************************************/
+
 /**********************************************************************************
  Function Name: R_FAT_FileSize
  Description:   Return the size of  a file
@@ -632,6 +864,21 @@ FRESULT R_FAT_FindNext (DIR *p_dir, FATENTRY *p_fatentry)
  End of function  R_FAT_FindNext
  ***********************************************************************************/
 
+/**********************************************************************************
+ Function Name: R_FAT_FindClose
+ Description:   Function to close a find started by R_FAT_FindFirst, this
+                releases the lock held on the directory
+ Parameters:    IN  p_dir - Pointer to the directory object
+ Return value:  0 for success
+ **********************************************************************************/
+FRESULT R_FAT_FindClose (DIR *p_dir)
+{
+    return R_FAT_ConvertErrorCode(f_closedir(p_dir));
+}
+/**********************************************************************************
+ End of function  R_FAT_FindClose
+ ***********************************************************************************/
+
 /**********************************************************************************
  Function Name: R_FAT_RewindFind
  Description:   Function to rewind the find to the first entry
@@ -63,18 +63,23 @@ Includes <System Includes> , "Project Includes"
 /******************************************************************************
 Macro definitions
 ******************************************************************************/
-/** Allocate the memory for the driver instead of the hard-coded allocation below */
-#define _ALLOC_MEM_
-
-/** This is very nasty. Get the addresses from the linker or allocate dynamically */
-#define ADDR_OF_TXRX_DESC       0x60500000
-#define ADDR_OF_TXRX_BUFF       0x60501000
-
-#define NUM_OF_TX_DESCRIPTOR    (8)
-#define NUM_OF_RX_DESCRIPTOR    (8)
-#define NUM_OF_TX_BUFFER        NUM_OF_TX_DESCRIPTOR
-#define NUM_OF_RX_BUFFER        NUM_OF_RX_DESCRIPTOR
+/** The default number of descriptors in each ring when R_Ether_Open is not
+    given a configuration */
+#define NUM_OF_TX_DESCRIPTOR    (16)
+#define NUM_OF_RX_DESCRIPTOR    (16)
+/** The default number of spare receive buffers used to refill the descriptors
+    when frames are lent by R_Ether_ReadZeroCopy */
+#define NUM_OF_RX_LOAN_BUFFER   (16)
+/** The largest configuration accepted by R_Ether_Open */
+#define MAX_NUM_OF_TX_DESCRIPTOR    (64)
+#define MAX_NUM_OF_RX_DESCRIPTOR    (64)
+#define MAX_NUM_OF_RX_LOAN_BUFFER   (64)
 #define SIZE_OF_BUFFER          (1600)    /* Must be an integral multiple of 32 */
+/** Space in front of each receive buffer that the borrower of a frame may use */
+#define SIZE_OF_RX_HEADROOM     (32)      /* Must be an integral multiple of 32 */
+/** Segments shorter than this are copied into the transmit buffer by
+    R_Ether_WriteGather instead of being sent from where they are */
+#define SIZE_OF_TX_COPY         (128)
 
 #define R_ETHER_OK              (0)
 #define R_ETHER_ERROR           (-1)
@@ -82,6 +87,8 @@ Macro definitions
 #define R_ETHER_HARD_ERROR      (-3)
 #define R_ETHER_RECOVERAVLE     (-4)
 #define R_ETHER_NODATA          (-5)
+#define R_ETHER_NOBUFFER        (-6)
+#define R_ETHER_BUSY            (-7)
 #define MIN_FRAME_SIZE          (60)
 #define MAX_FRAME_SIZE          (1514)
 
@@ -197,11 +204,13 @@ typedef struct tag_edmac_recv_desc
     struct tag_edmac_recv_desc * pNext;
 } edmac_recv_desc_t;
 
-/** @brief The whole transmit/receive descriptors (must be allocated in 16-byte boundaries) */
+/** @brief The whole transmit/receive descriptors (the rings must be allocated in 16-byte boundaries) */
 typedef struct
 {
-    edmac_send_desc_t dsend[NUM_OF_TX_DESCRIPTOR];
-    edmac_recv_desc_t drecv[NUM_OF_RX_DESCRIPTOR];
+    edmac_send_desc_t * dsend;      /*!<  The ring of transmit descriptors */
+    edmac_recv_desc_t * drecv;      /*!<  The ring of receive descriptors */
+    uint32_t    num_send;           /*!<  The number of transmit descriptors */
+    uint32_t    num_recv;           /*!<  The number of receive descriptors */
     edmac_send_desc_t * pSend_top;  /*!<  Registration location of transmit descriptors */
     edmac_recv_desc_t * pRecv_end;  /*!<  Registration location and reception end of transmit descriptors */
 } txrx_descriptor_set_t;
@@ -211,11 +220,45 @@ typedef txrx_descriptor_set_t * txrx_descriptor_set_t_ptr;
  *         Definition of all transmit/receive buffer areas */
 typedef struct
 {
-    uint8_t bsend[NUM_OF_TX_BUFFER][SIZE_OF_BUFFER];
-    uint8_t brecv[NUM_OF_RX_BUFFER][SIZE_OF_BUFFER];
+    uint8_t (* bsend)[SIZE_OF_BUFFER];                          /*!< One per transmit descriptor */
+    uint8_t (* brecv)[SIZE_OF_RX_HEADROOM + SIZE_OF_BUFFER];    /*!< One per receive descriptor and spare */
 } txrx_buffer_set_t; 
 typedef txrx_buffer_set_t * txrx_buffer_set_t_ptr;
 
+/** @brief The size of the rings given to R_Ether_Open */
+typedef struct
+{
+    uint32_t    num_tx_descriptors;     /*!< 2 to MAX_NUM_OF_TX_DESCRIPTOR */
+    uint32_t    num_rx_descriptors;     /*!< 2 to MAX_NUM_OF_RX_DESCRIPTOR */
+    uint32_t    num_rx_loan_buffers;    /*!< 0 to MAX_NUM_OF_RX_LOAN_BUFFER */
+} ether_config_t;
+
+/** @brief A frame lent by R_Ether_ReadBurst */
+typedef struct
+{
+    uint8_t   * p_data;             /*!< Pointer to the frame */
+    uint32_t    length;             /*!< The length of the frame */
+} ether_frame_t;
+
+/** @brief The driver's counters */
+typedef struct
+{
+    uint32_t    rx_frames;          /*!< Frames received */
+    uint32_t    rx_errors;          /*!< Frames received with an error */
+    uint32_t    rx_dropped;         /*!< Frames discarded by the reader */
+    uint32_t    rx_fifo_overflows;  /*!< Receive FIFO overflows */
+    uint32_t    rx_ring_overruns;   /*!< Frames lost because every receive descriptor was full */
+    uint32_t    tx_frames;          /*!< Frames queued for transmission */
+    uint32_t    tx_ring_full;       /*!< Frames refused because every transmit descriptor was busy */
+} ether_statistics_t;
+
+/** @brief A segment of a frame to transmit with R_Ether_WriteGather */
+typedef struct
+{
+    uint8_t   * p_data;             /*!< Pointer to the data */
+    uint32_t    length;             /*!< The length of the data */
+} ether_segment_t;
+
 /******************************************************************************
 Exported global functions (to be accessed by other files)
 ******************************************************************************/
@@ -225,11 +268,13 @@ Exported global functions (to be accessed by other files)
  *
  * @param[in]    ch:            Ethernet channel number
  * @param[in]    mac_addr:      Pointer to MAC address array
+ * @param[in]    p_config:      Pointer to the size of the rings or NULL for
+ *                              the default sizes
  *
  * @retval       R_ETHER_OK(0): Success                
  * @retval       R_ETHER_ERROR(-1): Error                
 */
-int32_t R_Ether_Open(uint32_t ch, uint8_t mac_addr[]);
+int32_t R_Ether_Open(uint32_t ch, uint8_t mac_addr[], const ether_config_t *p_config);
 
 /**           
  * @brief        Stops the E-MAC/E-DMAC.
@@ -257,6 +302,90 @@ int32_t R_Ether_Close(uint32_t ch);
 */
 int32_t R_Ether_Read(uint32_t ch, void *buf);
 
+/**
+ * Description   Lends the buffer holding the received Ethernet frame to the
+ *               caller without copying it. The receive descriptor is refilled
+ *               with a spare buffer. SIZE_OF_RX_HEADROOM bytes in front of the
+ *               frame may be used by the caller. The buffer must be returned
+ *               with R_Ether_ReleaseBuffer before the driver is closed.
+ *
+ * @param[in]    ch:        Ethernet channel number
+ * @param[out]   ppbyFrame: Pointer to the destination frame pointer
+ *
+ * @retval       Greater than 0   : Success. Returns number of bytes received
+ * @retval       R_ETHER_ERROR(-1): The frame had an error and was discarded
+ * @retval       R_ETHER_HARD_ERROR(-3): The descriptor ring is broken.
+ *                                       Software reset is necessary to recover
+ * @retval       R_ETHER_NODATA(-5): No data received
+ * @retval       R_ETHER_NOBUFFER(-6): No spare buffer, the frame must be read
+ *                                     with R_Ether_Read
+*/
+int32_t R_Ether_ReadZeroCopy(uint32_t ch, uint8_t **ppbyFrame);
+
+/**
+ * Description   Returns a frame buffer lent by R_Ether_ReadZeroCopy.
+ *               This can be called from any task.
+ *
+ * @param[in]    ch:       Ethernet channel number
+ * @param[in]    pbyFrame: Pointer to the frame
+ *
+ * @return       None.
+*/
+void R_Ether_ReleaseBuffer(uint32_t ch, uint8_t *pbyFrame);
+
+/**
+ * Description   Lends every received frame up to max_frames in one call, as
+ *               R_Ether_ReadZeroCopy. Frames received with an error are
+ *               discarded. Each buffer must be returned with
+ *               R_Ether_ReleaseBuffer.
+ *
+ * @param[in]    ch:         Ethernet channel number
+ * @param[out]   frames:     The frames lent
+ * @param[in]    max_frames: The size of frames
+ *
+ * @retval       Greater than 0   : Success. Returns the number of frames lent
+ * @retval       R_ETHER_HARD_ERROR(-3): The descriptor ring is broken.
+ *                                       Software reset is necessary to recover
+ * @retval       R_ETHER_NODATA(-5): No data received
+ * @retval       R_ETHER_NOBUFFER(-6): No spare buffer, the frame must be read
+ *                                     with R_Ether_Read
+*/
+int32_t R_Ether_ReadBurst(uint32_t ch, ether_frame_t frames[], uint32_t max_frames);
+
+/**
+ * Description   Returns the number of received frames waiting to be read.
+ *               When there are none the receive interrupt is enabled again
+ *               so the caller can wait for the receive call-back.
+ *
+ * @param[in]    ch:  Ethernet channel number
+ *
+ * @return       The number of frames waiting
+*/
+uint32_t R_Ether_RxPending(uint32_t ch);
+
+/**
+ * Description   Sets receive interrupt moderation. When enabled the receive
+ *               interrupt is disabled after each receive call-back and is only
+ *               enabled again when a read or R_Ether_RxPending finds no more
+ *               frames, so one call-back covers a burst of frames.
+ *
+ * @param[in]    ch:     Ethernet channel number
+ * @param[in]    bf_enable: true to enable moderation
+ *
+ * @return       None.
+*/
+void R_Ether_RxModeration(uint32_t ch, _Bool bf_enable);
+
+/**
+ * Description   Gets the driver's counters
+ *
+ * @param[in]    ch:      Ethernet channel number
+ * @param[out]   p_stats: Pointer to the destination counters
+ *
+ * @return       None.
+*/
+void R_Ether_GetStatistics(uint32_t ch, ether_statistics_t *p_stats);
+
 /**
  * Description   This function sends an Ethernet frame pointed by Ethernet frame
  *               pointer on the Ethernet channel specified by channel number. 
@@ -270,9 +399,48 @@ int32_t R_Ether_Read(uint32_t ch, void *buf);
  * 
  * @retval       R_ETHER_OK(0):     Success              
  * @retval       R_ETHER_ERROR(-1): Error
+ * @retval       R_ETHER_BUSY(-7):  The transmit descriptor is busy, try again
+ *                                  after the transmit call-back
 */ 
 int32_t R_Ether_Write(uint32_t ch, void *buf, uint32_t len);
 
+/**
+ * Description   Sends an Ethernet frame made from a list of segments. Large
+ *               segments are sent from where they are using one transmit
+ *               descriptor each, runs of small segments are copied into the
+ *               transmit buffer. The segments must not be changed until the
+ *               release call-back has been called.
+ *
+ * @param[in]    ch:              Ethernet channel number
+ * @param[in]    segments:        The segments of the frame
+ * @param[in]    num_segments:    The number of segments
+ * @param[in]    pfn_release:     Function called when the frame has been sent
+ *                                or NULL
+ * @param[in]    p_release_param: The parameter to pass to pfn_release
+ *
+ * @retval       R_ETHER_OK(0):     Success
+ * @retval       R_ETHER_ERROR(-1): Error. pfn_release is not called
+ * @retval       R_ETHER_BUSY(-7):  Not enough free descriptors, try again
+ *                                  after the transmit call-back.
+ *                                  pfn_release is not called
+*/
+int32_t R_Ether_WriteGather(uint32_t ch,
+                            const ether_segment_t segments[],
+                            uint32_t num_segments,
+                            void (*pfn_release)(void *),
+                            void *p_release_param);
+
+/**
+ * Description   Calls the release call-back of the frames sent by
+ *               R_Ether_WriteGather which have been transmitted. This must
+ *               not be called from an ISR.
+ *
+ * @param[in]    ch:  Ethernet channel number
+ *
+ * @return       None.
+*/
+void R_Ether_TxReclaim(uint32_t ch);
+
 void INT_Ether(uint32_t status);
 
 /**               
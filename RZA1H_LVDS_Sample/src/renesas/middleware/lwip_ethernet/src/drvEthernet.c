@@ -72,6 +72,27 @@ Macro definitions
 
 #define ET_CHANNEL                      (0)
 
+/* The size of the rings given to the lower level driver */
+#ifndef ET_NUM_TX_DESCRIPTORS
+#define ET_NUM_TX_DESCRIPTORS           NUM_OF_TX_DESCRIPTOR
+#endif
+#ifndef ET_NUM_RX_DESCRIPTORS
+#define ET_NUM_RX_DESCRIPTORS           NUM_OF_RX_DESCRIPTOR
+#endif
+#ifndef ET_NUM_RX_LOAN_BUFFERS
+#define ET_NUM_RX_LOAN_BUFFERS          NUM_OF_RX_LOAN_BUFFER
+#endif
+
+/* The default receive interrupt moderation, 1 frame is no moderation */
+#define ET_RX_COALESCE_FRAMES           (1UL)
+#define ET_RX_COALESCE_TIME_OUT         (1UL)
+
+/* The time to wait for a transmit descriptor before dropping the frame */
+#define ET_TX_WAIT_TIME_OUT             (100UL)
+
+/* The largest number of frames read in a burst */
+#define ET_MAX_RX_BURST                 (16UL)
+
 /******************************************************************************
 Typedef definitions
 ******************************************************************************/
@@ -80,6 +101,8 @@ typedef enum _ETEV
 {
     ET_RX_ISR = 0,
     ET_LINK_STATUS_CHANGE,
+    ET_TX_ISR,
+    ET_TX_SPACE,
     ET_NUM_EVENTS
 } ETEV;
 
@@ -92,8 +115,12 @@ typedef struct _ETDRV
     uint8_t     pbyMacAddress[6];
     _Bool       bfPromiscuous;
     os_task_t   *uiLinkMonitorTaskID;
+    os_task_t   *uiTxReclaimTaskID;
     uint32_t    uiLinkStatus;
     uint32_t    uiRxIsrCount;
+    uint32_t    uiRxCoalesceFrames;
+    uint32_t    uiRxCoalesceTimeOut;
+    uint32_t    uiTxDropped;
 } ETDRV,
 *PETDRV;
 #pragma pack()
@@ -117,6 +144,20 @@ static int etWrite(st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t uiCount
 static int etControl(st_stream_ptr_t pStream, uint32_t ctlCode, void *pCtlStruct);
 static void etTaskLinkMonitor(PETDRV pEtDrv);
 static void etRxIsrCallBack(PETDRV pEtDrv);
+static void etTxIsrCallBack(PETDRV pEtDrv);
+static void etTaskTxReclaim(PETDRV pEtDrv);
+static int etReadZeroCopy(PETDRV pEtDrv, PETZCRX pRx);
+static int etWriteGather(PETDRV pEtDrv, PETGTX pTx);
+static int etReadBurst(PETDRV pEtDrv, PETRXB pBurst);
+static _Bool etWaitTxSpace(PETDRV pEtDrv);
+
+/* The size of the rings */
+static const ether_config_t gEtherCConfig =
+{
+    ET_NUM_TX_DESCRIPTORS,
+    ET_NUM_RX_DESCRIPTORS,
+    ET_NUM_RX_LOAN_BUFFERS
+};
 
 /* Define the driver function table for this device */
 const st_r_driver_t gEtherCDriver =
@@ -244,9 +285,11 @@ static int etOpen(st_stream_ptr_t pStream)
 
         /* Set the extension */
         pStream->p_extension = pEtDrv;
+        pEtDrv->uiRxCoalesceFrames = ET_RX_COALESCE_FRAMES;
+        pEtDrv->uiRxCoalesceTimeOut = ET_RX_COALESCE_TIME_OUT;
 
         /* Open the driver - only succeeds if there is a link available */
-        if (0 == R_Ether_Open(ET_CHANNEL, pEtDrv->pbyMacAddress))
+        if (0 == R_Ether_Open(ET_CHANNEL, pEtDrv->pbyMacAddress, &gEtherCConfig))
         {
             /* Set the receive call-back */
             lan_set_rx_call_back((void (*)(void *)) etRxIsrCallBack, (void *) pEtDrv);
@@ -255,7 +298,15 @@ static int etOpen(st_stream_ptr_t pStream)
             pEtDrv->uiLinkMonitorTaskID = R_OS_CreateTask("EtherC Link", (os_task_code_t) etTaskLinkMonitor, pEtDrv,
                     R_OS_ABSTRACTION_PRV_DEFAULT_STACK_SIZE, TASK_ETHERC_LINK_MON_PRI);
 
-            if (NULL != pEtDrv->uiLinkMonitorTaskID)
+            /* Create a task to release the frames sent without copying */
+            pEtDrv->uiTxReclaimTaskID = R_OS_CreateTask("EtherC TX", (os_task_code_t) etTaskTxReclaim, pEtDrv,
+                    R_OS_ABSTRACTION_PRV_DEFAULT_STACK_SIZE, TASK_ETHERC_OUTPUT_PRI);
+
+            /* Set the transmit call-back */
+            lan_set_tx_call_back((void (*)(void *)) etTxIsrCallBack, (void *) pEtDrv);
+
+            if ((NULL != pEtDrv->uiLinkMonitorTaskID)
+            &&  (NULL != pEtDrv->uiTxReclaimTaskID))
             {
                 return 0;
             }
@@ -290,6 +341,13 @@ static void etClose(st_stream_ptr_t pStream)
         R_OS_DeleteTask(pEtDrv->uiLinkMonitorTaskID);
     }
 
+    /* Destroy the transmit reclaim task */
+    lan_set_tx_call_back(NULL, NULL);
+    if (NULL != pEtDrv->uiTxReclaimTaskID)
+    {
+        R_OS_DeleteTask(pEtDrv->uiTxReclaimTaskID);
+    }
+
     /* Close the lower level driver */
     R_Ether_Close(ET_CHANNEL);
 
@@ -340,6 +398,11 @@ static int etRead(st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t uiCount)
         {
             eventWait(&pEtDrv->ppEventList[ET_RX_ISR], 1, true);
         }
+        else if (R_ETHER_HARD_ERROR == iResult)
+        {
+            /* The ring is broken, reading again would not move it on */
+            return -1;
+        }
     }
 
     return (int) iResult;
@@ -359,9 +422,16 @@ static int etRead(st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t uiCount)
  ******************************************************************************/
 static int etWrite(st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_t uiCount)
 {
-    (void) pStream;        /* avoid unused parameter warning */
+    PETDRV pEtDrv = (PETDRV) pStream->p_extension;
+    int32_t iResult;
+
+    /* Wait for a free transmit descriptor rather than drop the frame */
+    do
+    {
+        iResult = R_Ether_Write(ET_CHANNEL, pbyBuffer, uiCount);
+    } while ((R_ETHER_BUSY == iResult) && (etWaitTxSpace(pEtDrv)));
 
-    return R_Ether_Write(ET_CHANNEL, pbyBuffer, uiCount);
+    return (int) iResult;
 }
 /*****************************************************************************
  End of function  etWrite
@@ -450,6 +520,79 @@ static int etControl(st_stream_ptr_t pStream, uint32_t ctlCode, void *pCtlStruct
             break;
         }
 
+        case CTL_ETHER_READ_ZERO_COPY:
+        {
+            if (pCtlStruct)
+            {
+                return etReadZeroCopy(pEtDrv, (PETZCRX) pCtlStruct);
+            }
+            break;
+        }
+
+        case CTL_ETHER_RELEASE_RX_BUFFER:
+        {
+            if (pCtlStruct)
+            {
+                R_Ether_ReleaseBuffer(ET_CHANNEL, (uint8_t *) pCtlStruct);
+                return 0;
+            }
+            break;
+        }
+
+        case CTL_ETHER_WRITE_GATHER:
+        {
+            if (pCtlStruct)
+            {
+                return etWriteGather(pEtDrv, (PETGTX) pCtlStruct);
+            }
+            break;
+        }
+
+        case CTL_ETHER_READ_BURST:
+        {
+            if (pCtlStruct)
+            {
+                return etReadBurst(pEtDrv, (PETRXB) pCtlStruct);
+            }
+            break;
+        }
+
+        case CTL_ETHER_SET_RX_COALESCE:
+        {
+            if (pCtlStruct)
+            {
+                PETCOAL pCoalesce = (PETCOAL) pCtlStruct;
+                pEtDrv->uiRxCoalesceFrames = (pCoalesce->uiFrames) ? pCoalesce->uiFrames : 1UL;
+                pEtDrv->uiRxCoalesceTimeOut = pCoalesce->uiTimeOut;
+
+                /* Only take an interrupt per burst when waiting for more than one */
+                R_Ether_RxModeration(ET_CHANNEL, (pEtDrv->uiRxCoalesceFrames > 1UL));
+                return 0;
+            }
+            break;
+        }
+
+        case CTL_ETHER_GET_STATISTICS:
+        {
+            if (pCtlStruct)
+            {
+                PETSTATS            pStats = (PETSTATS) pCtlStruct;
+                ether_statistics_t  statistics;
+
+                R_Ether_GetStatistics(ET_CHANNEL, &statistics);
+                pStats->uiRxFrames = statistics.rx_frames;
+                pStats->uiRxErrors = statistics.rx_errors;
+                pStats->uiRxDropped = statistics.rx_dropped;
+                pStats->uiRxFifoOverflows = statistics.rx_fifo_overflows;
+                pStats->uiRxRingOverruns = statistics.rx_ring_overruns;
+                pStats->uiTxFrames = statistics.tx_frames;
+                pStats->uiTxRingFull = statistics.tx_ring_full;
+                pStats->uiTxDropped = pEtDrv->uiTxDropped;
+                return 0;
+            }
+            break;
+        }
+
         default:
         {
             TRACE(("etControl: Unknown control code\r\n"));
@@ -506,6 +649,215 @@ static void etTaskLinkMonitor(PETDRV pEtDrv)
  ******************************************************************************/
 
 
+/******************************************************************************
+ * Function Name: etReadZeroCopy
+ * Description  : Function to borrow the next received frame from the driver
+ *                without copying it. The frame must be returned with
+ *                CTL_ETHER_RELEASE_RX_BUFFER
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ *                OUT pRx - Pointer to the received frame information
+ * Return Value : 0 for success or -1 when no buffer can be lent and the frame
+ *                must be read with read(), or the ring is broken
+ ******************************************************************************/
+static int etReadZeroCopy(PETDRV pEtDrv, PETZCRX pRx)
+{
+    int32_t iResult = -1;
+
+    /* Block until some data is available */
+    while (iResult < 0)
+    {
+        /* Try to borrow the frame from the lower level driver */
+        iResult = R_Ether_ReadZeroCopy(ET_CHANNEL, &pRx->pbyFrame);
+
+        /* Wait on the ISR event if there is no data available */
+        if (R_ETHER_NODATA == iResult)
+        {
+            eventWait(&pEtDrv->ppEventList[ET_RX_ISR], 1, true);
+        }
+        else if ((R_ETHER_NOBUFFER == iResult) || (R_ETHER_HARD_ERROR == iResult))
+        {
+            return -1;
+        }
+    }
+
+    pRx->stLength = (size_t) iResult;
+    pRx->stHeadroom = SIZE_OF_RX_HEADROOM;
+    return 0;
+}
+/******************************************************************************
+ End of function  etReadZeroCopy
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function Name: etWriteGather
+ * Description  : Function to send a frame made from a list of segments. The
+ *                segments must not be changed until the release function has
+ *                been called
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ *                IN  pTx - Pointer to the frame information
+ * Return Value : 0 for success or -1 when the frame was not sent and the
+ *                release function will not be called
+ ******************************************************************************/
+static int etWriteGather(PETDRV pEtDrv, PETGTX pTx)
+{
+    ether_segment_t segments[ET_NUM_TX_DESCRIPTORS];
+    uint32_t        uiSegment;
+    int32_t         iResult;
+
+    /* A frame can not use more descriptors than the ring was opened with */
+    if (pTx->uiSegments > gEtherCConfig.num_tx_descriptors)
+    {
+        return -1;
+    }
+
+    for (uiSegment = 0; uiSegment < pTx->uiSegments; uiSegment++)
+    {
+        segments[uiSegment].p_data = pTx->pSegments[uiSegment].pbyData;
+        segments[uiSegment].length = (uint32_t) pTx->pSegments[uiSegment].stLength;
+    }
+
+    /* Wait for enough free transmit descriptors rather than drop the frame */
+    do
+    {
+        iResult = R_Ether_WriteGather(ET_CHANNEL, segments, pTx->uiSegments,
+                                      pTx->pfnRelease, pTx->pvParameter);
+    } while ((R_ETHER_BUSY == iResult) && (etWaitTxSpace(pEtDrv)));
+
+    if (R_ETHER_OK == iResult)
+    {
+        return 0;
+    }
+
+    return -1;
+}
+/******************************************************************************
+ End of function  etWriteGather
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function Name: etWaitTxSpace
+ * Description  : Function to wait for a frame to be transmitted when the
+ *                transmit descriptors are busy
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ * Return Value : true to try again or false if the wait timed out and the
+ *                frame has been dropped
+ ******************************************************************************/
+static _Bool etWaitTxSpace(PETDRV pEtDrv)
+{
+    if (R_OS_WaitForEvent(&pEtDrv->ppEventList[ET_TX_SPACE], ET_TX_WAIT_TIME_OUT))
+    {
+        return true;
+    }
+
+    pEtDrv->uiTxDropped++;
+    return false;
+}
+/******************************************************************************
+ End of function  etWaitTxSpace
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function Name: etReadBurst
+ * Description  : Function to borrow the received frames from the driver
+ *                without copying them. When receive interrupt moderation is
+ *                set this waits for the number of frames or the time-out
+ *                after the first frame. Each frame must be returned with
+ *                CTL_ETHER_RELEASE_RX_BUFFER
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ *                IN  pBurst - Pointer to the list of frames
+ * Return Value : 0 for success or -1 when no buffer can be lent and the frame
+ *                must be read with read(), or the ring is broken
+ ******************************************************************************/
+static int etReadBurst(PETDRV pEtDrv, PETRXB pBurst)
+{
+    ether_frame_t   frames[ET_MAX_RX_BURST];
+    uint32_t        uiMaxFrames = pBurst->uiMaxFrames;
+    uint32_t        uiWaited = 0;
+    uint32_t        uiFrame;
+    int32_t         iResult = R_ETHER_NODATA;
+
+    if (uiMaxFrames > ET_MAX_RX_BURST)
+    {
+        uiMaxFrames = ET_MAX_RX_BURST;
+    }
+    pBurst->uiFrames = 0;
+
+    /* Block until some data is available */
+    while (iResult < 0)
+    {
+        uint32_t uiPending = R_Ether_RxPending(ET_CHANNEL);
+
+        if (0 == uiPending)
+        {
+            /* Wait on the ISR event */
+            eventWait(&pEtDrv->ppEventList[ET_RX_ISR], 1, true);
+            uiWaited = 0;
+        }
+        else if ((uiPending < pEtDrv->uiRxCoalesceFrames)
+             &&  (uiPending < uiMaxFrames)
+             &&  (uiWaited < pEtDrv->uiRxCoalesceTimeOut))
+        {
+            /* Give the rest of the burst time to arrive */
+            R_OS_TaskSleep(1UL);
+            uiWaited++;
+        }
+        else
+        {
+            iResult = R_Ether_ReadBurst(ET_CHANNEL, frames, uiMaxFrames);
+            if ((R_ETHER_NOBUFFER == iResult) || (R_ETHER_HARD_ERROR == iResult))
+            {
+                return -1;
+            }
+        }
+    }
+
+    for (uiFrame = 0; uiFrame < (uint32_t) iResult; uiFrame++)
+    {
+        pBurst->pFrames[uiFrame].pbyFrame = frames[uiFrame].p_data;
+        pBurst->pFrames[uiFrame].stLength = (size_t) frames[uiFrame].length;
+        pBurst->pFrames[uiFrame].stHeadroom = SIZE_OF_RX_HEADROOM;
+    }
+    pBurst->uiFrames = (uint32_t) iResult;
+    return 0;
+}
+/******************************************************************************
+ End of function  etReadBurst
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function Name: etTaskTxReclaim
+ * Description  : Task to release the frames sent without copying when the
+ *                transmit complete interrupt occurs
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ * Return Value : none
+ ******************************************************************************/
+static void etTaskTxReclaim(PETDRV pEtDrv)
+{
+    while (1)
+    {
+        eventWait(&pEtDrv->ppEventList[ET_TX_ISR], 1, true);
+        R_Ether_TxReclaim(ET_CHANNEL);
+    }
+}
+/******************************************************************************
+ End of function  etTaskTxReclaim
+ ******************************************************************************/
+
+/******************************************************************************
+ * Function Name: etTxIsrCallBack
+ * Description  : Function to handle the TX ISR call-back
+ * Arguments    : IN  pEtDrv - Pointer to the Ethernet driver
+ * Return Value : none
+ ******************************************************************************/
+static void etTxIsrCallBack(PETDRV pEtDrv)
+{
+    eventSet(pEtDrv->ppEventList[ET_TX_ISR]);
+    eventSet(pEtDrv->ppEventList[ET_TX_SPACE]);
+}
+/******************************************************************************
+ End of function  etTxIsrCallBack
+ ******************************************************************************/
+
 /******************************************************************************
  * Function Name: etRxIsrCallBack
  * Description  : Function to handle the RX ISR call-back
@@ -65,6 +65,20 @@ Macro definitions
 #define ETHERNET_MALLOC_TYPE                HEAP_SRAM
 #define ETHERNET_MAX_ADAPTER_NAME_LENGTH    16U
 #define ETHERNET_NETIF_MTU                  1500U
+/* Set to 1 to pass the received frames to lwIP in the driver's buffers */
+#ifndef ETHERNET_ZERO_COPY_RX
+#define ETHERNET_ZERO_COPY_RX               1
+#endif
+/* The largest number of frames borrowed from the driver at once */
+#define ETHERNET_RX_BURST                   8U
+/* Set to 1 to send the frames from lwIP's buffers without copying */
+#ifndef ETHERNET_ZERO_COPY_TX
+#define ETHERNET_ZERO_COPY_TX               1
+#endif
+/* The largest number of pbufs in a frame sent without copying */
+#define ETHERNET_MAX_TX_SEGMENTS            8U
+/* The time to wait before reading again after the driver fails a read */
+#define ETHERNET_RX_ERROR_DELAY_MS          10UL
 
 /* Comment this line out to turn ON module trace in this file */
 #undef _TRACE_ON_
@@ -129,9 +143,26 @@ typedef struct _RTEIP
 
     /* The mutex event used to protect the output buffer */
     PEVENT          pevOutputBufferMutex;
+
+    /* The number of received frames dropped for want of a packet buffer */
+    uint32_t        uiRxDropped;
 } RTEIP;
 #pragma pack()
 
+/* A packet buffer describing a frame lent by the Ethernet driver. This is
+   built in the headroom in front of the frame */
+typedef struct _RXPBUF
+{
+    struct pbuf_custom  ipCustom;
+
+    /* The file descriptor of the Ethernet driver */
+    int                 iEtherC;
+
+    /* Pointer to the frame to return to the driver */
+    uint8_t             *pbyFrame;
+} RXPBUF,
+*PRXPBUF;
+
 /******************************************************************************
 Function Prototypes
 ******************************************************************************/
@@ -143,6 +174,10 @@ static void ipLinkMonitor(PRTEIP pEtherC);
 static void ipLinkStatus(struct netif *pIpNetIf);
 static void ipSetTcpIpTaskID(PRTEIP pEtherC);
 static err_t ipOutput(struct netif *pIpNetIf, struct pbuf *pPacket);
+#if ETHERNET_ZERO_COPY_TX
+static void ipTxRelease(void *pvPacket);
+static err_t ipOutputGather(int iEtherC, struct pbuf *pPacket);
+#endif
 static void ipAddNetIf(PRTEIP *ppEtherC, PRTEIP pEtherC);
 static PRTEIP ipRemoveNetIf(PRTEIP *ppEtherC, PRTEIP pEtherC);
 static PRTEIP ipFindNetIf(PRTEIP *ppEtherC, char_t *pszInterface);
@@ -1095,6 +1130,73 @@ static struct pbuf * ipAllocPacketBuffer(size_t stLength)
 End of function  ipAllocPacketBuffer
 ******************************************************************************/
 
+#if ETHERNET_ZERO_COPY_RX
+/******************************************************************************
+* Function Name: ipFreeRxPacket
+* Description  : Function called by lwIP to free a frame lent by the driver
+* Arguments    : IN  pPacket - Pointer to the packet buffer
+* Return Value : none
+******************************************************************************/
+static void ipFreeRxPacket(struct pbuf *pPacket)
+{
+    PRXPBUF pRxPacket = (PRXPBUF) pPacket;
+    control(pRxPacket->iEtherC, CTL_ETHER_RELEASE_RX_BUFFER, pRxPacket->pbyFrame);
+}
+/******************************************************************************
+End of function  ipFreeRxPacket
+******************************************************************************/
+
+/******************************************************************************
+* Function Name: ipRxFramePacket
+* Description  : Function to describe a frame lent by the driver with a packet
+*                buffer without copying it
+* Arguments    : IN  pEtherC - Pointer to the ethernet controller data
+*                IN  pRxFrame - Pointer to the frame lent by the driver
+* Return Value : Pointer to the packet or NULL if the frame was dropped
+******************************************************************************/
+static struct pbuf * ipRxFramePacket(PRTEIP pEtherC, PETZCRX pRxFrame)
+{
+    PRXPBUF     pRxPacket;
+    struct pbuf *pPacket;
+
+    /* Check that the packet buffer and padding fit in front of the frame */
+    if (pRxFrame->stHeadroom < (sizeof(RXPBUF) + ETH_PAD_SIZE))
+    {
+        /* Copy the frame and give the buffer straight back. The rest of the
+           burst is still lent, so do not wait for the pool */
+        pPacket = pbuf_alloc(PBUF_RAW, (u16_t)(pRxFrame->stLength + ETH_PAD_SIZE), PBUF_RAM);
+        if (pPacket)
+        {
+            memcpy((uint8_t *) pPacket->payload + ETH_PAD_SIZE, pRxFrame->pbyFrame, pRxFrame->stLength);
+        }
+        else
+        {
+            pEtherC->uiRxDropped++;
+        }
+        control(pEtherC->iEtherC, CTL_ETHER_RELEASE_RX_BUFFER, pRxFrame->pbyFrame);
+        return pPacket;
+    }
+
+    /* The packet buffer is put at the start of the headroom so lwIP can
+       treat it as a PBUF_RAM with the payload following it */
+    pRxPacket = (PRXPBUF) (pRxFrame->pbyFrame - pRxFrame->stHeadroom);
+    pRxPacket->iEtherC = pEtherC->iEtherC;
+    pRxPacket->pbyFrame = pRxFrame->pbyFrame;
+    pRxPacket->ipCustom.custom_free_function = ipFreeRxPacket;
+
+    /* Padding is required from the start */
+    return pbuf_alloced_custom(PBUF_RAW,
+                               (u16_t)(pRxFrame->stLength + ETH_PAD_SIZE),
+                               PBUF_RAM,
+                               &pRxPacket->ipCustom,
+                               pRxFrame->pbyFrame - ETH_PAD_SIZE,
+                               (u16_t)(pRxFrame->stLength + ETH_PAD_SIZE));
+}
+/******************************************************************************
+End of function  ipRxFramePacket
+******************************************************************************/
+#endif
+
 /******************************************************************************
 * Function Name: ipInputCallBack
 * Description  : Function to put the received packet into lwIP via the call-back
@@ -1125,12 +1227,44 @@ static void ipInputTask(PRTEIP pEtherC)
     /* Enter the main function of the input task */
     while (true)
     {
+        struct pbuf *pPacket;
+        uint8_t     *pbyBuffer;
+        int32_t     iResult;
+
+#if ETHERNET_ZERO_COPY_RX
+        ETZCRX      pRxFrames[ETHERNET_RX_BURST];
+        ETRXB       rxBurst;
+
+        /* Borrow all the frames received from the driver */
+        rxBurst.pFrames = pRxFrames;
+        rxBurst.uiMaxFrames = ETHERNET_RX_BURST;
+        if (0 == control(pEtherC->iEtherC, CTL_ETHER_READ_BURST, &rxBurst))
+        {
+            uint32_t uiFrame;
+
+            for (uiFrame = 0; uiFrame < rxBurst.uiFrames; uiFrame++)
+            {
+                pPacket = ipRxFramePacket(pEtherC, &pRxFrames[uiFrame]);
+                if (NULL == pPacket)
+                {
+                    continue;
+                }
+#ifdef _TRACE_RX_DATA_
+                Trace("RX %d\r\n", pPacket->tot_len - ETH_PAD_SIZE);
+                dbgPrintBuffer((uint8_t *) pPacket->payload + ETH_PAD_SIZE, pPacket->tot_len - ETH_PAD_SIZE);
+#endif
+                /* Put the packet into lwIP */
+                pPacket->next = (struct pbuf *)pEtherC;
+                tcpip_callback((void(*)(void*))ipInputCallBack, pPacket);
+            }
+            continue;
+        }
+#endif
         /* Allocate a buffer to hold the received data */
-        struct pbuf *pPacket = ipAllocPacketBuffer(ETHERNET_INPUT_BUFFER_SIZE);
+        pPacket = ipAllocPacketBuffer(ETHERNET_INPUT_BUFFER_SIZE);
 
         /* Get a pointer to the payload */
-        uint8_t     *pbyBuffer = pPacket->payload;
-        int32_t     iResult;
+        pbyBuffer = pPacket->payload;
 
         /* Padding is required from the start */
         pbyBuffer += ETH_PAD_SIZE;
@@ -1158,8 +1292,10 @@ static void ipInputTask(PRTEIP pEtherC)
         }
         else
         {
-            /* Error in the read, free the buffer and try again */
+            /* Error in the read, free the buffer and try again. The read
+               only fails at once when the ring is broken, so do not spin */
             pbuf_free(pPacket);
+            R_OS_TaskSleep(ETHERNET_RX_ERROR_DELAY_MS);
         }
     }
 }
@@ -1183,6 +1319,14 @@ static err_t ipOutput(struct netif *pIpNetIf, struct pbuf *pPacket)
     uint8_t     *pbyBuffer = pEtherC->pbyOuputBuffer;
     uint32_t    uiLength = 0;
 
+#if ETHERNET_ZERO_COPY_TX
+    /* Try to send the frame from where it is */
+    if (ERR_OK == ipOutputGather(iEtherC, pPacket))
+    {
+        return ERR_OK;
+    }
+#endif
+
     eventWaitMutex(&pEtherC->pevOutputBufferMutex, EV_WAIT_INFINITE);
 
     /* Check to see if the packet needs to be concatenated */
@@ -1237,6 +1381,79 @@ static err_t ipOutput(struct netif *pIpNetIf, struct pbuf *pPacket)
 End of function ipOutput
 ******************************************************************************/
 
+#if ETHERNET_ZERO_COPY_TX
+/******************************************************************************
+* Function Name: ipTxRelease
+* Description  : Function called by the driver when a frame sent by
+*                ipOutputGather has been transmitted
+* Arguments    : IN  pvPacket - Pointer to the lwIP pbuf structure
+* Return Value : none
+******************************************************************************/
+static void ipTxRelease(void *pvPacket)
+{
+    pbuf_free((struct pbuf *) pvPacket);
+}
+/******************************************************************************
+End of function ipTxRelease
+******************************************************************************/
+
+/******************************************************************************
+* Function Name: ipOutputGather
+* Description  : Function to send the pbuf chain without copying it. The
+*                chain is referenced until the driver has transmitted it
+* Arguments    : IN  iEtherC - The file descriptor of the Ethernet driver
+*                IN  pPacket - Pointer to the lwIP pbuf structure
+* Return Value : ERR_OK if the frame was sent otherwise ERR_BUF and the frame
+*                must be copied
+******************************************************************************/
+static err_t ipOutputGather(int iEtherC, struct pbuf *pPacket)
+{
+    ETSEG       pSegments[ETHERNET_MAX_TX_SEGMENTS];
+    ETGTX       txFrame;
+    struct pbuf *pGather = pPacket;
+    size_t      stSkip = ETH_PAD_SIZE;
+
+    txFrame.pSegments = pSegments;
+    txFrame.uiSegments = 0;
+    txFrame.pfnRelease = ipTxRelease;
+    txFrame.pvParameter = pPacket;
+
+    /* Make a segment for each pbuf, skipping the padding at the start */
+    while (pGather)
+    {
+        if (pGather->len > stSkip)
+        {
+            if (ETHERNET_MAX_TX_SEGMENTS == txFrame.uiSegments)
+            {
+                return ERR_BUF;
+            }
+            pSegments[txFrame.uiSegments].pbyData = (uint8_t *) pGather->payload + stSkip;
+            pSegments[txFrame.uiSegments].stLength = (size_t)(pGather->len - stSkip);
+            txFrame.uiSegments++;
+            stSkip = 0;
+        }
+        else
+        {
+            stSkip -= pGather->len;
+        }
+        pGather = pGather->next;
+    }
+
+    /* Hold on to the chain until the driver has sent it */
+    pbuf_ref(pPacket);
+    if (control(iEtherC, CTL_ETHER_WRITE_GATHER, &txFrame))
+    {
+        pbuf_free(pPacket);
+        return ERR_BUF;
+    }
+
+    return ERR_OK;
+}
+/******************************************************************************
+End of function ipOutputGather
+******************************************************************************/
+#endif
+
 /******************************************************************************
 End  Of File
 ******************************************************************************/
@@ -73,20 +73,19 @@ Defines
 
 
 /* Functions to allocate the memory */
-#ifdef _ALLOC_MEM_
-extern  void *etMalloc(size_t stLength, int32_t iAlign, void **ppvBase);
+extern  void *etMalloc(size_t stLength, uint32_t iAlign, void **ppvBase);
 extern  void etFree(void *pvBase);
-#endif
 
 /******************************************************************************
 Private global variables and functions
 ******************************************************************************/
 /* ---- Descriptor ---- */
-static uint32_t geth_desc[((sizeof(txrx_descriptor_set_t) + sizeof(uint32_t))/sizeof(uint32_t))] __attribute__ ((section(".ETHER_DESCRIPTOR")));
-static volatile txrx_descriptor_set_t_ptr   geth_desc_ptr;
+static txrx_descriptor_set_t                geth_desc;
+static volatile txrx_descriptor_set_t_ptr   geth_desc_ptr = &geth_desc;
 static void *gpv_txrx_descriptor_base = NULL;
 /* ---- Buffer ---- */
-static volatile txrx_buffer_set_t_ptr       geth_buf_ptr;
+static txrx_buffer_set_t                    geth_buf;
+static volatile txrx_buffer_set_t_ptr       geth_buf_ptr = &geth_buf;
 static void *gpv_txrx_buffer_base = NULL;
 /* ---- PHY link status ---- */
 static int32_t  glink_status;
@@ -100,14 +99,52 @@ static void *gpv_rx_parameter = NULL;
 static void (*gpfn_tx_call_back)(void *) = NULL;
 /* ---- Tx call-back parameter ---- */
 static void *gpv_tx_parameter = NULL;
+/* ---- Spare receive buffers ---- */
+static uint8_t *gpby_rx_spare[MAX_NUM_OF_RX_LOAN_BUFFER];
+static uint32_t gui_rx_spare_count;
+static uint32_t gui_rx_spare_total;
+/* ---- Release call-back of the frame ending at each transmit descriptor ---- */
+static void (* volatile gpfn_tx_release[MAX_NUM_OF_TX_DESCRIPTOR])(void *);
+static void * volatile gpv_tx_release_param[MAX_NUM_OF_TX_DESCRIPTOR];
+/* ---- Receive interrupt moderation ---- */
+static volatile _Bool gbf_rx_moderation = false;
+/* ---- Counters ---- */
+static volatile ether_statistics_t gst_statistics;
+/* ---- The default size of the rings ---- */
+static const ether_config_t gst_default_config =
+{
+    NUM_OF_TX_DESCRIPTOR,
+    NUM_OF_RX_DESCRIPTOR,
+    NUM_OF_RX_LOAN_BUFFER
+};
 
-static int32_t lan_desc_create(void);
+static int32_t lan_desc_create(const ether_config_t *p_config);
 static void lan_reg_reset(void);
 static void lan_reg_set(int32_t link);
+static void lan_rx_interrupt_enable(void);
+static void lan_tx_release(int32_t index, _Bool bf_abandon);
 
 #define I_DIV_P         (4) /* Ick:Pck0 = 4:1 */
 #define PCLK_5CYC       ((5 * I_DIV_P) / 2)
 
+/* Transmit descriptor TD0 bits */
+#define TD0_TACT        (0x80000000UL)
+#define TD0_TDLE        (0x40000000UL)
+#define TD0_TFP_START   (0x20000000UL)
+#define TD0_TFP_END     (0x10000000UL)
+
+/* E-DMAC status bits */
+#define EESR_TC         (0x00200000UL)
+#define EESR_FR         (0x00040000UL)
+#define EESR_RDE        (0x00020000UL)
+#define EESR_RFOF       (0x00010000UL)
+
+/* Check that a descriptor pointer is in its ring */
+#define TX_DESC_IN_RING(p)  (((p) >= geth_desc_ptr->dsend) \
+                          && ((p) < (geth_desc_ptr->dsend + geth_desc_ptr->num_send)))
+#define RX_DESC_IN_RING(p)  (((p) >= geth_desc_ptr->drecv) \
+                          && ((p) < (geth_desc_ptr->drecv + geth_desc_ptr->num_recv)))
+
 /******************************************************************************
 * Outline       : Open the Ethernet driver
 * Include       : none
@@ -115,10 +152,12 @@ static void lan_reg_set(int32_t link);
 * Description   : Initialises the EtherC, E-DMAC, PHY, and buffer memory.
 * Argument      : uint32_t ch       ; I : Ethernet channel number
 *               : uint8_t mac_addr[]; I : Pointer to MAC address array
+*               : const ether_config_t *p_config; I : The size of the rings
+*               :                                     or NULL for the defaults
 * Return Value  : R_ETHER_OK(0)    : Success
 *               : R_ETHER_ERROR(-1): Error
 ******************************************************************************/
-int32_t R_Ether_Open (uint32_t ch, uint8_t mac_addr[])
+int32_t R_Ether_Open (uint32_t ch, uint8_t mac_addr[], const ether_config_t *p_config)
 {
     (void) ch;
     int32_t             link;
@@ -435,7 +474,11 @@ int32_t R_Ether_Open (uint32_t ch, uint8_t mac_addr[])
     lan_reg_reset();
 
     /* ==== Initialise of buffer memory ==== */
-    if (lan_desc_create())
+    if (NULL == p_config)
+    {
+        p_config = &gst_default_config;
+    }
+    if (lan_desc_create(p_config))
     {
         return R_ETHER_ERROR;
     }
@@ -491,6 +534,7 @@ int32_t R_Ether_Open (uint32_t ch, uint8_t mac_addr[])
 ******************************************************************************/
 int32_t R_Ether_Close (uint32_t ch)
 {
+    int32_t i;
     (void) ch;
     /* ==== Resets the E-MAC,E-DMAC === */
     lan_reg_reset();
@@ -498,11 +542,25 @@ int32_t R_Ether_Close (uint32_t ch)
     /* ==== Disables the E-DMAC interrupt === */
     R_INTC_Disable(INTC_ID_ETHERI);
 
+    /* ==== Release the frames the E-DMAC will no longer send === */
+    for (i = 0; i < (int32_t) geth_desc_ptr->num_send; i++)
+    {
+        lan_tx_release(i, true);
+    }
+
     /* ==== Free the memory if it has been allocated === */
-#ifdef _ALLOC_MEM_
-    etFree(gpv_txrx_descriptor_base);
-    etFree(gpv_txrx_buffer_base);
-#endif
+    if (gpv_txrx_descriptor_base)
+    {
+        etFree(gpv_txrx_descriptor_base);
+        gpv_txrx_descriptor_base = NULL;
+    }
+    if (gpv_txrx_buffer_base)
+    {
+        etFree(gpv_txrx_buffer_base);
+        gpv_txrx_buffer_base = NULL;
+    }
+    geth_desc_ptr->num_send = 0;
+    geth_desc_ptr->num_recv = 0;
     return R_ETHER_OK;
 }
 
@@ -514,7 +572,8 @@ int32_t R_Ether_Close (uint32_t ch)
 * Description   : Copies the received Ethernet frame on the Ethernet channel
 *               : specified by channel number to the receive buffer.
 * Argument      : uint32_t ch; I : Ethernet channel number
-*               : void *buf  ; I : Pointer to Ethernet receive buffer
+*               : void *buf  ; I : Pointer to Ethernet receive buffer or NULL
+*               :                  to discard the frame
 * Return Value  : Greater than 0   : Success. Returns number of bytes received
 *               : R_ETHER_ERROR(-1): Error
 *               : R_ETHER_HARD_ERROR(-3): Hardware error. Software reset is necessary to recover
@@ -528,16 +587,16 @@ int32_t R_Ether_Read (uint32_t ch, void *buf)
     int32_t             ret = 0;
 
     /* Sanity check 1 */
-    if ((p < (edmac_recv_desc_t *)geth_desc_ptr)
-    ||  (p > (edmac_recv_desc_t *)(geth_desc_ptr + sizeof(txrx_descriptor_set_t))))
+    if (!RX_DESC_IN_RING(p))
     {
         TRACE(("R_Ether_Read: Error in list 0x%p\r\n", p));
-        return R_ETHER_ERROR;
+        return R_ETHER_HARD_ERROR;
     }
 
     /* ==== No data ==== */
     if (p->rd0.BIT.RACT == 1)
     {
+        lan_rx_interrupt_enable();
         return R_ETHER_NODATA;
     }
     /* ==== Receives 1 frame ==== */
@@ -546,10 +605,11 @@ int32_t R_Ether_Read (uint32_t ch, void *buf)
     if ((p->rd0.BIT.RFE == 1)  &&  ((p->rd0.LONG & 0x025f0000) != 0))
     {
         p->rd0.LONG &= 0x70000000;          /* Processes the error flag */
+        gst_statistics.rx_errors++;
         ret = R_ETHER_ERROR;
     }
     /* ---- Copies the received frame ---- */
-    else
+    else if (NULL != buf)
     {
         /* Need to invalidate the cache */
         {
@@ -557,8 +617,14 @@ int32_t R_Ether_Read (uint32_t ch, void *buf)
             R_CACHE_L1_CleanInvalidLine((uint32_t) pVirtual_addr,p->rd1.RDL);
         }
         memcpy(buf, p->rd2.RBA, (size_t)p->rd1.RDL);
+        gst_statistics.rx_frames++;
         ret = p->rd1.RDL;                   /* number of bytes received */
     }
+    else
+    {
+        gst_statistics.rx_dropped++;
+        ret = R_ETHER_ERROR;                /* Frame discarded */
+    }
 
     /* ---- Sets the receive descriptor to receive again ---- */
     p->rd0.BIT.RACT = 1;
@@ -570,17 +636,241 @@ int32_t R_Ether_Read (uint32_t ch, void *buf)
     }
 
     /* Sanity check 2 */
-    if ((p->pNext < (edmac_recv_desc_t *)geth_desc_ptr)
-    ||  (p->pNext > (edmac_recv_desc_t *)(geth_desc_ptr + sizeof(txrx_descriptor_set_t))))
+    if (!RX_DESC_IN_RING(p->pNext))
     {
         TRACE(("R_Ether_Read: Error in list next 0x%p\r\n", p->pNext));
-        return R_ETHER_ERROR;
+        return R_ETHER_HARD_ERROR;
     }
     /* ==== Update the current pointer value ==== */
     geth_desc_ptr->pRecv_end = p->pNext;
     //TRACE(("Rx%p\r\n", geth_desc_ptr->pRecv_end);
     return ret;
 }
+
+/******************************************************************************
+* Outline       : Read the frame without copying it
+* Include       : none
+* Function Name : R_Ether_ReadZeroCopy
+* Description   : Lends the buffer holding the received Ethernet frame to the
+*               : caller and refills the receive descriptor with a spare buffer.
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : uint8_t **ppbyFrame; O : Pointer to the frame pointer
+* Return Value  : Greater than 0   : Success. Returns number of bytes received
+*               : R_ETHER_ERROR(-1): The frame had an error and was discarded
+*               : R_ETHER_HARD_ERROR(-3): The descriptor ring is broken
+*               : R_ETHER_NODATA(-5): No data received
+*               : R_ETHER_NOBUFFER(-6): No spare buffer to refill the descriptor
+******************************************************************************/
+int32_t R_Ether_ReadZeroCopy (uint32_t ch, uint8_t **ppbyFrame)
+{
+    edmac_recv_desc_t * p   = geth_desc_ptr->pRecv_end;   /* Current descriptor */
+    uint8_t *           pby_spare = NULL;
+    int32_t             ret;
+    int_t               lock;
+
+    /* Sanity check 1 */
+    if (!RX_DESC_IN_RING(p))
+    {
+        TRACE(("R_Ether_ReadZeroCopy: Error in list 0x%p\r\n", p));
+        return R_ETHER_HARD_ERROR;
+    }
+
+    /* ==== No data ==== */
+    if (p->rd0.BIT.RACT == 1)
+    {
+        lan_rx_interrupt_enable();
+        return R_ETHER_NODATA;
+    }
+
+    /* ---- Receive frame errors are handled by the copying read ---- */
+    if ((p->rd0.BIT.RFE == 1)  &&  ((p->rd0.LONG & 0x025f0000) != 0))
+    {
+        return R_Ether_Read(ch, NULL);
+    }
+
+    /* ---- Take a spare buffer to refill the descriptor ---- */
+    lock = R_OS_SysLock(NULL);
+    if (gui_rx_spare_count)
+    {
+        gui_rx_spare_count--;
+        pby_spare = gpby_rx_spare[gui_rx_spare_count];
+    }
+    R_OS_SysUnlock(NULL, lock);
+    if (NULL == pby_spare)
+    {
+        return R_ETHER_NOBUFFER;
+    }
+
+    /* Need to invalidate the cache */
+    R_CACHE_L1_CleanInvalidLine((uint32_t) p->rd2.RBA, p->rd1.RDL);
+
+    /* ---- The E-DMAC may reuse the descriptor once it is handed back ---- */
+    ret = p->rd1.RDL;                   /* number of bytes received */
+
+    /* ---- Lend the frame and set the descriptor to receive again ---- */
+    *ppbyFrame = p->rd2.RBA;
+    p->rd2.RBA = pby_spare;
+    p->rd0.BIT.RACT = 1;
+    gst_statistics.rx_frames++;
+
+    /* ---- Starts receiving frame ---- */
+    if( (ETHER.EDRRR0 & 0x00000001) == 0 )
+    {
+        ETHER.EDRRR0 |=  0x00000001;
+    }
+
+    /* Sanity check 2 */
+    if (!RX_DESC_IN_RING(p->pNext))
+    {
+        TRACE(("R_Ether_ReadZeroCopy: Error in list next 0x%p\r\n", p->pNext));
+        return R_ETHER_HARD_ERROR;
+    }
+    /* ==== Update the current pointer value ==== */
+    geth_desc_ptr->pRecv_end = p->pNext;
+    return ret;
+}
+
+/******************************************************************************
+* Outline       : Return a lent frame buffer
+* Include       : none
+* Function Name : R_Ether_ReleaseBuffer
+* Description   : Returns a buffer lent by R_Ether_ReadZeroCopy to the spare
+*               : buffers.
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : uint8_t *pbyFrame; I : Pointer to the frame
+* Return Value  : none
+******************************************************************************/
+void R_Ether_ReleaseBuffer (uint32_t ch, uint8_t *pbyFrame)
+{
+    (void) ch;
+    int_t   lock = R_OS_SysLock(NULL);
+
+    if (gui_rx_spare_count < gui_rx_spare_total)
+    {
+        gpby_rx_spare[gui_rx_spare_count] = pbyFrame;
+        gui_rx_spare_count++;
+    }
+    R_OS_SysUnlock(NULL, lock);
+}
+
+/******************************************************************************
+* Outline       : Read the received frames without copying them
+* Include       : none
+* Function Name : R_Ether_ReadBurst
+* Description   : Lends every received frame up to max_frames to the caller.
+*               : Frames received with an error are discarded.
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : ether_frame_t frames[]; O : The frames lent
+*               : uint32_t max_frames; I : The size of frames
+* Return Value  : Greater than 0   : Success. Returns the number of frames lent
+*               : R_ETHER_HARD_ERROR(-3): The descriptor ring is broken
+*               : R_ETHER_NODATA(-5): No data received
+*               : R_ETHER_NOBUFFER(-6): No spare buffer to refill the descriptor
+******************************************************************************/
+int32_t R_Ether_ReadBurst (uint32_t ch, ether_frame_t frames[], uint32_t max_frames)
+{
+    uint32_t    count = 0;
+    int32_t     ret = R_ETHER_NODATA;
+
+    while (count < max_frames)
+    {
+        ret = R_Ether_ReadZeroCopy(ch, &frames[count].p_data);
+
+        if (ret > 0)
+        {
+            frames[count].length = (uint32_t) ret;
+            count++;
+        }
+        else if (R_ETHER_ERROR == ret)
+        {
+            /* The frame was received with an error and has been discarded,
+               the ring has moved on to the next frame */
+            continue;
+        }
+        else
+        {
+            /* No more frames, or the ring is broken and does not move on */
+            break;
+        }
+    }
+
+    if (count)
+    {
+        return (int32_t) count;
+    }
+    return ret;
+}
+
+/******************************************************************************
+* Outline       : Count the received frames
+* Include       : none
+* Function Name : R_Ether_RxPending
+* Description   : Returns the number of received frames waiting to be read.
+*               : When there are none the receive interrupt is enabled again.
+* Argument      : uint32_t ch; I : Ethernet channel number
+* Return Value  : The number of frames waiting
+******************************************************************************/
+uint32_t R_Ether_RxPending (uint32_t ch)
+{
+    edmac_recv_desc_t * p   = geth_desc_ptr->pRecv_end;   /* Current descriptor */
+    uint32_t            count = 0;
+    (void) ch;
+
+    if (!RX_DESC_IN_RING(p))
+    {
+        return 0;
+    }
+
+    while ((count < geth_desc_ptr->num_recv) && (RX_DESC_IN_RING(p)) && (p->rd0.BIT.RACT == 0))
+    {
+        count++;
+        p = p->pNext;
+    }
+
+    if (0 == count)
+    {
+        lan_rx_interrupt_enable();
+    }
+    return count;
+}
+
+/******************************************************************************
+* Outline       : Set receive interrupt moderation
+* Include       : none
+* Function Name : R_Ether_RxModeration
+* Description   : When enabled the receive interrupt is disabled after each
+*               : receive call-back until the frames have been read.
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : _Bool bf_enable; I : true to enable moderation
+* Return Value  : none
+******************************************************************************/
+void R_Ether_RxModeration (uint32_t ch, _Bool bf_enable)
+{
+    (void) ch;
+    gbf_rx_moderation = bf_enable;
+    if (!gbf_rx_moderation)
+    {
+        lan_rx_interrupt_enable();
+    }
+}
+
+/******************************************************************************
+* Outline       : Get the counters
+* Include       : none
+* Function Name : R_Ether_GetStatistics
+* Description   : Copies the driver's counters
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : ether_statistics_t *p_stats; O : The destination
+* Return Value  : none
+******************************************************************************/
+void R_Ether_GetStatistics (uint32_t ch, ether_statistics_t *p_stats)
+{
+    (void) ch;
+    int_t   lock = R_OS_SysLock(NULL);
+
+    *p_stats = *((ether_statistics_t *) &gst_statistics);
+    R_OS_SysUnlock(NULL, lock);
+}
 /******************************************************************************
 * ID            : ï¿½|
 * Outline       : Transfer the frame
@@ -596,6 +886,7 @@ int32_t R_Ether_Read (uint32_t ch, void *buf)
 *               : uint32_t len;I : Ethernet frame length (unit:byte)
 * Return Value  : R_ETHER_OK(0)    : Success
 *               : R_ETHER_ERROR(-1): Error
+*               : R_ETHER_BUSY(-7) : The transmit descriptor is busy
 ******************************************************************************/
 int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
 {
@@ -609,22 +900,29 @@ int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
     }
 
     /* Sanity check 1 */
-    if ((p < (edmac_send_desc_t *)geth_desc_ptr)
-    ||  (p > (edmac_send_desc_t *)(geth_desc_ptr + sizeof(txrx_descriptor_set_t))))
+    if (!TX_DESC_IN_RING(p))
     {
         TRACE(("R_Ether_Write: Error in list 0x%p\r\n", p));
         return R_ETHER_ERROR;
     }
 
+    /* ==== Release the frames sent by R_Ether_WriteGather ==== */
+    R_Ether_TxReclaim(ch);
+
     /* ==== When the buffer is full ==== */
     if (p->td0.BIT.TACT == 1)
     {
-        return R_ETHER_ERROR;
+        gst_statistics.tx_ring_full++;
+        return R_ETHER_BUSY;
     }
+
+    /* ---- A frame sent since the reclaim still has its release set ---- */
+    lan_tx_release((int32_t) (p - geth_desc_ptr->dsend), false);
     //TRACE(("Tx%p ", p);
     /* ==== Transfer 1 frame ==== */
 
     /* ---- Copies the transmit frame ---- */
+    p->td2.TBA = geth_buf_ptr->bsend[p - geth_desc_ptr->dsend];
     memcpy(p->td2.TBA, buf, len);
     
     /* Need to write back the cache to physical mem */
@@ -644,7 +942,8 @@ int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
     p->td1.TDL = (uint16_t)len;
 
     /* ---- Sets the transmit descriptor to transmit again ---- */
-    p->td0.BIT.TACT = 1;
+    p->td0.LONG = (p->td0.LONG & TD0_TDLE) | TD0_TFP_START | TD0_TFP_END | TD0_TACT;
+    gst_statistics.tx_frames++;
 
     /* ---- Starts the transmission ---- */
     if ((ETHER.EDTRR0&0x00000003) != 3)
@@ -653,8 +952,7 @@ int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
     }
 
     /* Sanity check 2 */
-    if ((p->pNext < (edmac_send_desc_t *)geth_desc_ptr)
-    ||  (p->pNext > (edmac_send_desc_t *)(geth_desc_ptr + sizeof(txrx_descriptor_set_t))))
+    if (!TX_DESC_IN_RING(p->pNext))
     {
         TRACE(("R_Ether_Write: Error in list next 0x%p\r\n", p->pNext));
         return R_ETHER_ERROR;
@@ -667,6 +965,275 @@ int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
     return R_ETHER_OK;
 }
 
+/******************************************************************************
+* Outline       : Transfer the frame from a list of segments
+* Include       : none
+* Function Name : R_Ether_WriteGather
+* Description   : Sends an Ethernet frame made from a list of segments. Large
+*               : segments are sent from where they are using one descriptor
+*               : each. Runs of small segments are copied into the buffer of
+*               : a descriptor. The frame is started when all the descriptors
+*               : have been set.
+* Argument      : uint32_t ch; I : Ethernet channel number
+*               : const ether_segment_t segments[]; I : The segments
+*               : uint32_t num_segments; I : The number of segments
+*               : void (*pfn_release)(void *); I : Function called when the
+*               :                                  frame has been sent
+*               : void *p_release_param; I : The parameter for pfn_release
+* Return Value  : R_ETHER_OK(0)    : Success
+*               : R_ETHER_ERROR(-1): Error
+*               : R_ETHER_BUSY(-7) : Not enough free descriptors
+******************************************************************************/
+int32_t R_Ether_WriteGather (uint32_t ch,
+                             const ether_segment_t segments[],
+                             uint32_t num_segments,
+                             void (*pfn_release)(void *),
+                             void *p_release_param)
+{
+    edmac_send_desc_t * p_first = geth_desc_ptr->pSend_top;   /* First descriptor of the frame */
+    edmac_send_desc_t * p;
+    edmac_send_desc_t * p_last = NULL;
+    uint32_t            total = 0;
+    uint32_t            num_desc = 0;
+    uint32_t            copied = 0;
+    uint32_t            desc;
+    uint32_t            seg;
+    _Bool               b_short;
+    _Bool               b_copy;
+
+    /* ==== link is down ==== */
+    if (glink_status == NEGO_FAIL)
+    {
+        return R_ETHER_ERROR;
+    }
+
+    /* Sanity check 1 */
+    if (!TX_DESC_IN_RING(p_first))
+    {
+        TRACE(("R_Ether_WriteGather: Error in list 0x%p\r\n", p_first));
+        return R_ETHER_ERROR;
+    }
+
+    /* ==== Release the frames which have been sent ==== */
+    R_Ether_TxReclaim(ch);
+
+    /* ==== Count the descriptors needed ==== */
+    for (seg = 0; seg < num_segments; seg++)
+    {
+        total += segments[seg].length;
+    }
+
+    /* A short frame is copied so it can be padded */
+    b_short = (total < MIN_FRAME_SIZE);
+    b_copy = false;
+    for (seg = 0; seg < num_segments; seg++)
+    {
+        if ((b_short) || (segments[seg].length < SIZE_OF_TX_COPY))
+        {
+            /* Start a new copy buffer when the last one was not a copy or
+               this segment does not fit */
+            if ((!b_copy) || ((copied + segments[seg].length) > SIZE_OF_BUFFER))
+            {
+                num_desc++;
+                copied = 0;
+            }
+            copied += segments[seg].length;
+            b_copy = true;
+        }
+        else if (segments[seg].length)
+        {
+            num_desc++;
+            b_copy = false;
+        }
+    }
+
+    if ((0 == num_desc) || (num_desc > geth_desc_ptr->num_send) || (total > MAX_FRAME_SIZE))
+    {
+        return R_ETHER_ERROR;
+    }
+
+    /* ==== When there are not enough free descriptors ==== */
+    p = p_first;
+    for (desc = 0; desc < num_desc; desc++)
+    {
+        if (p->td0.BIT.TACT == 1)
+        {
+            gst_statistics.tx_ring_full++;
+            return R_ETHER_BUSY;
+        }
+        p = p->pNext;
+    }
+
+    /* ---- Frames sent since the reclaim still have their release set,
+            release them before their slots are used again ---- */
+    p = p_first;
+    for (desc = 0; desc < num_desc; desc++)
+    {
+        lan_tx_release((int32_t) (p - geth_desc_ptr->dsend), false);
+        p = p->pNext;
+    }
+
+    /* ==== Set the descriptors ==== */
+    p = p_first;
+    desc = 0;
+    b_copy = false;
+    for (seg = 0; seg < num_segments; seg++)
+    {
+        uint32_t len = segments[seg].length;
+
+        if ((b_short) || (len < SIZE_OF_TX_COPY))
+        {
+            if ((!b_copy) || ((p_last->td1.TDL + len) > SIZE_OF_BUFFER))
+            {
+                /* Move on to the next descriptor and use its buffer */
+                if (p_last)
+                {
+                    p = p->pNext;
+                }
+                p->td2.TBA = geth_buf_ptr->bsend[p - geth_desc_ptr->dsend];
+                p->td1.TDL = 0;
+                p_last = p;
+            }
+
+            /* ---- Copies the segment ---- */
+            memcpy(p->td2.TBA + p->td1.TDL, segments[seg].p_data, len);
+            p->td1.TDL = (uint16_t)(p->td1.TDL + len);
+            b_copy = true;
+        }
+        else if (len)
+        {
+            if (p_last)
+            {
+                p = p->pNext;
+            }
+
+            /* ---- Sends the segment from where it is ---- */
+            p->td2.TBA = segments[seg].p_data;
+            p->td1.TDL = (uint16_t)len;
+            p_last = p;
+            b_copy = false;
+        }
+        else
+        {
+            /* Nothing to send */
+        }
+    }
+
+    /* ---- Padding for the short frame ---- */
+    if (b_short)
+    {
+        memset((p_last->td2.TBA + total), 0, (MIN_FRAME_SIZE - total));
+        p_last->td1.TDL = MIN_FRAME_SIZE;
+    }
+
+    /* ---- Sets the frame position and enables all but the first ---- */
+    p = p_first;
+    for (desc = 0; desc < num_desc; desc++)
+    {
+        uint32_t td0 = p->td0.LONG & TD0_TDLE;
+
+        /* Need to write back the cache to physical mem */
+        R_CACHE_L1_CleanLine((uint32_t) p->td2.TBA, p->td1.TDL);
+
+        if (0 == desc)
+        {
+            td0 |= TD0_TFP_START;
+        }
+        else
+        {
+            td0 |= TD0_TACT;
+        }
+        if ((num_desc - 1) == desc)
+        {
+            td0 |= TD0_TFP_END;
+        }
+        p->td0.LONG = td0;
+        p = p->pNext;
+    }
+
+    /* ---- Enables the first so the E-DMAC takes the whole frame ---- */
+    p_first->td0.LONG |= TD0_TACT;
+    gst_statistics.tx_frames++;
+
+    /* ---- Registers the release call-back after the frame is enabled ---- */
+    if (pfn_release)
+    {
+        gpv_tx_release_param[p_last - geth_desc_ptr->dsend] = p_release_param;
+        gpfn_tx_release[p_last - geth_desc_ptr->dsend] = pfn_release;
+    }
+
+    /* ---- Starts the transmission ---- */
+    if ((ETHER.EDTRR0&0x00000003) != 3)
+    {
+        ETHER.EDTRR0 |= 0x00000003;
+    }
+
+    /* Sanity check 2 */
+    if (!TX_DESC_IN_RING(p_last->pNext))
+    {
+        TRACE(("R_Ether_WriteGather: Error in list next 0x%p\r\n", p_last->pNext));
+        return R_ETHER_ERROR;
+    }
+
+    /* ==== Update the current pointer value ==== */
+    geth_desc_ptr->pSend_top = p_last->pNext;
+    return R_ETHER_OK;
+}
+
+/******************************************************************************
+* Outline       : Release the transmitted frames
+* Include       : none
+* Function Name : R_Ether_TxReclaim
+* Description   : Calls the release call-back of each frame sent by
+*               : R_Ether_WriteGather that the E-DMAC has finished with.
+* Argument      : uint32_t ch; I : Ethernet channel number
+* Return Value  : none
+******************************************************************************/
+void R_Ether_TxReclaim (uint32_t ch)
+{
+    int32_t i;
+    (void) ch;
+
+    for (i = 0; i < (int32_t) geth_desc_ptr->num_send; i++)
+    {
+        lan_tx_release(i, false);
+    }
+}
+
+/******************************************************************************
+* Outline       : Release a transmitted frame
+* Include       : none
+* Function Name : lan_tx_release
+* Description   : Calls the release call-back set on a transmit descriptor by
+*               : R_Ether_WriteGather once the E-DMAC has finished with it.
+* Argument      : int32_t index; I : The transmit descriptor
+*               : _Bool bf_abandon; I : true when the E-DMAC has been stopped
+*               :                       and the frame will not be sent
+* Return Value  : none
+******************************************************************************/
+static void lan_tx_release (int32_t index, _Bool bf_abandon)
+{
+    void    (*pfn_release)(void *) = NULL;
+    void    *p_param = NULL;
+    int_t   lock = R_OS_SysLock(NULL);
+
+    /* Take the call-back when the descriptor has been transmitted */
+    if ((NULL != gpfn_tx_release[index])
+    &&  ((bf_abandon) || (0 == geth_desc_ptr->dsend[index].td0.BIT.TACT)))
+    {
+        pfn_release = gpfn_tx_release[index];
+        p_param = gpv_tx_release_param[index];
+        gpfn_tx_release[index] = NULL;
+    }
+    R_OS_SysUnlock(NULL, lock);
+
+    /* Call it outside of the lock */
+    if (pfn_release)
+    {
+        pfn_release(p_param);
+    }
+}
+
 /******************************************************************************
 * ID            : ï¿½|
 * Outline       : Create the descriptor
@@ -677,47 +1244,62 @@ int32_t R_Ether_Write (uint32_t ch, void * buf, uint32_t len)
 * Argument      : none
 * Return Value  : 0 for success or -1 on error
 ******************************************************************************/
-static int32_t lan_desc_create (void)
+static int32_t lan_desc_create (const ether_config_t *p_config)
 {
     int32_t    i;
+    uint32_t   num_send = p_config->num_tx_descriptors;
+    uint32_t   num_recv = p_config->num_rx_descriptors;
+    uint32_t   num_spare = p_config->num_rx_loan_buffers;
+
+    if ((num_send < 2) || (num_send > MAX_NUM_OF_TX_DESCRIPTOR)
+    ||  (num_recv < 2) || (num_recv > MAX_NUM_OF_RX_DESCRIPTOR)
+    ||  (num_spare > MAX_NUM_OF_RX_LOAN_BUFFER))
+    {
+        return -1;
+    }
+
     /* ==== Descriptor area configuration ==== */
-#ifdef _ALLOC_MEM_
-    /* ---- Memory clear ---- */
-    geth_desc_ptr = (txrx_descriptor_set_t_ptr)geth_desc;
-    memset((void *)geth_desc_ptr, 0, sizeof(txrx_descriptor_set_t));
-#else
-    /* ---- Memory clear ---- */
-    geth_desc_ptr = (txrx_descriptor_set_t_ptr)ADDR_OF_TXRX_DESC;
-    memset((void *)geth_desc_ptr, 0, sizeof(txrx_descriptor_set_t));
-#endif
-    /* ==== Buffer area configuration ==== */
-#ifdef _ALLOC_MEM_
-    geth_buf_ptr  = (txrx_buffer_set_t_ptr)etMalloc(sizeof(txrx_buffer_set_t),
-                                                    32UL,
-                                                    &gpv_txrx_buffer_base);
-    if (geth_buf_ptr)
+    geth_desc_ptr->dsend = (edmac_send_desc_t *)etMalloc((sizeof(edmac_send_desc_t) * num_send)
+                                                       + (sizeof(edmac_recv_desc_t) * num_recv),
+                                                         32UL,
+                                                         &gpv_txrx_descriptor_base);
+    if (NULL == geth_desc_ptr->dsend)
     {
-        memset((void *)geth_buf_ptr, 0, sizeof(txrx_buffer_set_t));
+        return -1;
     }
-    else
+    memset((void *)geth_desc_ptr->dsend, 0, (sizeof(edmac_send_desc_t) * num_send)
+                                          + (sizeof(edmac_recv_desc_t) * num_recv));
+    geth_desc_ptr->drecv = (edmac_recv_desc_t *)(geth_desc_ptr->dsend + num_send);
+    geth_desc_ptr->num_send = num_send;
+    geth_desc_ptr->num_recv = num_recv;
+
+    /* ==== Buffer area configuration ==== */
+    geth_buf_ptr->bsend = etMalloc((SIZE_OF_BUFFER * num_send)
+                                 + ((SIZE_OF_RX_HEADROOM + SIZE_OF_BUFFER) * (num_recv + num_spare)),
+                                   32UL,
+                                   &gpv_txrx_buffer_base);
+    if (NULL == geth_buf_ptr->bsend)
     {
+        /* Do not leave the descriptors allocated without buffers */
+        etFree(gpv_txrx_descriptor_base);
+        gpv_txrx_descriptor_base = NULL;
+        geth_desc_ptr->dsend = NULL;
+        geth_desc_ptr->drecv = NULL;
+        geth_desc_ptr->num_send = 0;
+        geth_desc_ptr->num_recv = 0;
         return -1;
     }
-#else
-    /* ---- Clear the area ---- */
-    geth_buf_ptr  = (txrx_buffer_set_t_ptr)ADDR_OF_TXRX_BUFF;
-    memset((void *)geth_buf_ptr, 0, sizeof(txrx_buffer_set_t));
-#endif
+    geth_buf_ptr->brecv = (void *) (geth_buf_ptr->bsend + num_send);
 
     /* ---- Transmit descriptor ---- */
-    for (i = 0; i < NUM_OF_TX_DESCRIPTOR; i++)
+    for (i = 0; i < (int32_t) num_send; i++)
     {
         TRACE(("geth_desc_ptr->dsend[i].td2.TBA = 0x%p\r\n", geth_buf_ptr->bsend[i]));
         geth_desc_ptr->dsend[i].td2.TBA  = geth_buf_ptr->bsend[i];  /* TD2 */
         geth_desc_ptr->dsend[i].td1.TDL  = 0;                      /* TD1 */
         geth_desc_ptr->dsend[i].td0.LONG = 0x30000000;        /* TD0:1frame/1buf1buf, transmission disabled */
 
-        if ((NUM_OF_TX_DESCRIPTOR - 1) != i)
+        if (((int32_t) num_send - 1) != i)
         {
             geth_desc_ptr->dsend[i].pNext = &geth_desc_ptr->dsend[i + 1]; /* pNext */
         }
@@ -727,14 +1309,14 @@ static int32_t lan_desc_create (void)
     geth_desc_ptr->dsend[i - 1].pNext        = &geth_desc_ptr->dsend[0];
 
     /* ---- Receive descriptor ---- */
-    for (i = 0; i < NUM_OF_RX_DESCRIPTOR; i++)
+    for (i = 0; i < (int32_t) num_recv; i++)
     {
         TRACE(("geth_desc_ptr->drecv[i].rd2.RBA = 0x%p\r\n", geth_buf_ptr->brecv[i]));
-        geth_desc_ptr->drecv[i].rd2.RBA = geth_buf_ptr->brecv[i];      /* RD2 */
+        geth_desc_ptr->drecv[i].rd2.RBA = &geth_buf_ptr->brecv[i][SIZE_OF_RX_HEADROOM];   /* RD2 */
         geth_desc_ptr->drecv[i].rd1.RBL = (uint16_t)SIZE_OF_BUFFER;   /* RD1 */
         geth_desc_ptr->drecv[i].rd0.LONG= 0xB0000000;        /* RD0:1frame/1buf, reception enabled */
 
-        if ((NUM_OF_RX_DESCRIPTOR - 1) != i )
+        if (((int32_t) num_recv - 1) != i )
         {
             geth_desc_ptr->drecv[i].pNext = &geth_desc_ptr->drecv[i + 1]; /* pNext */
         }
@@ -743,6 +1325,21 @@ static int32_t lan_desc_create (void)
     geth_desc_ptr->drecv[i - 1].rd0.BIT.RDLE = 1;                /* Set the last descriptor */
     geth_desc_ptr->drecv[i - 1].pNext        = &geth_desc_ptr->drecv[0];
 
+    /* ---- Spare receive buffers ---- */
+    for (i = 0; i < (int32_t) num_spare; i++)
+    {
+        gpby_rx_spare[i] = &geth_buf_ptr->brecv[num_recv + i][SIZE_OF_RX_HEADROOM];
+    }
+    gui_rx_spare_count = num_spare;
+    gui_rx_spare_total = num_spare;
+
+    /* ---- No frames are waiting to be released ---- */
+    for (i = 0; i < MAX_NUM_OF_TX_DESCRIPTOR; i++)
+    {
+        gpfn_tx_release[i] = NULL;
+    }
+    memset((void *) &gst_statistics, 0, sizeof(gst_statistics));
+
     /* ---- Initialize descriptor management information ---- */
     geth_desc_ptr->pSend_top = &geth_desc_ptr->dsend[0];
     geth_desc_ptr->pRecv_end = &geth_desc_ptr->drecv[0];
@@ -836,12 +1433,12 @@ static void lan_reg_set (int32_t link)
     /* Ethernet Controller (ETHER)
     TDFXR - Transmit Descriptor Finished Address Register
     b31:b0  TDFX[31:0] - Transmit Descriptor Finished Address */
-    ETHER.TDFXR0        = &geth_desc_ptr->dsend[NUM_OF_TX_DESCRIPTOR - 1];
+    ETHER.TDFXR0        = &geth_desc_ptr->dsend[geth_desc_ptr->num_send - 1];
 
     /* Ethernet Controller (ETHER)
     RDFXR - Receive Descriptor Finished Address Register
     b31:b0  RDFX[31:0] - Receive Descriptor Finished Address */
-    ETHER.RDFXR0        = &geth_desc_ptr->drecv[NUM_OF_RX_DESCRIPTOR - 1];
+    ETHER.RDFXR0        = &geth_desc_ptr->drecv[geth_desc_ptr->num_recv - 1];
 
     /* Ethernet Controller (ETHER)
     TDFFR - Transmit Descriptor Final Flag Register
@@ -1032,7 +1629,9 @@ static void lan_reg_set (int32_t link)
     /* Ethernet Controller (ETHER)
     EESIPR - E-MAC/E-DMAC Status Interrupt Permission Register
     b31:b0             - Refer to EESR comment : Enable/Disable (1/0) */
-    ETHER.EESIPR0   = 0x00040000;      /* b18     FR         - Frame Reception (1) */
+    ETHER.EESIPR0   = 0x00070000;      /* b18     FR         - Frame Reception (1)
+                                          b17     RDE        - Receive Descriptor Empty (1)
+                                          b16     RFOF       - Receive FIFO Overflow (1) */
 
     /* Ethernet Controller (ETHER)
     CheckSum Mode Register */
@@ -1106,7 +1705,22 @@ void lan_send_handler_isr (uint32_t status)
 ******************************************************************************/
 void lan_recv_handler_isr (uint32_t status)
 {
-    UNUSED_PARAM(status);
+    /* Count the frames lost */
+    if (status & EESR_RFOF)
+    {
+        gst_statistics.rx_fifo_overflows++;
+    }
+    if (status & EESR_RDE)
+    {
+        gst_statistics.rx_ring_overruns++;
+    }
+
+    /* Let the reader take the rest of the burst without interrupts */
+    if ((gbf_rx_moderation) && (status & EESR_FR))
+    {
+        ETHER.EESIPR0 &= (uint32_t) ~(EESR_FR);
+    }
+
     if (gpfn_rx_call_back)
     {
         gpfn_rx_call_back(gpv_rx_parameter);
@@ -1144,9 +1758,9 @@ void INT_Ether(uint32_t status)
         lan_send_handler_isr(stat_edmac & EDMAC_EESIPR_INI_SEND);
     }
        /* ==== Reception-related ==== */
-    if (stat_edmac & EDMAC_EESIPR_INI_RECV)
+    if (stat_edmac & (EDMAC_EESIPR_INI_RECV | EESR_RDE))
     {
-        lan_recv_handler_isr( stat_edmac & EDMAC_EESIPR_INI_RECV );
+        lan_recv_handler_isr( stat_edmac & (EDMAC_EESIPR_INI_RECV | EESR_RDE) );
     }
     /* ==== E-MAC-related ==== */
     if (stat_edmac & EDMAC_EESIPR_INI_EtherC)
@@ -1283,6 +1897,36 @@ void lan_set_tx_call_back(void (*pfn_tx_call_back)(void *),
 {
     gpfn_tx_call_back = pfn_tx_call_back;
     gpv_tx_parameter = pv_tx_parameter;
+
+    /* Only interrupt on frame transmission complete when it is wanted */
+    if (pfn_tx_call_back)
+    {
+        ETHER.EESIPR0 |= EESR_TC;
+    }
+    else
+    {
+        ETHER.EESIPR0 &= (uint32_t) ~(EESR_TC);
+    }
+}
+
+/******************************************************************************
+* Outline       : Enable the receive interrupt
+* Include       : none
+* Function Name : lan_rx_interrupt_enable
+* Description   : Enables the frame reception interrupt after it has been
+*               : disabled by receive interrupt moderation. A frame received
+*               : while it was disabled causes an interrupt straight away.
+* Argument      : none
+* Return Value  : none
+******************************************************************************/
+static void lan_rx_interrupt_enable (void)
+{
+    if (!(ETHER.EESIPR0 & EESR_FR))
+    {
+        int_t   lock = R_OS_SysLock(NULL);
+        ETHER.EESIPR0 |= EESR_FR;
+        R_OS_SysUnlock(NULL, lock);
+    }
 }
 
 
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_glyph_cache.h
+ * @brief          Pre-rendered glyph cache and text renderer for the ASCII
+ *                 font used by the PMOD display
+ * @version        1.00
+ * @date           24.04.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 24.04.2019 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef R_GLYPH_CACHE_H
+#define R_GLYPH_CACHE_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_PMOD_API
+ * @defgroup R_SW_PKG_93_GLYPH_CACHE Glyph Cache
+ * @brief Text output to frame buffers
+ *
+ * @anchor R_SW_PKG_93_GLYPH_CACHE_SUMMARY
+ * @par Summary
+ *
+ * Characters of ASCII_TABLE are converted to pixels once for each
+ * foreground colour, background colour and pixel format, and kept in a
+ * small set associative cache. R_GLYPH_DrawText() then writes a string one
+ * pixel line at a time, copying the matching line of every glyph in turn,
+ * so each line of the text is a single run of memory writes.
+ *
+ * The cache is allocated by the caller. Each task drawing text should use
+ * its own cache, or serialise access to a shared one.
+ *
+ * @anchor R_SW_PKG_93_GLYPH_CACHE_INSTANCES
+ * @par Known Implementations:
+ * This driver is used in the RZA1H Software Package.
+ * @see RENESAS_APPLICATION_SOFTWARE_PACKAGE
+ * @{
+ *****************************************************************************/
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include "r_typedefs.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define GLYPH_WIDTH             (6u)    /*!< Pixels per character, including the space    */
+#define GLYPH_HEIGHT            (8u)    /*!< Lines per character, including the space      */
+#define GLYPH_MAX_BPP           (3u)    /*!< Largest bytes per pixel of e_glyph_format_t   */
+#define GLYPH_CACHE_SETS        (32u)   /*!< Sets of the cache, must be a power of 2       */
+#define GLYPH_CACHE_WAYS        (2u)    /*!< Glyphs per set                                */
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+/*! @enum e_glyph_format_t
+ *  @brief Pixel format of the target
+ */
+typedef enum
+{
+    GLYPH_FORMAT_RGB888 = 0,            /*!< 3 bytes, colour bits 23-16 first, as the PMOD display buffer */
+    GLYPH_FORMAT_RGB565                 /*!< 16 bits, as a VDC RGB565 graphics surface                   */
+} e_glyph_format_t;
+
+/*! @struct st_glyph_target_t
+ *  @brief Frame buffer that text is drawn into
+ */
+typedef struct
+{
+    uint8_t          *p_base;           /*!< First pixel of line 0                                */
+    int32_t          stride;            /*!< Bytes from a line to the line below, may be negative */
+    uint16_t         width;             /*!< Pixels per line                                      */
+    uint16_t         height;            /*!< Lines                                                */
+    e_glyph_format_t format;            /*!< Pixel format                                         */
+} st_glyph_target_t;
+
+/*! @struct st_glyph_entry_t
+ *  @brief One cached character
+ */
+typedef struct
+{
+    uint32_t run;                       /* Run of R_GLYPH_DrawText that last used it   */
+    uint32_t fg;                        /* Key: foreground colour                      */
+    uint32_t bg;                        /* Key: background colour                      */
+    uint8_t  code;                      /* Key: character, 0 when the entry is unused  */
+    uint8_t  format;                    /* Key: e_glyph_format_t                       */
+    uint8_t  pixels[GLYPH_HEIGHT * GLYPH_WIDTH * GLYPH_MAX_BPP]; /* Line 0 first       */
+} st_glyph_entry_t;
+
+/*! @struct st_glyph_cache_t
+ *  @brief Glyph cache, allocated by the caller
+ */
+typedef struct
+{
+    st_glyph_entry_t entry[GLYPH_CACHE_SETS][GLYPH_CACHE_WAYS];
+    uint8_t          victim[GLYPH_CACHE_SETS];  /* Way replaced by the next miss in the set */
+    uint32_t         run;               /* Current run, its glyphs are not replaced */
+    uint32_t         hits;              /*!< Characters found in the cache  */
+    uint32_t         misses;            /*!< Characters rendered from ASCII_TABLE */
+} st_glyph_cache_t;
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**
+ * @brief       Empties a glyph cache and clears its statistics.
+ *
+ * @param[out]  p_cache:        Glyph cache
+ */
+void R_GLYPH_CacheInit(st_glyph_cache_t * const p_cache);
+
+/**
+ * @brief       Draws a line of text. Characters outside 0x20 - 0x7E are
+ *              drawn as spaces. Pixels outside the target are not written.
+ *
+ * @param[in]   p_cache:        Glyph cache
+ * @param[in]   p_target:       Frame buffer
+ * @param[in]   x:              Left pixel of the first character, may be negative
+ * @param[in]   y:              Top line of the characters, may be negative
+ * @param[in]   p_text:         Characters
+ * @param[in]   len:            Number of characters
+ * @param[in]   fg:             Foreground colour, 0x00RRGGBB
+ * @param[in]   bg:             Background colour, 0x00RRGGBB
+ */
+void R_GLYPH_DrawText(st_glyph_cache_t * const p_cache, const st_glyph_target_t * const p_target,
+        const int_t x, const int_t y, const uint8_t * p_text, const uint32_t len,
+        const uint32_t fg, const uint32_t bg);
+
+#endif  /* R_GLYPH_CACHE_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
@@ -316,18 +316,16 @@ void R_LCD_DisplayRAWImage (uint8_t *image, uint8_t image_width,
                          uint8_t image_height, uint8_t loc_x, uint8_t loc_y);
 
 /**
-* @brief          This function puts a 24-bit image on the 16-bit display,
-*                 colour reduction is embedded in display routine.
+* @brief          This function sends the areas of the display buffer changed
+*                 since the last update to the 16-bit display, colour
+*                 reduction is embedded in display routine. The data is sent
+*                 by DMA when the dma_pmod_wr and dma_pmod_rd channels are
+*                 available. The changed areas are kept if a transfer times
+*                 out, so that they are sent again by the next call.
 *
-* @param[in]      image:        24 bit RGB888 format RAW data no header
-* @param[in]      image_width:  Target image width
-* @param[in]      image_height: Target image height
-* @param[in]      loc_x:        Image horizontal position on display
-* @param[in]      loc_y:        Image vertical position on display
-*
-* @return         None
+* @return         true if the display was updated, false on a DMA time-out
 */
-void R_LCD_UpdateDisplay (void);
+bool_t R_LCD_UpdateDisplay (void);
 
 /**
 * @brief          Enable Display (display can be written to whiles disabled)
@@ -0,0 +1,328 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+/*******************************************************************************
+* File Name     : r_glyph_cache.c
+* Device(s)     : RZ/A1H (R7S721001)
+* Tool-Chain    : GNUARM-NONE-EABI-v16.01
+* H/W Platform  : RSK+RZA1H CPU Board
+* Description   : Pre-rendered glyph cache and text renderer. Please refer to
+*                 the header file r_glyph_cache.h for detail explanation
+*******************************************************************************/
+/*******************************************************************************
+* History       : DD.MM.YYYY Version Description
+*               : 24.04.2019 1.00    First Release
+*******************************************************************************/
+
+/*******************************************************************************
+* User Includes (Project Level Includes)
+*******************************************************************************/
+#include <string.h>
+
+/* Default  type definition header */
+#include "r_typedefs.h"
+
+/* ASCII font header */
+#include "ascii.h"
+
+/* Glyph cache header */
+#include "r_glyph_cache.h"
+
+/*******************************************************************************
+* Macro Definitions
+*******************************************************************************/
+/* Characters held in ASCII_TABLE */
+#define GLYPH_PRV_FIRST_CODE    (0x20u)
+#define GLYPH_PRV_LAST_CODE     (0x7Eu)
+
+/* Characters resolved before their lines are copied */
+#define GLYPH_PRV_RUN_MAX       (32u)
+
+/*******************************************************************************
+* Local Function Prototypes
+*******************************************************************************/
+static uint32_t glyph_bpp (e_glyph_format_t format);
+static void glyph_render (st_glyph_entry_t *p_entry);
+static const uint8_t *glyph_lookup (st_glyph_cache_t *p_cache, uint8_t code,
+                                    e_glyph_format_t format, uint32_t fg, uint32_t bg);
+
+/*******************************************************************************
+* Function Name : glyph_bpp
+* Description   : Returns the bytes per pixel of a format
+* Argument      : format - pixel format
+* Return value  : bytes per pixel
+*******************************************************************************/
+static uint32_t glyph_bpp (e_glyph_format_t format)
+{
+    return ((GLYPH_FORMAT_RGB565 == format) ? 2u : 3u);
+}
+/*******************************************************************************
+* End of function glyph_bpp
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : glyph_render
+* Description   : Converts a character of ASCII_TABLE to pixels. Each byte of
+*                 the table is one column, with the top line in bit 7.
+* Argument      : p_entry - entry with its key filled in
+* Return value  : none
+*******************************************************************************/
+static void glyph_render (st_glyph_entry_t *p_entry)
+{
+    const char *p_columns = ASCII_TABLE[p_entry->code - GLYPH_PRV_FIRST_CODE];
+    uint8_t *p_pixel = p_entry->pixels;
+    uint32_t colour;
+    uint16_t rgb565;
+    uint32_t line;
+    uint32_t column;
+
+    for (line = 0; line < GLYPH_HEIGHT; line++)
+    {
+        for (column = 0; column < GLYPH_WIDTH; column++)
+        {
+            colour = (((uint8_t)p_columns[column]) & (0x80u >> line)) ? p_entry->fg : p_entry->bg;
+
+            if (GLYPH_FORMAT_RGB565 == p_entry->format)
+            {
+                rgb565 = (uint16_t)((((colour >> 19) & 0x1Fu) << 11) |
+                                    (((colour >> 10) & 0x3Fu) << 5) |
+                                    ((colour >> 3) & 0x1Fu));
+                *p_pixel++ = (uint8_t)rgb565;
+                *p_pixel++ = (uint8_t)(rgb565 >> 8);
+            }
+            else
+            {
+                *p_pixel++ = (uint8_t)(colour >> 16);
+                *p_pixel++ = (uint8_t)(colour >> 8);
+                *p_pixel++ = (uint8_t)colour;
+            }
+        }
+    }
+}
+/*******************************************************************************
+* End of function glyph_render
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : glyph_lookup
+* Description   : Finds a character in the cache, rendering it into the least
+*                 recently used way of its set when it is not there. Glyphs
+*                 of the current run are kept, as their lines are still to be
+*                 copied.
+* Argument      : p_cache - glyph cache
+*                 code    - character, 0x20 - 0x7E
+*                 format  - pixel format
+*                 fg, bg  - colours
+* Return value  : pixels of the character, line 0 first, or NULL if every
+*                 way of the set holds a glyph of the current run
+*******************************************************************************/
+static const uint8_t *glyph_lookup (st_glyph_cache_t *p_cache, uint8_t code,
+                                    e_glyph_format_t format, uint32_t fg, uint32_t bg)
+{
+    st_glyph_entry_t *p_set;
+    st_glyph_entry_t *p_entry;
+    uint32_t set;
+    uint32_t way;
+    uint32_t i;
+
+    set = (code ^ ((fg * 0x9E3779B1u) >> 27) ^ ((bg * 0x85EBCA6Bu) >> 28) ^ ((uint32_t)format << 4))
+          & (GLYPH_CACHE_SETS - 1u);
+    p_set = p_cache->entry[set];
+
+    for (way = 0; way < GLYPH_CACHE_WAYS; way++)
+    {
+        p_entry = &p_set[way];
+        if ((p_entry->code == code) && (p_entry->fg == fg) && (p_entry->bg == bg)
+                && (p_entry->format == (uint8_t)format))
+        {
+            p_cache->victim[set] = (uint8_t)((way + 1u) % GLYPH_CACHE_WAYS);
+            p_cache->hits++;
+            p_entry->run = p_cache->run;
+            return (p_entry->pixels);
+        }
+    }
+
+    way = p_cache->victim[set];
+    for (i = 0; (i < GLYPH_CACHE_WAYS) && (p_set[way].run == p_cache->run); i++)
+    {
+        way = (way + 1u) % GLYPH_CACHE_WAYS;
+    }
+
+    if (p_set[way].run == p_cache->run)
+    {
+        return (NULL);
+    }
+
+    p_cache->victim[set] = (uint8_t)((way + 1u) % GLYPH_CACHE_WAYS);
+    p_cache->misses++;
+
+    p_entry = &p_set[way];
+    p_entry->run = p_cache->run;
+    p_entry->code = code;
+    p_entry->format = (uint8_t)format;
+    p_entry->fg = fg;
+    p_entry->bg = bg;
+    glyph_render(p_entry);
+
+    return (p_entry->pixels);
+}
+/*******************************************************************************
+* End of function glyph_lookup
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : R_GLYPH_CacheInit
+* Description   : Empties a glyph cache and clears its statistics
+* Argument      : p_cache - glyph cache
+* Return value  : none
+*******************************************************************************/
+void R_GLYPH_CacheInit (st_glyph_cache_t * const p_cache)
+{
+    /* code 0 is never looked up, so every entry misses */
+    memset(p_cache, 0, sizeof(st_glyph_cache_t));
+    p_cache->run = 1;
+}
+/*******************************************************************************
+* End of function R_GLYPH_CacheInit
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : R_GLYPH_DrawText
+* Description   : Draws a line of text. The glyphs of up to GLYPH_PRV_RUN_MAX
+*                 characters are looked up first, then each pixel line of the
+*                 run is written from left to right.
+* Argument      : p_cache  - glyph cache
+*                 p_target - frame buffer
+*                 x, y     - top left pixel of the first character
+*                 p_text   - characters
+*                 len      - number of characters
+*                 fg, bg   - colours, 0x00RRGGBB
+* Return value  : none
+*******************************************************************************/
+void R_GLYPH_DrawText (st_glyph_cache_t * const p_cache, const st_glyph_target_t * const p_target,
+        const int_t x, const int_t y, const uint8_t * p_text, const uint32_t len,
+        const uint32_t fg, const uint32_t bg)
+{
+    const uint8_t *p_glyph[GLYPH_PRV_RUN_MAX];
+    const uint32_t bpp = glyph_bpp(p_target->format);
+    const uint32_t glyph_line = GLYPH_WIDTH * bpp;
+    uint8_t *p_dst;
+    uint8_t code;
+    int_t left;
+    int_t first;
+    int_t last;
+    int_t line0;
+    int_t line1;
+    int_t line;
+    int_t column0;
+    int_t column1;
+    int_t skip;
+    uint32_t run;
+    uint32_t i;
+
+    /* lines of the target covered by the text */
+    line0 = (y < 0) ? (-y) : 0;
+    line1 = (int_t)p_target->height - y;
+    line1 = (line1 > (int_t)GLYPH_HEIGHT) ? (int_t)GLYPH_HEIGHT : line1;
+
+    /* characters at least partly inside the target */
+    first = (x < 0) ? ((-x) / (int_t)GLYPH_WIDTH) : 0;
+    last = (((int_t)p_target->width - x) + ((int_t)GLYPH_WIDTH - 1)) / (int_t)GLYPH_WIDTH;
+    last = (last > (int_t)len) ? (int_t)len : last;
+
+    if ((line0 >= line1) || (first >= last))
+    {
+        return;
+    }
+
+    while (first < last)
+    {
+        run = (uint32_t)(last - first);
+        run = (run > GLYPH_PRV_RUN_MAX) ? GLYPH_PRV_RUN_MAX : run;
+
+        /* a new run, no glyph is in use. 0 is the run of unused entries */
+        p_cache->run++;
+        if (0 == p_cache->run)
+        {
+            p_cache->run = 1;
+        }
+
+        for (i = 0; i < run; i++)
+        {
+            code = p_text[(uint32_t)first + i];
+            if ((code < GLYPH_PRV_FIRST_CODE) || (code > GLYPH_PRV_LAST_CODE))
+            {
+                code = (uint8_t)' ';
+            }
+            p_glyph[i] = glyph_lookup(p_cache, code, p_target->format, fg, bg);
+
+            /* the set is full of this run, the character starts the next one */
+            if (NULL == p_glyph[i])
+            {
+                run = i;
+            }
+        }
+
+        left = x + (first * (int_t)GLYPH_WIDTH);
+
+        for (line = line0; line < line1; line++)
+        {
+            p_dst = p_target->p_base + ((int32_t)(y + line) * p_target->stride);
+
+            for (i = 0; i < run; i++)
+            {
+                /* clip the columns of the characters at either edge */
+                column0 = left + ((int_t)i * (int_t)GLYPH_WIDTH);
+                column1 = column0 + (int_t)GLYPH_WIDTH;
+                skip = (column0 < 0) ? (-column0) : 0;
+                column1 = (column1 > (int_t)p_target->width) ? (int_t)p_target->width : column1;
+
+                /* whole lines have a constant size, so the copy is inlined */
+                if ((0 == skip) && ((column0 + (int_t)GLYPH_WIDTH) == column1))
+                {
+                    if (2u == bpp)
+                    {
+                        memcpy(p_dst + ((uint32_t)column0 * 2u),
+                               p_glyph[i] + ((uint32_t)line * GLYPH_WIDTH * 2u), GLYPH_WIDTH * 2u);
+                    }
+                    else
+                    {
+                        memcpy(p_dst + ((uint32_t)column0 * 3u),
+                               p_glyph[i] + ((uint32_t)line * GLYPH_WIDTH * 3u), GLYPH_WIDTH * 3u);
+                    }
+                }
+                else if ((column0 + skip) < column1)
+                {
+                    memcpy(p_dst + ((uint32_t)(column0 + skip) * bpp),
+                           p_glyph[i] + ((uint32_t)line * glyph_line) + ((uint32_t)skip * bpp),
+                           (uint32_t)(column1 - (column0 + skip)) * bpp);
+                }
+            }
+        }
+
+        first += (int_t)run;
+    }
+}
+/*******************************************************************************
+* End of function R_GLYPH_DrawText
+*******************************************************************************/
@@ -40,6 +40,7 @@
 *******************************************************************************/
 /* Includes assembly level definitions */
 #include <string.h>
+#include <fcntl.h>
 
 /* Interchangeable compiler specific header */
 #include "compiler_settings.h"
@@ -50,12 +51,21 @@
 /* ASCII font header */
 #include "ascii.h"
 
+/* Glyph cache header */
+#include "r_glyph_cache.h"
+
 /* rspi Device Driver header */
 #include "rspi.h"
 
 /* Device driver header */
 #include "dev_drv.h"
 
+/* DMA driver header */
+#include "r_dmac_drv_api.h"
+
+/* Cache maintenance header */
+#include "r_cache_l1_rz_api.h"
+
 /* PMOD LCD controlling function prototypes & macros */
 #include "r_lcd_pmod.h"
 
@@ -72,6 +82,22 @@
 #define PMOD_LCD_PRV_GET_GREEN_COMP(a) ((((a) >> 0x08) & 0xFF))
 #define PMOD_LCD_PRV_GET_BLUE_COMP(a)  (((a) & 0xFF))
 
+/* Bytes per line of display_buffer */
+#define PMOD_LCD_PRV_ROW_BYTES         (SCREEN_WIDTH * 3)
+
+/* Pixels converted per SPI transfer, two transfers are kept in flight */
+#define PMOD_LCD_PRV_CHUNK_PIXELS      (SCREEN_WIDTH * 8)
+
+/* SPI frames per pixel, RGB565 is sent as 2 bytes */
+#define PMOD_LCD_PRV_FRAMES_PER_PIXEL  (2)
+
+/* Unchanged pixels worth resending rather than setting up a new window,
+ * CASET, RASET and RAMWR with their parameters take 11 bytes */
+#define PMOD_LCD_PRV_WINDOW_COST       (6)
+
+/* A chunk takes 1.5 ms at 11.11 Mbit/s */
+#define PMOD_LCD_PRV_DMA_TIMEOUT_MS    (100)
+
 
 /* PMOD LCD details */
 typedef struct
@@ -86,10 +112,29 @@ typedef struct
     uint32_t back_colour;
 
     uint8_t  display_buffer[128][128 * 3];
-    uint8_t  final_buffer[128][128 * 3];
+
+    /* Characters already converted to display_buffer pixels */
+    st_glyph_cache_t glyphs;
+
+    /* Changed columns of each display_buffer line, clean when first > last */
+    uint8_t  dirty_first[SCREEN_HEIGHT];
+    uint8_t  dirty_last[SCREEN_HEIGHT];
+
+    /* SPI frames for the panel, one is filled while the other is sent */
+    uint16_t tx_frames[2][PMOD_LCD_PRV_CHUNK_PIXELS * PMOD_LCD_PRV_FRAMES_PER_PIXEL];
 
 } st_lcd_object_t;
 
+/* Walk through display_buffer in panel order for one window */
+typedef struct
+{
+    const uint8_t *p_line;  /* Pixel at the start of the current panel line */
+    int_t    step;          /* Bytes to the next pixel along a panel line     */
+    int_t    line;          /* Bytes to the next panel line                   */
+    uint32_t width;         /* Pixels per panel line                          */
+    uint32_t x;             /* Pixels already taken from the current line     */
+} st_lcd_walk_t;
+
 /*******************************************************************************
 * Local Function Prototypes
 *******************************************************************************/
@@ -97,18 +142,35 @@ static void init_pmod_lcd (void);
 static void charput (uint8_t const val);
 static void display_write_command (uint8_t const  cmd);
 static void display_write_data (uint8_t data);
-static void display_write_pixel (uint8_t const x, uint8_t const y,
-                                 uint32_t const colour);
 static void display_draw_horz_line (uint8_t const line, uint32_t const  colour);
 static void display_set_addr_window (uint8_t xs, uint8_t ys,
                                      uint8_t xe, uint8_t ye);
-static void display_write_char_column (uint8_t const x, uint8_t const y,
-                                       uint8_t const pattern);
-static void display_write_image (uint8_t const *data, int16_t count);
+static void display_write_run (uint8_t const * str, uint8_t const count);
+static bool_t display_write_image (uint16_t const *frames, uint32_t count);
+static bool_t display_write_image_wait (void);
 static void display_delay_ms (uint32_t  time_ms);
+static void display_mark_dirty (int_t x0, int_t y0, int_t x1, int_t y1);
+static void display_mark_clean (void);
+static void display_convert (st_lcd_walk_t *p_walk, uint16_t *frames, uint32_t count);
+static bool_t display_update_window (uint8_t first_col, uint8_t first_row,
+                                     uint8_t last_col, uint8_t last_row);
+static void display_dma_open (void);
+static bool_t display_dma_start (uint16_t const *frames, uint32_t count);
+static bool_t display_dma_wait (void);
+static void display_dma_complete (void);
 
 static  event_t s_pmod_lcd_lock = 0;
 
+/* DMA channels sending to and draining RSPI1, -1 for CPU transfers */
+static int_t s_dma_wr_handle = (-1);
+static int_t s_dma_rd_handle = (-1);
+
+/* Released by the end of the read DMA, the last frame has then been sent */
+static uint32_t s_dma_semaphore = 0;
+
+/* Received frames are not used */
+static volatile uint16_t s_dma_discard;
+
 /*******************************************************************************
 Global variables and functions
 *******************************************************************************/
@@ -131,12 +193,6 @@ st_lcd_object_t g_my_lcd;
 *******************************************************************************/
 static void charput (uint8_t const val)
 {
-    uint8_t * ptr;
-    uint8_t   i;
-    uint8_t   pattern;
-    uint8_t   x;
-    uint8_t   y;
-
     switch (val)
     {
         /* Carriage return character */
@@ -173,34 +229,7 @@ static void charput (uint8_t const val)
             /* Ensure value is within the ASCII range */
             if ((val >= 0x20) && (val <= 0x7f))
             {
-                /* Get pointer to start of representation of character
-                 * in ASCII table */
-                ptr = (uint8_t *)&ASCII_TABLE[val - 0x20][0];
-
-                /* Copy character over */
-                for (i = 0; i < FONT_WIDTH; i++)
-                {
-                    pattern = (*ptr++);
-                    x = (uint8_t)((g_my_lcd.curx * FONT_WIDTH) + i);
-                    y = (uint8_t)(g_my_lcd.cury * FONT_HEIGHT);
-                    display_write_char_column(x, y, pattern);
-                }
-
-                /* move cursor to next co-ordinate on LCD */
-                g_my_lcd.curx++;
-
-                /* move to next row if reached the end of line */
-                if (g_my_lcd.curx >= CHAR_PER_LINE)
-                {
-                    g_my_lcd.curx = 0;
-                    g_my_lcd.cury++;
-                    if (g_my_lcd.cury >= MAX_LINES)
-                    {
-                        /* loop back to top line if the
-                         * last line of the display is reached */
-                        g_my_lcd.cury = 0;
-                    }
-                }
+                display_write_run(&val, 1);
             }
         }
         break;
@@ -211,37 +240,69 @@ static void charput (uint8_t const val)
 *******************************************************************************/
 
 /*******************************************************************************
-* Function Name : display_delay_ms
-* Description   : Delay routine for LCD or any other devices.
-* Argument      : (uint32_t) time_ms - time in millisecond
-* Return value  : None
+* Function Name : display_write_run
+* Description   : Displays characters at the current cursor position, all on
+*                 the current line. Advances the cursor by count positions.
+*                 Cursor wraps as for charput.
+* Argument      : str   - characters, 0x20 - 0x7f
+*                 count - number of characters, no more than the rest of the
+*                         line
+* Return value  : none
 *******************************************************************************/
-static void display_delay_ms (uint32_t  time_ms)
+static void display_write_run (uint8_t const * str, uint8_t const count)
 {
-    R_OS_TaskSleep(time_ms);
+    st_glyph_target_t target;
+    int_t x;
+    int_t y;
+
+    /* display_buffer holds the display bottom line first, from display line 1 */
+    target.p_base = &g_my_lcd.display_buffer[SCREEN_HEIGHT - 1][0];
+    target.stride = -PMOD_LCD_PRV_ROW_BYTES;
+    target.width = SCREEN_WIDTH;
+    target.height = SCREEN_HEIGHT - 1;
+    target.format = GLYPH_FORMAT_RGB888;
+
+    x = g_my_lcd.curx * FONT_WIDTH;
+    y = g_my_lcd.cury * FONT_HEIGHT;
+
+    /* The top line of the font falls outside display_buffer on text line 0 */
+    R_GLYPH_DrawText(&g_my_lcd.glyphs, &target, x, y - 1, str, count,
+                     g_my_lcd.font_colour, g_my_lcd.back_colour);
+    display_mark_dirty(x, SCREEN_HEIGHT - (y + (FONT_HEIGHT - 1)),
+                       (x + (count * FONT_WIDTH)) - 1, SCREEN_HEIGHT - y);
+
+    /* move cursor to next co-ordinate on LCD */
+    g_my_lcd.curx = (uint8_t)(g_my_lcd.curx + count);
+
+    /* move to next row if reached the end of line */
+    if (g_my_lcd.curx >= CHAR_PER_LINE)
+    {
+        g_my_lcd.curx = 0;
+        g_my_lcd.cury++;
+        if (g_my_lcd.cury >= MAX_LINES)
+        {
+            /* loop back to top line if the
+             * last line of the display is reached */
+            g_my_lcd.cury = 0;
+        }
+    }
 }
 /*******************************************************************************
-* End of function display_delay_ms
+* End of function display_write_run
 *******************************************************************************/
 
 /*******************************************************************************
-* Function Name : display_write_pixel
-* Description   : Write the colour to the current cursor position
-* Argument      : x,y - pixel position
-*                 colour in R5G6B5 format
-* Return value  : none
+* Function Name : display_delay_ms
+* Description   : Delay routine for LCD or any other devices.
+* Argument      : (uint32_t) time_ms - time in millisecond
+* Return value  : None
 *******************************************************************************/
-static void display_write_pixel (uint8_t const x,
-                                 uint8_t const y,
-                                 uint32_t const colour)
+static void display_delay_ms (uint32_t  time_ms)
 {
-    g_my_lcd.display_buffer[SCREEN_HEIGHT - y][((x*3)+0)] = PMOD_LCD_PRV_GET_RED_COMP(colour);
-    g_my_lcd.display_buffer[SCREEN_HEIGHT - y][((x*3)+1)] = PMOD_LCD_PRV_GET_GREEN_COMP(colour);
-    g_my_lcd.display_buffer[SCREEN_HEIGHT - y][((x*3)+2)] = PMOD_LCD_PRV_GET_BLUE_COMP(colour);
+    R_OS_TaskSleep(time_ms);
 }
-
 /*******************************************************************************
-* End of function display_write_pixel
+* End of function display_delay_ms
 *******************************************************************************/
 
 /*******************************************************************************
@@ -266,44 +327,12 @@ static void display_draw_horz_line (uint8_t const line, uint32_t const colour)
             g_my_lcd.display_buffer[SCREEN_HEIGHT - y][((x*3)+1)] = PMOD_LCD_PRV_GET_GREEN_COMP(colour);
             g_my_lcd.display_buffer[SCREEN_HEIGHT - y][((x*3)+2)] = PMOD_LCD_PRV_GET_BLUE_COMP(colour);
         }
+        display_mark_dirty(0, SCREEN_HEIGHT - y, SCREEN_WIDTH - 1, SCREEN_HEIGHT - y);
     }
 }
 /*******************************************************************************
 * End of function display_draw_horz_line
 *******************************************************************************/
-/*******************************************************************************
-* Function Name : display_write_char_column
-* Description   : Write a character at a current cursor position
-* Argument      : x,y pixel position
-*                 pattern to draw 1 = font colour, 0 = back colour
-* Return value  : None
-*******************************************************************************/
-static void display_write_char_column (uint8_t const x,
-                                         uint8_t const y, uint8_t const pattern)
-{
-    uint8_t mask;
-    uint8_t i;
-    uint8_t y1;
-
-    mask = 0x80;
-    for (i = 0; i < FONT_HEIGHT; i++)
-    {
-        y1 = (uint8_t)(y + i);
-        if (pattern & mask)
-        {
-            display_write_pixel(x, y1,g_my_lcd.font_colour);
-        }
-        else
-        {
-            display_write_pixel(x, y1,g_my_lcd.back_colour);
-        }
-        mask = (uint8_t)(mask >> 1);
-    }
-}
-/*******************************************************************************
-* End of function display_write_char_column
-*******************************************************************************/
-
 /*******************************************************************************
 * Function Name : init_pmod_lcd
 * Description   : Initialises the LCD display.
@@ -401,23 +430,19 @@ static void display_set_addr_window (uint8_t xs, uint8_t ys, uint8_t xe, uint8_t
 
 /*******************************************************************************
 * Function Name : display_write_image
-* Description   : This function puts a single line of a 24-bit image on the
-*                 16-bit display, colour reduction to 16-bit is embedded in
-*                 function.
-* Argument      : uint8_t  *data  - pointer to image data in RGB888 format RAW
-*                 data no header
-*                 uint16_t count  - Target image width * 3 (1 byte per colour
-*                 (RGB) per pixel)
-* Return value  : none
+* Description   : This function sends panel data prepared by display_convert.
+*                 The frames are passed to the DMAC when it is available, in
+*                 which case the transfer is still running on return and
+*                 must be finished with display_write_image_wait.
+* Argument      : uint16_t *frames  - SPI frames, one byte in the top half of
+*                                     each
+*                 uint32_t count    - number of frames
+* Return value  : true if the transfer is still running
 * Note          : DATA_CMD_PIN is set hi for data.
 *******************************************************************************/
-static void display_write_image (uint8_t const *data, int16_t count)
+static bool_t display_write_image (uint16_t const *frames, uint32_t count)
 {
     uint16_t trans_data = 0u;
-    uint16_t idata = 0u;
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
 
     UNUSED_VARIABLE(trans_data);
 
@@ -427,19 +452,16 @@ static void display_write_image (uint8_t const *data, int16_t count)
     /* assert chip select */
     ENABLE_PIN  &= (uint16_t)(~ENABLE_PIN_BIT);
 
-    while(count > 0)
+    if (display_dma_start(frames, count))
     {
-        r = ((*(data++)) >>3);
-        g = ((*(data++)) >>2);
-        b = ((*(data++)) >>3);
-        count = (int16_t)(count - 3);
-
-        idata  = (uint16_t)(((b<<11) + (g<<5)) + r);
-
-        g_my_lcd.data_block_content = (uint8_t)(idata>>8);
+        return (true);
+    }
 
+    while (count > 0)
+    {
         /*send command */
-        SPDR_1L = (uint16_t)(g_my_lcd.data_block_content << 8u);
+        SPDR_1L = (*(frames++));
+        count--;
 
         while (0u == (SPSR_1 & 0x80))
         {
@@ -460,41 +482,197 @@ static void display_write_image (uint8_t const *data, int16_t count)
                 /* Overrun error occurred */
             };
         }
+    }
 
-        g_my_lcd.data_block_content = (uint8_t)idata;
+    /* de-assert chip select */
+    ENABLE_PIN  |= ENABLE_PIN_BIT;
 
-        /*send command */
-        SPDR_1L = (uint16_t)(g_my_lcd.data_block_content << 8u);
+    /* data cmd pin high to signify data */
+    DATA_CMD_PIN |= DATA_CMD_PIN_BIT;
 
-        while (0u == (SPSR_1 & 0x80))
-           {
-            /*wait for send command completion */
-           }
+    return (false);
+}
+/*******************************************************************************
+* End of function display_write_image
+*******************************************************************************/
 
-        /* check if number of receive data is reached */
-        if (0u != (SPSR_1 & 0x80))
+/*******************************************************************************
+* Function Name : display_write_image_wait
+* Description   : Sleeps until a transfer started by display_write_image has
+*                 been sent, then releases the panel.
+* Argument      : none
+* Return value  : true if the transfer completed, false if it was stopped
+*******************************************************************************/
+static bool_t display_write_image_wait (void)
+{
+    bool_t done;
+
+    done = display_dma_wait();
+
+    /* de-assert chip select */
+    ENABLE_PIN  |= ENABLE_PIN_BIT;
+
+    /* data cmd pin high to signify data */
+    DATA_CMD_PIN |= DATA_CMD_PIN_BIT;
+
+    return (done);
+}
+/*******************************************************************************
+* End of function display_write_image_wait
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_dma_open
+* Description   : Opens the DMA channels for RSPI1. Panel data is sent by the
+*                 CPU if they are not available.
+* Argument      : none
+* Return value  : none
+*******************************************************************************/
+static void display_dma_open (void)
+{
+    if ((-1) != s_dma_wr_handle)
+    {
+        return;
+    }
+
+    s_dma_wr_handle = open(DEVICE_INDENTIFIER "dma_pmod_wr", O_WRONLY);
+    s_dma_rd_handle = open(DEVICE_INDENTIFIER "dma_pmod_rd", O_RDONLY);
+
+    if ((s_dma_wr_handle < 0) || (s_dma_rd_handle < 0)
+            || (false == R_OS_CreateSemaphore(&s_dma_semaphore, 0)))
+    {
+        if (s_dma_wr_handle >= 0)
         {
-            /* Read receiver buffer */
-            trans_data = SPDR_1L;
+            close(s_dma_wr_handle);
+        }
+        if (s_dma_rd_handle >= 0)
+        {
+            close(s_dma_rd_handle);
         }
+        s_dma_wr_handle = (-1);
+        s_dma_rd_handle = (-1);
+    }
+}
+/*******************************************************************************
+* End of function display_dma_open
+*******************************************************************************/
 
-        if (0u != (SPSR_1 & 0x01))
+/*******************************************************************************
+* Function Name : display_dma_start
+* Description   : Starts sending frames to RSPI1 by DMA. A second channel
+*                 drains the receive buffer, its end shows that the last
+*                 frame has left the shift register.
+* Argument      : uint16_t *frames  - SPI frames
+*                 uint32_t count    - number of frames
+* Return value  : true if the transfer was started
+*******************************************************************************/
+static bool_t display_dma_start (uint16_t const *frames, uint32_t count)
+{
+    st_r_drv_dmac_config_t dma_config;
+    int_t result;
+
+    if ((-1) == s_dma_wr_handle)
+    {
+        return (false);
+    }
+
+    /* discard a completion that arrived after an earlier transfer timed out */
+    while (R_OS_WaitForSemaphore(&s_dma_semaphore, 0))
+    {
+        /* do nothing */
+    }
+
+    R_CACHE_L1_CleanLine((uint32_t) frames, count * sizeof(uint16_t));
+
+    dma_config.config.resource = DMA_RS_SPRI1;
+    dma_config.config.source_width = DMA_DATA_SIZE_2;
+    dma_config.config.destination_width = DMA_DATA_SIZE_2;
+    dma_config.config.source_address_type = DMA_ADDRESS_FIX;
+    dma_config.config.destination_address_type = DMA_ADDRESS_FIX;
+    dma_config.config.direction = DMA_REQUEST_SOURCE;
+    dma_config.config.p_dmaComplete = display_dma_complete;
+    dma_config.config.p_dmaError = NULL;
+    dma_config.config.source_address = (void *) &SPDR_1L;
+    dma_config.config.destination_address = (void *) &s_dma_discard;
+    dma_config.config.count = count * sizeof(uint16_t);
+
+    result = control(s_dma_rd_handle, CTL_DMAC_SET_CONFIGURATION, (void *) &dma_config);
+    if (DRV_SUCCESS == result)
+    {
+        result = control(s_dma_rd_handle, CTL_DMAC_ENABLE, NULL);
+    }
+
+    if (DRV_SUCCESS == result)
+    {
+        dma_config.config.resource = DMA_RS_SPTI1;
+        dma_config.config.source_address_type = DMA_ADDRESS_INCREMENT;
+        dma_config.config.destination_address_type = DMA_ADDRESS_FIX;
+        dma_config.config.direction = DMA_REQUEST_DESTINATION;
+        dma_config.config.p_dmaComplete = NULL;
+        dma_config.config.source_address = (void *) frames;
+        dma_config.config.destination_address = (void *) &SPDR_1L;
+
+        result = control(s_dma_wr_handle, CTL_DMAC_SET_CONFIGURATION, (void *) &dma_config);
+        if (DRV_SUCCESS == result)
         {
-            while(1)
-            {
-                /* Overrun error occurred */
-            };
+            result = control(s_dma_wr_handle, CTL_DMAC_ENABLE, NULL);
         }
     }
 
-    /* de-assert chip select */
-    ENABLE_PIN  |= ENABLE_PIN_BIT;
+    if (DRV_SUCCESS != result)
+    {
+        return (false);
+    }
 
-    /* data cmd pin high to signify data */
-    DATA_CMD_PIN |= DATA_CMD_PIN_BIT;
+    /* RSPI1 requests the first frame straight away */
+    R_RSPI1_DmaRequestEnable();
+
+    return (true);
 }
 /*******************************************************************************
-* End of function display_write_image
+* End of function display_dma_start
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_dma_wait
+* Description   : Sleeps until the transfer started by display_dma_start has
+*                 been sent.
+* Argument      : none
+* Return value  : true if the transfer completed, false if it was stopped
+*******************************************************************************/
+static bool_t display_dma_wait (void)
+{
+    bool_t done;
+    uint32_t remaining;
+
+    done = R_OS_WaitForSemaphore(&s_dma_semaphore, PMOD_LCD_PRV_DMA_TIMEOUT_MS);
+
+    R_RSPI1_DmaRequestDisable();
+
+    if (false == done)
+    {
+        control(s_dma_wr_handle, CTL_DMAC_DISABLE, (void *) &remaining);
+        control(s_dma_rd_handle, CTL_DMAC_DISABLE, (void *) &remaining);
+    }
+
+    return (done);
+}
+/*******************************************************************************
+* End of function display_dma_wait
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_dma_complete
+* Description   : End of the read DMA, called in interrupt context.
+* Argument      : none
+* Return value  : none
+*******************************************************************************/
+static void display_dma_complete (void)
+{
+    R_OS_ReleaseSemaphore(&s_dma_semaphore);
+}
+/*******************************************************************************
+* End of function display_dma_complete
 *******************************************************************************/
 
 /*******************************************************************************
@@ -642,83 +820,215 @@ static void update_display_buffer (uint8_t *image, uint8_t image_width,
             g_my_lcd.display_buffer[y + loc_y][(3 * (x + loc_x)) + 2] = (*(image + (hdr_offset  + (count++))));
         }
     }
+
+    display_mark_dirty(loc_x, loc_y, (loc_x + image_width) - 1, (loc_y + image_height) - 1);
 }
 /*******************************************************************************
 * End of function update_display_buffer
 *******************************************************************************/
 
 /*******************************************************************************
-* Function Name : rotate_image
-* Description   : rotate image as specified by g_my_lcd.angle
-* Argument      : none g_my_lcd.angle is set externally to this function
+* Function Name : display_mark_dirty
+* Description   : Records that an area of display_buffer has to be sent to
+*                 the panel by the next R_LCD_UpdateDisplay
+* Argument      : x0, y0 - first column and line of display_buffer
+*                 x1, y1 - last column and line, clipped to the display
 * Return value  : None
 *******************************************************************************/
-static void rotate_image(void)
+static void display_mark_dirty (int_t x0, int_t y0, int_t x1, int_t y1)
 {
     int_t y;
-    int_t x;
-    int_t count = 0;
-    uint8_t *image = (uint8_t *)&g_my_lcd.display_buffer;
 
-    switch (g_my_lcd.angle)
+    x0 = (x0 < 0) ? 0 : x0;
+    y0 = (y0 < 0) ? 0 : y0;
+    x1 = (x1 >= SCREEN_WIDTH) ? (SCREEN_WIDTH - 1) : x1;
+    y1 = (y1 >= SCREEN_HEIGHT) ? (SCREEN_HEIGHT - 1) : y1;
+
+    if (x0 > x1)
     {
-        /* 90 degrees rotate */
-        case 1:
-            for(x = 0; x < SCREEN_WIDTH; x++)
+        return;
+    }
+
+    for (y = y0; y <= y1; y++)
+    {
+        if (g_my_lcd.dirty_first[y] > g_my_lcd.dirty_last[y])
+        {
+            g_my_lcd.dirty_first[y] = (uint8_t)x0;
+            g_my_lcd.dirty_last[y] = (uint8_t)x1;
+        }
+        else
+        {
+            if (x0 < g_my_lcd.dirty_first[y])
             {
-                for(y = (SCREEN_HEIGHT-1); y >= 0; y--)
-                {
-                    g_my_lcd.final_buffer[y][(3 * x) + 0] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 1] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 2] = (*(image + (count++)));
-                }
+                g_my_lcd.dirty_first[y] = (uint8_t)x0;
             }
+            if (x1 > g_my_lcd.dirty_last[y])
+            {
+                g_my_lcd.dirty_last[y] = (uint8_t)x1;
+            }
+        }
+    }
+}
+/*******************************************************************************
+* End of function display_mark_dirty
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_mark_clean
+* Description   : Records that the panel matches display_buffer
+* Argument      : None
+* Return value  : None
+*******************************************************************************/
+static void display_mark_clean (void)
+{
+    memset(g_my_lcd.dirty_first, 0xFF, sizeof(g_my_lcd.dirty_first));
+    memset(g_my_lcd.dirty_last, 0x00, sizeof(g_my_lcd.dirty_last));
+}
+/*******************************************************************************
+* End of function display_mark_clean
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_convert
+* Description   : Takes the next pixels of a window from display_buffer and
+*                 converts them to SPI frames for the panel
+* Argument      : p_walk - position in the window, advanced by count
+*                 frames - PMOD_LCD_PRV_FRAMES_PER_PIXEL frames per pixel
+*                 count  - pixels
+* Return value  : None
+*******************************************************************************/
+static void display_convert (st_lcd_walk_t *p_walk, uint16_t *frames, uint32_t count)
+{
+    const uint8_t *pixel;
+    uint16_t idata;
+
+    while (count > 0)
+    {
+        pixel = p_walk->p_line + ((int_t)p_walk->x * p_walk->step);
+
+        /* the panel is wired BGR */
+        idata  = (uint16_t)((((uint32_t)(pixel[2] >> 3)) << 11) +
+                            (((uint32_t)(pixel[1] >> 2)) << 5) + (pixel[0] >> 3));
+
+        *(frames++) = (uint16_t)(idata & 0xFF00u);
+        *(frames++) = (uint16_t)(idata << 8u);
+        count--;
+
+        p_walk->x++;
+        if (p_walk->x >= p_walk->width)
+        {
+            p_walk->x = 0;
+            p_walk->p_line += p_walk->line;
+        }
+    }
+}
+/*******************************************************************************
+* End of function display_convert
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name : display_update_window
+* Description   : Sends an area of display_buffer to the panel, rotated as
+*                 specified by g_my_lcd.angle. The area is sent as a single
+*                 panel window, read from display_buffer in the order the
+*                 panel fills it so that no intermediate copy is needed.
+* Argument      : first_col, first_row - top left of the area in display_buffer
+*                 last_col, last_row   - bottom right of the area
+* Return value  : true if the area was sent, false if a transfer timed out
+*******************************************************************************/
+static bool_t display_update_window (uint8_t first_col, uint8_t first_row,
+                                     uint8_t last_col, uint8_t last_row)
+{
+    const uint8_t *image = &g_my_lcd.display_buffer[0][0];
+    st_lcd_walk_t walk;
+    uint8_t xs;
+    uint8_t ys;
+    uint8_t xe;
+    uint8_t ye;
+    uint32_t remaining;
+    uint32_t count;
+    uint_t buffer = 0;
+    bool_t busy = false;
+
+    switch (g_my_lcd.angle)
+    {
+        /* 90 degrees rotate, display_buffer lines become panel columns */
+        case 1:
+            xs = first_row;
+            xe = last_row;
+            ys = first_col;
+            ye = last_col;
+            walk.p_line = image + ((first_row * PMOD_LCD_PRV_ROW_BYTES) + (3 * first_col));
+            walk.step = PMOD_LCD_PRV_ROW_BYTES;
+            walk.line = 3;
             break;
 
         /* 180 degrees rotate */
         case 2:
-            for(y = (SCREEN_HEIGHT-1); y >= 0; y--)
-            {
-                for(x = (SCREEN_WIDTH-1); x >= 0; x--)
-                {
-                    g_my_lcd.final_buffer[y][(3 * x) + 0] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 1] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 2] = (*(image + (count++)));
-                }
-            }
+            xs = (uint8_t)((SCREEN_WIDTH - 1) - last_col);
+            xe = (uint8_t)((SCREEN_WIDTH - 1) - first_col);
+            ys = first_row;
+            ye = last_row;
+            walk.p_line = image + ((first_row * PMOD_LCD_PRV_ROW_BYTES) + (3 * last_col));
+            walk.step = -3;
+            walk.line = PMOD_LCD_PRV_ROW_BYTES;
             break;
 
         /* 270 degrees rotate */
         case 3:
-            for(x = (SCREEN_WIDTH-1); x >= 0; x--)
-            {
-                for(y = 0; y < SCREEN_HEIGHT; y++)
-                {
-                    g_my_lcd.final_buffer[y][(3 * x) + 0] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 1] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 2] = (*(image + (count++)));
-                }
-            }
+            xs = (uint8_t)((SCREEN_HEIGHT - 1) - last_row);
+            xe = (uint8_t)((SCREEN_HEIGHT - 1) - first_row);
+            ys = (uint8_t)((SCREEN_WIDTH - 1) - last_col);
+            ye = (uint8_t)((SCREEN_WIDTH - 1) - first_col);
+            walk.p_line = image + ((last_row * PMOD_LCD_PRV_ROW_BYTES) + (3 * last_col));
+            walk.step = -PMOD_LCD_PRV_ROW_BYTES;
+            walk.line = -3;
             break;
 
-        /* 0 degrees rotate */
+        /* 0 degrees rotate, display_buffer is held bottom line first */
         case 0:
-            for(y = 0; y < SCREEN_HEIGHT; y++)
-            {
-                for(x = 0; x < SCREEN_WIDTH; x++)
-                {
-                    g_my_lcd.final_buffer[y][(3 * x) + 0] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 1] = (*(image + (count++)));
-                    g_my_lcd.final_buffer[y][(3 * x) + 2] = (*(image + (count++)));
-                }
-            }
-        break;
         default:
-        break;
+            xs = first_col;
+            xe = last_col;
+            ys = (uint8_t)((SCREEN_HEIGHT - 1) - last_row);
+            ye = (uint8_t)((SCREEN_HEIGHT - 1) - first_row);
+            walk.p_line = image + ((last_row * PMOD_LCD_PRV_ROW_BYTES) + (3 * first_col));
+            walk.step = 3;
+            walk.line = -PMOD_LCD_PRV_ROW_BYTES;
+            break;
+    }
+    walk.width = (uint32_t)((xe - xs) + 1);
+    walk.x = 0;
+
+    display_set_addr_window(xs, ys, xe, ye);
+    display_write_command(ST7735_RAMWR);
+
+    /* convert each chunk while the previous one is being sent */
+    remaining = walk.width * (uint32_t)((ye - ys) + 1);
+    while (remaining > 0)
+    {
+        count = (remaining > PMOD_LCD_PRV_CHUNK_PIXELS) ? PMOD_LCD_PRV_CHUNK_PIXELS : remaining;
+        display_convert(&walk, g_my_lcd.tx_frames[buffer], count);
+        remaining -= count;
+
+        if (busy && (false == display_write_image_wait()))
+        {
+            return (false);
+        }
+        busy = display_write_image(g_my_lcd.tx_frames[buffer],
+                                   count * PMOD_LCD_PRV_FRAMES_PER_PIXEL);
+        buffer ^= 1u;
     }
+
+    if (busy)
+    {
+        return (display_write_image_wait());
+    }
+
+    return (true);
 }
 /*******************************************************************************
-* End of function rotate_image
+* End of function display_update_window
 *******************************************************************************/
 
 /*******************************************************************************
@@ -740,6 +1050,11 @@ void R_LCD_ImageRotation(uint8_t angle)
         case 2:
         case 3:
             {
+                if (g_my_lcd.angle != angle)
+                {
+                    /* every pixel moves on the panel */
+                    display_mark_dirty(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
+                }
                 g_my_lcd.angle = angle;
             }
         break;
@@ -807,6 +1122,16 @@ void R_LCD_PmodInit (void)
     g_my_lcd.font_colour = DEFAULT_FONT_COLOUR;
     g_my_lcd.back_colour = DEFAULT_BACKGROUND_COLOUR;
 
+    /* start with an empty glyph cache */
+    R_GLYPH_CacheInit(&g_my_lcd.glyphs);
+
+    /* the panel content is unknown until the first update */
+    display_mark_clean();
+    display_mark_dirty(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
+
+    /* send panel data by DMA when the channels are available */
+    display_dma_open();
+
     /* initialise Standard PMOD display */
     init_pmod_lcd();
 }
@@ -844,13 +1169,32 @@ void R_LCD_DisplayStr (uint8_t * str)
 {
     uint16_t i;
     uint16_t size;
+    uint8_t  run;
 
     size = (uint16_t)strlen((const char *)str);
 
     /* load characters into screen bitmap */
-    for (i = 0; i < size; i++)
+    i = 0;
+    while (i < size)
     {
-        charput(*str++);
+        /* printable characters up to the end of the line are drawn together */
+        run = 0;
+        while (((i + run) < size) && ((g_my_lcd.curx + run) < CHAR_PER_LINE)
+                && (str[i + run] >= 0x20) && (str[i + run] <= 0x7f))
+        {
+            run++;
+        }
+
+        if (run > 0)
+        {
+            display_write_run(&str[i], run);
+            i = (uint16_t)(i + run);
+        }
+        else
+        {
+            charput(str[i]);
+            i++;
+        }
     }
 }
 /*******************************************************************************
@@ -901,6 +1245,8 @@ void R_LCD_DisplayClear (uint32_t colour)
             g_my_lcd.display_buffer[y][(3 * x) + 2] = (uint8_t)PMOD_LCD_PRV_GET_BLUE_COMP(colour);
         }
     }
+
+    display_mark_dirty(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
 }
 /*******************************************************************************
 * End of function R_LCD_DisplayClear
@@ -953,34 +1299,76 @@ void R_LCD_DisplayRAWImage (uint8_t *image, uint8_t image_width,
 
 /*******************************************************************************
 * Function Name : R_LCD_UpdateDisplay
-* Description   : This function puts a 24-bit image on the 16-bit display,
-*                 colour reduction is embedded in display routine.
-* Argument      : uint8_t  *image       - 24 bit RGB888 format RAW data no
-*                                         header
-*                 uint16_t image_width  - Target image width
-*                 uint16_t image_height - Target image height
-*                 uint16_t loc_x        - Image horizontal position on display
-*                 uint16_t loc_y        - Image vertical position on display
-* Return value  : none
+* Description   : This function sends the parts of the display buffer changed
+*                 since the last update to the 16-bit display, colour
+*                 reduction is embedded in display routine.
+*                 Dirty lines are grouped into rectangular windows, a line is
+*                 added to the current window unless the unchanged pixels
+*                 that would be resent cost more than starting a new one.
+*                 The lines are left dirty if a transfer times out.
+* Argument      : none
+* Return value  : true if the display was updated, false on a time-out
 *******************************************************************************/
-void R_LCD_UpdateDisplay (void)
+bool_t R_LCD_UpdateDisplay (void)
 {
-    uint8_t y;
-    uint8_t image_width = SCREEN_WIDTH;
-    uint8_t image_height = SCREEN_HEIGHT;
-    uint8_t loc_x = 0;
-    uint8_t loc_y = 0;
+    int_t y;
+    int_t first_row = (-1);
+    int_t first_col = 0;
+    int_t last_col = 0;
+    int_t col0;
+    int_t col1;
+    int_t waste;
+
+    for (y = 0; y <= SCREEN_HEIGHT; y++)
+    {
+        if ((y < SCREEN_HEIGHT) && (g_my_lcd.dirty_first[y] <= g_my_lcd.dirty_last[y]))
+        {
+            if (first_row < 0)
+            {
+                first_row = y;
+                first_col = g_my_lcd.dirty_first[y];
+                last_col = g_my_lcd.dirty_last[y];
+                continue;
+            }
 
-    rotate_image();
+            col0 = (g_my_lcd.dirty_first[y] < first_col) ? g_my_lcd.dirty_first[y] : first_col;
+            col1 = (g_my_lcd.dirty_last[y] > last_col) ? g_my_lcd.dirty_last[y] : last_col;
 
-    for(y = 0; y < image_height; y++)
-    {
-        display_set_addr_window((uint8_t)(loc_x), (uint8_t)(loc_y + y),
-              (uint8_t)(image_width - 1), (uint8_t)((loc_y + image_height) - 1));
-        display_write_command(ST7735_RAMWR);
-        display_write_image((&g_my_lcd.final_buffer[((image_height - y) - 1)][0]),
-                            (int16_t)(image_width * 3));
+            /* pixels sent without being changed if the window grows to include this line */
+            waste = (((col1 - col0) + 1) * ((y - first_row) + 1))
+                    - (((last_col - first_col) + 1) * (y - first_row))
+                    - ((g_my_lcd.dirty_last[y] - g_my_lcd.dirty_first[y]) + 1);
+
+            if (waste <= PMOD_LCD_PRV_WINDOW_COST)
+            {
+                first_col = col0;
+                last_col = col1;
+                continue;
+            }
+        }
+
+        if (first_row >= 0)
+        {
+            if (false == display_update_window((uint8_t)first_col, (uint8_t)first_row,
+                                               (uint8_t)last_col, (uint8_t)(y - 1)))
+            {
+                return (false);
+            }
+            first_row = (-1);
+        }
+
+        /* this dirty line starts the next window */
+        if ((y < SCREEN_HEIGHT) && (g_my_lcd.dirty_first[y] <= g_my_lcd.dirty_last[y]))
+        {
+            first_row = y;
+            first_col = g_my_lcd.dirty_first[y];
+            last_col = g_my_lcd.dirty_last[y];
+        }
     }
+
+    display_mark_clean();
+
+    return (true);
 }
 /*******************************************************************************
 * End of function R_LCD_UpdateDisplay
@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2018 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     sound_mixer.h
+ * @brief          Software mixer and sample rate converter API header
+ * @version        1.00
+ * @date           27.06.2018
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 30.06.2018 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_SOUND_API Sound
+ * @defgroup R_SW_PKG_93_SOUND_MIXER Sound Mixer
+ * @brief Mixes several PCM sources into one SSIF stream
+ *
+ * @anchor R_SW_PKG_93_SOUND_MIXER_API_SUMMARY
+ * @par Summary
+ *
+ * Each source may have its own sampling rate, sample size (8, 16 or 24-bit)
+ * and channel count. Sources are converted to the output rate with a
+ * polyphase windowed sinc filter, scaled by their own volume and summed
+ * with saturation into interleaved 16-bit stereo.
+ *
+ * The caller owns the output buffers. A typical player renders a block
+ * with R_SOUND_MixerRender() and queues it on the SSIF channel with
+ * write(), keeping two or more blocks queued so that the SSIF never runs
+ * dry.
+ *
+ * @anchor R_SW_PKG_93_SOUND_MIXER_API_INSTANCES
+ * @par Known Implementations:
+ * This driver is used in the RZA1H Software Package.
+ * @see RENESAS_APPLICATION_SOFTWARE_PACKAGE
+ *
+ * @see RENESAS_OS_ABSTRACTION  Renesas OS Abstraction interface
+ * @{
+ *****************************************************************************/
+
+/******************************************************************************
+Includes   <System Includes> , "Project Includes"
+******************************************************************************/
+#include "r_typedefs.h"
+#include "sound_if.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/******************************************************************************
+Macro definitions
+******************************************************************************/
+#define SOUND_MIXER_MAX_SOURCES     (4u)    /*!< Sources mixed at the same time */
+#define SOUND_MIXER_BLOCK           (64u)   /*!< Output frames processed per pass */
+#define SOUND_MIXER_TAPS            (8u)    /*!< Filter taps per output sample */
+#define SOUND_MIXER_PHASES          (32u)   /*!< Filter phases between input samples */
+#define SOUND_MIXER_MAX_RATIO       (4u)    /*!< Highest source rate / output rate */
+
+/** Converted source frames held for the filter */
+#define SOUND_MIXER_HIST_SIZE       ((SOUND_MIXER_BLOCK * SOUND_MIXER_MAX_RATIO) + SOUND_MIXER_TAPS)
+
+/******************************************************************************
+Typedef definitions
+******************************************************************************/
+
+/** Sample formats accepted for a source */
+typedef enum
+{
+    SOUND_MIXER_FMT_U8 = 0,     /*!< 8-bit unsigned PCM */
+    SOUND_MIXER_FMT_S16,        /*!< 16-bit signed little endian PCM */
+    SOUND_MIXER_FMT_S24         /*!< 24-bit signed little endian PCM, 3 bytes per sample */
+} e_sound_mixer_fmt_t;
+
+/** Description of a source passed to R_SOUND_MixerAddSource */
+typedef struct
+{
+    const void          *p_data;    /*!< Interleaved PCM, must stay valid while the source plays */
+    uint32_t            frames;     /*!< Number of frames in p_data */
+    uint32_t            freq;       /*!< Sampling rate of p_data */
+    e_sound_mixer_fmt_t fmt;        /*!< Sample format of p_data */
+    uint32_t            channels;   /*!< 1 (mono) or 2 (stereo) */
+    uint32_t            vol;        /*!< Volume 0 - SOUND_VOL_MAX */
+    bool_t              loop;       /*!< Restart from the first frame at the end of the data */
+} st_sound_mixer_src_cfg_t;
+
+/** Source state, private to the mixer */
+typedef struct
+{
+    st_sound_mixer_src_cfg_t cfg;
+    bool_t   active;
+    int32_t  gain;                  /* Q15 */
+    uint32_t read_pos;              /* Next frame of cfg.p_data to convert */
+    uint32_t fill;                  /* Frames held in hist_l/hist_r */
+    uint32_t pos;                   /* Q16 filter position in hist_l/hist_r */
+    uint32_t step;                  /* Q16 source frames per output frame */
+    uint32_t tail;                  /* Silent frames appended after the end of the data */
+    const int16_t (* p_coef)[SOUND_MIXER_TAPS];  /* coef, or a shared filter if the source is not faster than the output */
+    int16_t  coef[SOUND_MIXER_PHASES][SOUND_MIXER_TAPS];
+    int16_t  hist_l[SOUND_MIXER_HIST_SIZE];
+    int16_t  hist_r[SOUND_MIXER_HIST_SIZE];
+} st_sound_mixer_src_t;
+
+/** Mixer instance, allocated by the caller */
+typedef struct
+{
+    uint32_t             freq;      /* Output sampling rate */
+    uint32_t             semid;
+    st_sound_mixer_src_t src[SOUND_MIXER_MAX_SOURCES];
+    int32_t              acc_l[SOUND_MIXER_BLOCK];
+    int32_t              acc_r[SOUND_MIXER_BLOCK];
+} st_sound_mixer_t;
+
+/******************************************************************************
+Functions Prototypes
+******************************************************************************/
+
+/**
+ * @brief       Initialises a mixer with no sources.
+ *
+ * @param[out]  p_mixer: mixer instance
+ * @param[in]   freq:    output sampling rate, as set with R_SOUND_SetSamplingRate
+ *
+ * @retval  DEVDRV_SUCCESS: Successful initialisation
+ * @retval  DEVDRV_ERROR:   Failed initialisation
+ */
+extern int32_t R_SOUND_MixerInit(st_sound_mixer_t * const p_mixer, const uint32_t freq);
+
+/**
+ * @brief       Uninitialises a mixer, removing all sources.
+ *
+ * @param[in]   p_mixer: mixer instance
+ *
+ * @retval  DEVDRV_SUCCESS: Successful uninitialisation
+ * @retval  DEVDRV_ERROR:   Failed uninitialisation
+ */
+extern int32_t R_SOUND_MixerUnInit(st_sound_mixer_t * const p_mixer);
+
+/**
+ * @brief       Starts mixing a source. The filter for a source faster
+ *              than the output is designed here, so this should not be
+ *              called from the task rendering the output.
+ *
+ * @param[in]   p_mixer: mixer instance
+ * @param[in]   p_cfg:   source description, copied
+ * @param[out]  p_id:    identifier of the source
+ *
+ * @retval  DEVDRV_SUCCESS: Success
+ * @retval  DEVDRV_ERROR:   Invalid source or all sources in use
+ */
+extern int32_t R_SOUND_MixerAddSource(st_sound_mixer_t * const p_mixer,
+                                      const st_sound_mixer_src_cfg_t * const p_cfg, uint32_t * const p_id);
+
+/**
+ * @brief       Stops mixing a source. The source data is not accessed
+ *              after this returns.
+ *
+ * @param[in]   p_mixer: mixer instance
+ * @param[in]   id:      identifier from R_SOUND_MixerAddSource
+ *
+ * @retval  DEVDRV_SUCCESS: Success
+ * @retval  DEVDRV_ERROR:   Failure
+ */
+extern int32_t R_SOUND_MixerRemoveSource(st_sound_mixer_t * const p_mixer, const uint32_t id);
+
+/**
+ * @brief       Sets the volume of a source.
+ *
+ * @param[in]   p_mixer: mixer instance
+ * @param[in]   id:      identifier from R_SOUND_MixerAddSource
+ * @param[in]   vol:     volume 0(mute) - 100(unity)
+ *
+ * @retval  DEVDRV_SUCCESS: Success
+ * @retval  DEVDRV_ERROR:   Failure
+ */
+extern int32_t R_SOUND_MixerSetVolume(st_sound_mixer_t * const p_mixer, const uint32_t id, const uint32_t vol);
+
+/**
+ * @brief       Reports whether a source is still being mixed. A source
+ *              without loop stops once all of its data has been output.
+ *
+ * @param[in]   p_mixer: mixer instance
+ * @param[in]   id:      identifier from R_SOUND_MixerAddSource
+ *
+ * @retval  true:  the source is playing
+ * @retval  false: the source has finished or was removed
+ */
+extern bool_t R_SOUND_MixerIsActive(st_sound_mixer_t * const p_mixer, const uint32_t id);
+
+/**
+ * @brief       Renders interleaved 16-bit stereo at the output rate.
+ *              Silence is rendered when no source is active.
+ *
+ * @param[in]   p_mixer: mixer instance
+ * @param[out]  p_out:   frames * 2 samples
+ * @param[in]   frames:  number of frames to render
+ *
+ * @retval  DEVDRV_SUCCESS: Success
+ * @retval  DEVDRV_ERROR:   Failure
+ */
+extern int32_t R_SOUND_MixerRender(st_sound_mixer_t * const p_mixer, int16_t * const p_out, const uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SOUND_MIXER_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
@@ -0,0 +1,791 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2018 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * @file         sound_mixer.c
+ * @brief        software mixer and sample rate converter
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include <string.h>
+#include <math.h>
+
+#include "sound_mixer.h"
+#include "r_os_abstraction_api.h"
+#include "dev_drv.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define SOUND_MIXER_REQ_TMOUT_PRV_  (500u)
+
+/* position of the filter phase in the Q16 source position */
+#define SOUND_MIXER_PHASE_SHIFT_PRV_ (11u)
+
+/* source sample the output is aligned with, the filter is centred on it */
+#define SOUND_MIXER_CENTRE_PRV_     ((SOUND_MIXER_TAPS / 2u) - 1u)
+
+/* pass band edge as a fraction of the lower Nyquist frequency */
+#define SOUND_MIXER_CUTOFF_PRV_     (0.9f)
+
+#define SOUND_MIXER_PI_PRV_         (3.14159265f)
+#define SOUND_MIXER_Q15_ONE_PRV_    (32767)
+
+/* gs_coef_fixed is laid out for this filter size */
+#if (SOUND_MIXER_TAPS != 8u) || (SOUND_MIXER_PHASES != 32u)
+#error "gs_coef_fixed must be redesigned for SOUND_MIXER_TAPS and SOUND_MIXER_PHASES"
+#endif
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static void make_coefficients (st_sound_mixer_src_t * const p_src, const uint32_t out_freq);
+static void fill_history (st_sound_mixer_src_t * const p_src, const uint32_t need);
+static void convert_frames (st_sound_mixer_src_t * const p_src, const uint32_t count);
+static void mix_source (st_sound_mixer_src_t * const p_src, int32_t * const p_acc_l, int32_t * const p_acc_r,
+        const uint32_t frames);
+static void fir_block (const int16_t * const p_x, uint32_t pos, const uint32_t step, const uint32_t frames,
+        const int16_t (* const p_coef)[SOUND_MIXER_TAPS], const int32_t gain, int32_t * const p_acc_a,
+        int32_t * const p_acc_b);
+static void clip_block (const int32_t * const p_acc_l, const int32_t * const p_acc_r, int16_t * const p_out,
+        const uint32_t frames);
+static bool_t is_valid_cfg (const st_sound_mixer_src_cfg_t * const p_cfg, const uint32_t out_freq);
+
+/* Filter of a source that is not faster than the output, as designed by
+   make_coefficients with the cut off at SOUND_MIXER_CUTOFF_PRV_ */
+static const int16_t gs_coef_fixed[SOUND_MIXER_PHASES][SOUND_MIXER_TAPS] =
+{
+    {    187,  -1042,   2493,  29492,   2493,  -1042,    187,      0 },
+    {    160,   -865,   1723,  29446,   3315,  -1226,    215,      0 },
+    {    135,   -697,   1006,  29309,   4187,  -1416,    244,     -1 },
+    {    112,   -538,    344,  29082,   5105,  -1610,    274,     -1 },
+    {     91,   -390,   -263,  28767,   6067,  -1806,    304,     -2 },
+    {     72,   -252,   -813,  28364,   7069,  -2003,    335,     -4 },
+    {     55,   -126,  -1307,  27878,   8107,  -2197,    365,     -5 },
+    {     39,    -12,  -1746,  27311,   9176,  -2388,    394,     -7 },
+    {     26,     90,  -2130,  26668,  10272,  -2571,    422,     -9 },
+    {     15,    181,  -2461,  25951,  11390,  -2744,    447,    -11 },
+    {      5,    260,  -2739,  25167,  12524,  -2905,    470,    -13 },
+    {     -2,    327,  -2967,  24319,  13668,  -3051,    490,    -15 },
+    {     -9,    383,  -3147,  23414,  14817,  -3178,    505,    -17 },
+    {    -13,    429,  -3281,  22456,  15964,  -3283,    515,    -18 },
+    {    -17,    464,  -3372,  21453,  17103,  -3363,    519,    -20 },
+    {    -19,    490,  -3423,  20410,  18228,  -3415,    517,    -20 },
+    {    -20,    508,  -3436,  19333,  19333,  -3436,    508,    -20 },
+    {    -20,    517,  -3415,  18228,  20410,  -3423,    490,    -19 },
+    {    -20,    519,  -3363,  17103,  21453,  -3372,    464,    -17 },
+    {    -18,    515,  -3283,  15964,  22456,  -3281,    429,    -13 },
+    {    -17,    505,  -3178,  14817,  23414,  -3147,    383,     -9 },
+    {    -15,    490,  -3051,  13668,  24319,  -2967,    327,     -2 },
+    {    -13,    470,  -2905,  12524,  25167,  -2739,    260,      5 },
+    {    -11,    447,  -2744,  11390,  25951,  -2461,    181,     15 },
+    {     -9,    422,  -2571,  10272,  26668,  -2130,     90,     26 },
+    {     -7,    394,  -2388,   9176,  27311,  -1746,    -12,     39 },
+    {     -5,    365,  -2197,   8107,  27878,  -1307,   -126,     55 },
+    {     -4,    335,  -2003,   7069,  28364,   -813,   -252,     72 },
+    {     -2,    304,  -1806,   6067,  28767,   -263,   -390,     91 },
+    {     -1,    274,  -1610,   5105,  29082,    344,   -538,    112 },
+    {     -1,    244,  -1416,   4187,  29309,   1006,   -697,    135 },
+    {      0,    215,  -1226,   3315,  29446,   1723,   -865,    160 }
+};
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerInit
+ * @brief         Initialise a mixer.
+ *
+ *                Description:<br>
+ *
+ * @param[out]    p_mixer    :mixer instance
+ * @param[in]     freq       :output sampling rate
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerInit (st_sound_mixer_t * const p_mixer, const uint32_t freq)
+{
+    int32_t ercd = DEVDRV_SUCCESS;
+
+    if ((NULL == p_mixer) || (0u == freq))
+    {
+        ercd = DEVDRV_ERROR;
+    }
+    else
+    {
+        memset(p_mixer, 0, sizeof(st_sound_mixer_t));
+        p_mixer->freq = freq;
+
+        R_OS_CreateSemaphore( &p_mixer->semid, 1);
+
+        if (0 == p_mixer->semid)
+        {
+            ercd = DEVDRV_ERROR;
+        }
+    }
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerInit
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerUnInit
+ * @brief         Uninitialise a mixer.
+ *
+ *                Description:<br>
+ *
+ * @param[in]     p_mixer    :mixer instance
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerUnInit (st_sound_mixer_t * const p_mixer)
+{
+    int32_t ercd = DEVDRV_SUCCESS;
+
+    if ((NULL == p_mixer) || (0 == p_mixer->semid))
+    {
+        ercd = DEVDRV_ERROR;
+    }
+    else
+    {
+        if ( !R_OS_WaitForSemaphore( &p_mixer->semid, SOUND_MIXER_REQ_TMOUT_PRV_))
+        {
+            ercd = DEVDRV_ERROR;
+        }
+        else
+        {
+            R_OS_DeleteSemaphore( &p_mixer->semid);
+            memset(p_mixer, 0, sizeof(st_sound_mixer_t));
+        }
+    }
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerUnInit
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerAddSource
+ * @brief         Start mixing a source.
+ *
+ *                Description:<br>
+ *                A source faster than the output has its own filter,
+ *                designed before the mixer is locked so that rendering is
+ *                not held up by it. Other sources share gs_coef_fixed.
+ * @param[in]     p_mixer    :mixer instance
+ * @param[in]     p_cfg      :source description
+ * @param[out]    p_id       :identifier of the source
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerAddSource (st_sound_mixer_t * const p_mixer, const st_sound_mixer_src_cfg_t * const p_cfg,
+        uint32_t * const p_id)
+{
+    int32_t ercd = DEVDRV_ERROR;
+    st_sound_mixer_src_t *p_src = NULL;
+    uint32_t id;
+    int_t lock;
+
+    if ((NULL == p_mixer) || (0 == p_mixer->semid) || (NULL == p_id) || (false == is_valid_cfg(p_cfg, p_mixer->freq)))
+    {
+        return DEVDRV_ERROR;
+    }
+
+    /* reserve a free slot, the render task skips it until it is active */
+    lock = R_OS_SysLock(NULL);
+    for (id = 0u; id < SOUND_MIXER_MAX_SOURCES; id++)
+    {
+        if ((false == p_mixer->src[id].active) && (0u == p_mixer->src[id].step))
+        {
+            p_src = &p_mixer->src[id];
+            p_src->step = 1u;
+            break;
+        }
+    }
+    R_OS_SysUnlock(NULL, lock);
+
+    if (NULL != p_src)
+    {
+        p_src->cfg = *p_cfg;
+        p_src->gain = (int32_t) ((p_cfg->vol * (uint32_t) SOUND_MIXER_Q15_ONE_PRV_) / SOUND_VOL_MAX);
+        p_src->read_pos = 0u;
+        p_src->pos = 0u;
+        p_src->tail = 0u;
+        p_src->step = (uint32_t) (((uint64_t) p_cfg->freq << 16) / p_mixer->freq);
+
+        if (p_cfg->freq > p_mixer->freq)
+        {
+            make_coefficients(p_src, p_mixer->freq);
+            p_src->p_coef = p_src->coef;
+        }
+        else
+        {
+            p_src->p_coef = gs_coef_fixed;
+        }
+
+        /* start with silence ahead of the first frame so that it lands on the filter centre */
+        memset(p_src->hist_l, 0, SOUND_MIXER_CENTRE_PRV_ * sizeof(int16_t));
+        memset(p_src->hist_r, 0, SOUND_MIXER_CENTRE_PRV_ * sizeof(int16_t));
+        p_src->fill = SOUND_MIXER_CENTRE_PRV_;
+
+        if (R_OS_WaitForSemaphore( &p_mixer->semid, SOUND_MIXER_REQ_TMOUT_PRV_))
+        {
+            p_src->active = true;
+            R_OS_ReleaseSemaphore( &p_mixer->semid);
+
+            *p_id = id;
+            ercd = DEVDRV_SUCCESS;
+        }
+        else
+        {
+            p_src->step = 0u;
+        }
+    }
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerAddSource
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerRemoveSource
+ * @brief         Stop mixing a source.
+ *
+ *                Description:<br>
+ *
+ * @param[in]     p_mixer    :mixer instance
+ * @param[in]     id         :identifier of the source
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerRemoveSource (st_sound_mixer_t * const p_mixer, const uint32_t id)
+{
+    int32_t ercd = DEVDRV_SUCCESS;
+
+    if ((NULL == p_mixer) || (0 == p_mixer->semid) || (SOUND_MIXER_MAX_SOURCES <= id))
+    {
+        ercd = DEVDRV_ERROR;
+    }
+    else
+    {
+        /* waiting for the semaphore ensures a render in progress has finished with the data */
+        if ( !R_OS_WaitForSemaphore( &p_mixer->semid, SOUND_MIXER_REQ_TMOUT_PRV_))
+        {
+            ercd = DEVDRV_ERROR;
+        }
+        else
+        {
+            p_mixer->src[id].active = false;
+            p_mixer->src[id].step = 0u;
+            R_OS_ReleaseSemaphore( &p_mixer->semid);
+        }
+    }
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerRemoveSource
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerSetVolume
+ * @brief         Set the volume of a source.
+ *
+ *                Description:<br>
+ *
+ * @param[in]     p_mixer    :mixer instance
+ * @param[in]     id         :identifier of the source
+ * @param[in]     vol        :volume(0 - 100)
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerSetVolume (st_sound_mixer_t * const p_mixer, const uint32_t id, const uint32_t vol)
+{
+    int32_t ercd = DEVDRV_SUCCESS;
+
+    if ((NULL == p_mixer) || (SOUND_MIXER_MAX_SOURCES <= id) || (SOUND_VOL_MAX < vol))
+    {
+        ercd = DEVDRV_ERROR;
+    }
+    else
+    {
+        /* a single word write, picked up by the next block rendered */
+        p_mixer->src[id].cfg.vol = vol;
+        p_mixer->src[id].gain = (int32_t) ((vol * (uint32_t) SOUND_MIXER_Q15_ONE_PRV_) / SOUND_VOL_MAX);
+    }
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerSetVolume
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerIsActive
+ * @brief         Check whether a source is still being mixed.
+ *
+ *                Description:<br>
+ *
+ * @param[in]     p_mixer    :mixer instance
+ * @param[in]     id         :identifier of the source
+ * @retval        true       :playing.
+ * @retval        false      :finished or removed.
+ ******************************************************************************/
+bool_t R_SOUND_MixerIsActive (st_sound_mixer_t * const p_mixer, const uint32_t id)
+{
+    bool_t ret = false;
+
+    if ((NULL != p_mixer) && (id < SOUND_MIXER_MAX_SOURCES))
+    {
+        ret = p_mixer->src[id].active;
+    }
+
+    return ret;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerIsActive
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: R_SOUND_MixerRender
+ * @brief         Render the mix of all active sources.
+ *
+ *                Description:<br>
+ *                Output is produced in blocks of SOUND_MIXER_BLOCK frames.
+ *                Sources without loop are deactivated once their last
+ *                frame has left the filter.
+ * @param[in]     p_mixer    :mixer instance
+ * @param[out]    p_out      :interleaved 16-bit stereo output
+ * @param[in]     frames     :number of frames to render
+ * @retval        DEVDRV_SUCCESS   :Success.
+ * @retval        DEVDRV_ERROR     :Failure.
+ ******************************************************************************/
+int32_t R_SOUND_MixerRender (st_sound_mixer_t * const p_mixer, int16_t * const p_out, const uint32_t frames)
+{
+    int32_t ercd = DEVDRV_SUCCESS;
+    uint32_t done = 0u;
+    uint32_t count;
+    uint32_t id;
+
+    if ((NULL == p_mixer) || (0 == p_mixer->semid) || (NULL == p_out))
+    {
+        return DEVDRV_ERROR;
+    }
+
+    if ( !R_OS_WaitForSemaphore( &p_mixer->semid, SOUND_MIXER_REQ_TMOUT_PRV_))
+    {
+        return DEVDRV_ERROR;
+    }
+
+    while (done < frames)
+    {
+        count = frames - done;
+        if (SOUND_MIXER_BLOCK < count)
+        {
+            count = SOUND_MIXER_BLOCK;
+        }
+
+        memset(p_mixer->acc_l, 0, count * sizeof(int32_t));
+        memset(p_mixer->acc_r, 0, count * sizeof(int32_t));
+
+        for (id = 0u; id < SOUND_MIXER_MAX_SOURCES; id++)
+        {
+            if (p_mixer->src[id].active)
+            {
+                mix_source( &p_mixer->src[id], p_mixer->acc_l, p_mixer->acc_r, count);
+            }
+        }
+
+        clip_block(p_mixer->acc_l, p_mixer->acc_r, &p_out[done * 2u], count);
+        done += count;
+    }
+
+    R_OS_ReleaseSemaphore( &p_mixer->semid);
+
+    return ercd;
+}
+/*******************************************************************************
+ End of function R_SOUND_MixerRender
+ ******************************************************************************/
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: make_coefficients
+ * @brief         Design the polyphase filter of a source.
+ *
+ *                Description:<br>
+ *                Blackman windowed sinc spanning SOUND_MIXER_TAPS source
+ *                frames, for a source faster than the output. The cut off
+ *                follows the output Nyquist frequency. Each phase is
+ *                normalised to unity gain at DC.
+ * @param[in,out] p_src      :source
+ * @param[in]     out_freq   :output sampling rate
+ * @retval        none
+ ******************************************************************************/
+static void make_coefficients (st_sound_mixer_src_t * const p_src, const uint32_t out_freq)
+{
+    float h[SOUND_MIXER_TAPS];
+    const float cutoff = (SOUND_MIXER_CUTOFF_PRV_ * (float) out_freq) / (float) p_src->cfg.freq;
+    const float half = (float) (SOUND_MIXER_TAPS / 2u);
+    float sum;
+    float u;
+    float x;
+    float value;
+    uint32_t phase;
+    uint32_t tap;
+
+    for (phase = 0u; phase < SOUND_MIXER_PHASES; phase++)
+    {
+        sum = 0.0f;
+
+        for (tap = 0u; tap < SOUND_MIXER_TAPS; tap++)
+        {
+            /* distance in source frames from the output position */
+            u = ((float) tap - (float) SOUND_MIXER_CENTRE_PRV_) - ((float) phase / (float) SOUND_MIXER_PHASES);
+            x = SOUND_MIXER_PI_PRV_ * cutoff * u;
+
+            h[tap] = (fabsf(x) < 1.0e-6f) ? cutoff : ((cutoff * sinf(x)) / x);
+            h[tap] *= (0.42f + (0.5f * cosf((SOUND_MIXER_PI_PRV_ * u) / half)))
+                    + (0.08f * cosf((2.0f * SOUND_MIXER_PI_PRV_ * u) / half));
+            sum += h[tap];
+        }
+
+        for (tap = 0u; tap < SOUND_MIXER_TAPS; tap++)
+        {
+            value = floorf(((h[tap] / sum) * 32768.0f) + 0.5f);
+            if (value > (float) SOUND_MIXER_Q15_ONE_PRV_)
+            {
+                value = (float) SOUND_MIXER_Q15_ONE_PRV_;
+            }
+            p_src->coef[phase][tap] = (int16_t) value;
+        }
+    }
+}
+/*******************************************************************************
+ End of function make_coefficients
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: fill_history
+ * @brief         Convert source frames until the filter has enough input.
+ *
+ *                Description:<br>
+ *                Looping sources wrap to the first frame, others are
+ *                followed by silence.
+ * @param[in,out] p_src      :source
+ * @param[in]     need       :frames required in the history
+ * @retval        none
+ ******************************************************************************/
+static void fill_history (st_sound_mixer_src_t * const p_src, const uint32_t need)
+{
+    uint32_t count;
+
+    while (p_src->fill < need)
+    {
+        count = need - p_src->fill;
+
+        if (p_src->read_pos < p_src->cfg.frames)
+        {
+            if (count > (p_src->cfg.frames - p_src->read_pos))
+            {
+                count = p_src->cfg.frames - p_src->read_pos;
+            }
+            convert_frames(p_src, count);
+        }
+        else if (p_src->cfg.loop)
+        {
+            p_src->read_pos = 0u;
+        }
+        else
+        {
+            memset( &p_src->hist_l[p_src->fill], 0, count * sizeof(int16_t));
+            memset( &p_src->hist_r[p_src->fill], 0, count * sizeof(int16_t));
+            p_src->fill += count;
+            p_src->tail += count;
+        }
+    }
+}
+/*******************************************************************************
+ End of function fill_history
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: convert_frames
+ * @brief         Convert source frames to 16-bit planar history.
+ *
+ *                Description:<br>
+ *                Mono sources are only written to hist_l.
+ * @param[in,out] p_src      :source
+ * @param[in]     count      :frames to convert
+ * @retval        none
+ ******************************************************************************/
+static void convert_frames (st_sound_mixer_src_t * const p_src, const uint32_t count)
+{
+    const uint32_t channels = p_src->cfg.channels;
+    int16_t * const p_l = &p_src->hist_l[p_src->fill];
+    int16_t * const p_r = (2u == channels) ? &p_src->hist_r[p_src->fill] : p_l;
+    uint32_t i;
+
+    switch (p_src->cfg.fmt)
+    {
+        case SOUND_MIXER_FMT_U8:
+        {
+            const uint8_t *p_in = (const uint8_t *) p_src->cfg.p_data + (p_src->read_pos * channels);
+
+            for (i = 0u; i < count; i++)
+            {
+                p_l[i] = (int16_t) (((int32_t) p_in[0] - 128) << 8);
+                p_r[i] = (int16_t) (((int32_t) p_in[channels - 1u] - 128) << 8);
+                p_in += channels;
+            }
+        }
+        break;
+
+        case SOUND_MIXER_FMT_S16:
+        {
+            const int16_t *p_in = (const int16_t *) p_src->cfg.p_data + (p_src->read_pos * channels);
+
+            for (i = 0u; i < count; i++)
+            {
+                p_l[i] = p_in[0];
+                p_r[i] = p_in[channels - 1u];
+                p_in += channels;
+            }
+        }
+        break;
+
+        case SOUND_MIXER_FMT_S24:
+        default:
+        {
+            /* keep the upper 16 bits of each little endian 24-bit sample */
+            const uint8_t *p_in = (const uint8_t *) p_src->cfg.p_data + (p_src->read_pos * channels * 3u);
+            const uint32_t right = (channels - 1u) * 3u;
+
+            for (i = 0u; i < count; i++)
+            {
+                p_l[i] = (int16_t) (uint16_t) (p_in[1] | ((uint32_t) p_in[2] << 8));
+                p_r[i] = (int16_t) (uint16_t) (p_in[right + 1u] | ((uint32_t) p_in[right + 2u] << 8));
+                p_in += channels * 3u;
+            }
+        }
+        break;
+    }
+
+    p_src->read_pos += count;
+    p_src->fill += count;
+}
+/*******************************************************************************
+ End of function convert_frames
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: mix_source
+ * @brief         Resample a block of a source into the accumulators.
+ *
+ *                Description:<br>
+ *                Consumed history is moved down once the block is done.
+ * @param[in,out] p_src      :source
+ * @param[in,out] p_acc_l    :left accumulator
+ * @param[in,out] p_acc_r    :right accumulator
+ * @param[in]     frames     :output frames, at most SOUND_MIXER_BLOCK
+ * @retval        none
+ ******************************************************************************/
+static void mix_source (st_sound_mixer_src_t * const p_src, int32_t * const p_acc_l, int32_t * const p_acc_r,
+        const uint32_t frames)
+{
+    const int32_t gain = p_src->gain;
+    uint32_t consumed;
+
+    /* the last output of the block reads SOUND_MIXER_TAPS frames from its integer position */
+    fill_history(p_src, ((p_src->pos + (p_src->step * (frames - 1u))) >> 16) + SOUND_MIXER_TAPS);
+
+    if (2u == p_src->cfg.channels)
+    {
+        fir_block(p_src->hist_l, p_src->pos, p_src->step, frames, p_src->p_coef, gain, p_acc_l, NULL);
+        fir_block(p_src->hist_r, p_src->pos, p_src->step, frames, p_src->p_coef, gain, p_acc_r, NULL);
+    }
+    else
+    {
+        fir_block(p_src->hist_l, p_src->pos, p_src->step, frames, p_src->p_coef, gain, p_acc_l, p_acc_r);
+    }
+
+    p_src->pos += p_src->step * frames;
+    consumed = p_src->pos >> 16;
+    p_src->pos &= 0xFFFFu;
+
+    p_src->fill -= consumed;
+    memmove(p_src->hist_l, &p_src->hist_l[consumed], p_src->fill * sizeof(int16_t));
+    memmove(p_src->hist_r, &p_src->hist_r[consumed], p_src->fill * sizeof(int16_t));
+
+    /* silence is only ever appended, so once it fills the history the data has been played */
+    if ((p_src->tail > 0u) && (p_src->tail >= p_src->fill))
+    {
+        p_src->active = false;
+        p_src->step = 0u;
+    }
+}
+/*******************************************************************************
+ End of function mix_source
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: fir_block
+ * @brief         Polyphase filter a block of one channel.
+ *
+ *                Description:<br>
+ *                Output k is the dot product of SOUND_MIXER_TAPS frames
+ *                from p_x[pos >> 16] with the phase selected by the
+ *                fraction of pos, scaled by gain and added to the
+ *                accumulators.
+ * @param[in]     p_x        :16-bit history
+ * @param[in]     pos        :Q16 position of the first output
+ * @param[in]     step       :Q16 increment per output
+ * @param[in]     frames     :number of outputs
+ * @param[in]     p_coef     :polyphase coefficients, Q15
+ * @param[in]     gain       :Q15 gain
+ * @param[in,out] p_acc_a    :accumulator
+ * @param[in,out] p_acc_b    :second accumulator for mono sources, or NULL
+ * @retval        none
+ ******************************************************************************/
+static void fir_block (const int16_t * const p_x, uint32_t pos, const uint32_t step, const uint32_t frames,
+        const int16_t (* const p_coef)[SOUND_MIXER_TAPS], const int32_t gain, int32_t * const p_acc_a,
+        int32_t * const p_acc_b)
+{
+    const int16_t *p_in;
+    const int16_t *p_c;
+    int32_t sum;
+    int32_t sample;
+    uint32_t tap;
+    uint32_t k;
+
+    for (k = 0u; k < frames; k++)
+    {
+        p_in = &p_x[pos >> 16];
+        p_c = p_coef[(pos >> SOUND_MIXER_PHASE_SHIFT_PRV_) & (SOUND_MIXER_PHASES - 1u)];
+
+        sum = 0;
+        for (tap = 0u; tap < SOUND_MIXER_TAPS; tap++)
+        {
+            sum += (int32_t) p_in[tap] * (int32_t) p_c[tap];
+        }
+
+        sample = ((sum >> 15) * gain) >> 15;
+
+        p_acc_a[k] += sample;
+        if (NULL != p_acc_b)
+        {
+            p_acc_b[k] += sample;
+        }
+
+        pos += step;
+    }
+}
+/*******************************************************************************
+ End of function fir_block
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: clip_block
+ * @brief         Saturate and interleave the accumulators.
+ *
+ *                Description:<br>
+ *
+ * @param[in]     p_acc_l    :left accumulator
+ * @param[in]     p_acc_r    :right accumulator
+ * @param[out]    p_out      :interleaved 16-bit stereo
+ * @param[in]     frames     :number of frames
+ * @retval        none
+ ******************************************************************************/
+static void clip_block (const int32_t * const p_acc_l, const int32_t * const p_acc_r, int16_t * const p_out,
+        const uint32_t frames)
+{
+    uint32_t k;
+    int32_t l;
+    int32_t r;
+
+    for (k = 0u; k < frames; k++)
+    {
+        l = p_acc_l[k];
+        r = p_acc_r[k];
+        l = (l > 32767) ? 32767 : ((l < -32768) ? -32768 : l);
+        r = (r > 32767) ? 32767 : ((r < -32768) ? -32768 : r);
+        p_out[k * 2u] = (int16_t) l;
+        p_out[(k * 2u) + 1u] = (int16_t) r;
+    }
+}
+/*******************************************************************************
+ End of function clip_block
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name: is_valid_cfg
+ * @brief         Check a source description.
+ *
+ *                Description:<br>
+ *                If value is valid then return true.
+ * @param[in]     p_cfg      :source description
+ * @param[in]     out_freq   :output sampling rate
+ * @retval        true       :valid.
+ * @retval        false      :invalid.
+ ******************************************************************************/
+static bool_t is_valid_cfg (const st_sound_mixer_src_cfg_t * const p_cfg, const uint32_t out_freq)
+{
+    bool_t ret = true;
+
+    if ((NULL == p_cfg) || (NULL == p_cfg->p_data) || (0u == p_cfg->frames) || (0u == p_cfg->freq))
+    {
+        ret = false;
+    }
+    else if ((1u != p_cfg->channels) && (2u != p_cfg->channels))
+    {
+        ret = false;
+    }
+    else if ((SOUND_MIXER_FMT_U8 != p_cfg->fmt) && (SOUND_MIXER_FMT_S16 != p_cfg->fmt)
+            && (SOUND_MIXER_FMT_S24 != p_cfg->fmt))
+    {
+        ret = false;
+    }
+    else if ((SOUND_VOL_MAX < p_cfg->vol) || ((out_freq * SOUND_MIXER_MAX_RATIO) < p_cfg->freq))
+    {
+        /* the history holds at most SOUND_MIXER_MAX_RATIO source frames per output frame */
+        ret = false;
+    }
+    else
+    {
+        ; /* valid */
+    }
+
+    return (ret);
+}
+/*******************************************************************************
+ End of function is_valid_cfg
+ ******************************************************************************/
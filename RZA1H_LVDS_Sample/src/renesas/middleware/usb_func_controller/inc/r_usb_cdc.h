@@ -130,6 +130,10 @@ usb_err_t R_USB_CdcWrite(volatile st_usb_object_t *_pchannel, uint32_t _num_byte
 
 /**
  * @brief               Start an asynchronous write. (BULK IN)
+ *                      If a write is in progress the request is queued
+ *                      (up to USB_CDC_WRITE_QUEUE_SIZE) and started when
+ *                      the one before it completes. The buffer must not
+ *                      be changed until the callback has been called.
  * 
  * @param[in]          _num_bytes: Number of bytes to write.
  * @param[in]          _pbuffer:   Data Buffer.
@@ -164,6 +168,33 @@ usb_err_t R_USB_CdcRead(volatile st_usb_object_t *_pchannel, uint32_t _pbufferSi
 */
 usb_err_t R_USB_CdcReadAsync(volatile st_usb_object_t *_pchannel, uint32_t _pbufferSize, uint8_t* _pbuffer, CB_DONE_OUT _cb);
 
+/**
+ * @brief              Keep a BULK OUT transfer armed and collect the
+ *                     received data in a ring. The host is NAKed while
+ *                     the ring is full. The ring is released by
+ *                     R_USB_CdcCancel.
+ *
+ * @param[in]          _pring:      Ring buffer.
+ * @param[in]          _ring_size:  Size of the ring, must be a power of 2.
+ * @param[in]          _cb:         Called from the interrupt when data has
+ *                                  been put in the ring or the ring has
+ *                                  stopped, may be NULL.
+ *
+ * @retval             USB_ER_CODE: Error code.
+*/
+usb_err_t R_USB_CdcStartReceive(volatile st_usb_object_t *_pchannel, uint8_t* _pring, uint32_t _ring_size, CB_DONE _cb);
+
+/**
+ * @brief              Take data from the receive ring without blocking.
+ *
+ * @param[in]          _pbufferSize:    Buffer Size
+ * @param[out]         _pbuffer:        Buffer to read data into.
+ * @param[out]         _pNumBytesRead:  Number of bytes read, may be 0.
+ *
+ * @retval             USB_ER_CODE: Error code.
+*/
+usb_err_t R_USB_CdcReadRing(volatile st_usb_object_t *_pchannel, uint32_t _pbufferSize, uint8_t* _pbuffer, uint32_t* _pNumBytesRead);
+
 /**
  * @brief              Cancel waiting on any blocking functions. 
  * 
@@ -178,7 +178,8 @@ typedef void(*CB_REPORT_OUT)(uint8_t(*)[]);
 typedef enum
 {
     USBF_NORMAL = 0,
-    USBF_ASYNC
+    USBF_ASYNC,
+    USBF_STREAM
 } cdc_rw_mode_t;
 
 typedef struct
@@ -269,6 +270,13 @@ typedef struct
     uint8_t b_data_bits;
 }SET_CONTROL_LINE_STATE_DATA;
 
+/* Number of asynchronous BULK IN writes that can wait behind the active one */
+#define USB_CDC_WRITE_QUEUE_SIZE    (8)
+
+/* Size of the transfer kept armed on BULK OUT while a receive ring is in use
+   (four high speed bulk packets) */
+#define USB_CDC_RX_STAGE_SIZE       (2048)
+
 /*Structure for BULK OUT*/
 typedef struct
 {
@@ -283,8 +291,33 @@ typedef struct
 
     /*Callback done*/
     CB_DONE_OUT m_cb_done;
+
+    /*Receive ring set by R_USB_CdcStartReceive*/
+    uint8_t *m_pring;
+    uint32_t m_ring_size;
+    volatile uint32_t m_ring_in;
+    volatile uint32_t m_ring_out;
+
+    /*Called when data has gone into the ring or the ring has stopped*/
+    CB_DONE m_cb_ring;
+
+    /*TRUE while a transfer into m_stage is armed on the pipe*/
+    volatile BOOL m_ring_armed;
+
+    /*Received data that did not fit in the ring yet*/
+    uint32_t m_stage_count;
+    uint32_t m_stage_pos;
+    uint32_t m_stage[USB_CDC_RX_STAGE_SIZE / sizeof(uint32_t)];
 }BULK_OUT;
 
+/*Asynchronous BULK IN write waiting for the pipe*/
+typedef struct
+{
+    uint32_t m_num_bytes;
+    uint8_t  *m_pbuffer;
+    CB_DONE  m_cb_done;
+}BULK_IN_REQUEST;
+
 /*Structure for BULK IN*/
 typedef struct
 {
@@ -296,6 +329,14 @@ typedef struct
 
     /*Callback done*/
     CB_DONE m_cb_done;
+
+    /*Writes queued by R_USB_CdcWriteAsync while the pipe is busy*/
+    BULK_IN_REQUEST m_queue[USB_CDC_WRITE_QUEUE_SIZE];
+    volatile uint32_t m_queue_in;
+    volatile uint32_t m_queue_out;
+
+    /*Set while the queue is being drained to stop re-entry from the callback*/
+    BOOL m_queue_starting;
 }BULK_IN;
 
 typedef struct
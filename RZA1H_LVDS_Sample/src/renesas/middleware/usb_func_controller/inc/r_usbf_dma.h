@@ -0,0 +1,62 @@
+/******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized.
+* This software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES
+* REGARDING THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY,
+* INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+* PARTICULAR PURPOSE AND NON-INFRINGEMENT.  ALL SUCH WARRANTIES ARE EXPRESSLY
+* DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+* FOR ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS
+* AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this
+* software and to discontinue the availability of this software.
+* By using this software, you agree to the additional terms and
+* conditions found by accessing the following link:
+* http://www.renesas.com/disclaimer
+******************************************************************************/
+/* Copyright (C) 2016 Renesas Electronics Corporation. All rights reserved.*/
+/******************************************************************************
+* File Name       : r_usbf_dma.h
+* Version         : 1.00
+* Device          : RZA1(H)
+* Tool Chain      :
+* H/W Platform    : RSK2+RZA1H
+* Description     : DMA transfers on the D1FIFO port for the bulk pipes
+******************************************************************************/
+/******************************************************************************
+* History         : 17.10.2026 Ver. 1.00 First Release
+******************************************************************************/
+/******************************************************************************
+User Includes (Project Level Includes)
+******************************************************************************/
+/* Following header file provides rte type definitions. */
+#include "stdint.h"
+/* Following header file provides common defines for widely used items. */
+#include "usb_common.h"
+#include "r_usbf_core.h"
+
+#ifndef R_USBF_DMA_H_INCLUDED
+#define R_USBF_DMA_H_INCLUDED
+
+/******************************************************************************
+Macro Definitions
+******************************************************************************/
+/* Transfers shorter than this are quicker by the CPU */
+#define USBF_DMA_THRESHOLD      (64u)
+
+/******************************************************************************
+Function Prototypes for function mode
+******************************************************************************/
+extern usb_err_t       R_USBF_DmaOpen(volatile st_usb_object_t *_pchannel);
+extern void            R_USBF_DmaClose(volatile st_usb_object_t *_pchannel);
+extern void            R_USBF_DmaStop(volatile st_usb_object_t *_pchannel);
+extern BOOL            R_USBF_DmaBulkIn(volatile st_usb_object_t *_pchannel);
+extern BOOL            R_USBF_DmaBulkOut(volatile st_usb_object_t *_pchannel);
+
+#endif        /* R_USBF_DMA_H_INCLUDED*/
@@ -81,6 +81,12 @@
 /* USB Function driver must have higher priority than timer for enumerator */
 #define USBF_CDC_INTERRUPT_PRIORITY (configMAX_API_CALL_INTERRUPT_PRIORITY + 1)
 
+/* Size of the receive ring used in USBF_STREAM mode, must be a power of 2 */
+#define USBF_CDC_RX_RING_SIZE (8192)
+
+/* Longest wait in USBF_STREAM mode before the state is checked again */
+#define USBF_CDC_STREAM_WAIT_MS (100)
+
 /* The root port control functions */
 #define GPIO_BIT_N1  (1u <<  1)
 
@@ -102,6 +108,14 @@ static int_t           ref_count = 0;
 /* configuration used buy the driver*/
 static st_usbf_user_configuration_t config = {};
 
+/* receive ring used in USBF_STREAM mode */
+static uint8_t rx_ring[USBF_CDC_RX_RING_SIZE];
+
+/* released from the interrupt in USBF_STREAM mode when the ring has data
+   and when a write has completed */
+static uint32_t rx_event = 0;
+static uint32_t tx_event = 0;
+
 /******************************************************************************
  Constant Data
  ******************************************************************************/
@@ -165,6 +179,12 @@ Return value:   -
 *******************************************************************************/
 static void ch0_writecb(usb_err_t _err)
 {
+    if(USBF_STREAM == channel.rw_config.mode)
+    {
+        /* There is room in the write queue */
+        R_OS_ReleaseSemaphore(&tx_event);
+    }
+
     if(NULL != channel.rw_config.pin_done_async)
     {
         channel.rw_config.pin_done_async(_err);
@@ -178,6 +198,23 @@ static void ch0_writecb(usb_err_t _err)
 End of function ch0_writecb
 *******************************************************************************/
 
+/******************************************************************************
+Function Name : ch0_ringcb
+Description   : Callback called when data has been put in the receive ring
+                or the ring has stopped.
+Parameters:     _err: Error code.
+Return value:   -
+*******************************************************************************/
+static void ch0_ringcb(usb_err_t _err)
+{
+    (void) _err;
+
+    R_OS_ReleaseSemaphore(&rx_event);
+}
+/*******************************************************************************
+End of function ch0_ringcb
+*******************************************************************************/
+
 /*******************************************************************************
 * Function Name: start_device
 * Description  : Initialises the HID device with specified configuration
@@ -275,6 +312,18 @@ static int_t usbf_cdc_open (st_stream_ptr_t pStream)
     {
         if(0 == ref_count )
         {
+            if(!R_OS_CreateSemaphore(&rx_event, 0))
+            {
+                eventReset(g_usb_devices_events[0]);
+                return -1;
+            }
+            if(!R_OS_CreateSemaphore(&tx_event, 0))
+            {
+                R_OS_DeleteSemaphore(&rx_event);
+                eventReset(g_usb_devices_events[0]);
+                return -1;
+            }
+
             ref_count++;
 
             memset(&config,0,sizeof(config));
@@ -324,6 +373,8 @@ static void usbf_cdc_close (st_stream_ptr_t pStream)
         memset(&config,0,sizeof(config));
         memset((st_usb_object_t *)&channel,0,sizeof(channel));
 
+        R_OS_DeleteSemaphore(&tx_event);
+        R_OS_DeleteSemaphore(&rx_event);
     }
 }
 /******************************************************************************
@@ -368,6 +419,23 @@ static int_t usbf_cdc_read (st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32_
                 }
             }
             break;
+            case USBF_STREAM:
+            {
+                uint32_t sizein = 0;
+
+                /* Return what the ring holds, wait only when it is empty.
+                   ch0_ringcb releases rx_event as data arrives */
+                while(USB_ERR_OK == R_USB_CdcReadRing(&channel, uiCount, pbyBuffer, &sizein))
+                {
+                    if(sizein)
+                    {
+                        ret = (int_t) sizein;
+                        break;
+                    }
+                    R_OS_WaitForSemaphore(&rx_event, USBF_CDC_STREAM_WAIT_MS);
+                }
+            }
+            break;
             default:
             {
                 ret = -1;
@@ -410,6 +478,19 @@ static int_t usbf_cdc_write (st_stream_ptr_t pStream, uint8_t *pbyBuffer, uint32
                 ret = R_USB_CdcWrite(&channel, uiCount, pbyBuffer);
             }
             break;
+            case USBF_STREAM:
+            {
+                /* The buffer is queued not copied, pin_done_async reports
+                   when it can be re-used. Wait only when the queue is full,
+                   ch0_writecb releases tx_event as each write completes */
+                ret = R_USB_CdcWriteAsync(&channel, uiCount, pbyBuffer, ch0_writecb);
+                while(USB_ERR_BUSY == ret)
+                {
+                    R_OS_WaitForSemaphore(&tx_event, USBF_CDC_STREAM_WAIT_MS);
+                    ret = R_USB_CdcWriteAsync(&channel, uiCount, pbyBuffer, ch0_writecb);
+                }
+            }
+            break;
             default:
             {
                 ret = -1;
@@ -458,6 +539,17 @@ static int_t usbf_cdc_control (st_stream_ptr_t pStream, uint32_t ctlCode, void *
                         channel.rw_config.pout_done_async = ((st_usbf_asyn_config_t *)pCtlStruct)->pout_done_async;
                     }
                     break;
+                    case USBF_STREAM:
+                    {
+                        channel.rw_config.mode = USBF_STREAM;
+                        channel.rw_config.pin_done_async = ((st_usbf_asyn_config_t *)pCtlStruct)->pin_done_async;
+                        channel.rw_config.pout_done_async = NULL;
+                        if(USB_ERR_OK != R_USB_CdcStartReceive(&channel, rx_ring, sizeof(rx_ring), ch0_ringcb))
+                        {
+                            ret = -1;
+                        }
+                    }
+                    break;
                     case USBF_NORMAL:
                     {
                         channel.rw_config.mode = USBF_NORMAL;
@@ -99,7 +99,7 @@ static volatile uint16_t  end_ptbl_1[] =
                                                               be used to read from the FIFO buffer
                                                               memory and write data to the FIFO
                                                               buffer memory */
-    ((((BULK | DBLBOFF) | CNTMDON) | DIR_P_OUT) | EP1),    /* Pipe Configuration Register (0x68)  */
+    ((((BULK | DBLBON) | CNTMDON) | DIR_P_OUT) | EP1),     /* Pipe Configuration Register (0x68)  */
     BUF_SIZE(BULK_OUT_PACKET_SIZE) | 16,                   /* Pipe Buffer setting Register (0x6A) */
     BULK_OUT_PACKET_SIZE,                                  /* Pipe Maxpacket Size Register (0x6C) */
     0,                                                     /* Pipe Cycle Control Register (0x6E)  */
@@ -199,6 +199,10 @@ static usb_err_t cb_unhandled_setup_packet(volatile st_usb_object_t *_pchannel,
 static void cb_done_control_out(volatile st_usb_object_t *_pchannel, usb_err_t _err, uint32_t _num_bytes);
 static void cb_done_bulk_out(volatile st_usb_object_t *_pchannel,usb_err_t _err, uint32_t _num_bytes);
 static void cb_done_bulk_in(volatile st_usb_object_t *_pchannel, usb_err_t _err);
+static void cb_done_ring_out(volatile st_usb_object_t *_pchannel, usb_err_t _err, uint32_t _num_bytes);
+static void start_queued_write(volatile st_usb_object_t *_pchannel);
+static void fill_receive_ring(volatile st_usb_object_t *_pchannel);
+static void arm_receive_ring(volatile st_usb_object_t *_pchannel);
 
 static void cb_error(volatile st_usb_object_t * _pchannel, usb_err_t _err);
 
@@ -368,40 +372,52 @@ End of function R_USB_CdcWrite
 /******************************************************************************
 * Function Name   :   R_USB_CdcWriteAsync
 * Description     :   Start an asynchronous write. (BULK IN)
+*                     If a write is already in progress the request is
+*                     queued and started from the completion of the one
+*                     before it. The buffer must not be changed until the
+*                     callback has been called.
 * Argument        :   _num_bytes:     Number of bytes to write.
 *                     _pbuffer:    Data Buffer.
 *                     _cb:         Callback when done.
-* Return value    :   Error Code.
+* Return value    :   Error Code. USB_ERR_BUSY if the queue is full.
 *****************************************************************************/
 usb_err_t R_USB_CdcWriteAsync(volatile st_usb_object_t *_pchannel, uint32_t _num_bytes, uint8_t* _pbuffer, CB_DONE _cb)
 {
-    _pchannel->err = USB_ERR_OK;
-    
+    volatile BULK_IN_REQUEST *prequest;
+    usb_err_t err = USB_ERR_OK;
+    int_t lock;
+
     /*This can not complete until connected*/
     if(TRUE == _pchannel->connected)
     {
-        /*Check not already busy*/
-        if(FALSE == _pchannel->bulk_in.m_busy)
+        lock = R_OS_SysLock(NULL);
+
+        /*Check there is room in the queue*/
+        if((_pchannel->bulk_in.m_queue_in - _pchannel->bulk_in.m_queue_out) < USB_CDC_WRITE_QUEUE_SIZE)
         {
-            /*Set Flag to wait on*/
-            _pchannel->bulk_in.m_busy = TRUE;
-            _pchannel->bulk_in.m_cb_done = _cb;
-            _pchannel->err = R_USB_HalBulkIn(_pchannel, _num_bytes, _pbuffer, (CB_DONE_BULK_IN)cb_done_bulk_in);
-            if(USB_ERR_OK != _pchannel->err)
-            {
-                _pchannel->bulk_in.m_busy = FALSE;
-            }
+            prequest = &_pchannel->bulk_in.m_queue[_pchannel->bulk_in.m_queue_in % USB_CDC_WRITE_QUEUE_SIZE];
+            prequest->m_num_bytes = _num_bytes;
+            prequest->m_pbuffer = _pbuffer;
+            prequest->m_cb_done = _cb;
+            _pchannel->bulk_in.m_queue_in++;
+
+            /*Start it now if the pipe is free*/
+            start_queued_write(_pchannel);
         }
         else
         {
-            _pchannel->err = USB_ERR_BUSY;
+            err = USB_ERR_BUSY;
         }
+
+        R_OS_SysUnlock(NULL, lock);
     }
     else
     {
-        _pchannel->err = USB_ERR_NOT_CONNECTED;
+        err = USB_ERR_NOT_CONNECTED;
     }
-    
+
+    _pchannel->err = err;
+
     return _pchannel->err;
 }
 /*****************************************************************************
@@ -517,6 +533,128 @@ usb_err_t R_USB_CdcReadAsync(volatile st_usb_object_t *_pchannel, uint32_t _pbuf
 End of function R_USB_CdcReadAsync
 ******************************************************************************/   
 
+/*****************************************************************************
+* Function Name   :   R_USB_CdcStartReceive
+* Description     :   Keep a BULK OUT transfer armed and collect the data
+*                     in a receive ring. When the ring is full the pipe is
+*                     left un-armed so the host is NAKed until
+*                     R_USB_CdcReadRing makes room.
+*                     While the ring is in use R_USB_CdcRead and
+*                     R_USB_CdcReadAsync return USB_ERR_BUSY. The ring is
+*                     released by R_USB_CdcCancel.
+* Argument        :   _pring:      Ring buffer.
+*                     _ring_size:  Size of the ring, must be a power of 2.
+*                     _cb:         Called when data has been put in the
+*                                  ring or the ring has stopped.
+* Return value    :   Error Code.
+*****************************************************************************/
+usb_err_t R_USB_CdcStartReceive(volatile st_usb_object_t *_pchannel, uint8_t* _pring, uint32_t _ring_size, CB_DONE _cb)
+{
+    usb_err_t err = USB_ERR_OK;
+    int_t lock;
+
+    if((NULL == _pring) || (0 == _ring_size) || (0 != (_ring_size & (_ring_size - 1))))
+    {
+        err = USB_ERR_PARAM;
+    }
+    else
+    {
+        lock = R_OS_SysLock(NULL);
+
+        /*Check a read is not already using the pipe*/
+        if((TRUE == _pchannel->bulk_out.m_busy) && (NULL == _pchannel->bulk_out.m_pring))
+        {
+            err = USB_ERR_BUSY;
+        }
+        else
+        {
+            _pchannel->bulk_out.m_pring = _pring;
+            _pchannel->bulk_out.m_ring_size = _ring_size;
+            _pchannel->bulk_out.m_ring_in = 0;
+            _pchannel->bulk_out.m_ring_out = 0;
+            _pchannel->bulk_out.m_cb_ring = _cb;
+            _pchannel->bulk_out.m_busy = TRUE;
+
+            /*Arm the pipe now if the host has configured us*/
+            arm_receive_ring(_pchannel);
+        }
+
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    _pchannel->err = err;
+
+    return _pchannel->err;
+}
+/******************************************************************************
+End of function R_USB_CdcStartReceive
+******************************************************************************/
+
+/*****************************************************************************
+* Function Name   :   R_USB_CdcReadRing
+* Description     :   Take data from the receive ring without blocking.
+*                     Re-arms the pipe if it was waiting for room.
+* Argument        :   _pbufferSize:     Buffer Size
+*                     _pbuffer:         Buffer to read data into.
+*                     _pNumBytesRead:   (OUT)Number of bytes read.
+* Return value    :   Error Code.
+*****************************************************************************/
+usb_err_t R_USB_CdcReadRing(volatile st_usb_object_t *_pchannel, uint32_t _pbufferSize, uint8_t* _pbuffer, uint32_t* _pNumBytesRead)
+{
+    usb_err_t err = USB_ERR_OK;
+    uint32_t count = 0;
+    uint32_t ring_in;
+    uint32_t pos;
+    uint32_t chunk;
+    int_t lock;
+
+    if(NULL == _pchannel->bulk_out.m_pring)
+    {
+        err = USB_ERR_STATE;
+    }
+    else
+    {
+        /*Only the interrupt moves m_ring_in so the data up to it can be
+          copied out without holding the lock*/
+        ring_in = _pchannel->bulk_out.m_ring_in;
+        while((count < _pbufferSize) && (ring_in != _pchannel->bulk_out.m_ring_out))
+        {
+            pos = _pchannel->bulk_out.m_ring_out & (_pchannel->bulk_out.m_ring_size - 1);
+            chunk = ring_in - _pchannel->bulk_out.m_ring_out;
+            if(chunk > (_pchannel->bulk_out.m_ring_size - pos))
+            {
+                chunk = _pchannel->bulk_out.m_ring_size - pos;
+            }
+            if(chunk > (_pbufferSize - count))
+            {
+                chunk = _pbufferSize - count;
+            }
+            memcpy(_pbuffer + count, _pchannel->bulk_out.m_pring + pos, chunk);
+            _pchannel->bulk_out.m_ring_out += chunk;
+            count += chunk;
+        }
+
+        /*Move anything held back in the stage buffer and re-arm*/
+        lock = R_OS_SysLock(NULL);
+        fill_receive_ring(_pchannel);
+        arm_receive_ring(_pchannel);
+        R_OS_SysUnlock(NULL, lock);
+
+        if((0 == count) && (TRUE != _pchannel->connected))
+        {
+            err = USB_ERR_NOT_CONNECTED;
+        }
+    }
+
+    *_pNumBytesRead = count;
+    _pchannel->err = err;
+
+    return _pchannel->err;
+}
+/******************************************************************************
+End of function R_USB_CdcReadRing
+******************************************************************************/
+
 /******************************************************************************
 * Function Name   :    R_USB_CdcCancel
 * Description     :    Cancel waiting on any blocking functions.
@@ -524,13 +662,24 @@ End of function R_USB_CdcReadAsync
 ******************************************************************************/
 usb_err_t R_USB_CdcCancel(volatile st_usb_object_t * _pchannel)
 {
+    int_t lock;
+
     _pchannel->err = USB_ERR_OK;
     
+    /*The ring completion interrupt reads the ring and re-arms the pipe*/
+    lock = R_OS_SysLock(NULL);
+
     release_flags(_pchannel, USB_ERR_CANCEL);
+
+    /*The pipe is reset so the receive ring is no longer fed*/
+    _pchannel->bulk_out.m_pring = NULL;
+    _pchannel->bulk_out.m_cb_ring = NULL;
     
     /*Reset HAL*/
     _pchannel->err = R_USB_HalReset(_pchannel);
     
+    R_OS_SysUnlock(NULL, lock);
+
     return _pchannel->err;
 }
 /******************************************************************************
@@ -686,11 +835,176 @@ static void cb_done_bulk_in(volatile st_usb_object_t *_pchannel, usb_err_t _err)
     {
         _pchannel->bulk_in.m_cb_done(_err);
     }
+
+    /*Start the next queued write*/
+    start_queued_write(_pchannel);
 }
 /******************************************************************************
 End of function cb_done_bulk_in
 ******************************************************************************/   
 
+/*****************************************************************************
+* Function Name   :   cb_done_ring_out
+* Description     :   The BULK OUT transfer armed for the receive ring has
+*                     completed. Move the data into the ring and re-arm.
+* Argument        :   _err - Error code.
+*                     _num_bytes - The number of bytes received from the host.
+* Return value    :   -
+*****************************************************************************/
+static void cb_done_ring_out(volatile st_usb_object_t *_pchannel, usb_err_t _err, uint32_t _num_bytes)
+{
+    _pchannel->bulk_out.m_ring_armed = FALSE;
+    _pchannel->bulk_out.m_err = _err;
+
+    if(USB_ERR_OK == _err)
+    {
+        _pchannel->bulk_out.m_stage_count = _num_bytes;
+        _pchannel->bulk_out.m_stage_pos = 0;
+        fill_receive_ring(_pchannel);
+    }
+
+    /*Re-arm unless the ring is full, R_USB_CdcReadRing re-arms when
+      there is room*/
+    arm_receive_ring(_pchannel);
+
+    /*Wake the reader*/
+    if(NULL != _pchannel->bulk_out.m_cb_ring)
+    {
+        _pchannel->bulk_out.m_cb_ring(_err);
+    }
+}
+/******************************************************************************
+End of function cb_done_ring_out
+******************************************************************************/
+
+/*****************************************************************************
+* Function Name   :   start_queued_write
+* Description     :   Start queued BULK IN writes while the pipe is free.
+*                     Must be called from the interrupt or with the system
+*                     locked.
+* Argument        :   -
+* Return value    :   -
+*****************************************************************************/
+static void start_queued_write(volatile st_usb_object_t *_pchannel)
+{
+    volatile BULK_IN_REQUEST *prequest;
+    uint32_t num_bytes;
+    uint8_t *pbuffer;
+    usb_err_t err;
+
+    /*A short write completes inside R_USB_HalBulkIn and calls back into
+      here, the loop below starts the next one*/
+    if(TRUE == _pchannel->bulk_in.m_queue_starting)
+    {
+        return;
+    }
+    _pchannel->bulk_in.m_queue_starting = TRUE;
+
+    while((FALSE == _pchannel->bulk_in.m_busy)
+       && (_pchannel->bulk_in.m_queue_out != _pchannel->bulk_in.m_queue_in))
+    {
+        prequest = &_pchannel->bulk_in.m_queue[_pchannel->bulk_in.m_queue_out % USB_CDC_WRITE_QUEUE_SIZE];
+        num_bytes = prequest->m_num_bytes;
+        pbuffer = prequest->m_pbuffer;
+        _pchannel->bulk_in.m_cb_done = prequest->m_cb_done;
+        _pchannel->bulk_in.m_queue_out++;
+
+        _pchannel->bulk_in.m_busy = TRUE;
+        err = R_USB_HalBulkIn(_pchannel, num_bytes, pbuffer, (CB_DONE_BULK_IN)cb_done_bulk_in);
+
+        /*WRITESHRT is returned when the callback has already been made*/
+        if((USB_ERR_OK != err) && ((usb_err_t)WRITESHRT != err))
+        {
+            _pchannel->bulk_in.m_busy = FALSE;
+            if(NULL != _pchannel->bulk_in.m_cb_done)
+            {
+                _pchannel->bulk_in.m_cb_done(err);
+            }
+        }
+    }
+
+    _pchannel->bulk_in.m_queue_starting = FALSE;
+}
+/******************************************************************************
+End of function start_queued_write
+******************************************************************************/
+
+/*****************************************************************************
+* Function Name   :   fill_receive_ring
+* Description     :   Copy as much of the stage buffer into the receive ring
+*                     as will fit.
+*                     Must be called from the interrupt or with the system
+*                     locked.
+* Argument        :   -
+* Return value    :   -
+*****************************************************************************/
+static void fill_receive_ring(volatile st_usb_object_t *_pchannel)
+{
+    uint8_t *pstage = (uint8_t *)_pchannel->bulk_out.m_stage;
+    uint32_t space;
+    uint32_t pos;
+    uint32_t chunk;
+
+    while((NULL != _pchannel->bulk_out.m_pring)
+       && (_pchannel->bulk_out.m_stage_pos < _pchannel->bulk_out.m_stage_count))
+    {
+        space = _pchannel->bulk_out.m_ring_size - (_pchannel->bulk_out.m_ring_in - _pchannel->bulk_out.m_ring_out);
+        if(0 == space)
+        {
+            break;
+        }
+        pos = _pchannel->bulk_out.m_ring_in & (_pchannel->bulk_out.m_ring_size - 1);
+        chunk = _pchannel->bulk_out.m_stage_count - _pchannel->bulk_out.m_stage_pos;
+        if(chunk > space)
+        {
+            chunk = space;
+        }
+        if(chunk > (_pchannel->bulk_out.m_ring_size - pos))
+        {
+            chunk = _pchannel->bulk_out.m_ring_size - pos;
+        }
+        memcpy(_pchannel->bulk_out.m_pring + pos, pstage + _pchannel->bulk_out.m_stage_pos, chunk);
+        _pchannel->bulk_out.m_stage_pos += chunk;
+        _pchannel->bulk_out.m_ring_in += chunk;
+    }
+}
+/******************************************************************************
+End of function fill_receive_ring
+******************************************************************************/
+
+/*****************************************************************************
+* Function Name   :   arm_receive_ring
+* Description     :   Arm a BULK OUT transfer into the stage buffer once
+*                     everything received so far has gone into the ring.
+*                     Must be called from the interrupt or with the system
+*                     locked.
+* Argument        :   -
+* Return value    :   -
+*****************************************************************************/
+static void arm_receive_ring(volatile st_usb_object_t *_pchannel)
+{
+    if((NULL != _pchannel->bulk_out.m_pring)
+    && (TRUE == _pchannel->connected)
+    && (FALSE == _pchannel->bulk_out.m_ring_armed)
+    && (_pchannel->bulk_out.m_stage_pos == _pchannel->bulk_out.m_stage_count))
+    {
+        _pchannel->bulk_out.m_stage_count = 0;
+        _pchannel->bulk_out.m_stage_pos = 0;
+        _pchannel->bulk_out.m_ring_armed = TRUE;
+        _pchannel->bulk_out.m_busy = TRUE;
+        if(USB_ERR_OK != R_USB_HalBulkOut(_pchannel,
+                                          USB_CDC_RX_STAGE_SIZE,
+                                          (uint8_t *)_pchannel->bulk_out.m_stage,
+                                          (CB_DONE_OUT)cb_done_ring_out))
+        {
+            _pchannel->bulk_out.m_ring_armed = FALSE;
+        }
+    }
+}
+/******************************************************************************
+End of function arm_receive_ring
+******************************************************************************/
+
 /*****************************************************************************
 * Function Name   :   cb_done_control_out
 * Description     :   A Control Out has completed in response to a
@@ -815,6 +1129,25 @@ static void release_flags(volatile st_usb_object_t *_pchannel, usb_err_t _err)
     _pchannel->bulk_out.m_err  = _err;
     _pchannel->bulk_in.m_busy  = FALSE;
     _pchannel->bulk_out.m_busy = FALSE;
+    _pchannel->bulk_out.m_ring_armed = FALSE;
+
+    /*Fail any queued writes*/
+    while(_pchannel->bulk_in.m_queue_out != _pchannel->bulk_in.m_queue_in)
+    {
+        CB_DONE cb_done = _pchannel->bulk_in.m_queue[_pchannel->bulk_in.m_queue_out % USB_CDC_WRITE_QUEUE_SIZE].m_cb_done;
+
+        _pchannel->bulk_in.m_queue_out++;
+        if(NULL != cb_done)
+        {
+            cb_done(_err);
+        }
+    }
+
+    /*A reader waiting on the ring will get nothing more*/
+    if(NULL != _pchannel->bulk_out.m_cb_ring)
+    {
+        _pchannel->bulk_out.m_cb_ring(_err);
+    }
 }
 /******************************************************************************
 End of function release_flags
@@ -842,6 +1175,18 @@ static uint16_t initialise_data(volatile st_usb_object_t *_pchannel)
 
     /*Callback done*/
     _pchannel->bulk_out.m_cb_done = NULL;
+
+    /*Receive ring - the ring itself is kept, it is re-armed by the next
+      R_USB_CdcReadRing*/
+    _pchannel->bulk_out.m_ring_in = 0;
+    _pchannel->bulk_out.m_ring_out = 0;
+    _pchannel->bulk_out.m_ring_armed = FALSE;
+    _pchannel->bulk_out.m_stage_count = 0;
+    _pchannel->bulk_out.m_stage_pos = 0;
+    if(NULL != _pchannel->bulk_out.m_pring)
+    {
+        _pchannel->bulk_out.m_busy = TRUE;
+    }
     
     /*Bulk In*/
     /*Busy Flag*/
@@ -853,6 +1198,11 @@ static uint16_t initialise_data(volatile st_usb_object_t *_pchannel)
     /*Callback done*/
     _pchannel->bulk_in.m_cb_done = NULL;
 
+    /*Write queue*/
+    _pchannel->bulk_in.m_queue_in = 0;
+    _pchannel->bulk_in.m_queue_out = 0;
+    _pchannel->bulk_in.m_queue_starting = FALSE;
+
     _pchannel->pend_pnt[0] = end_ptbl_1;
     _pchannel->pend_pnt[1] = end_ptbl_2;
     _pchannel->pend_pnt[2] = end_ptbl_3;
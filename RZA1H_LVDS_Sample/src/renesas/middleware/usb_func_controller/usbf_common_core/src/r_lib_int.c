@@ -49,6 +49,7 @@ User Include (Project Level Includes)
 #include "usb_common.h"
 
 #include "r_lib_int.h"
+#include "r_usbf_dma.h"
 
 #include "rza_io_regrw.h"
 #include "usb_iobitmask.h"
@@ -80,7 +81,15 @@ static void intr_int_pipe(volatile st_usb_object_t *_pchannel, uint16_t Status,
         rza_io_reg_write_16(&_pchannel->phwdevice->PIPESEL,   PIPE1, USB_PIPESEL_PIPESEL_SHIFT, USB_PIPESEL_PIPESEL);
         if( 0  == rza_io_reg_read_16(&_pchannel->phwdevice->PIPECFG, USB_PIPECFG_DIR_SHIFT, USB_PIPECFG_DIR) )
         {
-            _pchannel->endflag_k = R_USBF_DataioBufRead(_pchannel, PIPE1);
+            if (TRUE == R_USBF_DmaBulkOut(_pchannel))
+            {
+                /* The DMA end interrupt continues the read */
+                _pchannel->endflag_k = READING;
+            }
+            else
+            {
+                _pchannel->endflag_k = R_USBF_DataioBufRead(_pchannel, PIPE1);
+            }
             switch( _pchannel->endflag_k )
             {
                 case    FIFOERROR:
@@ -64,6 +64,7 @@ User Includes (Project Level Includes)
 #include "usb_common.h"
 
 #include "r_lib_int.h"
+#include "r_usbf_dma.h"
 
 #include "usb.h"
 
@@ -176,6 +177,9 @@ usb_err_t R_USB_HalInit(volatile st_usb_object_t *_pchannel,
         /*Initialise the USB module.
         Enable USB interrupts in driver */
         hw_init(_pchannel);
+
+        /* Without the DMA channel the bulk pipes use the CPU */
+        R_USBF_DmaOpen(_pchannel);
     }
 
     return _pchannel->err;
@@ -194,6 +198,8 @@ usb_err_t R_USB_HalClose(volatile st_usb_object_t *_pchannel)
 {
     _pchannel->err = USB_ERR_OK;
 
+    R_USBF_DmaClose(_pchannel);
+
     /*Release the USB module.
       This includes enabling USB interrupts*/
     hw_close(_pchannel);
@@ -480,7 +486,15 @@ usb_err_t R_USB_HalBulkIn(volatile st_usb_object_t *_pchannel, uint32_t _num_byt
         /* Ignore count clear */
         _pchannel->pipe_ignore[PIPE2] = 0;
         _pchannel->pipe_flag[PIPE2] = PIPE_WAIT;
-        _pchannel->endflag_k    = R_USBF_DataioBufWrite(_pchannel, PIPE2);
+        if (TRUE == R_USBF_DmaBulkIn(_pchannel))
+        {
+            /* The BRDY handler writes the last buffer after the DMAC */
+            _pchannel->endflag_k    = WRITING;
+        }
+        else
+        {
+            _pchannel->endflag_k    = R_USBF_DataioBufWrite(_pchannel, PIPE2);
+        }
 
         /* Peripheral Control sequence */
         switch( _pchannel->endflag_k )
@@ -1365,6 +1379,9 @@ usb_err_t R_USB_HalReset( volatile st_usb_object_t *_pchannel )
 
     DEBUG_MSG_MID( ("USBHAL: - Resetting HAL\r\n"));
 
+    /* Abandon a DMA transfer */
+    R_USBF_DmaStop(_pchannel);
+
     /*If connected then go to ready state*/
     if(STATE_DISCONNECTED != usb_control.device_state)
     {
@@ -0,0 +1,454 @@
+/******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized.
+* This software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES
+* REGARDING THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY,
+* INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+* PARTICULAR PURPOSE AND NON-INFRINGEMENT.  ALL SUCH WARRANTIES ARE EXPRESSLY
+* DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES
+* FOR ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS
+* AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this
+* software and to discontinue the availability of this software.
+* By using this software, you agree to the additional terms and
+* conditions found by accessing the following link:
+* http://www.renesas.com/disclaimer
+******************************************************************************
+* Copyright (C) 2016 Renesas Electronics Corporation. All rights reserved. */
+/******************************************************************************
+* File Name       : r_usbf_dma.c
+* Version         : 1.00
+* Device          : RZA1H
+* Tool Chain      :
+* H/W Platform    :
+* Description     : DMA transfers for the bulk pipes.
+*
+*                   The bulk pipes are set up for the CFIFO port. A transfer
+*                   of whole FIFO buffers is moved through the D1FIFO port by
+*                   the DMAC instead, and the pipe is handed back to the CPU
+*                   CFIFO code for the rest. The D0FIFO port stays with the
+*                   pipes that use it for CPU transfers.
+*
+*                   Bulk IN:  all buffers but the last go by DMA, the last is
+*                             written by the BRDY handler, so short and zero
+*                             length packets are sent as before.
+*                   Bulk OUT: each BRDY that finds only full packets in the
+*                             FIFO is read by DMA, anything else is read by
+*                             the CPU.
+*
+*                   One controller at a time uses the channel, the other one
+*                   keeps to the CPU.
+******************************************************************************/
+
+/******************************************************************************
+* History         : 17.10.2026 Ver. 1.00 First Release
+******************************************************************************/
+
+/******************************************************************************
+System Includes (Project Level Includes)
+******************************************************************************/
+#include <fcntl.h>
+
+/******************************************************************************
+User Includes (Project Level Includes)
+******************************************************************************/
+/*    Following header file provides structure and prototype definition of USB
+    API's. */
+#include "usb.h"
+/*    Following header file provides a structure to access on-chip I/O
+    registers. */
+#include "iodefine_cfg.h"
+/*    Following header file provides a structure of HAL Layer. */
+#include "r_usb_hal.h"
+/* Following header file provides common defines for widely used items. */
+#include "usb_common.h"
+
+#include "r_lib_int.h"
+#include "r_usbf_dma.h"
+
+#include "compiler_settings.h"
+#include "rza_io_regrw.h"
+#include "usb_iobitmask.h"
+#include "r_cache_l1_rz_api.h"
+#include "r_dmac_drv_api.h"
+
+/******************************************************************************
+Global Variable
+******************************************************************************/
+
+/* Handle of the DMA driver channel */
+static int_t usbf_dma_handle = (-1);
+
+/* The controller that owns the channel. The DMA driver calls the completion
+   routine without a parameter, so it is kept here */
+static volatile st_usb_object_t *usbf_dma_owner = NULL;
+
+/* Pipe of the running transfer, 0 when the channel is idle */
+static volatile uint16_t usbf_dma_pipe = 0;
+
+/* Length of the running transfer */
+static uint32_t usbf_dma_length = 0;
+
+static st_r_drv_dmac_config_t usbf_dma_config;
+
+/******************************************************************************
+Function Prototypes
+******************************************************************************/
+static void usbf_dma_complete(uint32_t dummy);
+
+/******************************************************************************
+User Program Code
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : usbf_dma_release_cfifo
+* Description     : A pipe can only be on one FIFO port at a time. Takes the
+*                   pipe off the CFIFO port if the CPU code left it there.
+* Argument        : uint16_t Pipe      ; Pipe Number
+* Return value    : None
+******************************************************************************/
+static void usbf_dma_release_cfifo(volatile st_usb_object_t *_pchannel, uint16_t Pipe)
+{
+    if(Pipe == rza_io_reg_read_16(&_pchannel->phwdevice->CFIFOSEL, USB_CFIFOSEL_CURPIPE_SHIFT, USB_CFIFOSEL_CURPIPE))
+    {
+        rza_io_reg_write_16(&_pchannel->phwdevice->CFIFOSEL, PIPE0, USB_CFIFOSEL_CURPIPE_SHIFT, USB_CFIFOSEL_CURPIPE);
+    }
+}
+/******************************************************************************
+End of function usbf_dma_release_cfifo
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : usbf_dma_start
+* Description     : Starts a transfer between the pipe buffer and the pipe
+*                   selected on the D1FIFO port.
+*                   Must be called with the system locked.
+* Argument        : uint16_t Pipe      ; Pipe Number
+*                   uint32_t length    ; Bytes, a multiple of 4
+* Return value    : None
+******************************************************************************/
+static void usbf_dma_start(volatile st_usb_object_t *_pchannel, uint16_t Pipe, uint32_t length)
+{
+    uint32_t buffer = (uint32_t)_pchannel->p_dtptr[Pipe];
+    uint32_t fifo = (uint32_t)&_pchannel->phwdevice->D1FIFO.UINT32;
+    BOOL out;
+
+    /* PIPE1 is bulk OUT, data goes from the FIFO to the buffer */
+    out = (PIPE1 == Pipe) ? TRUE : FALSE;
+
+    if ((&USB200) == _pchannel->phwdevice)
+    {
+        usbf_dma_config.config.resource = out ? DMA_RS_USB0_DMA0_RX : DMA_RS_USB0_DMA0_TX_D1FIFO;
+    }
+    else
+    {
+        usbf_dma_config.config.resource = out ? DMA_RS_USB0_DMA1_RX : DMA_RS_USB0_DMA1_TX_D1FIFO;
+    }
+
+    usbf_dma_config.config.source_width = DMA_DATA_SIZE_4;
+    usbf_dma_config.config.destination_width = DMA_DATA_SIZE_4;
+    if (out)
+    {
+        usbf_dma_config.config.source_address_type = DMA_ADDRESS_FIX;
+        usbf_dma_config.config.destination_address_type = DMA_ADDRESS_INCREMENT;
+        usbf_dma_config.config.source_address = (void *)fifo;
+        usbf_dma_config.config.destination_address = (void *)buffer;
+    }
+    else
+    {
+        usbf_dma_config.config.source_address_type = DMA_ADDRESS_INCREMENT;
+        usbf_dma_config.config.destination_address_type = DMA_ADDRESS_FIX;
+        usbf_dma_config.config.source_address = (void *)buffer;
+        usbf_dma_config.config.destination_address = (void *)fifo;
+    }
+    usbf_dma_config.config.direction = DMA_REQUEST_SOURCE;
+    usbf_dma_config.config.count = length;
+    usbf_dma_config.config.p_dmaComplete = usbf_dma_complete;
+
+    /* The DMAC works on memory */
+    R_CACHE_L1_CleanInvalidLine(buffer, length);
+
+    usbf_dma_pipe = Pipe;
+    usbf_dma_length = length;
+
+    /* 32 bit FIFO access, then let the pipe request the DMAC */
+    rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, MBW_32, USB_DnFIFOSEL_MBW_SHIFT, USB_DnFIFOSEL_MBW);
+    rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, 1, USB_DnFIFOSEL_DREQE_SHIFT, USB_DnFIFOSEL_DREQE);
+
+    control(usbf_dma_handle, CTL_DMAC_SET_CONFIGURATION, (void *)&usbf_dma_config);
+    control(usbf_dma_handle, CTL_DMAC_ENABLE, NULL);
+}
+/******************************************************************************
+End of function usbf_dma_start
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : usbf_dma_end
+* Description     : Stops the channel and takes the pipe off the D1FIFO port.
+*                   Must be called with the system locked.
+* Argument        : None
+* Return value    : None
+******************************************************************************/
+static void usbf_dma_end(volatile st_usb_object_t *_pchannel)
+{
+    uint32_t remaining = 0;
+
+    /* The driver will not disable the channel without somewhere to return
+       the remaining length */
+    control(usbf_dma_handle, CTL_DMAC_DISABLE, (void *)&remaining);
+
+    rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, 0, USB_DnFIFOSEL_DREQE_SHIFT, USB_DnFIFOSEL_DREQE);
+    rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, PIPE0, USB_DnFIFOSEL_CURPIPE_SHIFT, USB_DnFIFOSEL_CURPIPE);
+
+    usbf_dma_pipe = 0;
+}
+/******************************************************************************
+End of function usbf_dma_end
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : usbf_dma_complete
+* Description     : DMA end interrupt. Hands the pipe back to the BRDY
+*                   handler, or completes a bulk OUT that the DMAC filled.
+* Argument        : uint32_t dummy     ; Not used
+* Return value    : None
+******************************************************************************/
+static void usbf_dma_complete(uint32_t dummy)
+{
+    volatile st_usb_object_t *_pchannel = usbf_dma_owner;
+    uint16_t pipe;
+    uint16_t bit;
+    int_t lock;
+
+    UNUSED_PARAM(dummy);
+
+    /* The DMA end interrupt has a lower priority than the USB interrupt,
+       which must not run while the pipe is handed back */
+    lock = R_OS_SysLock(NULL);
+
+    pipe = usbf_dma_pipe;
+    if ((NULL != _pchannel) && (0 != pipe))
+    {
+        usbf_dma_end(_pchannel);
+
+        _pchannel->p_dtptr[pipe] += usbf_dma_length;
+        _pchannel->dtcnt[pipe] -= usbf_dma_length;
+
+        if ((PIPE1 == pipe) && (0 == _pchannel->dtcnt[pipe]))
+        {
+            /* Just Receive Size, as R_USBF_DataioBufRead READEND */
+            R_LIB_DisableIntR(_pchannel, pipe);
+            _pchannel->pipe_flag[pipe] = PIPE_IDLE;
+            if (NULL != _pchannel->callbacks.p_cb_bout_mfpdone)
+            {
+                _pchannel->callbacks.p_cb_bout_mfpdone((volatile void *)_pchannel, 0, _pchannel->rdcnt[pipe]);
+            }
+        }
+        else
+        {
+            bit = g_util_BitSet[pipe];
+
+            /* A BRDY that came during the transfer was for the DMAC */
+            rza_io_reg_write_16(&_pchannel->phwdevice->BRDYSTS, (uint16_t)~bit, ACC_16B_SHIFT, ACC_16B_MASK);
+
+            if (0 != rza_io_reg_read_16(((PIPE1 == pipe) ? &_pchannel->phwdevice->PIPE1CTR : &_pchannel->phwdevice->PIPE2CTR),
+                                        USB_PIPEnCTR_1_5_BSTS_SHIFT, USB_PIPEnCTR_1_5_BSTS))
+            {
+                /* The buffer is ready now and its BRDY may have been cleared
+                   above, so run the handler */
+                R_LIB_IntrInt(_pchannel, bit, bit);
+            }
+            else
+            {
+                R_LIB_EnableIntR(_pchannel, pipe);
+            }
+        }
+    }
+
+    R_OS_SysUnlock(NULL, lock);
+}
+/******************************************************************************
+End of function usbf_dma_complete
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : R_USBF_DmaOpen
+* Description     : Opens the DMA channel for a controller. The bulk pipes of
+*                   a controller that can not have it use the CPU.
+* Argument        : None
+* Return value    : USB_ERR_OK, or USB_ERR_BUSY when it can not be used
+******************************************************************************/
+usb_err_t R_USBF_DmaOpen(volatile st_usb_object_t *_pchannel)
+{
+    usb_err_t err = USB_ERR_BUSY;
+
+    if ((NULL == usbf_dma_owner) || (_pchannel == usbf_dma_owner))
+    {
+        if (usbf_dma_handle < 0)
+        {
+            usbf_dma_handle = open(DEVICE_INDENTIFIER "dma_usbf0", O_RDWR);
+        }
+
+        if (usbf_dma_handle >= 0)
+        {
+            usbf_dma_owner = _pchannel;
+            usbf_dma_pipe = 0;
+            err = USB_ERR_OK;
+        }
+    }
+
+    return err;
+}
+/******************************************************************************
+End of function R_USBF_DmaOpen
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : R_USBF_DmaClose
+* Description     : Stops any transfer and closes the DMA channel
+* Argument        : None
+* Return value    : None
+******************************************************************************/
+void R_USBF_DmaClose(volatile st_usb_object_t *_pchannel)
+{
+    if ((_pchannel == usbf_dma_owner) && (usbf_dma_handle >= 0))
+    {
+        R_USBF_DmaStop(_pchannel);
+        close(usbf_dma_handle);
+        usbf_dma_handle = (-1);
+        usbf_dma_owner = NULL;
+    }
+}
+/******************************************************************************
+End of function R_USBF_DmaClose
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : R_USBF_DmaStop
+* Description     : Abandons a running transfer. The completion callbacks are
+*                   not called.
+* Argument        : None
+* Return value    : None
+******************************************************************************/
+void R_USBF_DmaStop(volatile st_usb_object_t *_pchannel)
+{
+    int_t lock;
+
+    if (_pchannel == usbf_dma_owner)
+    {
+        lock = R_OS_SysLock(NULL);
+        if (0 != usbf_dma_pipe)
+        {
+            usbf_dma_end(_pchannel);
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+}
+/******************************************************************************
+End of function R_USBF_DmaStop
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : R_USBF_DmaBulkIn
+* Description     : Starts a bulk IN set up in dtcnt[PIPE2] and p_dtptr[PIPE2]
+*                   by DMA. All FIFO buffers but the last are written by the
+*                   DMAC, the last by the BRDY handler.
+* Argument        : None
+* Return value    : TRUE when the DMAC has the transfer, FALSE to write it
+*                   with the CPU
+******************************************************************************/
+BOOL R_USBF_DmaBulkIn(volatile st_usb_object_t *_pchannel)
+{
+    BOOL started = FALSE;
+    uint16_t size;
+    uint32_t length;
+    int_t lock;
+
+    if ((_pchannel == usbf_dma_owner) && (NULL != _pchannel->p_dtptr[PIPE2]) &&
+        (0 == ((uint32_t)_pchannel->p_dtptr[PIPE2] & 0x00000003)))
+    {
+        lock = R_OS_SysLock(NULL);
+
+        size = getBufSize(_pchannel, PIPE2);
+        if ((0 == usbf_dma_pipe) && (_pchannel->dtcnt[PIPE2] > size) && (size >= USBF_DMA_THRESHOLD))
+        {
+            /* The pipe buffer empties while the DMAC fills it */
+            R_LIB_DisableIntR(_pchannel, PIPE2);
+            R_LIB_DisableIntE(_pchannel, PIPE2);
+            rza_io_reg_write_16(&_pchannel->phwdevice->BRDYSTS, (uint16_t)~BITBRDY2, ACC_16B_SHIFT, ACC_16B_MASK);
+            rza_io_reg_write_16(&_pchannel->phwdevice->BEMPSTS, (uint16_t)~BITBEMP2, ACC_16B_SHIFT, ACC_16B_MASK);
+
+            usbf_dma_release_cfifo(_pchannel, PIPE2);
+            if (FIFOERROR != R_USBF_DataioFPortChange1(_pchannel, PIPE2, D1USE, USB_NO))
+            {
+                length = ((_pchannel->dtcnt[PIPE2] - 1) / size) * size;
+                usbf_dma_start(_pchannel, PIPE2, length);
+
+                /* Set BUF */
+                R_LIB_SetBUF(_pchannel, PIPE2);
+                started = TRUE;
+            }
+            else
+            {
+                rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, PIPE0, USB_DnFIFOSEL_CURPIPE_SHIFT, USB_DnFIFOSEL_CURPIPE);
+            }
+        }
+
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return started;
+}
+/******************************************************************************
+End of function R_USBF_DmaBulkIn
+******************************************************************************/
+
+/******************************************************************************
+* Function Name   : R_USBF_DmaBulkOut
+* Description     : Called by the PIPE1 BRDY handler. When the FIFO holds
+*                   only full packets and they fit in the buffer they are
+*                   read by DMA, and the DMA end interrupt continues the read.
+* Argument        : None
+* Return value    : TRUE when the DMAC reads the FIFO, FALSE to read it with
+*                   the CPU
+******************************************************************************/
+BOOL R_USBF_DmaBulkOut(volatile st_usb_object_t *_pchannel)
+{
+    BOOL started = FALSE;
+    uint16_t buffer;
+    uint16_t dtln;
+    uint16_t mxps;
+
+    if ((_pchannel == usbf_dma_owner) && (0 == usbf_dma_pipe) && (NULL != _pchannel->p_dtptr[PIPE1]) &&
+        (0 == ((uint32_t)_pchannel->p_dtptr[PIPE1] & 0x00000003)))
+    {
+        usbf_dma_release_cfifo(_pchannel, PIPE1);
+        buffer = R_USBF_DataioFPortChange1(_pchannel, PIPE1, D1USE, USB_NO);
+        dtln = (uint16_t)(buffer & BITDTLN);
+        mxps = getMaxPacketSize(_pchannel, PIPE1);
+
+        /* Short packets end the read, they are left to the CPU */
+        if ((FIFOERROR != buffer) && (dtln >= USBF_DMA_THRESHOLD) && (0 == (dtln % mxps)) &&
+            (_pchannel->dtcnt[PIPE1] >= dtln))
+        {
+            R_LIB_DisableIntR(_pchannel, PIPE1);
+            usbf_dma_start(_pchannel, PIPE1, dtln);
+            started = TRUE;
+        }
+        else
+        {
+            rza_io_reg_write_16(&_pchannel->phwdevice->D1FIFOSEL, PIPE0, USB_DnFIFOSEL_CURPIPE_SHIFT, USB_DnFIFOSEL_CURPIPE);
+        }
+    }
+
+    return started;
+}
+/******************************************************************************
+End of function R_USBF_DmaBulkOut
+******************************************************************************/
@@ -89,6 +89,10 @@ typedef struct _BULKEP
     PUSBEI   pInEndpoint;
     /* The current time-out */
     uint32_t dwTimeOut_mS;
+    /* Set when the next read is to be started without waiting for it */
+    _Bool    bfOverlappedRead;
+    /* Set while an overlapped read is in progress */
+    _Bool    bfReadPending;
 
     /* The mutex event to make sure that devices with more than one logical
      uint are accessed sequentially */
@@ -249,6 +253,17 @@ static int blkepRead (st_stream_ptr_t pstream, uint8_t *pbyBuffer, uint32_t uiCo
         bfResult = usbhStartTransfer(pBulkEp->pDevice, &pBulkEp->readRequest, pBulkEp->pInEndpoint, pbyBuffer,
                 (size_t) uiCount, pBulkEp->dwTimeOut_mS);
 
+        /* If an overlapped read was requested don't wait for it. The result
+         is collected with CTL_GET_OVERLAPPED_READ_RESULT */
+        if ((bfResult) && (pBulkEp->bfOverlappedRead))
+        {
+            pBulkEp->bfOverlappedRead = false;
+            pBulkEp->bfReadPending = true;
+            pBulkEp->lastError = BULK_EP_IO_PENDING;
+            return 0;
+        }
+        pBulkEp->bfOverlappedRead = false;
+
         /* If the transfer was started */
         if (bfResult)
         {
@@ -498,6 +513,44 @@ static int blkepGetMaxLun (PBULKEP pBulkEp, uint8_t *pbyMaxLun)
  End of function  blkepGetMaxLun
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: blkepGetOverlappedReadResult
+ Description:   Function to wait for an overlapped read to complete
+ Arguments:     IN  pBulkEp - Pointer to the driver extension
+ OUT pOverlapped - Pointer to the overlapped result
+ Return value:  0 for success or error code
+ ******************************************************************************/
+static int blkepGetOverlappedReadResult (PBULKEP pBulkEp, POLD pOverlapped)
+{
+    if (!pBulkEp->bfReadPending)
+    {
+        return BULK_EP_INVALID_PARAMETER;
+    }
+
+    /* Wait for the transfer to complete or time-out */
+    R_OS_WaitForEvent(&pBulkEp->readRequest.ioSignal, R_OS_ABSTRACTION_PRV_EV_WAIT_INFINITE);
+    pBulkEp->bfReadPending = false;
+
+    /* Check the error code */
+    if (pBulkEp->readRequest.errorCode)
+    {
+        TRACE(("blkepGetOverlappedReadResult: Error %d\r\n", pBulkEp->readRequest.errorCode));
+        /* Simplify the error code */
+        pBulkEp->lastError = bulkepSetErrorCode(pBulkEp->readRequest.errorCode);
+        pOverlapped->stLength = (size_t) -1;
+    }
+    else
+    {
+        pBulkEp->lastError = BULK_EP_NO_ERROR;
+        pOverlapped->stLength = (size_t) pBulkEp->readRequest.uiTransferLength;
+    }
+    pOverlapped->iResult = (int) pBulkEp->lastError;
+    return BULK_EP_NO_ERROR;
+}
+/******************************************************************************
+ End of function  blkepGetOverlappedReadResult
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: blkepControl
  Description:   Function to handle custom controls for the bulk endpoints
@@ -546,6 +599,34 @@ static int blkepControl (st_stream_ptr_t pstream, uint32_t ctlCode, void *pCtlSt
             }
             return BULK_EP_NO_ERROR;
 
+        case CTL_START_OVERLAPPED_READ :
+        {
+            /* The next read is started and returns without waiting. The
+             completion is signalled on the read request event of this driver */
+            pBulkEp->bfOverlappedRead = true;
+            return BULK_EP_NO_ERROR;
+        }
+
+        case CTL_GET_OVERLAPPED_READ_RESULT :
+        {
+            if (pCtlStruct)
+            {
+                return blkepGetOverlappedReadResult(pBulkEp, (POLD) pCtlStruct);
+            }
+            break;
+        }
+
+        case CTL_CANCEL_OVERLAPPED_READ :
+        {
+            pBulkEp->bfOverlappedRead = false;
+            if (pBulkEp->bfReadPending)
+            {
+                usbhCancelTransfer(&pBulkEp->readRequest);
+                pBulkEp->bfReadPending = false;
+            }
+            return BULK_EP_NO_ERROR;
+        }
+
         case CTL_USB_MS_RESET :
             return blkepMsReset(pBulkEp);
 
@@ -74,6 +74,9 @@
 #define TRACE(x)
 #endif
 
+/* The period at which data held in the drive caches is written to the media */
+#define DSK_CACHE_FLUSH_PERIOD_MS   (1000UL)
+
 /******************************************************************************
  Typedef definitions
  ******************************************************************************/
@@ -103,6 +106,8 @@ typedef struct _DSKLST
     {
         uint32_t dwNumBlocks;
         uint32_t dwBlockSize;
+        _Bool    bfLongCommands;    /* Set when the 16 byte SCSI commands
+                                       are required */
     } mediaGeometry;
 
     /* The attributes of the media */
@@ -127,6 +132,8 @@ static void dskDismountDevice (int iMsDev);
 static DSKERR dskMountUnit (int iMsDev, int iLun, PDSKLST pDisk, _Bool bfAdd);
 static _Bool dskRemoveDisk (PDSKLST pDisk);
 static int dskCountAttachedDrives (int iMsDev);
+static void dskFlushAllDevices (void);
+static void dskWaitFlush (PDRIVE pDrive);
 
 /******************************************************************************
  Global Variables
@@ -136,6 +143,7 @@ static PDSKLST gpDiskList = NULL;
 static int initaliser =  R_OS_ABSTRACTION_PRV_INVALID_HANDLE;
 static os_task_t *guiTaskID = &initaliser;
 static event_t gpevNewDrive = NULL;
+static PDRIVE volatile gpMountDrive = NULL;
 
 /******************************************************************************
  Public Functions
@@ -510,23 +518,104 @@ void dskManager (void)
     /* Until the task is destroyed */
     while (true)
     {
-        /* Wait for the new drive event to be set */
-        R_OS_WaitForEvent(&gpevNewDrive, R_OS_ABSTRACTION_PRV_EV_WAIT_INFINITE);
-
-        /* Reset the signal */
-        R_OS_ResetEvent(&gpevNewDrive);
+        /* Wait for the new drive event to be set, or for the time to write
+           back the drive caches */
+        if (R_OS_WaitForEvent(&gpevNewDrive, DSK_CACHE_FLUSH_PERIOD_MS))
+        {
+            /* Reset the signal */
+            R_OS_ResetEvent(&gpevNewDrive);
 
-        /* Wait for the disk to be added to the device list */
-        R_OS_TaskSleep(50UL);
+            /* Wait for the disk to be added to the device list */
+            R_OS_TaskSleep(50UL);
 
-        /* Mount all devices */
-        dskMountAllDevices();
+            /* Mount all devices */
+            dskMountAllDevices();
+        }
+        else
+        {
+            dskFlushAllDevices();
+        }
     }
 }
 /*****************************************************************************
  End of function  dskManager
  ******************************************************************************/
 
+/*****************************************************************************
+ Function Name: dskFlushAllDevices
+ Description:   Function to write the data held in the drive caches to the media.
+                The system lock is only held to find each drive, the write back
+                is serialised with the file system by the cache's own mutex
+ Arguments:     none
+ Return value:  none
+ *****************************************************************************/
+static void dskFlushAllDevices (void)
+{
+    PDSKLST pListTop;
+    PDRIVE pDrive;
+    int iDisk = 0;
+    int iSkip;
+
+    do
+    {
+        /* Find the next drive that is ready */
+        pDrive = NULL;
+        R_OS_SysWaitAccess();
+        pListTop = gpDiskList;
+        iSkip = iDisk;
+        while (pListTop)
+        {
+            if ((pListTop->pDrive) && (pListTop->driveState == DRIVE_READY))
+            {
+                if (0 == iSkip)
+                {
+                    pDrive = pListTop->pDrive;
+                    break;
+                }
+                iSkip--;
+            }
+            pListTop = pListTop->pNext;
+        }
+
+        /* The drive is not destroyed while it is being written back */
+        if (pDrive)
+        {
+            bcClaimFlush(pDrive->pBlockCache);
+        }
+        R_OS_SysReleaseAccess();
+
+        if (pDrive)
+        {
+            if (R_FAT_FlushDrive(pDrive))
+            {
+                TRACE(("dskFlushAllDevices: %c write back failed\r\n",
+                                'A' + pDrive->proposed_drive_index));
+            }
+            bcReleaseFlush(pDrive->pBlockCache);
+        }
+        iDisk++;
+    } while (pDrive);
+}
+/*****************************************************************************
+ End of function  dskFlushAllDevices
+ ******************************************************************************/
+
+/*****************************************************************************
+ Function Name: dskWaitFlush
+ Description:   Function to wait for the write back of a drive to finish before
+                it is destroyed. The caller holds the system lock, which the
+                write back does not need to finish
+ Arguments:     IN  pDrive - Pointer to the drive object
+ Return value:  none
+ *****************************************************************************/
+static void dskWaitFlush (PDRIVE pDrive)
+{
+    bcWaitFlush(pDrive->pBlockCache);
+}
+/*****************************************************************************
+ End of function  dskWaitFlush
+ ******************************************************************************/
+
 /*****************************************************************************
  Function Name: dskGetDriveFromLetter
  Description:   Function to get a pointer to the drive object
@@ -575,10 +664,19 @@ static PDRIVE dskGetDriveFromLetter (int8_t chDriveLetter)
  ******************************************************************************/
 static void dskFree (PDSKLST pDisk)
 {
-    if (pDisk->pDrive)
+    PDRIVE pDrive;
+    int_t lock;
+
+    /* Take the drive off the disk so that get_drive no longer finds it */
+    lock = R_OS_SysLock(NULL);
+    pDrive = pDisk->pDrive;
+    pDisk->pDrive = NULL;
+    R_OS_SysUnlock(NULL, lock);
+
+    if (pDrive)
     {
-        R_FAT_DestroyDrive(pDisk->pDrive);
-        pDisk->pDrive = NULL;
+        dskWaitFlush(pDrive);
+        R_FAT_DestroyDrive(pDrive);
     }
 }
 /******************************************************************************
@@ -662,6 +760,8 @@ static void dskDismountDevice (int iMsDev)
         /* Look for the device in the list */
         if ((*ppDiskList)->iMsDev == iMsDev)
         {
+            /* Write back the cache while the device may still be attached */
+            R_FAT_FlushDrive((*ppDiskList)->pDrive);
             dskRemoveDisk(*ppDiskList);
             ppDiskList = &gpDiskList;
         }
@@ -728,7 +828,15 @@ DSKERR dskMountPartition (PDSKLST pDisk, int iPartition)
          pDisk->pDrive = (PDRIVE) R_FAT_CreateDrive(pDisk->iMsDev,
                                                     pDisk->iLun,
                                                     pDisk->mediaGeometry.dwBlockSize,
-                      pDisk->mediaGeometry.dwNumBlocks);
+                      pDisk->mediaGeometry.dwNumBlocks,
+                                                    NULL);
+
+        /* Large media use the 16 byte commands, which also let a long
+           contiguous transfer go out as one command */
+        if ((pDisk->pDrive) && (pDisk->mediaGeometry.bfLongCommands))
+        {
+            bcSetLongCommands(pDisk->pDrive->pBlockCache, true);
+        }
     }
 
     if (pDisk->pDrive)
@@ -739,13 +847,18 @@ DSKERR dskMountPartition (PDSKLST pDisk, int iPartition)
            drive letter. */
         pDisk->pDrive->proposed_drive_index = (int8_t)(dskAssignDriveLetter() - (int8_t)65);
 
-        /* Ask the FAT library to mount the disk */
+        /* Ask the FAT library to mount the disk. The disk is not on the list
+           yet, so get_drive finds it here while it is mounted */
+        gpMountDrive = pDisk->pDrive;
         if (R_FAT_MountPartition(pDisk->pDrive))
         {
-                 R_FAT_DestroyDrive(pDisk->pDrive);
+            gpMountDrive = NULL;
+            dskWaitFlush(pDisk->pDrive);
+            R_FAT_DestroyDrive(pDisk->pDrive);
             pDisk->pDrive = NULL;
             return DISK_FAILED_TO_MOUNT_PARTITION;
         }
+        gpMountDrive = NULL;
         TRACE(("dskMountPartition: "
                         "iMsDev = %d, iLun = %d, bfWriteProtect %d, "
                         "dwBlockSize = %u, dwNumBlocks = %u\r\n",
@@ -994,7 +1107,28 @@ static DSKERR dskMountUnit (int iMsDev, int iLun, PDSKLST pDisk, _Bool bfAdd)
                                        &pDisk->mediaGeometry.dwBlockSize))
         {
             return DISK_DRIVER_ERROR;
-        } TRACE(("Capacity: Blocks %lu Size %lu\r\n",
+        }
+
+        /* A last LBA of 0xFFFFFFFF (the block count wraps to 0) means the
+           media is too large for the 10 byte commands */
+        pDisk->mediaGeometry.bfLongCommands = false;
+        if (0UL == pDisk->mediaGeometry.dwNumBlocks)
+        {
+            uint64_t qwNumBlocks;
+
+            if (scsiReadCapacity16(iMsDev, iLun, &qwNumBlocks,
+                                   &pDisk->mediaGeometry.dwBlockSize))
+            {
+                return DISK_DRIVER_ERROR;
+            }
+            pDisk->mediaGeometry.bfLongCommands = true;
+
+            /* The FAT library addresses 32 bit LBAs, so only the start of
+               the media is accessible */
+            pDisk->mediaGeometry.dwNumBlocks = (qwNumBlocks > 0xFFFFFFFFULL)
+                                             ? 0xFFFFFFFFUL : (uint32_t) qwNumBlocks;
+        }
+        TRACE(("Capacity: Blocks %lu Size %lu\r\n",
                         pDisk->mediaGeometry.dwNumBlocks,
                         pDisk->mediaGeometry.dwBlockSize));
 
@@ -1059,26 +1193,44 @@ static DSKERR dskMountUnit (int iMsDev, int iLun, PDSKLST pDisk, _Bool bfAdd)
 
 /*****************************************************************************
 Function Name: get_drive
-Description:   Function find the drive in the drive list
+Description:   Function find the drive in the drive list. Called by the
+               file system, which may run while the disk manager removes a disk
 Arguments:     iMsDev - drive number to search for
 Return value:  PDRIVE the drive if found, NULL if not
 *****************************************************************************/
 PDRIVE get_drive (int drive)
 {
-    PDSKLST pListTop = gpDiskList;
+    PDRIVE pDrive = NULL;
+    PDSKLST pListTop;
+    int_t lock;
+
+    /* The drive being mounted is not on the list until the mount is done */
+    pDrive = gpMountDrive;
+    if ((pDrive) && (drive == pDrive->proposed_drive_index))
+    {
+        return pDrive;
+    }
+    pDrive = NULL;
 
+    /* The mount calls this with the system lock held, so the list is walked
+       with the interrupts locked out instead. A disk removed from the list
+       is not freed while this walks it */
+    lock = R_OS_SysLock(NULL);
+    pListTop = gpDiskList;
     while (pListTop)
     {
         if (drive == pListTop->chDriveLetter - 'A')
         {
-            return pListTop->pDrive;
+            pDrive = pListTop->pDrive;
+            break;
         }
 
         /* Advance to the next disk on the list */
         pListTop = pListTop->pNext;
     }
+    R_OS_SysUnlock(NULL, lock);
 
-    return p_drive_0;
+    return pDrive;
 }
 /*****************************************************************************
 End of function get_drive
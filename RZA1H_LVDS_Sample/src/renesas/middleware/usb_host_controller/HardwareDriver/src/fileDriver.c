@@ -370,6 +370,36 @@ static int fileControl (st_stream_ptr_t stream_ptr, uint32_t ctlCode, void *pCtl
             break;
         }
 
+        case CTL_FILE_CREATE_LINK_MAP :
+        {
+            DWORD table_size = 0UL;
+
+            /* Optional size of the table in DWORDs, 0 sizes it to the file */
+            if (pCtlStruct)
+            {
+                table_size = (DWORD) *((uint32_t *) pCtlStruct);
+            }
+
+            if (!R_FAT_CreateLinkMap(pFile, &table_size))
+            {
+                if (pCtlStruct)
+                {
+                    *((uint32_t *) pCtlStruct) = (uint32_t) table_size;
+                }
+
+                return 0;
+            }
+
+            break;
+        }
+
+        case CTL_FILE_DISCARD_LINK_MAP :
+        {
+            R_FAT_DiscardLinkMap(pFile);
+
+            return 0;
+        }
+
         default :
         {
             return -1;
@@ -32,6 +32,10 @@
  *                support required functionality. Channels used for dma
  *                are now allocated in the dma driver file:
  *                drivers\r_dmac\inc\r_dmac_drv_sc_cfg.h
+ *                Each host controller has two DMA FIFO ports (D0FIFO and
+ *                D1FIFO) which can be used in either direction, so up to
+ *                two transfers per controller are serviced by the DMAC at
+ *                the same time.
  *******************************************************************************
  * History      : DD.MM.YYYY Ver. Description
  *              : 28.05.2015 1.0  First Release
@@ -40,6 +44,9 @@
  *                                legacy reasons. Improved GSCE compliance.
  *              : 28.10.2019 2.00 Move interface from direct access to using
  *                                the r_dmac driver.
+ *              : 17.10.2026 2.10 Replace the fixed IN and OUT channels with a
+ *                                pool of channels so that transfers on
+ *                                different pipes can run concurrently.
  ******************************************************************************/
 
 /******************************************************************************
@@ -90,47 +97,68 @@
 /* Remove comment on line below to turn nested interrupt support in this file */
 #define NESTED_SUPPORT (1)
 
+/******************************************************************************
+ Typedef definitions
+ *****************************************************************************/
+
+typedef struct
+{
+    /* The handle of the DMA driver channel */
+    int_t   iHandle;
+    /* Set while the channel is allocated to a transfer */
+    _Bool   bfBusy;
+    /* The host controller and the FIFO port the channel is assigned to */
+    void    *pUSB;
+    int     iFifo;
+    /* The completion routine and its parameter */
+    void    *pv_param;
+    void    (*pf_complete) (void *pv_param);
+    /* The driver configuration for the transfer */
+    st_r_drv_dmac_config_t dma_config;
+} USBDMACH, *PUSBDMACH;
+
 /******************************************************************************
  Function Prototypes
  *****************************************************************************/
-static void INT_D1FIFO0_COMPLETE (uint32_t dummy);
-static void INT_D0FIFO1_COMPLETE (uint32_t dummy);
-static void INT_D1FIFO1_COMPLETE (uint32_t dummy);
-static void dmaFreeVectD0FIFO0 (void);
-static void dmaFreeVectD0FIFO1 (void);
-static void dmaFreeVectD1FIFO0 (void);
-static void dmaFreeVectD1FIFO1 (void);
+static void dmaCompleteUsb (int iChannel);
+static void INT_USB_DMA0_COMPLETE (uint32_t dummy);
+static void INT_USB_DMA1_COMPLETE (uint32_t dummy);
+static void INT_USB_DMA2_COMPLETE (uint32_t dummy);
+static void INT_USB_DMA3_COMPLETE (uint32_t dummy);
+static void dmaStartUsb (int iChannel, void *pvSrc, void *pvDest, size_t st_length, void *pv_param,
+        void (*pf_complete)(void *pv_param), _Bool bfOut);
 
 /******************************************************************************
  Global Variables
  *****************************************************************************/
 
-/* The parameters for the call-back functions */
-static void *pv_param_ch0 = NULL;
-static void *pv_param_ch1 = NULL;
-
-/* The call back function pointers */
-static void (*gpf_complete0) (void *) = NULL;
-static void (*gpf_complete1) (void *) = NULL;
-
-/* The vector free functions */
-static void (*gpfFreeVectUsbOutCh0) (void) = NULL;
-static void (*gpfFreeVectUsbInCh1) (void) = NULL;
-
-/* The length of the transfers used in USB functions*/
-static size_t gst_lengthCh0 = 0UL;
-static size_t gstTransferLengthCh0 = 0UL;
-static size_t gst_lengthCh1 = 0UL;
-static size_t gstTransferLengthCh1 = 0UL;
-
-/* DMA driver */
-static int_t dma_usb_out_handle = -1;
-static int_t dma_usb_in_handle = -1;
-
-static void *ch0out_source;
-static void *ch0out_destination;
-static void *inch1_source;
-static void *inch1_destination;
+/* The names of the channels in the device link table */
+static const char * const gpszUsbDmaName[USB_DMA_NUM_CHANNELS] =
+{
+    DEVICE_INDENTIFIER "dma_usb0",
+    DEVICE_INDENTIFIER "dma_usb1",
+    DEVICE_INDENTIFIER "dma_usb2",
+    DEVICE_INDENTIFIER "dma_usb3"
+};
+
+/* The DMA driver calls the completion routine without a parameter so each
+   channel needs its own */
+static void (* const gpfUsbDmaComplete[USB_DMA_NUM_CHANNELS]) (uint32_t dummy) =
+{
+    INT_USB_DMA0_COMPLETE,
+    INT_USB_DMA1_COMPLETE,
+    INT_USB_DMA2_COMPLETE,
+    INT_USB_DMA3_COMPLETE
+};
+
+/* The channel pool */
+static USBDMACH gpUsbDmaCh[USB_DMA_NUM_CHANNELS] =
+{
+    {-1, false, NULL, 0, NULL, NULL, {{0}}},
+    {-1, false, NULL, 0, NULL, NULL, {{0}}},
+    {-1, false, NULL, 0, NULL, NULL, {{0}}},
+    {-1, false, NULL, 0, NULL, NULL, {{0}}}
+};
 
 /******************************************************************************
  Public Functions
@@ -138,290 +166,230 @@ static void *inch1_destination;
 
 /******************************************************************************
  * Function Name: usbOpenDmaDriver
- * Description  : Open the DMA driver for USBN out and in
+ * Description  : Open the DMA driver channels used by the USB host
  * Arguments    : none
- * Return Value : DRV_SUCCESS or DRV_ERROR
+ * Return Value : DRV_SUCCESS if at least one channel is available otherwise
+ *                DRV_ERROR
  *****************************************************************************/
 int_t usbOpenDmaDriver(void)
 {
-    if (dma_usb_out_handle < 0)
-    {
-        dma_usb_out_handle = open(DEVICE_INDENTIFIER "dma_usb_out", O_WRONLY);
-    }
+    int_t   iResult = DRV_ERROR;
+    int     iChannel;
 
-    if (dma_usb_in_handle < 0)
+    for (iChannel = 0; iChannel < USB_DMA_NUM_CHANNELS; iChannel++)
     {
-        dma_usb_in_handle = open(DEVICE_INDENTIFIER "dma_usb_in", O_RDONLY);
-    }
+        if (gpUsbDmaCh[iChannel].iHandle < 0)
+        {
+            gpUsbDmaCh[iChannel].iHandle = open(gpszUsbDmaName[iChannel], O_RDWR);
+        }
 
-    if ((dma_usb_out_handle < 0) || (dma_usb_out_handle < 0))
-    {
-        return (DRV_ERROR);
+        if (gpUsbDmaCh[iChannel].iHandle >= 0)
+        {
+            iResult = DRV_SUCCESS;
+        }
     }
 
-    return (DRV_SUCCESS);
+    return (iResult);
 }
 /******************************************************************************
- End of function dmaStartUsbOutCh0
+ End of function usbOpenDmaDriver
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: dmaStartUsbOutCh0
- Description:   Function to start DMA channel 0 for a USB OUT transfer
- This is where the DMAC writes to the designated pipe FIFO.
- In this implementation the assignment is DMA Channel 0 always
- uses the USB D0FIFO.
-
- Direction: Buffer memory --> USB Channel
-
- Arguments:
- IN  pvSrc - Pointer to the 4 byte aligned source memory
- (CAUTION: If using internal SRAM ensure this is a *Mirrored Address* (6xxxxxxx)
- native (2xxxxxxx) addresses corrupts data when DMA transfer crosses blocks)
- IN  st_length - The length of data to transfer
- IN  p_fifo - Pointer to the destination FIFO
- IN  pv_param - Pointer to pass to the completion routine
- IN  pf_complete - Pointer to the completion routine
- Return value:  none
- ******************************************************************************/
-void dmaStartUsbOutCh0 (void *pvSrc, size_t st_length, void *p_fifo, void *pv_param, void (*pf_complete)(void *pv_param))
+ Function Name: dmaAllocUsbChannel
+ Description:   Function to allocate a DMA channel and one of the DMA FIFO
+                ports of a host controller to a transfer
+ Arguments:     IN  pUSB - Pointer to the host controller
+                OUT piFifo - Pointer to the FIFO port assigned
+                             USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
+ Return value:  The channel number or -1 if no channel or port is free
+ *****************************************************************************/
+int dmaAllocUsbChannel (void *pUSB, int *piFifo)
 {
-    static st_r_drv_dmac_config_t dma_config;
-
-	/* check the DMA driver */
-    if (dma_usb_out_handle < 0)
-    {
-        return;
-    }
+    int     iChannel;
+    int     iFree = -1;
+    _Bool   pbfPortBusy[2] = {false, false};
 
 #if NESTED_SUPPORT
     int_t imask = R_OS_SysLock(NULL);
 #endif
 
-	ch0out_source = pvSrc;
-	ch0out_destination = p_fifo;
-
-    PUSBTR prequest = (PUSBTR) pv_param;
-
-    /* configure the DMA transfer */
-    if ((&USB200) == prequest->pUSB)
+    for (iChannel = 0; iChannel < USB_DMA_NUM_CHANNELS; iChannel++)
     {
-    	dma_config.config.resource = DMA_RS_USB0_DMA0_TX;
-        gpfFreeVectUsbOutCh0 = dmaFreeVectD0FIFO0;
+        if (gpUsbDmaCh[iChannel].bfBusy)
+        {
+            if (gpUsbDmaCh[iChannel].pUSB == pUSB)
+            {
+                pbfPortBusy[gpUsbDmaCh[iChannel].iFifo] = true;
+            }
+        }
+        else if ((iFree < 0) && (gpUsbDmaCh[iChannel].iHandle >= 0))
+        {
+            iFree = iChannel;
+        }
     }
-    else
+
+    if (iFree >= 0)
     {
-    	dma_config.config.resource = DMA_RS_USB0_DMA1_TX;
-        gpfFreeVectUsbOutCh0 = dmaFreeVectD0FIFO1;
+        if (!pbfPortBusy[USBH_DMA_D0FIFO])
+        {
+            *piFifo = USBH_DMA_D0FIFO;
+        }
+        else if (!pbfPortBusy[USBH_DMA_D1FIFO])
+        {
+            *piFifo = USBH_DMA_D1FIFO;
+        }
+        else
+        {
+            /* Both ports of this controller are in use */
+            iFree = -1;
+        }
     }
 
-    R_CACHE_L1_CleanInvalidLine((uint32_t) pvSrc, st_length);
-
-    dma_config.config.source_width = DMA_DATA_SIZE_4;                         /* DMA transfer unit size (source) - 32 bits */
-    dma_config.config.destination_width = DMA_DATA_SIZE_4;                    /* DMA transfer unit size (destination) - 32 bits */
-    dma_config.config.source_address_type = DMA_ADDRESS_INCREMENT;            /* DMA address type (source) */
-    dma_config.config.destination_address_type = DMA_ADDRESS_FIX;             /* DMA address type (destination) */
-    dma_config.config.direction = DMA_REQUEST_SOURCE;                         /* DMA transfer direction will be set by the driver */
-    dma_config.config.source_address = pvSrc;                                 /* Source Address */
-    dma_config.config.destination_address = p_fifo;                           /* Destination Address */
-    dma_config.config.count = st_length;                                      /* length */
-    dma_config.config.p_dmaComplete = INT_D0FIFO1_COMPLETE;                   /* set callback function (DMA end interrupt) */
-
-    control(dma_usb_out_handle, CTL_DMAC_SET_CONFIGURATION, (void *) &dma_config);
-
-    TRACE(("hwDmaif: DMA out len = 0x%.8lX from address 0x%.8lX\r\n", gstTransferLengthCh0, pvSrc));
-
-    /* Set the pipe number and completion routine */
-    pv_param_ch0 = pv_param;
-    gpf_complete0 = pf_complete;
-    gstTransferLengthCh0 = st_length;
-
-    /* Set the remainder which will need to be processed by another transfer */
-    gst_lengthCh0 = st_length - gstTransferLengthCh0;
-
-    /* trigger the DMA transfer */
-    control(dma_usb_out_handle, CTL_DMAC_ENABLE, NULL);
+    if (iFree >= 0)
+    {
+        gpUsbDmaCh[iFree].bfBusy = true;
+        gpUsbDmaCh[iFree].pUSB = pUSB;
+        gpUsbDmaCh[iFree].iFifo = *piFifo;
+    }
 
 #if NESTED_SUPPORT
     R_OS_SysUnlock(NULL, imask);
 #endif
+
+    return iFree;
 }
 /******************************************************************************
- End of function dmaStartUsbOutCh0
+ End of function dmaAllocUsbChannel
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: dmaGetUsbOutCh0Count
- Description:   Function to get the current DMA transfer count
- Parameters:    none
- Return value:  The value of the transfer count register
+ Function Name: dmaFreeUsbChannel
+ Description:   Function to return a channel to the pool
+ Arguments:     IN  iChannel - The channel number
+ Return value:  none
  *****************************************************************************/
-unsigned long dmaGetUsbOutCh0Count (void)
+void dmaFreeUsbChannel (int iChannel)
 {
-    uint32_t transfer_byte_count;
-
-    control(dma_usb_out_handle, CTL_DMAC_GET_TRANSFER_BYTE_COUNT, (void *) &transfer_byte_count);
-
-    return (transfer_byte_count);
+    if ((iChannel >= 0) && (iChannel < USB_DMA_NUM_CHANNELS))
+    {
+        gpUsbDmaCh[iChannel].pf_complete = NULL;
+        gpUsbDmaCh[iChannel].pv_param = NULL;
+        gpUsbDmaCh[iChannel].bfBusy = false;
+    }
 }
 /******************************************************************************
- End of function dmaGetUsbOutCh0Count
+ End of function dmaFreeUsbChannel
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: dmaStopUsbOutCh0
- Description:   Function to stop a USB OUT DMA transfer on channel 0
- Parameters:    none
- Return value:  none
- *****************************************************************************/
-void dmaStopUsbOutCh0 (void)
-{
-    TRACE(("dmaStopUsbOutCh0: Called\r\n"));
-
-#if NESTED_SUPPORT
-    int_t imask = R_OS_SysLock(NULL);
-#endif
-
-    control(dma_usb_out_handle, CTL_DMAC_DISABLE, NULL);
+ Function Name: dmaStartUsbOut
+ Description:   Function to start a DMA channel for a USB OUT transfer
+ This is where the DMAC writes to the designated pipe FIFO.
 
-    if (gpfFreeVectUsbOutCh0)
-    {
-        gpfFreeVectUsbOutCh0();
-        gpfFreeVectUsbOutCh0 = NULL;
-    }
+ Direction: Buffer memory --> USB Channel
 
-#if NESTED_SUPPORT
-    R_OS_SysUnlock(NULL, imask);
-#endif
+ Arguments:
+ IN  iChannel - The channel returned by dmaAllocUsbChannel
+ IN  pvSrc - Pointer to the 4 byte aligned source memory
+ (CAUTION: If using internal SRAM ensure this is a *Mirrored Address* (6xxxxxxx)
+ native (2xxxxxxx) addresses corrupts data when DMA transfer crosses blocks)
+ IN  st_length - The length of data to transfer
+ IN  p_fifo - Pointer to the destination FIFO
+ IN  pv_param - Pointer to pass to the completion routine
+ IN  pf_complete - Pointer to the completion routine
+ Return value:  none
+ ******************************************************************************/
+void dmaStartUsbOut (int iChannel, void *pvSrc, size_t st_length, void *p_fifo, void *pv_param,
+        void (*pf_complete)(void *pv_param))
+{
+    R_CACHE_L1_CleanInvalidLine((uint32_t) pvSrc, st_length);
+    dmaStartUsb(iChannel, pvSrc, p_fifo, st_length, pv_param, pf_complete, true);
 }
 /******************************************************************************
- End of function dmaStopUsbOutCh0
+ End of function dmaStartUsbOut
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: dmaStartUsbInCh1
- Description:   Function to start DMA channel 1 for a USB IN transfer
- This is where the DMAC writes to the designated pipe FIFO.
- In this implementation the assignment is DMA Channel 1 always
- uses the USB D1FIFO.
+ Function Name: dmaStartUsbIn
+ Description:   Function to start a DMA channel for a USB IN transfer
+ This is where the DMAC reads from the designated pipe FIFO.
 
  Direction: USB Channel --> Buffer Memory
 
  Arguments:
+ IN  iChannel - The channel returned by dmaAllocUsbChannel
  IN  pv_dest - Pointer to the 4 byte aligned destination memory
  (CAUTION: If using internal SRAM ensure this is a *Mirrored Address* (6xxxxxxx)
  native (2xxxxxxx) addresses corrupts data when DMA transfer crosses blocks)
-
  IN  st_length - The length of data to transfer
  IN  p_fifo - Pointer to the source FIFO
  IN  pv_param - Pointer to pass to the completion routine
  IN  pf_complete - Pointer to the completion routine
  Return value:  none
  *****************************************************************************/
-void dmaStartUsbInCh1 (void *pv_dest, size_t st_length, void *p_fifo, void *pv_param, void (*pf_complete) (void *pv_param))
+void dmaStartUsbIn (int iChannel, void *pv_dest, size_t st_length, void *p_fifo, void *pv_param,
+        void (*pf_complete) (void *pv_param))
 {
-    static st_r_drv_dmac_config_t dma_config;
-
-#if NESTED_SUPPORT
-    int_t imask = R_OS_SysLock(NULL);
-#endif
-
-    /* check the DMA driver */
-    if (dma_usb_in_handle < 0)
-    {
-        return;
-    }
-
-    PUSBTR prequest = (PUSBTR) pv_param;
-
-    inch1_source = p_fifo;
-    inch1_destination = pv_dest;
-
-    /* configure the DMA transfer */
-    if ((&USB200) == prequest->pUSB)
-    {
-    	dma_config.config.resource = DMA_RS_USB0_DMA0_RX;
-        gpfFreeVectUsbInCh1 = dmaFreeVectD1FIFO0;
-    }
-    else
-    {
-    	dma_config.config.resource = DMA_RS_USB0_DMA1_RX;
-        gpfFreeVectUsbInCh1 = dmaFreeVectD1FIFO1;
-    }
-
     R_CACHE_L1_CleanInvalidLine((uint32_t) pv_dest, st_length);
-
-    dma_config.config.source_width = DMA_DATA_SIZE_4;                         /* DMA transfer unit size (source) - 32 bits */
-    dma_config.config.destination_width = DMA_DATA_SIZE_4;                    /* DMA transfer unit size (destination) - 32 bits */
-    dma_config.config.source_address_type = DMA_ADDRESS_FIX;                  /* DMA address type (source) */
-    dma_config.config.destination_address_type = DMA_ADDRESS_INCREMENT;       /* DMA address type (destination) */
-    dma_config.config.direction = DMA_REQUEST_SOURCE;                         /* DMA transfer direction will be set by the driver */
-    dma_config.config.source_address = p_fifo;                                /* Source Address */
-    dma_config.config.destination_address = pv_dest;                          /* Destination Address */
-    dma_config.config.count = st_length;                                      /* length */
-    dma_config.config.p_dmaComplete = INT_D1FIFO0_COMPLETE;                   /* set callback function (DMA end interrupt) */
-
-    control(dma_usb_in_handle, CTL_DMAC_SET_CONFIGURATION, (void *) &dma_config);
-
-    TRACE(("hwDmaif: DMA in len = 0x%.8lX to address 0x%.8lX Int: %d\r\n", gstTransferLengthCh1, pv_dest, 0));
-
-    /* Set the pipe number and completion routine */
-    pv_param_ch1 = pv_param;
-    gpf_complete1 = pf_complete;
-    gstTransferLengthCh1 = st_length;
-
-    /* Set the remainder which will need to be processed by another transfer */
-    gst_lengthCh1 = st_length - gstTransferLengthCh1;
-
-    /* trigger the DMA transfer */
-    control(dma_usb_in_handle, CTL_DMAC_ENABLE, NULL);
-
-#if NESTED_SUPPORT
-    R_OS_SysUnlock(NULL, imask);
-#endif
+    dmaStartUsb(iChannel, p_fifo, pv_dest, st_length, pv_param, pf_complete, false);
 }
 /******************************************************************************
- End of function dmaStartUsbInCh1
+ End of function dmaStartUsbIn
  ******************************************************************************/
 
 /******************************************************************************
- Function Name: dmaGetUsbInCh1Count
- Description:   Function to get the USB DMA transfer on channel 1
- Parameters:    none
+ Function Name: dmaGetUsbCount
+ Description:   Function to get the number of bytes the channel has still to
+                transfer
+ Parameters:    IN  iChannel - The channel number
  Return value:  The value of the transfer count register
  *****************************************************************************/
-unsigned long dmaGetUsbInCh1Count (void)
+unsigned long dmaGetUsbCount (int iChannel)
 {
-    uint32_t transfer_byte_count;
+    uint32_t transfer_byte_count = 0;
 
-    control(dma_usb_in_handle, CTL_DMAC_GET_TRANSFER_BYTE_COUNT, (void *) &transfer_byte_count);
+    if ((iChannel >= 0) && (iChannel < USB_DMA_NUM_CHANNELS))
+    {
+        control(gpUsbDmaCh[iChannel].iHandle, CTL_DMAC_GET_TRANSFER_BYTE_COUNT, (void *) &transfer_byte_count);
+    }
 
     return (transfer_byte_count);
 }
 /******************************************************************************
- End of function dmaGetUsbInCh1Count
+ End of function dmaGetUsbCount
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: dmaStopUsbInCh1
- Description:   Function to stop a USB OUT DMA transfer on channel 1
- Parameters:    none
+ Function Name: dmaStopUsb
+ Description:   Function to stop a USB DMA transfer. The channel remains
+                allocated until dmaFreeUsbChannel is called
+ Parameters:    IN  iChannel - The channel number
  Return value:  none
  *****************************************************************************/
-void dmaStopUsbInCh1 (void)
+void dmaStopUsb (int iChannel)
 {
-    TRACE(("dmaStopUsbInCh1: Called\r\n"));
+    uint32_t remaining_length;
 
-    control(dma_usb_in_handle, CTL_DMAC_DISABLE, NULL);
+    TRACE(("dmaStopUsb: Called %d\r\n", iChannel));
 
-    if (gpfFreeVectUsbInCh1)
+    if ((iChannel >= 0) && (iChannel < USB_DMA_NUM_CHANNELS))
     {
-        gpfFreeVectUsbInCh1();
-        gpfFreeVectUsbInCh1 = NULL;
+#if NESTED_SUPPORT
+        int_t imask = R_OS_SysLock(NULL);
+#endif
+
+        /* The driver will not disable the channel without somewhere to return
+           the remaining length */
+        control(gpUsbDmaCh[iChannel].iHandle, CTL_DMAC_DISABLE, (void *) &remaining_length);
+
+#if NESTED_SUPPORT
+        R_OS_SysUnlock(NULL, imask);
+#endif
     }
 }
 /******************************************************************************
- End of function dmaStopUsbInCh1
+ End of function dmaStopUsb
  *****************************************************************************/
 
 /******************************************************************************
@@ -429,44 +397,113 @@ void dmaStopUsbInCh1 (void)
  *****************************************************************************/
 
 /******************************************************************************
- * Function Name: dmaCompleteUsbCh0Out
- * Description  : Function to complete the USB DMA out transfer
- * Arguments    : none
+ * Function Name: dmaStartUsb
+ * Description  : Function to configure and start a channel
+ * Arguments    : IN  iChannel - The channel number
+ *                IN  pvSrc - The source address
+ *                IN  pvDest - The destination address
+ *                IN  st_length - The length of data to transfer
+ *                IN  pv_param - Pointer to pass to the completion routine
+ *                IN  pf_complete - Pointer to the completion routine
+ *                IN  bfOut - true for a transfer to the FIFO
  * Return Value : none
  *****************************************************************************/
-static void dmaCompleteUsbCh0Out (void)
+static void dmaStartUsb (int iChannel, void *pvSrc, void *pvDest, size_t st_length, void *pv_param,
+        void (*pf_complete)(void *pv_param), _Bool bfOut)
 {
-	/* Check to see if there is more data to be transferred */
-    if (gst_lengthCh0)
+    PUSBDMACH pDmaCh;
+    st_r_drv_dmac_config_t *p_config;
+
+    if ((iChannel < 0) || (iChannel >= USB_DMA_NUM_CHANNELS))
+    {
+        return;
+    }
+
+    pDmaCh = &gpUsbDmaCh[iChannel];
+    p_config = &pDmaCh->dma_config;
+
+    /* check the DMA driver */
+    if (pDmaCh->iHandle < 0)
+    {
+        return;
+    }
+
+#if NESTED_SUPPORT
+    int_t imask = R_OS_SysLock(NULL);
+#endif
+
+    /* Select the request source for the controller, FIFO port and direction */
+    if ((&USB200) == pDmaCh->pUSB)
     {
-        /* Start another transfer continuing with the same source and
-         destination addresses */
-        dmaStartUsbOutCh0(ch0out_source, gst_lengthCh0,
-        		          ch0out_destination, pv_param_ch0, gpf_complete0);
+        if (USBH_DMA_D0FIFO == pDmaCh->iFifo)
+        {
+            p_config->config.resource = bfOut ? DMA_RS_USB0_DMA0_TX : DMA_RS_USB0_DMA0_RX_D0FIFO;
+        }
+        else
+        {
+            p_config->config.resource = bfOut ? DMA_RS_USB0_DMA0_TX_D1FIFO : DMA_RS_USB0_DMA0_RX;
+        }
     }
     else
     {
-        /* If there is a completion routine */
-        if (gpf_complete0)
+        if (USBH_DMA_D0FIFO == pDmaCh->iFifo)
+        {
+            p_config->config.resource = bfOut ? DMA_RS_USB0_DMA1_TX : DMA_RS_USB0_DMA1_RX_D0FIFO;
+        }
+        else
         {
-            /* Call it */
-            gpf_complete0(pv_param_ch0);
+            p_config->config.resource = bfOut ? DMA_RS_USB0_DMA1_TX_D1FIFO : DMA_RS_USB0_DMA1_RX;
         }
     }
+
+    p_config->config.source_width = DMA_DATA_SIZE_4;                         /* DMA transfer unit size (source) - 32 bits */
+    p_config->config.destination_width = DMA_DATA_SIZE_4;                    /* DMA transfer unit size (destination) - 32 bits */
+    if (bfOut)
+    {
+        p_config->config.source_address_type = DMA_ADDRESS_INCREMENT;        /* DMA address type (source) */
+        p_config->config.destination_address_type = DMA_ADDRESS_FIX;         /* DMA address type (destination) */
+    }
+    else
+    {
+        p_config->config.source_address_type = DMA_ADDRESS_FIX;              /* DMA address type (source) */
+        p_config->config.destination_address_type = DMA_ADDRESS_INCREMENT;  /* DMA address type (destination) */
+    }
+    p_config->config.direction = DMA_REQUEST_SOURCE;                         /* DMA transfer direction will be set by the driver */
+    p_config->config.source_address = pvSrc;                                 /* Source Address */
+    p_config->config.destination_address = pvDest;                           /* Destination Address */
+    p_config->config.count = st_length;                                      /* length */
+    p_config->config.p_dmaComplete = gpfUsbDmaComplete[iChannel];            /* set callback function (DMA end interrupt) */
+
+    control(pDmaCh->iHandle, CTL_DMAC_SET_CONFIGURATION, (void *) p_config);
+
+    TRACE(("hwDmaif: DMA %d len = 0x%.8lX src 0x%.8lX dst 0x%.8lX\r\n", iChannel, st_length, pvSrc, pvDest));
+
+    /* Set the completion routine */
+    pDmaCh->pv_param = pv_param;
+    pDmaCh->pf_complete = pf_complete;
+
+    /* trigger the DMA transfer */
+    control(pDmaCh->iHandle, CTL_DMAC_ENABLE, NULL);
+
+#if NESTED_SUPPORT
+    R_OS_SysUnlock(NULL, imask);
+#endif
 }
 /******************************************************************************
- End of function dmaCompleteUsbCh0Out
+ End of function dmaStartUsb
  *****************************************************************************/
 
 /******************************************************************************
- * Function Name: dmaCompleteUsbCh1Indir
- * Description  : Function to complete the USB DMA in transfer
- * Arguments    : none
+ * Function Name: dmaCompleteUsb
+ * Description  : Function to complete a USB DMA transfer
+ * Arguments    : IN  iChannel - The channel number
  * Return Value : none
  *****************************************************************************/
-static void dmaCompleteUsbCh1In (void)
+static void dmaCompleteUsb (int iChannel)
 {
-    TRACE(("dmaCompleteUsbCh1In: Called\r\n"));
+    PUSBDMACH pDmaCh = &gpUsbDmaCh[iChannel];
+
+    TRACE(("dmaCompleteUsb: Called %d\r\n", iChannel));
 
     /*  Software Countermeasure for DMA Restrictions are not required because
      the following conditions are satisfied:
@@ -474,132 +511,76 @@ static void dmaCompleteUsbCh1In (void)
      2. The number of receive blocks matches the value set in the USB
      so that another transfer request is not generated until this
      interrupt handler is vectored */
-    /* Check to see if there is more data to be transferred */
-    if (gst_lengthCh1)
+    /* If there is a completion routine */
+    if (pDmaCh->pf_complete)
     {
-        /* Start another transfer continuing with the same source and
-         destination addresses */
-        dmaStartUsbInCh1(inch1_source, gst_lengthCh1,
-        		         inch1_destination, pv_param_ch1, gpf_complete1);
-    }
-    else
-    {
-        /* If there is a completion routine */
-        if (gpf_complete1)
-        {
-            /* Call it */
-            gpf_complete1(pv_param_ch1);
-        }
+        /* Call it */
+        pDmaCh->pf_complete(pDmaCh->pv_param);
     }
 }
 /******************************************************************************
- End of function dmaCompleteUsbCh1In
+ End of function dmaCompleteUsb
  *****************************************************************************/
 
 /******************************************************************************
- Function Name: INT_D1FIFO0_COMPLETE
- Description:   USB_D1FIFO0 (USB IN  - device to host) end of transfer
- interrupt
+ Function Name: INT_USB_DMA0_COMPLETE
+ Description:   End of transfer interrupt for USB DMA channel 0
  Parameters:    none
  Return value:  none
  ******************************************************************************/
-static void INT_D1FIFO0_COMPLETE (uint32_t dummy)
+static void INT_USB_DMA0_COMPLETE (uint32_t dummy)
 {
-    (void) dummy;
-    dmaCompleteUsbCh1In();
+    UNUSED_PARAM(dummy);
+    dmaCompleteUsb(0);
 }
 /******************************************************************************
- End of function INT_D1FIFO0_COMPLETE
+ End of function INT_USB_DMA0_COMPLETE
  ******************************************************************************/
 
 /******************************************************************************
- Function Name: INT_D0FIFO1_COMPLETE
- Description:   USB_D0FIFO1 (USB OUT  - host to device) end of transfer
- interrupt
+ Function Name: INT_USB_DMA1_COMPLETE
+ Description:   End of transfer interrupt for USB DMA channel 1
  Parameters:    none
  Return value:  none
  ******************************************************************************/
-static void INT_D0FIFO1_COMPLETE (uint32_t dummy)
+static void INT_USB_DMA1_COMPLETE (uint32_t dummy)
 {
-    (void) dummy;
-
-    dmaCompleteUsbCh0Out();
+    UNUSED_PARAM(dummy);
+    dmaCompleteUsb(1);
 }
 /******************************************************************************
- End of function  INT_D0FIFO1_COMPLETE
- *****************************************************************************/
+ End of function INT_USB_DMA1_COMPLETE
+ ******************************************************************************/
 
 /******************************************************************************
- Function Name: INT_D1FIFO1_COMPLETE
- Description:   USB_D1FIFO1 (USB IN  - device to host) end of transfer
- interrupt
+ Function Name: INT_USB_DMA2_COMPLETE
+ Description:   End of transfer interrupt for USB DMA channel 2
  Parameters:    none
  Return value:  none
- *****************************************************************************/
-static void INT_D1FIFO1_COMPLETE (uint32_t dummy)
+ ******************************************************************************/
+static void INT_USB_DMA2_COMPLETE (uint32_t dummy)
 {
     UNUSED_PARAM(dummy);
-    dmaCompleteUsbCh1In();
-}
-/******************************************************************************
- End of function  INT_D1FIFO1_COMPLETE
- *****************************************************************************/
-
-/******************************************************************************
- * Function Name: dmaFreeVectD0FIFO0
- * Description  : Function to free the D0FIFO0 vector
- * Arguments    : none
- * Return Value : none
- *****************************************************************************/
-static void dmaFreeVectD0FIFO0 (void)
-{
-    /* Do Nothing */
+    dmaCompleteUsb(2);
 }
 /******************************************************************************
- End of function  dmaFreeVectD0FIFO0
- *****************************************************************************/
-
-/******************************************************************************
- * Function Name: dmaFreeVectD0FIFO1
- * Description  : Function to free the D0FIFO1 vector
- * Arguments    : none
- * Return Value : none
+ End of function INT_USB_DMA2_COMPLETE
  ******************************************************************************/
-static void dmaFreeVectD0FIFO1 (void)
-{
-    /* Do Nothing */
-}
-/******************************************************************************
- End of function  dmaFreeVectD0FIFO1
- *****************************************************************************/
 
 /******************************************************************************
- * Function Name: dmaFreeVectD1FIFO0
- * Description  : Function to free the D1FIFO0 vector
- * Arguments    : none
- * Return Value : none
+ Function Name: INT_USB_DMA3_COMPLETE
+ Description:   End of transfer interrupt for USB DMA channel 3
+ Parameters:    none
+ Return value:  none
  ******************************************************************************/
-static void dmaFreeVectD1FIFO0 (void)
-{
-    /* Do Nothing */
-}
-/******************************************************************************
- End of function dmaFreeVectD1FIFO0
- *****************************************************************************/
-
-/******************************************************************************
- * Function Name: dmaFreeVectD1FIFO1
- * Description  : Function to free the D1FIFO1 vector
- * Arguments    : none
- * Return Value : none
- *****************************************************************************/
-static void dmaFreeVectD1FIFO1 (void)
+static void INT_USB_DMA3_COMPLETE (uint32_t dummy)
 {
-    /* Do Nothing */
+    UNUSED_PARAM(dummy);
+    dmaCompleteUsb(3);
 }
 /******************************************************************************
- End of function dmaFreeVectD1FIFO1
- *****************************************************************************/
+ End of function INT_USB_DMA3_COMPLETE
+ ******************************************************************************/
 
 /******************************************************************************
  End of file
@@ -55,6 +55,7 @@
 #include "usb_iobitmask.h"
 #include "usb20_iodefine.h"
 #include "rza_io_regrw.h"
+#include "hwDmaIf.h"
 
 #include "Trace.h"
 
@@ -248,6 +249,10 @@ static int_t usb_host_open (st_stream_ptr_t p_stream)
         /* Open the host driver */
         usbhOpen(&usb_hc0);
 
+        /* Open the DMA channels shared by the host controllers. Transfers
+         are performed by FIFO if none can be opened */
+        usbOpenDmaDriver();
+
         /* Add the root ports to the driver */
         usbhAddRootPort(&usb_hc0, (const PUSBPC)&g_c_root_port0);
 
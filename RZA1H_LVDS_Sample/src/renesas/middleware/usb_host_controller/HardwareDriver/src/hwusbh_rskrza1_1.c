@@ -59,6 +59,7 @@
 #include "usb_iobitmask.h"
 #include "usb20_iodefine.h"
 #include "rza_io_regrw.h"
+#include "hwDmaIf.h"
 
 #include "Trace.h"
 
@@ -346,6 +347,10 @@ static int_t usb_host_open (st_stream_ptr_t p_stream)
         /* Open the host driver */
         usbhOpen(&usb_hc1);
 
+        /* Open the DMA channels shared by the host controllers. Transfers
+         are performed by FIFO if none can be opened */
+        usbOpenDmaDriver();
+
         /* Add the root ports to the driver */
         usbhAddRootPort(&usb_hc1, (const PUSBPC)&g_c_root_port1);
 
@@ -436,10 +436,12 @@ static const size_t gpstPipeTrn[] =
 static void r_usbh_config_fifo (PUSB pUSB);
 #endif
 static int r_usbh_wait_fifo (PUSB pUSB, int iPipeNumber, int iCountOut);
+static int r_usbh_select_fifo (PUSB pUSB, int iPipeNumber, uint16_t usCFIFOSEL);
 static void r_usbh_init_pipes (PUSB pUSB);
 static void r_usbh_write_fifo (PUSB pUSB, void *pvSrc, size_t stLength);
 static void r_usbh_read_fifo (PUSB pUSB, void *pvDest, size_t stLength);
 static void r_usbh_cfiosel (PUSB pUSB, uint16_t usCFIFOSEL);
+static void r_usbh_dma_port (PUSB pUSB, int iDmaFifo, uint16_t usDFIFOSEL, _Bool bfEnable);
 
 /******************************************************************************
  Renesas Abstracted Host Driver API functions
@@ -996,6 +998,43 @@ void R_USBH_ClearPipeInterrupt (PUSB pUSB, int iPipeNumber, USBIP buffIntType)
  End of function  R_USBH_ClearPipeInterrupt
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: R_USBH_GetPipeInterruptMap
+ Description:   Function to get the pipes other than pipe 0 with an enabled
+ interrupt status flag set
+ Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+ IN  buffIntType - The interrupt type
+ Return value:  A bit map with bit n set for pipe n
+ ******************************************************************************/
+uint16_t R_USBH_GetPipeInterruptMap (PUSB pUSB, USBIP buffIntType)
+{
+    uint16_t wMap = 0;
+
+    switch (buffIntType)
+    {
+        case USBH_PIPE_BUFFER_EMPTY :
+            wMap = (uint16_t) (rza_io_reg_read_16(&pUSB->BEMPSTS, NO_SHIFT, GENERIC_16B_MASK) &
+                    rza_io_reg_read_16(&pUSB->BEMPENB, NO_SHIFT, GENERIC_16B_MASK));
+        break;
+        case USBH_PIPE_BUFFER_READY :
+            wMap = (uint16_t) (rza_io_reg_read_16(&pUSB->BRDYSTS, NO_SHIFT, GENERIC_16B_MASK) &
+                    rza_io_reg_read_16(&pUSB->BRDYENB, NO_SHIFT, GENERIC_16B_MASK));
+        break;
+        case USBH_PIPE_BUFFER_NOT_READY :
+            wMap = (uint16_t) (rza_io_reg_read_16(&pUSB->NRDYSTS, NO_SHIFT, GENERIC_16B_MASK) &
+                    rza_io_reg_read_16(&pUSB->NRDYENB, NO_SHIFT, GENERIC_16B_MASK));
+        break;
+        default :
+        break;
+    }
+
+    /* Pipe 0 is handled by the control transfer functions */
+    return (uint16_t) (wMap & (((1U << USBH_MAX_NUM_PIPES) - 1U) & ~1U));
+}
+/******************************************************************************
+ End of function  R_USBH_GetPipeInterruptMap
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: R_USBH_GetPipeInterrupt
  Description:   Function to get the state of the pipe interrupt status flag
@@ -1396,9 +1435,10 @@ size_t R_USBH_WritePipe (PUSB pUSB, int iPipeNumber, uint8_t *pbySrc, size_t stL
  Arguments:     IN  pUSB - Pointer to the Host Controller hardware
  IN  iPipeNumber - The pipe to configure
  IN  wNumPackets - The number of packets to be written
+ IN  iDmaFifo - The DMA FIFO port to use USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
  Return value:  0 for success -1 on error
  ******************************************************************************/
-int R_USBH_DmaWritePipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
+int R_USBH_DmaWritePipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets, int iDmaFifo)
 {
     UNUSED_PARAM(wNumPackets);
     if ((iPipeNumber > 0) && (iPipeNumber <= USBH_NUM_DMA_ENABLED_PIPES))
@@ -1424,17 +1464,9 @@ int R_USBH_DmaWritePipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
                         | USB_D0FIFOSEL_BIG_END
 #endif
 |        USB_D0FIFOSEL_CURPIPE(iPipeNumber));
-        USB_D0FIFOSEL(pUSB, usDFIFOSEL);
 
-        /* Enable DMA on this FIFO */
-        rza_io_reg_write_16(&pUSB->D0FIFOSEL, USB_DnFIFOSEL_DREQE, NO_SHIFT, (uint16_t)~GENERIC_16B_MASK);
-
-        /* Enable Transfer End Sampling - specific setting to dual core DMA */
-#if USBH_HIGH_SPEED_SUPPORT == 1
-
-        /* Enable Transfer End Sampling */
-        rza_io_reg_write_16(&pUSB->D0FBCFG, USB_DnFBCFG_TENDE, NO_SHIFT, GENERIC_16B_MASK);
-#endif
+        /* Assign the pipe to the DMA FIFO port and enable DMA requests */
+        r_usbh_dma_port(pUSB, iDmaFifo, usDFIFOSEL, true);
 
         /* Enable the transaction counter */
         USB_PIPETRE(pUSB, iPipeNumber)->BIT.TRENB = 0;
@@ -1450,16 +1482,15 @@ int R_USBH_DmaWritePipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
  Function Name: R_USBH_StopDmaPipe
  Description:   Function to unconfigure a pipe from a DMA transfer
  Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+ IN  iDmaFifo - The DMA FIFO port used by the transfer
  Return value:  none
  ******************************************************************************/
-void R_USBH_StopDmaPipe (PUSB pUSB)
+void R_USBH_StopDmaPipe (PUSB pUSB, int iDmaFifo)
 {
-
 #if USBH_FIFO_BIT_WIDTH == 32
-    USB_D0FIFOSEL(pUSB, USB_CFIFOSEL_MBW_FUNC(2));
-    rza_io_reg_write_16(&pUSB->D0FBCFG, 0x0, USB_DnFBCFG_TENDE_SHIFT, USB_DnFBCFG_TENDE);        /* Disable DMA Transfer End Sampling */
+    r_usbh_dma_port(pUSB, iDmaFifo, USB_CFIFOSEL_MBW_FUNC(2), false);
 #else
-    USB_D0FIFOSEL(pUSB, USB_CFIFOSEL_MBW_FUNC(1));
+    r_usbh_dma_port(pUSB, iDmaFifo, USB_CFIFOSEL_MBW_FUNC(1), false);
 #endif
 }
 /******************************************************************************
@@ -1483,7 +1514,6 @@ void R_USBH_StopDmaPipe (PUSB pUSB)
 size_t R_USBH_ReadPipe (PUSB pUSB, int iPipeNumber, uint8_t *pbyDest, size_t stLength)
 {
     size_t stAvailable;
-    int iReadFIFOStuck = 100;
     uint16_t usCFIFOSEL = (uint16_t) (
 #if USBH_FIFO_BIT_WIDTH == 32
             USB_CFIFOSEL_MBW_FUNC(2)
@@ -1501,30 +1531,19 @@ size_t R_USBH_ReadPipe (PUSB pUSB, int iPipeNumber, uint8_t *pbyDest, size_t stL
         ; /* Wait for the pipe to stop action */
     }
 
-    /* Select the FIFO */
-    USB_CFIFOSEL(pUSB, usCFIFOSEL);
-
-    /* Wait for access to FIFO */
-    while ( (rza_io_reg_read_16(&pUSB->CFIFOSEL, USB_CFIFOSEL_CURPIPE_SHIFT, USB_CFIFOSEL_CURPIPE) != iPipeNumber) ||
-            (rza_io_reg_read_16(&pUSB->CFIFOCTR, USB_CFIFOCTR_FRDY_SHIFT, USB_CFIFOCTR_FRDY) == 0) )
+    /* Select the FIFO and wait for access to it */
+    if (r_usbh_select_fifo(pUSB, iPipeNumber, usCFIFOSEL))
     {
-        USB_CFIFOSEL(pUSB, usCFIFOSEL);
+        TRACE(("FIFO Stuck %d\r\n", iPipeNumber));
 
-        /* Prevent from getting stuck in this loop */
-        iReadFIFOStuck--;
-        if (!iReadFIFOStuck)
-        {
-            TRACE(("FIFO Stuck %d\r\n", iReadFIFOStuck));
-
-            /* Clear the pipe */
-            USB_PIPECTR(pUSB, iPipeNumber)->BIT.PID = 0;
-            rza_io_reg_write_16(&pUSB->CFIFOCTR, 0x1, USB_CFIFOCTR_BCLR_SHIFT, USB_CFIFOCTR_BCLR);
-            USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 1;
-            USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 0;
-            USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 1;
-            USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 0;
-            return -1UL;
-        }
+        /* Clear the pipe */
+        USB_PIPECTR(pUSB, iPipeNumber)->BIT.PID = 0;
+        rza_io_reg_write_16(&pUSB->CFIFOCTR, 0x1, USB_CFIFOCTR_BCLR_SHIFT, USB_CFIFOCTR_BCLR);
+        USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 1;
+        USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 0;
+        USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 1;
+        USB_PIPECTR(pUSB, iPipeNumber)->BIT.ACLRM = 0;
+        return -1UL;
     }
     USB_PIPECTR(pUSB, iPipeNumber)->BIT.PID = 0;
 
@@ -1573,8 +1592,6 @@ size_t R_USBH_ReadPipe (PUSB pUSB, int iPipeNumber, uint8_t *pbyDest, size_t stL
  ******************************************************************************/
 int R_USBH_DataInFIFO (PUSB pUSB, int iPipeNumber)
 {
-
-    int iReadFIFOStuck = 100;
     uint16_t usCFIFOSEL = (uint16_t) (
 #if USBH_FIFO_BIT_WIDTH == 32
             USB_CFIFOSEL_MBW_FUNC(2)
@@ -1595,19 +1612,10 @@ int R_USBH_DataInFIFO (PUSB pUSB, int iPipeNumber)
         /* Wait for the pipe to stop action */
     }
 
-    /* Select the FIFO */
-    USB_CFIFOSEL(pUSB, usCFIFOSEL);
-
-    /* Wait for access to FIFO */
-    while ( (rza_io_reg_read_16(&pUSB->CFIFOSEL, USB_CFIFOSEL_CURPIPE_SHIFT, USB_CFIFOSEL_CURPIPE) != iPipeNumber) ||
-            (rza_io_reg_read_16(&pUSB->CFIFOCTR, USB_CFIFOCTR_FRDY_SHIFT, USB_CFIFOCTR_FRDY) == 0) )
+    /* Select the FIFO and wait for access to it */
+    if (r_usbh_select_fifo(pUSB, iPipeNumber, usCFIFOSEL))
     {
-        /* Prevent from getting stuck in this loop */
-        iReadFIFOStuck--;
-        if (!iReadFIFOStuck)
-        {
-            return -1;
-        }
+        return -1;
     }
     return (int) rza_io_reg_read_16(&pUSB->CFIFOCTR, USB_CFIFOCTR_DTLN_SHIFT, USB_CFIFOCTR_DTLN);
 }
@@ -1621,14 +1629,15 @@ int R_USBH_DataInFIFO (PUSB pUSB, int iPipeNumber)
  Arguments:     IN  pUSB - Pointer to the Host Controller hardware
  IN  iPipeNumber - The pipe to configure
  IN  wNumPackets - The number of packets to be read
+ IN  iDmaFifo - The DMA FIFO port to use USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
  Return value:  0 for success -1 on error
  ******************************************************************************/
-int R_USBH_DmaReadPipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
+int R_USBH_DmaReadPipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets, int iDmaFifo)
 {
     /* DMA only available on pipes 1, 2, 3, 4 and 5 - Pipes 6 - 9 the DMA can
      only fill one packet (Interrupt transfers) and another function
      should be written to handle DMA transfers on these pipes */
-    if ((iPipeNumber > 0) && (iPipeNumber < 6))
+    if (R_USBH_DmaPipe(iPipeNumber))
     {
         uint16_t usDFIFOSEL;
 
@@ -1647,6 +1656,14 @@ int R_USBH_DmaReadPipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
          */
         rza_io_reg_write_16(&pUSB->PIPECFG, 0x1, USB_PIPECFG_DBLB_SHIFT, USB_PIPECFG_DBLB);
 #endif
+        /* Set the pipe to NAK when the transaction counter expires or a short
+         packet is received. The SIE then stops issuing IN tokens at the end
+         of the transfer and no data belonging to the next transfer can be
+         accepted into the double buffered FIFO. Should the pipe later be
+         used for a FIFO transfer this is harmless, since that transfer also
+         ends on a short packet */
+        rza_io_reg_write_16(&pUSB->PIPECFG, 0x1, USB_PIPECFG_SHTNAK_SHIFT, USB_PIPECFG_SHTNAK);
+
         /* Disable the transaction counter */
         USB_PIPETRE(pUSB, iPipeNumber)->BIT.TRENB = 0;
 
@@ -1668,16 +1685,9 @@ int R_USBH_DmaReadPipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
                         | USB_D0FIFOSEL_BIG_END
 #endif
 |        USB_D0FIFOSEL_CURPIPE(iPipeNumber));
-        USB_D1FIFOSEL(pUSB, usDFIFOSEL);
 
-        /* Enable DMA on this FIFO */
-        rza_io_reg_write_16(&pUSB->D1FIFOSEL, USB_DnFIFOSEL_DREQE, NO_SHIFT, (uint16_t)~GENERIC_16B_MASK);
-#if USBH_HIGH_SPEED_SUPPORT == 1
-
-        /* Enable Transfer End Sampling */
-        rza_io_reg_write_16(&pUSB->D1FBCFG, USB_DnFBCFG_TENDE, NO_SHIFT, GENERIC_16B_MASK);
-
-#endif
+        /* Assign the pipe to the DMA FIFO port and enable DMA requests */
+        r_usbh_dma_port(pUSB, iDmaFifo, usDFIFOSEL, true);
 
         /* Enable the transaction counter */
         USB_PIPETRE(pUSB, iPipeNumber)->BIT.TRENB = 1;
@@ -1690,35 +1700,17 @@ int R_USBH_DmaReadPipe (PUSB pUSB, int iPipeNumber, uint16_t wNumPackets)
  End of function  R_USBH_DmaReadPipe
  ******************************************************************************/
 
-/******************************************************************************
- Function Name: R_USBH_StopDmaReadPipe
- Description:   Function to unconfigure a pipe from a DMA read
- Arguments:     IN  pUSB - Pointer to the Host Controller hardware
- Return value:  none
- ******************************************************************************/
-void R_USBH_StopDmaReadPipe (PUSB pUSB)
-{
-#if USBH_FIFO_BIT_WIDTH == 32
-    USB_D1FIFOSEL(pUSB, USB_CFIFOSEL_MBW_FUNC(2));
-#else
-    USB_D1FIFOSEL(pUSB, USB_CFIFOSEL_MBW_FUNC(1));
-#endif
-}
-/******************************************************************************
- End of function  R_USBH_StopDmaReadPipe
- ******************************************************************************/
-
 /******************************************************************************
  Function Name: R_USBH_DmaFIFO
  Description:   Function to get a pointer to the DMA FIFO
  Arguments:     IN  pUSB - Pointer to the Host Controller hardware
- IN  transferDirection - The direction of transfer
+ IN  iDmaFifo - The DMA FIFO port USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
  Return value:  Pointer to the DMA FIFO
  ******************************************************************************/
-void *R_USBH_DmaFIFO (PUSB pUSB, USBDIR transferDirection)
+void *R_USBH_DmaFIFO (PUSB pUSB, int iDmaFifo)
 {
 
-    if (transferDirection)
+    if (USBH_DMA_D1FIFO == iDmaFifo)
     {
         return (void*) &pUSB->D1FIFO;
     }
@@ -1752,6 +1744,40 @@ uint16_t R_USBH_DmaTransac (PUSB pUSB, int iPipeNumber)
  End of function  R_USBH_DmaTransac
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: R_USBH_DmaPipe
+ Description:   Function to check that a pipe can be serviced by the DMAC
+ Arguments:     IN  iPipeNumber - The number of the pipe
+ Return value:  true if the D0FIFO / D1FIFO can be assigned to the pipe
+ ******************************************************************************/
+_Bool R_USBH_DmaPipe (int iPipeNumber)
+{
+    return (_Bool) ((iPipeNumber > 0) && (iPipeNumber <= USBH_NUM_DMA_ENABLED_PIPES));
+}
+/******************************************************************************
+ End of function  R_USBH_DmaPipe
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: R_USBH_PipeBufferReady
+ Description:   Function to check the buffer status of a pipe without
+ selecting it on a FIFO port
+ Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+ IN  iPipeNumber - The number of the pipe
+ Return value:  true if the pipe buffer can be accessed by the CPU
+ ******************************************************************************/
+_Bool R_USBH_PipeBufferReady (PUSB pUSB, int iPipeNumber)
+{
+    if ((iPipeNumber > 0) && (iPipeNumber < USBH_MAX_NUM_PIPES))
+    {
+        return (_Bool) USB_PIPECTR(pUSB, iPipeNumber)->BIT.BSTS;
+    }
+    return false;
+}
+/******************************************************************************
+ End of function  R_USBH_PipeBufferReady
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: R_USBH_SetDevAddrCfg
  Description:   Function to set the appropriate Device Address Configuration
@@ -2032,6 +2058,49 @@ static int r_usbh_wait_fifo (PUSB pUSB, int iPipeNumber, int iCountOut)
  End of function  r_usbh_wait_fifo
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: r_usbh_select_fifo
+ Description:   Function to switch the CFIFO port to a pipe and wait for the
+ FRDY bit. CFIFOSEL is written once only: writing it again
+ while the switch is in progress restarts the switch, so the
+ register is polled rather than re-written.
+ This is a bounded busy poll, and it has to be. The controller
+ raises no interrupt when CURPIPE changes or FRDY sets, and the
+ hardware manual requires CURPIPE and FRDY to be read back
+ before the port is accessed. The switch takes a few USB clock
+ cycles, so USBH_FIFO_READY_POLL reads are enough unless the
+ pipe is stuck. Transfers at or above USBH_DMA_THRESHOLD use
+ the D0FIFO/D1FIFO ports and do not come here; this is only
+ for the control pipe, short transfers and short tails.
+ Parameters:    IN  pUSB - Pointer to the Host Controller hardware
+ IN  iPipeNumber - The pipe number
+ IN  usCFIFOSEL - The value for the CFIFOSEL register
+ Return value:  0 for success -1 if the FIFO did not become ready
+ ******************************************************************************/
+static int r_usbh_select_fifo (PUSB pUSB, int iPipeNumber, uint16_t usCFIFOSEL)
+{
+    int iCountOut = USBH_FIFO_READY_POLL;
+
+    /* Select the FIFO */
+    USB_CFIFOSEL(pUSB, usCFIFOSEL);
+
+    /* Wait for access to FIFO, there is no interrupt for this */
+    while ((rza_io_reg_read_16(&pUSB->CFIFOSEL, USB_CFIFOSEL_CURPIPE_SHIFT, USB_CFIFOSEL_CURPIPE) != iPipeNumber) ||
+            (rza_io_reg_read_16(&pUSB->CFIFOCTR, USB_CFIFOCTR_FRDY_SHIFT, USB_CFIFOCTR_FRDY) == 0))
+    {
+        /* Prevent from getting stuck in this loop */
+        iCountOut--;
+        if (!iCountOut)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+/******************************************************************************
+ End of function  r_usbh_select_fifo
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: r_usbh_config_fifo
  Description:   Function to configure the FIFO buffer allocation
@@ -2099,6 +2168,7 @@ static void r_usbh_write_fifo (PUSB pUSB, void *pvSrc, size_t stLength)
             size_t stDwords;
             /* Peripheral with 32 bit access to FIFO */
             uint32_t *pulSrc = pvSrc;
+            volatile uint32_t *pulFifo = (volatile uint32_t *) &pUSB->CFIFO;
 
             /* Calculate the number of DWORDS */
             stDwords = stLength >> 2;
@@ -2106,10 +2176,21 @@ static void r_usbh_write_fifo (PUSB pUSB, void *pvSrc, size_t stLength)
             /* Calculate the number of BYTES */
             stBytes = stLength - (stDwords << 2);
 
-            /* Write the DWORDs */
+            /* Write the DWORDs. The whole register is the FIFO port so it is
+             written directly, a read-modify-write would cost a FIFO read for
+             every DWORD written. Unroll by four to cut the loop overhead */
+            while (stDwords >= 4)
+            {
+                *pulFifo = pulSrc[0];
+                *pulFifo = pulSrc[1];
+                *pulFifo = pulSrc[2];
+                *pulFifo = pulSrc[3];
+                pulSrc += 4;
+                stDwords -= 4;
+            }
             while (stDwords--)
             {
-                rza_io_reg_write_32((uint32_t *)&pUSB->CFIFO, *pulSrc++, USB_CFIFO_FIFOPORT_SHIFT, USB_CFIFO_FIFOPORT);
+                *pulFifo = *pulSrc++;
             }
 
             /* If there are bytes */
@@ -2214,13 +2295,42 @@ static void r_usbh_read_fifo (PUSB pUSB, void *pvDest, size_t stLength)
     if ((pUSB) && (pvDest))
     {
         uint8_t *pbyDest = (uint8_t*) pvDest;
+        volatile uint32_t *pulFifo = (volatile uint32_t *) &pUSB->CFIFO;
+
+        /* When the destination is DWORD aligned the FIFO data is stored
+         directly. The byte order of the port follows the BIGEND setting so
+         this is the same as unpacking each DWORD a byte at a time */
+        if (((size_t) pvDest & 3UL) == 0)
+        {
+            uint32_t *pulDest = (uint32_t*) pvDest;
+            size_t stDwords = stLength >> 2;
+
+            /* Unroll by four to cut the loop overhead */
+            while (stDwords >= 4)
+            {
+                pulDest[0] = *pulFifo;
+                pulDest[1] = *pulFifo;
+                pulDest[2] = *pulFifo;
+                pulDest[3] = *pulFifo;
+                pulDest += 4;
+                stDwords -= 4;
+            }
+            while (stDwords--)
+            {
+                *pulDest++ = *pulFifo;
+            }
+
+            /* Leave any remaining bytes to be unpacked below */
+            pbyDest = (uint8_t*) pulDest;
+            stLength &= 3UL;
+        }
 
         /* Adjust the length for a number of DWORDS */
         while (stLength)
         {
             uint32_t data;
             uint32_t loop;
-            data = rza_io_reg_read_32((uint32_t *)&pUSB->CFIFO, USB_CFIFO_FIFOPORT_SHIFT, USB_CFIFO_FIFOPORT);
+            data = *pulFifo;
             for (loop = 0; loop < sizeof(uint32_t); loop++)
             {
                 if(stLength)
@@ -2301,6 +2411,55 @@ static void r_usbh_cfiosel (PUSB pUSB, uint16_t usCFIFOSEL)
  End of function  r_usbh_cfiosel
  ******************************************************************************/
 
+/******************************************************************************
+ * Function Name: r_usbh_dma_port
+ * Description  : Function to assign a pipe to, or release a pipe from, one of
+ *                the two DMA FIFO ports
+ * Arguments    : IN  pUSB - Pointer to the USB hardware
+ *                IN  iDmaFifo - USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
+ *                IN  usDFIFOSEL - The value for the DnFIFOSEL register
+ *                IN  bfEnable - true to enable DMA requests and transfer end
+ *                               sampling, false to disable them
+ * Return Value : none
+ ******************************************************************************/
+static void r_usbh_dma_port (PUSB pUSB, int iDmaFifo, uint16_t usDFIFOSEL, _Bool bfEnable)
+{
+    volatile uint16_t *pusDFIFOSEL;
+    volatile uint16_t *pusDFBCFG;
+
+    if (USBH_DMA_D1FIFO == iDmaFifo)
+    {
+        USB_D1FIFOSEL(pUSB, usDFIFOSEL);
+        pusDFIFOSEL = &pUSB->D1FIFOSEL;
+        pusDFBCFG = &pUSB->D1FBCFG;
+    }
+    else
+    {
+        USB_D0FIFOSEL(pUSB, usDFIFOSEL);
+        pusDFIFOSEL = &pUSB->D0FIFOSEL;
+        pusDFBCFG = &pUSB->D0FBCFG;
+    }
+
+    if (bfEnable)
+    {
+        /* Enable DMA on this FIFO */
+        rza_io_reg_write_16(pusDFIFOSEL, USB_DnFIFOSEL_DREQE, NO_SHIFT, (uint16_t)~GENERIC_16B_MASK);
+#if USBH_HIGH_SPEED_SUPPORT == 1
+
+        /* Enable Transfer End Sampling */
+        rza_io_reg_write_16(pusDFBCFG, USB_DnFBCFG_TENDE, NO_SHIFT, GENERIC_16B_MASK);
+#endif
+    }
+    else
+    {
+        /* Disable DMA Transfer End Sampling */
+        rza_io_reg_write_16(pusDFBCFG, 0x0, USB_DnFBCFG_TENDE_SHIFT, USB_DnFBCFG_TENDE);
+    }
+}
+/*****************************************************************************
+ End of function  r_usbh_dma_port
+ ******************************************************************************/
+
 /******************************************************************************
  End  Of File
  ******************************************************************************/
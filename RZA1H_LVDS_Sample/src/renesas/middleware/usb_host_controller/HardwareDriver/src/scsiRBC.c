@@ -63,6 +63,11 @@
 #define SCSI_WRITE_10               0x2A
 /* SCSI_VERIFY_10: Not used by this code */
 #define SCSI_VERIFY_10              0x2F
+/* 16 byte commands from SBC-3 for media with more than 2^32 blocks */
+#define SCSI_READ_16                0x88
+#define SCSI_WRITE_16               0x8A
+#define SCSI_SERVICE_ACTION_IN_16   0x9E
+#define SCSI_SA_READ_CAPACITY_16    0x10
 /* Commands from the SPC-2 requied for RBC devices */
 #define SCSI_INQUIRY                0x12
 #define SCSI_TEST_UNIT_READY        0x00
@@ -112,6 +117,10 @@
 /* 29h 00h DT LPWROMAEBKVF POWER ON, RESET, OR BUS DEVICE RESET OCCURRED */
 #define SCSI_SENSE_MNP_BUS_RESET    SCSI_SENSE(0x06, 0x29, 0x00)
 
+/* The time allowed for a transfer is extended by 1mS for each kB so that
+   large transfers do not time out at full speed */
+#define SCSI_TRANSFER_TIME_OUT(t, l) ((t) + (uint32_t) ((l) >> 10))
+
 /******************************************************************************
  Function Macros
  ******************************************************************************/
@@ -224,6 +233,40 @@ const MSCMD USB_MS_SCSI_READ_CAPACITY_10 =
     8000UL /* Time out (ms) */
 };
 
+const MSCMD USB_MS_SCSI_READ_16 =
+{
+    (int8_t *) "READ 16",
+    {
+        SCSI_READ_16, 0x00, /* Flags */
+        0x00, 0x00, 0x00, 0x00, /* Logical Block Address MSB-LSB */
+        0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x01, /* Transfer length MSB-LSB in blocks*/
+        0x00, /* Group number */
+        0x00 /* Control */
+    },
+    16, /* Length of the command block */
+    USB_MS_DIRECTION_IN, /* Transfer direction is IN */
+    512, /* The length of data (in bytes) - to be set*/
+    8000UL /* Time out (ms) */
+};
+
+const MSCMD USB_MS_SCSI_READ_CAPACITY_16 =
+{
+    (int8_t *) "READ CAPACITY 16",
+    {
+        SCSI_SERVICE_ACTION_IN_16, SCSI_SA_READ_CAPACITY_16, /* Service action */
+        0x00, 0x00, 0x00, 0x00, /* Obsolete */
+        0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x20, /* Allocation length */
+        0x00, /* Reserved */
+        0x00 /* Control */
+    },
+    16, /* Length of the command block */
+    USB_MS_DIRECTION_IN, /* Transfer direction is IN */
+    32, /* The length of data */
+    8000UL /* Time out (ms) */
+};
+
 const MSCMD USB_MS_START_UNIT =
 {
     (int8_t *) "START",
@@ -270,6 +313,23 @@ const MSCMD USB_MS_WRITE_10 =
     8000UL /* Time out (ms) */
 };
 
+const MSCMD USB_MS_WRITE_16 =
+{
+    (int8_t *) "WRITE 16",
+    {
+        SCSI_WRITE_16, 0x00, /* Force Unit Access BIT_3 */
+        0x00, 0x00, 0x00, 0x00, /* Logical Block Address MSB-LSB */
+        0x00, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x01, /* Transfer length MSB-LSB in blocks*/
+        0x00, /* Group number */
+        0x00 /* Control */
+    },
+    16, /* Length of the command block */
+    USB_MS_DIRECTION_OUT, /* Transfer direction is OUT */
+    512, /* The length of data (in bytes) - to be set */
+    8000UL /* Time out (ms) */
+};
+
 const MSCMD USB_MS_SCSI_UNIT_READY =
 {
     (int8_t *) "TEST UNIT READY",
@@ -363,6 +423,37 @@ const MSCMD USB_MS_SCSI_ALLW_REMOVAL =
     8000UL /* Time out (ms) */
 };
 
+/******************************************************************************
+ Private Functions
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: scsiSetBlocks16
+ Description:   Function to set the LBA and transfer length of a 16 byte
+                command. The fields are written a byte at a time so this
+                works for either endian
+ Arguments:     IN  pbyCB - Pointer to the command block
+ IN  qwLBA - The logical block address
+ IN  dwNumBlocks - The number of blocks
+ Return value:  none
+ ******************************************************************************/
+static void scsiSetBlocks16 (uint8_t *pbyCB, uint64_t qwLBA, uint32_t dwNumBlocks)
+{
+    int iByte;
+
+    for (iByte = 0; iByte < 8; iByte++)
+    {
+        pbyCB[2 + iByte] = (uint8_t) (qwLBA >> (56 - (iByte * 8)));
+    }
+    pbyCB[10] = (uint8_t) (dwNumBlocks >> 24);
+    pbyCB[11] = (uint8_t) (dwNumBlocks >> 16);
+    pbyCB[12] = (uint8_t) (dwNumBlocks >> 8);
+    pbyCB[13] = (uint8_t) (dwNumBlocks >> 0);
+}
+/******************************************************************************
+ End of function  scsiSetBlocks16
+ ******************************************************************************/
+
 /******************************************************************************
  Public Functions
  ******************************************************************************/
@@ -408,6 +499,7 @@ int scsiRead10 (int iMsDev, int iLun, uint32_t dwLBA, uint16_t wNumBlocks, uint8
 
     /* Set the length of the destination memory */
     msCmd.stTransferLength = stDestLength;
+    msCmd.dwTimeOut = SCSI_TRANSFER_TIME_OUT(msCmd.dwTimeOut, stDestLength);
 
     /* Issue the read command */
     do
@@ -423,6 +515,47 @@ int scsiRead10 (int iMsDev, int iLun, uint32_t dwLBA, uint16_t wNumBlocks, uint8
  End of function  scsiRead10
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: scsiRead16
+ Description:   Function to read from the media with the 16 byte command.
+                Required for LBAs above 32 bits and allows more than 65535
+                blocks in one command
+ Arguments:     IN  iMsDev - The mass storage device file descriptor
+ IN  iLun - The logical uint number
+ IN  qwLBA - The logical block address
+ IN  dwNumBlocks - The number of blocks
+ OUT pbyDest - Pointer to the destination memory
+ IN  stDestLength - The length of the destination memory
+ OUT pstLengthRead - Pointer to the length of data read in bytes
+ Return value:  0 for success otherwise error code
+ ******************************************************************************/
+int scsiRead16 (int iMsDev, int iLun, uint64_t qwLBA, uint32_t dwNumBlocks, uint8_t *pbyDest, size_t stDestLength,
+        size_t *pstLengthRead)
+{
+    MSCMD msCmd = USB_MS_SCSI_READ_16;
+    int iTry = 3;
+
+    /* The LUN is carried by the Bulk-Only CBW, byte 1 holds flags */
+    scsiSetBlocks16(msCmd.pbyCB, qwLBA, dwNumBlocks);
+
+    /* Set the length of the destination memory */
+    msCmd.stTransferLength = stDestLength;
+    msCmd.dwTimeOut = SCSI_TRANSFER_TIME_OUT(msCmd.dwTimeOut, stDestLength);
+
+    /* Issue the read command */
+    do
+    {
+        if (!usbMsCommand(iMsDev, iLun, &msCmd, pbyDest, pstLengthRead))
+        {
+            return SCSI_OK;
+        } TRACE(("scsiRead16: Error in command %d\r\n", iTry));
+    } while (iTry--);
+    return SCSI_COMMAND_ERROR;
+}
+/******************************************************************************
+ End of function  scsiRead16
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: scsiReadCapacity10
  Description:   Function to read the capacity of the medium
@@ -472,6 +605,52 @@ int scsiReadCapacity10 (int iMsDev, int iLun, uint32_t * pdwNumBlocks, uint32_t
  End of function  scsiReadCapacity10
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: scsiReadCapacity16
+ Description:   Function to read the capacity of the medium with the 16 byte
+                command. Used when READ CAPACITY 10 reports 0xFFFFFFFF
+ Arguments:     IN  iMsDev - The mass storage device file descriptor
+ IN  iLun - The logical uint number
+ OUT pqwNumBlocks - Pointer to the number of blocks
+ OUT pdwBlockSize - Pointer to the length of the block
+ Return value:  0 for success otherwise error code
+ ******************************************************************************/
+int scsiReadCapacity16 (int iMsDev, int iLun, uint64_t * pqwNumBlocks, uint32_t * pdwBlockSize)
+{
+    uint8_t pbyPacket[32];
+    UMSERR umsErr;
+    int iByte;
+    uint64_t qwLastLBA = 0;
+
+    /* Issue the capacity command */
+    umsErr = usbMsCommand(iMsDev, iLun, (PMSCMD) &USB_MS_SCSI_READ_CAPACITY_16, pbyPacket, NULL);
+    if (umsErr)
+    {
+        TRACE(("scsiReadCapacity16: Error in command\r\n"));
+        return SCSI_COMMAND_ERROR;
+    }
+
+    /* The returned LBA and block length are big endian */
+    for (iByte = 0; iByte < 8; iByte++)
+    {
+        qwLastLBA = (qwLastLBA << 8) | pbyPacket[iByte];
+    }
+    if (pqwNumBlocks)
+    {
+        /* Add one to convert from last block address to number of blocks */
+        *pqwNumBlocks = qwLastLBA + 1;
+    }
+    if (pdwBlockSize)
+    {
+        *pdwBlockSize = ((uint32_t) pbyPacket[8] << 24) | ((uint32_t) pbyPacket[9] << 16)
+                      | ((uint32_t) pbyPacket[10] << 8) | (uint32_t) pbyPacket[11];
+    }
+    return SCSI_OK;
+}
+/******************************************************************************
+ End of function  scsiReadCapacity16
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: scsiStartStopUnit
  Description:   Function to start and stop the unit
@@ -542,6 +721,7 @@ int scsiWrite10 (int iMsDev, int iLun, uint32_t dwLBA, uint16_t wNumBlocks, cons
 #endif
     /* Set the length of the source memory */
     msCmd.stTransferLength = stSrcLength;
+    msCmd.dwTimeOut = SCSI_TRANSFER_TIME_OUT(msCmd.dwTimeOut, stSrcLength);
     /* Issue the write command */
     if (usbMsCommand(iMsDev, iLun, &msCmd, (void *)pbySrc, pstLengthWritten))
     {
@@ -557,6 +737,48 @@ int scsiWrite10 (int iMsDev, int iLun, uint32_t dwLBA, uint16_t wNumBlocks, cons
  End of function  scsiWrite10
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: scsiWrite16
+ Description:   Function to write to the media with the 16 byte command.
+                Required for LBAs above 32 bits and allows more than 65535
+                blocks in one command
+ Arguments:     IN  iMsDev - The mass storage device file descriptor
+ IN  iLun - The logical uint number
+ IN  qwLBA - The logical block address
+ IN  dwNumBlocks - The number of blocks
+ OUT pbySrc - Pointer to the source memory
+ IN  stSrcLength - The length of the source memory
+ OUT pstLengthWritten - Pointer to the length of data written in
+ bytes
+ Return value:  0 for success otherwise error code
+ ******************************************************************************/
+int scsiWrite16 (int iMsDev, int iLun, uint64_t qwLBA, uint32_t dwNumBlocks, const uint8_t *  pbySrc,
+        size_t stSrcLength, size_t *pstLengthWritten)
+{
+    MSCMD msCmd = USB_MS_WRITE_16;
+
+    /* The LUN is carried by the Bulk-Only CBW, byte 1 holds flags */
+    scsiSetBlocks16(msCmd.pbyCB, qwLBA, dwNumBlocks);
+
+    /* Set the length of the source memory */
+    msCmd.stTransferLength = stSrcLength;
+    msCmd.dwTimeOut = SCSI_TRANSFER_TIME_OUT(msCmd.dwTimeOut, stSrcLength);
+
+    /* Issue the write command */
+    if (usbMsCommand(iMsDev, iLun, &msCmd, (void *)pbySrc, pstLengthWritten))
+    {
+        TRACE(("scsiWrite16: Command error\r\n"));
+        return SCSI_COMMAND_ERROR;
+    }
+
+    TRACE(("scsiWrite16: Blocks %lu \r\n", dwNumBlocks));
+
+    return SCSI_OK;
+}
+/******************************************************************************
+ End of function  scsiWrite16
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: scsiInquire
  Description:   Function to get the Mass Storage device information
@@ -136,7 +136,7 @@ typedef union _CSW
 static UMSERR usbMsPutGet (int iMsDev, int iLun, PMSCMD pMsCmd, void *pvData, size_t *pstLenTrans);
 static UMSERR usbMsGetErrorCode (int iDriverErrorCode);
 static UMSERR usbMsSendCBW (int iMsDev, int iLun, PMSCMD pMsCmd, PCBW pCBW);
-static UMSERR usbMsReceiveCSW (int iMsDev, PCSW pCSW);
+static UMSERR usbMsReceiveCSW (int iMsDev, PCSW pCSW, uint32_t dwCSWTag, _Bool bfPosted);
 
 /******************************************************************************
  Exported global variables and functions (to be accessed by other files)
@@ -240,15 +240,34 @@ static UMSERR usbMsPutGet (int iMsDev, int iLun, PMSCMD pMsCmd, void *pvData, si
     CSW cmdStsWpr;
     UMSERR iErrorCode = USB_MS_OK;
     size_t stLengthTransferred = 0UL;
+    _Bool bfDataIn = ((pMsCmd->stTransferLength) && (pMsCmd->transferDirection == USB_MS_DIRECTION_IN));
+    _Bool bfCSWPosted = false;
 
     /* Set the time-out for the command */
     control(iMsDev, CTL_SET_TIME_OUT, &pMsCmd->dwTimeOut);
 
+    /* Start reading the data before the CBW is sent so the IN transfer is
+     waiting on the bus as soon as the device is ready with the data */
+    if (bfDataIn)
+    {
+        control(iMsDev, CTL_START_OVERLAPPED_READ, NULL);
+        if (read(iMsDev, pvData, (uint32_t) pMsCmd->stTransferLength) == -1)
+        {
+            /* Fall back to a blocking read after the CBW */
+            control(iMsDev, CTL_CANCEL_OVERLAPPED_READ, NULL);
+            bfDataIn = false;
+        }
+    }
+
     /* Write the CBW to the device */
     iErrorCode = usbMsSendCBW(iMsDev, iLun, pMsCmd, &cmdBlkWpr);
     if (iErrorCode)
     {
         TRACE(("usbMsPutGet: Failed to send CBW %d\r\n", iErrorCode));
+        if (bfDataIn)
+        {
+            control(iMsDev, CTL_CANCEL_OVERLAPPED_READ, NULL);
+        }
         /* Section 6.6.1 */
         control(iMsDev, CTL_USB_MS_RESET, NULL);
         ;
@@ -261,14 +280,32 @@ static UMSERR usbMsPutGet (int iMsDev, int iLun, PMSCMD pMsCmd, void *pvData, si
     /* Read or write the data - if there is any */
     if (pMsCmd->stTransferLength)
     {
-        UMSERR iDataPhaseError = USB_MS_OK;
+        int iDataPhaseError = BULK_EP_NO_ERROR;
         if (pMsCmd->transferDirection == USB_MS_DIRECTION_IN)
         {
-            stLengthTransferred = (size_t) read(iMsDev, pvData, (uint32_t) pMsCmd->stTransferLength);
+            if (bfDataIn)
+            {
+                OLD overlapped;
+                control(iMsDev, CTL_GET_OVERLAPPED_READ_RESULT, &overlapped);
+                stLengthTransferred = overlapped.stLength;
+                iDataPhaseError = overlapped.iResult;
+            }
+            else
+            {
+                stLengthTransferred = (size_t) read(iMsDev, pvData, (uint32_t) pMsCmd->stTransferLength);
+            }
             TRACE(("usbMsPutGet: Read %d\r\n", stLengthTransferred));
         }
         else
         {
+            /* Start reading the CSW so it is collected as soon as the device
+             has received the data */
+            control(iMsDev, CTL_START_OVERLAPPED_READ, NULL);
+            bfCSWPosted = (read(iMsDev, (uint8_t *) &cmdStsWpr, sizeof(CSW)) != -1);
+            if (!bfCSWPosted)
+            {
+                control(iMsDev, CTL_CANCEL_OVERLAPPED_READ, NULL);
+            }
             stLengthTransferred = (size_t) write(iMsDev, pvData, (uint32_t) pMsCmd->stTransferLength);
             XTRACE(("usbMsPutGet: Write %lu\r\n", stLengthTransferred));
         }
@@ -277,19 +314,28 @@ static UMSERR usbMsPutGet (int iMsDev, int iLun, PMSCMD pMsCmd, void *pvData, si
             *pstLenTrans = stLengthTransferred;
         }
 
-        /* Get the error code from the data transfer */
-        control(iMsDev, CTL_GET_LAST_ERROR, &iDataPhaseError);
         if (stLengthTransferred == -1u)
         {
+            /* Get the error code from the data transfer */
+            if (!bfDataIn)
+            {
+                control(iMsDev, CTL_GET_LAST_ERROR, &iDataPhaseError);
+            }
+
+            /* The CSW can't be trusted after a failed data phase */
+            if (bfCSWPosted)
+            {
+                control(iMsDev, CTL_CANCEL_OVERLAPPED_READ, NULL);
+            }
+
             /* If the command is not supported by the device it may stall
              the IN endpoint */
-            if ((int)iDataPhaseError == (int)BULK_EP_STALL_ERROR)
+            if (iDataPhaseError == (int)BULK_EP_STALL_ERROR)
             {
                 /* Clear a stalled IN endpoint */
                 control(iMsDev, CTL_USB_MS_CLEAR_BULK_IN_STALL, NULL);
                 /* Get the status of the command */
-                cmdStsWpr.Field.dCSWTag = cmdBlkWpr.Field.dCBWTag;
-                iErrorCode = usbMsReceiveCSW(iMsDev, &cmdStsWpr);
+                iErrorCode = usbMsReceiveCSW(iMsDev, &cmdStsWpr, cmdBlkWpr.Field.dCBWTag, false);
                 if (iErrorCode)
                 {
                     TRACE(("usbMsPutGet: Failed to get CSW\r\n"));
@@ -306,8 +352,7 @@ static UMSERR usbMsPutGet (int iMsDev, int iLun, PMSCMD pMsCmd, void *pvData, si
     } XTRACE(("usbMsPutGet: Try to receive CSW\r\n"));
 
     /* Get the status of the command */
-    cmdStsWpr.Field.dCSWTag = cmdBlkWpr.Field.dCBWTag;
-    iErrorCode = usbMsReceiveCSW(iMsDev, &cmdStsWpr);
+    iErrorCode = usbMsReceiveCSW(iMsDev, &cmdStsWpr, cmdBlkWpr.Field.dCBWTag, bfCSWPosted);
 
     if (iErrorCode)
     {
@@ -468,26 +513,42 @@ static _Bool usbMsValidateCSW (uint32_t *pdwTempPacket, uint32_t dwCSWTag, size_
  Function Name: usbMsReceiveCSW
  Description:   Function to receive the CSW
  Arguments:     IN  iMsDev - The mass storage device file descriptor
- OUT pCSW - pointer to the Command Status Wrapper
+ IN/OUT pCSW - pointer to the Command Status Wrapper
+ IN  dwCSWTag - The tag of the CBW
+ IN  bfPosted - true if an overlapped read of the CSW into pCSW has been
+ started
  Return value:  0 for success or error code
  ******************************************************************************/
-static UMSERR usbMsReceiveCSW (int iMsDev, PCSW pCSW)
+static UMSERR usbMsReceiveCSW (int iMsDev, PCSW pCSW, uint32_t dwCSWTag, _Bool bfPosted)
 {
     CSW msCSW;
     size_t stLengthTransferred;
     int iStallCount = 0;
-    PBLKERR ErrorCode;
+    BLKERR ErrorCode;
 
     /* Loop so if the device returns more data than expected CSW is still
      received */
     do
     {
-        ErrorCode = 0;
+        ErrorCode = BULK_EP_NO_ERROR;
 
-        /* Read one packet at a time until a CSW is found */
-        stLengthTransferred = (size_t) read(iMsDev, (uint8_t *) &msCSW, sizeof(CSW));
-        /* Get the error code */
-        control(iMsDev, CTL_GET_LAST_ERROR, &ErrorCode);
+        if (bfPosted)
+        {
+            /* Collect the packet that was requested during the data phase */
+            OLD overlapped;
+            bfPosted = false;
+            control(iMsDev, CTL_GET_OVERLAPPED_READ_RESULT, &overlapped);
+            stLengthTransferred = overlapped.stLength;
+            ErrorCode = (BLKERR) overlapped.iResult;
+            msCSW = *pCSW;
+        }
+        else
+        {
+            /* Read one packet at a time until a CSW is found */
+            stLengthTransferred = (size_t) read(iMsDev, (uint8_t *) &msCSW, sizeof(CSW));
+            /* Get the error code */
+            control(iMsDev, CTL_GET_LAST_ERROR, &ErrorCode);
+        }
         /* Figure 2 states STALL Bulk-In or Bulk Error - so we don't care about
          the reason for failure */
         if (ErrorCode)
@@ -526,7 +587,7 @@ static UMSERR usbMsReceiveCSW (int iMsDev, PCSW pCSW)
                 control(iMsDev, CTL_USB_MS_CLEAR_BULK_IN_STALL, NULL);
             }
         }
-    } while (!usbMsValidateCSW((uint32_t *) &msCSW, pCSW->Field.dCSWTag, stLengthTransferred));
+    } while (!usbMsValidateCSW((uint32_t *) &msCSW, dwCSWTag, stLengthTransferred));
 
     /* Copy the data to the destination CSW */
     *pCSW = msCSW;
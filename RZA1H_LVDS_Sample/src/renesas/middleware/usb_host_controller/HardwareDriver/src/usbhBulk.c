@@ -63,6 +63,8 @@
  Function Prototypes
  ******************************************************************************/
 
+static _Bool usbhBulkUseDma (PUSBTR pRequest, int iPipeNumber);
+static void usbhBulkReleaseDma (PUSBTR pRequest, int iPipeNumber);
 static _Bool usbhStartBulkInTransfer (PUSBTR pRequest, int iPipeNumber);
 static void usbhCompleteDmaIn (void *pvRequest);
 static void usbhCancelBulkInDma (PUSBTR pRequest);
@@ -71,11 +73,6 @@ static void usbhContinueBulkOutFifo (PUSBTR pRequest, int iPipeNumber);
 static void usbhCompleteDmaOut (void *pvRequest);
 static void usbhCancelBulkOutDma (PUSBTR pRequest);
 
-/******************************************************************************
- Exported global variables and functions (to be accessed by other files)
- ******************************************************************************/
-extern bool_t dma_available;
-
 /******************************************************************************
  Function Name: usbhStartBulkTransfer
  Description:   Function to start a Bulk transfer
@@ -100,6 +97,10 @@ _Bool usbhStartBulkTransfer (PUSBTR pRequest)
             /* Initialise the FIFO used count - for idle time-out */
             pRequest->pUsbHc->pPipeTrack[iPipeNumber].iFifoUsedCount = 0;
 
+            /* Release any DMA channel left assigned to the pipe by a transfer
+             that was cancelled after its DMA had completed */
+            usbhBulkReleaseDma(pRequest, iPipeNumber);
+
             /* Set the pipe to NAK */
             R_USBH_EnablePipe(pRequest->pUSB, iPipeNumber, false);
 
@@ -214,17 +215,9 @@ _Bool usbhBulkPipeIdle (PUSBTR pRequest, int iPipeNumber)
         pRequest->pUsbHc->pPipeTrack[iPipeNumber].iFifoUsedCount = 0;
         return false;
     }
-    else
+    else if (pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel >= 0)
     {
-        uint32_t ulDmaCount;
-        if (pRequest->pEndpoint->transferDirection == USBH_OUT)
-        {
-            ulDmaCount = dmaGetUsbOutCh0Count();
-        }
-        else
-        {
-            ulDmaCount = dmaGetUsbInCh1Count();
-        }
+        uint32_t ulDmaCount = dmaGetUsbCount(pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel);
 
         if (ulDmaCount == pRequest->pUsbHc->pPipeTrack[iPipeNumber].ulDmaTransCnt)
         {
@@ -247,6 +240,74 @@ _Bool usbhBulkPipeIdle (PUSBTR pRequest, int iPipeNumber)
  Private global variables and functions
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: usbhBulkUseDma
+ Description:   Function to check if a transfer should be moved by the DMAC
+ and to assign a DMA channel and FIFO port to the pipe
+ Arguments:     IN  pRequest - Pointer to the transfer request
+ IN  iPipeNumber - The pipe number to use
+ Return value:  true if the DMAC should be used
+ ******************************************************************************/
+static _Bool usbhBulkUseDma (PUSBTR pRequest, int iPipeNumber)
+{
+    int iDmaFifo = USBH_DMA_D0FIFO;
+    int iDmaChannel;
+
+    /* The DMAC moves whole DWORD aligned packets through the D0FIFO and
+     D1FIFO ports which can only be assigned to some of the pipes */
+    if ((!R_USBH_DmaPipe(iPipeNumber))
+            || (((size_t) pRequest->pMemory & 3UL) != 0)
+            || (pRequest->stLength < (size_t) pRequest->pEndpoint->wPacketSize)
+            || (pRequest->stLength < USBH_DMA_THRESHOLD))
+    {
+        return false;
+    }
+
+    /* When both ports of the controller are busy with transfers on other
+     pipes this one is performed by FIFO instead of waiting */
+    iDmaChannel = dmaAllocUsbChannel((void *) pRequest->pUSB, &iDmaFifo);
+    if (iDmaChannel < 0)
+    {
+        TRACE(("usbhBulkUseDma: No DMA channel for PIPE %d\r\n", iPipeNumber));
+        return false;
+    }
+
+    pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel = iDmaChannel;
+    pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaFifo = iDmaFifo;
+    return true;
+}
+/******************************************************************************
+ End of function  usbhBulkUseDma
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhBulkReleaseDma
+ Description:   Function to stop the DMA of a pipe and return its channel to
+ the pool
+ Arguments:     IN  pRequest - Pointer to the transfer request
+ IN  iPipeNumber - The pipe number
+ Return value:  none
+ ******************************************************************************/
+static void usbhBulkReleaseDma (PUSBTR pRequest, int iPipeNumber)
+{
+    int iDmaChannel = pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel;
+
+    if (iDmaChannel >= 0)
+    {
+        /* Release the DMA FIFO port */
+        R_USBH_StopDmaPipe(pRequest->pUSB, pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaFifo);
+
+        /* Stop the DMA and return the channel to the pool */
+        dmaStopUsb(iDmaChannel);
+        dmaFreeUsbChannel(iDmaChannel);
+        pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel = -1;
+    }
+    pRequest->pUsbHc->pPipeTrack[iPipeNumber].bfTerminateOutDma = false;
+}
+/******************************************************************************
+ End of function  usbhBulkReleaseDma
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: usbhStartBulkInTransfer
  Description:   Function to start a bulk in transfer
@@ -257,29 +318,23 @@ _Bool usbhBulkPipeIdle (PUSBTR pRequest, int iPipeNumber)
 static _Bool usbhStartBulkInTransfer (PUSBTR pRequest, int iPipeNumber)
 {
     PUSB pUSB = pRequest->pUSB;
-    int32_t dma_ercd = 0;
-
-    /* If the transfer is greater than four packets. The problem here is that
-     if there is further data to be received after the the current transfer
-     once the DMA has finished the next two packets will automatically be
-     accepted into the pipe FIFO. When the DMA completes the pipe is freed
-     and the data in the FIFO is lost. */
 
-    if ((pRequest->stLength >= (size_t) (pRequest->pEndpoint->wPacketSize << 2)) && dma_available)
-    /* See if there is a DMA channel available to handle this request */
+    /* See if this request should be handled by the DMA */
+    if (usbhBulkUseDma(pRequest, iPipeNumber))
     {
+        int iDmaChannel = pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel;
+        int iDmaFifo = pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaFifo;
+        size_t stPacketSize = (size_t) pRequest->pEndpoint->wPacketSize;
         uint16_t wNumPackets;
 
         /* Calculate the length of whole packets to transfer */
-        size_t stDmaTransferLength = pRequest->stLength - (pRequest->stLength % pRequest->pEndpoint->wPacketSize);
+        size_t stDmaTransferLength = pRequest->stLength - (pRequest->stLength % stPacketSize);
 
-        /* Subtract two packets from the length to allow then to be brought in
-         by the double buffered FIFO without receiving data for the next
-         transfer */
-        stDmaTransferLength -= (size_t) (pRequest->pEndpoint->wPacketSize << 1);
-
-        /* Calculate the number of packets */
-        wNumPackets = (uint16_t) (stDmaTransferLength / pRequest->pEndpoint->wPacketSize);
+        /* The transaction counter covers the whole request including any
+         short final packet. The pipe is set to NAK when the counter expires
+         so no data for the next transfer is received into the FIFO, and the
+         final packet is read by the DMA completion routine */
+        wNumPackets = (uint16_t) ((pRequest->stLength + stPacketSize - 1) / stPacketSize);
 
         /* Set the cancel function */
         pRequest->pCancel = usbhCancelBulkInDma;
@@ -288,11 +343,11 @@ static _Bool usbhStartBulkInTransfer (PUSBTR pRequest, int iPipeNumber)
         pRequest->stTransferSize = stDmaTransferLength;
 
         /* Setup the DMA to perform the transfer */
-        dmaStartUsbInCh1(pRequest->pMemory, stDmaTransferLength, R_USBH_DmaFIFO(pRequest->pUSB, USBH_IN), pRequest,
-                usbhCompleteDmaIn);
+        dmaStartUsbIn(iDmaChannel, pRequest->pMemory, stDmaTransferLength, R_USBH_DmaFIFO(pUSB, iDmaFifo),
+                pRequest, usbhCompleteDmaIn);
 
         /* Set the pipe DMA FIFO for the transfer */
-        R_USBH_DmaReadPipe(pUSB, iPipeNumber, wNumPackets);
+        R_USBH_DmaReadPipe(pUSB, iPipeNumber, wNumPackets, iDmaFifo);
         TRACE(("usbhStartBulkInTransfer: Started DMA %lu\r\n",
                         pRequest->stLength));
 
@@ -333,93 +388,61 @@ static void usbhCompleteDmaIn (void *pvRequest)
 {
     PUSBTR pRequest = pvRequest;
     int iPipeNumber = (int) pRequest->pInternal;
-    uint8_t *pbyDest;
-    size_t stLengthToRead;
-    int32_t dma_ercd = 0;
+    size_t stDmaRemaining;
 
-    /* Disable the endpoint */
-    R_USBH_EnablePipe(pRequest->pUSB, iPipeNumber, false);
-    /* Disable the IN DMA FIFO settings */
-    R_USBH_StopDmaReadPipe(pRequest->pUSB);
+    /* Get the length that the DMA did not transfer. This is only non zero
+     when the transfer end signal from the FIFO stopped the DMA early because
+     the device sent a short packet */
+    stDmaRemaining = (size_t) dmaGetUsbCount(pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel);
 
-    /* Stop the DMA - Remainder of transfer will now be performed by FIFO */
-    dmaStopUsbInCh1();
+    /* Disable the IN DMA FIFO settings and stop the DMA so the channel can
+     be used by another pipe - Remainder of transfer will now be performed
+     by FIFO */
+    usbhBulkReleaseDma(pRequest, iPipeNumber);
 
     /* Update the index */
-    pRequest->stIdx += pRequest->stTransferSize;
-    /* The double buffered FIFO may have received up to two packets */
-    stLengthToRead = pRequest->stLength - pRequest->stIdx;
-    /* All of the data must be read from the FIFO to prevent data loss. Space
-     was reserved for the last two packets when the transfer was started */
-    while ((stLengthToRead) && (pRequest->stTransferSize))
-    {
-        /* Calculate the destination */
-        pbyDest = pRequest->pMemory + pRequest->stIdx;
-        /* Read the FIFO */
-        pRequest->stTransferSize = R_USBH_ReadPipe(pRequest->pUSB, iPipeNumber, pbyDest, stLengthToRead);
-        switch (pRequest->stTransferSize)
-        {
-            /* More data in FIFO than in room for in destination memory */
-            case -2UL :
-                TRACE(("USBH_DATA_OVERRUN_ERROR\r\n"));
-
-                /* Set the error code */
-                pRequest->errorCode = USBH_DATA_OVERRUN_ERROR;
-
-                /* Clear the buffer of any data */
-                R_USBH_ClearPipeFifo(pRequest->pUSB, iPipeNumber);
+    pRequest->stIdx += pRequest->stTransferSize - stDmaRemaining;
 
-                /* Complete the request */
-                usbhCompleteInFifo(pRequest, iPipeNumber);
-                return;
+    /* Show that this request is not idle */
+    pRequest->pUsbHc->pPipeTrack[iPipeNumber].iFifoUsedCount++;
 
-                /* SIE would not release the FIFO */
-            case -1UL :
-
-                /* When running tests in single buffered mode this is to be
-                 expected because there is no more data in the FIFO to read. */
-                usbhCompleteByFIFO(pRequest, iPipeNumber);
-                return;
-
-                /* A packet was transferred */
-            default :
-
-                /* Show that this request is not idle */
-                pRequest->pUsbHc->pPipeTrack[iPipeNumber].iFifoUsedCount++;
-
-                /* Update the index */
-                pRequest->stIdx += pRequest->stTransferSize;
+    /* Transfer may have been completed by length or a short packet */
+    if ((stDmaRemaining) || (pRequest->stIdx == pRequest->stLength))
+    {
+        /* Disable the endpoint */
+        R_USBH_EnablePipe(pRequest->pUSB, iPipeNumber, false);
 
-                /* Transfer may have been completed by length */
-                if ((pRequest->stIdx == pRequest->stLength)
+        /* Set the error code */
+        pRequest->errorCode = USBH_NO_ERROR;
 
-                /* or a short packet */
-                || (pRequest->stTransferSize < pRequest->pEndpoint->wPacketSize))
-                {
-                    /* Set the error code */
-                    pRequest->errorCode = USBH_NO_ERROR;
-                    /* Complete the request */
-                    usbhCompleteInFifo(pRequest, iPipeNumber);
-                    return;
-                }
+        /* Complete the request */
+        usbhCompleteInFifo(pRequest, iPipeNumber);
+    }
+    else
+    {
+        /* The short final packet is covered by the transaction counter so
+         the pipe is left enabled to receive it. Rather than wait here for it
+         to arrive it is read by FIFO, now if it is already in the buffer or
+         otherwise when the buffer ready interrupt is raised */
+        pRequest->stTransferSize = 0;
 
-                /* Update the length remaining */
-                stLengthToRead = pRequest->stLength - pRequest->stIdx;
+        /* Set the cancel function */
+        pRequest->pCancel = usbhCancelInFifo;
 
-                /* Check to see if there is more data in the FIFO */
-                if (R_USBH_DataInFIFO(pRequest->pUSB, iPipeNumber) <= 0)
-                {
-                    /* The FIFO is empty so continue with standard single buffered
-                     transfer */
-                    usbhCompleteByFIFO(pRequest, iPipeNumber);
-                    return;
-                }
-            break;
+        /* Clear any buffer ready status left from the DMA transfer */
+        R_USBH_ClearPipeInterrupt(pRequest->pUSB, iPipeNumber, USBH_PIPE_BUFFER_READY);
+        if (R_USBH_PipeBufferReady(pRequest->pUSB, iPipeNumber))
+        {
+            usbhBulkIn(pRequest, iPipeNumber);
+        }
+        else
+        {
+            /* Enable the buffer ready interrupt */
+            R_USBH_SetPipeInterrupt(pRequest->pUSB, iPipeNumber, USBH_PIPE_BUFFER_READY);
+            TRACE(("usbhCompleteDmaIn: Tail %lu by FIFO\r\n",
+                            pRequest->stLength - pRequest->stIdx));
         }
     }
-
-    /* Complete the request */
-    usbhCompleteInFifo(pRequest, iPipeNumber);
 }
 /******************************************************************************
  End of function  usbhCompleteDmaIn
@@ -433,9 +456,7 @@ static void usbhCompleteDmaIn (void *pvRequest)
  ******************************************************************************/
 static void usbhCancelBulkInDma (PUSBTR pRequest)
 {
-    PUSB pUSB = pRequest->pUSB;
     int iPipeNumber = (int) pRequest->pInternal;
-    int32_t dma_ercd = 0;
 
     if (iPipeNumber)
     {
@@ -446,20 +467,17 @@ static void usbhCancelBulkInDma (PUSBTR pRequest)
         R_USBH_EnablePipe(pRequest->pUSB, iPipeNumber, false);
         /* Update the endpoint data PID toggle bit */
         pRequest->pEndpoint->dataPID = R_USBH_GetPipePID(pRequest->pUSB, iPipeNumber);
-        /* Update the transfer length */
-        {
-            size_t stLengthRemaining = (size_t) (R_USBH_DmaTransac(pUSB, iPipeNumber) * pRequest->pEndpoint->wPacketSize);
-            pRequest->stIdx = pRequest->stTransferSize - stLengthRemaining;
-        }
+        /* Update the transfer length. The transaction counter includes the
+         short final packet which the DMA does not move, so use the DMA
+         count instead */
+        pRequest->stIdx = pRequest->stTransferSize
+                - (size_t) dmaGetUsbCount(pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel);
 
-        /* Disable DMA to USB association */
-        R_USBH_StopDmaPipe(pUSB);
+        /* Disable DMA to USB association and the DMA */
+        usbhBulkReleaseDma(pRequest, iPipeNumber);
 
         /* Free the pipe for use by another transfer */
         usbhFreePipeNumber(pRequest->pUsbHc, iPipeNumber);
-
-        /* Disable the DMA */
-        dmaStopUsbInCh1();
     }
     else
     {
@@ -480,12 +498,14 @@ static void usbhCancelBulkInDma (PUSBTR pRequest)
 static _Bool usbhStartBulkOutTransfer (PUSBTR pRequest, int iPipeNumber)
 {
     PUSB pUSB = pRequest->pUSB;
-    int32_t dma_ercd = 0;
-
-    /* Check to see if this transfer can be handled by DMA */
 
-    if ((pRequest->stLength >= (size_t) pRequest->pEndpoint->wPacketSize) && dma_available)
+    /* Check to see if this transfer can be handled by DMA. Any short final
+     packet is written by FIFO when the DMA part has been sent */
+    if (usbhBulkUseDma(pRequest, iPipeNumber))
     {
+        int iDmaChannel = pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel;
+        int iDmaFifo = pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaFifo;
+
         /* Calculate the length of whole packets to transfer */
         size_t stDmaTransferLength = pRequest->stLength - (pRequest->stLength % pRequest->pEndpoint->wPacketSize);
 
@@ -499,11 +519,11 @@ static _Bool usbhStartBulkOutTransfer (PUSBTR pRequest, int iPipeNumber)
         pRequest->stTransferSize = stDmaTransferLength;
 
         /* Setup the DMA to perform the transfer */
-        dmaStartUsbOutCh0(pRequest->pMemory, stDmaTransferLength, R_USBH_DmaFIFO(pRequest->pUSB, USBH_OUT), pRequest,
-                usbhCompleteDmaOut);
+        dmaStartUsbOut(iDmaChannel, pRequest->pMemory, stDmaTransferLength, R_USBH_DmaFIFO(pUSB, iDmaFifo),
+                pRequest, usbhCompleteDmaOut);
 
         /* Set the pipe DMA FIFO for the transfer */
-        R_USBH_DmaWritePipe(pUSB, iPipeNumber, wNumPackets);
+        R_USBH_DmaWritePipe(pUSB, iPipeNumber, wNumPackets, iDmaFifo);
 
         /* Enable the not ready interrupt for detection of a STALL condition */
         R_USBH_SetPipeInterrupt(pRequest->pUSB, iPipeNumber, USBH_PIPE_BUFFER_NOT_READY);
@@ -579,9 +599,8 @@ static void usbhContinueBulkOutFifo (PUSBTR pRequest, int iPipeNumber)
     /* Check for termination of a DMA transfer */
     if (pRequest->pUsbHc->pPipeTrack[iPipeNumber].bfTerminateOutDma)
     {
-        pRequest->pUsbHc->pPipeTrack[iPipeNumber].bfTerminateOutDma = false;
-        /* Clear the DMA request bit */
-        R_USBH_StopDmaPipe(pRequest->pUSB);
+        /* Clear the DMA request bit and return the channel to the pool */
+        usbhBulkReleaseDma(pRequest, iPipeNumber);
     }
     /* Check for a short packet */
     if ((pRequest->stTransferSize < pRequest->pEndpoint->wPacketSize)
@@ -635,7 +654,6 @@ static void usbhCompleteDmaOut (void *pvRequest)
 {
     PUSBTR pRequest = pvRequest;
     int iPipeNumber = (int) pRequest->pInternal;
-    int32_t dma_ercd = 0;
 
     /* Set the cancel function */
     pRequest->pCancel = usbhCancelOutFifo;
@@ -644,8 +662,9 @@ static void usbhCompleteDmaOut (void *pvRequest)
     R_USBH_SetPipeInterrupt(pRequest->pUSB, iPipeNumber, USBH_PIPE_BUFFER_EMPTY);
 
     /* Stop the DMA - The remainder of the transfer will now be performed
-     with the FIFO */
-    dmaStopUsbOutCh0();
+     with the FIFO. The channel keeps the FIFO port until the last packet has
+     been sent */
+    dmaStopUsb(pRequest->pUsbHc->pPipeTrack[iPipeNumber].iDmaChannel);
 }
 /******************************************************************************
  End of function  usbhCompleteDmaOut
@@ -661,7 +680,6 @@ static void usbhCancelBulkOutDma (PUSBTR pRequest)
 {
     PUSB pUSB = pRequest->pUSB;
     int iPipeNumber = (int) pRequest->pInternal;
-    int32_t dma_ercd = 0;
 
     if (iPipeNumber)
     {
@@ -678,8 +696,8 @@ static void usbhCancelBulkOutDma (PUSBTR pRequest)
             pRequest->stIdx = pRequest->stTransferSize - stLengthRemaining;
         }
 
-        /* Disable DMA to USB association */
-        R_USBH_StopDmaPipe(pUSB);
+        /* Disable DMA to USB association and the DMA */
+        usbhBulkReleaseDma(pRequest, iPipeNumber);
 
         /* Free the pipe for use by another transfer */
         usbhFreePipeNumber(pRequest->pUsbHc, iPipeNumber);
@@ -688,9 +706,6 @@ static void usbhCancelBulkOutDma (PUSBTR pRequest)
     {
         TRACE(("usbhCancelBulkOutDma: Invalid pipe number\r\n"));
     }
-
-    /* Disable the DMA */
-    dmaStopUsbOutCh0();
 }
 /******************************************************************************
  End of function  usbhCancelBulkOutDma
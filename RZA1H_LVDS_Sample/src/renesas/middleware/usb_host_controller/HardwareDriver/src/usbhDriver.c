@@ -175,6 +175,9 @@ void usbhInterruptHandler (PUSBHC pUsbHc)
      only when there is a device attached to one or more root ports */
     if (R_USBH_InterruptStatus(pUSB, USBH_INTSTS_SOFR, true))
     {
+        /* Count the frame for the request queue statistics */
+        pUsbHc->dwFrameCount++;
+
         /* Schedule any isoc transfers */
         usbhSheduleIsoc(pUsbHc);
         /* Schedule any interrupt transfers */
@@ -333,9 +336,17 @@ static void usbhSheduleIsoc (PUSBHC pUsbHc)
 static void usbhHandleOutTransfer (PUSBHC pUsbHc)
 {
     PUSB pUSB = pUsbHc->pPort->pUSB;
-    int iPipeNumber = 1;
-    while (iPipeNumber < USBH_MAX_NUM_PIPES)
+
+    /* Take the pipes with the interrupt pending in one read of the status
+     registers rather than testing each pipe in turn */
+    uint16_t wPipeMap = R_USBH_GetPipeInterruptMap(pUSB, USBH_PIPE_BUFFER_EMPTY);
+    while (wPipeMap)
     {
+        /* Take the lowest numbered pipe */
+        int iPipeNumber = __builtin_ctz(wPipeMap);
+        wPipeMap = (uint16_t) (wPipeMap & (wPipeMap - 1U));
+
+        /* Check it again in case handling an earlier pipe has changed it */
         if (R_USBH_GetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_EMPTY,
         true))
         {
@@ -375,7 +386,6 @@ static void usbhHandleOutTransfer (PUSBHC pUsbHc)
                 R_USBH_SetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_EMPTY | USBH_PIPE_INT_DISABLE);
             }
         }
-        iPipeNumber++;
     }
 }
 /******************************************************************************
@@ -392,9 +402,17 @@ static void usbhHandleOutTransfer (PUSBHC pUsbHc)
 static void ushbHandleInTransfer (PUSBHC pUsbHc)
 {
     PUSB pUSB = pUsbHc->pPort->pUSB;
-    int iPipeNumber = 1;
-    while (iPipeNumber < USBH_MAX_NUM_PIPES)
+
+    /* Take the pipes with the interrupt pending in one read of the status
+     registers rather than testing each pipe in turn */
+    uint16_t wPipeMap = R_USBH_GetPipeInterruptMap(pUSB, USBH_PIPE_BUFFER_READY);
+    while (wPipeMap)
     {
+        /* Take the lowest numbered pipe */
+        int iPipeNumber = __builtin_ctz(wPipeMap);
+        wPipeMap = (uint16_t) (wPipeMap & (wPipeMap - 1U));
+
+        /* Check it again in case handling an earlier pipe has changed it */
         if (R_USBH_GetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_READY,
         true))
         {
@@ -435,7 +453,6 @@ static void ushbHandleInTransfer (PUSBHC pUsbHc)
                 R_USBH_SetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_READY | USBH_PIPE_INT_DISABLE);
             }
         }
-        iPipeNumber++;
     }
 }
 /******************************************************************************
@@ -452,9 +469,17 @@ static void ushbHandleInTransfer (PUSBHC pUsbHc)
 static void usbhHandleTransferError (PUSBHC pUsbHc)
 {
     PUSB pUSB = pUsbHc->pPort->pUSB;
-    int iPipeNumber = 1;
-    while (iPipeNumber < USBH_MAX_NUM_PIPES)
+
+    /* Take the pipes with the interrupt pending in one read of the status
+     registers rather than testing each pipe in turn */
+    uint16_t wPipeMap = R_USBH_GetPipeInterruptMap(pUSB, USBH_PIPE_BUFFER_NOT_READY);
+    while (wPipeMap)
     {
+        /* Take the lowest numbered pipe */
+        int iPipeNumber = __builtin_ctz(wPipeMap);
+        wPipeMap = (uint16_t) (wPipeMap & (wPipeMap - 1U));
+
+        /* Check it again in case handling an earlier pipe has changed it */
         if (R_USBH_GetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_NOT_READY,
         true))
         {
@@ -502,7 +527,6 @@ static void usbhHandleTransferError (PUSBHC pUsbHc)
                 R_USBH_SetPipeInterrupt(pUSB, iPipeNumber, USBH_PIPE_BUFFER_NOT_READY | USBH_PIPE_INT_DISABLE);
             }
         }
-        iPipeNumber++;
     }
 }
 /******************************************************************************
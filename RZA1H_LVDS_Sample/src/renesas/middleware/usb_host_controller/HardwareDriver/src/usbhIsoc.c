@@ -45,6 +45,7 @@
  ******************************************************************************/
 #include "usbhDriverInternal.h"
 #include "hwDmaIf.h"
+#include "r_task_priority.h"
 #include "trace.h"
 
 /******************************************************************************
@@ -59,6 +60,11 @@
 #define TRACE(x)
 #endif
 
+/* The PCM ring is shared between the USB interrupt and a task on the same
+   core so only the compiler needs to be stopped from re-ordering the copy
+   and the index update */
+#define USBH_ISOC_RING_BARRIER()    __asm__ volatile ("" ::: "memory")
+
 /******************************************************************************
  Function Prototypes
  ******************************************************************************/
@@ -67,6 +73,11 @@ static _Bool usbhStartIsocInTransfer (PUSBTR pRequest, int iPipeNumber);
 static _Bool usbhStartIsocOutTransfer (PUSBTR pRequest, int iPipeNumber);
 static void usbhContinueIsocOutFifo (PUSBTR pRequest, int iPipeNumber);
 static size_t usbhWriteIsocPipe (PUSB pUSB, int iPipeNumber, uint8_t *pbySrc, size_t stLength, PUSBIV pIsocPacket);
+static void usbhIsocStreamComplete (PUSBTR pRequest);
+static void usbhIsocStreamFill (PUSBSM pStream, PUSBTR pRequest);
+static size_t usbhIsocRingPut (PUSBSM pStream, const uint8_t *pbySrc, size_t stLength);
+static size_t usbhIsocRingGet (PUSBSM pStream, uint8_t *pbyDest, size_t stLength);
+static void usbhIsocStreamFree (PUSBSM pStream, int iNumEvents);
 
 /******************************************************************************
  Exported global variables and functions (to be accessed by other files)
@@ -187,6 +198,200 @@ _Bool usbhIsocOut (PUSBTR pRequest, int iPipeNumber)
  End of function  usbhIsocOut
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: usbhIsocStreamStart
+ Description:   Function to start a continuous isochronous stream. The requests
+ are kept in flight on the endpoint and each one is put back on
+ the endpoint queue from the interrupt when it completes. IN data
+ is put into the PCM ring and OUT data is taken from it.
+ Arguments:     OUT pStream - Pointer to the stream to start
+ IN  pDevice - Pointer to the device
+ IN  pEndpoint - Pointer to the isochronous endpoint
+ IN  pIsocPacketSize - Pointer to the OUT packet size schedule or
+ NULL to use the endpoint packet size
+ IN  iNumRequests - The number of requests to keep in flight
+ IN  pbyRing - Pointer to the memory for the PCM ring
+ IN  stRingSize - The size of the ring, which must be a power of 2
+ IN  pNotify - Pointer to a function called from the interrupt
+ after each packet or NULL
+ IN  pvNotifyParam - The parameter passed to pNotify
+ Return value:  true if the stream was started
+ ******************************************************************************/
+_Bool usbhIsocStreamStart (PUSBSM pStream, PUSBDI pDevice, PUSBEI pEndpoint, PUSBIV pIsocPacketSize,
+        int iNumRequests, uint8_t *pbyRing, size_t stRingSize, void (*pNotify)(void *pvParam), void *pvNotifyParam)
+{
+    int iIndex;
+    int iUnlock;
+
+    if ((USBH_ISOCHRONOUS != pEndpoint->transferType) || (iNumRequests < 1)
+            || (iNumRequests > USBH_ISOC_STREAM_MAX_REQUESTS) || (NULL == pbyRing) || (0 == stRingSize)
+            || (stRingSize & (stRingSize - 1)))
+    {
+        return false;
+    }
+    memset(pStream, 0, sizeof(USBSM));
+    pStream->pDevice = pDevice;
+    pStream->pEndpoint = pEndpoint;
+    pStream->pIsocPacketSize = pIsocPacketSize;
+    pStream->iNumRequests = iNumRequests;
+    pStream->stPacketSize = (size_t) pEndpoint->wPacketSize;
+    pStream->pbyRing = pbyRing;
+    pStream->dwRingSize = (uint32_t) stRingSize;
+    pStream->pNotify = pNotify;
+    pStream->pvNotifyParam = pvNotifyParam;
+
+    /* The endpoint interval is 2^(bInterval - 1) frames */
+    pStream->dwFrameInterval = 1UL;
+    if ((pEndpoint->byInterval > 1) && (pEndpoint->byInterval <= 16))
+    {
+        pStream->dwFrameInterval = 1UL << (pEndpoint->byInterval - 1);
+    }
+
+    /* Allocate a packet buffer for each request */
+    pStream->pbyPacketMemory = R_OS_AllocMem(pStream->stPacketSize * (size_t) iNumRequests,
+            R_REGION_LARGE_CAPACITY_RAM);
+    if (NULL == pStream->pbyPacketMemory)
+    {
+        return false;
+    }
+
+    for (iIndex = 0; iIndex < iNumRequests; iIndex++)
+    {
+        PUSBTR pRequest = &pStream->request[iIndex];
+        if (!R_OS_CreateEvent(&pRequest->ioSignal))
+        {
+            usbhIsocStreamFree(pStream, iIndex);
+            return false;
+        }
+        pRequest->pUSB = pDevice->pPort->pUSB;
+        pRequest->pUsbHc = pDevice->pPort->pUsbHc;
+        pRequest->pEndpoint = pEndpoint;
+        pRequest->pMemory = pStream->pbyPacketMemory + (pStream->stPacketSize * (size_t) iIndex);
+        pRequest->stLength = pStream->stPacketSize;
+        pRequest->dwIdleTimeOut = REQ_IDLE_TIME_OUT_INFINITE;
+        pRequest->pComplete = usbhIsocStreamComplete;
+        pRequest->pvCompleteParam = pStream;
+    }
+
+    /* ACQUIRE MUTEX LIST LOCK */
+    iUnlock = R_OS_SysLock(NULL);
+
+    pStream->bfRunning = true;
+    pStream->stats.dwLastFrame = pDevice->pPort->pUsbHc->dwFrameCount;
+    for (iIndex = 0; iIndex < iNumRequests; iIndex++)
+    {
+        PUSBTR pRequest = &pStream->request[iIndex];
+        if (USBH_OUT == pEndpoint->transferDirection)
+        {
+            usbhIsocStreamFill(pStream, pRequest);
+        }
+        if (!usbhQueueTransfer(pRequest))
+        {
+            pStream->bfRunning = false;
+            break;
+        }
+    }
+
+    /* RELEASE MUTEX LIST LOCK */
+    R_OS_SysUnlock(NULL, iUnlock);
+
+    if (!pStream->bfRunning)
+    {
+        usbhIsocStreamStop(pStream);
+        return false;
+    }
+    return true;
+}
+/******************************************************************************
+ End of function  usbhIsocStreamStart
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamStop
+ Description:   Function to stop an isochronous stream and free its resources
+ Arguments:     IN  pStream - Pointer to the stream to stop
+ Return value:  none
+ ******************************************************************************/
+void usbhIsocStreamStop (PUSBSM pStream)
+{
+    int iIndex;
+
+    /* Stop the complete function from putting the requests back */
+    pStream->bfRunning = false;
+    for (iIndex = 0; iIndex < pStream->iNumRequests; iIndex++)
+    {
+        usbhCancelTransfer(&pStream->request[iIndex]);
+    }
+    usbhIsocStreamFree(pStream, pStream->iNumRequests);
+}
+/******************************************************************************
+ End of function  usbhIsocStreamStop
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamRead
+ Description:   Function to take PCM data received on an IN stream from the ring
+ Arguments:     IN  pStream - Pointer to the stream
+ OUT pbyDest - Pointer to the destination memory
+ IN  stLength - The maximum length to read
+ Return value:  The number of bytes read
+ ******************************************************************************/
+size_t usbhIsocStreamRead (PUSBSM pStream, uint8_t *pbyDest, size_t stLength)
+{
+    return usbhIsocRingGet(pStream, pbyDest, stLength);
+}
+/******************************************************************************
+ End of function  usbhIsocStreamRead
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamWrite
+ Description:   Function to put PCM data to be sent on an OUT stream in the ring
+ Arguments:     IN  pStream - Pointer to the stream
+ IN  pbySrc - Pointer to the source memory
+ IN  stLength - The length to write
+ Return value:  The number of bytes written
+ ******************************************************************************/
+size_t usbhIsocStreamWrite (PUSBSM pStream, const uint8_t *pbySrc, size_t stLength)
+{
+    return usbhIsocRingPut(pStream, pbySrc, stLength);
+}
+/******************************************************************************
+ End of function  usbhIsocStreamWrite
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamLevel
+ Description:   Function to get the amount of data in the PCM ring
+ Arguments:     IN  pStream - Pointer to the stream
+ Return value:  The number of bytes in the ring
+ ******************************************************************************/
+size_t usbhIsocStreamLevel (PUSBSM pStream)
+{
+    return (size_t) (pStream->dwRingIn - pStream->dwRingOut);
+}
+/******************************************************************************
+ End of function  usbhIsocStreamLevel
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamGetStats
+ Description:   Function to get a copy of the stream statistics
+ Arguments:     IN  pStream - Pointer to the stream
+ OUT pStats - Pointer to the destination for the statistics
+ Return value:  none
+ ******************************************************************************/
+void usbhIsocStreamGetStats (PUSBSM pStream, PUSBSMS pStats)
+{
+    /* Take a consistent copy */
+    int iUnlock = R_OS_SysLock(NULL);
+    *pStats = pStream->stats;
+    R_OS_SysUnlock(NULL, iUnlock);
+}
+/******************************************************************************
+ End of function  usbhIsocStreamGetStats
+ ******************************************************************************/
+
 /******************************************************************************
  Private global variables and functions
  ******************************************************************************/
@@ -346,6 +551,241 @@ static size_t usbhWriteIsocPipe (PUSB pUSB, int iPipeNumber, uint8_t *pbySrc, si
  End of function  usbhWriteIsocPipe
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: usbhIsocStreamComplete
+ Description:   Function called from the interrupt when a stream request is
+ removed from the endpoint queue. It keeps the statistics, moves
+ the data to or from the PCM ring and puts the request back on
+ the queue.
+ Arguments:     IN  pRequest - Pointer to the transfer request
+ Return value:  none
+ ******************************************************************************/
+static void usbhIsocStreamComplete (PUSBTR pRequest)
+{
+    PUSBSM pStream = (PUSBSM) pRequest->pvCompleteParam;
+    uint32_t dwFrame = pRequest->pUsbHc->dwFrameCount;
+    uint32_t dwInterval;
+
+    if (!pStream->bfRunning)
+    {
+        return;
+    }
+    if (REQ_DEVICE_NOT_FOUND == pRequest->errorCode)
+    {
+        /* The device has gone */
+        pStream->bfRunning = false;
+        return;
+    }
+
+    /* Check the time since the last packet */
+    dwInterval = dwFrame - pStream->stats.dwLastFrame;
+    pStream->stats.dwLastFrame = dwFrame;
+    if (pStream->stats.dwPackets)
+    {
+        if (dwInterval > pStream->stats.dwMaxInterval)
+        {
+            pStream->stats.dwMaxInterval = dwInterval;
+        }
+        if (dwInterval > pStream->dwFrameInterval)
+        {
+            pStream->stats.dwLateFrames++;
+        }
+    }
+
+    if (pRequest->errorCode)
+    {
+        pStream->stats.dwErrors++;
+    }
+    else
+    {
+        pStream->stats.dwPackets++;
+        pStream->stats.dwBytes += pRequest->uiTransferLength;
+        if (USBH_IN == pStream->pEndpoint->transferDirection)
+        {
+            if (0 == pRequest->uiTransferLength)
+            {
+                pStream->stats.dwEmptyPackets++;
+            }
+
+            /* Drop the whole packet if there is not room for it, a part of
+             a packet would split a sample frame */
+            else if (pRequest->uiTransferLength
+                    > (size_t) (pStream->dwRingSize - (pStream->dwRingIn - pStream->dwRingOut)))
+            {
+                pStream->stats.dwOverruns++;
+            }
+            else
+            {
+                usbhIsocRingPut(pStream, pRequest->pMemory, pRequest->uiTransferLength);
+            }
+        }
+    }
+
+    /* Put the request back on the queue */
+    if (USBH_OUT == pStream->pEndpoint->transferDirection)
+    {
+        usbhIsocStreamFill(pStream, pRequest);
+    }
+    if (!usbhQueueTransfer(pRequest))
+    {
+        pStream->bfRunning = false;
+    }
+
+    if (pStream->pNotify)
+    {
+        pStream->pNotify(pStream->pvNotifyParam);
+    }
+}
+/******************************************************************************
+ End of function  usbhIsocStreamComplete
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamFill
+ Description:   Function to fill an OUT stream request from the PCM ring. When
+ the ring does not hold enough data the rest is filled with silence.
+ Arguments:     IN  pStream - Pointer to the stream
+ IN  pRequest - Pointer to the transfer request
+ Return value:  none
+ ******************************************************************************/
+static void usbhIsocStreamFill (PUSBSM pStream, PUSBTR pRequest)
+{
+    size_t stLength = pStream->stPacketSize;
+    size_t stRead;
+    PUSBIV pIsocPacket = pStream->pIsocPacketSize;
+
+    /* Get the packet size from the schedule */
+    if (pIsocPacket)
+    {
+        stLength = (size_t) pIsocPacket->pwPacketSizeList[pStream->iScheduleIndex];
+        if (stLength > pStream->stPacketSize)
+        {
+            stLength = pStream->stPacketSize;
+        }
+        pStream->iScheduleIndex++;
+        pStream->iScheduleIndex %= pIsocPacket->iListLength;
+    }
+
+    /* Take as much as there is, up to a whole packet */
+    stRead = usbhIsocRingGet(pStream, pRequest->pMemory, stLength);
+    if (stRead < stLength)
+    {
+        memset(pRequest->pMemory + stRead, 0, stLength - stRead);
+
+        /* The requests are started before the producer has anything to send
+         so only count the underruns once the stream is running */
+        if (pStream->stats.dwPackets)
+        {
+            pStream->stats.dwUnderruns++;
+        }
+    }
+    pRequest->stLength = stLength;
+}
+/******************************************************************************
+ End of function  usbhIsocStreamFill
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocRingPut
+ Description:   Function to put data into the PCM ring. Only the producer
+ calls this.
+ Arguments:     IN  pStream - Pointer to the stream
+ IN  pbySrc - Pointer to the data
+ IN  stLength - The length of the data
+ Return value:  The number of bytes put in the ring
+ ******************************************************************************/
+static size_t usbhIsocRingPut (PUSBSM pStream, const uint8_t *pbySrc, size_t stLength)
+{
+    uint32_t dwIn = pStream->dwRingIn;
+    uint32_t dwFree = pStream->dwRingSize - (dwIn - pStream->dwRingOut);
+    uint32_t dwOffset = dwIn & (pStream->dwRingSize - 1UL);
+    uint32_t dwFirst;
+
+    if (stLength > dwFree)
+    {
+        stLength = (size_t) dwFree;
+    }
+    if (stLength)
+    {
+        /* Copy up to the end of the ring and then from the start */
+        dwFirst = pStream->dwRingSize - dwOffset;
+        if (dwFirst > stLength)
+        {
+            dwFirst = (uint32_t) stLength;
+        }
+        memcpy(pStream->pbyRing + dwOffset, pbySrc, dwFirst);
+        memcpy(pStream->pbyRing, pbySrc + dwFirst, stLength - dwFirst);
+        USBH_ISOC_RING_BARRIER();
+        pStream->dwRingIn = dwIn + (uint32_t) stLength;
+    }
+    return stLength;
+}
+/******************************************************************************
+ End of function  usbhIsocRingPut
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocRingGet
+ Description:   Function to take data from the PCM ring. Only the consumer
+ calls this.
+ Arguments:     IN  pStream - Pointer to the stream
+ OUT pbyDest - Pointer to the destination memory
+ IN  stLength - The maximum length to take
+ Return value:  The number of bytes taken from the ring
+ ******************************************************************************/
+static size_t usbhIsocRingGet (PUSBSM pStream, uint8_t *pbyDest, size_t stLength)
+{
+    uint32_t dwOut = pStream->dwRingOut;
+    uint32_t dwUsed = pStream->dwRingIn - dwOut;
+    uint32_t dwOffset = dwOut & (pStream->dwRingSize - 1UL);
+    uint32_t dwFirst;
+
+    if (stLength > dwUsed)
+    {
+        stLength = (size_t) dwUsed;
+    }
+    if (stLength)
+    {
+        USBH_ISOC_RING_BARRIER();
+        dwFirst = pStream->dwRingSize - dwOffset;
+        if (dwFirst > stLength)
+        {
+            dwFirst = (uint32_t) stLength;
+        }
+        memcpy(pbyDest, pStream->pbyRing + dwOffset, dwFirst);
+        memcpy(pbyDest + dwFirst, pStream->pbyRing, stLength - dwFirst);
+        USBH_ISOC_RING_BARRIER();
+        pStream->dwRingOut = dwOut + (uint32_t) stLength;
+    }
+    return stLength;
+}
+/******************************************************************************
+ End of function  usbhIsocRingGet
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhIsocStreamFree
+ Description:   Function to free the resources of a stream
+ Arguments:     IN  pStream - Pointer to the stream
+ IN  iNumEvents - The number of request events that were created
+ Return value:  none
+ ******************************************************************************/
+static void usbhIsocStreamFree (PUSBSM pStream, int iNumEvents)
+{
+    while (iNumEvents--)
+    {
+        R_OS_DeleteEvent(&pStream->request[iNumEvents].ioSignal);
+    }
+    if (pStream->pbyPacketMemory)
+    {
+        R_OS_FreeMem(pStream->pbyPacketMemory);
+        pStream->pbyPacketMemory = NULL;
+    }
+}
+/******************************************************************************
+ End of function  usbhIsocStreamFree
+ ******************************************************************************/
+
 /******************************************************************************
  End  Of File
  ******************************************************************************/
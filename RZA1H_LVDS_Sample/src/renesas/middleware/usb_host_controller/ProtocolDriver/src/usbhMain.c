@@ -107,11 +107,12 @@ static void usbHostSchedule (PUSBHC pUsbHc);
 #endif
 
 static void usbhDestroyHubInformation (PUSBHI pHub);
-static int usbhCancelRequests (PUSBEI pEndpoint, PUSBTR pRequestList);
+static int usbhCancelRequests (PUSBEI pEndpoint);
 static _Bool usbhValidDevice (PUSBDI pDevice);
 static void usbhAddTransferRequest (PUSBTR pRequest);
 static _Bool usbhRemoveTransferRequest (PUSBTR pRequest);
-static void usbhSafeRemove (PUSBHC pUsbHc, PUSBTR pRequest);
+static _Bool usbhDequeueRequest (PUSBTR pRequest);
+static void usbhSafeRemove (PUSBTR pRequest);
 static PUSBEI usbhCreateEndpointInformation (PUSBEP pUsbEpDesc);
 static PUSBEI usbhCreatControlEndpointInformation (PUSBDI pDevice, uint16_t wPacketSize, USBDIR transferDirection);
 static uint16_t usbhGetWord (uint16_t * pWord);
@@ -175,10 +176,17 @@ static _Bool gbfEnumeratorStarted = false;
 _Bool usbhOpen (PUSBHC pUsbHc)
 {
     int iIndex = USBH_MAX_CONTROLLERS;
+    int iPipe;
 
     /* Reset the host controller data */
     memset(pUsbHc, 0, sizeof(USBHC));
 
+    /* No pipe has a DMA channel assigned */
+    for (iPipe = 0; iPipe < USBH_MAX_NUM_PIPES; iPipe++)
+    {
+        pUsbHc->pPipeTrack[iPipe].iDmaChannel = -1;
+    }
+
     /* The upper level API abstracts from the physical number of host
      controllers attached to the system. Therefore there is only one
      enumerator */
@@ -318,6 +326,42 @@ _Bool usbhComplete (PUSBTR pRequest)
  End of function  usbhComplete
  ******************************************************************************/
 
+/******************************************************************************
+ Function Name: usbhQueueTransfer
+ Description:   Function to put a request that has been set up by the caller
+ on the queue of its endpoint. The request keeps its complete
+ function so it can be put back on the queue from the interrupt
+ when it completes.
+ Arguments:     IN  pRequest - Pointer to the request
+ Return value:  true if the request was added
+ NOTE: Requires mutually exclusive access to protect list, which is the
+ case in the complete function
+ ******************************************************************************/
+_Bool usbhQueueTransfer (PUSBTR pRequest)
+{
+    if ((pRequest->bfQueued) || (!usbhValidDevice(pRequest->pEndpoint->pDevice)))
+    {
+        return false;
+    }
+
+    /* Reset the progress of the transfer */
+    pRequest->pInternal = NULL;
+    pRequest->pCancel = NULL;
+    pRequest->bfInProgress = false;
+    pRequest->stTransferSize = 0;
+    pRequest->stIdx = 0;
+    pRequest->dwIdleTime = pRequest->dwIdleTimeOut;
+    pRequest->uiTransferLength = 0;
+    pRequest->errorCode = USBH_NO_ERROR;
+
+    /* Add the request to the list */
+    usbhAddTransferRequest(pRequest);
+    return true;
+}
+/******************************************************************************
+ End of function  usbhQueueTransfer
+ ******************************************************************************/
+
 /******************************************************************************
  Function Name: usbhIdleTimerTick
  Description:   Function to perform an Idle time-out function and should be
@@ -468,7 +512,7 @@ _Bool usbhStartTransfer (PUSBDI pDevice, PUSBTR pRequest, PUSBEI pEndpoint, uint
 
         /* ACQUIRE MUTEX LIST LOCK */
         iUnlock = R_OS_SysLock(NULL);
-        usbhSafeRemove(pUsbHc, pRequest);
+        usbhSafeRemove(pRequest);
 
         /* RELEASE MUTEX LIST LOCK */
         R_OS_SysUnlock(NULL, iUnlock);
@@ -535,7 +579,7 @@ _Bool usbhIsocTransfer (PUSBDI pDevice, PUSBTR pRequest, PUSBIV pIsocPacketSize,
         /* ACQUIRE MUTEX LIST LOCK */
         iUnlock = R_OS_SysLock(NULL);
 
-        usbhSafeRemove(pUsbHc, pRequest);
+        usbhSafeRemove(pRequest);
 
         /* RELEASE MUTEX LIST LOCK */
         R_OS_SysUnlock(NULL, iUnlock);
@@ -610,37 +654,13 @@ _Bool usbhCancelTransfer (PUSBTR pRequest)
 int usbhCancelAllTransferReqests (PUSBDI pDevice)
 {
     int iCount = 0;
-    int iIndex = USBH_MAX_CONTROLLERS;
     PUSBEI pEndpoint = pDevice->pEndpoint;
-    while (iIndex--)
+    /* For each endpoint that the device has */
+    while (pEndpoint)
     {
-        if (gpHcdLst[iIndex].bfAllocated)
-        {
-            /* Check the control list pointer */
-            if (gpHcdLst[iIndex].pUsbHc->pControl)
-            {
-                /* Cancel any control requests */
-                iCount += usbhCancelRequests(pEndpoint, gpHcdLst[iIndex].pUsbHc->pControl);
-            }
-            /* Check the Interrupt list pointer */
-            if (gpHcdLst[iIndex].pUsbHc->pInterrupt)
-            {
-                /* Cancel any interrupt requests */
-                iCount += usbhCancelRequests(pEndpoint, gpHcdLst[iIndex].pUsbHc->pInterrupt);
-            }
-            /* Check the bulk list pointer */
-            if (gpHcdLst[iIndex].pUsbHc->pBulk)
-            {
-                /* Cancel any bulk requests */
-                iCount += usbhCancelRequests(pEndpoint, gpHcdLst[iIndex].pUsbHc->pBulk);
-            }
-            /* Check the Isochronus list pointer */
-            if (gpHcdLst[iIndex].pUsbHc->pIsochronus)
-            {
-                /* Cancel any Isochronus requests */
-                iCount += usbhCancelRequests(pEndpoint, gpHcdLst[iIndex].pUsbHc->pIsochronus);
-            }
-        }
+        /* Cancel any requests queued on it */
+        iCount += usbhCancelRequests(pEndpoint);
+        pEndpoint = pEndpoint->pNext;
     }
     return iCount;
 }
@@ -727,6 +747,10 @@ REQERR _usbhDeviceRequest (PUSBTR pRequest, PUSBDI pDevice, uint8_t bmRequestTyp
     PUSBEI pStatus = NULL, pSetup = pDevice->pControlSetup;
 
     /* Create the events for the setup phase */
+    /* The requests are checked for a queue entry before they are used */
+    memset(&setupRequest, 0, sizeof(USBTR));
+    memset(&statusRequest, 0, sizeof(USBTR));
+
     ret = R_OS_CreateEvent(&setupRequest.ioSignal);
 
     if(false == ret)
@@ -1439,30 +1463,42 @@ static void usbhDestroyHubInformation (PUSBHI pHub)
 
 /******************************************************************************
  Function Name: usbhCancelRequests
- Description:   Function to search a request list and cancel requests
- Arguments:     IN  pEndpoint - Pointer to the list of endpoints
- IN  pRequestList - Pointer to the request list
+ Description:   Function to cancel the requests queued on an endpoint
+ Arguments:     IN  pEndpoint - Pointer to the endpoint
  Return value:  The number of requests calcelled
  ******************************************************************************/
-static int usbhCancelRequests (PUSBEI pEndpoint, PUSBTR pRequestList)
+static int usbhCancelRequests (PUSBEI pEndpoint)
 {
     int iCount = 0;
-    /* For each endpoint that the device has */
-    while (pEndpoint)
+    PUSBTR pRequest;
+    if (USBH_CONTROL == pEndpoint->transferType)
     {
-        PUSBTR pRequest = pRequestList;
-        /* Look for it on the list */
+        /* Control requests are kept in a single list for all endpoints */
+        pRequest = pEndpoint->pDevice->pPort->pUsbHc->pControl;
         while (pRequest)
         {
+            PUSBTR pNext = pRequest->pNext;
             if (pRequest->pEndpoint == pEndpoint)
             {
                 pRequest->errorCode = REQ_DEVICE_NOT_FOUND;
                 usbhCancelTransfer(pRequest);
                 iCount++;
             }
-            pRequest = pRequest->pNext;
+            pRequest = pNext;
         }
-        pEndpoint = pEndpoint->pNext;
+        return iCount;
+    }
+    pRequest = pEndpoint->pQueueHead;
+    /* Cancel from the head of the queue until it is empty */
+    while (pRequest)
+    {
+        pRequest->errorCode = REQ_DEVICE_NOT_FOUND;
+        if (!usbhCancelTransfer(pRequest))
+        {
+            break;
+        }
+        iCount++;
+        pRequest = pEndpoint->pQueueHead;
     }
     return iCount;
 }
@@ -1500,55 +1536,163 @@ static _Bool usbhValidDevice (PUSBDI pDevice)
  ******************************************************************************/
 
 /******************************************************************************
- Function Name: usbhAddTransferRequest
- Description:   Function to add a transfer request to the top of the appropriate
- list
- Arguments:     pRequest - Pointer to the request
- Return value:  none
+ Function Name: usbhGetRequestList
+ Description:   Function to get the list of endpoint queues that a request
+ belongs on
+ Arguments:     IN  pRequest - Pointer to the request
+ OUT ppHead - Pointer to the list head pointer
+ OUT ppTail - Pointer to the list tail pointer
+ Return value:  true if the transfer type is known
  ******************************************************************************/
-static void usbhAddTransferRequest (PUSBTR pRequest)
+static _Bool usbhGetRequestList (PUSBTR pRequest, PUSBTR **pppHead, PUSBTR **pppTail)
 {
-    PUSBTR *ppRequestList;
-
-    /* Mark the request as incomplete */
-    R_OS_ResetEvent(&pRequest->ioSignal);
-
+    PUSBHC pUsbHc = pRequest->pUsbHc;
     switch (pRequest->pEndpoint->transferType)
     {
         case USBH_CONTROL :
-            ppRequestList = &pRequest->pUsbHc->pControl;
+            *pppHead = &pUsbHc->pControl;
+            *pppTail = &pUsbHc->pControlTail;
         break;
 
         case USBH_ISOCHRONOUS :
-
-            ppRequestList = &pRequest->pUsbHc->pIsochronus;
+            *pppHead = &pUsbHc->pIsochronus;
+            *pppTail = &pUsbHc->pIsochronusTail;
         break;
 
         case USBH_BULK :
-            ppRequestList = &pRequest->pUsbHc->pBulk;
+            *pppHead = &pUsbHc->pBulk;
+            *pppTail = &pUsbHc->pBulkTail;
         break;
 
         case USBH_INTERRUPT :
-            ppRequestList = &pRequest->pUsbHc->pInterrupt;
+            *pppHead = &pUsbHc->pInterrupt;
+            *pppTail = &pUsbHc->pInterruptTail;
         break;
 
         default :
-            TRACE(("usbhAddTransferRequest: Unknown transfer type\r\n"));
-            return;
+            return false;
     }
-    /* Add to the end of the list */
-    while (*ppRequestList)
+    return true;
+}
+/******************************************************************************
+ End of function  usbhGetRequestList
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhListAppend
+ Description:   Function to add a request to the end of a transfer list
+ Arguments:     IN  ppHead - Pointer to the list head pointer
+ IN  ppTail - Pointer to the list tail pointer
+ IN  pRequest - Pointer to the request
+ Return value:  none
+ ******************************************************************************/
+static void usbhListAppend (PUSBTR *ppHead, PUSBTR *ppTail, PUSBTR pRequest)
+{
+    pRequest->pNext = NULL;
+    pRequest->pPrev = *ppTail;
+    if (*ppTail)
     {
-        ppRequestList = &(*ppRequestList)->pNext;
+        (*ppTail)->pNext = pRequest;
     }
-    if (*ppRequestList)
+    else
     {
-        *ppRequestList = pRequest;
+        *ppHead = pRequest;
+    }
+    *ppTail = pRequest;
+}
+/******************************************************************************
+ End of function  usbhListAppend
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhListRemove
+ Description:   Function to remove a request from a transfer list
+ Arguments:     IN  ppHead - Pointer to the list head pointer
+ IN  ppTail - Pointer to the list tail pointer
+ IN  pRequest - Pointer to the request
+ Return value:  none
+ ******************************************************************************/
+static void usbhListRemove (PUSBTR *ppHead, PUSBTR *ppTail, PUSBTR pRequest)
+{
+    if (pRequest->pPrev)
+    {
+        pRequest->pPrev->pNext = pRequest->pNext;
     }
     else
     {
-        pRequest->pNext = *ppRequestList;
-        *ppRequestList = pRequest;
+        *ppHead = pRequest->pNext;
+    }
+    if (pRequest->pNext)
+    {
+        pRequest->pNext->pPrev = pRequest->pPrev;
+    }
+    else
+    {
+        *ppTail = pRequest->pPrev;
+    }
+    pRequest->pNext = NULL;
+    pRequest->pPrev = NULL;
+}
+/******************************************************************************
+ End of function  usbhListRemove
+ ******************************************************************************/
+
+/******************************************************************************
+ Function Name: usbhAddTransferRequest
+ Description:   Function to add a transfer request to the end of the queue of
+ its endpoint. The request at the head of each endpoint queue is
+ also put on the list for its transfer type so the scheduler only
+ sees the requests that can be started. The phases of a control
+ transfer use different endpoints and must be done in the order
+ they were requested so control requests all go on one list.
+ Arguments:     pRequest - Pointer to the request
+ Return value:  none
+ NOTE: Requires mutually exclusive access to protect list
+ ******************************************************************************/
+static void usbhAddTransferRequest (PUSBTR pRequest)
+{
+    PUSBEI pEndpoint = pRequest->pEndpoint;
+    PUSBTR *ppHead;
+    PUSBTR *ppTail;
+
+    /* Mark the request as incomplete */
+    R_OS_ResetEvent(&pRequest->ioSignal);
+
+    if (!usbhGetRequestList(pRequest, &ppHead, &ppTail))
+    {
+        TRACE(("usbhAddTransferRequest: Unknown transfer type\r\n"));
+        return;
+    }
+
+    if (USBH_CONTROL == pEndpoint->transferType)
+    {
+        usbhListAppend(ppHead, ppTail, pRequest);
+    }
+    else
+    {
+        /* Add to the end of the endpoint queue */
+        pRequest->pQueueNext = NULL;
+        pRequest->pQueuePrev = pEndpoint->pQueueTail;
+        if (pEndpoint->pQueueTail)
+        {
+            pEndpoint->pQueueTail->pQueueNext = pRequest;
+        }
+        else
+        {
+            /* The endpoint was idle so this request can be scheduled */
+            pEndpoint->pQueueHead = pRequest;
+            usbhListAppend(ppHead, ppTail, pRequest);
+        }
+        pEndpoint->pQueueTail = pRequest;
+    }
+    pRequest->bfQueued = true;
+    pRequest->dwQueuedFrame = pRequest->pUsbHc->dwFrameCount;
+
+    /* Keep the queue statistics */
+    pEndpoint->dwQueueDepth++;
+    if (pEndpoint->dwQueueDepth > pEndpoint->dwQueueDepthMax)
+    {
+        pEndpoint->dwQueueDepthMax = pEndpoint->dwQueueDepth;
     }
 }
 /******************************************************************************
@@ -1556,32 +1700,95 @@ static void usbhAddTransferRequest (PUSBTR pRequest)
  ******************************************************************************/
 
 /******************************************************************************
- Function Name: usbhRemoveRequest
- Description:   Function to remove the request from a list
- Parameters:    IN  ppRequestList - Pointer to the request list pointer
- IN  pRequest - Pointer to the request to remove
+ Function Name: usbhDequeueRequest
+ Description:   Function to remove a request from the queue of its endpoint.
+ When the request is at the head of the queue the next request
+ takes its place on the list for the transfer type.
+ Parameters:    IN  pRequest - Pointer to the request to remove
  Return value:  true if the request was removed
+ NOTE: Requires mutually exclusive access to protect list
  ******************************************************************************/
-static _Bool usbhRemoveRequest (PUSBTR *ppRequestList, PUSBTR pRequest)
+static _Bool usbhDequeueRequest (PUSBTR pRequest)
 {
-    _Bool bfResult = false;
-    /* Search the list for the request */
-    while ((*ppRequestList != NULL) && (*ppRequestList != pRequest))
+    PUSBEI pEndpoint = pRequest->pEndpoint;
+    PUSBTR *ppHead;
+    PUSBTR *ppTail;
+    uint32_t dwLatency;
+
+    if ((!pRequest->bfQueued) || (NULL == pEndpoint))
     {
-        ppRequestList = &(*ppRequestList)->pNext;
+        return false;
     }
-    /* If it has been found */
-    if (*ppRequestList)
+
+    if (!usbhGetRequestList(pRequest, &ppHead, &ppTail))
     {
-        /* Delete from the list */
-        *ppRequestList = (*ppRequestList)->pNext;
-        pRequest->pNext = NULL;
-        bfResult = true;
+        return false;
     }
-    return bfResult;
+
+    if (USBH_CONTROL == pEndpoint->transferType)
+    {
+        /* Check that the request really is on the list */
+        if (pRequest->pPrev ? (pRequest->pPrev->pNext != pRequest) : (*ppHead != pRequest))
+        {
+            return false;
+        }
+        usbhListRemove(ppHead, ppTail, pRequest);
+    }
+    else
+    {
+        /* Check that the request really is on the queue */
+        if (pRequest->pQueuePrev ?
+                (pRequest->pQueuePrev->pQueueNext != pRequest) : (pEndpoint->pQueueHead != pRequest))
+        {
+            return false;
+        }
+
+        if (pEndpoint->pQueueHead == pRequest)
+        {
+            /* Take it off the transfer list and schedule the next request */
+            usbhListRemove(ppHead, ppTail, pRequest);
+            if (pRequest->pQueueNext)
+            {
+                usbhListAppend(ppHead, ppTail, pRequest->pQueueNext);
+            }
+        }
+
+        /* Unlink from the endpoint queue */
+        if (pRequest->pQueuePrev)
+        {
+            pRequest->pQueuePrev->pQueueNext = pRequest->pQueueNext;
+        }
+        else
+        {
+            pEndpoint->pQueueHead = pRequest->pQueueNext;
+        }
+        if (pRequest->pQueueNext)
+        {
+            pRequest->pQueueNext->pQueuePrev = pRequest->pQueuePrev;
+        }
+        else
+        {
+            pEndpoint->pQueueTail = pRequest->pQueuePrev;
+        }
+    }
+
+    /* Keep the queue statistics, the latency is measured in frames */
+    dwLatency = pRequest->pUsbHc->dwFrameCount - pRequest->dwQueuedFrame;
+    pEndpoint->dwQueueDepth--;
+    pEndpoint->dwRequestCount++;
+    pEndpoint->dwLatencyTotal += dwLatency;
+    if (dwLatency > pEndpoint->dwLatencyMax)
+    {
+        pEndpoint->dwLatencyMax = dwLatency;
+    }
+
+    pRequest->pQueueNext = NULL;
+    pRequest->pQueuePrev = NULL;
+    pRequest->bfQueued = false;
+    return true;
 }
 /******************************************************************************
- End of function  usbhRemoveRequest
+ End of function  usbhDequeueRequest
  ******************************************************************************/
 
 char_t evlu[][12] =
@@ -1600,42 +1807,22 @@ char_t evlu[][12] =
 static _Bool usbhRemoveTransferRequest (PUSBTR pRequest)
 {
    volatile  _Bool bfReturn = false;
-    PUSBTR *ppRequestList;
-    if (pRequest->pEndpoint)
-    {
-        switch (pRequest->pEndpoint->transferType)
-        {
-            case USBH_CONTROL :
-                ppRequestList = &pRequest->pUsbHc->pControl;
-            break;
-
-            case USBH_ISOCHRONOUS :
-                ppRequestList = &pRequest->pUsbHc->pIsochronus;
-            break;
-
-            case USBH_BULK :
-                ppRequestList = &pRequest->pUsbHc->pBulk;
-            break;
-
-            case USBH_INTERRUPT :
-                ppRequestList = &pRequest->pUsbHc->pInterrupt;
-            break;
-
-            default :
-                TRACE(("usbhRemoveTransferRequest: Unknown transfer type\r\n"));
-                return bfReturn;
-        }
-    }
-    else
+    if (NULL == pRequest->pEndpoint)
     {
         return bfReturn;
     }
 
     /* Remove the request */
-    bfReturn = usbhRemoveRequest(ppRequestList, pRequest);
+    bfReturn = usbhDequeueRequest(pRequest);
 
     R_OS_SetEvent(&pRequest->ioSignal);
 
+    /* Call the optional complete function */
+    if ((bfReturn) && (pRequest->pComplete))
+    {
+        pRequest->pComplete(pRequest);
+    }
+
     return bfReturn;
 }
 /******************************************************************************
@@ -1645,22 +1832,12 @@ static _Bool usbhRemoveTransferRequest (PUSBTR pRequest)
 /******************************************************************************
  Function Name: usbhSafeRemove
  Description:   Function to remove a transfer request that is not initialised
- Parameters:    IN  pUsbUc - Pointer to the USB host controller data
- IN  pRequest - Pointer to the request to remove
+ Parameters:    IN  pRequest - Pointer to the request to remove
  Return value:  none
  ******************************************************************************/
-static void usbhSafeRemove (PUSBHC pUsbHc, PUSBTR pRequest)
+static void usbhSafeRemove (PUSBTR pRequest)
 {
-    if (!usbhRemoveRequest(&pUsbHc->pControl, pRequest))
-    {
-        if (!usbhRemoveRequest(&pUsbHc->pBulk, pRequest))
-        {
-            if (!usbhRemoveRequest(&pUsbHc->pInterrupt, pRequest))
-            {
-                usbhRemoveRequest(&pUsbHc->pIsochronus, pRequest);
-            }
-        }
-    }
+    usbhDequeueRequest(pRequest);
 }
 /******************************************************************************
  End of function  usbhSafeRemove
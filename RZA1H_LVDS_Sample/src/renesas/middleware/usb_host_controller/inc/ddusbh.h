@@ -268,6 +268,21 @@ typedef struct _USBEI
                                        transaction */
     USBDP    dataPID;               /* The DATA0/1 PID */
     _Bool    bfAllocated;           /* true if allocated */
+                                    /* The queue of requests on this
+                                       endpoint. Only the request at the
+                                       head is on the host controller
+                                       transfer list */
+    PUSBTR   pQueueHead;
+    PUSBTR   pQueueTail;
+                                    /* Queue statistics */
+    uint32_t dwQueueDepth;          /* The number of requests queued */
+    uint32_t dwQueueDepthMax;       /* The greatest number queued */
+    uint32_t dwRequestCount;        /* The number of requests completed or
+                                       cancelled */
+    uint32_t dwLatencyTotal;        /* The total time in frames that those
+                                       requests were queued */
+    uint32_t dwLatencyMax;          /* The longest time in frames that a
+                                       request was queued */
 } USBEI;
 
 /* Define the structure of the data used by the host controller */
@@ -276,13 +291,23 @@ typedef struct _USBHC
     /* Pointers to a lists of hubs, ports and devices attached */
     PUSBPI  pPort;
 
-    /* The transfer lists */
+    /* The transfer lists. These hold the request at the head of each
+       endpoint queue */
     PUSBTR  pControl;
     PUSBTR  pCurrentControl;
     PUSBTR  pInterrupt;
     PUSBTR  pBulk;
     PUSBTR  pIsochronus;
 
+    /* The last request on each transfer list */
+    PUSBTR  pControlTail;
+    PUSBTR  pInterruptTail;
+    PUSBTR  pBulkTail;
+    PUSBTR  pIsochronusTail;
+
+    /* The number of frames since the host controller was opened */
+    uint32_t dwFrameCount;
+
     /* A structure of data used to keeps track of pipe activity so the
        idle time-out can be implemented by the host driver and USB stack */
     struct
@@ -302,6 +327,11 @@ typedef struct _USBHC
         /* When an IN DMA is used to transfer data on a pipe this is set true
            and is cleared to zero when the transfer is complete */
         _Bool    bfTerminateInDma;
+
+        /* The DMA channel and the DMA FIFO port assigned to the pipe for
+           the current transfer or -1 when the pipe is accessed by FIFO */
+        int      iDmaChannel;
+        int      iDmaFifo;
     } pPipeTrack[USBH_MAX_NUM_PIPES];
 
     /* The pipe assignment information - entry for pipe 0 is never used as
@@ -354,6 +384,7 @@ typedef struct _USBTC
 typedef struct _USBTR
 {
     PUSBTR   pNext;                 /* List pointer */
+    PUSBTR   pPrev;                 /* List pointer */
     PUSB     pUSB;                  /* Pointer to the Host Controller to which
                                        the port is attached */
     PUSBHC   pUsbHc;                /* Pointer to the host controller data */
@@ -370,6 +401,10 @@ typedef struct _USBTR
     size_t   stTransferSize;        /* The size of the last transfer made by
                                        the hardware driver*/
     uint32_t dwIdleTime;            /* Idle time in mS */
+    PUSBTR   pQueueNext;            /* Endpoint queue pointers */
+    PUSBTR   pQueuePrev;
+    _Bool    bfQueued;              /* true while on an endpoint queue */
+    uint32_t dwQueuedFrame;         /* The frame count when queued */
 
                                     /* IN */
     uint8_t  *pMemory;              /* A pointer to the memory to transfer */
@@ -379,6 +414,10 @@ typedef struct _USBTR
     uint32_t dwIdleTimeOut;         /* An transfer idle time-out in mS */
     PUSBIV   pIsocPacketSize;       /* Pointer to the isochronous packet size
                                        schedule */
+    void     (*pComplete)(PUSBTR);  /* Optional function called from the
+                                       interrupt when the request is removed
+                                       from its endpoint queue */
+    void     *pvCompleteParam;      /* Parameter for the complete function */
 
                                     /* OUT */
     uint32_t uiTransferLength;      /* The number of bytes transfered */
@@ -387,6 +426,53 @@ typedef struct _USBTR
                                        transfer */
 } USBTR;
 
+/* Define the statistics kept by an isochronous stream */
+typedef struct _USBSMS
+{
+    uint32_t dwPackets;             /* The number of packets transferred */
+    uint32_t dwBytes;               /* The number of bytes transferred */
+    uint32_t dwEmptyPackets;        /* IN packets with no data */
+    uint32_t dwErrors;              /* Requests completed with an error */
+    uint32_t dwOverruns;            /* IN packets dropped on a full ring */
+    uint32_t dwUnderruns;           /* OUT packets padded from an empty ring */
+    uint32_t dwLateFrames;          /* Completions later than the endpoint
+                                       interval */
+    uint32_t dwMaxInterval;         /* The longest time in frames between
+                                       completions */
+    uint32_t dwLastFrame;           /* The frame count at the last
+                                       completion */
+} USBSMS,
+*PUSBSMS;
+
+/* Define the structure of an isochronous stream. The requests are kept in
+   flight on the endpoint queue and each is put back on the queue from the
+   interrupt when it completes. The PCM ring has a single producer and a
+   single consumer and needs no lock. */
+typedef struct _USBSM
+{
+    PUSBDI   pDevice;               /* Pointer to the device */
+    PUSBEI   pEndpoint;             /* Pointer to the isochronous endpoint */
+    PUSBIV   pIsocPacketSize;       /* Optional OUT packet size schedule */
+    int      iScheduleIndex;        /* The stream's index into the schedule */
+    int      iNumRequests;          /* The number of requests in flight */
+    size_t   stPacketSize;          /* The size of each request buffer */
+    uint8_t  *pbyPacketMemory;      /* The request buffers */
+    uint32_t dwFrameInterval;       /* The endpoint interval in frames */
+    volatile _Bool bfRunning;       /* true while the requests are re-armed */
+                                    /* The PCM ring */
+    uint8_t  *pbyRing;
+    uint32_t dwRingSize;            /* Size in bytes, a power of two */
+    volatile uint32_t dwRingIn;     /* Written only by the producer */
+    volatile uint32_t dwRingOut;    /* Written only by the consumer */
+                                    /* Optional function called from the
+                                       interrupt after each packet */
+    void     (*pNotify)(void *pvParam);
+    void     *pvNotifyParam;
+    USBSMS   stats;                 /* The stream statistics */
+    USBTR    request[USBH_ISOC_STREAM_MAX_REQUESTS];
+} USBSM,
+*PUSBSM;
+
 #endif /* DDUSBH_H_INCLUDED */
 
 /******************************************************************************
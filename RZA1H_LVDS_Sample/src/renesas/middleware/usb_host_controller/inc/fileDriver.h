@@ -127,6 +127,9 @@ fileLoadDriver (st_stream_ptr_t st_stream_ptr_t, char * pszFileName, int iMode);
  * fileControl - <BR>
  * CTL_FILE_SEEK: Returns position of a file <BR>
  * CTL_FILE_SIZE: Returns the size of a file <BR>
+ * CTL_FILE_CREATE_LINK_MAP: Builds the fast seek cluster link map, optional
+ * uint32_t * table size in DWORDs (0 to size to the file) <BR>
+ * CTL_FILE_DISCARD_LINK_MAP: Frees the fast seek cluster link map <BR>
  * 
  * fileGetVersion - GetVersion of file driver
  */
@@ -56,6 +56,10 @@ Includes   <System Includes> , "Project Includes"
 Macro definitions
 ******************************************************************************/
 
+/* The number of DMA channels available to the USB host. Each host controller
+   has two DMA FIFO ports so more than four can not be used at once */
+#define USB_DMA_NUM_CHANNELS        (4)
+
 /******************************************************************************
 Function Prototypes
 ******************************************************************************/
@@ -66,57 +70,60 @@ extern "C" {
 
 /******************************************************************************
  * Function Name: usbOpenDmaDriver
- * Description  : Open the DMA driver for USBN out and in
+ * Description  : Open the DMA driver channels used by the USB host
  * Arguments    : none
- * Return Value : DRV_SUCCESS or DRV_ERROR
+ * Return Value : DRV_SUCCESS if at least one channel is available otherwise
+ *                DRV_ERROR
  *****************************************************************************/
 extern int_t usbOpenDmaDriver(void);
 
 /******************************************************************************
-Function Name: dmaStartUsbOutCh0
-Description:   Function to start DMA channel 0 for a USB OUT transfer
-               This is where the DMAC writes to the designated pipe FIFO.
-               In this implementation the assignment is DMA Channel 0 always
-               uses the USB D0FIFO.
-Arguments:     IN  pvSrc - Pointer to the 4 byte aligned source memory
-               IN  st_length - The length of data to transfer
-               IN  p_fifo - Pointer to the destination FIFO
-               IN  pv_param - Pointer to pass to the completion routine
-               IN  pf_complete - Pointer to the completion routine
-Return value:  none
+Function Name: dmaAllocUsbChannel
+Description:   Function to allocate a DMA channel and one of the DMA FIFO
+               ports of a host controller to a transfer
+Arguments:     IN  pUSB - Pointer to the host controller
+               OUT piFifo - Pointer to the FIFO port assigned
+                   USBH_DMA_D0FIFO or USBH_DMA_D1FIFO
+Return value:  The channel number or -1 if no channel or port is free
 ******************************************************************************/
 
-extern  void dmaStartUsbOutCh0(void     *pvSrc,
-                               size_t   st_length,
-                               void     *p_fifo,
-                               void     *pv_param,
-                               void (*pf_complete)(void *pv_param));
+extern  int dmaAllocUsbChannel(void *pUSB, int *piFifo);
 
 /******************************************************************************
-Function Name: dmaGetUsbOutCh0Count
-Description:   Function to get the current DMA transfer count
-Arguments:     none
-Return value:  The value of the transfer count register
+Function Name: dmaFreeUsbChannel
+Description:   Function to return a channel to the pool
+Arguments:     IN  iChannel - The channel number
+Return value:  none
 ******************************************************************************/
 
-extern  unsigned long dmaGetUsbOutCh0Count(void);
+extern  void dmaFreeUsbChannel(int iChannel);
 
 /******************************************************************************
-Function Name: dmaStopUsbOutCh0
-Description:   Function to stop a USB OUT DMA transfer on channel 0
-Arguments:     none
+Function Name: dmaStartUsbOut
+Description:   Function to start a DMA channel for a USB OUT transfer
+               This is where the DMAC writes to the designated pipe FIFO.
+Arguments:     IN  iChannel - The channel returned by dmaAllocUsbChannel
+               IN  pvSrc - Pointer to the 4 byte aligned source memory
+               IN  st_length - The length of data to transfer
+               IN  p_fifo - Pointer to the destination FIFO
+               IN  pv_param - Pointer to pass to the completion routine
+               IN  pf_complete - Pointer to the completion routine
 Return value:  none
 ******************************************************************************/
 
-extern  void dmaStopUsbOutCh0(void);
+extern  void dmaStartUsbOut(int      iChannel,
+                            void     *pvSrc,
+                            size_t   st_length,
+                            void     *p_fifo,
+                            void     *pv_param,
+                            void (*pf_complete)(void *pv_param));
 
 /******************************************************************************
-Function Name: dmaStartUsbInCh1
-Description:   Function to start DMA channel 1 for a USB IN transfer
-               This is where the DMAC writes to the designated pipe FIFO.
-               In this implementation the assignment is DMA Channel 1 always
-               uses the USB D1FIFO.
-Arguments:     IN  pv_dest - Pointer to the 4 byte aligned destination memory
+Function Name: dmaStartUsbIn
+Description:   Function to start a DMA channel for a USB IN transfer
+               This is where the DMAC reads from the designated pipe FIFO.
+Arguments:     IN  iChannel - The channel returned by dmaAllocUsbChannel
+               IN  pv_dest - Pointer to the 4 byte aligned destination memory
                IN  st_length - The length of data to transfer
                IN  p_fifo - Pointer to the source FIFO
                IN  pv_param - Pointer to pass to the completion routine
@@ -124,29 +131,31 @@ Arguments:     IN  pv_dest - Pointer to the 4 byte aligned destination memory
 Return value:  none
 ******************************************************************************/
 
-extern  void dmaStartUsbInCh1(void     *pv_dest,
-                              size_t   st_length,
-                              void     *p_fifo,
-                              void     *pv_param,
-                              void (*pf_complete)(void *pv_param));
+extern  void dmaStartUsbIn(int      iChannel,
+                           void     *pv_dest,
+                           size_t   st_length,
+                           void     *p_fifo,
+                           void     *pv_param,
+                           void (*pf_complete)(void *pv_param));
 
 /******************************************************************************
-Function Name: dmaGetUsbInCh1Count
-Description:   Function to get the USB DMA transfer on channel 1
-Arguments:     none
+Function Name: dmaGetUsbCount
+Description:   Function to get the number of bytes a channel has still to
+               transfer
+Arguments:     IN  iChannel - The channel number
 Return value:  The value of the transfer count register
 ******************************************************************************/
 
-extern  unsigned long dmaGetUsbInCh1Count(void);
+extern  unsigned long dmaGetUsbCount(int iChannel);
 
 /******************************************************************************
-Function Name: dmaStopUsbInCh1
-Description:   Function to stop a USB OUT DMA transfer on channel 1
-Arguments:     none
+Function Name: dmaStopUsb
+Description:   Function to stop a USB DMA transfer
+Arguments:     IN  iChannel - The channel number
 Return value:  none
 ******************************************************************************/
 
-extern  void dmaStopUsbInCh1(void);
+extern  void dmaStopUsb(int iChannel);
 
 #ifdef __cplusplus
 }
@@ -57,6 +57,10 @@ Macro definitions
 #define USBH_PIPE_NUMBER_ANY        -1
 #define USBH_MAX_NUM_PIPES          10
 
+/* The DMA FIFO ports of each host controller */
+#define USBH_DMA_D0FIFO             0
+#define USBH_DMA_D1FIFO             1
+
 /******************************************************************************
 Typedef definitions
 ******************************************************************************/
@@ -276,6 +280,18 @@ extern  void R_USBH_ClearPipeInterrupt(PUSB  pUSB,
                                        int   iPipeNumber,
                                        USBIP buffIntType);
 
+/******************************************************************************
+Function Name: R_USBH_GetPipeInterruptMap
+Description:   Function to get the pipes other than pipe 0 with an enabled
+               interrupt status flag set
+Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+               IN  buffIntType - The interrupt type
+Return value:  A bit map with bit n set for pipe n
+******************************************************************************/
+
+extern  uint16_t R_USBH_GetPipeInterruptMap(PUSB  pUSB,
+                                            USBIP buffIntType);
+
 /******************************************************************************
 Function Name: R_USBH_GetPipeInterrupt
 Description:   Function to get the state of the pipe interrupt status flag
@@ -338,21 +354,25 @@ Description:   Function to configure a pipe for the DMA to write to it
 Arguments:     IN  pUSB - Pointer to the Host Controller hardware
                IN  iPipeNumber - The pipe to configure
                IN  wNumPackets - The number of packets to be written
+               IN  iDmaFifo - The DMA FIFO port to use USBH_DMA_D0FIFO or
+                   USBH_DMA_D1FIFO
 Return value:  0 for success -1 on error
 ******************************************************************************/
 
 extern  int R_USBH_DmaWritePipe(PUSB        pUSB,
                                 int         iPipeNumber,
-                                uint16_t    wNumPackets);
+                                uint16_t    wNumPackets,
+                                int         iDmaFifo);
 
 /******************************************************************************
 Function Name: R_USBH_StopDmaPipe
 Description:   Function to unconfigure a pipe from a DMA transfer
 Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+               IN  iDmaFifo - The DMA FIFO port used by the transfer
 Return value:  none
 ******************************************************************************/
 
-extern  void R_USBH_StopDmaPipe(PUSB pUSB);
+extern  void R_USBH_StopDmaPipe(PUSB pUSB, int iDmaFifo);
 
 /******************************************************************************
 Function Name: R_USBH_ReadPipe
@@ -390,31 +410,26 @@ Description:   Function to configure a pipe for the DMA to read from it
 Arguments:     IN  pUSB - Pointer to the Host Controller hardware
                IN  iPipeNumber - The pipe to configure
                IN  wNumPackets - The number of packets to be read
+               IN  iDmaFifo - The DMA FIFO port to use USBH_DMA_D0FIFO or
+                   USBH_DMA_D1FIFO
 Return value:  0 for success -1 on error
 ******************************************************************************/
 
 extern  int R_USBH_DmaReadPipe(PUSB     pUSB,
                                int      iPipeNumber,
-                               uint16_t wNumPackets);
-
-/******************************************************************************
-Function Name: R_USBH_StopDmaReadPipe
-Description:   Function to unconfigure a pipe from a DMA read
-Arguments:     IN  pUSB - Pointer to the Host Controller hardware
-Return value:  none
-******************************************************************************/
-
-extern  void R_USBH_StopDmaReadPipe(PUSB pUSB);
+                               uint16_t wNumPackets,
+                               int      iDmaFifo);
 
 /******************************************************************************
 Function Name: R_USBH_DmaFIFO
 Description:   Function to get a pointer to the DMA FIFO
 Arguments:     IN  pUSB - Pointer to the Host Controller hardware
-               IN  transferDirection - The direction of transfer
+               IN  iDmaFifo - The DMA FIFO port USBH_DMA_D0FIFO or
+                   USBH_DMA_D1FIFO
 Return value:  Pointer to the DMA FIFO
 ******************************************************************************/
 
-extern  void *R_USBH_DmaFIFO(PUSB pUSB, USBDIR transferDirection);
+extern  void *R_USBH_DmaFIFO(PUSB pUSB, int iDmaFifo);
 
 /******************************************************************************
 Function Name: R_USBH_DmaTransac
@@ -426,6 +441,26 @@ Return value:  The value of the transaction counter
 
 extern  uint16_t R_USBH_DmaTransac(PUSB pUSB, int iPipeNumber);
 
+/******************************************************************************
+Function Name: R_USBH_DmaPipe
+Description:   Function to check that a pipe can be serviced by the DMAC
+Arguments:     IN  iPipeNumber - The number of the pipe
+Return value:  true if the D0FIFO / D1FIFO can be assigned to the pipe
+******************************************************************************/
+
+extern  _Bool R_USBH_DmaPipe(int iPipeNumber);
+
+/******************************************************************************
+Function Name: R_USBH_PipeBufferReady
+Description:   Function to check the buffer status of a pipe without
+               selecting it on a FIFO port
+Arguments:     IN  pUSB - Pointer to the Host Controller hardware
+               IN  iPipeNumber - The number of the pipe
+Return value:  true if the pipe buffer can be accessed by the CPU
+******************************************************************************/
+
+extern  _Bool R_USBH_PipeBufferReady(PUSB pUSB, int iPipeNumber);
+
 /******************************************************************************
 Function Name: R_USBH_SetDevAddrCfg
 Description:   Function to set the appropriate Device Address Configuration
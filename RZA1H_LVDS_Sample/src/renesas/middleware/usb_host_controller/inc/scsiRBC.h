@@ -105,6 +105,27 @@ extern  int scsiRead10(int       iMsDev,
                        size_t    stDestLength,
                        size_t    *pstLengthRead);
 
+/******************************************************************************
+Function Name: scsiRead16
+Description:   Function to read from the media with the 16 byte command
+Arguments:     IN  iMsDev - The mass storage device file descriptor
+               IN  iLun - The logical uint number
+               IN  qwLBA - The logical block address
+               IN  dwNumBlocks - The number of blocks
+               OUT pbyDest - Pointer to the destination memory
+               IN  stDestLength - The length of the destination memory
+               OUT pstLengthRead - Pointer to the length of data read in bytes
+Return value:  0 for success otherwise error code
+******************************************************************************/
+
+extern  int scsiRead16(int       iMsDev,
+                       int       iLun,
+                       uint64_t  qwLBA,
+                       uint32_t  dwNumBlocks,
+                       uint8_t * pbyDest,
+                       size_t    stDestLength,
+                       size_t    *pstLengthRead);
+
 /******************************************************************************
 Function Name: scsiReadCapacity
 Description:   Function to read the capacity of the medium
@@ -120,6 +141,22 @@ extern  int scsiReadCapacity10(int      iMsDev,
                                uint32_t *   pdwNumBlocks,
                                uint32_t *   pdwBlockSize);
 
+/******************************************************************************
+Function Name: scsiReadCapacity16
+Description:   Function to read the capacity of media with more than 2^32
+               blocks
+Arguments:     IN  iMsDev - The mass storage device file descriptor
+               IN  iLun - The logical uint number
+               OUT pqwNumBlocks - Pointer to the number of blocks
+               OUT pdwBlockSize - Pointer to the length of the block
+Return value:  0 for success otherwise error code
+******************************************************************************/
+
+extern  int scsiReadCapacity16(int      iMsDev,
+                               int      iLun,
+                               uint64_t *   pqwNumBlocks,
+                               uint32_t *   pdwBlockSize);
+
 /******************************************************************************
 Function Name: scsiStartStopUnit
 Description:   Function to start and stop the unit
@@ -153,6 +190,28 @@ extern  int scsiWrite10(int       iMsDev,
                         size_t    stSrcLength,
                         size_t *  pstLengthWritten);
                 
+/******************************************************************************
+Function Name: scsiWrite16
+Description:   Function to write to the media with the 16 byte command
+Arguments:     IN  iMsDev - The mass storage device file descriptor
+               IN  iLun - The logical uint number
+               IN  qwLBA - The logical block address
+               IN  dwNumBlocks - The number of blocks
+               OUT pbySrc - Pointer to the source memory
+               IN  stSrcLength - The length of the source memory
+               OUT pstLengthWritten - Pointer to the length of data written in
+                                      bytes
+Return value:  0 for success otherwise error code
+******************************************************************************/
+
+extern  int scsiWrite16(int       iMsDev,
+                        int       iLun,
+                        uint64_t  qwLBA,
+                        uint32_t  dwNumBlocks,
+                        const uint8_t * pbySrc,
+                        size_t    stSrcLength,
+                        size_t *  pstLengthWritten);
+
 /******************************************************************************
 Function Name: scsiInquire
 Description:   Function to get the Mass Storage device information
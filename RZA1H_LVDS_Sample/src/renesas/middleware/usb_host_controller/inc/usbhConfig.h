@@ -73,6 +73,22 @@ Macro definitions
    Currently 16 for RX on chip peripherals */
 #define USBH_FIFO_BIT_WIDTH         32
 
+/** The smallest bulk transfer in bytes that is moved by the DMAC rather than
+   by CPU access to the pipe FIFO. The DMAC always moves whole packets, so
+   transfers shorter than one maximum size packet use the FIFO whatever the
+   value set here */
+#define USBH_DMA_THRESHOLD          64U
+
+/** The number of times FRDY is sampled after the CFIFO port is switched to a
+   pipe before the access is treated as a FIFO error. The switch can only be
+   polled, the controller has no interrupt for it. It normally completes in a
+   few reads, so this bounds the time spent on a stuck pipe */
+#define USBH_FIFO_READY_POLL        100
+
+/** The maximum number of transfer requests an isochronous stream keeps in
+   flight */
+#define USBH_ISOC_STREAM_MAX_REQUESTS   8
+
 /** The maximum number of host controllers supported */
 #define USBH_MAX_CONTROLLERS        2
 
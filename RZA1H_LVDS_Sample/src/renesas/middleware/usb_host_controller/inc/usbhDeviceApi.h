@@ -129,6 +129,86 @@ extern  _Bool usbhIsocTransfer(PUSBDI   pDevice,
                                size_t   stLength,
                                uint32_t dwIdleTimeOut);
 
+/**
+ * @brief         Function to start a continuous isochronous stream. The
+ *                requests are kept in flight and each one is put back on the
+ *                endpoint queue from the interrupt when it completes. IN data
+ *                is put into the PCM ring and OUT data is taken from it.
+ * 
+ * @param[out]    pStream:         Pointer to the stream
+ * @param[in]     pDevice:         Pointer to the device
+ * @param[in]     pEndpoint:       Pointer to the isochronous endpoint
+ * @param[in]     pIsocPacketSize: Pointer to the OUT packet size schedule or
+ *                                 NULL to use the endpoint packet size
+ * @param[in]     iNumRequests:    The number of requests to keep in flight
+ * @param[in]     pbyRing:         Pointer to the memory for the PCM ring
+ * @param[in]     stRingSize:      The size of the ring, a power of 2
+ * @param[in]     pNotify:         Function called from the interrupt after
+ *                                 each packet or NULL
+ * @param[in]     pvNotifyParam:   The parameter passed to pNotify
+ * 
+ * @retval        true: If the stream was started
+*/
+extern  _Bool usbhIsocStreamStart(PUSBSM   pStream,
+                                  PUSBDI   pDevice,
+                                  PUSBEI   pEndpoint,
+                                  PUSBIV   pIsocPacketSize,
+                                  int      iNumRequests,
+                                  uint8_t  *pbyRing,
+                                  size_t   stRingSize,
+                                  void     (*pNotify)(void *pvParam),
+                                  void     *pvNotifyParam);
+
+/**
+ * @brief         Function to stop an isochronous stream and free its
+ *                resources
+ * 
+ * @param[in]     pStream: Pointer to the stream
+*/
+extern  void usbhIsocStreamStop(PUSBSM pStream);
+
+/**
+ * @brief         Function to take PCM data received on an IN stream. This is
+ *                the only consumer of the ring.
+ * 
+ * @param[in]     pStream:  Pointer to the stream
+ * @param[out]    pbyDest:  Pointer to the destination memory
+ * @param[in]     stLength: The maximum length to read
+ * 
+ * @retval        The number of bytes read
+*/
+extern  size_t usbhIsocStreamRead(PUSBSM pStream, uint8_t *pbyDest, size_t stLength);
+
+/**
+ * @brief         Function to put PCM data to be sent on an OUT stream. This is
+ *                the only producer for the ring.
+ * 
+ * @param[in]     pStream:  Pointer to the stream
+ * @param[in]     pbySrc:   Pointer to the data
+ * @param[in]     stLength: The length to write
+ * 
+ * @retval        The number of bytes written
+*/
+extern  size_t usbhIsocStreamWrite(PUSBSM pStream, const uint8_t *pbySrc, size_t stLength);
+
+/**
+ * @brief         Function to get the amount of data in the PCM ring
+ * 
+ * @param[in]     pStream: Pointer to the stream
+ * 
+ * @retval        The number of bytes in the ring
+*/
+extern  size_t usbhIsocStreamLevel(PUSBSM pStream);
+
+/**
+ * @brief         Function to get a copy of the stream packet, timing and
+ *                error statistics
+ * 
+ * @param[in]     pStream: Pointer to the stream
+ * @param[out]    pStats:  Pointer to the destination for the statistics
+*/
+extern  void usbhIsocStreamGetStats(PUSBSM pStream, PUSBSMS pStats);
+
 /**
  * @brief         Function to cancel a transfer
  * 
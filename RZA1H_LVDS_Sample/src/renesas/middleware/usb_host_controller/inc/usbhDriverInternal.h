@@ -86,6 +86,19 @@ Return value:  true if the request was completed
 
 extern  _Bool usbhComplete(PUSBTR pRequest);
 
+/******************************************************************************
+Function Name: usbhQueueTransfer
+Description:   Function to put a request that has been set up by the caller
+               on the queue of its endpoint. The request keeps its complete
+               function so it can be put back on the queue from the
+               interrupt when it completes.
+Arguments:     IN  pRequest - Pointer to the request
+Return value:  true if the request was added
+NOTE: Requires mutually exclusive access to protect list
+******************************************************************************/
+
+extern  _Bool usbhQueueTransfer(PUSBTR pRequest);
+
 /******************************************************************************
 Function Name: usbhIdleTimerTick
 Description:   Function to perform an Idle time-out function and should be
@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_jpeg_pipe.h
+ * @brief          Pipelined JPEG decode to surface service
+ * @version        1.00
+ * @date           08.05.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 08.05.2019 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef R_JPEG_PIPE_H
+#define R_JPEG_PIPE_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_VIDEO_API
+ * @defgroup R_SW_PKG_93_JPEG_PIPE JPEG Decode Pipeline
+ * @brief Queued JPEG decoding into graphics surfaces
+ *
+ * @anchor R_SW_PKG_93_JPEG_PIPE_API_SUMMARY
+ * @par Summary
+ *
+ * Jobs queued with R_JPEG_PipeSubmit() are decoded in order by a service
+ * task. Each job names a JPEG in memory or the rest of an open file, and
+ * the surface, output format and scaling to decode it to. While the
+ * decoder works on one job, the task reads the next job into the second
+ * input buffer, so file reads and decoding overlap.
+ *
+ * The decoder is a back end. g_jpeg_pipe_jcu drives the JCU.
+ * g_jpeg_pipe_soft is a baseline software decoder with the same
+ * restrictions as the JCU, so that the service can be run without it. Its
+ * output is not bit exact with the JCU. Each back end can be used by one
+ * pipe at a time.
+ *
+ * g_jpeg_pipe_jcu and g_mjpeg_rec_jcu of the motion JPEG recorder share
+ * the JCU, so a pipe on the JCU and a recorder on the JCU can not be open
+ * together. Whichever is opened second fails with E_STATE.
+ *
+ * Jobs are allocated by the caller and belong to the service from
+ * R_JPEG_PipeSubmit() until their p_done callback, which is called from
+ * the service task. The time in the queue and in the decoder is recorded
+ * in every job.
+ *
+ * @anchor R_SW_PKG_93_JPEG_PIPE_API_INSTANCES
+ * @par Known Implementations:
+ * This driver is used in the RZA1H Software Package.
+ * @see RENESAS_APPLICATION_SOFTWARE_PACKAGE
+ *
+ * @see RENESAS_OS_ABSTRACTION  Renesas OS Abstraction interface
+ * @{
+ *****************************************************************************/
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include "r_typedefs.h"
+#include "r_os_abstraction_api.h"
+#include "r_jcu_typedef.h"
+#include "ff.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define JPEG_PIPE_QUEUE_DEPTH   (8u)    /*!< Jobs waiting for the service task, at most 8 */
+#define JPEG_PIPE_BUFFERS       (2u)    /*!< Input buffers                               */
+#define JPEG_PIPE_ALIGNMENT     (JCU_BUFFER_ALIGNMENT) /*!< Alignment of buffers, in bytes */
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+/*! @enum e_jpeg_pipe_source_t
+ *  @brief Where the JPEG of a job is read from
+ */
+typedef enum
+{
+    JPEG_PIPE_SOURCE_MEMORY = 0,            /*!< p_data, size bytes                               */
+    JPEG_PIPE_SOURCE_FILE                   /*!< p_file from its current position, size bytes or
+                                                 to the end of the file when size is 0            */
+} e_jpeg_pipe_source_t;
+
+/*! @struct st_jpeg_pipe_surface_t
+ *  @brief Frame buffer a JPEG is decoded into
+ */
+typedef struct
+{
+    void                *p_base;            /*!< Top left pixel, JPEG_PIPE_ALIGNMENT aligned          */
+    int16_t             stride;             /*!< Pixels from a line to the line below                 */
+    uint16_t            width;              /*!< Pixels per line, even for JCU_OUTPUT_YCbCr422         */
+    uint16_t            height;             /*!< Lines                                                */
+    jcu_decode_format_t format;             /*!< Pixel format                                         */
+} st_jpeg_pipe_surface_t;
+
+/*! @struct st_jpeg_pipe_decode_t
+ *  @brief One decode, as passed to a back end
+ */
+typedef struct
+{
+    const uint8_t          *p_jpeg;         /*!< JPEG data, JPEG_PIPE_ALIGNMENT aligned      */
+    uint32_t               size;            /*!< Bytes of JPEG data                          */
+    st_jpeg_pipe_surface_t dst;             /*!< Target surface                              */
+    jcu_sub_sampling_t     h_scale;         /*!< Horizontal scaling                          */
+    jcu_sub_sampling_t     v_scale;         /*!< Vertical scaling                            */
+    jcu_cbcr_offset_t      cbcr_offset;     /*!< Chroma offset of JCU_OUTPUT_YCbCr422        */
+    uint8_t                alpha;           /*!< Alpha of JCU_OUTPUT_ARGB8888                */
+} st_jpeg_pipe_decode_t;
+
+/*! @struct st_jpeg_pipe_backend_t
+ *  @brief Decoder back end
+ */
+typedef struct
+{
+    jcu_errorcode_t (*p_open)(void);        /*!< Claims the decoder                               */
+    jcu_errorcode_t (*p_start)(const st_jpeg_pipe_decode_t * const p_decode); /*!< Starts a decode */
+    jcu_errorcode_t (*p_wait)(const uint32_t timeout); /*!< Waits for the decode, timeout in ms    */
+    void            (*p_close)(void);       /*!< Releases the decoder                             */
+} st_jpeg_pipe_backend_t;
+
+typedef struct st_jpeg_pipe_job_t st_jpeg_pipe_job_t;
+
+/*! @struct st_jpeg_pipe_job_t
+ *  @brief Decode job, allocated by the caller
+ */
+struct st_jpeg_pipe_job_t
+{
+    /* Set by the caller */
+    e_jpeg_pipe_source_t   source;          /*!< Source of the JPEG                                   */
+    const uint8_t          *p_data;         /*!< JPEG_PIPE_SOURCE_MEMORY: JPEG data                   */
+    FIL                    *p_file;         /*!< JPEG_PIPE_SOURCE_FILE: open file                     */
+    uint32_t               size;            /*!< Bytes of JPEG data                                   */
+    st_jpeg_pipe_surface_t dst;             /*!< Target surface                                       */
+    jcu_sub_sampling_t     h_scale;         /*!< Horizontal scaling                                   */
+    jcu_sub_sampling_t     v_scale;         /*!< Vertical scaling                                     */
+    jcu_cbcr_offset_t      cbcr_offset;     /*!< Chroma offset, JCU_CBCR_OFFSET_0 unless YCbCr422     */
+    uint8_t                alpha;           /*!< Alpha of JCU_OUTPUT_ARGB8888                         */
+    void (*p_done)(st_jpeg_pipe_job_t * const p_job); /*!< Called from the service task, or NULL     */
+    void                   *p_arg;          /*!< Not used by the service                              */
+
+    /* Set by the service */
+    jcu_errorcode_t        result;          /*!< JCU_ERROR_OK, or why the job failed                  */
+    uint32_t               sequence;        /*!< Order in which jobs were submitted                   */
+    uint32_t               width;           /*!< Width of the JPEG, before scaling                    */
+    uint32_t               height;          /*!< Height of the JPEG, before scaling                   */
+    uint32_t               queued_ms;       /*!< Time the job spent before the decoder started it     */
+    uint32_t               decode_ms;       /*!< Time the decoder took                                */
+    uint32_t               latency_ms;      /*!< Time from R_JPEG_PipeSubmit to p_done                */
+    volatile bool_t        done;            /*!< true once the job is finished                        */
+
+    /* Private */
+    uint32_t               tick_submit;
+    uint32_t               tick_start;
+    const uint8_t          *p_jpeg;         /* Data passed to the decoder */
+    uint32_t               jpeg_size;
+};
+
+/*! @struct st_jpeg_pipe_stats_t
+ *  @brief Pipeline statistics
+ */
+typedef struct
+{
+    uint32_t jobs;                          /*!< Jobs finished                            */
+    uint32_t errors;                        /*!< Jobs finished with an error              */
+    uint32_t overlapped;                    /*!< Jobs read while the decoder was busy     */
+    uint32_t latency_min_ms;                /*!< Shortest latency_ms of a decoded job     */
+    uint32_t latency_max_ms;                /*!< Longest latency_ms of a decoded job      */
+    uint32_t latency_sum_ms;                /*!< Sum of latency_ms of the decoded jobs    */
+    uint32_t decode_max_ms;                 /*!< Longest decode_ms                        */
+} st_jpeg_pipe_stats_t;
+
+/*! @struct st_jpeg_pipe_t
+ *  @brief Pipeline instance, allocated by the caller
+ */
+typedef struct
+{
+    const st_jpeg_pipe_backend_t *p_backend;
+    uint8_t                  *p_buff[JPEG_PIPE_BUFFERS];
+    uint32_t                 buff_size;
+    uint32_t                 timeout;       /* Longest decode in ms                       */
+    uint32_t                 semid;         /* Counts jobs in queue                       */
+    uint32_t                 stop_semid;    /* Released by the task when it exits         */
+    os_task_t                *p_task;
+    st_jpeg_pipe_job_t       *queue[JPEG_PIPE_QUEUE_DEPTH];
+    volatile uint32_t        head;          /* Oldest job in queue                        */
+    volatile uint32_t        count;         /* Jobs in queue                              */
+    volatile uint32_t        sequence;
+    volatile bool_t          stop;
+    volatile st_jpeg_pipe_stats_t stats;
+} st_jpeg_pipe_t;
+
+/*! @struct st_jpeg_pipe_config_t
+ *  @brief Pipeline config
+ */
+typedef struct
+{
+    const st_jpeg_pipe_backend_t *p_backend;    /*!< &g_jpeg_pipe_jcu or &g_jpeg_pipe_soft              */
+    uint8_t  *p_buff[JPEG_PIPE_BUFFERS];        /*!< Input buffers, JPEG_PIPE_ALIGNMENT aligned        */
+    uint32_t buff_size;                         /*!< Bytes per input buffer, limits the JPEG size     */
+    uint32_t timeout;                           /*!< Longest decode in ms                              */
+    int_t    priority;                          /*!< Service task priority, TASK_JPEG_PIPE_PRI         */
+} st_jpeg_pipe_config_t;
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+extern const st_jpeg_pipe_backend_t g_jpeg_pipe_jcu;
+extern const st_jpeg_pipe_backend_t g_jpeg_pipe_soft;
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**
+ * @brief       Opens the back end and starts the service task.
+ *
+ * @param[out]  p_pipe:         Pipeline instance
+ * @param[in]   p_cnf:          Pipeline config
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      JCU_ERROR_PARAM: Bad config
+ * @retval      E_STATE:        The task could not be created, or the back end
+ *                              is the JCU and a recorder has it
+ * @retval      Other:          Error of the back end
+ */
+jcu_errorcode_t R_JPEG_PipeCreate(st_jpeg_pipe_t * const p_pipe, const st_jpeg_pipe_config_t * const p_cnf);
+
+/**
+ * @brief       Stops the service task and closes the back end. The job being
+ *              decoded is finished, jobs still queued fail with E_STATE.
+ *
+ * @param[in]   p_pipe:         Pipeline instance
+ */
+void R_JPEG_PipeDestroy(st_jpeg_pipe_t * const p_pipe);
+
+/**
+ * @brief       Queues a job. The result is reported by the job, see
+ *              st_jpeg_pipe_job_t. Besides the errors of the back end it can
+ *              be E_FEW_ARRAY if the JPEG does not fit an input buffer,
+ *              E_LIMITATION if the scaled image does not fit dst, or
+ *              E_TIME_OUT.
+ *
+ * @param[in]   p_pipe:         Pipeline instance
+ * @param[in]   p_job:          Job
+ *
+ * @retval      JCU_ERROR_OK:   Queued
+ * @retval      JCU_ERROR_PARAM: Bad job
+ * @retval      E_FIFO_OVER:    JPEG_PIPE_QUEUE_DEPTH jobs are queued already
+ * @retval      E_STATE:        The pipeline is stopping
+ */
+jcu_errorcode_t R_JPEG_PipeSubmit(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_job_t * const p_job);
+
+/**
+ * @brief       Reads the pipeline statistics.
+ *
+ * @param[in]   p_pipe:         Pipeline instance
+ * @param[out]  p_stats:        Statistics
+ * @param[in]   clear:          true: reset the statistics after reading
+ */
+void R_JPEG_PipeGetStats(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_stats_t * const p_stats,
+        const bool_t clear);
+
+/**
+ * @brief       Reads the size and format of a JPEG from its frame header.
+ *              Fails for JPEGs that the JCU cannot decode.
+ *
+ * @param[in]   p_jpeg:         JPEG data
+ * @param[in]   size:           Bytes of JPEG data
+ * @param[out]  p_info:         Image information
+ *
+ * @retval      JCU_JCDERR_OK:  Success
+ * @retval      JCU_JCDERR_*:   The error the JCU reports for this JPEG
+ */
+jcu_errorcode_t R_JPEG_PipeGetImageInfo(const uint8_t * const p_jpeg, const uint32_t size,
+        jcu_image_info_t * const p_info);
+
+#endif  /* R_JPEG_PIPE_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
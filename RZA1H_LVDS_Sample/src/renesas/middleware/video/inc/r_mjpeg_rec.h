@@ -0,0 +1,423 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_mjpeg_rec.h
+ * @brief          Motion JPEG recorder
+ * @version        1.00
+ * @date           15.05.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 15.05.2019 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef R_MJPEG_REC_H
+#define R_MJPEG_REC_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_VIDEO_API
+ * @defgroup R_SW_PKG_93_MJPEG_REC Motion JPEG Recorder
+ * @brief Records YCbCr422 frames to an AVI file as motion JPEG
+ *
+ * @anchor R_SW_PKG_93_MJPEG_REC_API_SUMMARY
+ * @par Summary
+ *
+ * Frames queued with R_MJPEG_RecSubmit() are encoded in order by a service
+ * task and appended to an AVI file. The frames are YCbCr422, bytes Y0 Cb Y1
+ * Cr, as the CEU writes them in data synchronous fetch mode. While one
+ * frame is encoded, the JPEG of the frame before it is written to the
+ * file, so file writes and encoding overlap.
+ *
+ * The file is written in whole write buffers, a multiple of the sector
+ * size, to clusters allocated in one block when the recording starts. The
+ * AVI headers and the index are completed by R_MJPEG_RecClose().
+ *
+ * When a bit rate is set the quality of each frame is chosen to hold it,
+ * between quality_min and quality_max. Quality scales the quantisation
+ * tables of ITU-T T.81 Annex K as the IJG library does, 50 being the
+ * tables themselves.
+ *
+ * The encoder is a back end. g_mjpeg_rec_jcu drives the JCU.
+ * g_mjpeg_rec_soft is a baseline software encoder, so that the recorder
+ * can be run without the JCU. Each back end can be used by one recorder at
+ * a time.
+ *
+ * g_mjpeg_rec_jcu and g_jpeg_pipe_jcu of the JPEG decode pipeline share
+ * the JCU, so a recorder on the JCU and a pipe on the JCU can not be open
+ * together. Whichever is opened second fails with E_STATE.
+ *
+ * R_MJPEG_CeuStart() feeds the recorder from the CEU, capturing into a
+ * ring of frame buffers that are given back as soon as they are encoded.
+ *
+ * @anchor R_SW_PKG_93_MJPEG_REC_API_INSTANCES
+ * @par Known Implementations:
+ * This driver is used in the RZA1H Software Package.
+ * @see RENESAS_APPLICATION_SOFTWARE_PACKAGE
+ *
+ * @see RENESAS_OS_ABSTRACTION  Renesas OS Abstraction interface
+ * @{
+ *****************************************************************************/
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include "r_typedefs.h"
+#include "r_os_abstraction_api.h"
+#include "r_jcu_typedef.h"
+#include "ff.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define MJPEG_REC_QUEUE_DEPTH   (4u)    /*!< Frames waiting for the service task, at most 8    */
+#define MJPEG_REC_BUFFERS       (2u)    /*!< JPEG buffers                                      */
+#define MJPEG_REC_ALIGNMENT     (JCU_BUFFER_ALIGNMENT) /*!< Alignment of buffers, in bytes   */
+#define MJPEG_REC_SECTOR        (512u)  /*!< The write buffer is a multiple of this            */
+#define MJPEG_REC_QUALITY_MAX   (95u)   /*!< Above this a JPEG can be larger than its frame     */
+#define MJPEG_REC_DHT_DC_SIZE   (28u)   /*!< Code counts and symbols of a DC Huffman table      */
+#define MJPEG_REC_DHT_AC_SIZE   (178u)  /*!< Code counts and symbols of an AC Huffman table     */
+#define MJPEG_REC_AVI_MAX       (0x40000000uL) /*!< Largest AVI file, in bytes                 */
+#define MJPEG_CEU_FRAMES        (3u)    /*!< Frame buffers of the CEU capture                  */
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+/*! @struct st_mjpeg_rec_encode_t
+ *  @brief One encode, as passed to a back end
+ */
+typedef struct
+{
+    const uint8_t     *p_frame;             /*!< Frame, MJPEG_REC_ALIGNMENT aligned            */
+    int16_t           stride;               /*!< Pixels from a line to the line below          */
+    uint16_t          width;                /*!< Pixels per line, a multiple of 16             */
+    uint16_t          height;               /*!< Lines, a multiple of 8                        */
+    jcu_cbcr_offset_t cbcr_offset;          /*!< JCU_CBCR_OFFSET_128: Cb and Cr are unsigned   */
+    const uint8_t     *p_qt[2];             /*!< Y and CbCr quantisation tables, zig-zag order */
+    uint16_t          restart;              /*!< MCUs per restart interval, 0 for none         */
+    uint8_t           *p_jpeg;              /*!< JPEG buffer, MJPEG_REC_ALIGNMENT aligned      */
+    uint32_t          jpeg_size;            /*!< Bytes of JPEG buffer                          */
+} st_mjpeg_rec_encode_t;
+
+/*! @struct st_mjpeg_rec_backend_t
+ *  @brief Encoder back end
+ */
+typedef struct
+{
+    jcu_errorcode_t (*p_open)(void);        /*!< Claims the encoder                               */
+    jcu_errorcode_t (*p_start)(const st_mjpeg_rec_encode_t * const p_encode); /*!< Starts an encode */
+    jcu_errorcode_t (*p_wait)(const uint32_t timeout, uint32_t * const p_size); /*!< Waits for the
+                                                 encode, timeout in ms, and gives the JPEG size  */
+    void            (*p_close)(void);       /*!< Releases the encoder                             */
+} st_mjpeg_rec_backend_t;
+
+typedef struct st_mjpeg_rec_frame_t st_mjpeg_rec_frame_t;
+
+/*! @struct st_mjpeg_rec_frame_t
+ *  @brief Frame to record, allocated by the caller
+ */
+struct st_mjpeg_rec_frame_t
+{
+    /* Set by the caller */
+    const uint8_t   *p_data;                /*!< Frame, MJPEG_REC_ALIGNMENT aligned, in the layout
+                                                 given to R_MJPEG_RecOpen                        */
+    void (*p_done)(st_mjpeg_rec_frame_t * const p_frame); /*!< Called from the service task when
+                                                 p_data is no longer read, or NULL               */
+    void            *p_arg;                 /*!< Not used by the recorder                        */
+
+    /* Set by the recorder */
+    jcu_errorcode_t result;                 /*!< JCU_ERROR_OK, or why the frame was not recorded */
+    uint32_t        sequence;               /*!< Order in which frames were submitted            */
+    uint32_t        size;                   /*!< Bytes of JPEG                                   */
+    uint32_t        quality;                /*!< Quality the frame was encoded at                */
+    uint32_t        encode_ms;              /*!< Time the encoder took                           */
+    volatile bool_t done;                   /*!< true once p_data is no longer read              */
+
+    /* Private */
+    uint32_t        tick_submit;
+};
+
+/*! @struct st_mjpeg_rec_stats_t
+ *  @brief Recorder statistics
+ */
+typedef struct
+{
+    uint32_t frames;                        /*!< Frames recorded                                    */
+    uint32_t dropped;                       /*!< Frames refused by R_MJPEG_RecSubmit, queue full    */
+    uint32_t errors;                        /*!< Frames not recorded for any other reason           */
+    uint32_t overlapped;                    /*!< JPEGs written while the encoder was busy           */
+    uint32_t bytes;                         /*!< Bytes of JPEG recorded                             */
+    uint32_t bytes_min;                     /*!< Smallest JPEG                                      */
+    uint32_t bytes_max;                     /*!< Largest JPEG                                       */
+    uint32_t quality;                       /*!< Quality of the last frame                          */
+    uint32_t encode_max_ms;                 /*!< Longest encode                                     */
+    uint32_t write_max_ms;                  /*!< Longest write of a JPEG to the file                */
+    uint32_t elapsed_ms;                    /*!< Time from the first frame submitted to the last
+                                                 frame recorded, frames * 1000 / elapsed_ms is the
+                                                 sustained frame rate                               */
+} st_mjpeg_rec_stats_t;
+
+/*! @struct st_mjpeg_avi_t
+ *  @brief AVI file writer, used by the recorder
+ */
+typedef struct
+{
+    FIL             *p_file;
+    uint8_t         *p_buff;                /* Write buffer                              */
+    uint32_t        buff_size;
+    uint32_t        fill;                   /* Bytes in the write buffer                 */
+    uint32_t        file_pos;               /* File offset of the write buffer           */
+    uint32_t        *p_index;               /* Offset and size of each frame             */
+    uint32_t        max_frames;
+    uint32_t        frames;
+    uint32_t        movi_size;              /* Bytes of frame chunks                     */
+    uint32_t        chunk_max;              /* Largest JPEG                              */
+    uint16_t        width;
+    uint16_t        height;
+    uint32_t        fps;
+    bool_t          expanded;               /* Clusters were allocated in one block      */
+    jcu_errorcode_t error;                  /* First write error                         */
+} st_mjpeg_avi_t;
+
+/*! @struct st_mjpeg_rec_t
+ *  @brief Recorder instance, allocated by the caller
+ */
+typedef struct
+{
+    const st_mjpeg_rec_backend_t *p_backend;
+    st_mjpeg_rec_encode_t    encode;        /* Frame layout and buffers                   */
+    uint8_t                  *p_jpeg[MJPEG_REC_BUFFERS];
+    uint8_t                  qt[2][64];     /* Tables of the current quality               */
+    uint32_t                 timeout;       /* Longest encode in ms                        */
+    uint32_t                 budget;        /* Bytes per frame for the bit rate, 0 for none */
+    uint32_t                 average;       /* Running average of the JPEG size            */
+    uint32_t                 quality;
+    uint32_t                 quality_min;
+    uint32_t                 quality_max;
+    st_mjpeg_avi_t           avi;
+    uint32_t                 semid;         /* Counts frames in queue                      */
+    uint32_t                 stop_semid;    /* Released by the task when it exits          */
+    os_task_t                *p_task;
+    st_mjpeg_rec_frame_t     *queue[MJPEG_REC_QUEUE_DEPTH];
+    volatile uint32_t        head;          /* Oldest frame in queue                       */
+    volatile uint32_t        count;         /* Frames in queue                             */
+    volatile uint32_t        sequence;
+    volatile bool_t          stop;
+    uint32_t                 tick_first;    /* Submission of the first frame               */
+    volatile st_mjpeg_rec_stats_t stats;
+} st_mjpeg_rec_t;
+
+/*! @struct st_mjpeg_rec_config_t
+ *  @brief Recorder config
+ */
+typedef struct
+{
+    const st_mjpeg_rec_backend_t *p_backend;    /*!< &g_mjpeg_rec_jcu or &g_mjpeg_rec_soft                 */
+    FIL               *p_file;              /*!< Empty file opened for writing, closed by the caller     */
+    uint16_t          width;                /*!< Pixels per line, a multiple of 16                       */
+    uint16_t          height;               /*!< Lines, a multiple of 8                                  */
+    int16_t           stride;               /*!< Pixels from a line of a frame to the line below         */
+    jcu_cbcr_offset_t cbcr_offset;          /*!< JCU_CBCR_OFFSET_128: Cb and Cr are unsigned, as from
+                                                 the CEU                                                 */
+    uint32_t          fps;                  /*!< Frame rate written to the file                          */
+    uint32_t          bitrate;              /*!< Bits per second to hold, 0 for a fixed quality          */
+    uint32_t          quality;              /*!< Quality of the first frame, 1 - MJPEG_REC_QUALITY_MAX   */
+    uint32_t          quality_min;          /*!< Lowest quality the bit rate may choose                  */
+    uint32_t          quality_max;          /*!< Highest quality the bit rate may choose                 */
+    uint16_t          restart;              /*!< MCUs per restart interval, 0 for none                   */
+    uint8_t           *p_jpeg[MJPEG_REC_BUFFERS]; /*!< JPEG buffers, MJPEG_REC_ALIGNMENT aligned          */
+    uint32_t          jpeg_size;            /*!< Bytes per JPEG buffer, at least width * height * 2      */
+    uint8_t           *p_write;             /*!< Write buffer                                            */
+    uint32_t          write_size;           /*!< Bytes of write buffer, a multiple of MJPEG_REC_SECTOR   */
+    uint32_t          *p_index;             /*!< Index, 2 words per frame                                */
+    uint32_t          max_frames;           /*!< Frames the index holds                                  */
+    uint32_t          prealloc;             /*!< Bytes to allocate to the file in one block, 0 for none  */
+    uint32_t          timeout;              /*!< Longest encode in ms                                    */
+    int_t             priority;             /*!< Service task priority, TASK_MJPEG_REC_PRI               */
+} st_mjpeg_rec_config_t;
+
+/*! @struct st_mjpeg_ceu_t
+ *  @brief CEU capture into a recorder, allocated by the caller
+ */
+typedef struct
+{
+    st_mjpeg_rec_t           *p_rec;
+    st_mjpeg_rec_frame_t     frame[MJPEG_CEU_FRAMES];
+    uint32_t                 chdw;          /* Bytes per line written by the CEU             */
+    volatile uint32_t        free;          /* Bit per frame buffer not in use               */
+    uint32_t                 free_semid;    /* Counts free frame buffers                     */
+    uint32_t                 end_semid;     /* Released by the CEU interrupt                 */
+    uint32_t                 stop_semid;    /* Released by the task when it exits            */
+    os_task_t                *p_task;
+    volatile bool_t          stop;
+    volatile uint32_t        captured;      /* Frames captured                               */
+    volatile uint32_t        dropped;       /* Frames captured but refused by the recorder   */
+    volatile uint32_t        timeouts;      /* Captures that did not end                     */
+} st_mjpeg_ceu_t;
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+extern const st_mjpeg_rec_backend_t g_mjpeg_rec_jcu;
+extern const st_mjpeg_rec_backend_t g_mjpeg_rec_soft;
+
+/* Huffman tables of ITU-T T.81 Annex K, luminance then chrominance, used by both back ends */
+extern const uint8_t g_mjpeg_rec_dht_dc[2][MJPEG_REC_DHT_DC_SIZE];
+extern const uint8_t g_mjpeg_rec_dht_ac[2][MJPEG_REC_DHT_AC_SIZE];
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**
+ * @brief       Starts the AVI file, opens the back end and starts the
+ *              service task.
+ *
+ * @param[out]  p_rec:          Recorder instance
+ * @param[in]   p_cnf:          Recorder config
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      JCU_ERROR_PARAM: Bad config, or the file is not empty
+ * @retval      E_STATE:        The task could not be created, or the back end
+ *                              is the JCU and a decode pipe has it
+ * @retval      Other:          Error of the back end
+ */
+jcu_errorcode_t R_MJPEG_RecOpen(st_mjpeg_rec_t * const p_rec, const st_mjpeg_rec_config_t * const p_cnf);
+
+/**
+ * @brief       Stops the service task, completes the AVI file and closes
+ *              the back end. The frame being encoded is recorded, frames
+ *              still queued fail with E_STATE.
+ *
+ * @param[in]   p_rec:          Recorder instance
+ *
+ * @retval      JCU_ERROR_OK:   The file is complete
+ * @retval      E_ERRNO:        The file could not be written
+ */
+jcu_errorcode_t R_MJPEG_RecClose(st_mjpeg_rec_t * const p_rec);
+
+/**
+ * @brief       Queues a frame. The result of the encode is reported by the
+ *              frame, see st_mjpeg_rec_frame_t. Besides the errors of the
+ *              back end it can be E_FEW_ARRAY if the JPEG did not fit a JPEG
+ *              buffer, E_LIMITATION if the index is full, E_ERRNO once the
+ *              file can not be written or E_TIME_OUT. The JPEG is written
+ *              after p_done is called, a JPEG that can not be written is
+ *              counted in errors of st_mjpeg_rec_stats_t.
+ *
+ * @param[in]   p_rec:          Recorder instance
+ * @param[in]   p_frame:        Frame
+ *
+ * @retval      JCU_ERROR_OK:   Queued
+ * @retval      JCU_ERROR_PARAM: Bad frame
+ * @retval      E_FIFO_OVER:    MJPEG_REC_QUEUE_DEPTH frames are queued already,
+ *                              the frame is counted as dropped
+ * @retval      E_STATE:        The recorder is stopping
+ */
+jcu_errorcode_t R_MJPEG_RecSubmit(st_mjpeg_rec_t * const p_rec, st_mjpeg_rec_frame_t * const p_frame);
+
+/**
+ * @brief       Reads the recorder statistics.
+ *
+ * @param[in]   p_rec:          Recorder instance
+ * @param[out]  p_stats:        Statistics
+ * @param[in]   clear:          true: reset the statistics after reading
+ */
+void R_MJPEG_RecGetStats(st_mjpeg_rec_t * const p_rec, st_mjpeg_rec_stats_t * const p_stats,
+        const bool_t clear);
+
+/**
+ * @brief       Fills the quantisation tables of a quality, in zig-zag order.
+ *
+ * @param[in]   quality:        1 - 100, 50 gives the tables of T.81 Annex K
+ * @param[out]  p_qt:           Y and CbCr tables
+ */
+void R_MJPEG_RecQualityTables(const uint32_t quality, uint8_t p_qt[][64]);
+
+/**
+ * @brief       Starts an AVI file with the headers of an empty recording.
+ *
+ * @param[out]  p_avi:          AVI writer
+ * @param[in]   p_cnf:          Recorder config, for the file, buffers and
+ *                              frame size and rate
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      JCU_ERROR_PARAM: Bad config, or the file is not empty
+ */
+jcu_errorcode_t R_MJPEG_AviOpen(st_mjpeg_avi_t * const p_avi, const st_mjpeg_rec_config_t * const p_cnf);
+
+/**
+ * @brief       Appends a JPEG as the next frame.
+ *
+ * @param[in]   p_avi:          AVI writer
+ * @param[in]   p_jpeg:         JPEG
+ * @param[in]   size:           Bytes of JPEG
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      E_LIMITATION:   The index is full or the file would exceed
+ *                              MJPEG_REC_AVI_MAX
+ * @retval      E_ERRNO:        The file could not be written
+ */
+jcu_errorcode_t R_MJPEG_AviWrite(st_mjpeg_avi_t * const p_avi, const uint8_t * const p_jpeg, const uint32_t size);
+
+/**
+ * @brief       Writes the index and the final headers, and returns the
+ *              clusters that were allocated but not used.
+ *
+ * @param[in]   p_avi:          AVI writer
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      E_ERRNO:        The file could not be written
+ */
+jcu_errorcode_t R_MJPEG_AviClose(st_mjpeg_avi_t * const p_avi);
+
+/**
+ * @brief       Captures frames from the CEU into the recorder. The CEU
+ *              must be open, in data synchronous fetch mode with the
+ *              interrupt enabled by R_RVAPI_OpenCEU, writing the frame
+ *              layout the recorder was opened with.
+ *
+ * @param[out]  p_ceu:          Capture instance
+ * @param[in]   p_rec:          Recorder
+ * @param[in]   p_buff:         Frame buffers, MJPEG_REC_ALIGNMENT aligned
+ * @param[in]   chdw:           Bytes per line written by the CEU
+ * @param[in]   priority:       Capture task priority, TASK_MJPEG_CEU_PRI
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      JCU_ERROR_PARAM: Bad buffers
+ * @retval      E_STATE:        The task could not be created
+ */
+jcu_errorcode_t R_MJPEG_CeuStart(st_mjpeg_ceu_t * const p_ceu, st_mjpeg_rec_t * const p_rec,
+        uint8_t * const p_buff[MJPEG_CEU_FRAMES], const uint32_t chdw, const int_t priority);
+
+/**
+ * @brief       Stops capturing. Frames already captured are still recorded.
+ *
+ * @param[in]   p_ceu:          Capture instance
+ */
+void R_MJPEG_CeuStop(st_mjpeg_ceu_t * const p_ceu);
+
+#endif  /* R_MJPEG_REC_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
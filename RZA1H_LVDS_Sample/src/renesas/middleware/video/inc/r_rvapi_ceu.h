@@ -131,6 +131,17 @@ ceu_error_t R_RVAPI_CaptureStartCEU(const void * cayr, const void * cacr,
  * @retval      cap_status: Status of the Capture
  */
 cap_status_t R_RVAPI_CaptureStatusCEU(void);
+
+/**
+ * @brief       Sets the function called from the CEU interrupt when a
+ *              frame capture ends, so the capture can be waited for
+ *              without polling R_RVAPI_CaptureStatusCEU
+ * 
+ * @param[in]   func:      Function, or NULL for none
+ * 
+ * @return None.
+ */
+void R_RVAPI_SetCaptureEndCEU(void (* const func)(void));
 #endif  /* R_RVAPI_CEU_H */
 /**************************************************************************//**
  * @} (end addtogroup)
@@ -0,0 +1,204 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2018 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_rvapi_flip.h
+ * @brief          RVAPI vsync synchronised page flip header
+ * @version        1.00
+ * @date           27.06.2018
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 30.06.2018 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef R_RVAPI_FLIP_H
+#define R_RVAPI_FLIP_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_VIDEO_API
+ * @defgroup R_SW_PKG_93_VIDEO_FLIP Video Page Flip
+ * @brief Double and triple buffered graphics layers
+ *
+ * @anchor R_SW_PKG_93_VIDEO_FLIP_API_SUMMARY
+ * @par Summary
+ *
+ * Manages 2 or 3 frame buffers for one graphics layer. The renderer takes a
+ * free buffer with R_RVAPI_FlipAcquireVDC(), draws into it and hands it back
+ * with R_RVAPI_FlipQueueVDC(). Queued buffers are passed to the VDC from the
+ * output Vsync interrupt, so the new base address is latched by the VDC at
+ * the start of the following frame and a frame is never shown half drawn.
+ * A buffer becomes free again once the frame after it is on the display.
+ *
+ * The service owns the VDC_INT_TYPE_S0_LO_VSYNC callback of the channel
+ * while at least one layer of that channel is flipped.
+ *
+ * @anchor R_SW_PKG_93_VIDEO_FLIP_API_INSTANCES
+ * @par Known Implementations:
+ * This driver is used in the RZA1H Software Package.
+ * @see RENESAS_APPLICATION_SOFTWARE_PACKAGE
+ *
+ * @see RENESAS_OS_ABSTRACTION  Renesas OS Abstraction interface
+ * @{
+ *****************************************************************************/
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include "r_typedefs.h"
+#include "r_rvapi_vdc.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define RVAPI_FLIP_MAX_BUFFERS  (3u)    /*!< Frame buffers managed per layer */
+#define RVAPI_FLIP_NONE         (0xFFu) /*!< No buffer */
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+/*! @enum e_rvapi_flip_state_t
+ *  @brief Frame buffer state
+ */
+typedef enum
+{
+    RVAPI_FLIP_FREE = 0,                    /*!< Available to R_RVAPI_FlipAcquireVDC */
+    RVAPI_FLIP_RENDER,                      /*!< Owned by the renderer               */
+    RVAPI_FLIP_QUEUED,                      /*!< Waiting for a Vsync                 */
+    RVAPI_FLIP_LATCHED,                     /*!< Displayed from the next frame       */
+    RVAPI_FLIP_SHOWN                        /*!< Being displayed                     */
+} e_rvapi_flip_state_t;
+
+/*! @struct st_rvapi_flip_stats_t
+ *  @brief Frame pacing statistics
+ */
+typedef struct
+{
+    uint32_t vsyncs;                        /*!< Vsync interrupts handled                        */
+    uint32_t flips;                         /*!< Frames that reached the display                 */
+    uint32_t dropped;                       /*!< Queued frames replaced before they were shown   */
+    uint32_t late;                          /*!< Vsyncs at which a frame was due but not queued  */
+} st_rvapi_flip_stats_t;
+
+/*! @struct st_rvapi_flip_t
+ *  @brief Page flip instance, allocated by the caller
+ */
+typedef struct
+{
+    vdc_channel_t            ch;
+    vdc_layer_id_t           layer_id;
+    uint32_t                 num;           /* Buffers in p_buff                            */
+    uint32_t                 interval;      /* Vsyncs each frame is shown for at least      */
+    bool_t                   mailbox;       /* A new frame replaces a frame still queued    */
+    uint32_t                 semid;         /* Counts RVAPI_FLIP_FREE buffers               */
+    void                     *p_buff[RVAPI_FLIP_MAX_BUFFERS];
+    volatile e_rvapi_flip_state_t state[RVAPI_FLIP_MAX_BUFFERS];
+    volatile uint8_t         queue[RVAPI_FLIP_MAX_BUFFERS]; /* Queued buffers, oldest first */
+    volatile uint32_t        queued;
+    volatile uint32_t        latched;
+    volatile uint32_t        shown;
+    volatile uint32_t        since_flip;    /* Vsyncs since the shown buffer was displayed  */
+    volatile st_rvapi_flip_stats_t stats;
+} st_rvapi_flip_t;
+
+/*! @struct st_rvapi_flip_config_t
+ *  @brief Page flip config
+ */
+typedef struct
+{
+    vdc_layer_id_t layer_id;                /*!< Graphics layer, VDC_LAYER_ID_0_RD - VDC_LAYER_ID_3_RD   */
+    void * const * pp_buff;                 /*!< Frame buffers, pp_buff[0] is the buffer on the display   */
+    uint32_t num;                           /*!< Number of frame buffers, 2 or 3                          */
+    uint32_t interval;                      /*!< Minimum Vsyncs per frame, 1 for the panel refresh rate   */
+    bool_t mailbox;                         /*!< true: drop a queued frame when a newer one is queued    */
+} st_rvapi_flip_config_t;
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**
+ * @brief       Starts flipping a graphics layer. The surface must have been
+ *              created with R_RVAPI_GraphCreateSurfaceVDC showing pp_buff[0].
+ *
+ * @param[out]  p_flip:         Page flip instance
+ * @param[in]   ch:             Channel
+ * @param[in]   p_cnf:          Page flip config
+ *
+ * @retval      VDC_ER:         VDC driver error code
+ */
+vdc_error_t R_RVAPI_FlipCreateVDC(st_rvapi_flip_t * const p_flip, const vdc_channel_t ch,
+        const st_rvapi_flip_config_t * const p_cnf);
+
+/**
+ * @brief       Stops flipping a graphics layer. The buffer shown last stays
+ *              on the display.
+ *
+ * @param[in]   p_flip:         Page flip instance
+ *
+ * @retval      VDC_ER:         VDC driver error code
+ */
+vdc_error_t R_RVAPI_FlipDestroyVDC(st_rvapi_flip_t * const p_flip);
+
+/**
+ * @brief       Waits for a free frame buffer and passes it to the renderer.
+ *
+ * @param[in]   p_flip:         Page flip instance
+ * @param[in]   timeout:        Time to wait in ms
+ * @param[out]  pp_buff:        Frame buffer to draw into
+ *
+ * @retval      VDC_OK:                 Success
+ * @retval      VDC_ERR_RESOURCE_VSYNC: No buffer was freed within timeout
+ * @retval      VDC_ER:                 Other VDC driver error code
+ */
+vdc_error_t R_RVAPI_FlipAcquireVDC(st_rvapi_flip_t * const p_flip, const uint32_t timeout,
+        void ** const pp_buff);
+
+/**
+ * @brief       Queues a frame buffer from R_RVAPI_FlipAcquireVDC for display.
+ *              Data cache lines covering the buffer must have been written
+ *              back by the caller.
+ *
+ * @param[in]   p_flip:         Page flip instance
+ * @param[in]   p_buff:         Frame buffer
+ *
+ * @retval      VDC_ER:         VDC driver error code
+ */
+vdc_error_t R_RVAPI_FlipQueueVDC(st_rvapi_flip_t * const p_flip, void * const p_buff);
+
+/**
+ * @brief       Reads the frame pacing statistics.
+ *
+ * @param[in]   p_flip:         Page flip instance
+ * @param[out]  p_stats:        Statistics
+ * @param[in]   clear:          true: reset the statistics after reading
+ *
+ * @retval      VDC_ER:         VDC driver error code
+ */
+vdc_error_t R_RVAPI_FlipGetStatsVDC(st_rvapi_flip_t * const p_flip, st_rvapi_flip_stats_t * const p_stats,
+        const bool_t clear);
+
+#endif  /* R_RVAPI_FLIP_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
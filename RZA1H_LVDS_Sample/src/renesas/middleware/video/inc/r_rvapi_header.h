@@ -49,6 +49,7 @@ Includes   <System Includes> , "Project Includes"
 #include    "r_rvapi_ceu.h"
 #include    "r_rvapi_vdec.h"
 #include    "r_rvapi_vdc.h"
+#include    "r_rvapi_flip.h"
 
 /******************************************************************************
 Macro definitions
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this
+ * software and to discontinue the availability of this software. By using this
+ * software, you agree to the additional terms and conditions found by
+ * accessing the following link:
+ * http://www.renesas.com/disclaimer
+*******************************************************************************
+* Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *****************************************************************************/
+/******************************************************************************
+ * @headerfile     r_video_jcu.h
+ * @brief          JCU ownership shared by the JPEG back ends
+ * @version        1.00
+ * @date           15.05.2019
+ * H/W Platform    RZA1H
+ *****************************************************************************/
+ /*****************************************************************************
+ * History      : DD.MM.YYYY Ver. Description
+ *              : 15.05.2019 1.00 First Release
+ *****************************************************************************/
+/* Multiple inclusion prevention macro */
+#ifndef R_VIDEO_JCU_H
+#define R_VIDEO_JCU_H
+
+/**************************************************************************//**
+ * @ingroup R_SW_PKG_93_VIDEO_API
+ * @defgroup R_SW_PKG_93_VIDEO_JCU JCU Owner
+ * @brief Claims the JCU for one JPEG back end at a time
+ *
+ * @anchor R_SW_PKG_93_VIDEO_JCU_API_SUMMARY
+ * @par Summary
+ *
+ * The JCU back ends of the JPEG decode pipeline and of the motion JPEG
+ * recorder share the one JCU. R_VIDEO_JcuOpen() records which of them has
+ * it, and fails for the other until R_VIDEO_JcuClose(). The back ends set
+ * up their own codec and buffers, then start and wait for the JCU here.
+ *
+ * @{
+ *****************************************************************************/
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include "r_typedefs.h"
+#include "r_jcu_typedef.h"
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+/*! @enum e_video_jcu_owner_t
+ *  @brief User of the JCU
+ */
+typedef enum
+{
+    VIDEO_JCU_OWNER_NONE = 0,               /*!< The JCU is free                       */
+    VIDEO_JCU_OWNER_PIPE,                   /*!< g_jpeg_pipe_jcu, the JPEG decode pipe */
+    VIDEO_JCU_OWNER_REC                     /*!< g_mjpeg_rec_jcu, the motion JPEG recorder */
+} e_video_jcu_owner_t;
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**
+ * @brief       Claims and initialises the JCU.
+ *
+ * @param[in]   owner:          Back end claiming the JCU
+ *
+ * @retval      JCU_ERROR_OK:   Success
+ * @retval      E_STATE:        The JCU is open already, or out of semaphores
+ * @retval      Other:          Error of R_JCU_Initialize
+ */
+jcu_errorcode_t R_VIDEO_JcuOpen(const e_video_jcu_owner_t owner);
+
+/**
+ * @brief       Starts the codec set up by the owner.
+ *
+ * @retval      Error code of R_JCU_StartAsync
+ */
+jcu_errorcode_t R_VIDEO_JcuStart(void);
+
+/**
+ * @brief       Waits for the codec started by R_VIDEO_JcuStart(). If it does
+ *              not finish in time the JCU is reset.
+ *
+ * @param[in]   timeout:        Time to wait in ms
+ *
+ * @retval      E_TIME_OUT:     The codec did not finish in time
+ * @retval      Other:          Error code of the codec
+ */
+jcu_errorcode_t R_VIDEO_JcuWait(const uint32_t timeout);
+
+/**
+ * @brief       Stops the JCU and releases it. Does nothing unless owner has
+ *              the JCU.
+ *
+ * @param[in]   owner:          Back end that opened the JCU
+ */
+void R_VIDEO_JcuClose(const e_video_jcu_owner_t owner);
+
+#endif  /* R_VIDEO_JCU_H */
+/**************************************************************************//**
+ * @} (end addtogroup)
+ *****************************************************************************/
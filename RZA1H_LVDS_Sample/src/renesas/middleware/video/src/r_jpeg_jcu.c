@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_jpeg_jcu.c
+ * @file         r_jpeg_jcu.c
+ * @version      1.00
+ * @brief        JCU back end of the JPEG decode pipeline
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_cache_l1_rz_api.h"
+#include    "r_jcu.h"
+#include    "r_jpeg_pipe.h"
+#include    "r_video_jcu.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+/* The JCU reads and writes 8 byte units with the first byte in the top bits */
+#define JCU_PIPE_SWAP           (JCU_SWAP_LONG_WORD_AND_WORD_AND_BYTE)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static uint32_t gs_jcu_dst;             /* Surface written by the current decode */
+static uint32_t gs_jcu_dst_size;
+
+static jcu_errorcode_t jcu_open(void);
+static jcu_errorcode_t jcu_start(const st_jpeg_pipe_decode_t * const p_decode);
+static jcu_errorcode_t jcu_wait(const uint32_t timeout);
+static void jcu_close(void);
+
+/**************************************************************************//**
+ * Function Name : jcu_open
+ * @brief       Claims the JCU, which the motion JPEG recorder may have
+ * @retval      Error code of the JCU driver, or E_STATE
+ ******************************************************************************/
+static jcu_errorcode_t jcu_open(void)
+{
+    return R_VIDEO_JcuOpen(VIDEO_JCU_OWNER_PIPE);
+} /* End of function jcu_open() */
+
+/**************************************************************************//**
+ * Function Name : jcu_start
+ * @brief       Starts decoding a JPEG
+ * @param[in]   p_decode        : Decode parameters
+ * @retval      Error code of the JCU driver
+ ******************************************************************************/
+static jcu_errorcode_t jcu_start(const st_jpeg_pipe_decode_t * const p_decode)
+{
+    jcu_errorcode_t error;
+    jcu_decode_param_t decode;
+    jcu_buffer_param_t buffer;
+    uint32_t bpp;
+
+    decode.verticalSubSampling = p_decode->v_scale;
+    decode.horizontalSubSampling = p_decode->h_scale;
+    decode.decodeFormat = p_decode->dst.format;
+    decode.outputCbCrOffset = p_decode->cbcr_offset;
+    decode.alpha = p_decode->alpha;
+
+    buffer.source.swapSetting = JCU_PIPE_SWAP;
+    buffer.source.address = (uint32_t *) p_decode->p_jpeg;
+    buffer.destination.swapSetting = JCU_PIPE_SWAP;
+    buffer.destination.address = (uint32_t *) p_decode->dst.p_base;
+    buffer.lineOffset = p_decode->dst.stride;
+
+    /* The JCU works on memory, the surface must not be overwritten by dirty lines later */
+    bpp = (JCU_OUTPUT_ARGB8888 == p_decode->dst.format) ? 4u : 2u;
+    gs_jcu_dst = (uint32_t) p_decode->dst.p_base;
+    gs_jcu_dst_size = (uint32_t) p_decode->dst.stride * bpp * p_decode->dst.height;
+    R_CACHE_L1_CleanLine((uint32_t) p_decode->p_jpeg, p_decode->size);
+    R_CACHE_L1_CleanInvalidLine(gs_jcu_dst, gs_jcu_dst_size);
+
+    error = R_JCU_SelectCodec(JCU_DECODE);
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetDecodeParam(&decode, &buffer);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_VIDEO_JcuStart();
+    }
+
+    return error;
+} /* End of function jcu_start() */
+
+/**************************************************************************//**
+ * Function Name : jcu_wait
+ * @brief       Waits for the decode started by jcu_start. If it does not
+ *              finish in time the JCU is reset.
+ * @param[in]   timeout         : Time to wait in ms
+ * @retval      Error code of the decode, or E_TIME_OUT
+ ******************************************************************************/
+static jcu_errorcode_t jcu_wait(const uint32_t timeout)
+{
+    jcu_errorcode_t error;
+
+    error = R_VIDEO_JcuWait(timeout);
+
+    /* Lines of the surface may have been fetched while the JCU wrote it */
+    R_CACHE_L1_InvalidLine(gs_jcu_dst, gs_jcu_dst_size);
+
+    return error;
+} /* End of function jcu_wait() */
+
+/**************************************************************************//**
+ * Function Name : jcu_close
+ * @brief       Stops the JCU
+ * @retval      none
+ ******************************************************************************/
+static void jcu_close(void)
+{
+    R_VIDEO_JcuClose(VIDEO_JCU_OWNER_PIPE);
+} /* End of function jcu_close() */
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+const st_jpeg_pipe_backend_t g_jpeg_pipe_jcu =
+{
+    &jcu_open,
+    &jcu_start,
+    &jcu_wait,
+    &jcu_close
+};
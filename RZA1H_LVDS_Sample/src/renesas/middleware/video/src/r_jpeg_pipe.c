@@ -0,0 +1,786 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_jpeg_pipe.c
+ * @file         r_jpeg_pipe.c
+ * @version      1.00
+ * @brief        Pipelined JPEG decode to surface service
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    <string.h>
+
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_fatfs_abstraction.h"
+#include    "FreeRTOS.h"
+#include    "task.h"
+#include    "r_jpeg_pipe.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define PIPE_IDLE_MS        (100u)  /* Longest wait for a job before checking for a stop */
+
+/* JPEG markers */
+#define PIPE_MARKER         (0xFFu)
+#define PIPE_SOI            (0xD8u)
+#define PIPE_EOI            (0xD9u)
+#define PIPE_SOS            (0xDAu)
+#define PIPE_SOF0           (0xC0u)
+#define PIPE_SOF1           (0xC1u)
+#define PIPE_SOF15          (0xCFu)
+#define PIPE_DHT            (0xC4u)
+#define PIPE_JPG            (0xC8u)
+#define PIPE_DAC            (0xCCu)
+#define PIPE_RST0           (0xD0u)
+#define PIPE_RST7           (0xD7u)
+#define PIPE_TEM            (0x01u)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static void pipe_task(void *parameters);
+
+/**************************************************************************//**
+ * Function Name : read_be16
+ * @brief       Reads a big endian 16 bit value
+ * @param[in]   p_data          : First byte
+ * @retval      Value
+ ******************************************************************************/
+static uint32_t read_be16(const uint8_t * const p_data)
+{
+    return (((uint32_t) p_data[0] << 8) | (uint32_t) p_data[1]);
+} /* End of function read_be16() */
+
+/**************************************************************************//**
+ * Function Name : scaled
+ * @brief       Size of a side of the image after scaling
+ * @param[in]   size            : Pixels before scaling
+ * @param[in]   scale           : Scaling
+ * @retval      Pixels after scaling
+ ******************************************************************************/
+static uint32_t scaled(const uint32_t size, const jcu_sub_sampling_t scale)
+{
+    return ((size + ((1u << (uint32_t) scale) - 1u)) >> (uint32_t) scale);
+} /* End of function scaled() */
+
+/**************************************************************************//**
+ * Function Name : parse_sof
+ * @brief       Reads a baseline frame header
+ * @param[in]   p_sof           : Frame header, after the length
+ * @param[in]   length          : Bytes of frame header, after the length
+ * @param[out]  p_info          : Image information
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for the frame
+ ******************************************************************************/
+static jcu_errorcode_t parse_sof(const uint8_t * const p_sof, const uint32_t length,
+        jcu_image_info_t * const p_info)
+{
+    jcu_errorcode_t error;
+    uint32_t i;
+
+    error = JCU_JCDERR_OK;
+
+    /* Precision, height, width and one YCbCr component after another */
+    if (length < 6u)
+    {
+        error = JCU_JCDERR_INVALID_SOF;
+    }
+    else if (8u != p_sof[0])
+    {
+        error = JCU_JCDERR_SOF_ACCURACY;
+    }
+    else if ((3u != p_sof[5]) || (length < (6u + (3u * 3u))))
+    {
+        error = JCU_JCDERR_COMPONENT_1;
+    }
+    else
+    {
+        p_info->height = read_be16(&p_sof[1]);
+        p_info->width = read_be16(&p_sof[3]);
+
+        /* The chroma is never sampled more often than once per MCU */
+        switch (p_sof[7])
+        {
+            case 0x11u:
+            {
+                p_info->encodedFormat = JCU_JPEG_YCbCr444;
+                break;
+            }
+            case 0x21u:
+            {
+                p_info->encodedFormat = JCU_JPEG_YCbCr422;
+                break;
+            }
+            case 0x22u:
+            {
+                p_info->encodedFormat = JCU_JPEG_YCbCr420;
+                break;
+            }
+            case 0x41u:
+            {
+                p_info->encodedFormat = JCU_JPEG_YCbCr411;
+                break;
+            }
+            default:
+            {
+                error = JCU_JCDERR_COMPONENT_2;
+                break;
+            }
+        }
+        for (i = 1u; i < 3u; i++)
+        {
+            if (0x11u != p_sof[7u + (i * 3u)])
+            {
+                error = JCU_JCDERR_COMPONENT_2;
+            }
+        }
+
+        if ((JCU_JCDERR_OK == error) && ((0u == p_info->width) || (0u == p_info->height)))
+        {
+            error = JCU_JCDERR_IMAGE_SIZE;
+        }
+    }
+
+    return error;
+} /* End of function parse_sof() */
+
+/**************************************************************************//**
+ * Function Name : take_job
+ * @brief       Takes the oldest job from the queue
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[in]   timeout         : Time to wait in ms
+ * @retval      Job, or NULL if there was none
+ ******************************************************************************/
+static st_jpeg_pipe_job_t *take_job(st_jpeg_pipe_t * const p_pipe, const uint32_t timeout)
+{
+    st_jpeg_pipe_job_t *p_job;
+    int_t lock;
+
+    p_job = NULL;
+
+    if (true == R_OS_WaitForSemaphore(&p_pipe->semid, timeout))
+    {
+        lock = R_OS_SysLock(NULL);
+
+        /* R_JPEG_PipeDestroy releases the semaphore without a job */
+        if (0u != p_pipe->count)
+        {
+            p_job = p_pipe->queue[p_pipe->head];
+            p_pipe->head = (p_pipe->head + 1u) % JPEG_PIPE_QUEUE_DEPTH;
+            p_pipe->count--;
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return p_job;
+} /* End of function take_job() */
+
+/**************************************************************************//**
+ * Function Name : load_job
+ * @brief       Reads the JPEG of a job and checks it against the target
+ *              surface
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[in]   p_job           : Job
+ * @param[in]   p_buff          : Input buffer that is not in use
+ * @retval      JCU_ERROR_OK, or why the job fails
+ ******************************************************************************/
+static jcu_errorcode_t load_job(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_job_t * const p_job,
+        uint8_t * const p_buff)
+{
+    jcu_errorcode_t error;
+    jcu_image_info_t info;
+    uint32_t request;
+    int_t count;
+
+    error = JCU_ERROR_OK;
+
+    if (JPEG_PIPE_SOURCE_MEMORY == p_job->source)
+    {
+        /* Aligned data is decoded where it is */
+        if (0u == ((uint32_t) p_job->p_data & (JPEG_PIPE_ALIGNMENT - 1u)))
+        {
+            p_job->p_jpeg = p_job->p_data;
+            p_job->jpeg_size = p_job->size;
+        }
+        else if (p_job->size > p_pipe->buff_size)
+        {
+            error = E_FEW_ARRAY;
+        }
+        else
+        {
+            memcpy(p_buff, p_job->p_data, p_job->size);
+            p_job->p_jpeg = p_buff;
+            p_job->jpeg_size = p_job->size;
+        }
+    }
+    else
+    {
+        request = (0u == p_job->size) ? p_pipe->buff_size : p_job->size;
+        if (request > p_pipe->buff_size)
+        {
+            error = E_FEW_ARRAY;
+        }
+        else
+        {
+            count = R_FAT_ReadFile(p_job->p_file, p_buff, (unsigned int) request);
+            if (count < 0)
+            {
+                error = E_ERRNO;
+            }
+            else if ((0u == p_job->size) && ((uint32_t) count == request) && (0 == R_FAT_EndOfFile(p_job->p_file)))
+            {
+                error = E_FEW_ARRAY;
+            }
+            else
+            {
+                p_job->p_jpeg = p_buff;
+                p_job->jpeg_size = (uint32_t) count;
+            }
+        }
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JPEG_PipeGetImageInfo(p_job->p_jpeg, p_job->jpeg_size, &info);
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        p_job->width = info.width;
+        p_job->height = info.height;
+        if ((scaled(info.width, p_job->h_scale) > p_job->dst.width)
+                || (scaled(info.height, p_job->v_scale) > p_job->dst.height))
+        {
+            error = E_LIMITATION;
+        }
+    }
+
+    return error;
+} /* End of function load_job() */
+
+/**************************************************************************//**
+ * Function Name : start_job
+ * @brief       Passes a loaded job to the back end
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[in]   p_job           : Job
+ * @retval      Error of the back end
+ ******************************************************************************/
+static jcu_errorcode_t start_job(st_jpeg_pipe_t * const p_pipe, const st_jpeg_pipe_job_t * const p_job)
+{
+    st_jpeg_pipe_decode_t decode;
+
+    decode.p_jpeg = p_job->p_jpeg;
+    decode.size = p_job->jpeg_size;
+    decode.dst = p_job->dst;
+    decode.h_scale = p_job->h_scale;
+    decode.v_scale = p_job->v_scale;
+    decode.cbcr_offset = p_job->cbcr_offset;
+    decode.alpha = p_job->alpha;
+
+    return p_pipe->p_backend->p_start(&decode);
+} /* End of function start_job() */
+
+/**************************************************************************//**
+ * Function Name : finish_job
+ * @brief       Records the times and the result of a job and hands it back
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[in]   p_job           : Job
+ * @retval      none
+ ******************************************************************************/
+static void finish_job(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_job_t * const p_job)
+{
+    uint32_t now;
+    int_t lock;
+
+    now = (uint32_t) xTaskGetTickCount();
+    p_job->queued_ms = OS_SYSTICKS_TO_MS(p_job->tick_start - p_job->tick_submit);
+    p_job->decode_ms = OS_SYSTICKS_TO_MS(now - p_job->tick_start);
+    p_job->latency_ms = OS_SYSTICKS_TO_MS(now - p_job->tick_submit);
+
+    lock = R_OS_SysLock(NULL);
+    p_pipe->stats.jobs++;
+    if (JCU_ERROR_OK != p_job->result)
+    {
+        p_pipe->stats.errors++;
+    }
+    else
+    {
+        if (p_job->latency_ms < p_pipe->stats.latency_min_ms)
+        {
+            p_pipe->stats.latency_min_ms = p_job->latency_ms;
+        }
+        if (p_job->latency_ms > p_pipe->stats.latency_max_ms)
+        {
+            p_pipe->stats.latency_max_ms = p_job->latency_ms;
+        }
+        p_pipe->stats.latency_sum_ms += p_job->latency_ms;
+        if (p_job->decode_ms > p_pipe->stats.decode_max_ms)
+        {
+            p_pipe->stats.decode_max_ms = p_job->decode_ms;
+        }
+    }
+    R_OS_SysUnlock(NULL, lock);
+
+    p_job->done = true;
+    if (NULL != p_job->p_done)
+    {
+        p_job->p_done(p_job);
+    }
+} /* End of function finish_job() */
+
+/**************************************************************************//**
+ * Function Name : clear_stats
+ * @brief       Resets the statistics, called with interrupts locked out
+ * @param[in]   p_pipe          : Pipeline instance
+ * @retval      none
+ ******************************************************************************/
+static void clear_stats(st_jpeg_pipe_t * const p_pipe)
+{
+    p_pipe->stats.jobs = 0u;
+    p_pipe->stats.errors = 0u;
+    p_pipe->stats.overlapped = 0u;
+    p_pipe->stats.latency_min_ms = 0xFFFFFFFFu;
+    p_pipe->stats.latency_max_ms = 0u;
+    p_pipe->stats.latency_sum_ms = 0u;
+    p_pipe->stats.decode_max_ms = 0u;
+} /* End of function clear_stats() */
+
+/**************************************************************************//**
+ * Function Name : pipe_task
+ * @brief       Service task. A job is read into one input buffer while the
+ *              back end decodes the job before it from the other. Jobs are
+ *              finished in the order they were submitted.
+ * @param[in]   parameters      : Pipeline instance
+ * @retval      none
+ ******************************************************************************/
+static void pipe_task(void *parameters)
+{
+    st_jpeg_pipe_t * const p_pipe = (st_jpeg_pipe_t *) parameters;
+    st_jpeg_pipe_job_t *p_job;
+    st_jpeg_pipe_job_t *p_next;
+    uint32_t fill;
+
+    p_next = NULL;
+    fill = 0u;
+
+    while (false == p_pipe->stop)
+    {
+        if (NULL == p_next)
+        {
+            p_next = take_job(p_pipe, PIPE_IDLE_MS);
+            if (NULL != p_next)
+            {
+                p_next->result = load_job(p_pipe, p_next, p_pipe->p_buff[fill]);
+            }
+        }
+
+        if (NULL != p_next)
+        {
+            p_job = p_next;
+            p_next = NULL;
+            p_job->tick_start = (uint32_t) xTaskGetTickCount();
+
+            if (JCU_ERROR_OK == p_job->result)
+            {
+                p_job->result = start_job(p_pipe, p_job);
+                if (JCU_ERROR_OK == p_job->result)
+                {
+                    /* The decoder reads from p_buff[fill] until p_wait returns */
+                    fill ^= 1u;
+
+                    p_next = take_job(p_pipe, 0u);
+                    if (NULL != p_next)
+                    {
+                        p_pipe->stats.overlapped++;
+                        p_next->result = load_job(p_pipe, p_next, p_pipe->p_buff[fill]);
+                    }
+
+                    p_job->result = p_pipe->p_backend->p_wait(p_pipe->timeout);
+                }
+            }
+
+            finish_job(p_pipe, p_job);
+        }
+    }
+
+    /* Everything that was not started fails, still in order */
+    if (NULL != p_next)
+    {
+        p_next->tick_start = (uint32_t) xTaskGetTickCount();
+        p_next->result = E_STATE;
+        finish_job(p_pipe, p_next);
+    }
+    p_next = take_job(p_pipe, 0u);
+    while (NULL != p_next)
+    {
+        p_next->tick_start = (uint32_t) xTaskGetTickCount();
+        p_next->result = E_STATE;
+        finish_job(p_pipe, p_next);
+        p_next = take_job(p_pipe, 0u);
+    }
+
+    R_OS_ReleaseSemaphore(&p_pipe->stop_semid);
+    R_OS_DeleteTask(NULL);
+} /* End of function pipe_task() */
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : R_JPEG_PipeCreate
+ * @brief       Opens the back end and starts the service task
+ * @param[out]  p_pipe          : Pipeline instance
+ * @param[in]   p_cnf           : Pipeline config
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM, E_STATE or error of the back end
+ ******************************************************************************/
+jcu_errorcode_t R_JPEG_PipeCreate(st_jpeg_pipe_t * const p_pipe, const st_jpeg_pipe_config_t * const p_cnf)
+{
+    jcu_errorcode_t error;
+    uint32_t i;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_pipe) || (NULL == p_cnf) || (NULL == p_cnf->p_backend))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((0u == p_cnf->buff_size) || (0u == p_cnf->timeout))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else
+    {
+        for (i = 0u; i < JPEG_PIPE_BUFFERS; i++)
+        {
+            if ((NULL == p_cnf->p_buff[i]) || (0u != ((uint32_t) p_cnf->p_buff[i] & (JPEG_PIPE_ALIGNMENT - 1u))))
+            {
+                error = JCU_ERROR_PARAM;
+            }
+        }
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        p_pipe->p_backend = p_cnf->p_backend;
+        for (i = 0u; i < JPEG_PIPE_BUFFERS; i++)
+        {
+            p_pipe->p_buff[i] = p_cnf->p_buff[i];
+        }
+        p_pipe->buff_size = p_cnf->buff_size;
+        p_pipe->timeout = p_cnf->timeout;
+        p_pipe->head = 0u;
+        p_pipe->count = 0u;
+        p_pipe->sequence = 0u;
+        p_pipe->stop = false;
+        clear_stats(p_pipe);
+
+        error = p_pipe->p_backend->p_open();
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        if (false == R_OS_CreateSemaphore(&p_pipe->semid, 0u))
+        {
+            error = E_STATE;
+        }
+        else if (false == R_OS_CreateSemaphore(&p_pipe->stop_semid, 0u))
+        {
+            R_OS_DeleteSemaphore(&p_pipe->semid);
+            error = E_STATE;
+        }
+        else
+        {
+            p_pipe->p_task = R_OS_CreateTask("JPEG pipe", pipe_task, p_pipe,
+                    R_OS_ABSTRACTION_PRV_DEFAULT_STACK_SIZE, p_cnf->priority);
+            if (NULL == p_pipe->p_task)
+            {
+                R_OS_DeleteSemaphore(&p_pipe->stop_semid);
+                R_OS_DeleteSemaphore(&p_pipe->semid);
+                error = E_STATE;
+            }
+        }
+
+        if (JCU_ERROR_OK != error)
+        {
+            p_pipe->p_backend->p_close();
+        }
+    }
+
+    return error;
+} /* End of function R_JPEG_PipeCreate() */
+
+/**************************************************************************//**
+ * Function Name : R_JPEG_PipeDestroy
+ * @brief       Stops the service task and closes the back end
+ * @param[in]   p_pipe          : Pipeline instance
+ * @retval      none
+ ******************************************************************************/
+void R_JPEG_PipeDestroy(st_jpeg_pipe_t * const p_pipe)
+{
+    int_t lock;
+
+    if (NULL != p_pipe)
+    {
+        lock = R_OS_SysLock(NULL);
+        p_pipe->stop = true;
+        R_OS_SysUnlock(NULL, lock);
+
+        /* Wakes the task if it is waiting for a job */
+        R_OS_ReleaseSemaphore(&p_pipe->semid);
+        while (false == R_OS_WaitForSemaphore(&p_pipe->stop_semid, PIPE_IDLE_MS))
+        {
+            /* Do Nothing */
+        }
+
+        R_OS_DeleteSemaphore(&p_pipe->stop_semid);
+        R_OS_DeleteSemaphore(&p_pipe->semid);
+        p_pipe->p_backend->p_close();
+    }
+} /* End of function R_JPEG_PipeDestroy() */
+
+/**************************************************************************//**
+ * Function Name : R_JPEG_PipeSubmit
+ * @brief       Queues a job
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[in]   p_job           : Job
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM, E_FIFO_OVER or E_STATE
+ ******************************************************************************/
+jcu_errorcode_t R_JPEG_PipeSubmit(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_job_t * const p_job)
+{
+    jcu_errorcode_t error;
+    int_t lock;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_pipe) || (NULL == p_job))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((JPEG_PIPE_SOURCE_MEMORY == p_job->source) && ((NULL == p_job->p_data) || (0u == p_job->size)))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((JPEG_PIPE_SOURCE_FILE == p_job->source) && (NULL == p_job->p_file))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((JPEG_PIPE_SOURCE_MEMORY != p_job->source) && (JPEG_PIPE_SOURCE_FILE != p_job->source))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((NULL == p_job->dst.p_base) || (0u != ((uint32_t) p_job->dst.p_base & (JPEG_PIPE_ALIGNMENT - 1u))))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((0u == p_job->dst.width) || (0u == p_job->dst.height) || (p_job->dst.stride < (int16_t) p_job->dst.width))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((p_job->h_scale > JCU_SUB_SAMPLING_1_8) || (p_job->v_scale > JCU_SUB_SAMPLING_1_8))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (JCU_OUTPUT_YCbCr422 == p_job->dst.format)
+    {
+        if ((0u != (p_job->dst.width & 1u)) || (p_job->cbcr_offset > JCU_CBCR_OFFSET_128))
+        {
+            error = JCU_ERROR_PARAM;
+        }
+    }
+    else if ((JCU_OUTPUT_ARGB8888 != p_job->dst.format) && (JCU_OUTPUT_RGB565 != p_job->dst.format))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (JCU_CBCR_OFFSET_0 != p_job->cbcr_offset)
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else
+    {
+        /* Do Nothing */
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        p_job->result = JCU_ERROR_OK;
+        p_job->width = 0u;
+        p_job->height = 0u;
+        p_job->queued_ms = 0u;
+        p_job->decode_ms = 0u;
+        p_job->latency_ms = 0u;
+        p_job->done = false;
+        p_job->tick_submit = (uint32_t) xTaskGetTickCount();
+
+        lock = R_OS_SysLock(NULL);
+        if (true == p_pipe->stop)
+        {
+            error = E_STATE;
+        }
+        else if (p_pipe->count >= JPEG_PIPE_QUEUE_DEPTH)
+        {
+            error = E_FIFO_OVER;
+        }
+        else
+        {
+            p_job->sequence = p_pipe->sequence;
+            p_pipe->sequence++;
+            p_pipe->queue[(p_pipe->head + p_pipe->count) % JPEG_PIPE_QUEUE_DEPTH] = p_job;
+            p_pipe->count++;
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        if (JCU_ERROR_OK == error)
+        {
+            R_OS_ReleaseSemaphore(&p_pipe->semid);
+        }
+    }
+
+    return error;
+} /* End of function R_JPEG_PipeSubmit() */
+
+/**************************************************************************//**
+ * Function Name : R_JPEG_PipeGetStats
+ * @brief       Reads the pipeline statistics
+ * @param[in]   p_pipe          : Pipeline instance
+ * @param[out]  p_stats         : Statistics
+ * @param[in]   clear           : true: reset the statistics after reading
+ * @retval      none
+ ******************************************************************************/
+void R_JPEG_PipeGetStats(st_jpeg_pipe_t * const p_pipe, st_jpeg_pipe_stats_t * const p_stats,
+        const bool_t clear)
+{
+    int_t lock;
+
+    if ((NULL != p_pipe) && (NULL != p_stats))
+    {
+        lock = R_OS_SysLock(NULL);
+        p_stats->jobs = p_pipe->stats.jobs;
+        p_stats->errors = p_pipe->stats.errors;
+        p_stats->overlapped = p_pipe->stats.overlapped;
+        p_stats->latency_min_ms = p_pipe->stats.latency_min_ms;
+        p_stats->latency_max_ms = p_pipe->stats.latency_max_ms;
+        p_stats->latency_sum_ms = p_pipe->stats.latency_sum_ms;
+        p_stats->decode_max_ms = p_pipe->stats.decode_max_ms;
+        if (true == clear)
+        {
+            clear_stats(p_pipe);
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        /* No job was decoded yet */
+        if (p_stats->latency_min_ms > p_stats->latency_max_ms)
+        {
+            p_stats->latency_min_ms = 0u;
+        }
+    }
+} /* End of function R_JPEG_PipeGetStats() */
+
+/**************************************************************************//**
+ * Function Name : R_JPEG_PipeGetImageInfo
+ * @brief       Reads the size and format of a JPEG from its frame header
+ * @param[in]   p_jpeg          : JPEG data
+ * @param[in]   size            : Bytes of JPEG data
+ * @param[out]  p_info          : Image information
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for this JPEG
+ ******************************************************************************/
+jcu_errorcode_t R_JPEG_PipeGetImageInfo(const uint8_t * const p_jpeg, const uint32_t size,
+        jcu_image_info_t * const p_info)
+{
+    jcu_errorcode_t error;
+    uint32_t pos;
+    uint32_t marker;
+    uint32_t length;
+    bool_t found;
+
+    error = JCU_JCDERR_OK;
+    found = false;
+
+    if ((NULL == p_jpeg) || (NULL == p_info))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((size < 4u) || (PIPE_MARKER != p_jpeg[0]) || (PIPE_SOI != p_jpeg[1]))
+    {
+        error = JCU_JCDERR_SOI_NOT_FOUND;
+    }
+    else
+    {
+        /* Skip the segments before the frame header */
+        pos = 2u;
+        while ((JCU_JCDERR_OK == error) && (false == found))
+        {
+            if ((pos + 4u) > size)
+            {
+                error = JCU_JCDERR_UNPROVIDED_SOF;
+            }
+            else if (PIPE_MARKER != p_jpeg[pos])
+            {
+                error = JCU_JCDERR_UNPROVIDED_SOF;
+            }
+            else
+            {
+                marker = p_jpeg[pos + 1u];
+                length = read_be16(&p_jpeg[pos + 2u]);
+
+                if (PIPE_MARKER == marker)
+                {
+                    /* Fill byte */
+                    pos++;
+                }
+                else if ((PIPE_TEM == marker) || ((marker >= PIPE_RST0) && (marker <= PIPE_RST7)))
+                {
+                    pos += 2u;
+                }
+                else if ((PIPE_SOS == marker) || (PIPE_EOI == marker) || (PIPE_SOI == marker))
+                {
+                    error = JCU_JCDERR_UNPROVIDED_SOF;
+                }
+                else if ((length < 2u) || ((pos + 2u + length) > size))
+                {
+                    error = JCU_JCDERR_UNPROVIDED_SOF;
+                }
+                else if ((PIPE_SOF0 == marker) || (PIPE_SOF1 == marker))
+                {
+                    error = parse_sof(&p_jpeg[pos + 4u], length - 2u, p_info);
+                    found = true;
+                }
+                else if ((marker > PIPE_SOF1) && (marker <= PIPE_SOF15)
+                        && (PIPE_DHT != marker) && (PIPE_JPG != marker) && (PIPE_DAC != marker))
+                {
+                    /* Progressive, lossless, hierarchical and arithmetic coded frames */
+                    error = JCU_JCDERR_INVALID_SOF;
+                }
+                else
+                {
+                    pos += 2u + length;
+                }
+            }
+        }
+    }
+
+    return error;
+} /* End of function R_JPEG_PipeGetImageInfo() */
@@ -0,0 +1,1056 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_jpeg_soft.c
+ * @file         r_jpeg_soft.c
+ * @version      1.00
+ * @brief        Software back end of the JPEG decode pipeline. Decodes the
+ *               baseline JPEGs accepted by the JCU, in the caller of p_wait.
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    <string.h>
+
+#include    "r_typedefs.h"
+#include    "r_jpeg_pipe.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define SOFT_BLOCK          (8u)    /* Samples per side of a block           */
+#define SOFT_MAX_H          (4u)    /* Largest horizontal sampling, YCbCr411 */
+#define SOFT_MAX_V          (2u)    /* Largest vertical sampling, YCbCr420   */
+#define SOFT_COMPONENTS     (3u)
+#define SOFT_TABLES         (4u)
+
+/* JPEG markers */
+#define SOFT_MARKER         (0xFFu)
+#define SOFT_SOF0           (0xC0u)
+#define SOFT_SOF1           (0xC1u)
+#define SOFT_DHT            (0xC4u)
+#define SOFT_RST0           (0xD0u)
+#define SOFT_RST7           (0xD7u)
+#define SOFT_EOI            (0xD9u)
+#define SOFT_SOS            (0xDAu)
+#define SOFT_DQT            (0xDBu)
+#define SOFT_DRI            (0xDDu)
+#define SOFT_TEM            (0x01u)
+
+/* YCbCr to RGB, full range BT.601 in 16 fractional bits */
+#define SOFT_R_CR           (91881)
+#define SOFT_G_CB           (22554)
+#define SOFT_G_CR           (46802)
+#define SOFT_B_CB           (116130)
+#define SOFT_HALF           (32768)
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t  vals[256];                 /* Symbols in code order              */
+    int32_t  mincode[17];               /* First code of each length          */
+    int32_t  maxcode[17];               /* Last code of each length, or -1    */
+    int32_t  valptr[17];                /* Index of the first code in vals    */
+    bool_t   valid;
+} st_soft_huff_t;
+
+typedef struct
+{
+    uint8_t  id;
+    uint8_t  h;                         /* Blocks per MCU horizontally */
+    uint8_t  v;                         /* Blocks per MCU vertically   */
+    uint8_t  tq;                        /* Quantisation table          */
+    uint8_t  td;                        /* DC Huffman table            */
+    uint8_t  ta;                        /* AC Huffman table            */
+    int32_t  pred;                      /* DC predictor                */
+} st_soft_comp_t;
+
+typedef struct
+{
+    /* Entropy coded data */
+    const uint8_t  *p_data;
+    uint32_t       size;
+    uint32_t       pos;
+    uint32_t       bits;                /* Next bits, first bit in bit 31       */
+    uint32_t       nbits;
+    uint32_t       fake;                /* Zero bytes fed after a marker or the end */
+    bool_t         marker;              /* pos is at a marker                   */
+
+    /* Tables and frame */
+    uint16_t       qt[SOFT_TABLES][64]; /* Zig-zag order */
+    bool_t         qt_valid[SOFT_TABLES];
+    st_soft_huff_t dc[SOFT_TABLES];
+    st_soft_huff_t ac[SOFT_TABLES];
+    st_soft_comp_t comp[SOFT_COMPONENTS];
+    jcu_image_info_t info;
+    uint32_t       hmax;
+    uint32_t       vmax;
+    uint32_t       restart;             /* MCUs per restart interval, 0 for none */
+
+    /* One MCU, each component at its own resolution */
+    uint8_t        mcu[SOFT_COMPONENTS][SOFT_MAX_V * SOFT_BLOCK][SOFT_MAX_H * SOFT_BLOCK];
+
+    st_jpeg_pipe_decode_t decode;
+    bool_t         pending;
+} st_soft_decoder_t;
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static st_soft_decoder_t gs_soft;
+
+/* Natural order index of each zig-zag position */
+static const uint8_t gs_zigzag[64] =
+{
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+/* C(u) / 2 * cos((2x + 1) * u * pi / 16), indexed [x][u] */
+static const float gs_idct[8][8] =
+{
+    { 0.353553391f, 0.490392640f, 0.461939766f, 0.415734806f, 0.353553391f, 0.277785117f, 0.191341716f, 0.097545161f },
+    { 0.353553391f, 0.415734806f, 0.191341716f, -0.097545161f, -0.353553391f, -0.490392640f, -0.461939766f, -0.277785117f },
+    { 0.353553391f, 0.277785117f, -0.191341716f, -0.490392640f, -0.353553391f, 0.097545161f, 0.461939766f, 0.415734806f },
+    { 0.353553391f, 0.097545161f, -0.461939766f, -0.277785117f, 0.353553391f, 0.415734806f, -0.191341716f, -0.490392640f },
+    { 0.353553391f, -0.097545161f, -0.461939766f, 0.277785117f, 0.353553391f, -0.415734806f, -0.191341716f, 0.490392640f },
+    { 0.353553391f, -0.277785117f, -0.191341716f, 0.490392640f, -0.353553391f, -0.097545161f, 0.461939766f, -0.415734806f },
+    { 0.353553391f, -0.415734806f, 0.191341716f, 0.097545161f, -0.353553391f, 0.490392640f, -0.461939766f, 0.277785117f },
+    { 0.353553391f, -0.490392640f, 0.461939766f, -0.415734806f, 0.353553391f, -0.277785117f, 0.191341716f, -0.097545161f }
+};
+
+static jcu_errorcode_t soft_open(void);
+static jcu_errorcode_t soft_start(const st_jpeg_pipe_decode_t * const p_decode);
+static jcu_errorcode_t soft_wait(const uint32_t timeout);
+static void soft_close(void);
+
+/**************************************************************************//**
+ * Function Name : clamp
+ * @brief       Limits a sample to 0 - 255
+ * @param[in]   value           : Sample
+ * @retval      Limited sample
+ ******************************************************************************/
+static uint32_t clamp(const int32_t value)
+{
+    uint32_t result;
+
+    if (value < 0)
+    {
+        result = 0u;
+    }
+    else if (value > 255)
+    {
+        result = 255u;
+    }
+    else
+    {
+        result = (uint32_t) value;
+    }
+
+    return result;
+} /* End of function clamp() */
+
+/**************************************************************************//**
+ * Function Name : fill_bits
+ * @brief       Tops up the bit buffer to more than 24 bits. Stuffed zero
+ *              bytes are removed. At a marker or the end of the data zero
+ *              bytes are fed instead, and counted.
+ * @param[in]   p_dec           : Decoder
+ * @retval      none
+ ******************************************************************************/
+static void fill_bits(st_soft_decoder_t * const p_dec)
+{
+    uint32_t byte;
+
+    while (p_dec->nbits <= 24u)
+    {
+        byte = 0u;
+        if ((false == p_dec->marker) && (p_dec->pos < p_dec->size))
+        {
+            byte = p_dec->p_data[p_dec->pos];
+            if (SOFT_MARKER != byte)
+            {
+                p_dec->pos++;
+            }
+            else if (((p_dec->pos + 1u) < p_dec->size) && (0u == p_dec->p_data[p_dec->pos + 1u]))
+            {
+                p_dec->pos += 2u;
+            }
+            else
+            {
+                p_dec->marker = true;
+                byte = 0u;
+                p_dec->fake++;
+            }
+        }
+        else
+        {
+            p_dec->fake++;
+        }
+        p_dec->bits |= byte << (24u - p_dec->nbits);
+        p_dec->nbits += 8u;
+    }
+} /* End of function fill_bits() */
+
+/**************************************************************************//**
+ * Function Name : get_bits
+ * @brief       Reads bits of the entropy coded data
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   count           : Bits to read, 0 - 16
+ * @retval      Bits, first bit in the most significant position
+ ******************************************************************************/
+static uint32_t get_bits(st_soft_decoder_t * const p_dec, const uint32_t count)
+{
+    uint32_t value;
+
+    value = 0u;
+    if (0u != count)
+    {
+        fill_bits(p_dec);
+        value = p_dec->bits >> (32u - count);
+        p_dec->bits <<= count;
+        p_dec->nbits -= count;
+    }
+
+    return value;
+} /* End of function get_bits() */
+
+/**************************************************************************//**
+ * Function Name : extend
+ * @brief       Converts the bits of a coefficient to its value
+ * @param[in]   value           : Bits
+ * @param[in]   count           : Number of bits
+ * @retval      Coefficient
+ ******************************************************************************/
+static int32_t extend(const uint32_t value, const uint32_t count)
+{
+    int32_t result;
+
+    result = (int32_t) value;
+    if ((0u != count) && (value < (1u << (count - 1u))))
+    {
+        result = (result - (int32_t) (1u << count)) + 1;
+    }
+
+    return result;
+} /* End of function extend() */
+
+/**************************************************************************//**
+ * Function Name : get_symbol
+ * @brief       Decodes one Huffman code
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_huff          : Huffman table
+ * @param[out]  p_symbol        : Symbol
+ * @retval      JCU_JCDERR_OK or JCU_JCDERR_BLOCK_DATA
+ ******************************************************************************/
+static jcu_errorcode_t get_symbol(st_soft_decoder_t * const p_dec, const st_soft_huff_t * const p_huff,
+        uint32_t * const p_symbol)
+{
+    jcu_errorcode_t error;
+    uint32_t peek;
+    int32_t code;
+    uint32_t len;
+
+    error = JCU_JCDERR_BLOCK_DATA;
+
+    fill_bits(p_dec);
+    peek = p_dec->bits >> 16;
+    for (len = 1u; len <= 16u; len++)
+    {
+        code = (int32_t) (peek >> (16u - len));
+        if (code <= p_huff->maxcode[len])
+        {
+            *p_symbol = p_huff->vals[(p_huff->valptr[len] + code) - p_huff->mincode[len]];
+            p_dec->bits <<= len;
+            p_dec->nbits -= len;
+            error = JCU_JCDERR_OK;
+            break;
+        }
+    }
+
+    return error;
+} /* End of function get_symbol() */
+
+/**************************************************************************//**
+ * Function Name : idct_block
+ * @brief       Inverse DCT of one block into the MCU
+ * @param[in]   p_coef          : Dequantised coefficients, natural order
+ * @param[out]  p_out           : Top left sample of the block in the MCU
+ * @param[in]   stride          : Samples per line of the MCU
+ * @retval      none
+ ******************************************************************************/
+static void idct_block(const int32_t * const p_coef, uint8_t * const p_out, const uint32_t stride)
+{
+    float tmp[64];
+    float sum;
+    uint32_t x;
+    uint32_t y;
+    uint32_t u;
+
+    for (y = 0u; y < 8u; y++)
+    {
+        for (x = 0u; x < 8u; x++)
+        {
+            sum = 0.0f;
+            for (u = 0u; u < 8u; u++)
+            {
+                sum += (float) p_coef[(y * 8u) + u] * gs_idct[x][u];
+            }
+            tmp[(y * 8u) + x] = sum;
+        }
+    }
+
+    for (y = 0u; y < 8u; y++)
+    {
+        for (x = 0u; x < 8u; x++)
+        {
+            sum = 128.5f;
+            for (u = 0u; u < 8u; u++)
+            {
+                sum += tmp[(u * 8u) + x] * gs_idct[y][u];
+            }
+            p_out[(y * stride) + x] = (uint8_t) clamp((sum < 0.0f) ? -1 : (int32_t) sum);
+        }
+    }
+} /* End of function idct_block() */
+
+/**************************************************************************//**
+ * Function Name : decode_block
+ * @brief       Decodes one block of a component
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_comp          : Component
+ * @param[out]  p_out           : Top left sample of the block in the MCU
+ * @retval      JCU_JCDERR_OK or JCU_JCDERR_BLOCK_DATA
+ ******************************************************************************/
+static jcu_errorcode_t decode_block(st_soft_decoder_t * const p_dec, st_soft_comp_t * const p_comp,
+        uint8_t * const p_out)
+{
+    jcu_errorcode_t error;
+    const uint16_t * const p_q = p_dec->qt[p_comp->tq];
+    int32_t coef[64];
+    uint32_t symbol;
+    uint32_t run;
+    uint32_t count;
+    uint32_t k;
+
+    memset(coef, 0, sizeof(coef));
+
+    error = get_symbol(p_dec, &p_dec->dc[p_comp->td], &symbol);
+    if ((JCU_JCDERR_OK == error) && (symbol > 11u))
+    {
+        error = JCU_JCDERR_BLOCK_DATA;
+    }
+    if (JCU_JCDERR_OK == error)
+    {
+        p_comp->pred += extend(get_bits(p_dec, symbol), symbol);
+        coef[0] = p_comp->pred * (int32_t) p_q[0];
+    }
+
+    k = 1u;
+    while ((JCU_JCDERR_OK == error) && (k < 64u))
+    {
+        error = get_symbol(p_dec, &p_dec->ac[p_comp->ta], &symbol);
+        if (JCU_JCDERR_OK == error)
+        {
+            run = symbol >> 4;
+            count = symbol & 0x0Fu;
+            if (0u == count)
+            {
+                if (15u != run)
+                {
+                    /* End of block */
+                    break;
+                }
+                k += 16u;
+            }
+            else
+            {
+                k += run;
+                if (k > 63u)
+                {
+                    error = JCU_JCDERR_BLOCK_DATA;
+                }
+                else
+                {
+                    coef[gs_zigzag[k]] = extend(get_bits(p_dec, count), count) * (int32_t) p_q[k];
+                    k++;
+                }
+            }
+        }
+    }
+
+    if (JCU_JCDERR_OK == error)
+    {
+        idct_block(coef, p_out, SOFT_MAX_H * SOFT_BLOCK);
+    }
+
+    return error;
+} /* End of function decode_block() */
+
+/**************************************************************************//**
+ * Function Name : put_pixel
+ * @brief       Writes one pixel to the target surface
+ * @param[in]   p_decode        : Decode parameters
+ * @param[in]   x               : Pixel in the target
+ * @param[in]   y               : Line in the target
+ * @param[in]   p_ycc           : Y, Cb and Cr
+ * @retval      none
+ ******************************************************************************/
+static void put_pixel(const st_jpeg_pipe_decode_t * const p_decode, const uint32_t x, const uint32_t y,
+        const uint32_t * const p_ycc)
+{
+    uint8_t *p_line;
+    int32_t luma;
+    int32_t cb;
+    int32_t cr;
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+
+    luma = (int32_t) p_ycc[0];
+    cb = (int32_t) p_ycc[1] - 128;
+    cr = (int32_t) p_ycc[2] - 128;
+
+    if (JCU_OUTPUT_YCbCr422 == p_decode->dst.format)
+    {
+        /* Bytes Y0 Cb Y1 Cr, the chroma of a pair is taken from its first pixel */
+        p_line = (uint8_t *) p_decode->dst.p_base + (y * (uint32_t) p_decode->dst.stride * 2u);
+        p_line[x * 2u] = (uint8_t) luma;
+        if (0u == (x & 1u))
+        {
+            if (JCU_CBCR_OFFSET_128 == p_decode->cbcr_offset)
+            {
+                p_line[(x * 2u) + 1u] = (uint8_t) p_ycc[1];
+                p_line[(x * 2u) + 3u] = (uint8_t) p_ycc[2];
+            }
+            else
+            {
+                p_line[(x * 2u) + 1u] = (uint8_t) cb;
+                p_line[(x * 2u) + 3u] = (uint8_t) cr;
+            }
+        }
+    }
+    else
+    {
+        r = clamp(luma + (((SOFT_R_CR * cr) + SOFT_HALF) >> 16));
+        g = clamp(luma - (((SOFT_G_CB * cb) + (SOFT_G_CR * cr) + SOFT_HALF) >> 16));
+        b = clamp(luma + (((SOFT_B_CB * cb) + SOFT_HALF) >> 16));
+
+        if (JCU_OUTPUT_ARGB8888 == p_decode->dst.format)
+        {
+            p_line = (uint8_t *) p_decode->dst.p_base + (y * (uint32_t) p_decode->dst.stride * 4u);
+            ((uint32_t *) p_line)[x] = ((uint32_t) p_decode->alpha << 24) | (r << 16) | (g << 8) | b;
+        }
+        else
+        {
+            p_line = (uint8_t *) p_decode->dst.p_base + (y * (uint32_t) p_decode->dst.stride * 2u);
+            ((uint16_t *) p_line)[x] = (uint16_t) (((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+        }
+    }
+} /* End of function put_pixel() */
+
+/**************************************************************************//**
+ * Function Name : put_mcu
+ * @brief       Writes the pixels of an MCU that the scaling keeps. The
+ *              chroma is repeated over the luma samples it covers.
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   x0              : Left pixel of the MCU in the JPEG
+ * @param[in]   y0              : Top line of the MCU in the JPEG
+ * @retval      none
+ ******************************************************************************/
+static void put_mcu(st_soft_decoder_t * const p_dec, const uint32_t x0, const uint32_t y0)
+{
+    const uint32_t hmask = (1u << (uint32_t) p_dec->decode.h_scale) - 1u;
+    const uint32_t vmask = (1u << (uint32_t) p_dec->decode.v_scale) - 1u;
+    uint32_t ycc[SOFT_COMPONENTS];
+    uint32_t px;
+    uint32_t py;
+    uint32_t c;
+
+    for (py = 0u; (py < (p_dec->vmax * SOFT_BLOCK)) && ((y0 + py) < p_dec->info.height); py++)
+    {
+        if (0u == ((y0 + py) & vmask))
+        {
+            for (px = 0u; (px < (p_dec->hmax * SOFT_BLOCK)) && ((x0 + px) < p_dec->info.width); px++)
+            {
+                if (0u == ((x0 + px) & hmask))
+                {
+                    for (c = 0u; c < SOFT_COMPONENTS; c++)
+                    {
+                        ycc[c] = p_dec->mcu[c][(py * p_dec->comp[c].v) / p_dec->vmax]
+                                [(px * p_dec->comp[c].h) / p_dec->hmax];
+                    }
+                    put_pixel(&p_dec->decode, (x0 + px) >> (uint32_t) p_dec->decode.h_scale,
+                            (y0 + py) >> (uint32_t) p_dec->decode.v_scale, ycc);
+                }
+            }
+        }
+    }
+} /* End of function put_mcu() */
+
+/**************************************************************************//**
+ * Function Name : restart
+ * @brief       Expects a restart marker and resets the decoder state
+ * @param[in]   p_dec           : Decoder
+ * @retval      JCU_JCDERR_OK or JCU_JCDERR_RESTART_INTERVAL
+ ******************************************************************************/
+static jcu_errorcode_t restart(st_soft_decoder_t * const p_dec)
+{
+    jcu_errorcode_t error;
+    uint32_t c;
+
+    error = JCU_JCDERR_OK;
+
+    /* The bits left are padding of the interval before */
+    p_dec->bits = 0u;
+    p_dec->nbits = 0u;
+    if (((p_dec->pos + 1u) < p_dec->size) && (SOFT_MARKER == p_dec->p_data[p_dec->pos])
+            && (p_dec->p_data[p_dec->pos + 1u] >= SOFT_RST0) && (p_dec->p_data[p_dec->pos + 1u] <= SOFT_RST7))
+    {
+        p_dec->pos += 2u;
+        p_dec->marker = false;
+        p_dec->fake = 0u;
+        for (c = 0u; c < SOFT_COMPONENTS; c++)
+        {
+            p_dec->comp[c].pred = 0;
+        }
+    }
+    else
+    {
+        error = JCU_JCDERR_RESTART_INTERVAL;
+    }
+
+    return error;
+} /* End of function restart() */
+
+/**************************************************************************//**
+ * Function Name : decode_scan
+ * @brief       Decodes the entropy coded data of an interleaved scan
+ * @param[in]   p_dec           : Decoder
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for the data
+ ******************************************************************************/
+static jcu_errorcode_t decode_scan(st_soft_decoder_t * const p_dec)
+{
+    jcu_errorcode_t error;
+    const uint32_t mcu_w = p_dec->hmax * SOFT_BLOCK;
+    const uint32_t mcu_h = p_dec->vmax * SOFT_BLOCK;
+    uint32_t mcus;
+    uint32_t mx;
+    uint32_t my;
+    uint32_t c;
+    uint32_t bx;
+    uint32_t by;
+
+    error = JCU_JCDERR_OK;
+    mcus = 0u;
+    p_dec->bits = 0u;
+    p_dec->nbits = 0u;
+    p_dec->fake = 0u;
+    p_dec->marker = false;
+    for (c = 0u; c < SOFT_COMPONENTS; c++)
+    {
+        p_dec->comp[c].pred = 0;
+    }
+
+    for (my = 0u; (JCU_JCDERR_OK == error) && ((my * mcu_h) < p_dec->info.height); my++)
+    {
+        for (mx = 0u; (JCU_JCDERR_OK == error) && ((mx * mcu_w) < p_dec->info.width); mx++)
+        {
+            if ((0u != p_dec->restart) && (0u != mcus) && (0u == (mcus % p_dec->restart)))
+            {
+                error = restart(p_dec);
+            }
+
+            for (c = 0u; (JCU_JCDERR_OK == error) && (c < SOFT_COMPONENTS); c++)
+            {
+                for (by = 0u; (JCU_JCDERR_OK == error) && (by < p_dec->comp[c].v); by++)
+                {
+                    for (bx = 0u; (JCU_JCDERR_OK == error) && (bx < p_dec->comp[c].h); bx++)
+                    {
+                        error = decode_block(p_dec, &p_dec->comp[c],
+                                &p_dec->mcu[c][by * SOFT_BLOCK][bx * SOFT_BLOCK]);
+                    }
+                }
+            }
+
+            if (JCU_JCDERR_OK == error)
+            {
+                put_mcu(p_dec, mx * mcu_w, my * mcu_h);
+                mcus++;
+            }
+        }
+    }
+
+    /* Bits fed after the end of the data were decoded as part of a block */
+    if ((JCU_JCDERR_OK == error) && ((p_dec->fake * 8u) > p_dec->nbits))
+    {
+        error = JCU_JCDERR_LAST_MCU_DATA;
+    }
+
+    return error;
+} /* End of function decode_scan() */
+
+/**************************************************************************//**
+ * Function Name : read_dqt
+ * @brief       Reads quantisation tables
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_seg           : Segment, after the length
+ * @param[in]   length          : Bytes of segment, after the length
+ * @retval      JCU_JCDERR_OK or JCU_JCDERR_DQT_ACCURACY
+ ******************************************************************************/
+static jcu_errorcode_t read_dqt(st_soft_decoder_t * const p_dec, const uint8_t * const p_seg,
+        const uint32_t length)
+{
+    jcu_errorcode_t error;
+    uint32_t pos;
+    uint32_t precision;
+    uint32_t table;
+    uint32_t k;
+
+    error = JCU_JCDERR_OK;
+    pos = 0u;
+
+    while ((JCU_JCDERR_OK == error) && (pos < length))
+    {
+        precision = p_seg[pos] >> 4;
+        table = p_seg[pos] & 0x0Fu;
+        pos++;
+
+        if ((table >= SOFT_TABLES) || (precision > 1u) || ((pos + (64u << precision)) > length))
+        {
+            error = JCU_JCDERR_DQT_ACCURACY;
+        }
+        else
+        {
+            for (k = 0u; k < 64u; k++)
+            {
+                if (0u == precision)
+                {
+                    p_dec->qt[table][k] = p_seg[pos];
+                    pos++;
+                }
+                else
+                {
+                    p_dec->qt[table][k] = (uint16_t) (((uint32_t) p_seg[pos] << 8) | p_seg[pos + 1u]);
+                    pos += 2u;
+                }
+            }
+            p_dec->qt_valid[table] = true;
+        }
+    }
+
+    return error;
+} /* End of function read_dqt() */
+
+/**************************************************************************//**
+ * Function Name : read_dht
+ * @brief       Reads Huffman tables
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_seg           : Segment, after the length
+ * @param[in]   length          : Bytes of segment, after the length
+ * @retval      JCU_JCDERR_OK or JCU_JCDERR_NO_SOF0_DQT_DHT
+ ******************************************************************************/
+static jcu_errorcode_t read_dht(st_soft_decoder_t * const p_dec, const uint8_t * const p_seg,
+        const uint32_t length)
+{
+    jcu_errorcode_t error;
+    st_soft_huff_t *p_huff;
+    uint32_t pos;
+    uint32_t total;
+    uint32_t len;
+    int32_t code;
+    int32_t index;
+
+    error = JCU_JCDERR_OK;
+    pos = 0u;
+
+    while ((JCU_JCDERR_OK == error) && (pos < length))
+    {
+        total = 0u;
+        if ((pos + 17u) <= length)
+        {
+            for (len = 1u; len <= 16u; len++)
+            {
+                total += p_seg[pos + len];
+            }
+        }
+
+        if (((pos + 17u) > length) || ((p_seg[pos] & 0x0Fu) >= SOFT_TABLES) || ((p_seg[pos] >> 4) > 1u)
+                || (total > 256u) || ((pos + 17u + total) > length))
+        {
+            error = JCU_JCDERR_NO_SOF0_DQT_DHT;
+        }
+        else
+        {
+            p_huff = (0u == (p_seg[pos] >> 4)) ? &p_dec->dc[p_seg[pos] & 0x0Fu] : &p_dec->ac[p_seg[pos] & 0x0Fu];
+            memcpy(p_huff->vals, &p_seg[pos + 17u], total);
+
+            /* Canonical codes, shortest first */
+            code = 0;
+            index = 0;
+            for (len = 1u; len <= 16u; len++)
+            {
+                p_huff->valptr[len] = index;
+                p_huff->mincode[len] = code;
+                code += (int32_t) p_seg[pos + len];
+                index += (int32_t) p_seg[pos + len];
+                p_huff->maxcode[len] = (0u != p_seg[pos + len]) ? (code - 1) : -1;
+                if (code > (int32_t) (1u << len))
+                {
+                    error = JCU_JCDERR_NO_SOF0_DQT_DHT;
+                }
+                code <<= 1;
+            }
+            p_huff->valid = (JCU_JCDERR_OK == error);
+            pos += 17u + total;
+        }
+    }
+
+    return error;
+} /* End of function read_dht() */
+
+/**************************************************************************//**
+ * Function Name : read_sof
+ * @brief       Reads the components of a frame header. The header is
+ *              checked again here, the sampling sets the size of an MCU.
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_seg           : Segment, after the length
+ * @param[in]   length          : Bytes of segment, after the length
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for the header
+ ******************************************************************************/
+static jcu_errorcode_t read_sof(st_soft_decoder_t * const p_dec, const uint8_t * const p_seg,
+        const uint32_t length)
+{
+    jcu_errorcode_t error;
+    uint32_t c;
+
+    error = JCU_JCDERR_OK;
+
+    if ((length < (6u + (SOFT_COMPONENTS * 3u))) || (SOFT_COMPONENTS != p_seg[5]))
+    {
+        error = JCU_JCDERR_COMPONENT_1;
+    }
+
+    for (c = 0u; (JCU_JCDERR_OK == error) && (c < SOFT_COMPONENTS); c++)
+    {
+        p_dec->comp[c].id = p_seg[6u + (c * 3u)];
+        p_dec->comp[c].h = p_seg[7u + (c * 3u)] >> 4;
+        p_dec->comp[c].v = p_seg[7u + (c * 3u)] & 0x0Fu;
+        p_dec->comp[c].tq = p_seg[8u + (c * 3u)];
+
+        /* The MCU buffer holds SOFT_MAX_H by SOFT_MAX_V blocks of Y, and
+           no chroma is sampled more often than Y */
+        if ((0u == p_dec->comp[c].h) || (p_dec->comp[c].h > SOFT_MAX_H)
+                || (0u == p_dec->comp[c].v) || (p_dec->comp[c].v > SOFT_MAX_V)
+                || (p_dec->comp[c].h > p_dec->comp[0].h) || (p_dec->comp[c].v > p_dec->comp[0].v))
+        {
+            error = JCU_JCDERR_COMPONENT_2;
+        }
+        else if (p_dec->comp[c].tq >= SOFT_TABLES)
+        {
+            error = JCU_JCDERR_DQT_ACCURACY;
+        }
+        else
+        {
+            /* Do Nothing */
+        }
+    }
+
+    if (JCU_JCDERR_OK == error)
+    {
+        p_dec->hmax = p_dec->comp[0].h;
+        p_dec->vmax = p_dec->comp[0].v;
+    }
+
+    return error;
+} /* End of function read_sof() */
+
+/**************************************************************************//**
+ * Function Name : read_sos
+ * @brief       Reads a scan header, the scan must hold all components
+ * @param[in]   p_dec           : Decoder
+ * @param[in]   p_seg           : Segment, after the length
+ * @param[in]   length          : Bytes of segment, after the length
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for the header
+ ******************************************************************************/
+static jcu_errorcode_t read_sos(st_soft_decoder_t * const p_dec, const uint8_t * const p_seg,
+        const uint32_t length)
+{
+    jcu_errorcode_t error;
+    uint32_t i;
+    uint32_t c;
+    bool_t found;
+
+    error = JCU_JCDERR_OK;
+
+    if ((length < (1u + (SOFT_COMPONENTS * 2u) + 3u)) || (SOFT_COMPONENTS != p_seg[0]))
+    {
+        error = JCU_JCDERR_COMPONENT_1;
+    }
+
+    for (i = 0u; (JCU_JCDERR_OK == error) && (i < SOFT_COMPONENTS); i++)
+    {
+        found = false;
+        for (c = 0u; c < SOFT_COMPONENTS; c++)
+        {
+            if (p_dec->comp[c].id == p_seg[1u + (i * 2u)])
+            {
+                p_dec->comp[c].td = p_seg[2u + (i * 2u)] >> 4;
+                p_dec->comp[c].ta = p_seg[2u + (i * 2u)] & 0x0Fu;
+                found = true;
+            }
+        }
+        if (false == found)
+        {
+            error = JCU_JCDERR_COMPONENT_2;
+        }
+    }
+
+    for (c = 0u; (JCU_JCDERR_OK == error) && (c < SOFT_COMPONENTS); c++)
+    {
+        if ((p_dec->comp[c].td >= SOFT_TABLES) || (p_dec->comp[c].ta >= SOFT_TABLES)
+                || (false == p_dec->qt_valid[p_dec->comp[c].tq])
+                || (false == p_dec->dc[p_dec->comp[c].td].valid)
+                || (false == p_dec->ac[p_dec->comp[c].ta].valid))
+        {
+            error = JCU_JCDERR_NO_SOF0_DQT_DHT;
+        }
+    }
+
+    return error;
+} /* End of function read_sos() */
+
+/**************************************************************************//**
+ * Function Name : soft_decode
+ * @brief       Decodes the JPEG passed to soft_start
+ * @param[in]   p_dec           : Decoder
+ * @retval      JCU_JCDERR_OK or the error the JCU reports for this JPEG
+ ******************************************************************************/
+static jcu_errorcode_t soft_decode(st_soft_decoder_t * const p_dec)
+{
+    jcu_errorcode_t error;
+    uint32_t marker;
+    uint32_t length;
+    uint32_t i;
+    bool_t framed;
+    bool_t scanned;
+
+    p_dec->p_data = p_dec->decode.p_jpeg;
+    p_dec->size = p_dec->decode.size;
+    p_dec->restart = 0u;
+    for (i = 0u; i < SOFT_TABLES; i++)
+    {
+        p_dec->qt_valid[i] = false;
+        p_dec->dc[i].valid = false;
+        p_dec->ac[i].valid = false;
+    }
+    framed = false;
+    scanned = false;
+
+    error = R_JPEG_PipeGetImageInfo(p_dec->p_data, p_dec->size, &p_dec->info);
+
+    /* Segments from after SOI to EOI */
+    p_dec->pos = 2u;
+    while (JCU_JCDERR_OK == error)
+    {
+        if (((p_dec->pos + 2u) > p_dec->size) || (SOFT_MARKER != p_dec->p_data[p_dec->pos]))
+        {
+            error = (true == scanned) ? JCU_JCDERR_EOI_NOT_FOUND : JCU_JCDERR_SOS_NOT_FOUND;
+            break;
+        }
+
+        marker = p_dec->p_data[p_dec->pos + 1u];
+        if (SOFT_EOI == marker)
+        {
+            if (false == scanned)
+            {
+                error = JCU_JCDERR_SOS_NOT_FOUND;
+            }
+            break;
+        }
+        if ((SOFT_MARKER == marker) || (SOFT_TEM == marker) || ((marker >= SOFT_RST0) && (marker <= SOFT_RST7)))
+        {
+            p_dec->pos += (SOFT_MARKER == marker) ? 1u : 2u;
+            continue;
+        }
+        if ((p_dec->pos + 4u) > p_dec->size)
+        {
+            error = (true == scanned) ? JCU_JCDERR_EOI_NOT_FOUND : JCU_JCDERR_SOS_NOT_FOUND;
+            break;
+        }
+        length = ((uint32_t) p_dec->p_data[p_dec->pos + 2u] << 8) | p_dec->p_data[p_dec->pos + 3u];
+        if ((length < 2u) || ((p_dec->pos + 2u + length) > p_dec->size))
+        {
+            error = (true == scanned) ? JCU_JCDERR_EOI_NOT_FOUND : JCU_JCDERR_SOS_NOT_FOUND;
+            break;
+        }
+
+        switch (marker)
+        {
+            case SOFT_DQT:
+            {
+                error = read_dqt(p_dec, &p_dec->p_data[p_dec->pos + 4u], length - 2u);
+                break;
+            }
+            case SOFT_DHT:
+            {
+                error = read_dht(p_dec, &p_dec->p_data[p_dec->pos + 4u], length - 2u);
+                break;
+            }
+            case SOFT_DRI:
+            {
+                p_dec->restart = (length >= 4u) ? (((uint32_t) p_dec->p_data[p_dec->pos + 4u] << 8)
+                        | p_dec->p_data[p_dec->pos + 5u]) : 0u;
+                break;
+            }
+            case SOFT_SOF0:
+            case SOFT_SOF1:
+            {
+                if (true == framed)
+                {
+                    /* The JCU decodes a single frame */
+                    error = JCU_JCDERR_INVALID_SOF;
+                }
+                else
+                {
+                    error = read_sof(p_dec, &p_dec->p_data[p_dec->pos + 4u], length - 2u);
+                    framed = true;
+                }
+                break;
+            }
+            case SOFT_SOS:
+            {
+                if (true == scanned)
+                {
+                    /* The JCU decodes a single scan */
+                    error = JCU_JCDERR_EOI_NOT_FOUND;
+                }
+                else if (false == framed)
+                {
+                    error = JCU_JCDERR_NO_SOF0_DQT_DHT;
+                }
+                else
+                {
+                    error = read_sos(p_dec, &p_dec->p_data[p_dec->pos + 4u], length - 2u);
+                }
+                break;
+            }
+            default:
+            {
+                /* APPn, COM and others are skipped */
+                break;
+            }
+        }
+
+        p_dec->pos += 2u + length;
+        if ((JCU_JCDERR_OK == error) && (SOFT_SOS == marker))
+        {
+            error = decode_scan(p_dec);
+            scanned = true;
+        }
+    }
+
+    return error;
+} /* End of function soft_decode() */
+
+/**************************************************************************//**
+ * Function Name : soft_open
+ * @brief       Claims the software decoder
+ * @retval      JCU_ERROR_OK
+ ******************************************************************************/
+static jcu_errorcode_t soft_open(void)
+{
+    gs_soft.pending = false;
+
+    return JCU_ERROR_OK;
+} /* End of function soft_open() */
+
+/**************************************************************************//**
+ * Function Name : soft_start
+ * @brief       Records a decode, the work is done by soft_wait
+ * @param[in]   p_decode        : Decode parameters
+ * @retval      JCU_ERROR_OK
+ ******************************************************************************/
+static jcu_errorcode_t soft_start(const st_jpeg_pipe_decode_t * const p_decode)
+{
+    gs_soft.decode = *p_decode;
+    gs_soft.pending = true;
+
+    return JCU_ERROR_OK;
+} /* End of function soft_start() */
+
+/**************************************************************************//**
+ * Function Name : soft_wait
+ * @brief       Decodes the JPEG passed to soft_start
+ * @param[in]   timeout         : Not used, the decode runs to the end
+ * @retval      JCU_JCDERR_OK, the error the JCU reports for this JPEG or
+ *              E_STATE if no decode was started
+ ******************************************************************************/
+static jcu_errorcode_t soft_wait(const uint32_t timeout)
+{
+    jcu_errorcode_t error;
+
+    (void) timeout;
+
+    if (false == gs_soft.pending)
+    {
+        error = E_STATE;
+    }
+    else
+    {
+        gs_soft.pending = false;
+        error = soft_decode(&gs_soft);
+    }
+
+    return error;
+} /* End of function soft_wait() */
+
+/**************************************************************************//**
+ * Function Name : soft_close
+ * @brief       Releases the software decoder
+ * @retval      none
+ ******************************************************************************/
+static void soft_close(void)
+{
+    gs_soft.pending = false;
+} /* End of function soft_close() */
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+const st_jpeg_pipe_backend_t g_jpeg_pipe_soft =
+{
+    &soft_open,
+    &soft_start,
+    &soft_wait,
+    &soft_close
+};
@@ -0,0 +1,437 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_mjpeg_avi.c
+ * @file         r_mjpeg_avi.c
+ * @version      1.00
+ * @brief        AVI file writer of the motion JPEG recorder
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    <string.h>
+#include    "r_typedefs.h"
+#include    "r_fatfs_abstraction.h"
+#include    "rz_co_typedef.h"
+#include    "r_mjpeg_rec.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+/* Offsets in the headers, which are written again when the file is closed */
+#define AVI_HDRL_SIZE           (192u)  /* LIST hdrl, after its size                     */
+#define AVI_STRL_SIZE           (116u)  /* LIST strl, after its size                     */
+#define AVI_AVIH_SIZE           (56u)
+#define AVI_STRH_SIZE           (56u)
+#define AVI_STRF_SIZE           (40u)
+#define AVI_MOVI_LIST           (212u)  /* LIST movi                                     */
+#define AVI_MOVI_FOURCC         (220u)  /* Index offsets are from 'movi'                 */
+#define AVI_HEADER_SIZE         (224u)  /* First frame chunk                             */
+
+#define AVI_CHUNK_HEADER        (8u)    /* Fourcc and size                               */
+#define AVI_INDEX_ENTRY         (16u)
+#define AVIF_HASINDEX           (0x00000010uL)
+#define AVIIF_KEYFRAME          (0x00000010uL)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : put_u32
+ * @brief       Stores a little endian word
+ * @param[out]  p_dst           : Destination
+ * @param[in]   value           : Word
+ * @retval      Byte after the word
+ ******************************************************************************/
+static uint8_t *put_u32(uint8_t *p_dst, const uint32_t value)
+{
+    p_dst[0] = (uint8_t) value;
+    p_dst[1] = (uint8_t) (value >> 8);
+    p_dst[2] = (uint8_t) (value >> 16);
+    p_dst[3] = (uint8_t) (value >> 24);
+
+    return p_dst + 4;
+} /* End of function put_u32() */
+
+/**************************************************************************//**
+ * Function Name : put_u16
+ * @brief       Stores a little endian half word
+ * @param[out]  p_dst           : Destination
+ * @param[in]   value           : Half word
+ * @retval      Byte after the half word
+ ******************************************************************************/
+static uint8_t *put_u16(uint8_t *p_dst, const uint32_t value)
+{
+    p_dst[0] = (uint8_t) value;
+    p_dst[1] = (uint8_t) (value >> 8);
+
+    return p_dst + 2;
+} /* End of function put_u16() */
+
+/**************************************************************************//**
+ * Function Name : put_fourcc
+ * @brief       Stores a four character code
+ * @param[out]  p_dst           : Destination
+ * @param[in]   p_fourcc        : Four characters
+ * @retval      Byte after the code
+ ******************************************************************************/
+static uint8_t *put_fourcc(uint8_t *p_dst, const char * const p_fourcc)
+{
+    (void) memcpy(p_dst, p_fourcc, 4u);
+
+    return p_dst + 4;
+} /* End of function put_fourcc() */
+
+/**************************************************************************//**
+ * Function Name : put_header
+ * @brief       Builds the headers from the start of the file to the first
+ *              frame, for the frames written so far
+ * @param[in]   p_avi           : AVI writer
+ * @param[out]  p_dst           : AVI_HEADER_SIZE bytes
+ * @retval      none
+ ******************************************************************************/
+static void put_header(const st_mjpeg_avi_t * const p_avi, uint8_t *p_dst)
+{
+    uint32_t idx1_size;
+
+    idx1_size = (0u == p_avi->frames) ? 0u : (AVI_CHUNK_HEADER + (p_avi->frames * AVI_INDEX_ENTRY));
+
+    p_dst = put_fourcc(p_dst, "RIFF");
+    p_dst = put_u32(p_dst, (AVI_HEADER_SIZE - AVI_CHUNK_HEADER) + p_avi->movi_size + idx1_size);
+    p_dst = put_fourcc(p_dst, "AVI ");
+
+    p_dst = put_fourcc(p_dst, "LIST");
+    p_dst = put_u32(p_dst, AVI_HDRL_SIZE);
+    p_dst = put_fourcc(p_dst, "hdrl");
+
+    /* MainAVIHeader */
+    p_dst = put_fourcc(p_dst, "avih");
+    p_dst = put_u32(p_dst, AVI_AVIH_SIZE);
+    p_dst = put_u32(p_dst, 1000000u / p_avi->fps);                  /* MicroSecPerFrame    */
+    p_dst = put_u32(p_dst, (p_avi->chunk_max + AVI_CHUNK_HEADER) * p_avi->fps); /* MaxBytesPerSec */
+    p_dst = put_u32(p_dst, 0u);                                     /* PaddingGranularity  */
+    p_dst = put_u32(p_dst, (0u == p_avi->frames) ? 0u : AVIF_HASINDEX); /* Flags           */
+    p_dst = put_u32(p_dst, p_avi->frames);                          /* TotalFrames         */
+    p_dst = put_u32(p_dst, 0u);                                     /* InitialFrames       */
+    p_dst = put_u32(p_dst, 1u);                                     /* Streams             */
+    p_dst = put_u32(p_dst, p_avi->chunk_max + AVI_CHUNK_HEADER);    /* SuggestedBufferSize */
+    p_dst = put_u32(p_dst, p_avi->width);
+    p_dst = put_u32(p_dst, p_avi->height);
+    (void) memset(p_dst, 0, 16u);                                   /* Reserved            */
+    p_dst += 16;
+
+    p_dst = put_fourcc(p_dst, "LIST");
+    p_dst = put_u32(p_dst, AVI_STRL_SIZE);
+    p_dst = put_fourcc(p_dst, "strl");
+
+    /* AVIStreamHeader */
+    p_dst = put_fourcc(p_dst, "strh");
+    p_dst = put_u32(p_dst, AVI_STRH_SIZE);
+    p_dst = put_fourcc(p_dst, "vids");
+    p_dst = put_fourcc(p_dst, "MJPG");
+    p_dst = put_u32(p_dst, 0u);                                     /* Flags               */
+    p_dst = put_u32(p_dst, 0u);                                     /* Priority, Language  */
+    p_dst = put_u32(p_dst, 0u);                                     /* InitialFrames       */
+    p_dst = put_u32(p_dst, 1u);                                     /* Scale               */
+    p_dst = put_u32(p_dst, p_avi->fps);                             /* Rate                */
+    p_dst = put_u32(p_dst, 0u);                                     /* Start               */
+    p_dst = put_u32(p_dst, p_avi->frames);                          /* Length              */
+    p_dst = put_u32(p_dst, p_avi->chunk_max + AVI_CHUNK_HEADER);    /* SuggestedBufferSize */
+    p_dst = put_u32(p_dst, 0xFFFFFFFFu);                            /* Quality, default    */
+    p_dst = put_u32(p_dst, 0u);                                     /* SampleSize          */
+    p_dst = put_u16(p_dst, 0u);                                     /* rcFrame             */
+    p_dst = put_u16(p_dst, 0u);
+    p_dst = put_u16(p_dst, p_avi->width);
+    p_dst = put_u16(p_dst, p_avi->height);
+
+    /* BITMAPINFOHEADER */
+    p_dst = put_fourcc(p_dst, "strf");
+    p_dst = put_u32(p_dst, AVI_STRF_SIZE);
+    p_dst = put_u32(p_dst, AVI_STRF_SIZE);                          /* biSize              */
+    p_dst = put_u32(p_dst, p_avi->width);
+    p_dst = put_u32(p_dst, p_avi->height);
+    p_dst = put_u16(p_dst, 1u);                                     /* biPlanes            */
+    p_dst = put_u16(p_dst, 24u);                                    /* biBitCount          */
+    p_dst = put_fourcc(p_dst, "MJPG");
+    p_dst = put_u32(p_dst, (uint32_t) p_avi->width * p_avi->height * 3u); /* biSizeImage   */
+    (void) memset(p_dst, 0, 16u);                                   /* Resolution, colours */
+    p_dst += 16;
+
+    p_dst = put_fourcc(p_dst, "LIST");
+    p_dst = put_u32(p_dst, (AVI_HEADER_SIZE - AVI_MOVI_FOURCC) + p_avi->movi_size);
+    (void) put_fourcc(p_dst, "movi");
+} /* End of function put_header() */
+
+/**************************************************************************//**
+ * Function Name : flush
+ * @brief       Writes the write buffer to the file
+ * @param[in]   p_avi           : AVI writer
+ * @retval      JCU_ERROR_OK or E_ERRNO
+ ******************************************************************************/
+static jcu_errorcode_t flush(st_mjpeg_avi_t * const p_avi)
+{
+    if ((JCU_ERROR_OK == p_avi->error) && (0u != p_avi->fill))
+    {
+        if (R_FAT_WriteFile(p_avi->p_file, p_avi->p_buff, p_avi->fill) < 0)
+        {
+            p_avi->error = E_ERRNO;
+        }
+        else
+        {
+            p_avi->file_pos += p_avi->fill;
+            p_avi->fill = 0u;
+        }
+    }
+
+    return p_avi->error;
+} /* End of function flush() */
+
+/**************************************************************************//**
+ * Function Name : append
+ * @brief       Adds data to the write buffer, writing each buffer to the
+ *              file as it fills, so that the file is written in whole
+ *              sectors
+ * @param[in]   p_avi           : AVI writer
+ * @param[in]   p_data          : Data
+ * @param[in]   size            : Bytes of data
+ * @retval      JCU_ERROR_OK or E_ERRNO
+ ******************************************************************************/
+static jcu_errorcode_t append(st_mjpeg_avi_t * const p_avi, const uint8_t *p_data, uint32_t size)
+{
+    uint32_t count;
+
+    while ((JCU_ERROR_OK == p_avi->error) && (0u != size))
+    {
+        count = p_avi->buff_size - p_avi->fill;
+        count = (count > size) ? size : count;
+        (void) memcpy(&p_avi->p_buff[p_avi->fill], p_data, count);
+        p_avi->fill += count;
+        p_data += count;
+        size -= count;
+
+        if (p_avi->fill == p_avi->buff_size)
+        {
+            (void) flush(p_avi);
+        }
+    }
+
+    return p_avi->error;
+} /* End of function append() */
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_AviOpen
+ * @brief       Starts an AVI file with the headers of an empty recording
+ * @param[out]  p_avi           : AVI writer
+ * @param[in]   p_cnf           : Recorder config
+ * @retval      JCU_ERROR_OK or JCU_ERROR_PARAM
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_AviOpen(st_mjpeg_avi_t * const p_avi, const st_mjpeg_rec_config_t * const p_cnf)
+{
+    jcu_errorcode_t error;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_avi) || (NULL == p_cnf) || (NULL == p_cnf->p_file) || (NULL == p_cnf->p_write)
+            || (p_cnf->write_size < AVI_HEADER_SIZE) || (0u == p_cnf->fps))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (0u != R_FAT_FileSize(p_cnf->p_file))
+    {
+        /* Clusters can only be allocated in one block to an empty file */
+        error = JCU_ERROR_PARAM;
+    }
+    else
+    {
+        p_avi->p_file = p_cnf->p_file;
+        p_avi->p_buff = p_cnf->p_write;
+        p_avi->buff_size = p_cnf->write_size;
+        p_avi->file_pos = 0u;
+        p_avi->p_index = p_cnf->p_index;
+        p_avi->max_frames = p_cnf->max_frames;
+        p_avi->frames = 0u;
+        p_avi->movi_size = 0u;
+        p_avi->chunk_max = 0u;
+        p_avi->width = p_cnf->width;
+        p_avi->height = p_cnf->height;
+        p_avi->fps = p_cnf->fps;
+        p_avi->error = JCU_ERROR_OK;
+
+        /* Without the block the file is extended cluster by cluster, which
+           is slower but still works */
+        p_avi->expanded = false;
+        if ((0u != p_cnf->prealloc) && (FR_OK == R_FAT_ExpandFile(p_avi->p_file, p_cnf->prealloc)))
+        {
+            p_avi->expanded = true;
+        }
+
+        /* Written again when the file is closed */
+        put_header(p_avi, p_avi->p_buff);
+        p_avi->fill = AVI_HEADER_SIZE;
+    }
+
+    return error;
+} /* End of function R_MJPEG_AviOpen() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_AviWrite
+ * @brief       Appends a JPEG as the next frame
+ * @param[in]   p_avi           : AVI writer
+ * @param[in]   p_jpeg          : JPEG
+ * @param[in]   size            : Bytes of JPEG
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM, E_LIMITATION or E_ERRNO
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_AviWrite(st_mjpeg_avi_t * const p_avi, const uint8_t * const p_jpeg, const uint32_t size)
+{
+    jcu_errorcode_t error;
+    uint8_t chunk[AVI_CHUNK_HEADER];
+    uint32_t padded;
+    uint32_t total;
+
+    if ((NULL == p_avi) || (NULL == p_jpeg) || (0u == size) || (size > (MJPEG_REC_AVI_MAX / 2u)))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (JCU_ERROR_OK != p_avi->error)
+    {
+        error = p_avi->error;
+    }
+    else
+    {
+        /* Chunks start on an even offset */
+        padded = (size + 1u) & ~1u;
+
+        /* The file as it would be closed after this frame */
+        total = AVI_HEADER_SIZE + p_avi->movi_size + AVI_CHUNK_HEADER + padded
+                + AVI_CHUNK_HEADER + ((p_avi->frames + 1u) * AVI_INDEX_ENTRY);
+
+        if ((p_avi->frames >= p_avi->max_frames) || (total > MJPEG_REC_AVI_MAX))
+        {
+            error = E_LIMITATION;
+        }
+        else
+        {
+            (void) put_fourcc(chunk, "00dc");
+            (void) put_u32(&chunk[4], size);
+            error = append(p_avi, chunk, AVI_CHUNK_HEADER);
+            if (JCU_ERROR_OK == error)
+            {
+                error = append(p_avi, p_jpeg, size);
+            }
+            if ((JCU_ERROR_OK == error) && (padded != size))
+            {
+                chunk[0] = 0u;
+                error = append(p_avi, chunk, 1u);
+            }
+
+            if (JCU_ERROR_OK == error)
+            {
+                p_avi->p_index[p_avi->frames * 2u] = (AVI_HEADER_SIZE - AVI_MOVI_FOURCC) + p_avi->movi_size;
+                p_avi->p_index[(p_avi->frames * 2u) + 1u] = size;
+                p_avi->frames++;
+                p_avi->movi_size += AVI_CHUNK_HEADER + padded;
+                if (size > p_avi->chunk_max)
+                {
+                    p_avi->chunk_max = size;
+                }
+            }
+        }
+    }
+
+    return error;
+} /* End of function R_MJPEG_AviWrite() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_AviClose
+ * @brief       Writes the index and the final headers, and returns the
+ *              clusters that were allocated but not used
+ * @param[in]   p_avi           : AVI writer
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM or E_ERRNO
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_AviClose(st_mjpeg_avi_t * const p_avi)
+{
+    jcu_errorcode_t error;
+    uint8_t entry[AVI_INDEX_ENTRY];
+    uint32_t i;
+    long position;
+
+    error = (NULL == p_avi) ? JCU_ERROR_PARAM : p_avi->error;
+
+    if ((JCU_ERROR_OK == error) && (0u != p_avi->frames))
+    {
+        (void) put_fourcc(entry, "idx1");
+        (void) put_u32(&entry[4], p_avi->frames * AVI_INDEX_ENTRY);
+        error = append(p_avi, entry, AVI_CHUNK_HEADER);
+
+        (void) put_fourcc(entry, "00dc");
+        (void) put_u32(&entry[4], AVIIF_KEYFRAME);
+        for (i = 0u; (JCU_ERROR_OK == error) && (i < p_avi->frames); i++)
+        {
+            (void) put_u32(&entry[8], p_avi->p_index[i * 2u]);
+            (void) put_u32(&entry[12], p_avi->p_index[(i * 2u) + 1u]);
+            error = append(p_avi, entry, AVI_INDEX_ENTRY);
+        }
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        error = flush(p_avi);
+    }
+
+    if ((JCU_ERROR_OK == error) && (true == p_avi->expanded))
+    {
+        /* The file pointer is at the end of the data */
+        if (FR_OK != R_FAT_TruncateFile(p_avi->p_file))
+        {
+            error = E_ERRNO;
+        }
+    }
+
+    /* The origin is always the start of the file */
+    if ((JCU_ERROR_OK == error) && (FR_OK != R_FAT_SeekFile(p_avi->p_file, 0u, 0, &position)))
+    {
+        error = E_ERRNO;
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        put_header(p_avi, p_avi->p_buff);
+        if (R_FAT_WriteFile(p_avi->p_file, p_avi->p_buff, AVI_HEADER_SIZE) < 0)
+        {
+            error = E_ERRNO;
+        }
+    }
+
+    if (NULL != p_avi)
+    {
+        p_avi->error = error;
+    }
+
+    return error;
+} /* End of function R_MJPEG_AviClose() */
@@ -0,0 +1,304 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_mjpeg_ceu.c
+ * @file         r_mjpeg_ceu.c
+ * @version      1.00
+ * @brief        CEU capture into the motion JPEG recorder
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_rvapi_ceu.h"
+#include    "rz_co_typedef.h"
+#include    "r_mjpeg_rec.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define CEU_REC_IDLE_MS     (100u)  /* Longest wait for a free buffer before checking for a stop */
+#define CEU_REC_END_MS      (1000u) /* Longest capture of a frame                               */
+#define CEU_REC_RETRY_MS    (10u)   /* Wait before starting a capture again                     */
+#define CEU_REC_ALL_FREE    ((1uL << MJPEG_CEU_FRAMES) - 1u)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+/* The CEU has one capture end function, so there is one capture at a time */
+static st_mjpeg_ceu_t * volatile gs_ceu = NULL;
+
+/**************************************************************************//**
+ * Function Name : capture_end
+ * @brief       Capture end function, called from the CEU interrupt
+ * @retval      none
+ ******************************************************************************/
+static void capture_end(void)
+{
+    st_mjpeg_ceu_t * const p_ceu = gs_ceu;
+
+    if (NULL != p_ceu)
+    {
+        R_OS_ReleaseSemaphore(&p_ceu->end_semid);
+    }
+} /* End of function capture_end() */
+
+/**************************************************************************//**
+ * Function Name : give_back
+ * @brief       Returns a frame buffer to the free set
+ * @param[in]   p_ceu           : Capture instance
+ * @param[in]   index           : Frame buffer
+ * @retval      none
+ ******************************************************************************/
+static void give_back(st_mjpeg_ceu_t * const p_ceu, const uint32_t index)
+{
+    int_t lock;
+
+    lock = R_OS_SysLock(NULL);
+    p_ceu->free |= (1uL << index);
+    R_OS_SysUnlock(NULL, lock);
+
+    R_OS_ReleaseSemaphore(&p_ceu->free_semid);
+} /* End of function give_back() */
+
+/**************************************************************************//**
+ * Function Name : frame_done
+ * @brief       Called by the recorder when a frame has been encoded
+ * @param[in]   p_frame         : Frame
+ * @retval      none
+ ******************************************************************************/
+static void frame_done(st_mjpeg_rec_frame_t * const p_frame)
+{
+    st_mjpeg_ceu_t * const p_ceu = (st_mjpeg_ceu_t *) p_frame->p_arg;
+
+    give_back(p_ceu, (uint32_t) (p_frame - p_ceu->frame));
+} /* End of function frame_done() */
+
+/**************************************************************************//**
+ * Function Name : take_free
+ * @brief       Takes a buffer from the free set
+ * @param[in]   p_ceu           : Capture instance
+ * @retval      Frame buffer, or MJPEG_CEU_FRAMES if none was free in time
+ ******************************************************************************/
+static uint32_t take_free(st_mjpeg_ceu_t * const p_ceu)
+{
+    uint32_t index;
+    int_t lock;
+
+    index = MJPEG_CEU_FRAMES;
+
+    if (true == R_OS_WaitForSemaphore(&p_ceu->free_semid, CEU_REC_IDLE_MS))
+    {
+        lock = R_OS_SysLock(NULL);
+        for (index = 0u; index < MJPEG_CEU_FRAMES; index++)
+        {
+            if (0u != (p_ceu->free & (1uL << index)))
+            {
+                p_ceu->free &= ~(1uL << index);
+                break;
+            }
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return index;
+} /* End of function take_free() */
+
+/**************************************************************************//**
+ * Function Name : ceu_task
+ * @brief       Capture task. Each free buffer is captured into and queued
+ *              to the recorder, so capture continues while earlier frames
+ *              are encoded.
+ * @param[in]   parameters      : Capture instance
+ * @retval      none
+ ******************************************************************************/
+static void ceu_task(void *parameters)
+{
+    st_mjpeg_ceu_t * const p_ceu = (st_mjpeg_ceu_t *) parameters;
+    uint32_t index;
+
+    while (false == p_ceu->stop)
+    {
+        index = take_free(p_ceu);
+        if (index < MJPEG_CEU_FRAMES)
+        {
+            /* A capture that timed out may have ended since */
+            while (true == R_OS_WaitForSemaphore(&p_ceu->end_semid, 0u))
+            {
+                /* Do Nothing */
+            }
+
+            if (CEU_OK != R_RVAPI_CaptureStartCEU(p_ceu->frame[index].p_data, NULL, p_ceu->chdw))
+            {
+                /* Still capturing after a time out */
+                give_back(p_ceu, index);
+                R_OS_TaskSleep(CEU_REC_RETRY_MS);
+            }
+            else if (false == R_OS_WaitForSemaphore(&p_ceu->end_semid, CEU_REC_END_MS))
+            {
+                p_ceu->timeouts++;
+                give_back(p_ceu, index);
+            }
+            else
+            {
+                p_ceu->captured++;
+                if (JCU_ERROR_OK != R_MJPEG_RecSubmit(p_ceu->p_rec, &p_ceu->frame[index]))
+                {
+                    /* The recorder is behind, the frame is lost */
+                    p_ceu->dropped++;
+                    give_back(p_ceu, index);
+                }
+            }
+        }
+    }
+
+    R_OS_ReleaseSemaphore(&p_ceu->stop_semid);
+    R_OS_DeleteTask(NULL);
+} /* End of function ceu_task() */
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_CeuStart
+ * @brief       Starts capturing from the CEU into a recorder
+ * @param[out]  p_ceu           : Capture instance
+ * @param[in]   p_rec           : Recorder
+ * @param[in]   p_buff          : Frame buffers
+ * @param[in]   chdw            : Bytes per line written by the CEU
+ * @param[in]   priority        : Capture task priority
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM or E_STATE
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_CeuStart(st_mjpeg_ceu_t * const p_ceu, st_mjpeg_rec_t * const p_rec,
+        uint8_t * const p_buff[MJPEG_CEU_FRAMES], const uint32_t chdw, const int_t priority)
+{
+    jcu_errorcode_t error;
+    uint32_t i;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_ceu) || (NULL == p_rec) || (NULL == p_buff) || (0u == chdw))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (NULL != gs_ceu)
+    {
+        error = E_STATE;
+    }
+    else
+    {
+        for (i = 0u; i < MJPEG_CEU_FRAMES; i++)
+        {
+            if ((NULL == p_buff[i]) || (0u != ((uint32_t) p_buff[i] & (MJPEG_REC_ALIGNMENT - 1u))))
+            {
+                error = JCU_ERROR_PARAM;
+            }
+        }
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        p_ceu->p_rec = p_rec;
+        for (i = 0u; i < MJPEG_CEU_FRAMES; i++)
+        {
+            p_ceu->frame[i].p_data = p_buff[i];
+            p_ceu->frame[i].p_done = frame_done;
+            p_ceu->frame[i].p_arg = p_ceu;
+        }
+        p_ceu->chdw = chdw;
+        p_ceu->free = CEU_REC_ALL_FREE;
+        p_ceu->stop = false;
+        p_ceu->captured = 0u;
+        p_ceu->dropped = 0u;
+        p_ceu->timeouts = 0u;
+
+        if (false == R_OS_CreateSemaphore(&p_ceu->free_semid, MJPEG_CEU_FRAMES))
+        {
+            error = E_STATE;
+        }
+        else if (false == R_OS_CreateSemaphore(&p_ceu->end_semid, 0u))
+        {
+            R_OS_DeleteSemaphore(&p_ceu->free_semid);
+            error = E_STATE;
+        }
+        else if (false == R_OS_CreateSemaphore(&p_ceu->stop_semid, 0u))
+        {
+            R_OS_DeleteSemaphore(&p_ceu->end_semid);
+            R_OS_DeleteSemaphore(&p_ceu->free_semid);
+            error = E_STATE;
+        }
+        else
+        {
+            gs_ceu = p_ceu;
+            R_RVAPI_SetCaptureEndCEU(capture_end);
+
+            p_ceu->p_task = R_OS_CreateTask("MJPEG capture", ceu_task, p_ceu,
+                    R_OS_ABSTRACTION_PRV_DEFAULT_STACK_SIZE, priority);
+            if (NULL == p_ceu->p_task)
+            {
+                R_RVAPI_SetCaptureEndCEU(NULL);
+                gs_ceu = NULL;
+                R_OS_DeleteSemaphore(&p_ceu->stop_semid);
+                R_OS_DeleteSemaphore(&p_ceu->end_semid);
+                R_OS_DeleteSemaphore(&p_ceu->free_semid);
+                error = E_STATE;
+            }
+        }
+    }
+
+    return error;
+} /* End of function R_MJPEG_CeuStart() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_CeuStop
+ * @brief       Stops capturing, then waits for the recorder to finish with
+ *              the frames already captured
+ * @param[in]   p_ceu           : Capture instance
+ * @retval      none
+ ******************************************************************************/
+void R_MJPEG_CeuStop(st_mjpeg_ceu_t * const p_ceu)
+{
+    if ((NULL != p_ceu) && (p_ceu == gs_ceu))
+    {
+        p_ceu->stop = true;
+        while (false == R_OS_WaitForSemaphore(&p_ceu->stop_semid, CEU_REC_IDLE_MS))
+        {
+            /* Do Nothing */
+        }
+
+        /* The recorder gives each frame back, encoded or not */
+        while (CEU_REC_ALL_FREE != p_ceu->free)
+        {
+            R_OS_TaskSleep(CEU_REC_RETRY_MS);
+        }
+
+        R_RVAPI_SetCaptureEndCEU(NULL);
+        gs_ceu = NULL;
+        R_OS_DeleteSemaphore(&p_ceu->stop_semid);
+        R_OS_DeleteSemaphore(&p_ceu->end_semid);
+        R_OS_DeleteSemaphore(&p_ceu->free_semid);
+    }
+} /* End of function R_MJPEG_CeuStop() */
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_mjpeg_jcu.c
+ * @file         r_mjpeg_jcu.c
+ * @version      1.00
+ * @brief        JCU back end of the motion JPEG recorder
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_cache_l1_rz_api.h"
+#include    "r_jcu.h"
+#include    "r_mjpeg_rec.h"
+#include    "r_video_jcu.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+/* The JCU reads and writes 8 byte units with the first byte in the top bits */
+#define JCU_REC_SWAP            (JCU_SWAP_LONG_WORD_AND_WORD_AND_BYTE)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static uint32_t gs_jcu_jpeg;            /* JPEG buffer written by the current encode */
+static uint32_t gs_jcu_jpeg_size;
+
+static jcu_errorcode_t jcu_open(void);
+static jcu_errorcode_t jcu_start(const st_mjpeg_rec_encode_t * const p_encode);
+static jcu_errorcode_t jcu_wait(const uint32_t timeout, uint32_t * const p_size);
+static void jcu_close(void);
+
+/**************************************************************************//**
+ * Function Name : jcu_open
+ * @brief       Claims the JCU, which the JPEG decode pipe may have
+ * @retval      Error code of the JCU driver, or E_STATE
+ ******************************************************************************/
+static jcu_errorcode_t jcu_open(void)
+{
+    return R_VIDEO_JcuOpen(VIDEO_JCU_OWNER_REC);
+} /* End of function jcu_open() */
+
+/**************************************************************************//**
+ * Function Name : jcu_start
+ * @brief       Starts encoding a frame. The tables are loaded for each
+ *              frame, as the quality can change from frame to frame.
+ * @param[in]   p_encode        : Encode parameters
+ * @retval      Error code of the JCU driver
+ ******************************************************************************/
+static jcu_errorcode_t jcu_start(const st_mjpeg_rec_encode_t * const p_encode)
+{
+    jcu_errorcode_t error;
+    jcu_encode_param_t encode;
+    jcu_buffer_param_t buffer;
+
+    /* Table 0 for Y, table 1 for Cb and Cr */
+    encode.encodeFormat = JCU_JPEG_YCbCr422;
+    encode.QuantizationTable[JCU_ELEMENT_Y] = JCU_TABLE_NO_0;
+    encode.QuantizationTable[JCU_ELEMENT_Cb] = JCU_TABLE_NO_1;
+    encode.QuantizationTable[JCU_ELEMENT_Cr] = JCU_TABLE_NO_1;
+    encode.HuffmanTable[JCU_ELEMENT_Y] = JCU_TABLE_NO_0;
+    encode.HuffmanTable[JCU_ELEMENT_Cb] = JCU_TABLE_NO_1;
+    encode.HuffmanTable[JCU_ELEMENT_Cr] = JCU_TABLE_NO_1;
+    encode.DRI_value = p_encode->restart;
+    encode.width = p_encode->width;
+    encode.height = p_encode->height;
+    encode.inputCbCrOffset = p_encode->cbcr_offset;
+
+    buffer.source.swapSetting = JCU_REC_SWAP;
+    buffer.source.address = (uint32_t *) p_encode->p_frame;
+    buffer.destination.swapSetting = JCU_REC_SWAP;
+    buffer.destination.address = (uint32_t *) p_encode->p_jpeg;
+    buffer.lineOffset = p_encode->stride;
+
+    /* The JCU works on memory, the JPEG must not be overwritten by dirty lines later */
+    gs_jcu_jpeg = (uint32_t) p_encode->p_jpeg;
+    gs_jcu_jpeg_size = p_encode->jpeg_size;
+    R_CACHE_L1_CleanLine((uint32_t) p_encode->p_frame, (uint32_t) p_encode->stride * 2u * p_encode->height);
+    R_CACHE_L1_CleanInvalidLine(gs_jcu_jpeg, gs_jcu_jpeg_size);
+
+    error = R_JCU_SelectCodec(JCU_ENCODE);
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetQuantizationTable(JCU_TABLE_NO_0, p_encode->p_qt[0]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetQuantizationTable(JCU_TABLE_NO_1, p_encode->p_qt[1]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetHuffmanTable(JCU_TABLE_NO_0, JCU_HUFFMAN_DC, g_mjpeg_rec_dht_dc[0]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetHuffmanTable(JCU_TABLE_NO_0, JCU_HUFFMAN_AC, g_mjpeg_rec_dht_ac[0]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetHuffmanTable(JCU_TABLE_NO_1, JCU_HUFFMAN_DC, g_mjpeg_rec_dht_dc[1]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetHuffmanTable(JCU_TABLE_NO_1, JCU_HUFFMAN_AC, g_mjpeg_rec_dht_ac[1]);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_SetEncodeParam(&encode, &buffer);
+    }
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_VIDEO_JcuStart();
+    }
+
+    return error;
+} /* End of function jcu_start() */
+
+/**************************************************************************//**
+ * Function Name : jcu_wait
+ * @brief       Waits for the encode started by jcu_start. If it does not
+ *              finish in time the JCU is reset.
+ * @param[in]   timeout         : Time to wait in ms
+ * @param[out]  p_size          : Bytes of JPEG
+ * @retval      Error code of the encode, E_FEW_ARRAY or E_TIME_OUT
+ ******************************************************************************/
+static jcu_errorcode_t jcu_wait(const uint32_t timeout, uint32_t * const p_size)
+{
+    jcu_errorcode_t error;
+    size_t size;
+
+    size = 0u;
+
+    error = R_VIDEO_JcuWait(timeout);
+
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_GetEncodedSize(&size);
+    }
+
+    /* The JCU has no limit on the size it writes, anything larger than the
+       buffer has overwritten memory after it */
+    if ((JCU_ERROR_OK == error) && (size > gs_jcu_jpeg_size))
+    {
+        error = E_FEW_ARRAY;
+    }
+
+    /* Lines of the JPEG may have been fetched while the JCU wrote it */
+    R_CACHE_L1_InvalidLine(gs_jcu_jpeg, gs_jcu_jpeg_size);
+
+    *p_size = (JCU_ERROR_OK == error) ? (uint32_t) size : 0u;
+
+    return error;
+} /* End of function jcu_wait() */
+
+/**************************************************************************//**
+ * Function Name : jcu_close
+ * @brief       Stops the JCU
+ * @retval      none
+ ******************************************************************************/
+static void jcu_close(void)
+{
+    R_VIDEO_JcuClose(VIDEO_JCU_OWNER_REC);
+} /* End of function jcu_close() */
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+const st_mjpeg_rec_backend_t g_mjpeg_rec_jcu =
+{
+    &jcu_open,
+    &jcu_start,
+    &jcu_wait,
+    &jcu_close
+};
@@ -0,0 +1,744 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_mjpeg_rec.c
+ * @file         r_mjpeg_rec.c
+ * @version      1.00
+ * @brief        Motion JPEG recorder service
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "FreeRTOS.h"
+#include    "task.h"
+#include    "r_mjpeg_rec.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define REC_IDLE_MS         (100u)  /* Longest wait for a frame before checking for a stop */
+
+/* Rate control, on the running average of the JPEG size in % of the budget */
+#define REC_RATE_HIGH       (110u)  /* Above this the quality is lowered          */
+#define REC_RATE_LOW        (90u)   /* Below this the quality is raised           */
+#define REC_STEP_DOWN_MAX   (10u)   /* Largest quality step down per frame        */
+#define REC_STEP_UP_MAX     (4u)    /* Largest quality step up per frame          */
+
+/******************************************************************************
+ Exported global variables and functions (to be accessed by other files)
+ ******************************************************************************/
+/* Code counts for lengths 1 - 16, then the symbols */
+const uint8_t g_mjpeg_rec_dht_dc[2][MJPEG_REC_DHT_DC_SIZE] =
+{
+    {
+        0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B
+    },
+    {
+        0x00, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B
+    }
+};
+
+const uint8_t g_mjpeg_rec_dht_ac[2][MJPEG_REC_DHT_AC_SIZE] =
+{
+    {
+        0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04, 0x04, 0x00, 0x00, 0x01, 0x7D,
+        0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+        0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+        0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+        0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+        0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+        0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+        0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+        0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+        0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+        0xF9, 0xFA
+    },
+    {
+        0x00, 0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00, 0x01, 0x02, 0x77,
+        0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+        0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+        0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+        0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+        0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+        0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+        0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+        0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+        0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+        0xF9, 0xFA
+    }
+};
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+/* Quantisation tables of T.81 Annex K, in zig-zag order */
+static const uint8_t gs_qt_base[2][64] =
+{
+    {
+        16, 11, 12, 14, 12, 10, 16, 14, 13, 14, 18, 17, 16, 19, 24, 40,
+        26, 24, 22, 22, 24, 49, 35, 37, 29, 40, 58, 51, 61, 60, 57, 51,
+        56, 55, 64, 72, 92, 78, 64, 68, 87, 69, 55, 56, 80, 109, 81, 87,
+        95, 98, 103, 104, 103, 62, 77, 113, 121, 112, 100, 120, 92, 101, 103, 99
+    },
+    {
+        17, 18, 18, 24, 21, 24, 47, 26, 26, 47, 99, 66, 56, 66, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99
+    }
+};
+
+static void rec_task(void *parameters);
+
+/**************************************************************************//**
+ * Function Name : take_frame
+ * @brief       Waits for the oldest queued frame
+ * @param[in]   p_rec           : Recorder instance
+ * @param[in]   timeout         : Time to wait in ms
+ * @retval      Frame, or NULL if none was queued in time
+ ******************************************************************************/
+static st_mjpeg_rec_frame_t *take_frame(st_mjpeg_rec_t * const p_rec, const uint32_t timeout)
+{
+    st_mjpeg_rec_frame_t *p_frame;
+    int_t lock;
+
+    p_frame = NULL;
+
+    if (true == R_OS_WaitForSemaphore(&p_rec->semid, timeout))
+    {
+        lock = R_OS_SysLock(NULL);
+        if (0u != p_rec->count)
+        {
+            p_frame = p_rec->queue[p_rec->head];
+            p_rec->head = (p_rec->head + 1u) % MJPEG_REC_QUEUE_DEPTH;
+            p_rec->count--;
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return p_frame;
+} /* End of function take_frame() */
+
+/**************************************************************************//**
+ * Function Name : finish_frame
+ * @brief       Records the result of an encode and hands the frame back
+ * @param[in]   p_rec           : Recorder instance
+ * @param[in]   p_frame         : Frame
+ * @param[in]   tick_start      : Start of the encode
+ * @retval      none
+ ******************************************************************************/
+static void finish_frame(st_mjpeg_rec_t * const p_rec, st_mjpeg_rec_frame_t * const p_frame,
+        const uint32_t tick_start)
+{
+    int_t lock;
+
+    p_frame->encode_ms = OS_SYSTICKS_TO_MS((uint32_t) xTaskGetTickCount() - tick_start);
+
+    lock = R_OS_SysLock(NULL);
+    if (JCU_ERROR_OK != p_frame->result)
+    {
+        p_rec->stats.errors++;
+    }
+    else if (p_frame->encode_ms > p_rec->stats.encode_max_ms)
+    {
+        p_rec->stats.encode_max_ms = p_frame->encode_ms;
+    }
+    else
+    {
+        /* Do Nothing */
+    }
+    R_OS_SysUnlock(NULL, lock);
+
+    p_frame->done = true;
+    if (NULL != p_frame->p_done)
+    {
+        p_frame->p_done(p_frame);
+    }
+} /* End of function finish_frame() */
+
+/**************************************************************************//**
+ * Function Name : write_jpeg
+ * @brief       Appends an encoded frame to the file
+ * @param[in]   p_rec           : Recorder instance
+ * @param[in]   p_jpeg          : JPEG
+ * @param[in]   size            : Bytes of JPEG
+ * @param[in]   overlapped      : true: the encoder is busy with the next frame
+ * @retval      none
+ ******************************************************************************/
+static void write_jpeg(st_mjpeg_rec_t * const p_rec, const uint8_t * const p_jpeg, const uint32_t size,
+        const bool_t overlapped)
+{
+    jcu_errorcode_t error;
+    uint32_t start;
+    uint32_t now;
+    uint32_t write_ms;
+    int_t lock;
+
+    start = (uint32_t) xTaskGetTickCount();
+    error = R_MJPEG_AviWrite(&p_rec->avi, p_jpeg, size);
+    now = (uint32_t) xTaskGetTickCount();
+    write_ms = OS_SYSTICKS_TO_MS(now - start);
+
+    lock = R_OS_SysLock(NULL);
+    if (true == overlapped)
+    {
+        p_rec->stats.overlapped++;
+    }
+    if (JCU_ERROR_OK != error)
+    {
+        p_rec->stats.errors++;
+    }
+    else
+    {
+        p_rec->stats.frames++;
+        p_rec->stats.bytes += size;
+        if (size < p_rec->stats.bytes_min)
+        {
+            p_rec->stats.bytes_min = size;
+        }
+        if (size > p_rec->stats.bytes_max)
+        {
+            p_rec->stats.bytes_max = size;
+        }
+        if (write_ms > p_rec->stats.write_max_ms)
+        {
+            p_rec->stats.write_max_ms = write_ms;
+        }
+        p_rec->stats.elapsed_ms = OS_SYSTICKS_TO_MS(now - p_rec->tick_first);
+    }
+    R_OS_SysUnlock(NULL, lock);
+} /* End of function write_jpeg() */
+
+/**************************************************************************//**
+ * Function Name : control_rate
+ * @brief       Chooses the quality of the next frame from the size of the
+ *              JPEGs so far
+ * @param[in]   p_rec           : Recorder instance
+ * @param[in]   size            : Bytes of the last JPEG
+ * @retval      none
+ ******************************************************************************/
+static void control_rate(st_mjpeg_rec_t * const p_rec, const uint32_t size)
+{
+    uint32_t ratio;
+    uint32_t step;
+    uint32_t quality;
+
+    if (0u != p_rec->budget)
+    {
+        /* Average over about 4 frames, so that one busy frame is not followed
+           by a run of poor ones */
+        if (0u == p_rec->average)
+        {
+            p_rec->average = size;
+        }
+        else if (size > p_rec->average)
+        {
+            p_rec->average += (size - p_rec->average) / 4u;
+        }
+        else
+        {
+            p_rec->average -= (p_rec->average - size) / 4u;
+        }
+
+        ratio = (p_rec->average * 100u) / p_rec->budget;
+        quality = p_rec->quality;
+
+        if (ratio > REC_RATE_HIGH)
+        {
+            step = (ratio - 100u) / 10u;
+            step = (step > REC_STEP_DOWN_MAX) ? REC_STEP_DOWN_MAX : ((0u == step) ? 1u : step);
+            quality = ((quality - p_rec->quality_min) > step) ? (quality - step) : p_rec->quality_min;
+        }
+        else if (ratio < REC_RATE_LOW)
+        {
+            step = ((100u - ratio) / 20u) + 1u;
+            step = (step > REC_STEP_UP_MAX) ? REC_STEP_UP_MAX : step;
+            quality = ((p_rec->quality_max - quality) > step) ? (quality + step) : p_rec->quality_max;
+        }
+        else
+        {
+            /* Do Nothing */
+        }
+
+        if (quality != p_rec->quality)
+        {
+            p_rec->quality = quality;
+            R_MJPEG_RecQualityTables(quality, p_rec->qt);
+
+            /* The sizes so far were for the other quality */
+            p_rec->average = 0u;
+        }
+    }
+} /* End of function control_rate() */
+
+/**************************************************************************//**
+ * Function Name : clear_stats
+ * @brief       Resets the statistics, called with interrupts locked out
+ * @param[in]   p_rec           : Recorder instance
+ * @retval      none
+ ******************************************************************************/
+static void clear_stats(st_mjpeg_rec_t * const p_rec)
+{
+    p_rec->stats.frames = 0u;
+    p_rec->stats.dropped = 0u;
+    p_rec->stats.errors = 0u;
+    p_rec->stats.overlapped = 0u;
+    p_rec->stats.bytes = 0u;
+    p_rec->stats.bytes_min = 0xFFFFFFFFu;
+    p_rec->stats.bytes_max = 0u;
+    p_rec->stats.encode_max_ms = 0u;
+    p_rec->stats.write_max_ms = 0u;
+    p_rec->stats.elapsed_ms = 0u;
+    p_rec->tick_first = 0u;
+    p_rec->sequence = 0u;
+} /* End of function clear_stats() */
+
+/**************************************************************************//**
+ * Function Name : rec_task
+ * @brief       Service task. A frame is encoded into one JPEG buffer while
+ *              the JPEG of the frame before it is written to the file from
+ *              the other.
+ * @param[in]   parameters      : Recorder instance
+ * @retval      none
+ ******************************************************************************/
+static void rec_task(void *parameters)
+{
+    st_mjpeg_rec_t * const p_rec = (st_mjpeg_rec_t *) parameters;
+    st_mjpeg_rec_frame_t *p_frame;
+    uint32_t fill;
+    uint32_t pending;
+    jcu_errorcode_t error;
+    uint32_t tick_start;
+    uint32_t size;
+
+    fill = 0u;
+    pending = 0u;
+
+    while (false == p_rec->stop)
+    {
+        p_frame = take_frame(p_rec, REC_IDLE_MS);
+        if (NULL != p_frame)
+        {
+            tick_start = (uint32_t) xTaskGetTickCount();
+            size = 0u;
+
+            if (JCU_ERROR_OK != p_rec->avi.error)
+            {
+                /* The file can not be written to */
+                p_frame->result = p_rec->avi.error;
+            }
+            else if ((p_rec->avi.frames + ((0u != pending) ? 1u : 0u)) >= p_rec->avi.max_frames)
+            {
+                p_frame->result = E_LIMITATION;
+            }
+            else
+            {
+                p_frame->quality = p_rec->quality;
+                p_rec->encode.p_frame = p_frame->p_data;
+                p_rec->encode.p_qt[0] = p_rec->qt[0];
+                p_rec->encode.p_qt[1] = p_rec->qt[1];
+                p_rec->encode.p_jpeg = p_rec->p_jpeg[fill];
+                p_frame->result = p_rec->p_backend->p_start(&p_rec->encode);
+
+                if (JCU_ERROR_OK == p_frame->result)
+                {
+                    /* The encoder writes p_jpeg[fill] until p_wait returns */
+                    if (0u != pending)
+                    {
+                        write_jpeg(p_rec, p_rec->p_jpeg[fill ^ 1u], pending, true);
+                        pending = 0u;
+                    }
+
+                    p_frame->result = p_rec->p_backend->p_wait(p_rec->timeout, &size);
+                }
+            }
+
+            /* The frame may be submitted again once it is finished */
+            error = p_frame->result;
+            p_frame->size = size;
+            finish_frame(p_rec, p_frame, tick_start);
+
+            /* A JPEG still pending was written while this frame was encoded */
+            if (JCU_ERROR_OK == error)
+            {
+                pending = size;
+                fill ^= 1u;
+                control_rate(p_rec, size);
+            }
+        }
+        else if (0u != pending)
+        {
+            /* Nothing to overlap with */
+            write_jpeg(p_rec, p_rec->p_jpeg[fill ^ 1u], pending, false);
+            pending = 0u;
+        }
+        else
+        {
+            /* Do Nothing */
+        }
+    }
+
+    if (0u != pending)
+    {
+        write_jpeg(p_rec, p_rec->p_jpeg[fill ^ 1u], pending, false);
+    }
+
+    /* Frames that were not started fail, still in order */
+    p_frame = take_frame(p_rec, 0u);
+    while (NULL != p_frame)
+    {
+        p_frame->result = E_STATE;
+        p_frame->size = 0u;
+        finish_frame(p_rec, p_frame, (uint32_t) xTaskGetTickCount());
+        p_frame = take_frame(p_rec, 0u);
+    }
+
+    R_OS_ReleaseSemaphore(&p_rec->stop_semid);
+    R_OS_DeleteTask(NULL);
+} /* End of function rec_task() */
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_RecQualityTables
+ * @brief       Scales the tables of T.81 Annex K to a quality, as the IJG
+ *              library does
+ * @param[in]   quality         : 1 - 100
+ * @param[out]  p_qt            : Y and CbCr tables, zig-zag order
+ * @retval      none
+ ******************************************************************************/
+void R_MJPEG_RecQualityTables(const uint32_t quality, uint8_t p_qt[][64])
+{
+    uint32_t scale;
+    uint32_t value;
+    uint32_t t;
+    uint32_t k;
+
+    if (quality < 1u)
+    {
+        scale = 5000u;
+    }
+    else if (quality < 50u)
+    {
+        scale = 5000u / quality;
+    }
+    else if (quality < 100u)
+    {
+        scale = 200u - (quality * 2u);
+    }
+    else
+    {
+        scale = 0u;
+    }
+
+    for (t = 0u; t < 2u; t++)
+    {
+        for (k = 0u; k < 64u; k++)
+        {
+            value = ((gs_qt_base[t][k] * scale) + 50u) / 100u;
+            if (0u == value)
+            {
+                value = 1u;
+            }
+            else if (value > 255u)
+            {
+                value = 255u;
+            }
+            else
+            {
+                /* Do Nothing */
+            }
+            p_qt[t][k] = (uint8_t) value;
+        }
+    }
+} /* End of function R_MJPEG_RecQualityTables() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_RecOpen
+ * @brief       Starts the AVI file, opens the back end and starts the
+ *              service task
+ * @param[out]  p_rec           : Recorder instance
+ * @param[in]   p_cnf           : Recorder config
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM, E_STATE or error of the back
+ *              end
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_RecOpen(st_mjpeg_rec_t * const p_rec, const st_mjpeg_rec_config_t * const p_cnf)
+{
+    jcu_errorcode_t error;
+    uint32_t i;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_rec) || (NULL == p_cnf) || (NULL == p_cnf->p_backend) || (NULL == p_cnf->p_file))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((0u == p_cnf->width) || (0u != (p_cnf->width % 16u)) || (0u == p_cnf->height)
+            || (0u != (p_cnf->height % 8u)) || (p_cnf->stride < (int16_t) p_cnf->width))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((p_cnf->cbcr_offset > JCU_CBCR_OFFSET_128) || (0u == p_cnf->fps) || (0u == p_cnf->timeout))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((p_cnf->quality_min < 1u) || (p_cnf->quality < p_cnf->quality_min)
+            || (p_cnf->quality_max < p_cnf->quality) || (p_cnf->quality_max > MJPEG_REC_QUALITY_MAX))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((NULL == p_cnf->p_write) || (0u == p_cnf->write_size) || (0u != (p_cnf->write_size % MJPEG_REC_SECTOR)))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if ((NULL == p_cnf->p_index) || (0u == p_cnf->max_frames)
+            || (p_cnf->jpeg_size < ((uint32_t) p_cnf->width * p_cnf->height * 2u)))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else
+    {
+        for (i = 0u; i < MJPEG_REC_BUFFERS; i++)
+        {
+            if ((NULL == p_cnf->p_jpeg[i]) || (0u != ((uint32_t) p_cnf->p_jpeg[i] & (MJPEG_REC_ALIGNMENT - 1u))))
+            {
+                error = JCU_ERROR_PARAM;
+            }
+        }
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        p_rec->p_backend = p_cnf->p_backend;
+        p_rec->encode.p_frame = NULL;
+        p_rec->encode.stride = p_cnf->stride;
+        p_rec->encode.width = p_cnf->width;
+        p_rec->encode.height = p_cnf->height;
+        p_rec->encode.cbcr_offset = p_cnf->cbcr_offset;
+        p_rec->encode.restart = p_cnf->restart;
+        p_rec->encode.jpeg_size = p_cnf->jpeg_size;
+        for (i = 0u; i < MJPEG_REC_BUFFERS; i++)
+        {
+            p_rec->p_jpeg[i] = p_cnf->p_jpeg[i];
+        }
+        p_rec->timeout = p_cnf->timeout;
+        p_rec->budget = (p_cnf->bitrate / 8u) / p_cnf->fps;
+        p_rec->average = 0u;
+        p_rec->quality = p_cnf->quality;
+        p_rec->quality_min = p_cnf->quality_min;
+        p_rec->quality_max = p_cnf->quality_max;
+        R_MJPEG_RecQualityTables(p_rec->quality, p_rec->qt);
+        p_rec->head = 0u;
+        p_rec->count = 0u;
+        p_rec->stop = false;
+        clear_stats(p_rec);
+
+        error = R_MJPEG_AviOpen(&p_rec->avi, p_cnf);
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        error = p_rec->p_backend->p_open();
+    }
+
+    if (JCU_ERROR_OK == error)
+    {
+        if (false == R_OS_CreateSemaphore(&p_rec->semid, 0u))
+        {
+            error = E_STATE;
+        }
+        else if (false == R_OS_CreateSemaphore(&p_rec->stop_semid, 0u))
+        {
+            R_OS_DeleteSemaphore(&p_rec->semid);
+            error = E_STATE;
+        }
+        else
+        {
+            p_rec->p_task = R_OS_CreateTask("MJPEG recorder", rec_task, p_rec,
+                    R_OS_ABSTRACTION_PRV_DEFAULT_STACK_SIZE, p_cnf->priority);
+            if (NULL == p_rec->p_task)
+            {
+                R_OS_DeleteSemaphore(&p_rec->stop_semid);
+                R_OS_DeleteSemaphore(&p_rec->semid);
+                error = E_STATE;
+            }
+        }
+
+        if (JCU_ERROR_OK != error)
+        {
+            p_rec->p_backend->p_close();
+        }
+    }
+
+    return error;
+} /* End of function R_MJPEG_RecOpen() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_RecClose
+ * @brief       Stops the service task, completes the AVI file and closes
+ *              the back end
+ * @param[in]   p_rec           : Recorder instance
+ * @retval      JCU_ERROR_OK or E_ERRNO
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_RecClose(st_mjpeg_rec_t * const p_rec)
+{
+    jcu_errorcode_t error;
+    int_t lock;
+
+    error = JCU_ERROR_PARAM;
+
+    if (NULL != p_rec)
+    {
+        lock = R_OS_SysLock(NULL);
+        p_rec->stop = true;
+        R_OS_SysUnlock(NULL, lock);
+
+        /* Wakes the task if it is waiting for a frame */
+        R_OS_ReleaseSemaphore(&p_rec->semid);
+        while (false == R_OS_WaitForSemaphore(&p_rec->stop_semid, REC_IDLE_MS))
+        {
+            /* Do Nothing */
+        }
+
+        R_OS_DeleteSemaphore(&p_rec->stop_semid);
+        R_OS_DeleteSemaphore(&p_rec->semid);
+        p_rec->p_backend->p_close();
+
+        error = R_MJPEG_AviClose(&p_rec->avi);
+    }
+
+    return error;
+} /* End of function R_MJPEG_RecClose() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_RecSubmit
+ * @brief       Queues a frame
+ * @param[in]   p_rec           : Recorder instance
+ * @param[in]   p_frame         : Frame
+ * @retval      JCU_ERROR_OK, JCU_ERROR_PARAM, E_FIFO_OVER or E_STATE
+ ******************************************************************************/
+jcu_errorcode_t R_MJPEG_RecSubmit(st_mjpeg_rec_t * const p_rec, st_mjpeg_rec_frame_t * const p_frame)
+{
+    jcu_errorcode_t error;
+    int_t lock;
+
+    error = JCU_ERROR_OK;
+
+    if ((NULL == p_rec) || (NULL == p_frame) || (NULL == p_frame->p_data))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else if (0u != ((uint32_t) p_frame->p_data & (MJPEG_REC_ALIGNMENT - 1u)))
+    {
+        error = JCU_ERROR_PARAM;
+    }
+    else
+    {
+        p_frame->result = JCU_ERROR_OK;
+        p_frame->size = 0u;
+        p_frame->quality = 0u;
+        p_frame->encode_ms = 0u;
+        p_frame->done = false;
+        p_frame->tick_submit = (uint32_t) xTaskGetTickCount();
+
+        lock = R_OS_SysLock(NULL);
+        if (true == p_rec->stop)
+        {
+            error = E_STATE;
+        }
+        else if (p_rec->count >= MJPEG_REC_QUEUE_DEPTH)
+        {
+            p_rec->stats.dropped++;
+            error = E_FIFO_OVER;
+        }
+        else
+        {
+            if (0u == p_rec->sequence)
+            {
+                p_rec->tick_first = p_frame->tick_submit;
+            }
+            p_frame->sequence = p_rec->sequence;
+            p_rec->sequence++;
+            p_rec->queue[(p_rec->head + p_rec->count) % MJPEG_REC_QUEUE_DEPTH] = p_frame;
+            p_rec->count++;
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        if (JCU_ERROR_OK == error)
+        {
+            R_OS_ReleaseSemaphore(&p_rec->semid);
+        }
+    }
+
+    return error;
+} /* End of function R_MJPEG_RecSubmit() */
+
+/**************************************************************************//**
+ * Function Name : R_MJPEG_RecGetStats
+ * @brief       Reads the recorder statistics
+ * @param[in]   p_rec           : Recorder instance
+ * @param[out]  p_stats         : Statistics
+ * @param[in]   clear           : true: reset the statistics after reading
+ * @retval      none
+ ******************************************************************************/
+void R_MJPEG_RecGetStats(st_mjpeg_rec_t * const p_rec, st_mjpeg_rec_stats_t * const p_stats,
+        const bool_t clear)
+{
+    int_t lock;
+
+    if ((NULL != p_rec) && (NULL != p_stats))
+    {
+        lock = R_OS_SysLock(NULL);
+        p_stats->frames = p_rec->stats.frames;
+        p_stats->dropped = p_rec->stats.dropped;
+        p_stats->errors = p_rec->stats.errors;
+        p_stats->overlapped = p_rec->stats.overlapped;
+        p_stats->bytes = p_rec->stats.bytes;
+        p_stats->bytes_min = p_rec->stats.bytes_min;
+        p_stats->bytes_max = p_rec->stats.bytes_max;
+        p_stats->quality = p_rec->quality;
+        p_stats->encode_max_ms = p_rec->stats.encode_max_ms;
+        p_stats->write_max_ms = p_rec->stats.write_max_ms;
+        p_stats->elapsed_ms = p_rec->stats.elapsed_ms;
+        if (true == clear)
+        {
+            clear_stats(p_rec);
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        /* No frame was recorded yet */
+        if (p_stats->bytes_min > p_stats->bytes_max)
+        {
+            p_stats->bytes_min = 0u;
+        }
+    }
+} /* End of function R_MJPEG_RecGetStats() */
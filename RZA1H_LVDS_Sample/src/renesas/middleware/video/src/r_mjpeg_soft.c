@@ -0,0 +1,624 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_mjpeg_soft.c
+ * @file         r_mjpeg_soft.c
+ * @version      1.00
+ * @brief        Software back end of the motion JPEG recorder, a baseline
+ *               encoder writing the same stream as the JCU
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "rz_co_typedef.h"
+#include    "r_mjpeg_rec.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define SOFT_BLOCK          (8u)    /* Samples per side of a block           */
+#define SOFT_MCU_WIDTH      (16u)   /* Pixels per MCU of YCbCr422            */
+#define SOFT_COMPONENTS     (3u)
+#define SOFT_DC_MAX         (2047)  /* Largest DC difference of 8 bit samples */
+#define SOFT_AC_MAX         (1023)  /* Largest AC coefficient of 8 bit samples */
+
+/* JPEG markers */
+#define SOFT_MARKER         (0xFFu)
+#define SOFT_SOI            (0xD8u)
+#define SOFT_EOI            (0xD9u)
+#define SOFT_SOF0           (0xC0u)
+#define SOFT_DHT            (0xC4u)
+#define SOFT_RST0           (0xD0u)
+#define SOFT_SOS            (0xDAu)
+#define SOFT_DQT            (0xDBu)
+#define SOFT_DRI            (0xDDu)
+
+/* Run length symbols */
+#define SOFT_EOB            (0x00u)
+#define SOFT_ZRL            (0xF0u)
+
+/******************************************************************************
+ Typedef definitions
+ ******************************************************************************/
+typedef struct
+{
+    uint16_t code[256];                 /* Code of each symbol                */
+    uint8_t  size[256];                 /* Bits of each code, 0 if not coded  */
+} st_soft_code_t;
+
+typedef struct
+{
+    /* Entropy coded data */
+    uint8_t        *p_out;
+    uint32_t       size;
+    uint32_t       pos;
+    uint32_t       bits;                /* Bits not yet written, last bit in bit 0 */
+    uint32_t       nbits;
+    bool_t         full;                /* The JPEG did not fit                */
+
+    /* Tables, luminance then chrominance */
+    st_soft_code_t dc[2];
+    st_soft_code_t ac[2];
+    float          scale[2][64];        /* 1 / quantiser, zig-zag order        */
+    int32_t        pred[SOFT_COMPONENTS];
+
+    st_mjpeg_rec_encode_t encode;
+    bool_t         pending;
+} st_soft_encoder_t;
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static st_soft_encoder_t gs_soft;
+
+/* Natural order index of each zig-zag position */
+static const uint8_t gs_zigzag[64] =
+{
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+/* C(u) / 2 * cos((2x + 1) * u * pi / 16), indexed [x][u] */
+static const float gs_fdct[8][8] =
+{
+    { 0.353553391f, 0.490392640f, 0.461939766f, 0.415734806f, 0.353553391f, 0.277785117f, 0.191341716f, 0.097545161f },
+    { 0.353553391f, 0.415734806f, 0.191341716f, -0.097545161f, -0.353553391f, -0.490392640f, -0.461939766f, -0.277785117f },
+    { 0.353553391f, 0.277785117f, -0.191341716f, -0.490392640f, -0.353553391f, 0.097545161f, 0.461939766f, 0.415734806f },
+    { 0.353553391f, 0.097545161f, -0.461939766f, -0.277785117f, 0.353553391f, 0.415734806f, -0.191341716f, -0.490392640f },
+    { 0.353553391f, -0.097545161f, -0.461939766f, 0.277785117f, 0.353553391f, -0.415734806f, -0.191341716f, 0.490392640f },
+    { 0.353553391f, -0.277785117f, -0.191341716f, 0.490392640f, -0.353553391f, -0.097545161f, 0.461939766f, -0.415734806f },
+    { 0.353553391f, -0.415734806f, 0.191341716f, 0.097545161f, -0.353553391f, 0.490392640f, -0.461939766f, 0.277785117f },
+    { 0.353553391f, -0.490392640f, 0.461939766f, -0.415734806f, 0.353553391f, -0.277785117f, 0.191341716f, -0.097545161f }
+};
+
+static jcu_errorcode_t soft_open(void);
+static jcu_errorcode_t soft_start(const st_mjpeg_rec_encode_t * const p_encode);
+static jcu_errorcode_t soft_wait(const uint32_t timeout, uint32_t * const p_size);
+static void soft_close(void);
+
+/**************************************************************************//**
+ * Function Name : make_codes
+ * @brief       Generates the code of each symbol of a Huffman table, as
+ *              T.81 Annex C
+ * @param[out]  p_code          : Codes
+ * @param[in]   p_table         : Code counts for lengths 1 - 16, then the
+ *                                symbols
+ * @retval      none
+ ******************************************************************************/
+static void make_codes(st_soft_code_t * const p_code, const uint8_t * const p_table)
+{
+    const uint8_t *p_vals;
+    uint32_t code;
+    uint32_t len;
+    uint32_t i;
+
+    p_vals = &p_table[16];
+    code = 0u;
+
+    for (i = 0u; i < 256u; i++)
+    {
+        p_code->size[i] = 0u;
+    }
+
+    for (len = 1u; len <= 16u; len++)
+    {
+        for (i = 0u; i < p_table[len - 1u]; i++)
+        {
+            p_code->code[*p_vals] = (uint16_t) code;
+            p_code->size[*p_vals] = (uint8_t) len;
+            p_vals++;
+            code++;
+        }
+        code <<= 1;
+    }
+} /* End of function make_codes() */
+
+/**************************************************************************//**
+ * Function Name : put_byte
+ * @brief       Writes a byte of the JPEG
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   value           : Byte
+ * @retval      none
+ ******************************************************************************/
+static void put_byte(st_soft_encoder_t * const p_enc, const uint32_t value)
+{
+    if (p_enc->pos < p_enc->size)
+    {
+        p_enc->p_out[p_enc->pos] = (uint8_t) value;
+        p_enc->pos++;
+    }
+    else
+    {
+        p_enc->full = true;
+    }
+} /* End of function put_byte() */
+
+/**************************************************************************//**
+ * Function Name : put_word
+ * @brief       Writes a big endian half word of the JPEG
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   value           : Half word
+ * @retval      none
+ ******************************************************************************/
+static void put_word(st_soft_encoder_t * const p_enc, const uint32_t value)
+{
+    put_byte(p_enc, (value >> 8) & 0xFFu);
+    put_byte(p_enc, value & 0xFFu);
+} /* End of function put_word() */
+
+/**************************************************************************//**
+ * Function Name : put_bits
+ * @brief       Adds bits to the entropy coded data, stuffing a zero byte
+ *              after each 0xFF
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   value           : Bits, last bit in bit 0
+ * @param[in]   count           : Number of bits, at most 16
+ * @retval      none
+ ******************************************************************************/
+static void put_bits(st_soft_encoder_t * const p_enc, const uint32_t value, const uint32_t count)
+{
+    uint32_t byte;
+
+    p_enc->bits = (p_enc->bits << count) | (value & ((1uL << count) - 1u));
+    p_enc->nbits += count;
+
+    while (p_enc->nbits >= 8u)
+    {
+        p_enc->nbits -= 8u;
+        byte = (p_enc->bits >> p_enc->nbits) & 0xFFu;
+        put_byte(p_enc, byte);
+        if (SOFT_MARKER == byte)
+        {
+            put_byte(p_enc, 0u);
+        }
+    }
+    p_enc->bits &= (1uL << p_enc->nbits) - 1u;
+} /* End of function put_bits() */
+
+/**************************************************************************//**
+ * Function Name : flush_bits
+ * @brief       Pads the entropy coded data to a byte with 1 bits
+ * @param[in]   p_enc           : Encoder
+ * @retval      none
+ ******************************************************************************/
+static void flush_bits(st_soft_encoder_t * const p_enc)
+{
+    if (0u != p_enc->nbits)
+    {
+        put_bits(p_enc, 0x7Fu, 8u - p_enc->nbits);
+    }
+} /* End of function flush_bits() */
+
+/**************************************************************************//**
+ * Function Name : put_value
+ * @brief       Codes a symbol, then the bits of the value it gives the size
+ *              of
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   p_code          : Huffman codes
+ * @param[in]   run             : Zero coefficients before the value, 0 for DC
+ * @param[in]   value           : Coefficient or DC difference
+ * @retval      none
+ ******************************************************************************/
+static void put_value(st_soft_encoder_t * const p_enc, const st_soft_code_t * const p_code,
+        const uint32_t run, const int32_t value)
+{
+    uint32_t magnitude;
+    uint32_t count;
+    uint32_t symbol;
+
+    magnitude = (uint32_t) ((value < 0) ? -value : value);
+    count = 0u;
+    while (0u != magnitude)
+    {
+        count++;
+        magnitude >>= 1;
+    }
+
+    symbol = (run << 4) | count;
+    put_bits(p_enc, p_code->code[symbol], p_code->size[symbol]);
+    if (0u != count)
+    {
+        /* Negative values are coded as value - 1, in count bits */
+        put_bits(p_enc, (uint32_t) ((value < 0) ? (value - 1) : value), count);
+    }
+} /* End of function put_value() */
+
+/**************************************************************************//**
+ * Function Name : encode_block
+ * @brief       Transforms, quantises and codes one block
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   p_block         : Samples less 128
+ * @param[in]   comp            : Component, 0 - 2
+ * @retval      none
+ ******************************************************************************/
+static void encode_block(st_soft_encoder_t * const p_enc, const float * const p_block, const uint32_t comp)
+{
+    const uint32_t table = (0u == comp) ? 0u : 1u;
+    float tmp[64];
+    float coef[64];
+    float sum;
+    int32_t value;
+    int32_t dc;
+    uint32_t run;
+    uint32_t x;
+    uint32_t y;
+    uint32_t u;
+    uint32_t k;
+
+    /* Rows, then columns */
+    for (y = 0u; y < SOFT_BLOCK; y++)
+    {
+        for (u = 0u; u < SOFT_BLOCK; u++)
+        {
+            sum = 0.0f;
+            for (x = 0u; x < SOFT_BLOCK; x++)
+            {
+                sum += p_block[(y * 8u) + x] * gs_fdct[x][u];
+            }
+            tmp[(y * 8u) + u] = sum;
+        }
+    }
+    for (x = 0u; x < SOFT_BLOCK; x++)
+    {
+        for (u = 0u; u < SOFT_BLOCK; u++)
+        {
+            sum = 0.0f;
+            for (y = 0u; y < SOFT_BLOCK; y++)
+            {
+                sum += tmp[(y * 8u) + x] * gs_fdct[y][u];
+            }
+            coef[(u * 8u) + x] = sum;
+        }
+    }
+
+    /* DC, as the difference to the block before */
+    sum = coef[0] * p_enc->scale[table][0];
+    dc = (int32_t) ((sum < 0.0f) ? (sum - 0.5f) : (sum + 0.5f));
+    value = dc - p_enc->pred[comp];
+    p_enc->pred[comp] = dc;
+    value = (value > SOFT_DC_MAX) ? SOFT_DC_MAX : ((value < -SOFT_DC_MAX) ? -SOFT_DC_MAX : value);
+    put_value(p_enc, &p_enc->dc[table], 0u, value);
+
+    run = 0u;
+    for (k = 1u; k < 64u; k++)
+    {
+        sum = coef[gs_zigzag[k]] * p_enc->scale[table][k];
+        value = (int32_t) ((sum < 0.0f) ? (sum - 0.5f) : (sum + 0.5f));
+        if (0 == value)
+        {
+            run++;
+        }
+        else
+        {
+            while (run > 15u)
+            {
+                put_bits(p_enc, p_enc->ac[table].code[SOFT_ZRL], p_enc->ac[table].size[SOFT_ZRL]);
+                run -= 16u;
+            }
+            value = (value > SOFT_AC_MAX) ? SOFT_AC_MAX : ((value < -SOFT_AC_MAX) ? -SOFT_AC_MAX : value);
+            put_value(p_enc, &p_enc->ac[table], run, value);
+            run = 0u;
+        }
+    }
+    if (0u != run)
+    {
+        put_bits(p_enc, p_enc->ac[table].code[SOFT_EOB], p_enc->ac[table].size[SOFT_EOB]);
+    }
+} /* End of function encode_block() */
+
+/**************************************************************************//**
+ * Function Name : encode_mcu
+ * @brief       Codes the two Y blocks and the Cb and Cr blocks of 16 x 8
+ *              pixels. Each pixel is Y, each pair shares Cb and Cr.
+ * @param[in]   p_enc           : Encoder
+ * @param[in]   x0              : Left pixel of the MCU
+ * @param[in]   y0              : Top line of the MCU
+ * @retval      none
+ ******************************************************************************/
+static void encode_mcu(st_soft_encoder_t * const p_enc, const uint32_t x0, const uint32_t y0)
+{
+    const st_mjpeg_rec_encode_t * const p_encode = &p_enc->encode;
+    const uint8_t *p_line;
+    float block[4][64];
+    uint32_t flip;
+    uint32_t x;
+    uint32_t y;
+
+    /* Signed chroma is made unsigned by flipping its top bit */
+    flip = (JCU_CBCR_OFFSET_128 == p_encode->cbcr_offset) ? 0u : 0x80u;
+
+    for (y = 0u; y < SOFT_BLOCK; y++)
+    {
+        /* Bytes Y0 Cb Y1 Cr */
+        p_line = p_encode->p_frame + ((((y0 + y) * (uint32_t) p_encode->stride) + x0) * 2u);
+        for (x = 0u; x < SOFT_BLOCK; x++)
+        {
+            block[0][(y * 8u) + x] = (float) p_line[x * 2u] - 128.0f;
+            block[1][(y * 8u) + x] = (float) p_line[(x + 8u) * 2u] - 128.0f;
+            block[2][(y * 8u) + x] = (float) (p_line[(x * 4u) + 1u] ^ flip) - 128.0f;
+            block[3][(y * 8u) + x] = (float) (p_line[(x * 4u) + 3u] ^ flip) - 128.0f;
+        }
+    }
+
+    encode_block(p_enc, block[0], 0u);
+    encode_block(p_enc, block[1], 0u);
+    encode_block(p_enc, block[2], 1u);
+    encode_block(p_enc, block[3], 2u);
+} /* End of function encode_mcu() */
+
+/**************************************************************************//**
+ * Function Name : put_headers
+ * @brief       Writes the markers before the entropy coded data
+ * @param[in]   p_enc           : Encoder
+ * @retval      none
+ ******************************************************************************/
+static void put_headers(st_soft_encoder_t * const p_enc)
+{
+    const st_mjpeg_rec_encode_t * const p_encode = &p_enc->encode;
+    uint32_t t;
+    uint32_t k;
+
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_SOI);
+
+    /* Both quantisation tables in one segment */
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_DQT);
+    put_word(p_enc, 2u + (2u * 65u));
+    for (t = 0u; t < 2u; t++)
+    {
+        put_byte(p_enc, t);
+        for (k = 0u; k < 64u; k++)
+        {
+            put_byte(p_enc, p_encode->p_qt[t][k]);
+        }
+    }
+
+    /* Y 2 x 1, Cb and Cr 1 x 1 */
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_SOF0);
+    put_word(p_enc, 8u + (3u * SOFT_COMPONENTS));
+    put_byte(p_enc, 8u);
+    put_word(p_enc, p_encode->height);
+    put_word(p_enc, p_encode->width);
+    put_byte(p_enc, SOFT_COMPONENTS);
+    for (t = 0u; t < SOFT_COMPONENTS; t++)
+    {
+        put_byte(p_enc, t + 1u);
+        put_byte(p_enc, (0u == t) ? 0x21u : 0x11u);
+        put_byte(p_enc, (0u == t) ? 0u : 1u);
+    }
+
+    /* DC 0, AC 0, DC 1, AC 1 */
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_DHT);
+    put_word(p_enc, 2u + (2u * (1u + MJPEG_REC_DHT_DC_SIZE)) + (2u * (1u + MJPEG_REC_DHT_AC_SIZE)));
+    for (t = 0u; t < 2u; t++)
+    {
+        put_byte(p_enc, t);
+        for (k = 0u; k < MJPEG_REC_DHT_DC_SIZE; k++)
+        {
+            put_byte(p_enc, g_mjpeg_rec_dht_dc[t][k]);
+        }
+        put_byte(p_enc, 0x10u | t);
+        for (k = 0u; k < MJPEG_REC_DHT_AC_SIZE; k++)
+        {
+            put_byte(p_enc, g_mjpeg_rec_dht_ac[t][k]);
+        }
+    }
+
+    if (0u != p_encode->restart)
+    {
+        put_byte(p_enc, SOFT_MARKER);
+        put_byte(p_enc, SOFT_DRI);
+        put_word(p_enc, 4u);
+        put_word(p_enc, p_encode->restart);
+    }
+
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_SOS);
+    put_word(p_enc, 6u + (2u * SOFT_COMPONENTS));
+    put_byte(p_enc, SOFT_COMPONENTS);
+    for (t = 0u; t < SOFT_COMPONENTS; t++)
+    {
+        put_byte(p_enc, t + 1u);
+        put_byte(p_enc, (0u == t) ? 0x00u : 0x11u);
+    }
+    put_byte(p_enc, 0u);
+    put_byte(p_enc, 63u);
+    put_byte(p_enc, 0u);
+} /* End of function put_headers() */
+
+/**************************************************************************//**
+ * Function Name : soft_encode
+ * @brief       Encodes the frame passed to soft_start
+ * @param[in]   p_enc           : Encoder
+ * @retval      JCU_ERROR_OK or E_FEW_ARRAY
+ ******************************************************************************/
+static jcu_errorcode_t soft_encode(st_soft_encoder_t * const p_enc)
+{
+    const st_mjpeg_rec_encode_t * const p_encode = &p_enc->encode;
+    uint32_t mcus;
+    uint32_t rst;
+    uint32_t x;
+    uint32_t y;
+    uint32_t t;
+    uint32_t k;
+
+    p_enc->p_out = p_encode->p_jpeg;
+    p_enc->size = p_encode->jpeg_size;
+    p_enc->pos = 0u;
+    p_enc->bits = 0u;
+    p_enc->nbits = 0u;
+    p_enc->full = false;
+
+    for (t = 0u; t < 2u; t++)
+    {
+        for (k = 0u; k < 64u; k++)
+        {
+            p_enc->scale[t][k] = 1.0f / (float) ((0u == p_encode->p_qt[t][k]) ? 1u : p_encode->p_qt[t][k]);
+        }
+    }
+    for (t = 0u; t < SOFT_COMPONENTS; t++)
+    {
+        p_enc->pred[t] = 0;
+    }
+
+    put_headers(p_enc);
+
+    mcus = 0u;
+    rst = 0u;
+    for (y = 0u; (y < p_encode->height) && (false == p_enc->full); y += SOFT_BLOCK)
+    {
+        for (x = 0u; x < p_encode->width; x += SOFT_MCU_WIDTH)
+        {
+            if ((0u != p_encode->restart) && (0u != mcus) && (0u == (mcus % p_encode->restart)))
+            {
+                flush_bits(p_enc);
+                put_byte(p_enc, SOFT_MARKER);
+                put_byte(p_enc, SOFT_RST0 + rst);
+                rst = (rst + 1u) & 7u;
+                for (t = 0u; t < SOFT_COMPONENTS; t++)
+                {
+                    p_enc->pred[t] = 0;
+                }
+            }
+            encode_mcu(p_enc, x, y);
+            mcus++;
+        }
+    }
+
+    flush_bits(p_enc);
+    put_byte(p_enc, SOFT_MARKER);
+    put_byte(p_enc, SOFT_EOI);
+
+    return (true == p_enc->full) ? E_FEW_ARRAY : JCU_ERROR_OK;
+} /* End of function soft_encode() */
+
+/**************************************************************************//**
+ * Function Name : soft_open
+ * @brief       Claims the software encoder
+ * @retval      JCU_ERROR_OK
+ ******************************************************************************/
+static jcu_errorcode_t soft_open(void)
+{
+    make_codes(&gs_soft.dc[0], g_mjpeg_rec_dht_dc[0]);
+    make_codes(&gs_soft.dc[1], g_mjpeg_rec_dht_dc[1]);
+    make_codes(&gs_soft.ac[0], g_mjpeg_rec_dht_ac[0]);
+    make_codes(&gs_soft.ac[1], g_mjpeg_rec_dht_ac[1]);
+    gs_soft.pending = false;
+
+    return JCU_ERROR_OK;
+} /* End of function soft_open() */
+
+/**************************************************************************//**
+ * Function Name : soft_start
+ * @brief       Records an encode, the work is done by soft_wait
+ * @param[in]   p_encode        : Encode parameters
+ * @retval      JCU_ERROR_OK
+ ******************************************************************************/
+static jcu_errorcode_t soft_start(const st_mjpeg_rec_encode_t * const p_encode)
+{
+    gs_soft.encode = *p_encode;
+    gs_soft.pending = true;
+
+    return JCU_ERROR_OK;
+} /* End of function soft_start() */
+
+/**************************************************************************//**
+ * Function Name : soft_wait
+ * @brief       Encodes the frame passed to soft_start
+ * @param[in]   timeout         : Not used, the encode runs to the end
+ * @param[out]  p_size          : Bytes of JPEG
+ * @retval      JCU_ERROR_OK, E_FEW_ARRAY or E_STATE if no encode was
+ *              started
+ ******************************************************************************/
+static jcu_errorcode_t soft_wait(const uint32_t timeout, uint32_t * const p_size)
+{
+    jcu_errorcode_t error;
+
+    (void) timeout;
+
+    if (false == gs_soft.pending)
+    {
+        error = E_STATE;
+    }
+    else
+    {
+        gs_soft.pending = false;
+        error = soft_encode(&gs_soft);
+    }
+
+    *p_size = (JCU_ERROR_OK == error) ? gs_soft.pos : 0u;
+
+    return error;
+} /* End of function soft_wait() */
+
+/**************************************************************************//**
+ * Function Name : soft_close
+ * @brief       Releases the software encoder
+ * @retval      none
+ ******************************************************************************/
+static void soft_close(void)
+{
+    gs_soft.pending = false;
+} /* End of function soft_close() */
+
+/******************************************************************************
+ Exported global variables
+ ******************************************************************************/
+const st_mjpeg_rec_backend_t g_mjpeg_rec_soft =
+{
+    &soft_open,
+    &soft_start,
+    &soft_wait,
+    &soft_close
+};
@@ -56,6 +56,7 @@
  ******************************************************************************/
 static void ceu_int_callback(const ceu_int_type_t interrupt_flag);
 static volatile int32_t capture_flag;
+static void (* volatile capture_end_func)(void);
 
 /**************************************************************************//**
  * Function Name : R_RVAPI_InitializeCEU
@@ -66,6 +67,7 @@ void R_RVAPI_InitializeCEU(void)
 {
     R_CEU_Initialize (&R_CEU_OnInitialize, 0);
     capture_flag = 0;
+    capture_end_func = NULL;
 } /* End of function R_RVAPI_InitializeCEU() */
 
 /**************************************************************************//**
@@ -155,6 +157,17 @@ cap_status_t R_RVAPI_CaptureStatusCEU(void)
     return status;
 } /* End of function R_RVAPI_CaptureStatusCEU() */
 
+/**************************************************************************//**
+ * Function Name : R_RVAPI_SetCaptureEndCEU
+ * @brief       Sets the function called when a frame capture ends
+ * @param[in]   func       : Function called from the CEU interrupt, or NULL
+ * @retval      none
+ ******************************************************************************/
+void R_RVAPI_SetCaptureEndCEU(void (* const func)(void))
+{
+    capture_end_func = func;
+} /* End of function R_RVAPI_SetCaptureEndCEU() */
+
 /**************************************************************************//**
  * Function Name : ceu_int_callback
  * @brief       CEU Interrupt callback function
@@ -163,9 +176,17 @@ cap_status_t R_RVAPI_CaptureStatusCEU(void)
  ******************************************************************************/
 static void ceu_int_callback(const ceu_int_type_t interrupt_flag)
 {
+    void (* func)(void);
+
     if ((CEU_INT_CPEIE & interrupt_flag) == 1u)
     {
         capture_flag = 0;
+
+        func = capture_end_func;
+        if (NULL != func)
+        {
+            func ();
+        }
     }
     return;
 } /* End of function ceu_int_callback() */
@@ -0,0 +1,509 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2018 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_rvapi_flip.c
+ * @file         r_rvapi_flip.c
+ * @version      1.00
+ * @brief        RVAPI vsync synchronised page flip
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "mcu_board_select.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_rvapi_vdc.h"
+#include    "r_rvapi_flip.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define FLIP_LAYER_NUM   (4u)    /* VDC_LAYER_ID_0_RD - VDC_LAYER_ID_3_RD */
+#define FLIP_MIN_BUFFERS (2u)
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static st_rvapi_flip_t * volatile gs_p_flip[VDC_CHANNEL_NUM][FLIP_LAYER_NUM];
+
+static void vsync_process(const vdc_channel_t ch);
+static void vsync_isr_ch0(vdc_int_type_t int_type);
+static void vsync_isr_ch1(vdc_int_type_t int_type);
+
+static void (* const gs_vsync_isr[VDC_CHANNEL_NUM])(vdc_int_type_t int_type) =
+{
+    &vsync_isr_ch0,
+    &vsync_isr_ch1
+};
+
+/**************************************************************************//**
+ * Function Name : release_buffer
+ * @brief       Returns a buffer to the free list, called with interrupts
+ *              locked out or from the Vsync interrupt
+ * @param[in]   p_flip          : Page flip instance
+ * @param[in]   index           : Buffer index
+ * @retval      none
+ ******************************************************************************/
+static void release_buffer(st_rvapi_flip_t * const p_flip, const uint32_t index)
+{
+    p_flip->state[index] = RVAPI_FLIP_FREE;
+    R_OS_ReleaseSemaphore(&p_flip->semid);
+} /* End of function release_buffer() */
+
+/**************************************************************************//**
+ * Function Name : layer_vsync
+ * @brief       Advances the buffers of one layer at the start of a frame.
+ *              The buffer latched at the previous Vsync is now displayed,
+ *              so the buffer it replaced can be drawn into again. The next
+ *              queued buffer is then programmed, and is latched by the VDC
+ *              at the following Vsync.
+ * @param[in]   p_flip          : Page flip instance
+ * @retval      none
+ ******************************************************************************/
+static void layer_vsync(st_rvapi_flip_t * const p_flip)
+{
+    uint32_t i;
+    uint32_t index;
+    bool_t rendering;
+
+    p_flip->stats.vsyncs++;
+    p_flip->since_flip++;
+
+    if (RVAPI_FLIP_NONE != p_flip->latched)
+    {
+        if (RVAPI_FLIP_NONE != p_flip->shown)
+        {
+            release_buffer(p_flip, p_flip->shown);
+        }
+        p_flip->shown = p_flip->latched;
+        p_flip->state[p_flip->shown] = RVAPI_FLIP_SHOWN;
+        p_flip->latched = RVAPI_FLIP_NONE;
+        p_flip->since_flip = 0u;
+        p_flip->stats.flips++;
+    }
+
+    /* A buffer programmed now is displayed since_flip + 1 frames after the current one */
+    if ((p_flip->since_flip + 1u) >= p_flip->interval)
+    {
+        if (0u != p_flip->queued)
+        {
+            index = p_flip->queue[0];
+            for (i = 1u; i < p_flip->queued; i++)
+            {
+                p_flip->queue[i - 1u] = p_flip->queue[i];
+            }
+            p_flip->queued--;
+
+            if (VDC_OK == R_RVAPI_GraphChangeSurfaceVDC(p_flip->ch, p_flip->layer_id, p_flip->p_buff[index]))
+            {
+                p_flip->state[index] = RVAPI_FLIP_LATCHED;
+                p_flip->latched = index;
+            }
+            else
+            {
+                p_flip->stats.dropped++;
+                release_buffer(p_flip, index);
+            }
+        }
+        else if ((p_flip->since_flip + 1u) == p_flip->interval)
+        {
+            /* The slot for the next frame is missed if a frame is still being drawn */
+            rendering = false;
+            for (i = 0u; i < p_flip->num; i++)
+            {
+                if (RVAPI_FLIP_RENDER == p_flip->state[i])
+                {
+                    rendering = true;
+                }
+            }
+            if (true == rendering)
+            {
+                p_flip->stats.late++;
+            }
+        }
+        else
+        {
+            /* Do Nothing */
+        }
+    }
+} /* End of function layer_vsync() */
+
+/**************************************************************************//**
+ * Function Name : vsync_process
+ * @brief       Vsync handling for all flipped layers of a channel
+ * @param[in]   ch              : Channel
+ * @retval      none
+ ******************************************************************************/
+static void vsync_process(const vdc_channel_t ch)
+{
+    uint32_t layer;
+    st_rvapi_flip_t * p_flip;
+
+    for (layer = 0u; layer < FLIP_LAYER_NUM; layer++)
+    {
+        p_flip = gs_p_flip[ch][layer];
+        if (NULL != p_flip)
+        {
+            layer_vsync(p_flip);
+        }
+    }
+} /* End of function vsync_process() */
+
+/**************************************************************************//**
+ * Function Name : vsync_isr_ch0
+ * @brief       VDC channel 0 output Vsync callback
+ * @param[in]   int_type        : VDC interrupt type
+ * @retval      none
+ ******************************************************************************/
+static void vsync_isr_ch0(vdc_int_type_t int_type)
+{
+    UNUSED_PARAM(int_type);
+    vsync_process(VDC_CHANNEL_0);
+} /* End of function vsync_isr_ch0() */
+
+/**************************************************************************//**
+ * Function Name : vsync_isr_ch1
+ * @brief       VDC channel 1 output Vsync callback
+ * @param[in]   int_type        : VDC interrupt type
+ * @retval      none
+ ******************************************************************************/
+static void vsync_isr_ch1(vdc_int_type_t int_type)
+{
+    UNUSED_PARAM(int_type);
+    vsync_process(VDC_CHANNEL_1);
+} /* End of function vsync_isr_ch1() */
+
+/**************************************************************************//**
+ * Function Name : R_RVAPI_FlipCreateVDC
+ * @brief       Starts flipping a graphics layer
+ * @param[out]  p_flip          : Page flip instance
+ * @param[in]   ch              : Channel
+ * @param[in]   p_cnf           : Page flip config
+ * @retval      VDC driver error code
+ ******************************************************************************/
+vdc_error_t R_RVAPI_FlipCreateVDC(st_rvapi_flip_t * const p_flip, const vdc_channel_t ch,
+        const st_rvapi_flip_config_t * const p_cnf)
+{
+    vdc_error_t error;
+    uint32_t i;
+    uint32_t layer;
+    bool_t first;
+    int_t lock;
+
+    error = VDC_OK;
+    layer = 0u;
+
+    if ((NULL == p_flip) || (NULL == p_cnf) || (NULL == p_cnf->pp_buff))
+    {
+        error = VDC_ERR_PARAM_NULL;
+    }
+    else if ((ch != VDC_CHANNEL_0) && (ch != VDC_CHANNEL_1))
+    {
+        error = VDC_ERR_PARAM_CHANNEL;
+    }
+    else if ((p_cnf->layer_id < VDC_LAYER_ID_0_RD) || (p_cnf->layer_id > VDC_LAYER_ID_3_RD))
+    {
+        error = VDC_ERR_PARAM_LAYER_ID;
+    }
+    else if ((p_cnf->num < FLIP_MIN_BUFFERS) || (p_cnf->num > RVAPI_FLIP_MAX_BUFFERS) || (0u == p_cnf->interval))
+    {
+        error = VDC_ERR_PARAM_EXCEED_RANGE;
+    }
+    else
+    {
+        layer = (uint32_t) p_cnf->layer_id - (uint32_t) VDC_LAYER_ID_0_RD;
+    }
+
+    if (VDC_OK == error)
+    {
+        p_flip->ch = ch;
+        p_flip->layer_id = p_cnf->layer_id;
+        p_flip->num = p_cnf->num;
+        p_flip->interval = p_cnf->interval;
+        p_flip->mailbox = p_cnf->mailbox;
+        for (i = 0u; i < p_flip->num; i++)
+        {
+            if (NULL == p_cnf->pp_buff[i])
+            {
+                error = VDC_ERR_PARAM_NULL;
+            }
+            p_flip->p_buff[i] = p_cnf->pp_buff[i];
+            p_flip->state[i] = RVAPI_FLIP_FREE;
+        }
+        p_flip->state[0] = RVAPI_FLIP_SHOWN;
+        p_flip->queued = 0u;
+        p_flip->latched = RVAPI_FLIP_NONE;
+        p_flip->shown = 0u;
+        p_flip->since_flip = 0u;
+        p_flip->stats.vsyncs = 0u;
+        p_flip->stats.flips = 0u;
+        p_flip->stats.dropped = 0u;
+        p_flip->stats.late = 0u;
+    }
+
+    if (VDC_OK == error)
+    {
+        if (false == R_OS_CreateSemaphore(&p_flip->semid, p_flip->num - 1u))
+        {
+            error = VDC_ERR_IF_CONDITION;
+        }
+    }
+
+    if (VDC_OK == error)
+    {
+        first = true;
+        lock = R_OS_SysLock(NULL);
+        for (i = 0u; i < FLIP_LAYER_NUM; i++)
+        {
+            if (NULL != gs_p_flip[ch][i])
+            {
+                first = false;
+            }
+        }
+        if (NULL == gs_p_flip[ch][layer])
+        {
+            gs_p_flip[ch][layer] = p_flip;
+        }
+        else
+        {
+            error = VDC_ERR_RESOURCE_LAYER;
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        if (VDC_OK != error)
+        {
+            R_OS_DeleteSemaphore(&p_flip->semid);
+        }
+        else if (true == first)
+        {
+            error = R_RVAPI_InterruptEnableVDC(ch, VDC_INT_TYPE_S0_LO_VSYNC, 0u, gs_vsync_isr[ch]);
+            if (VDC_OK != error)
+            {
+                gs_p_flip[ch][layer] = NULL;
+                R_OS_DeleteSemaphore(&p_flip->semid);
+            }
+        }
+        else
+        {
+            /* Do Nothing */
+        }
+    }
+
+    return error;
+} /* End of function R_RVAPI_FlipCreateVDC() */
+
+/**************************************************************************//**
+ * Function Name : R_RVAPI_FlipDestroyVDC
+ * @brief       Stops flipping a graphics layer
+ * @param[in]   p_flip          : Page flip instance
+ * @retval      VDC driver error code
+ ******************************************************************************/
+vdc_error_t R_RVAPI_FlipDestroyVDC(st_rvapi_flip_t * const p_flip)
+{
+    vdc_error_t error;
+    uint32_t i;
+    uint32_t layer;
+    bool_t last;
+    int_t lock;
+
+    error = VDC_OK;
+    layer = 0u;
+
+    if (NULL == p_flip)
+    {
+        error = VDC_ERR_PARAM_NULL;
+    }
+    else
+    {
+        layer = (uint32_t) p_flip->layer_id - (uint32_t) VDC_LAYER_ID_0_RD;
+        if ((layer >= FLIP_LAYER_NUM) || ((p_flip->ch != VDC_CHANNEL_0) && (p_flip->ch != VDC_CHANNEL_1))
+                || (gs_p_flip[p_flip->ch][layer] != p_flip))
+        {
+            error = VDC_ERR_IF_CONDITION;
+        }
+    }
+
+    if (VDC_OK == error)
+    {
+        last = true;
+        lock = R_OS_SysLock(NULL);
+        gs_p_flip[p_flip->ch][layer] = NULL;
+        for (i = 0u; i < FLIP_LAYER_NUM; i++)
+        {
+            if (NULL != gs_p_flip[p_flip->ch][i])
+            {
+                last = false;
+            }
+        }
+        R_OS_SysUnlock(NULL, lock);
+
+        if (true == last)
+        {
+            error = R_RVAPI_InterruptDisableVDC(p_flip->ch, VDC_INT_TYPE_S0_LO_VSYNC);
+        }
+        R_OS_DeleteSemaphore(&p_flip->semid);
+    }
+
+    return error;
+} /* End of function R_RVAPI_FlipDestroyVDC() */
+
+/**************************************************************************//**
+ * Function Name : R_RVAPI_FlipAcquireVDC
+ * @brief       Waits for a free frame buffer
+ * @param[in]   p_flip          : Page flip instance
+ * @param[in]   timeout         : Time to wait in ms
+ * @param[out]  pp_buff         : Frame buffer to draw into
+ * @retval      VDC driver error code
+ ******************************************************************************/
+vdc_error_t R_RVAPI_FlipAcquireVDC(st_rvapi_flip_t * const p_flip, const uint32_t timeout,
+        void ** const pp_buff)
+{
+    vdc_error_t error;
+    uint32_t i;
+    int_t lock;
+
+    error = VDC_OK;
+
+    if ((NULL == p_flip) || (NULL == pp_buff))
+    {
+        error = VDC_ERR_PARAM_NULL;
+    }
+    else if (false == R_OS_WaitForSemaphore(&p_flip->semid, timeout))
+    {
+        error = VDC_ERR_RESOURCE_VSYNC;
+    }
+    else
+    {
+        /* The semaphore count guarantees a free buffer */
+        *pp_buff = NULL;
+        lock = R_OS_SysLock(NULL);
+        for (i = 0u; (i < p_flip->num) && (NULL == *pp_buff); i++)
+        {
+            if (RVAPI_FLIP_FREE == p_flip->state[i])
+            {
+                p_flip->state[i] = RVAPI_FLIP_RENDER;
+                *pp_buff = p_flip->p_buff[i];
+            }
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return error;
+} /* End of function R_RVAPI_FlipAcquireVDC() */
+
+/**************************************************************************//**
+ * Function Name : R_RVAPI_FlipQueueVDC
+ * @brief       Queues a frame buffer for display
+ * @param[in]   p_flip          : Page flip instance
+ * @param[in]   p_buff          : Frame buffer
+ * @retval      VDC driver error code
+ ******************************************************************************/
+vdc_error_t R_RVAPI_FlipQueueVDC(st_rvapi_flip_t * const p_flip, void * const p_buff)
+{
+    vdc_error_t error;
+    uint32_t i;
+    uint32_t index;
+    int_t lock;
+
+    error = VDC_OK;
+    index = RVAPI_FLIP_NONE;
+
+    if ((NULL == p_flip) || (NULL == p_buff))
+    {
+        error = VDC_ERR_PARAM_NULL;
+    }
+    else
+    {
+        for (i = 0u; i < p_flip->num; i++)
+        {
+            if ((p_flip->p_buff[i] == p_buff) && (RVAPI_FLIP_RENDER == p_flip->state[i]))
+            {
+                index = i;
+            }
+        }
+        if (RVAPI_FLIP_NONE == index)
+        {
+            error = VDC_ERR_PARAM_CONDITION;
+        }
+    }
+
+    if (VDC_OK == error)
+    {
+        lock = R_OS_SysLock(NULL);
+        if (true == p_flip->mailbox)
+        {
+            for (i = 0u; i < p_flip->queued; i++)
+            {
+                p_flip->stats.dropped++;
+                release_buffer(p_flip, p_flip->queue[i]);
+            }
+            p_flip->queued = 0u;
+        }
+        p_flip->state[index] = RVAPI_FLIP_QUEUED;
+        p_flip->queue[p_flip->queued] = (uint8_t) index;
+        p_flip->queued++;
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return error;
+} /* End of function R_RVAPI_FlipQueueVDC() */
+
+/**************************************************************************//**
+ * Function Name : R_RVAPI_FlipGetStatsVDC
+ * @brief       Reads the frame pacing statistics
+ * @param[in]   p_flip          : Page flip instance
+ * @param[out]  p_stats         : Statistics
+ * @param[in]   clear           : true: reset the statistics after reading
+ * @retval      VDC driver error code
+ ******************************************************************************/
+vdc_error_t R_RVAPI_FlipGetStatsVDC(st_rvapi_flip_t * const p_flip, st_rvapi_flip_stats_t * const p_stats,
+        const bool_t clear)
+{
+    vdc_error_t error;
+    int_t lock;
+
+    error = VDC_OK;
+
+    if ((NULL == p_flip) || (NULL == p_stats))
+    {
+        error = VDC_ERR_PARAM_NULL;
+    }
+    else
+    {
+        lock = R_OS_SysLock(NULL);
+        p_stats->vsyncs = p_flip->stats.vsyncs;
+        p_stats->flips = p_flip->stats.flips;
+        p_stats->dropped = p_flip->stats.dropped;
+        p_stats->late = p_flip->stats.late;
+        if (true == clear)
+        {
+            p_flip->stats.vsyncs = 0u;
+            p_flip->stats.flips = 0u;
+            p_flip->stats.dropped = 0u;
+            p_flip->stats.late = 0u;
+        }
+        R_OS_SysUnlock(NULL, lock);
+    }
+
+    return error;
+} /* End of function R_RVAPI_FlipGetStatsVDC() */
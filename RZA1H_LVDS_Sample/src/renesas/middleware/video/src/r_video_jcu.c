@@ -0,0 +1,195 @@
+/*******************************************************************************
+ * DISCLAIMER
+ * This software is supplied by Renesas Electronics Corporation and is only
+ * intended for use with Renesas products. No other uses are authorized. This
+ * software is owned by Renesas Electronics Corporation and is protected under
+ * all applicable laws, including copyright laws.
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+ * THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+ * LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+ * TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+ * ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+ * ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+ * BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+ * Renesas reserves the right, without notice, to make changes to this software
+ * and to discontinue the availability of this software. By using this software,
+ * you agree to the additional terms and conditions found by accessing the
+ * following link:
+ * http://www.renesas.com/disclaimer
+ * Copyright (C) 2019 Renesas Electronics Corporation. All rights reserved.
+ *******************************************************************************/
+/**************************************************************************//**
+ * File Name :   r_video_jcu.c
+ * @file         r_video_jcu.c
+ * @version      1.00
+ * @brief        JCU ownership shared by the JPEG back ends
+ ******************************************************************************/
+
+/******************************************************************************
+ Includes   <System Includes> , "Project Includes"
+ ******************************************************************************/
+#include    "r_typedefs.h"
+#include    "r_os_abstraction_api.h"
+#include    "r_jcu.h"
+#include    "rz_co.h"
+#include    "r_video_jcu.h"
+
+/******************************************************************************
+ Macro definitions
+ ******************************************************************************/
+#define VIDEO_JCU_FINALIZE_MS   (100u)  /* Longest wait for a codec to be abandoned */
+
+/******************************************************************************
+ Private global variables and functions
+ ******************************************************************************/
+static e_video_jcu_owner_t gs_jcu_owner = VIDEO_JCU_OWNER_NONE;
+static uint32_t gs_jcu_semid;
+static volatile jcu_errorcode_t gs_jcu_result;
+
+/**************************************************************************//**
+ * Function Name : jcu_finished
+ * @brief       Codec finished callback, called from the JCU interrupt
+ * @param[in]   p_arg           : Not used
+ * @retval      none
+ ******************************************************************************/
+static void jcu_finished(volatile void *p_arg)
+{
+    (void) p_arg;
+
+    /* Set by R_JCU_OnInterrupted just before the callback */
+    gs_jcu_result = R_CO_GetErrNum();
+    R_OS_ReleaseSemaphore(&gs_jcu_semid);
+} /* End of function jcu_finished() */
+
+/**************************************************************************//**
+ * Function Name : jcu_terminate
+ * @brief       Stops the JCU, abandoning a codec still running
+ * @retval      none
+ ******************************************************************************/
+static void jcu_terminate(void)
+{
+    volatile bool_t finalized;
+    uint32_t waited;
+
+    finalized = false;
+    if (JCU_ERROR_OK == R_JCU_TerminateAsync((r_co_function_t) R_CO_SetTrue, &finalized))
+    {
+        for (waited = 0u; (false == finalized) && (waited < VIDEO_JCU_FINALIZE_MS); waited++)
+        {
+            R_OS_TaskSleep(1u);
+        }
+    }
+} /* End of function jcu_terminate() */
+
+/******************************************************************************
+ Exported global functions (to be accessed by other files)
+ ******************************************************************************/
+
+/**************************************************************************//**
+ * Function Name : R_VIDEO_JcuOpen
+ * @brief       Claims and initialises the JCU
+ * @param[in]   owner           : Back end claiming the JCU
+ * @retval      Error code of the JCU driver, or E_STATE
+ ******************************************************************************/
+jcu_errorcode_t R_VIDEO_JcuOpen(const e_video_jcu_owner_t owner)
+{
+    jcu_errorcode_t error;
+    jcu_config_t config = {0};
+    int_t lock;
+
+    error = JCU_ERROR_OK;
+
+    lock = R_OS_SysLock(NULL);
+    if (VIDEO_JCU_OWNER_NONE != gs_jcu_owner)
+    {
+        error = E_STATE;
+    }
+    else
+    {
+        gs_jcu_owner = owner;
+    }
+    R_OS_SysUnlock(NULL, lock);
+
+    if (JCU_ERROR_OK == error)
+    {
+        error = R_JCU_Initialize(&config);
+
+        if (JCU_ERROR_OK == error)
+        {
+            if (false == R_OS_CreateSemaphore(&gs_jcu_semid, 0u))
+            {
+                jcu_terminate();
+                error = E_STATE;
+            }
+        }
+
+        if (JCU_ERROR_OK != error)
+        {
+            gs_jcu_owner = VIDEO_JCU_OWNER_NONE;
+        }
+    }
+
+    return error;
+} /* End of function R_VIDEO_JcuOpen() */
+
+/**************************************************************************//**
+ * Function Name : R_VIDEO_JcuStart
+ * @brief       Starts the codec set up by the owner
+ * @retval      Error code of the JCU driver
+ ******************************************************************************/
+jcu_errorcode_t R_VIDEO_JcuStart(void)
+{
+    /* Discard a completion of a codec that R_VIDEO_JcuWait gave up on */
+    while (R_OS_WaitForSemaphore(&gs_jcu_semid, 0u))
+    {
+        /* Do nothing */
+    }
+
+    gs_jcu_result = JCU_ERROR_OK;
+
+    return R_JCU_StartAsync(jcu_finished, NULL);
+} /* End of function R_VIDEO_JcuStart() */
+
+/**************************************************************************//**
+ * Function Name : R_VIDEO_JcuWait
+ * @brief       Waits for the codec started by R_VIDEO_JcuStart. If it does
+ *              not finish in time the JCU is reset.
+ * @param[in]   timeout         : Time to wait in ms
+ * @retval      Error code of the codec, or E_TIME_OUT
+ ******************************************************************************/
+jcu_errorcode_t R_VIDEO_JcuWait(const uint32_t timeout)
+{
+    jcu_errorcode_t error;
+    jcu_config_t config = {0};
+
+    if (false == R_OS_WaitForSemaphore(&gs_jcu_semid, timeout))
+    {
+        jcu_terminate();
+        (void) R_JCU_Initialize(&config);
+        error = E_TIME_OUT;
+    }
+    else
+    {
+        error = gs_jcu_result;
+    }
+
+    return error;
+} /* End of function R_VIDEO_JcuWait() */
+
+/**************************************************************************//**
+ * Function Name : R_VIDEO_JcuClose
+ * @brief       Stops the JCU and releases it
+ * @param[in]   owner           : Back end that opened the JCU
+ * @retval      none
+ ******************************************************************************/
+void R_VIDEO_JcuClose(const e_video_jcu_owner_t owner)
+{
+    if ((VIDEO_JCU_OWNER_NONE != owner) && (owner == gs_jcu_owner))
+    {
+        jcu_terminate();
+        R_OS_DeleteSemaphore(&gs_jcu_semid);
+        gs_jcu_owner = VIDEO_JCU_OWNER_NONE;
+    }
+} /* End of function R_VIDEO_JcuClose() */